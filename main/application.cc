@@ -530,6 +530,7 @@ void Application::Start() {
                 
                 Schedule([this]() {
                     aborted_ = false;
+                    tts_message_open_ = false;
                     ESP_LOGI(TAG, "TTS start received, current state: %d, setting to speaking", device_state_);
                     // Force state to speaking immediately to ensure audio packets are received
                     SetDeviceState(kDeviceStateSpeaking);
@@ -604,7 +605,13 @@ void Application::Start() {
                     // So we display TTS text as a fallback if LLM didn't provide text
                     if (tts_text.length() > 0) {
                         Schedule([this, display, message = std::string(tts_text)]() {
-                            display->SetChatMessage("assistant", message.c_str());
+                            // Sentences of one turn stream into a single bubble
+                            if (tts_message_open_) {
+                                display->AppendChatMessage("assistant", message.c_str());
+                            } else {
+                                display->SetChatMessage("assistant", message.c_str());
+                                tts_message_open_ = true;
+                            }
                             ESP_LOGD(TAG, "Displayed TTS sentence text: %s", message.c_str());
                         });
                     }
@@ -938,7 +945,7 @@ void Application::Start() {
                         }
                         
                         // Also execute saved memory slot if configured (1-3)
-                        if (cached_action_slot_ >= 1 && cached_action_slot_ <= 3) {
+                        if (cached_action_slot_ >= 1 && cached_action_slot_ <= ACTION_SLOT_COUNT) {
                             ESP_LOGI(TAG, "🎭 Executing action slot %d for keyword", cached_action_slot_);
                             int actions_played = otto_play_memory_slot(cached_action_slot_);
                             ESP_LOGI(TAG, "✅ Played %d actions from slot %d", actions_played, cached_action_slot_);
@@ -1242,7 +1249,7 @@ void Application::Start() {
                                             otto_controller_queue_action(pose_action, 1, 1500, 0, 0);
                                         }
                                     }
-                                    if (action_slot >= 1 && action_slot <= 3) {
+                                    if (action_slot >= 1 && action_slot <= ACTION_SLOT_COUNT) {
                                         ESP_LOGI(TAG, "🎭 Music action slot %d", action_slot);
                                         otto_play_memory_slot(action_slot);
                                     }
@@ -121,11 +121,12 @@ private:
     std::vector<std::string> cached_keywords_;  // Pre-split keywords for fast matching
     std::string cached_emoji_;  // Emoji to show when keyword matched
     std::string cached_pose_;   // Pose name to execute (sit/wave/bow/stretch/swing/dance)
-    int8_t cached_action_slot_ = 0;  // Action slot to execute (memory slot 1-3)
+    int8_t cached_action_slot_ = 0;  // Action slot to execute (memory slot 1-ACTION_SLOT_COUNT)
     bool keywords_loaded_ = false;  // Whether keywords have been loaded from NVS
 
     bool has_server_time_ = false;
     bool aborted_ = false;
+    bool tts_message_open_ = false;  // A TTS sentence of this turn is on screen, append the next ones
     int clock_ticks_ = 0;
     TaskHandle_t check_new_version_task_handle_ = nullptr;
     TaskHandle_t main_event_loop_task_handle_ = nullptr;
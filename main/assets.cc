@@ -6,6 +6,7 @@
 #include "emote_display.h"
 #ifdef HAVE_LVGL
 #include "display/lcd_display.h"
+#include "lvgl_glyph_cache.h"
 #endif
 
 #include <esp_log.h>
@@ -16,6 +17,38 @@
 
 #define TAG "Assets"
 
+#if defined(HAVE_LVGL) && CONFIG_FONT_GLYPH_CACHE_SIZE_KB > 0
+#define GLYPH_PREWARM_ASCII " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"
+#define GLYPH_PREWARM_VIETNAMESE \
+    "àáảãạăằắẳẵặâầấẩẫậđèéẻẽẹêềếểễệìíỉĩịòóỏõọôồốổỗộơờớởỡợùúủũụưừứửữựỳýỷỹỵ" \
+    "ÀÁẢÃẠĂẰẮẲẴẶÂẦẤẨẪẬĐÈÉẺẼẸÊỀẾỂỄỆÌÍỈĨỊÒÓỎÕỌÔỒỐỔỖỘƠỜỚỞỠỢÙÚỦŨỤƯỪỨỬỮỰỲÝỶỸỴ"
+
+// Decode the common glyphs of the text font into PSRAM before the first chat message
+static void SetupGlyphCache(LvglCBinFont* text_font) {
+    text_font->EnableGlyphCache(CONFIG_FONT_GLYPH_CACHE_SIZE_KB * 1024);
+    auto glyph_cache = text_font->glyph_cache();
+    if (glyph_cache == nullptr) {
+        return;
+    }
+
+    std::string prewarm;
+#if CONFIG_FONT_GLYPH_CACHE_PREWARM_ASCII
+    prewarm = GLYPH_PREWARM_ASCII;
+#elif CONFIG_FONT_GLYPH_CACHE_PREWARM_VIETNAMESE
+    prewarm = GLYPH_PREWARM_ASCII GLYPH_PREWARM_VIETNAMESE;
+#endif
+    prewarm += CONFIG_FONT_GLYPH_CACHE_PREWARM_EXTRA;
+
+    DisplayLockGuard lock(Board::GetInstance().GetDisplay());
+#if CONFIG_FONT_GLYPH_CACHE_BENCHMARK
+    glyph_cache->Benchmark(prewarm.empty() ? GLYPH_PREWARM_ASCII : prewarm.c_str());
+#endif
+    if (!prewarm.empty()) {
+        glyph_cache->Prewarm(prewarm.c_str());
+    }
+}
+#endif
+
 struct mmap_assets_table {
     char asset_name[32];          /*!< Name of the asset */
     uint32_t asset_size;          /*!< Size of the asset */
@@ -160,6 +193,9 @@ bool Assets::Apply() {
                 ESP_LOGE(TAG, "Failed to load fonts.bin");
                 return false;
             }
+#if CONFIG_FONT_GLYPH_CACHE_SIZE_KB > 0
+            SetupGlyphCache(text_font.get());
+#endif
             if (light_theme != nullptr) {
                 light_theme->set_text_font(text_font);
             }
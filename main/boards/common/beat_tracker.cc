@@ -0,0 +1,428 @@
+#include "beat_tracker.h"
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define TAG "BeatTracker"
+
+static constexpr int kTargetRate = 11025;        // 分析采样率，足够覆盖鼓点能量
+static constexpr float kLogCompression = 10.0f;  // log(1 + C*|X|) 压缩动态范围
+static constexpr float kMinBpm = 60.0f;
+static constexpr float kMaxBpm = 180.0f;
+static constexpr float kPreferredBpm = 120.0f;
+static constexpr float kPriorOctaves = 1.0f;     // 速度先验宽度 (log2域标准差)
+static constexpr float kMinConfidence = 0.12f;   // 低于此值不输出节拍 (人声/无节奏段落)
+static constexpr float kTempoTolerance = 0.08f;  // 新估计与当前周期相差8%以内视为同一速度
+static constexpr float kPhaseGain = 0.5f;        // 每次相位修正只纠正一半误差，避免抖动
+static constexpr int kPhaseBeats = 4;            // 相位估计使用最近4拍
+static constexpr int kLookaheadMs = 250;         // 提前发出节拍事件，给舵机留出动作时间
+
+template<typename T>
+static T* AllocBuffer(size_t count) {
+    void* ptr = heap_caps_malloc(count * sizeof(T), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ptr) {
+        ptr = heap_caps_malloc(count * sizeof(T), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    return static_cast<T*>(ptr);
+}
+
+BeatTracker::BeatTracker() {
+}
+
+BeatTracker::~BeatTracker() {
+    heap_caps_free(window_);
+    heap_caps_free(twiddle_cos_);
+    heap_caps_free(twiddle_sin_);
+    heap_caps_free(bit_reverse_);
+    heap_caps_free(frame_);
+    heap_caps_free(re_);
+    heap_caps_free(im_);
+    heap_caps_free(prev_mag_);
+    heap_caps_free(envelope_);
+    heap_caps_free(onset_);
+}
+
+bool BeatTracker::EnsureBuffers() {
+    if (onset_ != nullptr) {
+        return true;
+    }
+
+    // 失败后下次重试时只补齐缺少的缓冲区
+    if (!window_) window_ = AllocBuffer<float>(kFftSize);
+    if (!twiddle_cos_) twiddle_cos_ = AllocBuffer<float>(kFftSize / 2);
+    if (!twiddle_sin_) twiddle_sin_ = AllocBuffer<float>(kFftSize / 2);
+    if (!bit_reverse_) bit_reverse_ = AllocBuffer<uint8_t>(kFftSize);
+    if (!frame_) frame_ = AllocBuffer<float>(kFftSize);
+    if (!re_) re_ = AllocBuffer<float>(kFftSize);
+    if (!im_) im_ = AllocBuffer<float>(kFftSize);
+    if (!prev_mag_) prev_mag_ = AllocBuffer<float>(kBins);
+    if (!envelope_) envelope_ = AllocBuffer<float>(kHistory);
+    float* onset = AllocBuffer<float>(kHistory);
+    if (!window_ || !twiddle_cos_ || !twiddle_sin_ || !bit_reverse_ || !frame_ ||
+        !re_ || !im_ || !prev_mag_ || !envelope_ || !onset) {
+        ESP_LOGE(TAG, "Failed to allocate beat tracker buffers");
+        heap_caps_free(onset);
+        return false;
+    }
+    memset(prev_mag_, 0, kBins * sizeof(float));
+
+    // 预计算窗函数、旋转因子和位反转表，分析时不再调用三角函数
+    for (int i = 0; i < kFftSize; i++) {
+        window_[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / (kFftSize - 1));
+    }
+    for (int i = 0; i < kFftSize / 2; i++) {
+        twiddle_cos_[i] = cosf(2.0f * (float)M_PI * i / kFftSize);
+        twiddle_sin_[i] = -sinf(2.0f * (float)M_PI * i / kFftSize);
+    }
+    int bits = 0;
+    while ((1 << bits) < kFftSize) {
+        bits++;
+    }
+    for (int i = 0; i < kFftSize; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) {
+                reversed |= 1 << (bits - 1 - b);
+            }
+        }
+        bit_reverse_[i] = (uint8_t)reversed;
+    }
+
+    onset_ = onset;
+    return true;
+}
+
+void BeatTracker::SetCallback(Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+void BeatTracker::Reset() {
+    sample_rate_ = 0;
+    decim_acc_ = 0;
+    decim_count_ = 0;
+    frame_fill_ = 0;
+    decimated_samples_ = 0;
+    base_sample_ = 0;
+    base_media_ms_ = 0;
+    frame_index_ = 0;
+    period_frames_ = 0;
+    candidate_period_ = 0;
+    confidence_ = 0;
+    next_beat_frame_ = 0;
+    beat_index_ = 0;
+    frames_since_tempo_ = 0;
+    if (prev_mag_) {
+        memset(prev_mag_, 0, kBins * sizeof(float));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = Stats();
+    cpu_us_ = 0;
+    audio_us_ = 0;
+}
+
+double BeatTracker::FrameToMs(double frame) const {
+    double center = frame * kHop + kFftSize / 2;
+    return base_media_ms_ + (center - base_sample_) * 1000.0 / decimated_rate_;
+}
+
+void BeatTracker::Process(const int16_t* pcm, int samples, int sample_rate, int64_t media_ms) {
+    if (pcm == nullptr || samples <= 0 || sample_rate <= 0) {
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+    if (!EnsureBuffers()) {
+        return;
+    }
+
+    if (sample_rate != sample_rate_) {
+        if (sample_rate_ != 0) {
+            ESP_LOGW(TAG, "Sample rate changed %d -> %d, restarting analysis", sample_rate_, sample_rate);
+        }
+        Reset();
+        sample_rate_ = sample_rate;
+        decimation_ = std::max(1, (sample_rate + kTargetRate / 2) / kTargetRate);
+        decimated_rate_ = (float)sample_rate / decimation_;
+    }
+
+    base_sample_ = decimated_samples_;
+    base_media_ms_ = media_ms;
+
+    for (int i = 0; i < samples; i++) {
+        // 盒式平均抽取，兼作简单低通
+        decim_acc_ += pcm[i];
+        if (++decim_count_ < decimation_) {
+            continue;
+        }
+        frame_[frame_fill_++] = (float)decim_acc_ / (decimation_ * 32768.0f);
+        decim_acc_ = 0;
+        decim_count_ = 0;
+        decimated_samples_++;
+
+        if (frame_fill_ == kFftSize) {
+            AnalyseFrame();
+            memmove(frame_, frame_ + kHop, (kFftSize - kHop) * sizeof(float));
+            frame_fill_ = kFftSize - kHop;
+        }
+    }
+
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    std::lock_guard<std::mutex> lock(mutex_);
+    cpu_us_ += elapsed_us;
+    audio_us_ += (int64_t)samples * 1000000 / sample_rate;
+    if (audio_us_ > 0) {
+        stats_.cpu_permille = (uint32_t)(cpu_us_ * 1000 / audio_us_);
+    }
+    if (stats_.frames > 0) {
+        stats_.avg_frame_us = (uint32_t)(cpu_us_ / stats_.frames);
+    }
+}
+
+void BeatTracker::AnalyseFrame() {
+    // 加窗 + 位反转重排
+    for (int i = 0; i < kFftSize; i++) {
+        int j = bit_reverse_[i];
+        re_[j] = frame_[i] * window_[i];
+        im_[j] = 0;
+    }
+
+    // 基2 DIT FFT
+    for (int size = 2; size <= kFftSize; size <<= 1) {
+        int half = size >> 1;
+        int step = kFftSize / size;
+        for (int start = 0; start < kFftSize; start += size) {
+            for (int k = 0; k < half; k++) {
+                float wr = twiddle_cos_[k * step];
+                float wi = twiddle_sin_[k * step];
+                int a = start + k;
+                int b = a + half;
+                float tr = re_[b] * wr - im_[b] * wi;
+                float ti = re_[b] * wi + im_[b] * wr;
+                re_[b] = re_[a] - tr;
+                im_[b] = im_[a] - ti;
+                re_[a] += tr;
+                im_[a] += ti;
+            }
+        }
+    }
+
+    // 半波整流的对数幅度谱通量
+    float flux = 0;
+    for (int k = 1; k < kBins; k++) {
+        float mag = log1pf(kLogCompression * sqrtf(re_[k] * re_[k] + im_[k] * im_[k]));
+        float diff = mag - prev_mag_[k];
+        if (diff > 0) {
+            flux += diff;
+        }
+        prev_mag_[k] = mag;
+    }
+    // 第一帧没有参考谱，通量无意义
+    onset_[frame_index_ % kHistory] = frame_index_ == 0 ? 0 : flux;
+    frame_index_++;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.frames++;
+    }
+
+    float frame_rate = decimated_rate_ / kHop;
+    if (++frames_since_tempo_ >= (int)frame_rate && frame_index_ >= kHistory / 2) {
+        frames_since_tempo_ = 0;
+        EstimateTempo();
+    }
+    EmitDueBeats();
+}
+
+void BeatTracker::EstimateTempo() {
+    int n = (int)std::min<int64_t>(frame_index_, kHistory);
+    int64_t first = frame_index_ - n;
+
+    // 环形缓冲区展开为平滑、去均值的线性序列；平滑后尖峰变宽，
+    // 非整数周期在整数滞后上也能得到稳定的自相关峰
+    float mean = 0;
+    for (int i = 0; i < n; i++) {
+        float sum = 0;
+        float weight = 0;
+        for (int k = -2; k <= 2; k++) {
+            int j = i + k;
+            if (j >= 0 && j < n) {
+                float w = 3.0f - abs(k);
+                sum += w * onset_[(first + j) % kHistory];
+                weight += w;
+            }
+        }
+        envelope_[i] = sum / weight;
+        mean += envelope_[i];
+    }
+    mean /= n;
+    float energy = 0;
+    for (int i = 0; i < n; i++) {
+        envelope_[i] -= mean;
+        energy += envelope_[i] * envelope_[i];
+    }
+    if (energy <= 1e-6f) {
+        return;
+    }
+
+    float frame_rate = decimated_rate_ / kHop;
+    int lag_min = std::max(2, (int)floorf(frame_rate * 60.0f / kMaxBpm));
+    int lag_max = std::min(n / 2, (int)ceilf(frame_rate * 60.0f / kMinBpm));
+    int ac_max = std::min(n - 1, std::min(kFftSize - 1, 2 * lag_max + 1));
+    if (lag_max <= lag_min + 1) {
+        return;
+    }
+
+    // 归一化自相关，复用FFT虚部缓冲区作为临时空间
+    const float* env = envelope_;
+    float* ac = im_;
+    for (int lag = lag_min - 1; lag <= ac_max; lag++) {
+        float sum = 0;
+        for (int i = lag; i < n; i++) {
+            sum += env[i] * env[i - lag];
+        }
+        ac[lag] = sum / energy;
+    }
+
+    // 加权评分：对数高斯速度先验 + 二倍周期谐波，抑制倍频/半频错误
+    float preferred_lag = frame_rate * 60.0f / kPreferredBpm;
+    int best_lag = -1;
+    float best_score = 0;
+    for (int lag = lag_min; lag <= lag_max; lag++) {
+        float score = ac[lag];
+        if (2 * lag + 1 <= ac_max) {
+            score += 0.5f * std::max(ac[2 * lag], std::max(ac[2 * lag - 1], ac[2 * lag + 1]));
+        }
+        float octaves = log2f(lag / preferred_lag) / kPriorOctaves;
+        score *= expf(-0.5f * octaves * octaves);
+        if (score > best_score) {
+            best_score = score;
+            best_lag = lag;
+        }
+    }
+    if (best_lag < 0) {
+        confidence_ *= 0.5f;
+        return;
+    }
+
+    // 抛物线插值得到小数周期
+    float period = (float)best_lag;
+    if (best_lag < ac_max) {
+        float l = ac[best_lag - 1], c = ac[best_lag], r = ac[best_lag + 1];
+        float denom = l - 2 * c + r;
+        if (denom < 0) {
+            period += std::clamp(0.5f * (l - r) / denom, -0.5f, 0.5f);
+        }
+    }
+    float confidence = std::clamp(ac[best_lag], 0.0f, 1.0f);
+    confidence_ = confidence_ == 0 ? confidence : 0.7f * confidence_ + 0.3f * confidence;
+
+    // 速度迟滞：偏差较大的估计需要连续两次一致才切换
+    bool locked = period_frames_ > 0;
+    if (!locked || fabsf(period - period_frames_) <= kTempoTolerance * period_frames_) {
+        period_frames_ = locked ? 0.7f * period_frames_ + 0.3f * period : period;
+        candidate_period_ = 0;
+    } else if (candidate_period_ > 0 && fabsf(period - candidate_period_) <= kTempoTolerance * candidate_period_) {
+        ESP_LOGI(TAG, "Tempo change %.1f -> %.1f BPM", frame_rate * 60.0f / period_frames_,
+                 frame_rate * 60.0f / period);
+        period_frames_ = period;
+        candidate_period_ = 0;
+        locked = false;
+    } else {
+        candidate_period_ = period;
+    }
+
+    // 相位：梳状滤波找出最近几拍的最佳对齐位置
+    int period_int = std::max(1, (int)lroundf(period_frames_));
+    int best_offset = 0;
+    float best_comb = -1;
+    for (int offset = 0; offset < period_int; offset++) {
+        float comb = 0;
+        for (int k = 0; k < kPhaseBeats; k++) {
+            int idx = n - 1 - offset - (int)lroundf(k * period_frames_);
+            if (idx < 0) {
+                break;
+            }
+            comb += env[idx];
+        }
+        if (comb > best_comb) {
+            best_comb = comb;
+            best_offset = offset;
+        }
+    }
+    double last_beat = (double)(frame_index_ - 1 - best_offset);
+    if (!locked) {
+        next_beat_frame_ = last_beat + period_frames_;
+    } else {
+        double error = std::remainder(last_beat - next_beat_frame_, (double)period_frames_);
+        next_beat_frame_ += kPhaseGain * error;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.tempo_updates++;
+    stats_.bpm = frame_rate * 60.0f / period_frames_;
+    stats_.confidence = confidence_;
+}
+
+void BeatTracker::EmitDueBeats() {
+    if (period_frames_ <= 0 || confidence_ < kMinConfidence) {
+        return;
+    }
+
+    double samples_per_ms = decimated_rate_ / 1000.0;
+    double lookahead_samples = kLookaheadMs * samples_per_ms;
+    while (true) {
+        double beat_sample = next_beat_frame_ * kHop + kFftSize / 2;
+        double ahead = beat_sample - decimated_samples_;
+        if (ahead > lookahead_samples) {
+            break;
+        }
+        int delay_ms = (int)(ahead / samples_per_ms) + output_latency_ms_;
+        double beat_frame = next_beat_frame_;
+        next_beat_frame_ += period_frames_;
+        if (delay_ms < 0) {
+            continue;  // 相位跳变后已错过的节拍直接跳过
+        }
+
+        BeatEvent event;
+        event.beat_ms = (int64_t)FrameToMs(beat_frame);
+        event.delay_ms = delay_ms;
+        event.period_ms = (int)(period_frames_ * kHop * 1000.0f / decimated_rate_);
+        event.bpm = decimated_rate_ * 60.0f / (kHop * period_frames_);
+        event.confidence = confidence_;
+        event.index = beat_index_++;
+
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.beats++;
+            callback = callback_;
+        }
+        ESP_LOGD(TAG, "Beat %u at %lldms (in %dms), %.1f BPM, conf=%.2f",
+                 (unsigned)event.index, event.beat_ms, event.delay_ms, event.bpm, event.confidence);
+        if (callback) {
+            callback(event);
+        }
+    }
+}
+
+BeatTracker::Stats BeatTracker::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::string BeatTracker::GetStatsJson() {
+    auto stats = GetStats();
+    char json[192];
+    snprintf(json, sizeof(json),
+             "{\"bpm\":%.1f,\"confidence\":%.2f,\"beats\":%u,\"frames\":%u,\"tempo_updates\":%u,"
+             "\"cpu_permille\":%u,\"frame_us\":%u}",
+             stats.bpm, stats.confidence, (unsigned)stats.beats, (unsigned)stats.frames,
+             (unsigned)stats.tempo_updates, (unsigned)stats.cpu_permille, (unsigned)stats.avg_frame_us);
+    return json;
+}
@@ -0,0 +1,116 @@
+#ifndef BEAT_TRACKER_H
+#define BEAT_TRACKER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief 节拍跟踪器 - lightweight onset/beat tracker for decoded music
+ *
+ * The player feeds mono PCM after decoding. The tracker decimates it to
+ * ~11kHz, runs a 256-point FFT every 128 samples (~86 onset frames/s) and
+ * uses half-wave rectified log-magnitude spectral flux as onset strength.
+ * Every second the tempo is re-estimated by autocorrelating the last ~6s of
+ * onset strength (60-180 BPM, weighted towards 120 BPM), the beat phase is
+ * picked by comb-filtering the same history, and a flywheel predicts the
+ * next beats so events can be emitted ahead of time.
+ *
+ * Timestamps use the player's media clock (ms since the start of the song)
+ * so consumers can line motion up with what is actually heard.
+ */
+class BeatTracker {
+public:
+    struct BeatEvent {
+        int64_t beat_ms = 0;     // Media time of the beat
+        int delay_ms = 0;        // Wall-clock time from emission until the beat is heard
+        int period_ms = 0;
+        float bpm = 0;
+        float confidence = 0;    // 0..1, normalized autocorrelation peak
+        uint32_t index = 0;      // Beat counter since the start of the song
+    };
+
+    struct Stats {
+        uint32_t frames = 0;       // Onset frames analysed
+        uint32_t beats = 0;        // Beat events emitted
+        uint32_t tempo_updates = 0;
+        float bpm = 0;
+        float confidence = 0;
+        uint32_t cpu_permille = 0; // Analysis time per unit of audio time
+        uint32_t avg_frame_us = 0;
+    };
+
+    using Callback = std::function<void(const BeatEvent&)>;
+
+    BeatTracker();
+    ~BeatTracker();
+    BeatTracker(const BeatTracker&) = delete;
+    BeatTracker& operator=(const BeatTracker&) = delete;
+
+    // Callback runs on the decoder thread - keep it short (post to a queue/timer)
+    void SetCallback(Callback callback);
+    // Extra latency between the decoder and the speaker, added to BeatEvent::delay_ms
+    void SetOutputLatencyMs(int latency_ms) { output_latency_ms_ = latency_ms; }
+
+    // Start of a new song
+    void Reset();
+    // Mono PCM block; media_ms is the media time of the first sample
+    void Process(const int16_t* pcm, int samples, int sample_rate, int64_t media_ms);
+
+    Stats GetStats();
+    std::string GetStatsJson();
+
+private:
+    static constexpr int kFftSize = 256;
+    static constexpr int kHop = 128;
+    static constexpr int kBins = kFftSize / 2 + 1;
+    static constexpr int kHistory = 512;  // Onset frames kept for tempo analysis (~6s)
+
+    bool EnsureBuffers();
+    void AnalyseFrame();
+    void EstimateTempo();
+    void EmitDueBeats();
+    double FrameToMs(double frame) const;
+
+    // Work buffers (allocated on first use, PSRAM preferred)
+    float* window_ = nullptr;
+    float* twiddle_cos_ = nullptr;
+    float* twiddle_sin_ = nullptr;
+    uint8_t* bit_reverse_ = nullptr;
+    float* frame_ = nullptr;       // Decimated samples, kFftSize
+    float* re_ = nullptr;
+    float* im_ = nullptr;
+    float* prev_mag_ = nullptr;    // Log magnitude of the previous frame, kBins
+    float* onset_ = nullptr;       // Ring buffer of onset strength, kHistory
+    float* envelope_ = nullptr;    // Linearized, mean-removed copy for tempo analysis
+
+    // Input/decimation state
+    int sample_rate_ = 0;
+    int decimation_ = 1;
+    float decimated_rate_ = 0;
+    int32_t decim_acc_ = 0;
+    int decim_count_ = 0;
+    int frame_fill_ = 0;
+    int64_t decimated_samples_ = 0;
+    int64_t base_sample_ = 0;      // Decimated sample index at base_media_ms_
+    int64_t base_media_ms_ = 0;
+
+    // Tempo/phase state
+    int64_t frame_index_ = 0;      // Onset frames produced
+    float period_frames_ = 0;      // Beat period in onset frames, 0 = no lock
+    float candidate_period_ = 0;   // Disagreeing estimate awaiting confirmation
+    float confidence_ = 0;
+    double next_beat_frame_ = 0;
+    uint32_t beat_index_ = 0;
+    int frames_since_tempo_ = 0;
+    int output_latency_ms_ = 0;
+
+    std::mutex mutex_;             // Guards callback_ and stats_
+    Callback callback_;
+    Stats stats_;
+    int64_t cpu_us_ = 0;
+    int64_t audio_us_ = 0;
+};
+
+#endif // BEAT_TRACKER_H
@@ -803,14 +803,15 @@ bool Esp32Camera::Capture() {
 
 #ifdef CONFIG_XIAOZHI_CAMERA_ALLOW_JPEG_INPUT
             case V4L2_PIX_FMT_JPEG: {
-                uint8_t* out_data = nullptr;  // out data is allocated by jpeg_to_image
+                uint8_t* out_data = nullptr;  // out data is allocated by jpeg_to_image_fit
                 size_t out_len = 0;
                 size_t out_width = 0;
                 size_t out_height = 0;
                 size_t out_stride = 0;
 
-                esp_err_t ret =
-                    jpeg_to_image(frame_.data, frame_.len, &out_data, &out_len, &out_width, &out_height, &out_stride);
+                // 预览不需要全分辨率：按屏幕尺寸缩放解码，省 PSRAM 和解码时间
+                esp_err_t ret = jpeg_to_image_fit(frame_.data, frame_.len, display->width(), display->height(),
+                                                  &out_data, &out_len, &out_width, &out_height, &out_stride);
                 if (ret != ESP_OK) {
                     ESP_LOGE(TAG, "Failed to decode JPEG image: %d (%s)", (int)ret, esp_err_to_name(ret));
                     if (out_data) {
@@ -1,5 +1,6 @@
 #include "esp32_music.h"
 #include "music.h"
+#include "music_cache.h"
 #include "board.h"
 #include "system_info.h"
 #include "audio/audio_codec.h"
@@ -28,6 +29,11 @@
 
 #define TAG "Esp32Music"
 
+// 解码到扬声器的延迟：70ms PCM累积 + I2S DMA缓冲
+static constexpr int kBeatOutputLatencyMs = 100;
+// 歌词相对解码时钟的提前量 (实测调整值)
+static constexpr int kLyricLeadMs = 600;
+
 // ========== Simple Linear Resampler ==========
 // silk resampler không hỗ trợ 44100Hz, nên dùng linear interpolation
 static void linear_resample(const int16_t* input, int input_samples, 
@@ -210,24 +216,31 @@ static std::string buildUrlWithParams(const std::string& base_url, const std::st
 }
 
 Esp32Music::Esp32Music() : last_downloaded_data_(), current_music_url_(), current_song_name_(),
-                         song_name_displayed_(false), current_lyric_url_(), lyrics_(), 
-                         current_lyric_index_(-1), lyric_thread_(), is_lyric_running_(false),
-                         last_displayed_song_title_(), last_displayed_lyric_text_(), 
-                         last_display_update_time_ms_(0),
+                         song_name_displayed_(false), current_lyric_url_(), lyric_fetches_(0),
                          display_mode_(DISPLAY_MODE_LYRICS), is_playing_(false), is_downloading_(false),
                          is_stopping_(false), is_preparing_(false), play_thread_(), download_thread_(), audio_buffer_(), buffer_mutex_(), 
-                         buffer_cv_(), buffer_size_(0), mp3_decoder_(nullptr), mp3_frame_info_(), 
+                         buffer_cv_(), buffer_size_(0), buffer_policy_(MIN_BUFFER_SIZE, MAX_BUFFER_SIZE), mp3_decoder_(nullptr), mp3_frame_info_(), 
                          mp3_decoder_initialized_(false), aac_decoder_(nullptr), aac_stream_info_(),
                          aac_decoder_initialized_(false), aac_info_ready_(false),
                          stream_format_(AudioStreamFormat::Unknown), active_http_(nullptr) {
     InitializeMp3Decoder();
+    MusicCache::GetInstance().Initialize();
+    beat_tracker_.SetOutputLatencyMs(kBeatOutputLatencyMs);
+    lyric_scheduler_.SetCallback([](const std::string& text) {
+        Application::GetInstance().Schedule([text]() {
+            auto disp = Board::GetInstance().GetDisplay();
+            if (disp) {
+                disp->SetChatMessage("lyric", text.c_str());
+            }
+        });
+    });
 }
 
 Esp32Music::~Esp32Music() {
     // 停止所有操作
     is_downloading_ = false;
     is_playing_ = false;
-    is_lyric_running_ = false;
+    lyric_scheduler_.Reset();
     
     // Cleanup HTTP handle nếu còn (tiết kiệm SRAM)
     {
@@ -255,9 +268,9 @@ Esp32Music::~Esp32Music() {
         play_thread_.join();
     }
     
-    // 等待歌词线程结束
-    if (lyric_thread_.joinable()) {
-        lyric_thread_.join();
+    // 等待歌词下载线程结束 (detached，其结果已因 Reset() 失效)
+    while (lyric_fetches_.load() > 0) {
+        vTaskDelay(pdMS_TO_TICKS(20));
     }
     
     // 清理缓冲区和解码器
@@ -299,6 +312,27 @@ bool Esp32Music::Download(const std::string& song_name, const std::string& artis
     Application::GetInstance().SetDeviceState(kDeviceStateIdle);
     ESP_LOGI(TAG, "🏠 Set device to IDLE state for music playback");
     
+    // 💾 Song cache hit: play straight from flash, no metadata request and no TLS at all
+    std::string cache_key = MusicCache::MakeKey(song_name, artist_name);
+    MusicCache::Entry cached;
+    if (MusicCache::GetInstance().Lookup(cache_key, cached)) {
+        ESP_LOGI(TAG, "💾 Cache hit for %s (%s, %u KB)", song_name.c_str(), cache_key.c_str(), (unsigned)(cached.size / 1024));
+        last_downloaded_data_.clear();
+        current_song_name_ = song_name;
+        current_artist_ = cached.artist;
+        current_thumbnail_ = cached.thumbnail;
+        current_lyric_url_ = cached.lyric_url;
+        pending_cache_key_.clear();
+        song_name_displayed_ = false;
+        current_music_url_ = std::string(MusicCache::kUrlScheme) + cache_key;
+        if (!StartStreaming(current_music_url_)) {
+            return false;
+        }
+        StartLyricFetch(song_name);
+        return true;
+    }
+    pending_cache_key_ = cache_key;
+    
     // 🔊 Disable audio output too to free more SRAM (speaker buffers)
     if (codec) {
         codec->EnableOutput(false);
@@ -523,19 +557,14 @@ bool Esp32Music::Download(const std::string& song_name, const std::string& artis
                 size_t sram_before_stream = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
                 ESP_LOGI(TAG, "🧹 SRAM before StartStreaming: %d bytes", (int)sram_before_stream);
                 
-                ESP_LOGI(TAG, "小智开源音乐固件qq交流群:826072986");
-                ESP_LOGI(TAG, "Starting streaming playback for: %s", song_name.c_str());
-                song_name_displayed_ = false;  // 重置歌名显示标志
-                StartStreaming(current_music_url_);
-                
-                // 处理歌词URL - 只有在歌词显示模式下且未启用低SRAM模式才启动歌词
-                bool low_sram_mode = Application::GetInstance().IsMediaLowSramMode();
-                if (!low_sram_mode && !lyric_path_str.empty()) {
-                    // 拼接完整的歌词下载URL，使用相同的URL构建逻辑
+                // 拼接完整的歌词下载URL，使用相同的URL构建逻辑。
+                // 在 StartStreaming 之前算好：写入缓存时连同歌词URL一起保存，缓存命中时也能显示歌词
+                current_lyric_url_.clear();
+                if (!lyric_path_str.empty()) {
                     std::string lyric_path = lyric_path_str;
                     
                     // Ensure lyric_path starts with /
-                    if (!lyric_path.empty() && lyric_path[0] != '/') {
+                    if (lyric_path[0] != '/') {
                         lyric_path = "/" + lyric_path;
                     }
                     
@@ -548,50 +577,14 @@ bool Esp32Music::Download(const std::string& song_name, const std::string& artis
                     } else {
                         current_lyric_url_ = base_url + lyric_path;
                     }
-                    
-                    // 根据显示模式决定是否启动歌词
-                    if (display_mode_ == DISPLAY_MODE_LYRICS) {
-                        ESP_LOGI(TAG, "Loading lyrics for: %s (lyrics display mode)", song_name.c_str());
-                        
-                        // 启动歌词下载和显示
-                        if (is_lyric_running_) {
-                            is_lyric_running_ = false;
-                            if (lyric_thread_.joinable()) {
-                                lyric_thread_.join();
-                            }
-                        }
-                        
-                        is_lyric_running_ = true;
-                        current_lyric_index_ = -1;
-                        lyrics_.clear();
-                        
-                        auto default_cfg = esp_pthread_get_default_config();
-                        esp_pthread_cfg_t lyric_cfg = default_cfg;
-                        lyric_cfg.stack_size = 4096;  // 4KB stack cho lyric parsing (cần đủ cho parse file lyrics lớn)
-                        lyric_cfg.prio = 4;
-                        lyric_cfg.thread_name = "lyric_disp";
-                        esp_pthread_set_cfg(&lyric_cfg);
-                        try {
-                            lyric_thread_ = std::thread(&Esp32Music::LyricDisplayThread, this);
-                        } catch (const std::system_error& e) {
-                            ESP_LOGE(TAG, "Failed to create lyric display thread: %s", e.what());
-                            is_lyric_running_ = false;
-                        }
-                        esp_pthread_set_cfg(&default_cfg);
-                    } else {
-                        ESP_LOGI(TAG, "Lyric URL found but spectrum display mode is active, skipping lyrics");
-                    }
-                } else {
-                    if (low_sram_mode) {
-                        ESP_LOGI(TAG, "Low-SRAM media mode: skip lyrics to save SRAM");
-                    } else {
-                        // Only log if lyric URL is actually missing (not due to low-SRAM mode)
-                        if (lyric_path_str.empty()) {
-                            ESP_LOGD(TAG, "No lyric URL found for this song (this is normal for some songs)");
-                        }
-                    }
                 }
                 
+                ESP_LOGI(TAG, "小智开源音乐固件qq交流群:826072986");
+                ESP_LOGI(TAG, "Starting streaming playback for: %s", song_name.c_str());
+                song_name_displayed_ = false;  // 重置歌名显示标志
+                StartStreaming(current_music_url_);
+                StartLyricFetch(song_name);
+                
                 // response_json already deleted above before StartStreaming()
                 return true;
             } else {
@@ -630,6 +623,10 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     // Reset stopping flag before starting new stream
     is_stopping_.store(false, std::memory_order_release);
     
+    // Cache key is only valid for the stream Download() just resolved
+    std::string cache_key = std::move(pending_cache_key_);
+    pending_cache_key_.clear();
+    
     if (music_url.empty()) {
         ESP_LOGE(TAG, "Music URL is empty");
         return false;
@@ -640,14 +637,12 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     // 停止之前的播放和下载
     is_downloading_ = false;
     is_playing_ = false;
-    is_lyric_running_ = false;
     
-    // 等待之前的线程完全结束（包括歌词线程）
-    if (lyric_thread_.joinable()) {
-        lyric_thread_.join();
-        lyric_thread_ = std::thread();
-    }
+    // 清空歌词时间轴；仍在下载的旧歌词会因 session 失效被丢弃。
+    // 在播放线程启动前完成，新歌的歌词用这里的 session 加载
+    lyric_session_ = lyric_scheduler_.Reset();
     
+    // 等待之前的线程完全结束
     if (download_thread_.joinable()) {
         {
             std::lock_guard<std::mutex> lock(buffer_mutex_);
@@ -665,10 +660,6 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
         play_thread_ = std::thread();
     }
     
-    // 清空歌词状态
-    lyrics_.clear();
-    current_lyric_index_ = -1;
-    
     // 清空缓冲区和解码器状态
     ClearAudioBuffer();
     CleanupMp3Decoder();
@@ -678,9 +669,6 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     
     // 重置显示标志
     song_name_displayed_ = false;
-    last_displayed_song_title_.clear();
-    last_displayed_lyric_text_.clear();
-    last_display_update_time_ms_ = 0;
     
     // 等待一小段时间确保资源被完全释放
     vTaskDelay(pdMS_TO_TICKS(50));
@@ -695,6 +683,7 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     
     // Clear the buffer before starting new stream
     ClearAudioBuffer();
+    buffer_policy_.BeginSession();
     
     // Configure thread stack size to avoid stack overflow (reference: TienHuyIoT)
     // Using 5KB stack size - increased from 3KB to prevent stack overflow during playback
@@ -705,6 +694,11 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     cfg.prio = 5;               // Medium priority
     cfg.thread_name = "audio_stream";
     cfg.stack_alloc_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;  // Use PSRAM for stack
+    bool from_cache = MusicCache::IsCacheUrl(music_url);
+    if (from_cache) {
+        // SPI flash reads disable the cache, so the cache reader needs an internal-RAM stack
+        cfg.stack_alloc_caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+    }
     esp_pthread_set_cfg(&cfg);
     
     // 开始下载线程
@@ -721,13 +715,17 @@ bool Esp32Music::StartStreaming(const std::string& music_url) {
     
     ESP_LOGI(TAG, "Creating download thread with 5KB stack");
     try {
-        download_thread_ = std::thread(&Esp32Music::DownloadAudioStream, this, music_url);
+        download_thread_ = std::thread(&Esp32Music::DownloadAudioStream, this, music_url, cache_key);
     } catch (const std::system_error& e) {
         ESP_LOGE(TAG, "Failed to create download thread: %s", e.what());
         is_downloading_ = false;
         is_preparing_ = false;
         return false;
     }
+    if (from_cache) {
+        cfg.stack_alloc_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+        esp_pthread_set_cfg(&cfg);
+    }
     
     // 开始播放线程 (will wait for buffer to have enough data)
     is_playing_ = true;
@@ -936,9 +934,14 @@ bool Esp32Music::StopStreaming(bool send_notification) {
 }
 
 // 流式下载音频数据
-void Esp32Music::DownloadAudioStream(const std::string& music_url) {
+void Esp32Music::DownloadAudioStream(const std::string& music_url, const std::string& cache_key) {
     ESP_LOGD(TAG, "Starting audio stream download from: %s", music_url.c_str());
     
+    if (MusicCache::IsCacheUrl(music_url)) {
+        ReadCachedAudioStream(MusicCache::KeyFromUrl(music_url));
+        return;
+    }
+    
     // 验证URL有效性
     if (music_url.empty() || music_url.find("http") != 0) {
         ESP_LOGE(TAG, "Invalid URL format: %s", music_url.c_str());
@@ -1024,7 +1027,17 @@ void Esp32Music::DownloadAudioStream(const std::string& music_url) {
         return;
     }
     size_t total_downloaded = 0;
+    bool reached_end = false;
     
+    // 💾 Write-through: the song is stored while it streams and committed only on a clean EOF
+    auto& cache = MusicCache::GetInstance();
+    if (!cache_key.empty()) {
+        cache.BeginWrite(cache_key, current_song_name_, current_artist_, current_thumbnail_, current_lyric_url_);
+    }
+    
+    // After blocking on the high-water mark the socket already holds data, so the
+    // next read returns at memory speed and would inflate the link estimate
+    bool skip_sample = false;
     while (is_downloading_ && is_playing_) {
         // Stack safety log every ~512 iterations
         static int __dl_cnt = 0;
@@ -1039,13 +1052,19 @@ void Esp32Music::DownloadAudioStream(const std::string& music_url) {
             if (!active_http_) {
                 break;  // HTTP đã bị close
             }
+            int64_t read_start_us = esp_timer_get_time();
             bytes_read = active_http_->Read((char*)buffer, chunk_size);
+            if (bytes_read > 0 && !skip_sample) {
+                buffer_policy_.OnDownloadSample(bytes_read, esp_timer_get_time() - read_start_us);
+            }
+            skip_sample = false;
         }
         if (bytes_read < 0) {
             ESP_LOGE(TAG, "Failed to read audio data: error code %d", bytes_read);
             break;
         }
         if (bytes_read == 0) {
+            reached_end = true;
             break;
         }
         
@@ -1077,11 +1096,15 @@ void Esp32Music::DownloadAudioStream(const std::string& music_url) {
             break;
         }
         memcpy(chunk_data, buffer, bytes_read);
+        cache.Append(buffer, bytes_read);
         
         // 等待缓冲区有空间
         {
             std::unique_lock<std::mutex> lock(buffer_mutex_);
-            buffer_cv_.wait(lock, [this] { return buffer_size_ < MAX_BUFFER_SIZE || !is_downloading_; });
+            if (buffer_size_ >= buffer_policy_.HighWaterMark()) {
+                skip_sample = true;
+            }
+            buffer_cv_.wait(lock, [this] { return buffer_size_ < buffer_policy_.HighWaterMark() || !is_downloading_; });
             
             // 监控memory mỗi 50 chunks để tránh spam log
             if (total_downloaded % (chunk_size * 50) == 0) {
@@ -1118,6 +1141,12 @@ void Esp32Music::DownloadAudioStream(const std::string& music_url) {
         buffer = nullptr;
     }
     
+    if (reached_end && is_downloading_) {
+        cache.CommitWrite();
+    } else {
+        cache.AbortWrite();
+    }
+    
     // Cleanup HTTP handle
     {
         std::lock_guard<std::mutex> lock(http_mutex_);
@@ -1136,6 +1165,53 @@ void Esp32Music::DownloadAudioStream(const std::string& music_url) {
     }
 }
 
+// 从本地缓存读取音频数据，与网络下载共用同一个播放缓冲区
+void Esp32Music::ReadCachedAudioStream(const std::string& cache_key) {
+    auto& cache = MusicCache::GetInstance();
+    FILE* file = cache.OpenRead(cache_key);
+    if (!file) {
+        ESP_LOGE(TAG, "Failed to open cached song: %s", cache_key.c_str());
+        is_downloading_ = false;
+        std::lock_guard<std::mutex> lock(buffer_mutex_);
+        buffer_cv_.notify_all();
+        return;
+    }
+    ESP_LOGI(TAG, "💾 Playing %s from song cache", cache_key.c_str());
+    
+    const size_t chunk_size = 4096;
+    size_t total_read = 0;
+    while (is_downloading_ && is_playing_) {
+        uint8_t* chunk_data = (uint8_t*)heap_caps_malloc(chunk_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!chunk_data) {
+            ESP_LOGE(TAG, "Failed to allocate cache read chunk in PSRAM");
+            break;
+        }
+        size_t bytes_read = fread(chunk_data, 1, chunk_size, file);
+        if (bytes_read == 0) {
+            heap_caps_free(chunk_data);
+            break;
+        }
+        
+        std::unique_lock<std::mutex> lock(buffer_mutex_);
+        buffer_cv_.wait(lock, [this] { return buffer_size_ < buffer_policy_.HighWaterMark() || !is_downloading_; });
+        if (!is_downloading_) {
+            heap_caps_free(chunk_data);
+            break;
+        }
+        audio_buffer_.push(AudioChunk(chunk_data, bytes_read));
+        buffer_size_ += bytes_read;
+        total_read += bytes_read;
+        buffer_cv_.notify_one();
+    }
+    
+    cache.CloseRead(file, total_read);
+    ESP_LOGI(TAG, "💾 Cache read finished: %u KB, %s", (unsigned)(total_read / 1024), cache.GetStatsJson().c_str());
+    is_downloading_ = false;
+    
+    std::lock_guard<std::mutex> lock(buffer_mutex_);
+    buffer_cv_.notify_all();
+}
+
 // 流式播放音频数据
 void Esp32Music::PlayAudioStream() {
     ESP_LOGI(TAG, "Starting audio stream playback");
@@ -1144,6 +1220,7 @@ void Esp32Music::PlayAudioStream() {
     current_play_time_ms_ = 0;
     last_frame_time_ms_ = 0;
     total_frames_decoded_ = 0;
+    beat_tracker_.Reset();
     
     auto codec = Board::GetInstance().GetAudioCodec();
     if (!codec) {
@@ -1160,9 +1237,10 @@ void Esp32Music::PlayAudioStream() {
     {
         std::unique_lock<std::mutex> lock(buffer_mutex_);
         buffer_cv_.wait(lock, [this] { 
-            return buffer_size_ >= MIN_BUFFER_SIZE || (!is_downloading_ && !audio_buffer_.empty()); 
+            return buffer_size_ >= buffer_policy_.StartThreshold() || (!is_downloading_ && !audio_buffer_.empty()); 
         });
     }
+    buffer_policy_.OnPlaybackStarted();
 
     if (stream_format_.load(std::memory_order_acquire) == AudioStreamFormat::Unknown) {
         std::lock_guard<std::mutex> lock(buffer_mutex_);
@@ -1200,7 +1278,8 @@ void Esp32Music::PlayAudioStream() {
         }
     }
     
-    ESP_LOGI(TAG, "Starting playback, buffer: %u KB", (unsigned int)(buffer_size_ / 1024));
+    ESP_LOGI(TAG, "Starting playback, buffer: %u KB, policy: %s", (unsigned int)(buffer_size_ / 1024),
+             buffer_policy_.GetSessionStatsJson().c_str());
     
     // 监控memory trước khi bắt đầu phát
     size_t free_sram = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
@@ -1215,6 +1294,17 @@ void Esp32Music::PlayAudioStream() {
     }
     
     size_t total_played = 0;
+    size_t total_consumed = 0;  // Compressed bytes taken from the buffer, for bitrate estimation
+    int64_t media_time_us = 0;  // 按微秒累计播放时间，避免每帧截断误差累积
+    
+    // 歌词由定时器驱动：只在播放开始/恢复时校准一次时钟，卡顿或暂停时冻结
+    bool lyric_clock_running = false;
+    auto pause_lyric_clock = [&]() {
+        if (lyric_clock_running) {
+            lyric_scheduler_.Pause();
+            lyric_clock_running = false;
+        }
+    };
     uint8_t* mp3_input_buffer = nullptr;
     size_t mp3_buffer_size = 0;  // 记录buffer size
     int bytes_left = 0;
@@ -1275,9 +1365,6 @@ void Esp32Music::PlayAudioStream() {
     ESP_LOGI("Memory", "All buffers allocated - Free Internal SRAM: %d bytes", (int)free_sram);
     ESP_LOGI("Memory", "All buffers allocated - Free PSRAM: %d bytes", (int)free_psram);
 
-    // 立即显示歌曲名称和歌词（如果有）
-    UpdateLyricDisplay(0);
-
     while (is_playing_) {
         // Stack high-water mark logging (every ~512 iterations)
         static int __hw_cnt = 0;
@@ -1307,9 +1394,11 @@ void Esp32Music::PlayAudioStream() {
             app.SetAudioStopSuppressed(true);
             app.ToggleChatState();
             app.SetAudioStopSuppressed(prev_suppressed);
+            pause_lyric_clock();
             vTaskDelay(pdMS_TO_TICKS(300));
             continue;
         } else if (current_state != kDeviceStateIdle) {
+            pause_lyric_clock();
             vTaskDelay(pdMS_TO_TICKS(50));
             continue;
         }
@@ -1347,8 +1436,13 @@ void Esp32Music::PlayAudioStream() {
                         // 下载完成且缓冲区为空，播放结束
                         break;
                     }
-                    // 等待新数据
-                    buffer_cv_.wait(lock, [this] { return !audio_buffer_.empty() || !is_downloading_; });
+                    // 缓冲区耗尽：记一次卡顿，重新缓冲到起播阈值再继续，避免连续的小卡顿
+                    buffer_policy_.OnUnderrun();
+                    pause_lyric_clock();
+                    buffer_cv_.wait(lock, [this] {
+                        return buffer_size_ >= buffer_policy_.StartThreshold() || !is_downloading_;
+                    });
+                    buffer_policy_.OnRebuffered();
                     if (audio_buffer_.empty()) {
                         continue;
                     }
@@ -1357,6 +1451,7 @@ void Esp32Music::PlayAudioStream() {
                 chunk = audio_buffer_.front();
                 audio_buffer_.pop();
                 buffer_size_ -= chunk.size;
+                total_consumed += chunk.size;
                 
                 // 通知下载线程缓冲区有空间
                 buffer_cv_.notify_one();
@@ -1429,15 +1524,20 @@ void Esp32Music::PlayAudioStream() {
                                   (mp3_frame_info_.samprate * mp3_frame_info_.nChans);
             
             // 更新当前播放时间
-            current_play_time_ms_ += frame_duration_ms;
+            int64_t frame_start_ms = current_play_time_ms_;
+            media_time_us += (int64_t)mp3_frame_info_.outputSamps * 1000000 /
+                             (mp3_frame_info_.samprate * mp3_frame_info_.nChans);
+            current_play_time_ms_ = media_time_us / 1000;
+            buffer_policy_.OnPlaybackProgress(total_consumed, current_play_time_ms_);
             
             ESP_LOGD(TAG, "Frame %d: time=%lldms, duration=%dms, rate=%d, ch=%d", 
                     total_frames_decoded_, current_play_time_ms_, frame_duration_ms,
                     mp3_frame_info_.samprate, mp3_frame_info_.nChans);
             
-            // 更新歌词显示
-            int buffer_latency_ms = 600; // 实测调整值
-            UpdateLyricDisplay(current_play_time_ms_ + buffer_latency_ms);
+            if (!lyric_clock_running) {
+                lyric_scheduler_.Resume(current_play_time_ms_ + kLyricLeadMs);
+                lyric_clock_running = true;
+            }
             
             // 将PCM数据发送到Application的音频解码队列
             if (mp3_frame_info_.outputSamps > 0) {
@@ -1473,6 +1573,9 @@ void Esp32Music::PlayAudioStream() {
                             mp3_frame_info_.nChans);
                 }
                 
+                beat_tracker_.Process(final_pcm_data, final_sample_count, mp3_frame_info_.samprate,
+                                      frame_start_ms);
+                
                 // PCM accumulation với threshold 70ms
                 if (accum_sample_rate == 0) {
                     accum_sample_rate = mp3_frame_info_.samprate;
@@ -1687,6 +1790,8 @@ void Esp32Music::FinishPlaybackCleanup(size_t total_played) {
     size_t free_psram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
 
     ESP_LOGI(TAG, "Playback finished, played: %d MB", (int)(total_played / (1024 * 1024)));
+    ESP_LOGI(TAG, "Buffering session: %s", buffer_policy_.GetSessionStatsJson().c_str());
+    ESP_LOGI(TAG, "Beat tracking: %s", beat_tracker_.GetStatsJson().c_str());
     ESP_LOGI("Memory", "After cleanup - Free Internal SRAM: %d bytes", (int)free_sram);
     ESP_LOGI("Memory", "After cleanup - Free PSRAM: %d bytes", (int)free_psram);
     MonitorPsramUsage();
@@ -1748,12 +1853,18 @@ void Esp32Music::AacPlaybackLoop() {
     resample_buffer.reserve(4096);  // Pre-allocate để tránh reallocation
 
     size_t total_played = 0;
+    size_t total_consumed = 0;
+    int64_t media_time_us = 0;
+    bool lyric_clock_running = false;
+    auto pause_lyric_clock = [&]() {
+        if (lyric_clock_running) {
+            lyric_scheduler_.Pause();
+            lyric_clock_running = false;
+        }
+    };
     int accum_sample_rate = 0;
     int sram_monitor_counter = 0;  // SRAM monitor counter
 
-    // 立即显示歌曲名称和歌词（如果有）
-    UpdateLyricDisplay(0);
-
     while (is_playing_) {
         static int __hw_cnt = 0;
         if (((++__hw_cnt) & 0x1FF) == 0) {
@@ -1779,9 +1890,11 @@ void Esp32Music::AacPlaybackLoop() {
             app.SetAudioStopSuppressed(true);
             app.ToggleChatState();
             app.SetAudioStopSuppressed(prev_suppressed);
+            pause_lyric_clock();
             vTaskDelay(pdMS_TO_TICKS(300));
             continue;
         } else if (current_state != kDeviceStateIdle) {
+            pause_lyric_clock();
             vTaskDelay(pdMS_TO_TICKS(50));
             continue;
         }
@@ -1806,7 +1919,12 @@ void Esp32Music::AacPlaybackLoop() {
                     if (!is_downloading_) {
                         break;
                     }
-                    buffer_cv_.wait(lock, [this] { return !audio_buffer_.empty() || !is_downloading_; });
+                    buffer_policy_.OnUnderrun();
+                    pause_lyric_clock();
+                    buffer_cv_.wait(lock, [this] {
+                        return buffer_size_ >= buffer_policy_.StartThreshold() || !is_downloading_;
+                    });
+                    buffer_policy_.OnRebuffered();
                     if (audio_buffer_.empty()) {
                         if (!is_downloading_) {
                             break;
@@ -1818,6 +1936,7 @@ void Esp32Music::AacPlaybackLoop() {
                 chunk = audio_buffer_.front();
                 audio_buffer_.pop();
                 buffer_size_ -= chunk.size;
+                total_consumed += chunk.size;
                 buffer_cv_.notify_one();
             }
 
@@ -1935,12 +2054,17 @@ void Esp32Music::AacPlaybackLoop() {
 
         pcm_accum.insert(pcm_accum.end(), final_pcm_data, final_pcm_data + total_samples);
 
-        int frame_duration_ms = sample_rate > 0 ? (total_samples * 1000) / sample_rate : 0;
-        current_play_time_ms_ += frame_duration_ms;
+        beat_tracker_.Process(final_pcm_data, total_samples, sample_rate, current_play_time_ms_);
+
+        media_time_us += (int64_t)total_samples * 1000000 / sample_rate;
+        current_play_time_ms_ = media_time_us / 1000;
         total_frames_decoded_++;
+        buffer_policy_.OnPlaybackProgress(total_consumed, current_play_time_ms_);
 
-        int buffer_latency_ms = 600;
-        UpdateLyricDisplay(current_play_time_ms_ + buffer_latency_ms);
+        if (!lyric_clock_running) {
+            lyric_scheduler_.Resume(current_play_time_ms_ + kLyricLeadMs);
+            lyric_clock_running = true;
+        }
 
         int threshold_samples = accum_sample_rate > 0 ? (accum_sample_rate * 7 / 100) : 3087;
         if ((int)pcm_accum.size() >= threshold_samples) {
@@ -2137,7 +2261,7 @@ bool Esp32Music::IsLikelyAacAdts(const uint8_t* data, size_t size) const {
 }
 
 // 下载歌词
-bool Esp32Music::DownloadLyrics(const std::string& lyric_url) {
+bool Esp32Music::DownloadLyrics(const std::string& lyric_url, std::string& lyric_content) {
     ESP_LOGI(TAG, "Downloading lyrics from: %s", lyric_url.c_str());
     
     // 检查URL是否为空
@@ -2150,7 +2274,6 @@ bool Esp32Music::DownloadLyrics(const std::string& lyric_url) {
     const int max_retries = 3;
     int retry_count = 0;
     bool success = false;
-    std::string lyric_content;
     std::string current_url = lyric_url;
     int redirect_count = 0;
     const int max_redirects = 5;  // 最多允许5次重定向
@@ -2282,212 +2405,64 @@ bool Esp32Music::DownloadLyrics(const std::string& lyric_url) {
     }
 
     ESP_LOGI(TAG, "Lyrics downloaded successfully, size: %d bytes", lyric_content.length());
-    return ParseLyrics(lyric_content);
-}
-
-// 解析歌词
-bool Esp32Music::ParseLyrics(const std::string& lyric_content) {
-    ESP_LOGI(TAG, "Parsing lyrics content");
-    
-    // 使用锁保护lyrics_数组访问
-    std::lock_guard<std::mutex> lock(lyrics_mutex_);
-    
-    lyrics_.clear();
-    // Shrink to fit để giải phóng memory không dùng - giảm SRAM usage
-    lyrics_.shrink_to_fit();
-    
-    // 按行分割歌词内容
-    std::istringstream stream(lyric_content);
-    std::string line;
-    
-    while (std::getline(stream, line)) {
-        // 去除行尾的回车符
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        
-        // 跳过空行
-        if (line.empty()) {
-            continue;
-        }
-        
-        // 解析LRC格式: [mm:ss.xx]歌词文本
-        if (line.length() > 10 && line[0] == '[') {
-            size_t close_bracket = line.find(']');
-            if (close_bracket != std::string::npos) {
-                std::string tag_or_time = line.substr(1, close_bracket - 1);
-                std::string content = line.substr(close_bracket + 1);
-                
-                // 检查是否是元数据标签而不是时间戳
-                // 元数据标签通常是 [ti:标题], [ar:艺术家], [al:专辑] 等
-                size_t colon_pos = tag_or_time.find(':');
-                if (colon_pos != std::string::npos) {
-                    std::string left_part = tag_or_time.substr(0, colon_pos);
-                    
-                    // 检查冒号左边是否是时间（数字）
-                    bool is_time_format = true;
-                    for (char c : left_part) {
-                        if (!isdigit(c)) {
-                            is_time_format = false;
-                            break;
-                        }
-                    }
-                    
-                    // 如果不是时间格式，跳过这一行（元数据标签）
-                    if (!is_time_format) {
-                        // 可以在这里处理元数据，例如提取标题、艺术家等信息
-                        ESP_LOGD(TAG, "Skipping metadata tag: [%s]", tag_or_time.c_str());
-                        continue;
-                    }
-                    
-                    // 是时间格式，解析时间戳
-                    try {
-                        int minutes = std::stoi(tag_or_time.substr(0, colon_pos));
-                        float seconds = std::stof(tag_or_time.substr(colon_pos + 1));
-                        int timestamp_ms = minutes * 60 * 1000 + (int)(seconds * 1000);
-                        
-                        // 安全处理歌词文本，确保UTF-8编码正确
-                        std::string safe_lyric_text;
-                        if (!content.empty()) {
-                            // 创建安全副本并验证字符串
-                            safe_lyric_text = content;
-                            // 确保字符串以null结尾
-                            safe_lyric_text.shrink_to_fit();
-                        }
-                        
-                        lyrics_.push_back(std::make_pair(timestamp_ms, safe_lyric_text));
-                        
-                        if (!safe_lyric_text.empty()) {
-                            // 限制日志输出长度，避免中文字符截断问题
-                            size_t log_len = std::min(safe_lyric_text.length(), size_t(50));
-                            std::string log_text = safe_lyric_text.substr(0, log_len);
-                            ESP_LOGD(TAG, "Parsed lyric: [%d ms] %s", timestamp_ms, log_text.c_str());
-                        } else {
-                            ESP_LOGD(TAG, "Parsed lyric: [%d ms] (empty)", timestamp_ms);
-                        }
-                    } catch (const std::exception& e) {
-                        ESP_LOGW(TAG, "Failed to parse time: %s", tag_or_time.c_str());
-                    }
-                }
-            }
-        }
-    }
-    
-    // 按时间戳排序
-    std::sort(lyrics_.begin(), lyrics_.end());
-    
-    ESP_LOGI(TAG, "Parsed %d lyric lines", lyrics_.size());
-    return !lyrics_.empty();
+    return true;
 }
 
-// 歌词显示线程
-void Esp32Music::LyricDisplayThread() {
-    ESP_LOGI(TAG, "Lyric display thread started");
-    
-    if (!DownloadLyrics(current_lyric_url_)) {
-        ESP_LOGE(TAG, "Failed to download or parse lyrics");
-        is_lyric_running_ = false;
+// 处理歌词URL - 只有在歌词显示模式下且未启用低SRAM模式才启动歌词。
+// 在 StartStreaming 之后调用：用它刚建立的歌词 session
+void Esp32Music::StartLyricFetch(const std::string& song_name) {
+    bool low_sram_mode = Application::GetInstance().IsMediaLowSramMode();
+    if (current_lyric_url_.empty()) {
+        ESP_LOGD(TAG, "No lyric URL found for this song (this is normal for some songs)");
         return;
     }
-    
-    // 定期检查是否需要更新显示(频率可以降低)
-    while (is_lyric_running_ && is_playing_) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-    }
-    
-    ESP_LOGI(TAG, "Lyric display thread finished");
-}
-
-void Esp32Music::UpdateLyricDisplay(int64_t current_time_ms) {
-    std::lock_guard<std::mutex> lock(lyrics_mutex_);
-    
-    // Spectrum mode đã bị xóa, luôn hiển thị lyrics
-    
-    // 节流：避免更新太频繁，至少间隔200ms
-    if (current_time_ms - last_display_update_time_ms_ < 200) {
+    if (low_sram_mode) {
+        ESP_LOGI(TAG, "Low-SRAM media mode: skip lyrics to save SRAM");
         return;
     }
-    
-    auto& board = Board::GetInstance();
-    auto display = board.GetDisplay();
-    if (!display) {
+    // 根据显示模式决定是否启动歌词
+    if (display_mode_ != DISPLAY_MODE_LYRICS) {
+        ESP_LOGI(TAG, "Lyric URL found but spectrum display mode is active, skipping lyrics");
         return;
     }
+    ESP_LOGI(TAG, "Loading lyrics for: %s (lyrics display mode)", song_name.c_str());
     
-    // 构建歌曲名称显示文本
-    std::string song_title_display;
-    if (!current_song_name_.empty()) {
-        song_title_display = "Đang phát 《" + current_song_name_ + "》...";
-    }
-    
-    std::string lyric_text;
-    
-    // 如果有歌词，查找当前应该显示的歌词
-    if (!lyrics_.empty()) {
-        int new_lyric_index = -1;
-        
-        // 从当前歌词索引开始查找，提高效率
-        int start_index = (current_lyric_index_.load() >= 0) ? current_lyric_index_.load() : 0;
-        
-        // 正向查找：找到最后一个时间戳小于等于当前时间的歌词
-        for (int i = start_index; i < (int)lyrics_.size(); i++) {
-            if (lyrics_[i].first <= current_time_ms) {
-                new_lyric_index = i;
-            } else {
-                break;  // 时间戳已超过当前时间
-            }
-        }
-        
-        // 如果歌词索引发生变化，更新显示
-        if (new_lyric_index != current_lyric_index_) {
-            current_lyric_index_ = new_lyric_index;
-        }
-        
-        // 获取当前歌词文本
-        if (current_lyric_index_ >= 0 && current_lyric_index_ < (int)lyrics_.size()) {
-            lyric_text = lyrics_[current_lyric_index_].second;
-        }
-    }
-    
-    // 只更新显示当内容发生变化
-    auto& app_sched = Application::GetInstance();
+    // 启动歌词下载：线程只负责下载+编译时间轴，之后由定时器驱动显示。
+    // detached 线程退出时即释放栈，不需要等到下一首歌 join。
+    // 不能在这里再 Reset：播放线程可能已经 Resume 了时钟
+    uint32_t session = lyric_session_;
     
-    // 更新歌曲名称（仅在首次或名称改变时）
-    if (!song_title_display.empty() && song_title_display != last_displayed_song_title_) {
-        last_displayed_song_title_ = song_title_display;
-        app_sched.Schedule([song_title_display]() {
-            auto disp = Board::GetInstance().GetDisplay();
-            if (disp) {
-                disp->SetMusicInfo(song_title_display.c_str());
-            }
-        });
+    auto default_cfg = esp_pthread_get_default_config();
+    esp_pthread_cfg_t lyric_cfg = default_cfg;
+    lyric_cfg.stack_size = 4096;  // 4KB stack cho lyric parsing (cần đủ cho parse file lyrics lớn)
+    lyric_cfg.prio = 4;
+    lyric_cfg.thread_name = "lyric_fetch";
+    esp_pthread_set_cfg(&lyric_cfg);
+    lyric_fetches_++;
+    try {
+        std::thread(&Esp32Music::LyricFetchThread, this, current_lyric_url_, session).detach();
+    } catch (const std::system_error& e) {
+        ESP_LOGE(TAG, "Failed to create lyric fetch thread: %s", e.what());
+        lyric_fetches_--;
     }
+    esp_pthread_set_cfg(&default_cfg);
+}
+
+// 歌词下载线程：下载并编译时间轴后立即退出
+void Esp32Music::LyricFetchThread(std::string lyric_url, uint32_t session) {
+    ESP_LOGI(TAG, "Lyric fetch thread started");
     
-    // 更新歌词（仅在歌词改变时）
-    if (lyric_text != last_displayed_lyric_text_) {
-        last_displayed_lyric_text_ = lyric_text;
-        if (!lyric_text.empty()) {
-            app_sched.Schedule([lyric_text]() {
-                auto disp = Board::GetInstance().GetDisplay();
-                if (disp) {
-                    disp->SetChatMessage("lyric", lyric_text.c_str());
-                }
-            });
-            
-            ESP_LOGD(TAG, "Lyric update at %lldms: %s", 
-                    current_time_ms, lyric_text.c_str());
-        } else {
-            // 如果歌词为空，也更新（清除显示）
-            app_sched.Schedule([]() {
-                auto disp = Board::GetInstance().GetDisplay();
-                if (disp) {
-                    disp->SetChatMessage("lyric", "");
-                }
-            });
+    std::string lyric_content;
+    if (DownloadLyrics(lyric_url, lyric_content)) {
+        if (lyric_scheduler_.Load(lyric_content, session) == 0) {
+            ESP_LOGW(TAG, "No timed lyric lines installed");
         }
+    } else {
+        ESP_LOGE(TAG, "Failed to download lyrics");
     }
     
-    last_display_update_time_ms_ = current_time_ms;
+    lyric_fetches_--;
+    ESP_LOGI(TAG, "Lyric fetch thread finished");
 }
 
 // 删除复杂的认证初始化方法，使用简单的静态函数
@@ -11,6 +11,9 @@
 #include <esp_heap_caps.h>
 
 #include "music.h"
+#include "music_buffer_policy.h"
+#include "beat_tracker.h"
+#include "lyric_scheduler.h"
 
 // 🎵 Custom PSRAM Allocator để std::vector dùng PSRAM thay vì SRAM
 // Giúp tiết kiệm ~10-20KB SRAM khi streaming nhạc
@@ -93,16 +96,9 @@ private:
     
     // 歌词相关
     std::string current_lyric_url_;
-    std::vector<std::pair<int, std::string>> lyrics_;  // 时间戳和歌词文本
-    std::mutex lyrics_mutex_;  // 保护lyrics_数组的互斥锁
-    std::atomic<int> current_lyric_index_;
-    std::thread lyric_thread_;
-    std::atomic<bool> is_lyric_running_;
-    
-    // 显示状态缓存，避免重复更新
-    std::string last_displayed_song_title_;
-    std::string last_displayed_lyric_text_;
-    int64_t last_display_update_time_ms_;  // 上次更新时间，用于throttle
+    LyricScheduler lyric_scheduler_;   // 定时器驱动的歌词时间轴
+    std::atomic<int> lyric_fetches_;   // 进行中的歌词下载线程 (detached)
+    uint32_t lyric_session_ = 0;       // StartStreaming() 为当前歌曲取得的歌词 session
     
     std::atomic<DisplayMode> display_mode_;
     std::atomic<bool> is_playing_;
@@ -120,10 +116,11 @@ private:
     std::mutex buffer_mutex_;
     std::condition_variable buffer_cv_;
     size_t buffer_size_;
-    // Buffer size giảm để tiết kiệm RAM - tối ưu cho ESP32-S3
-    // MAX giảm từ 256KB xuống 48KB, MIN giảm từ 32KB xuống 12KB
+    // Cold-start values used until the first throughput sample arrives;
+    // afterwards buffer_policy_ sizes both from the measured link quality
     static constexpr size_t MAX_BUFFER_SIZE = 48 * 1024;   // 48KB buffer (tối ưu RAM)
     static constexpr size_t MIN_BUFFER_SIZE = 12 * 1024;   // 12KB minimum playback buffer
+    MusicBufferPolicy buffer_policy_;
     
     // MP3解码器相关
     HMP3Decoder mp3_decoder_;
@@ -143,8 +140,15 @@ private:
     Http* active_http_;
     std::mutex http_mutex_;
     
+    // 本地歌曲缓存：Download()命中时直接从Flash播放，未命中时边下边存
+    std::string pending_cache_key_;
+    
+    // 节拍跟踪：分析解码后的单声道PCM，按播放时钟发出节拍事件
+    BeatTracker beat_tracker_;
+    
     // 私有方法
-    void DownloadAudioStream(const std::string& music_url);
+    void DownloadAudioStream(const std::string& music_url, const std::string& cache_key);
+    void ReadCachedAudioStream(const std::string& cache_key);
     void PlayAudioStream();
     void ClearAudioBuffer();
     bool InitializeMp3Decoder();
@@ -160,10 +164,9 @@ private:
     bool IsLikelyAacAdts(const uint8_t* data, size_t size) const;
     
     // 歌词相关私有方法
-    bool DownloadLyrics(const std::string& lyric_url);
-    bool ParseLyrics(const std::string& lyric_content);
-    void LyricDisplayThread();
-    void UpdateLyricDisplay(int64_t current_time_ms);
+    bool DownloadLyrics(const std::string& lyric_url, std::string& lyric_content);
+    void LyricFetchThread(std::string lyric_url, uint32_t session);
+    void StartLyricFetch(const std::string& song_name);
     
     // ID3标签处理
     size_t SkipId3Tag(uint8_t* data, size_t size);
@@ -195,6 +198,13 @@ public:
     // 检查是否正在播放音乐
     bool IsPlaying() const { return is_playing_.load(); }
     
+    // Per-session buffering stats (underruns, rebuffer time, link estimate)
+    std::string GetBufferStatsJson() { return buffer_policy_.GetSessionStatsJson(); }
+    
+    // Beat/tempo events for choreography; callback runs on the decoder thread
+    void SetBeatCallback(BeatTracker::Callback callback) { beat_tracker_.SetCallback(std::move(callback)); }
+    std::string GetBeatStatsJson() { return beat_tracker_.GetStatsJson(); }
+    
     // Get current song info for web UI
     std::string GetCurrentSongName() const { return current_song_name_; }
     std::string GetCurrentArtist() const { return current_artist_; }
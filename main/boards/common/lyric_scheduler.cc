@@ -0,0 +1,326 @@
+#include "lyric_scheduler.h"
+
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+#define TAG "LyricScheduler"
+
+// 定时器可能比目标时间早几百微秒触发，留出容差避免重复装载
+static constexpr int64_t kEarlyToleranceMs = 2;
+
+// 解析 mm:ss / mm:ss.x / mm:ss.xx / mm:ss.xxx (也接受 mm:ss:xx)
+static bool ParseTimestamp(const char* begin, const char* end, int32_t& time_ms) {
+    const char* p = begin;
+    int minutes = 0;
+    int digits = 0;
+    while (p < end && isdigit((unsigned char)*p)) {
+        minutes = minutes * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (digits == 0 || p >= end || *p++ != ':') {
+        return false;
+    }
+
+    int seconds = 0;
+    digits = 0;
+    while (p < end && isdigit((unsigned char)*p)) {
+        seconds = seconds * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    int fraction_ms = 0;
+    if (p < end && (*p == '.' || *p == ':')) {
+        p++;
+        int scale = 100;
+        while (p < end && isdigit((unsigned char)*p)) {
+            fraction_ms += (*p++ - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (p != end) {
+        return false;
+    }
+    time_ms = minutes * 60000 + seconds * 1000 + fraction_ms;
+    return true;
+}
+
+LyricScheduler::LyricScheduler() {
+}
+
+// esp_timer_stop 不会等待已经开始执行的回调。esp_timer 任务按顺序执行回调，
+// 所以等一个立即到期的栅栏定时器跑完，之前派发的回调就一定已经返回
+static void WaitForTimerTask() {
+    if (strcmp(pcTaskGetName(nullptr), "esp_timer") == 0) {
+        return;  // 就在定时器任务里，没有并发的回调
+    }
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (done == nullptr) {
+        return;
+    }
+    const esp_timer_create_args_t fence_args = {
+        .callback = [](void* arg) { xSemaphoreGive(static_cast<SemaphoreHandle_t>(arg)); },
+        .arg = done,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "lyric_fence",
+        .skip_unhandled_events = false,
+    };
+    esp_timer_handle_t fence = nullptr;
+    if (esp_timer_create(&fence_args, &fence) == ESP_OK) {
+        if (esp_timer_start_once(fence, 1) == ESP_OK) {
+            xSemaphoreTake(done, portMAX_DELAY);
+        }
+        esp_timer_delete(fence);
+    }
+    vSemaphoreDelete(done);
+}
+
+LyricScheduler::~LyricScheduler() {
+    {
+        // 停止后仍在等锁的回调看到 running_ == false 直接返回
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        if (timer_) {
+            esp_timer_stop(timer_);
+        }
+    }
+    if (timer_) {
+        WaitForTimerTask();
+        esp_timer_delete(timer_);
+        timer_ = nullptr;
+    }
+}
+
+void LyricScheduler::SetCallback(LineCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+uint32_t LyricScheduler::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timer_) {
+        esp_timer_stop(timer_);
+    }
+    lines_.clear();
+    lines_.shrink_to_fit();
+    text_.clear();
+    text_.shrink_to_fit();
+    cursor_ = -1;
+    running_ = false;
+    anchor_media_ms_ = 0;
+    anchor_us_ = 0;
+    return ++session_;
+}
+
+size_t LyricScheduler::Load(const std::string& lrc, uint32_t session) {
+    std::vector<Line> lines;
+    std::string text;
+    int32_t offset_ms = 0;
+    int32_t stamps[8];
+
+    // 一次遍历完成分行与解析，不产生中间字符串
+    const char* data = lrc.data();
+    const char* data_end = data + lrc.size();
+    while (data < data_end) {
+        const char* line_end = std::find(data, data_end, '\n');
+        const char* p = data;
+        const char* end = line_end;
+        data = line_end < data_end ? line_end + 1 : data_end;
+        if (end > p && end[-1] == '\r') {
+            end--;
+        }
+
+        // 一行可以有多个时间标签: [00:12.00][01:30.00]歌词
+        int stamp_count = 0;
+        while (p < end && *p == '[') {
+            const char* close = std::find(p + 1, end, ']');
+            if (close == end) {
+                break;
+            }
+            int32_t time_ms;
+            if (ParseTimestamp(p + 1, close, time_ms)) {
+                if (stamp_count < (int)(sizeof(stamps) / sizeof(stamps[0]))) {
+                    stamps[stamp_count++] = time_ms;
+                }
+            } else if (close - p > 8 && std::equal(p + 1, p + 8, "offset:")) {
+                // [offset:+500] 正值表示歌词提前显示
+                offset_ms = atoi(std::string(p + 8, close).c_str());
+            } else {
+                ESP_LOGD(TAG, "Skipping tag: %.*s", (int)(close - p + 1), p);
+            }
+            p = close + 1;
+        }
+        if (stamp_count == 0) {
+            continue;
+        }
+
+        uint32_t text_offset = text.size();
+        text.append(p, end);
+        text.push_back('\0');
+        for (int i = 0; i < stamp_count; i++) {
+            lines.push_back({stamps[i], text_offset});
+        }
+    }
+
+    for (auto& line : lines) {
+        line.time_ms = std::max<int32_t>(0, line.time_ms - offset_ms);
+    }
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const Line& a, const Line& b) { return a.time_ms < b.time_ms; });
+    lines.shrink_to_fit();
+    text.shrink_to_fit();
+
+    size_t count = lines.size();
+    size_t text_bytes = text.size();
+    std::string shown;
+    bool changed;
+    LineCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (session != session_) {
+            ESP_LOGI(TAG, "Discarding lyrics for a previous song");
+            return 0;
+        }
+        lines_.swap(lines);
+        text_.swap(text);
+        cursor_ = -1;
+        changed = SeekLocked(NowMediaMsLocked(), shown);
+        ArmLocked();
+        callback = callback_;
+    }
+    ESP_LOGI(TAG, "Compiled %u lyric lines (%u bytes of text)", (unsigned)count, (unsigned)text_bytes);
+    if (changed && callback) {
+        callback(shown);
+    }
+    return count;
+}
+
+void LyricScheduler::Resume(int64_t media_ms) {
+    std::string shown;
+    bool changed;
+    LineCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        anchor_media_ms_ = media_ms;
+        anchor_us_ = esp_timer_get_time();
+        running_ = true;
+        changed = SeekLocked(media_ms, shown);
+        ArmLocked();
+        callback = callback_;
+    }
+    if (changed && callback) {
+        callback(shown);
+    }
+}
+
+void LyricScheduler::Pause() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) {
+        return;
+    }
+    anchor_media_ms_ = NowMediaMsLocked();
+    running_ = false;
+    if (timer_) {
+        esp_timer_stop(timer_);
+    }
+}
+
+void LyricScheduler::Seek(int64_t media_ms) {
+    std::string shown;
+    bool changed;
+    LineCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        anchor_media_ms_ = media_ms;
+        anchor_us_ = esp_timer_get_time();
+        changed = SeekLocked(media_ms, shown);
+        ArmLocked();
+        callback = callback_;
+    }
+    if (changed && callback) {
+        callback(shown);
+    }
+}
+
+size_t LyricScheduler::GetLineCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lines_.size();
+}
+
+void LyricScheduler::TimerCallback(void* arg) {
+    static_cast<LyricScheduler*>(arg)->OnTimer();
+}
+
+void LyricScheduler::OnTimer() {
+    std::string shown;
+    bool changed;
+    LineCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        changed = SeekLocked(NowMediaMsLocked(), shown);
+        ArmLocked();
+        callback = callback_;
+    }
+    if (changed && callback) {
+        callback(shown);
+    }
+}
+
+int64_t LyricScheduler::NowMediaMsLocked() const {
+    if (!running_) {
+        return anchor_media_ms_;
+    }
+    return anchor_media_ms_ + (esp_timer_get_time() - anchor_us_) / 1000;
+}
+
+bool LyricScheduler::SeekLocked(int64_t media_ms, std::string& text) {
+    // 最后一个时间戳 <= media_ms 的行
+    auto it = std::upper_bound(lines_.begin(), lines_.end(), media_ms + kEarlyToleranceMs,
+                               [](int64_t t, const Line& line) { return t < line.time_ms; });
+    int cursor = (int)(it - lines_.begin()) - 1;
+    if (cursor == cursor_) {
+        return false;
+    }
+    // 只有文本偏移变化才算换行（同一句的重复时间标签不重复刷新）
+    bool same_text = cursor >= 0 && cursor_ >= 0 && lines_[cursor].offset == lines_[cursor_].offset;
+    cursor_ = cursor;
+    if (same_text) {
+        return false;
+    }
+    text = cursor >= 0 ? std::string(text_.c_str() + lines_[cursor].offset) : std::string();
+    return true;
+}
+
+void LyricScheduler::ArmLocked() {
+    if (timer_ == nullptr) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = &LyricScheduler::TimerCallback,
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "lyric_line",
+            .skip_unhandled_events = true,
+        };
+        if (esp_timer_create(&timer_args, &timer_) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create lyric timer");
+            timer_ = nullptr;
+            return;
+        }
+    }
+    esp_timer_stop(timer_);
+    if (!running_ || cursor_ + 1 >= (int)lines_.size()) {
+        return;
+    }
+    int64_t delay_ms = lines_[cursor_ + 1].time_ms - NowMediaMsLocked();
+    esp_timer_start_once(timer_, std::max<int64_t>(delay_ms, 1) * 1000);
+}
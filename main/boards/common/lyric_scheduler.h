@@ -0,0 +1,77 @@
+#ifndef LYRIC_SCHEDULER_H
+#define LYRIC_SCHEDULER_H
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <esp_timer.h>
+
+/**
+ * @brief 歌词调度器 - timer-driven LRC lyric timeline
+ *
+ * LRC text is compiled once into a sorted timeline: fixed-size entries
+ * (timestamp + offset) over a single NUL-separated text blob. A cursor points
+ * at the line currently shown, and a one-shot esp_timer is armed for exactly
+ * the next line's timestamp, so nothing runs between lines.
+ *
+ * The playback clock is anchored by the player: Resume() maps a media time to
+ * "now" whenever audio (re)starts, Pause() freezes it on stalls. Seeking is a
+ * binary search of the timeline.
+ */
+class LyricScheduler {
+public:
+    // Runs on the esp_timer task (or the caller of Resume/Seek/Load) - keep it short
+    using LineCallback = std::function<void(const std::string& text)>;
+
+    LyricScheduler();
+    ~LyricScheduler();
+    LyricScheduler(const LyricScheduler&) = delete;
+    LyricScheduler& operator=(const LyricScheduler&) = delete;
+
+    void SetCallback(LineCallback callback);
+
+    // Drop the timeline and stop the clock; returns the session id for Load()
+    uint32_t Reset();
+    // Compile LRC text; ignored if Reset() was called after `session` was issued.
+    // Returns the number of timed lines installed.
+    size_t Load(const std::string& lrc, uint32_t session);
+
+    // Anchor the playback clock: `media_ms` is being heard now
+    void Resume(int64_t media_ms);
+    void Pause();
+    // Jump to `media_ms` (keeps the running/paused state)
+    void Seek(int64_t media_ms);
+
+    size_t GetLineCount();
+
+private:
+    struct Line {
+        int32_t time_ms;
+        uint32_t offset;  // Into text_, NUL-terminated
+    };
+
+    static void TimerCallback(void* arg);
+    void OnTimer();
+    int64_t NowMediaMsLocked() const;
+    // Moves the cursor to `media_ms`; returns true if the shown line changed
+    bool SeekLocked(int64_t media_ms, std::string& text);
+    void ArmLocked();
+
+    std::mutex mutex_;
+    LineCallback callback_;
+    esp_timer_handle_t timer_ = nullptr;
+
+    std::vector<Line> lines_;
+    std::string text_;
+    int cursor_ = -1;  // Line currently shown, -1 = before the first line
+    uint32_t session_ = 0;
+
+    bool running_ = false;
+    int64_t anchor_media_ms_ = 0;
+    int64_t anchor_us_ = 0;
+};
+
+#endif // LYRIC_SCHEDULER_H
@@ -0,0 +1,171 @@
+#include "music_buffer_policy.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <sdkconfig.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#define TAG "MusicBuffer"
+
+#ifndef CONFIG_MUSIC_BUFFER_PSRAM_BUDGET_KB
+#define CONFIG_MUSIC_BUFFER_PSRAM_BUDGET_KB 256
+#endif
+#ifndef CONFIG_MUSIC_BUFFER_TARGET_UNDERRUN_PERMILLE
+#define CONFIG_MUSIC_BUFFER_TARGET_UNDERRUN_PERMILLE 10
+#endif
+
+static constexpr int64_t kWindowUs = 250 * 1000;        // 吞吐量采样窗口
+static constexpr double kEwmaAlpha = 0.2;
+static constexpr double kDefaultConsumptionBps = 16000;  // 128kbps MP3
+static constexpr double kMinStartSeconds = 0.5;          // 最少预缓冲0.5秒音频
+static constexpr double kJitterSeconds = 1.0;            // 抵抗1秒吞吐量抖动
+static constexpr double kPlanningHorizonSeconds = 60.0;  // 链路慢于码率时需覆盖的时长
+static constexpr double kHeadroomSeconds = 4.0;
+static constexpr size_t kMinStartBytes = 8 * 1024;       // 解码器一次需要4KB，至少两块
+
+// 正态分布上分位数 (Abramowitz & Stegun 26.2.23)，|误差| < 4.5e-4
+static float UpperTailZScore(float p) {
+    p = std::clamp(p, 1e-4f, 0.5f);
+    double t = std::sqrt(-2.0 * std::log(p));
+    return (float)(t - (2.515517 + 0.802853 * t + 0.010328 * t * t) /
+                       (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t));
+}
+
+MusicBufferPolicy::MusicBufferPolicy(size_t cold_start_threshold, size_t cold_high_water_mark)
+    : cold_start_threshold_(cold_start_threshold),
+      cold_high_water_mark_(cold_high_water_mark),
+      budget_bytes_((size_t)CONFIG_MUSIC_BUFFER_PSRAM_BUDGET_KB * 1024),
+      z_score_(UpperTailZScore(CONFIG_MUSIC_BUFFER_TARGET_UNDERRUN_PERMILLE / 1000.0f)),
+      start_threshold_(cold_start_threshold),
+      high_water_mark_(cold_high_water_mark) {
+}
+
+void MusicBufferPolicy::BeginSession() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    session_ = SessionStats();
+    session_begin_us_ = esp_timer_get_time();
+    underrun_begin_us_ = 0;
+    started_ = false;
+    window_bytes_ = 0;
+    window_us_ = 0;
+    // 码率因歌而异，链路估计跨歌曲保留
+    consumption_bps_ = 0;
+    RecomputeLocked();
+}
+
+void MusicBufferPolicy::OnDownloadSample(size_t bytes, int64_t elapsed_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_bytes_ += bytes;
+    window_us_ += std::max<int64_t>(elapsed_us, 1);
+    if (window_us_ < kWindowUs) {
+        return;
+    }
+
+    double sample = window_bytes_ * 1000000.0 / window_us_;
+    window_bytes_ = 0;
+    window_us_ = 0;
+    if (!has_estimate_) {
+        mean_bps_ = sample;
+        var_bps_ = 0;
+        has_estimate_ = true;
+    } else {
+        double diff = sample - mean_bps_;
+        mean_bps_ += kEwmaAlpha * diff;
+        var_bps_ = (1.0 - kEwmaAlpha) * (var_bps_ + kEwmaAlpha * diff * diff);
+    }
+    RecomputeLocked();
+}
+
+void MusicBufferPolicy::OnPlaybackProgress(size_t consumed_bytes, int64_t media_ms) {
+    // 前两秒码率估计不稳定（ID3、首帧），先用默认值
+    if (media_ms < 2000) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    consumption_bps_ = consumed_bytes * 1000.0 / media_ms;
+    RecomputeLocked();
+}
+
+void MusicBufferPolicy::RecomputeLocked() {
+    if (!has_estimate_) {
+        start_threshold_ = std::min(cold_start_threshold_, budget_bytes_);
+        high_water_mark_ = std::min(cold_high_water_mark_, budget_bytes_);
+        return;
+    }
+
+    double rate = consumption_bps_ > 0 ? consumption_bps_ : kDefaultConsumptionBps;
+    double stddev = std::sqrt(var_bps_);
+    double pessimistic = std::max(0.0, mean_bps_ - z_score_ * stddev);
+
+    double start = rate * kMinStartSeconds + z_score_ * stddev * kJitterSeconds;
+    if (pessimistic < rate) {
+        // 悲观吞吐量跟不上码率：预先缓冲规划时长内的缺口
+        start += (rate - pessimistic) * kPlanningHorizonSeconds;
+    }
+    double high = std::max(start + rate * kHeadroomSeconds, start * 2);
+
+    high_water_mark_ = std::min((size_t)high, budget_bytes_);
+    start_threshold_ = std::clamp((size_t)start, kMinStartBytes, high_water_mark_ * 3 / 4);
+}
+
+size_t MusicBufferPolicy::StartThreshold() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return start_threshold_;
+}
+
+size_t MusicBufferPolicy::HighWaterMark() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return high_water_mark_;
+}
+
+void MusicBufferPolicy::OnPlaybackStarted() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        started_ = true;
+        session_.startup_ms = (esp_timer_get_time() - session_begin_us_) / 1000;
+    }
+}
+
+void MusicBufferPolicy::OnUnderrun() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (underrun_begin_us_ == 0) {
+        underrun_begin_us_ = esp_timer_get_time();
+        session_.underruns++;
+    }
+}
+
+void MusicBufferPolicy::OnRebuffered() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (underrun_begin_us_ != 0) {
+        session_.rebuffer_ms += (esp_timer_get_time() - underrun_begin_us_) / 1000;
+        underrun_begin_us_ = 0;
+    }
+}
+
+MusicBufferPolicy::SessionStats MusicBufferPolicy::GetSessionStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SessionStats stats = session_;
+    stats.throughput_bps = (uint32_t)mean_bps_;
+    stats.throughput_std_bps = (uint32_t)std::sqrt(var_bps_);
+    stats.consumption_bps = (uint32_t)(consumption_bps_ > 0 ? consumption_bps_ : kDefaultConsumptionBps);
+    stats.start_threshold = start_threshold_;
+    stats.high_water_mark = high_water_mark_;
+    if (underrun_begin_us_ != 0) {
+        stats.rebuffer_ms += (esp_timer_get_time() - underrun_begin_us_) / 1000;
+    }
+    return stats;
+}
+
+std::string MusicBufferPolicy::GetSessionStatsJson() {
+    auto stats = GetSessionStats();
+    char json[256];
+    snprintf(json, sizeof(json),
+             "{\"underruns\":%u,\"rebuffer_ms\":%lld,\"startup_ms\":%lld,\"throughput_bps\":%u,"
+             "\"throughput_std_bps\":%u,\"bitrate_bps\":%u,\"start_kb\":%u,\"high_kb\":%u}",
+             (unsigned)stats.underruns, stats.rebuffer_ms, stats.startup_ms,
+             (unsigned)stats.throughput_bps, (unsigned)stats.throughput_std_bps, (unsigned)stats.consumption_bps,
+             (unsigned)(stats.start_threshold / 1024), (unsigned)(stats.high_water_mark / 1024));
+    return json;
+}
@@ -0,0 +1,84 @@
+#ifndef MUSIC_BUFFER_POLICY_H
+#define MUSIC_BUFFER_POLICY_H
+
+#include <mutex>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 自适应音乐缓冲策略 - sizes the stream buffer from measured link quality
+ *
+ * The download loop reports how long each network read took, the player reports
+ * how many compressed bytes it has consumed per millisecond of audio. From those
+ * the policy keeps an EWMA of throughput and its variance, and sizes:
+ *
+ *  - start threshold: bytes buffered before playback (re)starts
+ *  - high-water mark: bytes buffered before the download loop pauses
+ *
+ * so that the pessimistic throughput (mean - z * stddev, z from the target
+ * underrun probability) can sustain playback, all within a PSRAM budget.
+ */
+class MusicBufferPolicy {
+public:
+    struct SessionStats {
+        uint32_t underruns = 0;
+        int64_t rebuffer_ms = 0;
+        int64_t startup_ms = 0;
+        uint32_t throughput_bps = 0;      // Mean download throughput, bytes/s
+        uint32_t throughput_std_bps = 0;
+        uint32_t consumption_bps = 0;     // Compressed bytes/s consumed by the decoder
+        size_t start_threshold = 0;
+        size_t high_water_mark = 0;
+    };
+
+    MusicBufferPolicy(size_t cold_start_threshold, size_t cold_high_water_mark);
+
+    // Start of a new stream; keeps the link estimate, resets per-session counters
+    void BeginSession();
+
+    // Download thread: one network read of `bytes` that took `elapsed_us`; skip the
+    // first read after a high-water wait, it only drains the socket buffer
+    void OnDownloadSample(size_t bytes, int64_t elapsed_us);
+    // Play thread: total compressed bytes consumed for `media_ms` of decoded audio
+    void OnPlaybackProgress(size_t consumed_bytes, int64_t media_ms);
+
+    void OnPlaybackStarted();
+    void OnUnderrun();
+    void OnRebuffered();
+
+    size_t StartThreshold();
+    size_t HighWaterMark();
+
+    SessionStats GetSessionStats();
+    std::string GetSessionStatsJson();
+
+private:
+    void RecomputeLocked();
+
+    std::mutex mutex_;
+    const size_t cold_start_threshold_;
+    const size_t cold_high_water_mark_;
+    const size_t budget_bytes_;
+    const float z_score_;
+
+    // Throughput estimator (bytes/s), fed in ~250ms windows
+    bool has_estimate_ = false;
+    double mean_bps_ = 0;
+    double var_bps_ = 0;
+    size_t window_bytes_ = 0;
+    int64_t window_us_ = 0;
+
+    double consumption_bps_ = 0;
+
+    size_t start_threshold_;
+    size_t high_water_mark_;
+
+    // Per-session accounting
+    SessionStats session_;
+    int64_t session_begin_us_ = 0;
+    int64_t underrun_begin_us_ = 0;
+    bool started_ = false;
+};
+
+#endif // MUSIC_BUFFER_POLICY_H
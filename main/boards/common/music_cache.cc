@@ -0,0 +1,532 @@
+#include "music_cache.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <esp_partition.h>
+#include <esp_vfs_fat.h>
+#include <mbedtls/sha256.h>
+#include <cJSON.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+
+#define TAG "MusicCache"
+
+#define MUSIC_CACHE_PARTITION   "music"
+#define MUSIC_CACHE_BASE_PATH   "/music"
+#define MUSIC_CACHE_INDEX_PATH  MUSIC_CACHE_BASE_PATH "/index.jsn"
+#define MUSIC_CACHE_INDEX_TMP   MUSIC_CACHE_BASE_PATH "/index.tmp"
+
+// 写入队列深度：每项最多一个4KB下载块，16项约占64KB PSRAM
+static constexpr int kCommandQueueDepth = 16;
+static constexpr uint32_t kWriterStackSize = 4096;
+// 命中只更新内存中的LRU顺序；索引最多每10分钟因命中写一次，其余随下次提交/淘汰写入
+static constexpr int64_t kTouchSaveIntervalUs = 10LL * 60 * 1000 * 1000;
+
+bool MusicCache::Initialize() {
+    if (command_queue_ != nullptr) {
+        return available_;
+    }
+
+    auto partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_FAT, MUSIC_CACHE_PARTITION);
+    if (partition == nullptr) {
+        ESP_LOGI(TAG, "No music partition found, song cache disabled");
+        return false;
+    }
+
+    esp_vfs_fat_mount_config_t mount_config = {};
+    mount_config.format_if_mount_failed = true;
+    mount_config.max_files = 3;  // index + one writer + one reader
+    mount_config.allocation_unit_size = CONFIG_WL_SECTOR_SIZE;
+
+    esp_err_t err = esp_vfs_fat_spiflash_mount_rw_wl(MUSIC_CACHE_BASE_PATH, MUSIC_CACHE_PARTITION, &mount_config, &wl_handle_);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to mount music partition: %s", esp_err_to_name(err));
+        return false;
+    }
+
+    uint64_t total_bytes = 0, free_bytes = 0;
+    if (esp_vfs_fat_info(MUSIC_CACHE_BASE_PATH, &total_bytes, &free_bytes) == ESP_OK) {
+        stats_.capacity_bytes = total_bytes;
+    }
+
+    LoadIndex();
+    RemoveOrphans();
+
+    command_queue_ = xQueueCreate(kCommandQueueDepth, sizeof(Command));
+    if (command_queue_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to create command queue");
+        return false;
+    }
+    // 写Flash时cache会被关闭，任务栈必须位于内部RAM
+    if (xTaskCreate(WriterTask, "music_cache", kWriterStackSize, this, 3, &writer_task_) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create writer task");
+        return false;
+    }
+
+    available_ = true;
+    ESP_LOGI(TAG, "Song cache ready: %u entries, %llu/%llu KB free",
+             (unsigned)entries_.size(), free_bytes / 1024, total_bytes / 1024);
+    return true;
+}
+
+std::string MusicCache::MakeKey(const std::string& song_name, const std::string& artist_name) {
+    // 规范化：小写、合并空白、去首尾空格，使"Baby Shark"和" baby  shark "命中同一条目
+    auto normalize = [](const std::string& in) {
+        std::string out;
+        out.reserve(in.size());
+        bool pending_space = false;
+        for (unsigned char c : in) {
+            if (isspace(c)) {
+                pending_space = !out.empty();
+                continue;
+            }
+            if (pending_space) {
+                out += ' ';
+                pending_space = false;
+            }
+            out += (char)tolower(c);
+        }
+        return out;
+    };
+
+    std::string identity = normalize(song_name) + "\n" + normalize(artist_name);
+    unsigned char hash[32];
+    mbedtls_sha256((const unsigned char*)identity.data(), identity.size(), hash, 0);
+
+    // 8个十六进制字符，满足FAT 8.3文件名限制
+    char key[9];
+    snprintf(key, sizeof(key), "%02x%02x%02x%02x", hash[0], hash[1], hash[2], hash[3]);
+    return key;
+}
+
+bool MusicCache::IsCacheUrl(const std::string& url) {
+    return url.compare(0, strlen(kUrlScheme), kUrlScheme) == 0;
+}
+
+std::string MusicCache::KeyFromUrl(const std::string& url) {
+    return IsCacheUrl(url) ? url.substr(strlen(kUrlScheme)) : std::string();
+}
+
+std::string MusicCache::DataPath(const std::string& key, bool temporary) const {
+    return std::string(MUSIC_CACHE_BASE_PATH "/") + key + (temporary ? ".tmp" : ".bin");
+}
+
+MusicCache::Entry* MusicCache::FindEntryLocked(const std::string& key) {
+    for (auto& entry : entries_) {
+        if (entry.key == key) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool MusicCache::Lookup(const std::string& key, Entry& entry) {
+    if (!available_) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = FindEntryLocked(key);
+        if (found == nullptr) {
+            stats_.misses++;
+            return false;
+        }
+        found->last_used = ++lru_clock_;
+        stats_.hits++;
+        entry = *found;
+    }
+
+    // 持久化LRU顺序交给写入任务，避免在调用者任务里写Flash
+    PostCommand({CommandType::Touch, nullptr, 0, nullptr});
+    return true;
+}
+
+FILE* MusicCache::OpenRead(const std::string& key) {
+    if (!available_) {
+        return nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (FindEntryLocked(key) == nullptr) {
+            return nullptr;
+        }
+        reading_key_ = key;
+    }
+    FILE* file = fopen(DataPath(key, false).c_str(), "rb");
+    if (file == nullptr) {
+        ESP_LOGW(TAG, "Cached file for %s is missing", key.c_str());
+        std::lock_guard<std::mutex> lock(mutex_);
+        reading_key_.clear();
+    }
+    return file;
+}
+
+void MusicCache::CloseRead(FILE* file, size_t bytes_read) {
+    if (file != nullptr) {
+        fclose(file);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    reading_key_.clear();
+    stats_.bytes_saved += bytes_read;
+}
+
+bool MusicCache::PostCommand(const Command& command) {
+    if (command_queue_ == nullptr) {
+        return false;
+    }
+    // 数据块不等待，控制命令最多等待100ms
+    TickType_t wait = command.type == CommandType::Data ? 0 : pdMS_TO_TICKS(100);
+    return xQueueSend(command_queue_, &command, wait) == pdTRUE;
+}
+
+void MusicCache::BeginWrite(const std::string& key, const std::string& title, const std::string& artist,
+                            const std::string& thumbnail, const std::string& lyric_url) {
+    if (!available_ || key.empty()) {
+        return;
+    }
+    auto entry = new Entry();
+    entry->key = key;
+    entry->title = title;
+    entry->artist = artist;
+    entry->thumbnail = thumbnail;
+    entry->lyric_url = lyric_url;
+
+    write_failed_ = false;
+    writing_ = true;
+    if (!PostCommand({CommandType::Begin, nullptr, 0, entry})) {
+        delete entry;
+        writing_ = false;
+    }
+}
+
+void MusicCache::Append(const uint8_t* data, size_t size) {
+    if (!writing_ || write_failed_ || size == 0) {
+        return;
+    }
+    uint8_t* copy = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (copy == nullptr) {
+        write_failed_ = true;
+        return;
+    }
+    memcpy(copy, data, size);
+    if (!PostCommand({CommandType::Data, copy, size, nullptr})) {
+        // 写入跟不上下载速度：放弃缓存这首歌，而不是阻塞播放
+        heap_caps_free(copy);
+        write_failed_ = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.dropped_writes++;
+    }
+}
+
+void MusicCache::CommitWrite() {
+    if (!writing_) {
+        return;
+    }
+    writing_ = false;
+    // 丢过数据块的歌不能入库；在这里决定，下一次BeginWrite重置标志前写入任务可能还没处理到Commit
+    PostCommand({write_failed_ ? CommandType::Abort : CommandType::Commit, nullptr, 0, nullptr});
+}
+
+void MusicCache::AbortWrite() {
+    if (!writing_) {
+        return;
+    }
+    writing_ = false;
+    PostCommand({CommandType::Abort, nullptr, 0, nullptr});
+}
+
+void MusicCache::WriterTask(void* arg) {
+    auto self = static_cast<MusicCache*>(arg);
+    Command command;
+    while (true) {
+        if (xQueueReceive(self->command_queue_, &command, portMAX_DELAY) == pdTRUE) {
+            self->HandleCommand(command);
+        }
+    }
+}
+
+void MusicCache::HandleCommand(Command& command) {
+    switch (command.type) {
+    case CommandType::Begin: {
+        if (write_file_ != nullptr) {
+            fclose(write_file_);
+            write_file_ = nullptr;
+            unlink(DataPath(write_entry_.key, true).c_str());
+        }
+        write_entry_ = *command.entry;
+        write_entry_.size = 0;
+        write_error_ = false;
+        delete command.entry;
+        write_file_ = fopen(DataPath(write_entry_.key, true).c_str(), "wb");
+        if (write_file_ == nullptr) {
+            ESP_LOGW(TAG, "Failed to create cache file for %s", write_entry_.key.c_str());
+            write_error_ = true;
+        }
+        break;
+    }
+    case CommandType::Data: {
+        if (write_file_ != nullptr && !write_error_) {
+            // 单首歌最多占一半容量，防止一首长音频冲掉整个缓存
+            if (stats_.capacity_bytes > 0 && write_entry_.size + command.size > stats_.capacity_bytes / 2) {
+                ESP_LOGI(TAG, "Song %s too large to cache", write_entry_.key.c_str());
+                write_error_ = true;
+            } else {
+                size_t written = fwrite(command.data, 1, command.size, write_file_);
+                while (written < command.size && EvictOne(write_entry_.key)) {
+                    written += fwrite(command.data + written, 1, command.size - written, write_file_);
+                }
+                if (written < command.size) {
+                    ESP_LOGW(TAG, "Cache full, dropping %s", write_entry_.key.c_str());
+                    write_error_ = true;
+                }
+                write_entry_.size += written;
+            }
+        }
+        heap_caps_free(command.data);
+        break;
+    }
+    case CommandType::Commit: {
+        if (write_file_ == nullptr) {
+            break;
+        }
+        fclose(write_file_);
+        write_file_ = nullptr;
+        std::string tmp_path = DataPath(write_entry_.key, true);
+        if (write_error_ || write_entry_.size == 0) {
+            unlink(tmp_path.c_str());
+            break;
+        }
+
+        std::string final_path = DataPath(write_entry_.key, false);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (reading_key_ == write_entry_.key) {
+                // 正在从旧副本播放，保留旧副本
+                unlink(tmp_path.c_str());
+                break;
+            }
+            entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                [this](const Entry& e) { return e.key == write_entry_.key; }), entries_.end());
+        }
+        unlink(final_path.c_str());
+        if (rename(tmp_path.c_str(), final_path.c_str()) != 0) {
+            ESP_LOGW(TAG, "Failed to finalize cache file for %s", write_entry_.key.c_str());
+            unlink(tmp_path.c_str());
+            SaveIndex();
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            write_entry_.last_used = ++lru_clock_;
+            entries_.push_back(write_entry_);
+            stats_.stores++;
+            stats_.bytes_written += write_entry_.size;
+        }
+        SaveIndex();
+        ESP_LOGI(TAG, "Cached %s (%s), %u KB", write_entry_.key.c_str(),
+                 write_entry_.title.c_str(), (unsigned)(write_entry_.size / 1024));
+        break;
+    }
+    case CommandType::Abort:
+        if (write_file_ != nullptr) {
+            fclose(write_file_);
+            write_file_ = nullptr;
+            unlink(DataPath(write_entry_.key, true).c_str());
+        }
+        break;
+    case CommandType::Touch:
+        index_dirty_ = true;
+        if (esp_timer_get_time() - index_saved_us_ >= kTouchSaveIntervalUs) {
+            SaveIndex();
+        }
+        break;
+    }
+}
+
+bool MusicCache::EvictOne(const std::string& protected_key) {
+    Entry victim;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto lru = entries_.end();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->key == protected_key || it->key == reading_key_) {
+                continue;
+            }
+            if (lru == entries_.end() || it->last_used < lru->last_used) {
+                lru = it;
+            }
+        }
+        if (lru == entries_.end()) {
+            return false;
+        }
+        victim = *lru;
+        entries_.erase(lru);
+        stats_.evictions++;
+    }
+
+    unlink(DataPath(victim.key, false).c_str());
+    SaveIndex();
+    ESP_LOGI(TAG, "Evicted %s (%s), %u KB", victim.key.c_str(), victim.title.c_str(), (unsigned)(victim.size / 1024));
+    return true;
+}
+
+void MusicCache::LoadIndex() {
+    FILE* file = fopen(MUSIC_CACHE_INDEX_PATH, "rb");
+    if (file == nullptr) {
+        return;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    std::string content;
+    if (length > 0) {
+        content.resize(length);
+        content.resize(fread(content.data(), 1, length, file));
+    }
+    fclose(file);
+
+    cJSON* root = cJSON_Parse(content.c_str());
+    if (root == nullptr) {
+        ESP_LOGW(TAG, "Cache index is corrupted, starting empty");
+        return;
+    }
+
+    auto get_string = [](cJSON* item, const char* name) {
+        cJSON* value = cJSON_GetObjectItem(item, name);
+        return cJSON_IsString(value) ? std::string(value->valuestring) : std::string();
+    };
+    auto get_number = [](cJSON* item, const char* name) {
+        cJSON* value = cJSON_GetObjectItem(item, name);
+        return cJSON_IsNumber(value) ? (uint32_t)value->valuedouble : 0u;
+    };
+
+    lru_clock_ = get_number(root, "clock");
+    cJSON* items = cJSON_GetObjectItem(root, "entries");
+    cJSON* item = nullptr;
+    cJSON_ArrayForEach(item, items) {
+        Entry entry;
+        entry.key = get_string(item, "k");
+        entry.title = get_string(item, "t");
+        entry.artist = get_string(item, "a");
+        entry.thumbnail = get_string(item, "th");
+        entry.lyric_url = get_string(item, "l");
+        entry.size = get_number(item, "s");
+        entry.last_used = get_number(item, "u");
+
+        // 丢弃掉电时未写完或大小不符的条目
+        struct stat st;
+        if (entry.key.empty() || stat(DataPath(entry.key, false).c_str(), &st) != 0 || (uint32_t)st.st_size != entry.size) {
+            ESP_LOGW(TAG, "Dropping stale cache entry %s", entry.key.c_str());
+            unlink(DataPath(entry.key, false).c_str());
+            continue;
+        }
+        entries_.push_back(entry);
+    }
+    cJSON_Delete(root);
+}
+
+// 掉电留下的.tmp和不在索引里的.bin永远不会被淘汰，加载索引后删掉
+void MusicCache::RemoveOrphans() {
+    DIR* dir = opendir(MUSIC_CACHE_BASE_PATH);
+    if (dir == nullptr) {
+        return;
+    }
+    std::vector<std::string> orphans;
+    struct dirent* item;
+    while ((item = readdir(dir)) != nullptr) {
+        std::string name = item->d_name;
+        if (item->d_type == DT_DIR || strcasecmp(name.c_str(), "index.jsn") == 0) {
+            continue;
+        }
+        size_t dot = name.rfind('.');
+        bool indexed = false;
+        if (dot != std::string::npos && strcasecmp(name.c_str() + dot, ".bin") == 0) {
+            // FAT短文件名可能是大写
+            std::string key = name.substr(0, dot);
+            std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)tolower(c); });
+            indexed = FindEntryLocked(key) != nullptr;
+        }
+        if (!indexed) {
+            orphans.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    for (const auto& name : orphans) {
+        ESP_LOGW(TAG, "Removing orphaned cache file %s", name.c_str());
+        unlink((std::string(MUSIC_CACHE_BASE_PATH "/") + name).c_str());
+    }
+}
+
+void MusicCache::SaveIndex() {
+    cJSON* root = cJSON_CreateObject();
+    cJSON* items = cJSON_AddArrayToObject(root, "entries");
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cJSON_AddNumberToObject(root, "clock", lru_clock_);
+        for (const auto& entry : entries_) {
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "k", entry.key.c_str());
+            cJSON_AddStringToObject(item, "t", entry.title.c_str());
+            cJSON_AddStringToObject(item, "a", entry.artist.c_str());
+            cJSON_AddStringToObject(item, "th", entry.thumbnail.c_str());
+            cJSON_AddStringToObject(item, "l", entry.lyric_url.c_str());
+            cJSON_AddNumberToObject(item, "s", entry.size);
+            cJSON_AddNumberToObject(item, "u", entry.last_used);
+            cJSON_AddItemToArray(items, item);
+        }
+    }
+    char* json = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (json == nullptr) {
+        return;
+    }
+    index_dirty_ = false;
+    index_saved_us_ = esp_timer_get_time();
+
+    // 先写临时文件再替换，避免掉电损坏索引
+    FILE* file = fopen(MUSIC_CACHE_INDEX_TMP, "wb");
+    if (file != nullptr) {
+        size_t length = strlen(json);
+        bool ok = fwrite(json, 1, length, file) == length;
+        fclose(file);
+        if (ok) {
+            unlink(MUSIC_CACHE_INDEX_PATH);
+            rename(MUSIC_CACHE_INDEX_TMP, MUSIC_CACHE_INDEX_PATH);
+        } else {
+            unlink(MUSIC_CACHE_INDEX_TMP);
+        }
+    }
+    cJSON_free(json);
+}
+
+MusicCache::Stats MusicCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    stats.used_bytes = 0;
+    for (const auto& entry : entries_) {
+        stats.used_bytes += entry.size;
+    }
+    return stats;
+}
+
+std::string MusicCache::GetStatsJson() {
+    auto stats = GetStats();
+    uint32_t lookups = stats.hits + stats.misses;
+    char json[256];
+    snprintf(json, sizeof(json),
+             "{\"enabled\":%s,\"hits\":%u,\"misses\":%u,\"hit_rate\":%.2f,\"bytes_saved\":%llu,"
+             "\"entries\":%u,\"used_kb\":%llu,\"capacity_kb\":%llu,\"evictions\":%u}",
+             available_ ? "true" : "false", (unsigned)stats.hits, (unsigned)stats.misses,
+             lookups > 0 ? (double)stats.hits / lookups : 0.0, stats.bytes_saved,
+             (unsigned)stats.entries, stats.used_bytes / 1024, stats.capacity_bytes / 1024,
+             (unsigned)stats.evictions);
+    return json;
+}
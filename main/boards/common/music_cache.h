@@ -0,0 +1,138 @@
+#ifndef MUSIC_CACHE_H
+#define MUSIC_CACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <wear_levelling.h>
+
+/**
+ * @brief 歌曲本地缓存 - Flash-backed LRU cache of recently played songs
+ *
+ * Songs are stored as raw compressed streams (MP3/AAC) on a FAT volume in the
+ * "music" data partition. Entries are keyed by the requested song identity
+ * (normalized song + artist), so a hit plays without any network/TLS at all.
+ *
+ * SPI flash writes must not run on a task whose stack lives in PSRAM (the
+ * audio download thread does), so all writes go through a small writer task
+ * with an internal-RAM stack. If the writer falls behind, the current song is
+ * simply not cached - playback is never throttled by flash.
+ */
+class MusicCache {
+public:
+    struct Entry {
+        std::string key;
+        std::string title;
+        std::string artist;
+        std::string thumbnail;
+        std::string lyric_url;
+        uint32_t size = 0;
+        uint32_t last_used = 0;  // LRU sequence number, higher = more recent
+    };
+
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t stores = 0;
+        uint32_t evictions = 0;
+        uint32_t dropped_writes = 0;
+        uint64_t bytes_saved = 0;     // Bytes served from flash instead of network
+        uint64_t bytes_written = 0;
+        uint32_t entries = 0;
+        uint64_t used_bytes = 0;
+        uint64_t capacity_bytes = 0;
+    };
+
+    static constexpr const char* kUrlScheme = "cache://";
+
+    static MusicCache& GetInstance() {
+        static MusicCache instance;
+        return instance;
+    }
+
+    // Mount the "music" partition and start the writer task. Safe to call more than once.
+    bool Initialize();
+    bool IsAvailable() const { return available_; }
+
+    static std::string MakeKey(const std::string& song_name, const std::string& artist_name);
+    static bool IsCacheUrl(const std::string& url);
+    static std::string KeyFromUrl(const std::string& url);
+
+    // Lookup counts toward the hit/miss statistics
+    bool Lookup(const std::string& key, Entry& entry);
+
+    // Read side - must be called from a task with an internal-RAM stack
+    FILE* OpenRead(const std::string& key);
+    void CloseRead(FILE* file, size_t bytes_read);
+
+    // Write-through side - may be called from any task
+    void BeginWrite(const std::string& key, const std::string& title, const std::string& artist,
+                    const std::string& thumbnail, const std::string& lyric_url);
+    void Append(const uint8_t* data, size_t size);
+    void CommitWrite();
+    void AbortWrite();
+
+    Stats GetStats();
+    std::string GetStatsJson();
+
+private:
+    MusicCache() = default;
+    ~MusicCache() = default;
+    MusicCache(const MusicCache&) = delete;
+    MusicCache& operator=(const MusicCache&) = delete;
+
+    enum class CommandType : uint8_t {
+        Begin,
+        Data,
+        Commit,
+        Abort,
+        Touch,
+    };
+
+    struct Command {
+        CommandType type;
+        uint8_t* data;   // PSRAM copy for Data commands
+        size_t size;
+        Entry* entry;    // Owned metadata for Begin commands
+    };
+
+    static void WriterTask(void* arg);
+    void HandleCommand(Command& command);
+    bool PostCommand(const Command& command);
+
+    void LoadIndex();
+    void RemoveOrphans();
+    void SaveIndex();
+    bool EvictOne(const std::string& protected_key);
+    std::string DataPath(const std::string& key, bool temporary) const;
+    Entry* FindEntryLocked(const std::string& key);
+
+    std::atomic<bool> available_{false};
+    std::atomic<bool> writing_{false};
+    std::atomic<bool> write_failed_{false};  // Producer side: a chunk of the current write was lost
+    wl_handle_t wl_handle_ = WL_INVALID_HANDLE;
+    QueueHandle_t command_queue_ = nullptr;
+    TaskHandle_t writer_task_ = nullptr;
+
+    std::mutex mutex_;  // Guards entries_, stats_, lru_clock_ and reading_key_
+    std::vector<Entry> entries_;
+    std::string reading_key_;  // Never evicted while being played
+    Stats stats_;
+    uint32_t lru_clock_ = 0;
+
+    // Writer task state
+    FILE* write_file_ = nullptr;
+    Entry write_entry_;
+    bool write_error_ = false;     // The write being handled can't be committed
+    bool index_dirty_ = false;     // LRU order changed since the index was saved
+    int64_t index_saved_us_ = 0;
+};
+
+#endif // MUSIC_CACHE_H
@@ -0,0 +1,314 @@
+#include "oscillator.h"
+
+#include <driver/ledc.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+
+#define SINE_TABLE_BITS 10
+#define SINE_TABLE_SIZE (1 << SINE_TABLE_BITS)
+
+namespace {
+
+// One full turn plus a guard entry so interpolation never wraps
+struct SineTable {
+    int16_t values[SINE_TABLE_SIZE + 1];
+
+    SineTable() {
+        for (int i = 0; i <= SINE_TABLE_SIZE; i++) {
+            long v = std::lround(std::sin(2 * M_PI * i / SINE_TABLE_SIZE) * 32768);
+            values[i] = (int16_t)std::max(-32767L, std::min(32767L, v));
+        }
+    }
+};
+
+const SineTable& GetSineTable() {
+    static const SineTable table;
+    return table;
+}
+
+// sin(phase) in Q15, phase in turns (2^64 = one turn)
+inline int32_t SineQ15(const SineTable& table, uint64_t phase) {
+    uint32_t index = (uint32_t)(phase >> (64 - SINE_TABLE_BITS));
+    int32_t frac = (int32_t)((phase >> (48 - SINE_TABLE_BITS)) & 0xFFFF);
+    int32_t a = table.values[index];
+    int32_t b = table.values[index + 1];
+    return a + (((b - a) * frac) >> 16);
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////
+//-- SHARED SAMPLING TIMER --------------------------------------//
+///////////////////////////////////////////////////////////////////
+class OscillatorGroup {
+public:
+    static OscillatorGroup& GetInstance() {
+        static OscillatorGroup instance;
+        return instance;
+    }
+
+    void Start(Oscillator* oscillators, int count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (timer_ == nullptr) {
+            esp_timer_create_args_t timer_args = {
+                .callback = [](void* arg) { static_cast<OscillatorGroup*>(arg)->Tick(); },
+                .arg = this,
+                .dispatch_method = ESP_TIMER_TASK,
+                .name = "oscillator",
+                .skip_unhandled_events = true,
+            };
+            ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer_));
+        }
+        if (running_) {
+            esp_timer_stop(timer_);
+            running_ = false;
+        }
+
+        count_ = 0;
+        for (int i = 0; i < count && count_ < OSCILLATOR_MAX_CHANNELS; i++) {
+            if (oscillators[i].is_attached_) {
+                members_[count_++] = &oscillators[i];
+            }
+        }
+        if (count_ == 0) {
+            return;
+        }
+
+        // First sample right away, like the first Refresh() of the old polling loops
+        TickLocked();
+        ESP_ERROR_CHECK(esp_timer_start_periodic(timer_, OSCILLATOR_SAMPLING_PERIOD_MS * 1000));
+        running_ = true;
+    }
+
+    void Stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            esp_timer_stop(timer_);
+            running_ = false;
+        }
+        count_ = 0;
+    }
+
+    void Remove(Oscillator* oscillator) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int kept = 0;
+        for (int i = 0; i < count_; i++) {
+            if (members_[i] != oscillator) {
+                members_[kept++] = members_[i];
+            }
+        }
+        count_ = kept;
+    }
+
+private:
+    void Tick() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TickLocked();
+    }
+
+    // All channels sample the same tick; duties are latched only once every
+    // channel has its new value
+    void TickLocked() {
+        bool written[OSCILLATOR_MAX_CHANNELS];
+        for (int i = 0; i < count_; i++) {
+            Oscillator* oscillator = members_[i];
+            int position = oscillator->NextSample();
+            written[i] = !oscillator->stop_;
+            if (written[i]) {
+                oscillator->SetDuty(position);
+            }
+        }
+        for (int i = 0; i < count_; i++) {
+            if (written[i]) {
+                members_[i]->UpdateDuty();
+            }
+        }
+    }
+
+    std::mutex mutex_;
+    esp_timer_handle_t timer_ = nullptr;
+    bool running_ = false;
+    Oscillator* members_[OSCILLATOR_MAX_CHANNELS];
+    int count_ = 0;
+};
+
+void Oscillator::StartGroup(Oscillator* oscillators, int count) {
+    OscillatorGroup::GetInstance().Start(oscillators, count);
+}
+
+void Oscillator::StopGroup() {
+    OscillatorGroup::GetInstance().Stop();
+}
+
+static long CurrentMillis() {
+    return (long)(esp_timer_get_time() / 1000);
+}
+
+///////////////////////////////////////////////////////////////////
+//-- OSCILLATOR -------------------------------------------------//
+///////////////////////////////////////////////////////////////////
+Oscillator::Oscillator(int trim) {
+    trim_ = trim;
+    diff_limit_ = 0;
+    is_attached_ = false;
+
+    amplitude_ = 45;
+    phase_ = 0;
+    offset_ = 0;
+    stop_ = false;
+    rev_ = false;
+
+    SetT(2000);
+    SetPh(0);
+
+    pos_ = 90;
+}
+
+Oscillator::~Oscillator() {
+    Detach();
+}
+
+uint32_t Oscillator::AngleToCompare(int angle) {
+    return (angle - SERVO_MIN_DEGREE) * (SERVO_MAX_PULSEWIDTH_US - SERVO_MIN_PULSEWIDTH_US) /
+               (SERVO_MAX_DEGREE - SERVO_MIN_DEGREE) +
+           SERVO_MIN_PULSEWIDTH_US;
+}
+
+void Oscillator::Attach(int pin, bool rev) {
+    if (is_attached_) {
+        Detach();
+    }
+
+    pin_ = pin;
+    rev_ = rev;
+
+    ledc_timer_config_t ledc_timer = {.speed_mode = LEDC_LOW_SPEED_MODE,
+                                      .duty_resolution = LEDC_TIMER_13_BIT,
+                                      .timer_num = LEDC_TIMER_1,
+                                      .freq_hz = 50,
+                                      .clk_cfg = LEDC_AUTO_CLK};
+    ESP_ERROR_CHECK(ledc_timer_config(&ledc_timer));
+
+    static int last_channel = 0;
+    last_channel = (last_channel + 1) % 7 + 1;
+    ledc_channel_ = (ledc_channel_t)last_channel;
+
+    ledc_channel_config_t ledc_channel = {.gpio_num = pin_,
+                                          .speed_mode = LEDC_LOW_SPEED_MODE,
+                                          .channel = ledc_channel_,
+                                          .intr_type = LEDC_INTR_DISABLE,
+                                          .timer_sel = LEDC_TIMER_1,
+                                          .duty = 0,
+                                          .hpoint = 0};
+    ESP_ERROR_CHECK(ledc_channel_config(&ledc_channel));
+
+    ledc_speed_mode_ = LEDC_LOW_SPEED_MODE;
+
+    // pos_ = 90;
+    // Write(pos_);
+    previous_servo_command_millis_ = CurrentMillis();
+
+    is_attached_ = true;
+}
+
+void Oscillator::Detach() {
+    if (!is_attached_)
+        return;
+
+    OscillatorGroup::GetInstance().Remove(this);
+    ESP_ERROR_CHECK(ledc_stop(ledc_speed_mode_, ledc_channel_, 0));
+
+    is_attached_ = false;
+}
+
+void Oscillator::SetT(unsigned int T) {
+    period_ = T;
+
+    // Integer division on purpose, the old double version truncated the same way
+    number_samples_ = std::max(1u, period_ / OSCILLATOR_SAMPLING_PERIOD_MS);
+    // Round(2^64 / number_samples_)
+    uint64_t quotient = UINT64_MAX / number_samples_;
+    uint64_t remainder = UINT64_MAX % number_samples_ + 1;
+    inc_ = quotient + (remainder * 2 >= number_samples_ ? 1 : 0);
+}
+
+void Oscillator::SetPh(double Ph) {
+    phase0_ = Ph;
+
+    double turns = Ph / (2 * M_PI);
+    turns -= std::floor(turns);
+    double scaled = std::ldexp(turns, 64);
+    phase0_turns_ = scaled >= 18446744073709551615.0 ? 0 : (uint64_t)scaled;
+}
+
+void Oscillator::SetPosition(int position) {
+    Write(position);
+}
+
+int Oscillator::NextSample() {
+    const SineTable& table = GetSineTable();
+    uint64_t phase = phase_ + phase0_turns_;
+
+    // A * sin + O in Q15 degrees
+    int64_t value = (int64_t)amplitude_ * SineQ15(table, phase) + ((int64_t)offset_ << 15);
+    int64_t magnitude = value < 0 ? -value : value;
+    int pos = (int)((magnitude + 0x4000) >> 15);
+    if (value < 0)
+        pos = -pos;
+
+    phase_ += inc_;
+
+    if (rev_)
+        pos = -pos;
+    return pos + 90;
+}
+
+void Oscillator::Refresh() {
+    int position = NextSample();
+    if (!stop_) {
+        Write(position);
+    }
+}
+
+void Oscillator::Write(int position) {
+    SetDuty(position);
+    UpdateDuty();
+}
+
+void Oscillator::SetDuty(int position) {
+    if (!is_attached_)
+        return;
+
+    long currentMillis = CurrentMillis();
+    if (diff_limit_ > 0) {
+        int limit = std::max(
+            1, (((int)(currentMillis - previous_servo_command_millis_)) * diff_limit_) / 1000);
+        if (abs(position - pos_) > limit) {
+            pos_ += position < pos_ ? -limit : limit;
+        } else {
+            pos_ = position;
+        }
+    } else {
+        pos_ = position;
+    }
+    previous_servo_command_millis_ = currentMillis;
+
+    int angle = pos_ + trim_;
+
+    angle = std::min(std::max(angle, 0), 180);
+
+    uint32_t duty = (uint32_t)(((angle / 180.0) * 2.0 + 0.5) * 8191 / 20.0);
+
+    ESP_ERROR_CHECK(ledc_set_duty(ledc_speed_mode_, ledc_channel_, duty));
+}
+
+void Oscillator::UpdateDuty() {
+    if (!is_attached_)
+        return;
+
+    ESP_ERROR_CHECK(ledc_update_duty(ledc_speed_mode_, ledc_channel_));
+}
@@ -6,7 +6,11 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include <cstdint>
+
+#ifndef M_PI
 #define M_PI 3.14159265358979323846
+#endif
 
 #ifndef DEG2RAD
 #define DEG2RAD(g) ((g) * M_PI) / 180
@@ -19,6 +23,14 @@
 #define SERVO_TIMEBASE_RESOLUTION_HZ 1000000  // 1MHz, 1us per tick
 #define SERVO_TIMEBASE_PERIOD 20000           // 20000 ticks, 20ms
 
+#define OSCILLATOR_SAMPLING_PERIOD_MS 30      // 振荡采样周期，所有舵机共用一个定时器
+#define OSCILLATOR_MAX_CHANNELS 8             // 同时振荡的舵机数上限（LEDC 通道数）
+
+//-- Servo driver + sine oscillator shared by the kiki, otto-robot and electron-bot boards.
+//-- The waveform is A * sin(phase + Ph) + O sampled every OSCILLATOR_SAMPLING_PERIOD_MS,
+//-- computed from a Q15 sine table and a fixed-point phase accumulator instead of
+//-- double/std::sin, so a tick costs no double math on the S3. A sample within about
+//-- A * 2^-14 degrees of x.5 may round one degree off the old floating point version.
 class Oscillator {
 public:
     Oscillator(int trim = 0);
@@ -28,7 +40,7 @@ public:
 
     void SetA(unsigned int amplitude) { amplitude_ = amplitude; };
     void SetO(int offset) { offset_ = offset; };
-    void SetPh(double Ph) { phase0_ = Ph; };
+    void SetPh(double Ph);
     void SetT(unsigned int period);
     void SetTrim(int trim) { trim_ = trim; };
     void SetLimiter(int diff_limit) { diff_limit_ = diff_limit; };
@@ -37,13 +49,25 @@ public:
     void SetPosition(int position);
     void Stop() { stop_ = true; };
     void Play() { stop_ = false; };
-    void Reset() { phase_ = 0; };
-    void Refresh();
+    void Reset() {
+        phase_ = 0;
+    };
+    void Refresh();  // Takes one sample now; normally the shared timer does this
     int GetPosition() { return pos_; }
 
+    //-- Oscillates the attached servos in `oscillators` from one periodic timer:
+    //-- every channel samples on the same tick and the duties are latched together,
+    //-- so legs cannot drift apart. Replaces any group already running.
+    static void StartGroup(Oscillator* oscillators, int count);
+    static void StopGroup();
+
 private:
-    bool NextSample();
+    friend class OscillatorGroup;
+
+    int NextSample();
     void Write(int position);
+    void SetDuty(int position);
+    void UpdateDuty();
     uint32_t AngleToCompare(int angle);
 
 private:
@@ -59,13 +83,10 @@ private:
     int pos_;                       //-- Current servo pos
     int pin_;                       //-- Pin where the servo is connected
     int trim_;                      //-- Calibration offset
-    double phase_;                  //-- Current phase
-    double inc_;                    //-- Increment of phase
-    double number_samples_;         //-- Number of samples
-    unsigned int sampling_period_;  //-- sampling period (ms)
-
-    long previous_millis_;
-    long current_millis_;
+    uint64_t phase_;                //-- Current phase, one turn = 2^64
+    uint64_t phase0_turns_;         //-- phase0_ in the same unit
+    uint64_t inc_;                  //-- Increment of phase per sample
+    unsigned int number_samples_;   //-- Number of samples per period
 
     //-- Oscillation mode. If true, the servo is stopped
     bool stop_;
@@ -0,0 +1,86 @@
+#include "servo_trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Min-jerk peaks relative to the average: speed 1.875 D/T, acceleration 10/sqrt(3) D/T^2
+#define MIN_JERK_PEAK_SPEED 1.875
+#define MIN_JERK_PEAK_ACCEL 5.7735026919
+
+float TrajectoryProgress(TrajectoryProfile profile, float u, int accel_percent) {
+    if (u <= 0) {
+        return 0;
+    }
+    if (u >= 1) {
+        return 1;
+    }
+
+    switch (profile) {
+        case TRAJECTORY_MIN_JERK:
+            return u * u * u * (10 + u * (-15 + 6 * u));
+        case TRAJECTORY_TRAPEZOID: {
+            float r = std::max(1, std::min(accel_percent, 50)) / 100.0f;
+            float scale = 1 / (2 * r * (1 - r));
+            if (u < r) {
+                return u * u * scale;
+            }
+            if (u <= 1 - r) {
+                return (u - r / 2) / (1 - r);
+            }
+            float v = 1 - u;
+            return 1 - v * v * scale;
+        }
+        default:
+            return u;
+    }
+}
+
+TrajectoryPlan PlanTrajectory(TrajectoryProfile profile, const int* from, const int* to,
+                              const JointLimits* limits, int count, uint32_t min_duration_ms) {
+    // Every joint shares the shape, so only the tightest ratios matter:
+    // speed_time = D / max_speed (s), accel_time2 = D / max_accel (s^2)
+    double speed_time = 0;
+    double accel_time2 = 0;
+    for (int i = 0; limits != nullptr && i < count; i++) {
+        double distance = std::abs(to[i] - from[i]);
+        if (distance == 0) {
+            continue;
+        }
+        if (limits[i].max_speed > 0) {
+            speed_time = std::max(speed_time, distance / limits[i].max_speed);
+        }
+        if (limits[i].max_accel > 0) {
+            accel_time2 = std::max(accel_time2, distance / limits[i].max_accel);
+        }
+    }
+
+    TrajectoryPlan plan;
+    double t = min_duration_ms / 1000.0;
+    switch (profile) {
+        case TRAJECTORY_MIN_JERK:
+            t = std::max({t, MIN_JERK_PEAK_SPEED * speed_time, std::sqrt(MIN_JERK_PEAK_ACCEL * accel_time2)});
+            break;
+        case TRAJECTORY_TRAPEZOID: {
+            // Time-optimal: cruise at the speed limit if the distance allows it, else a triangle
+            double fastest = accel_time2 >= speed_time * speed_time ? 2 * std::sqrt(accel_time2)
+                                                                    : speed_time + accel_time2 / speed_time;
+            t = std::max(t, fastest);
+            // With slack, take the longest acceleration phase the speed limit allows: gentler on the chassis
+            double r = speed_time > 0 ? std::min(0.5, 1 - speed_time / t) : 0.5;
+            int percent = std::max(1, std::min((int)std::floor(r * 100), 50));
+            r = percent / 100.0;
+            // Whole percents can cost a little acceleration margin, stretch to get it back
+            t = std::max(t, speed_time / (1 - r));
+            t = std::max(t, std::sqrt(accel_time2 / (r * (1 - r))));
+            plan.accel_percent = (uint8_t)percent;
+            break;
+        }
+        default:
+            // Acceleration is unbounded at the ends of a linear move, only speed applies
+            t = std::max(t, speed_time);
+            break;
+    }
+    plan.duration_ms = (uint32_t)std::ceil(t * 1000 - 1e-6);
+    return plan;
+}
@@ -0,0 +1,40 @@
+#ifndef SERVO_TRAJECTORY_H
+#define SERVO_TRAJECTORY_H
+
+#include <cstdint>
+
+/**
+ * @brief 舵机轨迹规划 - point-to-point profiles with per-joint speed/accel limits
+ *
+ * A move from `from` to `to` over T ms puts every joint at
+ * from + (to - from) * TrajectoryProgress(profile, t / T). All joints of one
+ * move share T and the profile shape, so they start, peak and land together;
+ * T comes from whichever joint is closest to its speed or acceleration limit.
+ *
+ * Plain C++ with no ESP-IDF dependency, the host motion simulator links it as-is.
+ */
+enum TrajectoryProfile : uint8_t {
+    TRAJECTORY_LINEAR = 0,  // Constant speed, what the old step loops did
+    TRAJECTORY_MIN_JERK,    // 10u^3 - 15u^4 + 6u^5: zero speed and acceleration at both ends
+    TRAJECTORY_TRAPEZOID,   // Constant acceleration, cruise, constant deceleration
+};
+
+struct JointLimits {
+    float max_speed = 0;  // deg/s, <= 0: unlimited
+    float max_accel = 0;  // deg/s^2, <= 0: unlimited
+};
+
+struct TrajectoryPlan {
+    uint32_t duration_ms = 0;
+    uint8_t accel_percent = 50;  // Trapezoid: share of the move spent accelerating (and again braking), 1..50
+};
+
+// Progress 0..1 at normalized time u (clamped to 0..1)
+float TrajectoryProgress(TrajectoryProfile profile, float u, int accel_percent = 50);
+
+// Shortest synchronized move of `count` joints that keeps each one within its
+// limits, never shorter than min_duration_ms. limits may be null (no limits).
+TrajectoryPlan PlanTrajectory(TrajectoryProfile profile, const int* from, const int* to,
+                              const JointLimits* limits, int count, uint32_t min_duration_ms);
+
+#endif  // SERVO_TRAJECTORY_H
@@ -119,6 +119,8 @@ void SleepTimer::CheckTimer() {
             on_enter_deep_sleep_mode_();
         }
 
+        // 深度睡眠不会调用 shutdown handler，先提交缓存中的设置
+        Settings::Flush();
         esp_deep_sleep_start();
     }
 }
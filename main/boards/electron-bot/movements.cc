@@ -1,9 +1,11 @@
 #include "movements.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 
 #include "oscillator.h"
+#include "servo_trajectory.h"
 
 Otto::Otto() {
     is_otto_resting_ = false;
@@ -80,19 +82,22 @@ void Otto::MoveServos(int time, int servo_target[]) {
         SetRestState(false);
     }
 
-    final_time_ = millis() + time;
     if (time > 10) {
+        // Min-jerk from the start pose instead of adding float increments to the int
+        // position: those were truncated, so sub-degree steps upwards never moved
+        int start[SERVO_COUNT];
         for (int i = 0; i < SERVO_COUNT; i++) {
-            if (servo_pins_[i] != -1) {
-                increment_[i] = (servo_target[i] - servo_[i].GetPosition()) / (time / 10.0);
-            }
+            start[i] = servo_[i].GetPosition();
         }
 
-        for (int iteration = 1; millis() < final_time_; iteration++) {
-            partial_time_ = millis() + 10;
+        unsigned long start_time = millis();
+        unsigned long elapsed;
+        while ((elapsed = millis() - start_time) < (unsigned long)time) {
+            // Pose for the end of this 10 ms step, like the old increments
+            float progress = TrajectoryProgress(TRAJECTORY_MIN_JERK, (float)(elapsed + 10) / time);
             for (int i = 0; i < SERVO_COUNT; i++) {
                 if (servo_pins_[i] != -1) {
-                    servo_[i].SetPosition(servo_[i].GetPosition() + increment_[i]);
+                    servo_[i].SetPosition(start[i] + (int)std::lround((servo_target[i] - start[i]) * progress));
                 }
             }
             vTaskDelay(pdMS_TO_TICKS(10));
@@ -155,17 +160,10 @@ void Otto::OscillateServos(int amplitude[SERVO_COUNT], int offset[SERVO_COUNT],
         }
     }
 
-    double ref = millis();
-    double end_time = period * cycle + ref;
-
-    while (millis() < end_time) {
-        for (int i = 0; i < SERVO_COUNT; i++) {
-            if (servo_pins_[i] != -1) {
-                servo_[i].Refresh();
-            }
-        }
-        vTaskDelay(5);
-    }
+    // All servos sample on the shared oscillator timer tick
+    Oscillator::StartGroup(servo_, SERVO_COUNT);
+    vTaskDelay(pdMS_TO_TICKS(period * cycle));
+    Oscillator::StopGroup();
     vTaskDelay(pdMS_TO_TICKS(10));
 }
 
@@ -76,10 +76,6 @@ private:
     int servo_trim_[SERVO_COUNT];
     int servo_initial_[SERVO_COUNT] = {180, 180, 0, 0, 90, 90};
 
-    unsigned long final_time_;
-    unsigned long partial_time_;
-    float increment_[SERVO_COUNT];
-
     bool is_otto_resting_;
 
     void Execute(int amplitude[SERVO_COUNT], int offset[SERVO_COUNT], int period,
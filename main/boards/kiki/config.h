@@ -52,6 +52,10 @@
 #define DISPLAY_BACKLIGHT_OUTPUT_INVERT false
 #define DISPLAY_SPI_MODE 3
 
+// LVGL render strategy: full-screen GIF emojis need rendering to overlap the SPI DMA flush
+#define DISPLAY_RENDER_DOUBLE_BUFFER true
+#define DISPLAY_RENDER_BUFFER_LINES 40
+
 #define BOOT_BUTTON_GPIO GPIO_NUM_0
 
 // 8-bit WS2812 LED strip (8 LEDs)
@@ -0,0 +1,107 @@
+#include "draw_tile_decoder.h"
+
+#include <algorithm>
+
+DrawTileDecoder::DrawTileDecoder(Format format, const DrawTile& tile)
+    : format_(format), tile_(tile), remaining_pixels_((uint32_t)tile.w * tile.h) {
+    // Raw là một literal dài bằng cả tile
+    if (format_ == Format::kRaw) {
+        state_ = State::kLiteral;
+        run_ = remaining_pixels_;
+    }
+}
+
+void DrawTileDecoder::Advance(uint32_t count) {
+    remaining_pixels_ -= count;
+    col_ += count % tile_.w;
+    row_ += count / tile_.w;
+    if (col_ >= tile_.w) {
+        col_ -= tile_.w;
+        row_++;
+    }
+}
+
+void DrawTileDecoder::Put(uint16_t color, uint16_t* canvas, int stride_px) {
+    int y = tile_.y + row_;
+    canvas[y * stride_px + tile_.x + col_] = color;
+    touched_first_ = std::min(touched_first_, y);
+    touched_last_ = std::max(touched_last_, y);
+    pixels_written_++;
+    Advance(1);
+}
+
+bool DrawTileDecoder::ProcessWord(uint16_t word, uint16_t* canvas, int stride_px) {
+    switch (state_) {
+    case State::kOpcode: {
+        uint32_t count = word & kCountMask;
+        if (count == 0 || count > remaining_pixels_) {
+            return false;
+        }
+        switch (word & kOpMask) {
+        case kOpLiteral:
+            state_ = State::kLiteral;
+            run_ = count;
+            return true;
+        case kOpFill:
+            state_ = State::kFillColor;
+            run_ = count;
+            return true;
+        case kOpSkip:
+            Advance(count);
+            return true;
+        default:
+            return false;
+        }
+    }
+    case State::kLiteral:
+        if (remaining_pixels_ == 0) {
+            return false;
+        }
+        Put(word, canvas, stride_px);
+        if (--run_ == 0) {
+            state_ = State::kOpcode;
+        }
+        return true;
+    case State::kFillColor:
+        // Tô theo từng đoạn hàng thay vì từng pixel
+        while (run_ > 0) {
+            uint32_t n = std::min<uint32_t>(run_, tile_.w - col_);
+            int y = tile_.y + row_;
+            uint16_t* dst = canvas + y * stride_px + tile_.x + col_;
+            std::fill(dst, dst + n, word);
+            touched_first_ = std::min(touched_first_, y);
+            touched_last_ = std::max(touched_last_, y);
+            pixels_written_ += n;
+            run_ -= n;
+            Advance(n);
+        }
+        state_ = State::kOpcode;
+        return true;
+    }
+    return false;
+}
+
+bool DrawTileDecoder::Feed(const uint8_t* data, size_t len, uint16_t* canvas, int stride_px, int* first_row,
+                           int* last_row) {
+    touched_first_ = tile_.y + tile_.h;
+    touched_last_ = -1;
+    bool ok = true;
+
+    size_t i = 0;
+    if (has_carry_ && len > 0) {
+        has_carry_ = false;
+        ok = ProcessWord(carry_ | (data[0] << 8), canvas, stride_px);
+        i = 1;
+    }
+    for (; ok && i + 1 < len; i += 2) {
+        ok = ProcessWord(data[i] | (data[i + 1] << 8), canvas, stride_px);
+    }
+    if (ok && i < len) {
+        carry_ = data[i];
+        has_carry_ = true;
+    }
+
+    *first_row = touched_first_;
+    *last_row = touched_last_;
+    return ok;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Vùng chữ nhật trên canvas vẽ (pixel)
+ */
+struct DrawTile {
+    int x = 0;
+    int y = 0;
+    int w = 0;
+    int h = 0;
+};
+
+/**
+ * @brief Giải mã body upload của /draw theo luồng, ghi thẳng vào buffer canvas RGB565.
+ *
+ * - kRaw: w*h pixel RGB565 little-endian (định dạng cũ của /draw)
+ * - kRle: chuỗi word u16 little-endian cùng opcode với RLE565 của .anim
+ *   (0x0000|n: n pixel literal, 0x4000|n + màu: tô n pixel, 0x8000|n: bỏ qua n pixel),
+ *   chạy liên tục qua các hàng của tile. Skip giữ nguyên pixel cũ nên client chỉ
+ *   cần gửi phần thay đổi.
+ *
+ * Chunk mạng có thể cắt ngang pixel/opcode bất kỳ, phần dư được giữ tới lần Feed() sau.
+ * Không cấp phát, không cần LVGL; caller giữ khóa màn hình trong lúc Feed().
+ */
+class DrawTileDecoder {
+public:
+    enum class Format { kRaw, kRle };
+
+    DrawTileDecoder(Format format, const DrawTile& tile);
+
+    /**
+     * @brief Giải mã `len` byte vào `canvas` (stride_px pixel mỗi hàng)
+     * @param first_row, last_row Các hàng canvas đã ghi trong lần gọi này (first > last nếu không ghi gì)
+     * @return false nếu dữ liệu hỏng hoặc vượt quá tile
+     */
+    bool Feed(const uint8_t* data, size_t len, uint16_t* canvas, int stride_px, int* first_row, int* last_row);
+
+    // Đã phủ hết w*h pixel của tile
+    bool Done() const { return remaining_pixels_ == 0 && state_ == State::kOpcode && !has_carry_; }
+    uint32_t pixels_written() const { return pixels_written_; }
+
+    static constexpr uint16_t kOpMask = 0xC000;
+    static constexpr uint16_t kCountMask = 0x3FFF;
+    static constexpr uint16_t kOpLiteral = 0x0000;
+    static constexpr uint16_t kOpFill = 0x4000;
+    static constexpr uint16_t kOpSkip = 0x8000;
+
+private:
+    enum class State { kOpcode, kLiteral, kFillColor };
+
+    bool ProcessWord(uint16_t word, uint16_t* canvas, int stride_px);
+    void Put(uint16_t color, uint16_t* canvas, int stride_px);
+    void Advance(uint32_t count);
+
+    Format format_;
+    DrawTile tile_;
+    State state_ = State::kOpcode;
+    uint32_t run_ = 0;                 // Pixel còn lại của opcode hiện tại
+    uint32_t remaining_pixels_;        // Pixel còn lại của tile
+    int col_ = 0;                      // Vị trí hiện tại trong tile
+    int row_ = 0;
+    int touched_first_ = 0;
+    int touched_last_ = -1;
+    uint8_t carry_ = 0;                // Byte lẻ từ chunk trước
+    bool has_carry_ = false;
+    uint32_t pixels_written_ = 0;
+};
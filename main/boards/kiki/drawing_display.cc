@@ -1,5 +1,8 @@
 #include "drawing_display.h"
 #include <esp_log.h>
+#include <esp_lvgl_port.h>
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 
 #define TAG "DrawingDisplay"
@@ -19,12 +22,12 @@ DrawingDisplay::~DrawingDisplay() {
 }
 
 bool DrawingDisplay::Lock(int timeout_ms) {
-    // No actual locking needed for canvas overlay
-    return true;
+    // Canvas nằm trên màn hình LVGL chung, UDP task và web server phải giữ khóa LVGL
+    return lvgl_port_lock(timeout_ms);
 }
 
 void DrawingDisplay::Unlock() {
-    // No actual unlocking needed
+    lvgl_port_unlock();
 }
 
 void DrawingDisplay::StartDisplay() {
@@ -173,3 +176,94 @@ void DrawingDisplay::DrawPixel(int x, int y, bool state) {
     }
     */
 }
+
+void DrawingDisplay::StampPixel(uint8_t* buf, uint32_t stride, int x, int y, int width, uint16_t color,
+                                lv_area_t& dirty) {
+    int x1 = std::max(x - (width - 1) / 2, 0);
+    int y1 = std::max(y - (width - 1) / 2, 0);
+    int x2 = std::min(x + width / 2, width_ - 1);
+    int y2 = std::min(y + width / 2, height_ - 1);
+    if (x1 > x2 || y1 > y2) {
+        return;
+    }
+    for (int py = y1; py <= y2; py++) {
+        uint16_t* row = reinterpret_cast<uint16_t*>(buf + py * stride);
+        std::fill(row + x1, row + x2 + 1, color);
+    }
+    dirty.x1 = std::min<int32_t>(dirty.x1, x1);
+    dirty.y1 = std::min<int32_t>(dirty.y1, y1);
+    dirty.x2 = std::max<int32_t>(dirty.x2, x2);
+    dirty.y2 = std::max<int32_t>(dirty.y2, y2);
+}
+
+void DrawingDisplay::RasterizeLine(uint8_t* buf, uint32_t stride, int x0, int y0, int x1, int y1, int width,
+                                   uint16_t color, lv_area_t& dirty) {
+    // Bresenham, mỗi bước đóng một ô width x width
+    int dx = abs(x1 - x0);
+    int dy = -abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    while (true) {
+        StampPixel(buf, stride, x0, y0, width, color, dirty);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+size_t DrawingDisplay::DrawStroke(const StrokePoint* points, size_t count, bool segments, uint16_t color,
+                                  uint8_t width) {
+    if (count == 0) {
+        return 0;
+    }
+    DisplayLockGuard lock(this);
+    if (!canvas_ || !canvas_buf_) {
+        return 0;
+    }
+
+    lv_draw_buf_t* draw_buf = lv_canvas_get_draw_buf(canvas_);
+    uint8_t* buf = static_cast<uint8_t*>(canvas_buf_);
+    uint32_t stride = draw_buf ? draw_buf->header.stride : width_ * sizeof(uint16_t);
+    int w = std::clamp<int>(width, 1, 32);
+    lv_area_t dirty = {width_, height_, -1, -1};
+
+    size_t drawn = 0;
+    const StrokePoint* prev = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        const StrokePoint& p = points[i];
+        if (p.x == kPenUp) {
+            prev = nullptr;
+            continue;
+        }
+        if (p.x >= width_ || p.y >= height_) {
+            prev = nullptr;
+            continue;
+        }
+        if (prev == nullptr) {
+            StampPixel(buf, stride, p.x, p.y, w, color, dirty);
+        } else {
+            RasterizeLine(buf, stride, prev->x, prev->y, p.x, p.y, w, color, dirty);
+        }
+        drawn++;
+        // Chế độ segments: mỗi cặp điểm là một đoạn độc lập
+        prev = (segments && prev != nullptr) ? nullptr : &p;
+    }
+
+    if (dirty.x2 >= dirty.x1 && dirty.y2 >= dirty.y1) {
+        lv_area_t coords;
+        lv_obj_get_coords(canvas_, &coords);
+        lv_area_move(&dirty, coords.x1, coords.y1);
+        lv_obj_invalidate_area(canvas_, &dirty);
+    }
+    return drawn;
+}
@@ -2,6 +2,8 @@
 
 #include "display/display.h"
 #include <lvgl.h>
+#include <cstddef>
+#include <cstdint>
 
 /**
  * @brief Drawing canvas display for UDP drawing functionality
@@ -9,6 +11,13 @@
  */
 class DrawingDisplay : public Display {
 public:
+    struct StrokePoint {
+        uint16_t x;
+        uint16_t y;
+    };
+    // Điểm có x = kPenUp ngắt nét: điểm tiếp theo bắt đầu nét mới
+    static constexpr uint16_t kPenUp = 0xFFFF;
+
     DrawingDisplay(int width, int height);
     virtual ~DrawingDisplay();
 
@@ -30,6 +39,17 @@ public:
     bool IsCanvasEnabled() const { return canvas_enabled_; }
     void ClearCanvas();
     void DrawPixel(int x, int y, bool state);
+
+    /**
+     * @brief Vẽ một loạt điểm thẳng vào buffer canvas (không qua lv_canvas_set_px)
+     * @param points Polyline (segments = false) hoặc từng cặp điểm đầu-cuối (segments = true)
+     * @param color Màu RGB565
+     * @param width Độ dày nét (pixel)
+     * @return Số điểm đã vẽ, 0 nếu canvas chưa bật
+     *
+     * Cả batch chỉ invalidate một vùng chữ nhật bao quanh các nét đã vẽ.
+     */
+    size_t DrawStroke(const StrokePoint* points, size_t count, bool segments, uint16_t color, uint8_t width);
     
     // Get canvas object for integration
     lv_obj_t* GetCanvasObject() const { return canvas_; }
@@ -37,6 +57,9 @@ public:
 private:
     void InitializeCanvas();
     void CleanupCanvas();
+    void StampPixel(uint8_t* buf, uint32_t stride, int x, int y, int width, uint16_t color, lv_area_t& dirty);
+    void RasterizeLine(uint8_t* buf, uint32_t stride, int x0, int y0, int x1, int y1, int width, uint16_t color,
+                       lv_area_t& dirty);
 
     int width_;
     int height_;
@@ -6,6 +6,7 @@
 #include <nvs_flash.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <esp_timer.h>
 #include <math.h>
 
 static const char *TAG = "KikiLED";
@@ -322,6 +323,51 @@ void kiki_led_boot_animation(void) {
     ESP_LOGI(TAG, "✅ Boot animation complete!");
 }
 
+// Beat pulse - restore the steady state after the flash
+static esp_timer_handle_t beat_pulse_timer = NULL;
+static void beat_pulse_restore(void *arg) {
+    if (!animation_running) {
+        kiki_led_update();
+    }
+}
+
+// Beat pulse - short full-brightness flash on top of a static mode
+void kiki_led_beat_pulse(void) {
+    // Animated modes are already moving; don't fight the animation task
+    if (led_strip == NULL || animation_running) {
+        return;
+    }
+    if (beat_pulse_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = beat_pulse_restore,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "led_beat",
+            .skip_unhandled_events = true,
+        };
+        if (esp_timer_create(&timer_args, &beat_pulse_timer) != ESP_OK) {
+            return;
+        }
+    }
+
+    uint8_t r = current_state.r;
+    uint8_t g = current_state.g;
+    uint8_t b = current_state.b;
+    if (current_state.mode == LED_MODE_OFF || (r == 0 && g == 0 && b == 0)) {
+        // Warm white flash when no colour is set
+        r = 255;
+        g = 160;
+        b = 60;
+    }
+    for (int i = 0; i < LED_8BIT_COUNT; i++) {
+        led_strip_set_pixel(led_strip, i, r, g, b);
+    }
+    led_strip_refresh(led_strip);
+
+    esp_timer_stop(beat_pulse_timer);
+    esp_timer_start_once(beat_pulse_timer, 80 * 1000);
+}
+
 // Save LED state to NVS
 void kiki_led_save_to_nvs(void) {
     nvs_handle_t nvs_handle;
@@ -54,6 +54,9 @@ void kiki_led_off(void);
 // Boot animation (loading effect)
 void kiki_led_boot_animation(void);
 
+// Short flash on a music beat (ignored while an animated mode is running)
+void kiki_led_beat_pulse(void);
+
 // Save LED state to NVS
 void kiki_led_save_to_nvs(void);
 
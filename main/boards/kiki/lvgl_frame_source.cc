@@ -0,0 +1,69 @@
+#include "lvgl_frame_source.h"
+#include "display/lvgl_display/lvgl_display.h"
+
+#include <esp_log.h>
+
+#define TAG "LvglFrameSource"
+
+LvglFrameSource::LvglFrameSource(LvglDisplay* display) : display_(display) {
+    DisplayLockGuard lock(display_);
+    lv_display_ = lv_display_get_default();
+    if (lv_display_ != nullptr) {
+        lv_display_add_event_cb(lv_display_, InvalidateEventCallback, LV_EVENT_INVALIDATE_AREA, this);
+    }
+}
+
+LvglFrameSource::~LvglFrameSource() {
+    DisplayLockGuard lock(display_);
+    if (lv_display_ != nullptr) {
+        lv_display_remove_event_cb_with_user_data(lv_display_, InvalidateEventCallback, this);
+    }
+    if (snapshot_ != nullptr) {
+        lv_draw_buf_destroy(snapshot_);
+    }
+}
+
+void LvglFrameSource::InvalidateEventCallback(lv_event_t* e) {
+    auto self = static_cast<LvglFrameSource*>(lv_event_get_user_data(e));
+    self->generation_++;
+}
+
+bool LvglFrameSource::Capture(ScreenFrame& frame) {
+#if CONFIG_LV_USE_SNAPSHOT
+    {
+        DisplayLockGuard lock(display_);
+        lv_obj_t* screen = lv_screen_active();
+        // Buffer giữ lại giữa các khung, chỉ cấp phát lại khi kích thước màn hình đổi
+        if (snapshot_ == nullptr) {
+            snapshot_ = lv_snapshot_create_draw_buf(screen, LV_COLOR_FORMAT_RGB565);
+        } else if (lv_snapshot_reshape_draw_buf(screen, snapshot_) != LV_RESULT_OK) {
+            lv_draw_buf_destroy(snapshot_);
+            snapshot_ = lv_snapshot_create_draw_buf(screen, LV_COLOR_FORMAT_RGB565);
+        }
+        if (snapshot_ == nullptr) {
+            ESP_LOGE(TAG, "Failed to allocate snapshot buffer");
+            return false;
+        }
+        if (lv_snapshot_take_to_draw_buf(screen, LV_COLOR_FORMAT_RGB565, snapshot_) != LV_RESULT_OK) {
+            ESP_LOGE(TAG, "Failed to take snapshot");
+            return false;
+        }
+    }
+
+    // JPEG encoder cần RGB565 big-endian
+    uint16_t* pixels = (uint16_t*)snapshot_->data;
+    size_t pixel_count = (size_t)snapshot_->header.stride / 2 * snapshot_->header.h;
+    for (size_t i = 0; i < pixel_count; i++) {
+        pixels[i] = __builtin_bswap16(pixels[i]);
+    }
+
+    frame.data = snapshot_->data;
+    frame.size = (size_t)snapshot_->header.stride * snapshot_->header.h;
+    frame.width = snapshot_->header.w;
+    frame.height = snapshot_->header.h;
+    return true;
+#else
+    ESP_LOGE(TAG, "LV_USE_SNAPSHOT is not enabled");
+    return false;
+#endif
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "mjpeg_streamer.h"
+
+#include <lvgl.h>
+
+class LvglDisplay;
+
+/**
+ * @brief Chụp màn hình LVGL (lv_snapshot) cho MJPEG stream.
+ *
+ * Generation() tăng theo sự kiện LV_EVENT_INVALIDATE_AREA của display, nên
+ * màn hình đứng yên thì không chụp lại. Chỉ phần snapshot giữ khóa display;
+ * đảo byte cho encoder làm ngoài khóa trên buffer riêng.
+ */
+class LvglFrameSource : public ScreenFrameSource {
+public:
+    explicit LvglFrameSource(LvglDisplay* display);
+    ~LvglFrameSource();
+
+    virtual uint32_t Generation() override { return generation_; }
+    virtual bool Capture(ScreenFrame& frame) override;
+
+private:
+    static void InvalidateEventCallback(lv_event_t* e);
+
+    LvglDisplay* display_;
+    lv_display_t* lv_display_ = nullptr;
+    lv_draw_buf_t* snapshot_ = nullptr;
+    std::atomic<uint32_t> generation_{1};
+};
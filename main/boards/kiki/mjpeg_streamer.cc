@@ -0,0 +1,116 @@
+#include "mjpeg_streamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+
+int64_t NowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+SyntheticFrameSource::SyntheticFrameSource(uint16_t width, uint16_t height, bool auto_advance)
+    : width_(width), height_(height), auto_advance_(auto_advance), buffer_((size_t)width * height * 2) {
+}
+
+uint32_t SyntheticFrameSource::Generation() {
+    if (auto_advance_) {
+        return ++generation_;
+    }
+    return generation_;
+}
+
+bool SyntheticFrameSource::Capture(ScreenFrame& frame) {
+    // 8 vạch màu dọc, dịch 4px mỗi thế hệ
+    static const uint16_t kBars[8] = {0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000};
+    uint32_t shift = generation_.load() * 4;
+    uint8_t* p = buffer_.data();
+    for (uint16_t y = 0; y < height_; y++) {
+        for (uint16_t x = 0; x < width_; x++) {
+            uint16_t color = kBars[((x + shift) % width_) * 8 / width_];
+            *p++ = color >> 8;
+            *p++ = color & 0xFF;
+        }
+    }
+    frame.data = buffer_.data();
+    frame.size = buffer_.size();
+    frame.width = width_;
+    frame.height = height_;
+    return true;
+}
+
+MjpegStreamer::MjpegStreamer(ScreenFrameSource& source, Encoder encoder, const MjpegStreamConfig& config)
+    : source_(source), encoder_(std::move(encoder)), config_(config) {
+    config_.max_fps = std::clamp(config_.max_fps, 1, 30);
+    config_.quality = std::clamp(config_.quality, 1, 100);
+}
+
+MjpegStreamStats MjpegStreamer::Run(const Writer& writer, uint32_t max_frames) {
+    MjpegStreamStats stats;
+    const int64_t interval_us = 1000000 / config_.max_fps;
+    const int64_t keepalive_us = (int64_t)config_.keepalive_ms * 1000;
+
+    std::string jpeg;
+    char part_header[128];
+    bool have_frame = false;
+    uint32_t last_generation = 0;
+    int64_t last_sent_us = 0;
+    int64_t next_due_us = NowUs();
+
+    while (!stop_ && (max_frames == 0 || stats.frames_sent < max_frames)) {
+        int64_t now = NowUs();
+        if (now < next_due_us) {
+            std::this_thread::sleep_for(std::chrono::microseconds(next_due_us - now));
+            now = NowUs();
+        }
+        // Lịch tính từ lúc xong khung trước: client chậm thì ít khung hơn, không dồn hàng
+        next_due_us = now + interval_us;
+
+        // Đọc generation trước khi chụp, thay đổi trong lúc chụp sẽ tạo khung mới
+        uint32_t generation = source_.Generation();
+        bool changed = !have_frame || generation != last_generation;
+        if (!changed && now - last_sent_us < keepalive_us) {
+            stats.frames_unchanged++;
+            continue;
+        }
+
+        if (changed) {
+            ScreenFrame frame;
+            int64_t t0 = NowUs();
+            if (!source_.Capture(frame)) {
+                stats.capture_failures++;
+                continue;
+            }
+            int64_t t1 = NowUs();
+            jpeg.clear();
+            bool encoded = encoder_(frame, config_.quality, jpeg);
+            stats.capture_us += t1 - t0;
+            stats.encode_us += NowUs() - t1;
+            if (!encoded || jpeg.empty()) {
+                stats.encode_failures++;
+                continue;
+            }
+            last_generation = generation;
+            have_frame = true;
+        }
+
+        // Không đổi quá keepalive_ms: gửi lại JPEG cũ để proxy/trình duyệt không timeout
+        int64_t t0 = NowUs();
+        int len = snprintf(part_header, sizeof(part_header),
+                           "--%s\r\nContent-Type: image/jpeg\r\nContent-Length: %u\r\n\r\n",
+                           kBoundary, (unsigned)jpeg.size());
+        if (!writer(part_header, len) || !writer(jpeg.data(), jpeg.size()) || !writer("\r\n", 2)) {
+            break;
+        }
+        last_sent_us = NowUs();
+        stats.send_us += last_sent_us - t0;
+        stats.bytes_sent += len + jpeg.size() + 2;
+        stats.frames_sent++;
+    }
+    return stats;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Một khung hình màn hình, RGB565 big-endian (định dạng image_to_jpeg cần).
+ * Bộ nhớ thuộc về ScreenFrameSource, hợp lệ tới lần Capture() tiếp theo.
+ */
+struct ScreenFrame {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+};
+
+/**
+ * @brief Nguồn khung hình cho MJPEG stream (LVGL trên máy, synthetic khi test trên host)
+ */
+class ScreenFrameSource {
+public:
+    virtual ~ScreenFrameSource() = default;
+
+    // Tăng mỗi khi màn hình có thể đã thay đổi; cùng giá trị = cùng hình
+    virtual uint32_t Generation() = 0;
+
+    // Chụp màn hình hiện tại vào `frame`
+    virtual bool Capture(ScreenFrame& frame) = 0;
+};
+
+/**
+ * @brief Nguồn test: dải màu chạy ngang, đổi hình mỗi lần Advance().
+ * Dùng để kiểm tra pipeline stream mà không cần LVGL (host hoặc ?test=1).
+ */
+class SyntheticFrameSource : public ScreenFrameSource {
+public:
+    SyntheticFrameSource(uint16_t width, uint16_t height, bool auto_advance = true);
+
+    void Advance() { generation_++; }
+    virtual uint32_t Generation() override;
+    virtual bool Capture(ScreenFrame& frame) override;
+
+private:
+    uint16_t width_;
+    uint16_t height_;
+    bool auto_advance_;
+    std::atomic<uint32_t> generation_{0};
+    std::vector<uint8_t> buffer_;
+};
+
+struct MjpegStreamConfig {
+    int max_fps = 5;          // Giới hạn tốc độ khung hình
+    int quality = 60;         // Chất lượng JPEG 1-100
+    int keepalive_ms = 5000;  // Gửi lại khung cuối nếu màn hình đứng yên lâu hơn
+};
+
+struct MjpegStreamStats {
+    uint32_t frames_sent = 0;
+    uint32_t frames_unchanged = 0;  // Bỏ qua vì màn hình không đổi
+    uint32_t capture_failures = 0;
+    uint32_t encode_failures = 0;
+    uint64_t capture_us = 0;
+    uint64_t encode_us = 0;
+    uint64_t send_us = 0;
+    uint64_t bytes_sent = 0;
+};
+
+/**
+ * @brief Vòng lặp MJPEG (multipart/x-mixed-replace) độc lập với HTTP server và LVGL.
+ *
+ * - Rate cap: tối đa max_fps khung/giây.
+ * - Dirty-frame skipping: không chụp/encode khi Generation() không đổi.
+ * - Backpressure: chỉ một khung trong lúc gửi; client chậm làm giảm fps của
+ *   chính nó (khung bị bỏ, không xếp hàng). Chỉ Capture() giữ khóa màn hình,
+ *   encode và gửi chạy ngoài khóa nên không thể làm LVGL đứng.
+ */
+class MjpegStreamer {
+public:
+    // Encode `frame` thành JPEG vào `jpeg`
+    using Encoder = std::function<bool(const ScreenFrame& frame, int quality, std::string& jpeg)>;
+    // Gửi dữ liệu cho client; false = client đã ngắt
+    using Writer = std::function<bool(const char* data, size_t len)>;
+
+    static constexpr const char* kBoundary = "kikiframe";
+    static constexpr const char* kContentType = "multipart/x-mixed-replace;boundary=kikiframe";
+
+    MjpegStreamer(ScreenFrameSource& source, Encoder encoder, const MjpegStreamConfig& config);
+
+    // Chạy tới khi writer lỗi, Stop() được gọi, hoặc đã gửi `max_frames` khung (0 = không giới hạn)
+    MjpegStreamStats Run(const Writer& writer, uint32_t max_frames = 0);
+    void Stop() { stop_ = true; }
+
+private:
+    ScreenFrameSource& source_;
+    Encoder encoder_;
+    MjpegStreamConfig config_;
+    std::atomic<bool> stop_{false};
+};
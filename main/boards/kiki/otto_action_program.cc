@@ -0,0 +1,449 @@
+#include "otto_action_program.h"
+
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Tên chuẩn của từng opcode (tên web UI gửi), theo thứ tự ActionOp
+const char* const kOpNames[] = {
+    "dog_walk",         "dog_walk_back",    "dog_turn_left",   "dog_turn_right",      "dog_sit_down",
+    "dog_lie_down",     "dog_bow",          "dog_jump",        "dog_dance",           "dog_wave_right_foot",
+    "dog_swing",        "dog_stretch",      "dog_scratch",     "dog_wag_tail",        "dog_defend",
+    "dog_home",         "dog_dance_4_feet", "dog_greet",       "dog_attack",          "dog_celebrate",
+    "dog_search",       "dog_roll_over",    "dog_play_dead",   "dog_shake_paw",       "dog_pushup",
+    "dog_balance",      "dog_stop",         "show_clock",
+};
+static_assert(sizeof(kOpNames) / sizeof(kOpNames[0]) == ACTION_OP_LAST_ACTION - ACTION_OP_FIRST_ACTION + 1,
+              "kOpNames phải khớp ActionOp");
+
+// Khớp chuỗi con theo đúng thứ tự của /action trước đây; "turn" xử lý riêng.
+// dance_4_feet đứng trước dance: trước đây "dance" khớp trước nên dance_4_feet không bao giờ chạy.
+struct NameRule {
+    const char* pattern;
+    uint8_t op;
+};
+const NameRule kNameRules[] = {
+    {"walk_back", ACTION_OP_WALK_BACK},
+    {"walk", ACTION_OP_WALK},
+    {"sit", ACTION_OP_SIT},
+    {"lie", ACTION_OP_LIE},
+    {"bow", ACTION_OP_BOW},
+    {"jump", ACTION_OP_JUMP},
+    {"dance_4_feet", ACTION_OP_DANCE_4_FEET},
+    {"dance", ACTION_OP_DANCE},
+    {"wave", ACTION_OP_WAVE},
+    {"swing", ACTION_OP_SWING},
+    {"stretch", ACTION_OP_STRETCH},
+    {"scratch", ACTION_OP_SCRATCH},
+    {"wag_tail", ACTION_OP_WAG_TAIL},
+    {"defend", ACTION_OP_DEFEND},
+    {"home", ACTION_OP_HOME},
+    {"greet", ACTION_OP_GREET},
+    {"attack", ACTION_OP_ATTACK},
+    {"celebrate", ACTION_OP_CELEBRATE},
+    {"search", ACTION_OP_SEARCH},
+    {"roll_over", ACTION_OP_ROLL_OVER},
+    {"play_dead", ACTION_OP_PLAY_DEAD},
+    {"shake_paw", ACTION_OP_SHAKE_PAW},
+    {"pushup", ACTION_OP_PUSHUP},
+    {"balance", ACTION_OP_BALANCE},
+    {"stop", ACTION_OP_STOP},
+    {"show_clock", ACTION_OP_SHOW_CLOCK},
+};
+
+// Emoji id = vị trí trong bảng (lưu trong blob): chỉ thêm vào cuối
+const char* const kEmojiNames[] = {
+    "neutral", "relaxed",  "sleepy", "happy",     "laughing", "funny",   "loving",    "confident", "winking",
+    "cool",    "delicious", "kissy", "kiss",      "silly",    "sad",     "crying",    "angry",     "surprised",
+    "shocked", "thinking", "confused", "embarrassed", "scared", "excited", "love",
+};
+constexpr int kEmojiCount = sizeof(kEmojiNames) / sizeof(kEmojiNames[0]);
+
+bool IsAction(uint8_t op) {
+    return op >= ACTION_OP_FIRST_ACTION && op <= ACTION_OP_LAST_ACTION;
+}
+
+void PutVarint(std::vector<uint8_t>& out, int32_t value) {
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+    while (zigzag >= 0x80) {
+        out.push_back((uint8_t)(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back((uint8_t)zigzag);
+}
+
+bool GetVarint(const uint8_t* code, size_t size, size_t& pc, int32_t* value) {
+    uint32_t zigzag = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pc >= size) {
+            return false;
+        }
+        uint8_t byte = code[pc++];
+        zigzag |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = (int32_t)((zigzag >> 1) ^ (0u - (zigzag & 1)));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Trim(const std::string& s) {
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && isspace((unsigned char)s[begin])) begin++;
+    while (end > begin && isspace((unsigned char)s[end - 1])) end--;
+    return s.substr(begin, end - begin);
+}
+
+int32_t ParseInt(const std::string& s) {
+    long value = strtol(s.c_str(), nullptr, 10);
+    return (int32_t)(value < INT32_MIN ? INT32_MIN : value > INT32_MAX ? INT32_MAX : value);
+}
+
+bool Fail(std::string* error, int token, const char* message, const std::string& detail = "") {
+    if (error != nullptr) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "step %d: ", token);
+        *error = prefix + std::string(message) + (detail.empty() ? "" : " '" + detail + "'");
+    }
+    return false;
+}
+
+}  // namespace
+
+uint8_t ActionOpFromName(const char* name, int param1) {
+    if (name == nullptr) {
+        return ACTION_OP_END;
+    }
+    // walk_back/walk trước turn như trước đây
+    for (int i = 0; i < 2; i++) {
+        if (strstr(name, kNameRules[i].pattern) != nullptr) {
+            return kNameRules[i].op;
+        }
+    }
+    if (strstr(name, "turn") != nullptr) {
+        // turn_left, hoặc turn với param1 âm; còn lại (turn_right, turn) rẽ phải
+        return (strstr(name, "turn_left") != nullptr || param1 < 0) ? ACTION_OP_TURN_LEFT : ACTION_OP_TURN_RIGHT;
+    }
+    for (size_t i = 2; i < sizeof(kNameRules) / sizeof(kNameRules[0]); i++) {
+        if (strstr(name, kNameRules[i].pattern) != nullptr) {
+            return kNameRules[i].op;
+        }
+    }
+    return ACTION_OP_END;
+}
+
+const char* ActionOpName(uint8_t op) {
+    return IsAction(op) ? kOpNames[op - ACTION_OP_FIRST_ACTION] : nullptr;
+}
+
+uint8_t ActionEmojiFromName(const char* name) {
+    for (int i = 0; name != nullptr && i < kEmojiCount; i++) {
+        if (strcmp(name, kEmojiNames[i]) == 0) {
+            return (uint8_t)i;
+        }
+    }
+    return ACTION_EMOJI_NONE;
+}
+
+const char* ActionEmojiName(uint8_t id) {
+    return id < kEmojiCount ? kEmojiNames[id] : nullptr;
+}
+
+bool ActionProgramCompile(const char* text, const char* emotion, bool strict, std::vector<uint8_t>& code,
+                          std::string* error) {
+    code.clear();
+    uint8_t emotion_id = ACTION_EMOJI_NONE;
+    if (emotion != nullptr && emotion[0] != '\0') {
+        emotion_id = ActionEmojiFromName(emotion);
+        if (emotion_id == ACTION_EMOJI_NONE && strict) {
+            return Fail(error, 0, "unknown emotion", emotion);
+        }
+    }
+    code.push_back(ACTION_PROGRAM_VERSION);
+    code.push_back(emotion_id);
+    code.push_back(0);  // Số bước, ghi sau cùng
+    code.push_back(0);
+
+    int steps = 0;
+    int depth = 0;
+    int token_index = 0;
+    // Vị trí và số bước lúc mở từng vòng lặp, để phát hiện thân rỗng
+    size_t loop_pc[ACTION_PROGRAM_MAX_LOOP_DEPTH];
+    int loop_steps[ACTION_PROGRAM_MAX_LOOP_DEPTH];
+    const char* p = text != nullptr ? text : "";
+    while (*p != '\0') {
+        const char* end = strchr(p, ';');
+        if (end == nullptr) {
+            end = p + strlen(p);
+        }
+        std::string token(p, end - p);
+        p = *end != '\0' ? end + 1 : end;
+
+        // "action,p1,p2,emoji": trường thứ 4 lấy phần còn lại như sscanf("%[^\n]") cũ
+        std::string fields[4];
+        int field_count = 0;
+        size_t start = 0;
+        while (field_count < 4) {
+            size_t comma = field_count < 3 ? token.find(',', start) : std::string::npos;
+            fields[field_count++] = Trim(token.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+        const std::string& name = fields[0];
+        if (name.empty()) {
+            continue;  // ";;" như strtok bỏ qua
+        }
+        token_index++;
+        int32_t p1 = field_count > 1 ? ParseInt(fields[1]) : 0;
+        int32_t p2 = field_count > 2 ? ParseInt(fields[2]) : 0;
+
+        // Thiếu trường emoji: "neutral" như lúc phát trước đây; trường rỗng: giữ emoji hiện tại
+        uint8_t emoji = ActionEmojiFromName("neutral");
+        if (field_count > 3) {
+            emoji = fields[3].empty() ? ACTION_EMOJI_NONE : ActionEmojiFromName(fields[3].c_str());
+            if (emoji == ACTION_EMOJI_NONE && !fields[3].empty() && strict) {
+                return Fail(error, token_index, "unknown emoji", fields[3]);
+            }
+        }
+
+        if (name == "loop") {
+            if (depth >= ACTION_PROGRAM_MAX_LOOP_DEPTH) {
+                return Fail(error, token_index, "loops nested too deep");
+            }
+            if (p1 < 1 || p1 > ACTION_PROGRAM_MAX_LOOP_COUNT) {
+                if (strict) {
+                    return Fail(error, token_index, "loop count must be 1..99");
+                }
+                p1 = p1 < 1 ? 1 : ACTION_PROGRAM_MAX_LOOP_COUNT;
+            }
+            loop_pc[depth] = code.size();
+            loop_steps[depth] = steps;
+            code.push_back(ACTION_OP_LOOP);
+            code.push_back((uint8_t)p1);
+            depth++;
+        } else if (name == "endloop") {
+            if (depth == 0) {
+                if (strict) {
+                    return Fail(error, token_index, "endloop without loop");
+                }
+                continue;
+            }
+            depth--;
+            if (steps == loop_steps[depth]) {
+                // Thân rỗng: lặp tới 99^4 lần mà không có bước nào, treo trình phát
+                if (strict) {
+                    return Fail(error, token_index, "empty loop");
+                }
+                code.resize(loop_pc[depth]);
+                continue;
+            }
+            code.push_back(ACTION_OP_NEXT);
+        } else if (name == "emoji") {
+            if (emoji == ACTION_EMOJI_NONE) {
+                continue;  // Không strict: emoji lạ bị bỏ
+            }
+            code.push_back(ACTION_OP_EMOJI);
+            code.push_back(emoji);
+            steps++;
+        } else {
+            uint8_t op = ActionOpFromName(name.c_str(), p1);
+            if (op == ACTION_OP_END) {
+                if (strict) {
+                    return Fail(error, token_index, "unknown action", name);
+                }
+                continue;
+            }
+            code.push_back(op);
+            code.push_back(emoji);
+            PutVarint(code, p1);
+            PutVarint(code, p2);
+            steps++;
+        }
+
+        if (code.size() + depth + 1 > ACTION_PROGRAM_MAX_BYTES) {
+            return Fail(error, token_index, "program too long");
+        }
+    }
+
+    if (depth > 0) {
+        if (strict) {
+            return Fail(error, token_index, "loop without endloop");
+        }
+        while (depth > 0) {
+            depth--;
+            if (steps == loop_steps[depth]) {
+                code.resize(loop_pc[depth]);
+            } else {
+                code.push_back(ACTION_OP_NEXT);
+            }
+        }
+    }
+    if (steps == 0) {
+        return Fail(error, token_index, "no actions");
+    }
+    code.push_back(ACTION_OP_END);
+    code[2] = (uint8_t)(steps & 0xFF);
+    code[3] = (uint8_t)(steps >> 8);
+    return true;
+}
+
+bool ActionProgramInspect(const uint8_t* code, size_t size, ActionProgramInfo* info) {
+    if (code == nullptr || size < ACTION_PROGRAM_HEADER_SIZE + 1 || size > ACTION_PROGRAM_MAX_BYTES ||
+        code[0] != ACTION_PROGRAM_VERSION) {
+        return false;
+    }
+    if (code[1] != ACTION_EMOJI_NONE && code[1] >= kEmojiCount) {
+        return false;
+    }
+
+    int depth = 0;
+    int steps = 0;
+    int loop_steps[ACTION_PROGRAM_MAX_LOOP_DEPTH];
+    size_t pc = ACTION_PROGRAM_HEADER_SIZE;
+    while (pc < size) {
+        uint8_t op = code[pc++];
+        if (op == ACTION_OP_END) {
+            break;
+        }
+        if (op == ACTION_OP_LOOP) {
+            if (pc >= size || code[pc] < 1 || code[pc] > ACTION_PROGRAM_MAX_LOOP_COUNT ||
+                depth >= ACTION_PROGRAM_MAX_LOOP_DEPTH) {
+                return false;
+            }
+            loop_steps[depth++] = steps;
+            pc++;
+        } else if (op == ACTION_OP_NEXT) {
+            // Vòng lặp rỗng trong blob NVS cũng bị từ chối như lúc biên dịch
+            if (depth == 0 || steps == loop_steps[--depth]) {
+                return false;
+            }
+        } else if (op == ACTION_OP_EMOJI) {
+            if (pc >= size || code[pc] >= kEmojiCount) {
+                return false;
+            }
+            pc++;
+            steps++;
+        } else if (IsAction(op)) {
+            int32_t p1, p2;
+            if (pc >= size || (code[pc] != ACTION_EMOJI_NONE && code[pc] >= kEmojiCount)) {
+                return false;
+            }
+            pc++;
+            if (!GetVarint(code, size, pc, &p1) || !GetVarint(code, size, pc, &p2)) {
+                return false;
+            }
+            steps++;
+        } else {
+            return false;
+        }
+    }
+    // Phải kết thúc đúng ở ACTION_OP_END cuối blob, mọi vòng lặp đã đóng
+    if (pc != size || code[size - 1] != ACTION_OP_END || depth != 0 ||
+        steps != (code[2] | (code[3] << 8))) {
+        return false;
+    }
+
+    if (info != nullptr) {
+        info->emotion = code[1];
+        info->steps = (uint16_t)steps;
+        info->bytes = size;
+    }
+    return true;
+}
+
+int ActionProgramRun(const uint8_t* code, size_t size, int max_steps,
+                     const std::function<bool(const ActionStep&)>& step) {
+    struct Frame {
+        size_t body;
+        int remaining;
+    };
+    Frame stack[ACTION_PROGRAM_MAX_LOOP_DEPTH];
+    int depth = 0;
+    int count = 0;
+    size_t pc = ACTION_PROGRAM_HEADER_SIZE;
+
+    while (pc < size && count < max_steps) {
+        uint8_t op = code[pc++];
+        if (op == ACTION_OP_END) {
+            break;
+        }
+        if (op == ACTION_OP_LOOP) {
+            if (depth >= ACTION_PROGRAM_MAX_LOOP_DEPTH || pc >= size) {
+                break;
+            }
+            stack[depth].remaining = code[pc++];
+            stack[depth].body = pc;
+            depth++;
+            continue;
+        }
+        if (op == ACTION_OP_NEXT) {
+            if (depth == 0) {
+                break;
+            }
+            if (--stack[depth - 1].remaining > 0) {
+                pc = stack[depth - 1].body;
+            } else {
+                depth--;
+            }
+            continue;
+        }
+
+        ActionStep s = {op, ACTION_EMOJI_NONE, 0, 0};
+        if (pc >= size) {
+            break;
+        }
+        s.emoji = code[pc++];
+        if (op != ACTION_OP_EMOJI && (!GetVarint(code, size, pc, &s.p1) || !GetVarint(code, size, pc, &s.p2))) {
+            break;
+        }
+        if (!step(s)) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+std::string ActionProgramToText(const uint8_t* code, size_t size) {
+    std::string text;
+    size_t pc = ACTION_PROGRAM_HEADER_SIZE;
+    char buffer[64];
+    while (pc < size) {
+        uint8_t op = code[pc++];
+        if (op == ACTION_OP_END) {
+            break;
+        }
+        if (!text.empty()) {
+            text += ';';
+        }
+        if (op == ACTION_OP_LOOP && pc < size) {
+            snprintf(buffer, sizeof(buffer), "loop,%d", code[pc++]);
+            text += buffer;
+        } else if (op == ACTION_OP_NEXT) {
+            text += "endloop";
+        } else if (op == ACTION_OP_EMOJI && pc < size) {
+            const char* emoji = ActionEmojiName(code[pc++]);
+            text += std::string("emoji,0,0,") + (emoji != nullptr ? emoji : "");
+        } else if (IsAction(op) && pc < size) {
+            const char* emoji = ActionEmojiName(code[pc++]);
+            int32_t p1 = 0, p2 = 0;
+            if (!GetVarint(code, size, pc, &p1) || !GetVarint(code, size, pc, &p2)) {
+                break;
+            }
+            snprintf(buffer, sizeof(buffer), "%s,%ld,%ld,", ActionOpName(op), (long)p1, (long)p2);
+            text += buffer;
+            text += emoji != nullptr ? emoji : "";
+        } else {
+            break;
+        }
+    }
+    return text;
+}
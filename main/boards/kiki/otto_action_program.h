@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Bytecode cho memory slot: chuỗi ghi từ web UI ("dog_walk,3,150,happy;dog_sit_down,1,500,neutral")
+ * được biên dịch một lần lúc lưu; lúc phát chỉ giải mã vài byte mỗi bước, không còn strtok/sscanf/strstr.
+ *
+ * Blob:  [version][emotion][steps lo][steps hi] + các lệnh, kết thúc bằng ACTION_OP_END
+ * Lệnh:  action [op][emoji][p1][p2]          op >= ACTION_OP_FIRST_ACTION, p1/p2 varint zigzag
+ *        emoji  [ACTION_OP_EMOJI][emoji]
+ *        loop   [ACTION_OP_LOOP][count] ... [ACTION_OP_NEXT]
+ * Một bước action thường chiếm 4-6 byte (chuỗi gốc khoảng 20-25 ký tự).
+ *
+ * Cú pháp văn bản thêm "loop,N" ... "endloop" (lồng tối đa ACTION_PROGRAM_MAX_LOOP_DEPTH, thân không rỗng).
+ * Không phụ thuộc ESP-IDF: simulator trên host link nguyên file này.
+ */
+
+#define ACTION_PROGRAM_VERSION 1
+#define ACTION_PROGRAM_HEADER_SIZE 4
+#define ACTION_PROGRAM_MAX_BYTES 512
+#define ACTION_PROGRAM_MAX_LOOP_DEPTH 4
+#define ACTION_PROGRAM_MAX_LOOP_COUNT 99
+#define ACTION_EMOJI_NONE 0xFF
+
+// Giá trị opcode và emoji id nằm trong blob NVS: chỉ thêm vào cuối, không đổi số cũ
+enum ActionOp : uint8_t {
+    ACTION_OP_END = 0x00,
+    ACTION_OP_EMOJI = 0x01,
+    ACTION_OP_LOOP = 0x02,
+    ACTION_OP_NEXT = 0x03,
+
+    ACTION_OP_FIRST_ACTION = 0x10,
+    ACTION_OP_WALK = ACTION_OP_FIRST_ACTION,
+    ACTION_OP_WALK_BACK,
+    ACTION_OP_TURN_LEFT,
+    ACTION_OP_TURN_RIGHT,
+    ACTION_OP_SIT,
+    ACTION_OP_LIE,
+    ACTION_OP_BOW,
+    ACTION_OP_JUMP,
+    ACTION_OP_DANCE,
+    ACTION_OP_WAVE,
+    ACTION_OP_SWING,
+    ACTION_OP_STRETCH,
+    ACTION_OP_SCRATCH,
+    ACTION_OP_WAG_TAIL,
+    ACTION_OP_DEFEND,
+    ACTION_OP_HOME,
+    ACTION_OP_DANCE_4_FEET,
+    ACTION_OP_GREET,
+    ACTION_OP_ATTACK,
+    ACTION_OP_CELEBRATE,
+    ACTION_OP_SEARCH,
+    ACTION_OP_ROLL_OVER,
+    ACTION_OP_PLAY_DEAD,
+    ACTION_OP_SHAKE_PAW,
+    ACTION_OP_PUSHUP,
+    ACTION_OP_BALANCE,
+    ACTION_OP_STOP,
+    ACTION_OP_SHOW_CLOCK,
+    ACTION_OP_LAST_ACTION = ACTION_OP_SHOW_CLOCK,
+};
+
+// Một bước khi chạy: ACTION_OP_EMOJI hoặc một action
+struct ActionStep {
+    uint8_t op;
+    uint8_t emoji;  // ACTION_EMOJI_NONE: không đổi emoji
+    int32_t p1;
+    int32_t p2;
+};
+
+struct ActionProgramInfo {
+    uint8_t emotion = ACTION_EMOJI_NONE;  // Emoji chung của slot
+    uint16_t steps = 0;                   // Số bước như đã ghi, thân vòng lặp tính một lần
+    size_t bytes = 0;
+};
+
+// Tên action web -> opcode, cùng quy tắc khớp chuỗi con với /action ("dog_walk_back" trước "walk").
+// "turn" không rõ hướng dùng dấu của param1. ACTION_OP_END nếu không nhận ra.
+uint8_t ActionOpFromName(const char* name, int param1);
+const char* ActionOpName(uint8_t op);
+
+// Emoji id <-> tên; ACTION_EMOJI_NONE / nullptr nếu không biết
+uint8_t ActionEmojiFromName(const char* name);
+const char* ActionEmojiName(uint8_t id);
+
+// strict (lưu từ web): action/emoji lạ là lỗi. Không strict (chuyển slot cũ): bỏ qua bước lạ.
+bool ActionProgramCompile(const char* text, const char* emotion, bool strict, std::vector<uint8_t>& code,
+                          std::string* error);
+
+// Kiểm tra blob (đọc từ NVS) trước khi chạy; info có thể null
+bool ActionProgramInspect(const uint8_t* code, size_t size, ActionProgramInfo* info);
+
+// Gọi step cho từng bước theo thứ tự, vòng lặp được trải ra. Dừng khi step trả về false
+// hoặc sau max_steps bước. Blob phải đã qua ActionProgramInspect. Trả về số bước step đã nhận (true).
+int ActionProgramRun(const uint8_t* code, size_t size, int max_steps,
+                     const std::function<bool(const ActionStep&)>& step);
+
+// Dịch ngược về cú pháp văn bản (tên chuẩn), để xem lại slot và kiểm tra round-trip
+std::string ActionProgramToText(const uint8_t* code, size_t size);
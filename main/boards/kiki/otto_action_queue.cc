@@ -0,0 +1,89 @@
+#include "otto_action_queue.h"
+
+#include <algorithm>
+
+uint32_t ActionQueue::Push(const QueuedAction& action, ActionCoalesce coalesce, ActionPushResult* result) {
+    // Vị trí chèn: sau action cuối cùng có ưu tiên >= action mới
+    int insert_at = 0;
+    while (insert_at < count_ && items_[insert_at].priority >= action.priority) {
+        insert_at++;
+    }
+
+    // Chỉ gộp với action đứng ngay trước chỗ chèn, cùng mức: không đổi thứ tự với action khác
+    if (coalesce != ACTION_COALESCE_NONE && insert_at > 0) {
+        QueuedAction& tail = items_[insert_at - 1];
+        if (tail.priority == action.priority && tail.action_type == action.action_type &&
+            tail.speed == action.speed && tail.direction == action.direction && tail.amount == action.amount) {
+            if (coalesce == ACTION_COALESCE_STEPS) {
+                tail.steps = std::min(tail.steps + action.steps, ACTION_COALESCE_MAX_STEPS);
+                *result = ACTION_PUSH_COALESCED;
+                return tail.token;
+            }
+            if (tail.steps == action.steps) {
+                *result = ACTION_PUSH_COALESCED;
+                return tail.token;
+            }
+        }
+    }
+
+    *result = ACTION_PUSH_QUEUED;
+    if (count_ == ACTION_QUEUE_SIZE) {
+        // Cũ nhất trong mức thấp nhất = phần tử đầu của mức cuối hàng
+        int victim = count_ - 1;
+        while (victim > 0 && items_[victim - 1].priority == items_[count_ - 1].priority) {
+            victim--;
+        }
+        if (items_[victim].priority > action.priority) {
+            *result = ACTION_PUSH_FULL;
+            return 0;
+        }
+        RemoveAt(victim);
+        if (victim < insert_at) {
+            insert_at--;
+        }
+        *result = ACTION_PUSH_DROPPED_OLDEST;
+    }
+
+    for (int i = count_; i > insert_at; i--) {
+        items_[i] = items_[i - 1];
+    }
+    items_[insert_at] = action;
+    items_[insert_at].token = next_token_++;
+    if (next_token_ == 0) {
+        next_token_ = 1;  // 0 nghĩa là "không có"
+    }
+    count_++;
+    return items_[insert_at].token;
+}
+
+bool ActionQueue::Pop(QueuedAction* action) {
+    if (count_ == 0) {
+        return false;
+    }
+    *action = items_[0];
+    RemoveAt(0);
+    return true;
+}
+
+bool ActionQueue::Remove(uint32_t token) {
+    for (int i = 0; i < count_; i++) {
+        if (items_[i].token == token) {
+            RemoveAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+int ActionQueue::Clear() {
+    int cleared = count_;
+    count_ = 0;
+    return cleared;
+}
+
+void ActionQueue::RemoveAt(int index) {
+    for (int i = index; i < count_ - 1; i++) {
+        items_[i] = items_[i + 1];
+    }
+    count_--;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Hàng đợi action có ưu tiên của OttoController: URGENT > HIGH > NORMAL, FIFO trong cùng mức.
+ * Mỗi action có token để huỷ riêng; lệnh di chuyển trùng liên tiếp được gộp (bấm "đi" 3 lần = một
+ * lần đi nhiều bước) thay vì chiếm chỗ và đẩy action khác ra.
+ *
+ * Không tự khoá (OttoController giữ mutex) và không phụ thuộc ESP-IDF: simulator trên host link nguyên file.
+ */
+
+#define OTTO_PRIORITY_NORMAL 0  // Xếp sau mọi action đang chờ
+#define OTTO_PRIORITY_HIGH 1    // Chen trước action thường, đợi action đang chạy xong
+#define OTTO_PRIORITY_URGENT 2  // Chen trước tất cả, ngắt action đang chạy ở tick motion kế tiếp
+
+#define ACTION_QUEUE_SIZE 10
+#define ACTION_COALESCE_MAX_STEPS 20
+
+struct QueuedAction {
+    int action_type;
+    int steps;
+    int speed;
+    int direction;
+    int amount;
+    uint8_t priority;
+    uint32_t token;       // Push() gán
+    int64_t enqueue_us;
+};
+
+// Cách gộp với action cùng mức ưu tiên đang chờ cuối hàng
+enum ActionCoalesce : uint8_t {
+    ACTION_COALESCE_NONE = 0,
+    ACTION_COALESCE_STEPS,  // Dáng đi cùng loại, tốc độ, hướng: cộng số bước (tối đa ACTION_COALESCE_MAX_STEPS)
+    ACTION_COALESCE_SAME,   // Tư thế giống hệt (ngồi, nằm, home...): bỏ lệnh lặp
+};
+
+enum ActionPushResult : uint8_t {
+    ACTION_PUSH_QUEUED = 0,
+    ACTION_PUSH_COALESCED,
+    ACTION_PUSH_DROPPED_OLDEST,  // Đầy: bỏ action cũ nhất có ưu tiên thấp nhất để lấy chỗ
+    ACTION_PUSH_FULL,            // Đầy toàn action ưu tiên cao hơn: từ chối
+};
+
+// Độ trễ (micro giây) do OttoController đo
+struct OttoLatencyStats {
+    int64_t last_start_us;    // Enqueue -> action bắt đầu chạy
+    int64_t max_start_us;
+    int64_t avg_start_us;     // Trung bình trượt (1/8)
+    uint32_t started;
+    int64_t last_preempt_us;  // Lệnh khẩn -> action bị ngắt nhả servo
+    int64_t max_preempt_us;
+    uint32_t preempted;
+    uint32_t coalesced;
+    uint32_t dropped;
+};
+
+class ActionQueue {
+public:
+    // Token của action mới hoặc của action đang chờ đã gộp vào; 0 nếu bị từ chối
+    uint32_t Push(const QueuedAction& action, ActionCoalesce coalesce, ActionPushResult* result);
+    bool Pop(QueuedAction* action);
+    bool Remove(uint32_t token);
+    int Clear();
+    int Count() const { return count_; }
+
+private:
+    void RemoveAt(int index);
+
+    QueuedAction items_[ACTION_QUEUE_SIZE];
+    int count_ = 0;
+    uint32_t next_token_ = 1;
+};
@@ -0,0 +1,352 @@
+#include "otto_actions.h"
+
+#include <esp_log.h>
+
+#include <cstdlib>
+
+#include "otto_action_program.h"
+#include "otto_movements.h"
+
+#define TAG "OttoActions"
+
+int OttoWebOpActions(uint8_t op, int param1, int param2, WebOpAction out[WEB_OP_MAX_ACTIONS]) {
+    int n = 0;
+    auto add = [&](int action_type, int steps, int speed, int priority = OTTO_PRIORITY_NORMAL) {
+        out[n++] = {action_type, steps, speed, priority};
+    };
+
+    switch (op) {
+    case ACTION_OP_WALK_BACK: add(ACTION_DOG_WALK_BACK, param1, param2); break;
+    case ACTION_OP_WALK: add(ACTION_DOG_WALK, param1, param2); break;
+    case ACTION_OP_TURN_LEFT: add(ACTION_DOG_TURN_LEFT, abs(param1), param2); break;
+    case ACTION_OP_TURN_RIGHT: add(ACTION_DOG_TURN_RIGHT, param1, param2); break;
+    case ACTION_OP_SIT: add(ACTION_DOG_SIT_DOWN, 1, param2); break;
+    case ACTION_OP_LIE: add(ACTION_DOG_LIE_DOWN, 1, param2); break;
+    case ACTION_OP_BOW: add(ACTION_DOG_BOW, 1, param2); break;
+    case ACTION_OP_JUMP: add(ACTION_DOG_JUMP, 1, param2); break;
+    case ACTION_OP_DANCE: add(ACTION_DOG_DANCE, param1, param2); break;
+    case ACTION_OP_WAVE: add(ACTION_DOG_WAVE_RIGHT_FOOT, param1, param2); break;
+    case ACTION_OP_SWING: add(ACTION_DOG_SWING, param1, param2); break;
+    case ACTION_OP_STRETCH: add(ACTION_DOG_STRETCH, param1, param2); break;
+    case ACTION_OP_SCRATCH: add(ACTION_DOG_SCRATCH, param1, param2); break;
+    case ACTION_OP_WAG_TAIL: add(ACTION_DOG_WAG_TAIL, param1, param2); break;
+    case ACTION_OP_DEFEND:
+        // Walk back EXACTLY 1 journey -> sit (3000) -> lie (1500) -> delay(3000) -> home
+        add(ACTION_DOG_WALK_BACK, 1, 100);
+        add(ACTION_DOG_SIT_DOWN, 1, 3000);
+        add(ACTION_DOG_LIE_DOWN, 1, 1500);
+        add(ACTION_DELAY, 0, 3000);
+        add(ACTION_HOME, 1, 500);
+        break;
+    case ACTION_OP_HOME:
+        // Home is the web UI's "stop": it jumps the queue and cuts the running action short
+        add(ACTION_HOME, 1, param2, OTTO_PRIORITY_URGENT);
+        break;
+    case ACTION_OP_DANCE_4_FEET: add(ACTION_DOG_DANCE_4_FEET, param1, param2); break;
+    case ACTION_OP_GREET:
+        // Home → wave → bow
+        add(ACTION_HOME, 1, 500);
+        add(ACTION_DOG_WAVE_RIGHT_FOOT, 3, 150);
+        add(ACTION_DOG_BOW, 2, 150);
+        break;
+    case ACTION_OP_ATTACK:
+        // Forward → jump → bow
+        add(ACTION_DOG_WALK, 2, 100);
+        add(ACTION_DOG_JUMP, 2, 200);
+        add(ACTION_DOG_BOW, 1, 150);
+        break;
+    case ACTION_OP_CELEBRATE:
+        // Dance → wave → swing
+        add(ACTION_DOG_DANCE, 2, 200);
+        add(ACTION_DOG_WAVE_RIGHT_FOOT, 5, 100);
+        add(ACTION_DOG_SWING, 3, 10);
+        break;
+    case ACTION_OP_SEARCH:
+        // Look left → look right → walk forward
+        add(ACTION_DOG_TURN_LEFT, 2, 150);
+        add(ACTION_DOG_TURN_RIGHT, 4, 150);
+        add(ACTION_DOG_TURN_LEFT, 2, 150);
+        add(ACTION_DOG_WALK, 3, 120);
+        break;
+    case ACTION_OP_ROLL_OVER: add(ACTION_DOG_ROLL_OVER, param1 > 0 ? param1 : 1, param2 > 0 ? param2 : 200); break;
+    case ACTION_OP_PLAY_DEAD: add(ACTION_DOG_PLAY_DEAD, 1, param1 > 0 ? param1 : 5); break;  // speed = seconds
+    case ACTION_OP_SHAKE_PAW: add(ACTION_DOG_SHAKE_PAW, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150); break;
+    case ACTION_OP_PUSHUP: add(ACTION_DOG_PUSHUP, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150); break;
+    case ACTION_OP_BALANCE: add(ACTION_DOG_BALANCE, param1 > 0 ? param1 : 2000, param2 > 0 ? param2 : 150); break;
+    default:
+        // stop, show_clock: no queued action
+        break;
+    }
+    return n;
+}
+
+const char* OttoWebOpEmotion(uint8_t op) {
+    switch (op) {
+    case ACTION_OP_JUMP:
+    case ACTION_OP_ATTACK:
+        return "angry";
+    case ACTION_OP_DANCE:
+    case ACTION_OP_SWING:
+    case ACTION_OP_WAG_TAIL:
+    case ACTION_OP_DANCE_4_FEET:
+    case ACTION_OP_GREET:
+    case ACTION_OP_CELEBRATE:
+        return "happy";
+    case ACTION_OP_STRETCH:
+        return "sleepy";
+    case ACTION_OP_DEFEND:
+    case ACTION_OP_PLAY_DEAD:
+        return "shocked";
+    case ACTION_OP_SEARCH:
+        return "scared";  // Cautious
+    case ACTION_OP_ROLL_OVER:
+        return "excited";
+    default:
+        return nullptr;
+    }
+}
+
+ActionCoalesce OttoActionCoalesceMode(int action_type) {
+    switch (action_type) {
+    case ACTION_DOG_WALK:
+    case ACTION_DOG_WALK_BACK:
+    case ACTION_DOG_TURN_LEFT:
+    case ACTION_DOG_TURN_RIGHT:
+    case ACTION_WALK:
+    case ACTION_TURN:
+        return ACTION_COALESCE_STEPS;
+    case ACTION_DOG_SIT_DOWN:
+    case ACTION_DOG_LIE_DOWN:
+    case ACTION_DOG_STAND_UP:
+    case ACTION_HOME:
+        return ACTION_COALESCE_SAME;
+    default:
+        return ACTION_COALESCE_NONE;
+    }
+}
+
+const char* OttoActionName(int action_type) {
+    switch (action_type) {
+    case ACTION_DOG_WALK: return "walk";
+    case ACTION_DOG_WALK_BACK: return "walk_back";
+    case ACTION_DOG_TURN_LEFT: return "turn_left";
+    case ACTION_DOG_TURN_RIGHT: return "turn_right";
+    case ACTION_DOG_SIT_DOWN: return "sit_down";
+    case ACTION_DOG_LIE_DOWN: return "lie_down";
+    case ACTION_DOG_JUMP: return "jump";
+    case ACTION_DOG_BOW: return "bow";
+    case ACTION_DOG_DANCE: return "dance";
+    case ACTION_DOG_WAVE_RIGHT_FOOT: return "wave_right_foot";
+    case ACTION_DOG_DANCE_4_FEET: return "dance_4_feet";
+    case ACTION_DOG_SWING: return "swing";
+    case ACTION_DOG_STRETCH: return "stretch";
+    case ACTION_DOG_SCRATCH: return "scratch";
+    case ACTION_WALK: return "legacy_walk";
+    case ACTION_TURN: return "legacy_turn";
+    case ACTION_JUMP: return "legacy_jump";
+    case ACTION_BEND: return "bend";
+    case ACTION_HOME: return "home";
+    case ACTION_DELAY: return "delay";
+    case ACTION_DOG_JUMP_HAPPY: return "jump_happy";
+    case ACTION_DOG_WAG_TAIL: return "wag_tail";
+    case ACTION_DOG_ROLL_OVER: return "roll_over";
+    case ACTION_DOG_PLAY_DEAD: return "play_dead";
+    case ACTION_DOG_SHAKE_PAW: return "shake_paw";
+    case ACTION_DOG_SIDESTEP: return "sidestep";
+    case ACTION_DOG_PUSHUP: return "pushup";
+    case ACTION_DOG_BALANCE: return "balance";
+    case ACTION_DOG_TOILET: return "toilet";
+    case ACTION_DOG_STAND_UP: return "stand_up";
+    case ACTION_DOG_BEAT_STEP: return "beat_step";
+    default: return "unknown";
+    }
+}
+
+bool OttoPlayAction(Otto& otto, const QueuedAction& params, const OttoActionHooks& hooks) {
+    auto emotion = [&](const char* name) {
+        if (hooks.set_emotion) hooks.set_emotion(name);
+    };
+
+    switch (params.action_type) {
+    // Dog-style movement actions
+    case ACTION_DOG_WALK:
+        otto.DogWalk(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after walk
+        break;
+    case ACTION_DOG_WALK_BACK:
+        ESP_LOGI(TAG, "🐕 DogWalkBack: steps=%d, speed=%d", params.steps, params.speed);
+        otto.DogWalkBack(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after walk back
+        break;
+    case ACTION_DOG_TURN_LEFT:
+        ESP_LOGI(TAG, "🐕 DogTurnLeft: steps=%d, speed=%d", params.steps, params.speed);
+        otto.DogTurnLeft(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after turn
+        break;
+    case ACTION_DOG_TURN_RIGHT:
+        ESP_LOGI(TAG, "🐕 DogTurnRight: steps=%d, speed=%d", params.steps, params.speed);
+        otto.DogTurnRight(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after turn
+        break;
+    case ACTION_DOG_SIT_DOWN:
+        ESP_LOGI(TAG, "🐕 DogSitDown: speed=%d", params.speed);
+        otto.DogSitDown(params.speed);
+        otto.WagTail(3, 100); // Wag tail after sit
+        break;
+    case ACTION_DOG_LIE_DOWN:
+        ESP_LOGI(TAG, "🐕 DogLieDown: speed=%d (no tail wag)", params.speed);
+        otto.DogLieDown(params.speed);
+        // NO tail wag for lie down
+        break;
+    case ACTION_DOG_JUMP:
+        // Show angry emoji on jump and keep until complete
+        emotion("angry");
+        otto.DogJump(params.speed);
+        otto.WagTail(3, 100); // Wag tail after jump
+        emotion("neutral");
+        break;
+    case ACTION_DOG_JUMP_HAPPY:
+        // Touch-triggered happy jump
+        emotion("happy");
+        otto.DogJump(params.speed);
+        otto.WagTail(3, 100); // Wag tail after happy jump
+        emotion("neutral");
+        break;
+    case ACTION_DOG_BOW:
+        otto.DogBow(params.speed);
+        otto.WagTail(3, 100); // Wag tail after bow
+        break;
+    case ACTION_DOG_DANCE:
+        otto.DogDance(params.steps, params.speed);
+        otto.WagTail(5, 80); // More energetic tail wag after dance
+        break;
+    case ACTION_DOG_WAVE_RIGHT_FOOT:
+        otto.DogWaveRightFoot(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after wave
+        break;
+    case ACTION_DOG_DANCE_4_FEET:
+        otto.DogDance4Feet(params.steps, params.speed);
+        otto.WagTail(5, 80); // More energetic tail wag after dance
+        break;
+    case ACTION_DOG_SWING:
+        otto.DogSwing(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after swing
+        break;
+    case ACTION_DOG_STRETCH:
+        // Always show sleepy emoji during stretch and keep until complete
+        emotion("sleepy");
+        otto.DogStretch(params.steps, params.speed);
+        // NO tail wag for stretch (too sleepy!)
+        emotion("neutral");
+        break;
+    case ACTION_DOG_SCRATCH:
+        ESP_LOGI(TAG, "🐕 DogScratch: scratches=%d, speed=%d", params.steps, params.speed);
+        otto.DogScratch(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after scratch
+        break;
+    case ACTION_DOG_WAG_TAIL:
+        ESP_LOGI(TAG, "🐕 WagTail: wags=%d, speed=%d", params.steps, params.speed);
+        otto.WagTail(params.steps, params.speed);
+        break;
+
+    case ACTION_DOG_ROLL_OVER:
+        ESP_LOGI(TAG, "🔄 DogRollOver: rolls=%d, speed=%d", params.steps, params.speed);
+        emotion("excited");
+        // Roll over sequence: lie down → swing side to side → lie down opposite → back to home
+        otto.DogLieDown(1000);
+        hooks.pause(500);
+        otto.DogSwing(3, 10);  // Swing to simulate rolling
+        hooks.pause(500);
+        otto.DogLieDown(1000);
+        hooks.pause(500);
+        otto.Home();
+        otto.WagTail(5, 100); // Happy tail wag after roll
+        emotion("happy");
+        break;
+
+    case ACTION_DOG_PLAY_DEAD:
+        ESP_LOGI(TAG, "💀 DogPlayDead: duration=%d seconds", params.speed);
+        emotion("neutral");
+        // Play dead: lie down and stay still for specified seconds
+        otto.DogLieDown(1000);
+        hooks.pause(params.speed * 1000);  // Stay dead for speed seconds
+        // Wake up slowly
+        otto.DogSitDown(800);
+        hooks.pause(500);
+        otto.Home();
+        emotion("happy");
+        break;
+
+    // New poses (Priority 1 + 2)
+    case ACTION_DOG_SHAKE_PAW:
+        ESP_LOGI(TAG, "🤝 DogShakePaw: shakes=%d, speed=%d", params.steps, params.speed);
+        otto.DogShakePaw(params.steps, params.speed);
+        break;
+
+    case ACTION_DOG_SIDESTEP:
+        ESP_LOGI(TAG, "⬅️➡️ DogSidestep: steps=%d, speed=%d, direction=%d",
+                 params.steps, params.speed, params.direction);
+        otto.DogSidestep(params.steps, params.speed, params.direction);
+        break;
+
+    case ACTION_DOG_PUSHUP:
+        ESP_LOGI(TAG, "💪 DogPushup: pushups=%d, speed=%d", params.steps, params.speed);
+        emotion("confused");
+        otto.DogPushup(params.steps, params.speed);
+        // Keep confused emotion until pose completes (blocking LLM emoji changes)
+        hooks.pause(500);
+        emotion("happy");
+        break;
+
+    case ACTION_DOG_BALANCE:
+        ESP_LOGI(TAG, "⚖️ DogBalance: duration=%d ms, speed=%d", params.steps, params.speed);
+        otto.DogBalance(params.steps, params.speed);
+        break;
+    case ACTION_DOG_TOILET:
+        ESP_LOGI(TAG, "🚽 DogToilet: hold=%d ms, speed=%d", params.steps, params.speed);
+        otto.DogToilet(params.steps, params.speed);
+        break;
+
+    case ACTION_DOG_STAND_UP:
+        ESP_LOGI(TAG, "🧍 DogStandUp: Standing up to rest position");
+        otto.StandUp();
+        break;
+
+    case ACTION_DOG_BEAT_STEP:
+        // Pose lands on the beat; flash LEDs at the same moment
+        otto.DogBeatStep(params.direction, params.steps, params.speed);
+        if (hooks.beat_pulse) hooks.beat_pulse();
+        break;
+
+    // Legacy actions (adapted for 4 servos)
+    case ACTION_WALK:
+        otto.Walk(params.steps, params.speed, params.direction);
+        otto.WagTail(3, 100); // Wag tail after walk
+        break;
+    case ACTION_TURN:
+        otto.Turn(params.steps, params.speed, params.direction);
+        otto.WagTail(3, 100); // Wag tail after turn
+        break;
+    case ACTION_JUMP:
+        emotion("angry");
+        otto.Jump(params.steps, params.speed);
+        otto.WagTail(3, 100); // Wag tail after jump
+        emotion("neutral");
+        break;
+    case ACTION_BEND:
+        otto.Bend(params.steps, params.speed, params.direction);
+        otto.WagTail(3, 100); // Wag tail after bend
+        break;
+    case ACTION_HOME:
+        ESP_LOGI(TAG, "🏠 Going Home");
+        otto.Home();
+        break;
+    case ACTION_DELAY:
+        ESP_LOGI(TAG, "⏱️ Delay: %d ms", params.speed);
+        hooks.pause(params.speed);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
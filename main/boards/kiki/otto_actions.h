@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "otto_action_queue.h"
+
+/**
+ * @brief Bảng điều phối action của OttoController, dùng chung cho firmware và otto_motion_sim:
+ * id action, web op (otto_action_program.h) -> các action được xếp hàng, kiểu gộp của từng action,
+ * và routine action task chạy cho mỗi action.
+ *
+ * Màn hình, LED và Pause() đi qua OttoActionHooks nên file không phụ thuộc Board/MCP:
+ * simulator trên host link nguyên file này thay vì chép lại các switch.
+ */
+
+class Otto;
+
+// Otto action constants
+#define ACTION_DOG_WALK            1
+#define ACTION_DOG_WALK_BACK       2
+#define ACTION_DOG_TURN_LEFT       3
+#define ACTION_DOG_TURN_RIGHT      4
+#define ACTION_DOG_SIT_DOWN        5
+#define ACTION_DOG_LIE_DOWN        6
+#define ACTION_DOG_JUMP            7
+#define ACTION_DOG_BOW             8
+#define ACTION_DOG_DANCE           9
+#define ACTION_DOG_WAVE_RIGHT_FOOT 10
+#define ACTION_DOG_DANCE_4_FEET    11
+#define ACTION_DOG_SWING           12
+#define ACTION_DOG_STRETCH         13
+#define ACTION_DOG_SCRATCH         14  // New: Sit + BR leg wave (gãi ngứa)
+#define ACTION_DOG_WAG_TAIL        22  // New: Wag tail movement
+#define ACTION_DOG_ROLL_OVER       23  // New: Roll over movement
+#define ACTION_DOG_PLAY_DEAD       24  // New: Play dead movement
+
+// New poses (Priority 1 + 2)
+#define ACTION_DOG_SHAKE_PAW       25  // New: Shake paw (bắt tay)
+#define ACTION_DOG_SIDESTEP        26  // New: Sidestep (đi ngang)
+#define ACTION_DOG_PUSHUP          27  // New: Pushup exercise
+#define ACTION_DOG_BALANCE         28  // New: Balance on hind legs
+#define ACTION_DOG_TOILET          29  // New: Toilet squat pose
+#define ACTION_DOG_STAND_UP        30  // New: Stand up from sitting/lying position
+#define ACTION_DOG_BEAT_STEP       31  // One dance pose timed to a music beat (direction=style, steps=beat, speed=move ms)
+
+// Legacy actions (adapted for 4 servos)
+#define ACTION_WALK                15
+#define ACTION_TURN                16
+#define ACTION_JUMP                17
+#define ACTION_BEND                18
+#define ACTION_HOME                19
+// Utility
+#define ACTION_DELAY               20  // speed field as milliseconds delay
+#define ACTION_DOG_JUMP_HAPPY      21  // special: jump with happy emoji (touch)
+
+#define WEB_OP_MAX_ACTIONS 5  // Chuỗi dài nhất (defend)
+
+struct WebOpAction {
+    int action_type;
+    int steps;
+    int speed;
+    int priority;
+};
+
+// Các action một web op xếp hàng, theo thứ tự. Trả về số action; 0 với stop và show_clock
+// (người gọi tự xử lý) hoặc op lạ
+int OttoWebOpActions(uint8_t op, int param1, int param2, WebOpAction out[WEB_OP_MAX_ACTIONS]);
+
+// Biểu cảm hiện lúc xếp hàng op, nullptr nếu giữ nguyên
+const char* OttoWebOpEmotion(uint8_t op);
+
+// Dáng đi cộng số bước, tư thế lặp lại bị bỏ, còn lại xếp hàng nguyên
+ActionCoalesce OttoActionCoalesceMode(int action_type);
+
+// Tên ngắn cho log ("walk", "bow"...), "unknown" nếu id lạ
+const char* OttoActionName(int action_type);
+
+struct OttoActionHooks {
+    std::function<bool(int ms)> pause;             // OttoController::Pause: false nếu bị lệnh khẩn ngắt
+    std::function<void(const char*)> set_emotion;  // Có thể rỗng
+    std::function<void()> beat_pulse;              // Nháy LED đúng phách, có thể rỗng
+};
+
+// Switch của ActionTask: chạy routine của một action. Trả về false nếu id lạ
+bool OttoPlayAction(Otto& otto, const QueuedAction& action, const OttoActionHooks& hooks);
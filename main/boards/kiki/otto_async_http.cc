@@ -0,0 +1,230 @@
+#include "otto_async_http.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#define TAG "OttoAsync"
+
+namespace {
+
+constexpr int kWorkerCount = 2;
+constexpr int kMaxInFlight = 4;        // Đang chạy + đang chờ worker
+constexpr int kWorkerStackSize = 8192; // Bằng stack httpd mà các handler vốn chạy trên đó
+constexpr int kMaxEndpoints = 12;
+constexpr int kDrainTimeoutMs = 10000; // Chờ request đang chạy xong trước khi dừng server
+
+struct EndpointStats {
+    uint32_t calls = 0;
+    uint32_t shed = 0;
+    uint32_t errors = 0;
+    uint64_t total_us = 0;
+    uint32_t max_us = 0;
+    uint32_t max_wait_us = 0;
+};
+
+struct Endpoint {
+    char uri[48];
+    httpd_method_t method;
+    esp_err_t (*handler)(httpd_req_t* req);
+    EndpointStats stats;
+};
+
+struct AsyncJob {
+    httpd_req_t* req;
+    Endpoint* endpoint;
+    int64_t queued_us;
+};
+
+QueueHandle_t job_queue = nullptr;
+SemaphoreHandle_t slots = nullptr;
+std::atomic<bool> accepting{false};  // false từ lúc drain đến khi server bật lại
+std::mutex stats_mutex;
+Endpoint endpoints[kMaxEndpoints];
+int endpoint_count = 0;
+
+void WorkerTask(void* arg) {
+    AsyncJob job;
+    while (true) {
+        if (xQueueReceive(job_queue, &job, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t ret = job.endpoint->handler(job.req);
+        int64_t end_us = esp_timer_get_time();
+        httpd_req_async_handler_complete(job.req);
+        xSemaphoreGive(slots);
+
+        uint32_t run_us = end_us - start_us;
+        uint32_t wait_us = start_us - job.queued_us;
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        EndpointStats& stats = job.endpoint->stats;
+        stats.calls++;
+        stats.errors += ret != ESP_OK ? 1 : 0;
+        stats.total_us += run_us;
+        stats.max_us = std::max(stats.max_us, run_us);
+        stats.max_wait_us = std::max(stats.max_wait_us, wait_us);
+        if (run_us > 1000 * 1000) {
+            ESP_LOGI(TAG, "%s took %lums (waited %lums)", job.endpoint->uri, (unsigned long)(run_us / 1000),
+                     (unsigned long)(wait_us / 1000));
+        }
+    }
+}
+
+esp_err_t Shed(httpd_req_t* req, Endpoint* endpoint) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        endpoint->stats.shed++;
+    }
+    ESP_LOGW(TAG, "⚠️ Busy, shedding %s", endpoint->uri);
+    httpd_resp_set_status(req, "503 Service Unavailable");
+    httpd_resp_set_hdr(req, "Retry-After", "1");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"Robot đang bận, thử lại sau\"}");
+}
+
+// Handler thật được httpd gọi: chỉ chuyển request sang worker rồi trả về ngay
+esp_err_t AsyncTrampoline(httpd_req_t* req) {
+    auto* endpoint = static_cast<Endpoint*>(req->user_ctx);
+    if (!accepting || xSemaphoreTake(slots, 0) != pdTRUE) {
+        return Shed(req, endpoint);
+    }
+
+    httpd_req_t* copy = nullptr;
+    if (httpd_req_async_handler_begin(req, &copy) != ESP_OK) {
+        // Không tách được request: chạy đồng bộ như trước
+        xSemaphoreGive(slots);
+        return endpoint->handler(req);
+    }
+    AsyncJob job = {copy, endpoint, esp_timer_get_time()};
+    if (xQueueSend(job_queue, &job, 0) != pdTRUE) {
+        // Socket đã thuộc về bản copy, trả lời trên đó
+        Shed(copy, endpoint);
+        httpd_req_async_handler_complete(copy);
+        xSemaphoreGive(slots);
+    }
+    return ESP_OK;
+}
+
+esp_err_t StatsHandler(httpd_req_t* req) {
+    std::string json = "{\"workers\":" + std::to_string(kWorkerCount) + ",\"max_in_flight\":" +
+                       std::to_string(kMaxInFlight) + ",\"in_flight\":" +
+                       std::to_string(kMaxInFlight - (int)uxSemaphoreGetCount(slots)) + ",\"endpoints\":[";
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        for (int i = 0; i < endpoint_count; i++) {
+            const Endpoint& endpoint = endpoints[i];
+            const EndpointStats& stats = endpoint.stats;
+            char item[256];
+            snprintf(item, sizeof(item),
+                     "%s{\"uri\":\"%s\",\"method\":\"%s\",\"calls\":%lu,\"shed\":%lu,\"errors\":%lu,"
+                     "\"avg_ms\":%lu,\"max_ms\":%lu,\"max_wait_ms\":%lu}",
+                     i > 0 ? "," : "", endpoint.uri, endpoint.method == HTTP_POST ? "POST" : "GET",
+                     (unsigned long)stats.calls, (unsigned long)stats.shed, (unsigned long)stats.errors,
+                     (unsigned long)(stats.calls > 0 ? stats.total_us / stats.calls / 1000 : 0),
+                     (unsigned long)(stats.max_us / 1000), (unsigned long)(stats.max_wait_us / 1000));
+            json += item;
+        }
+    }
+    json += "]}";
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    return httpd_resp_send(req, json.c_str(), json.size());
+}
+
+}  // namespace
+
+esp_err_t otto_async_pool_start(httpd_handle_t server) {
+    if (job_queue == nullptr) {
+        job_queue = xQueueCreate(kMaxInFlight, sizeof(AsyncJob));
+        slots = xSemaphoreCreateCounting(kMaxInFlight, kMaxInFlight);
+        if (job_queue == nullptr || slots == nullptr) {
+            ESP_LOGE(TAG, "Failed to create async queue");
+            return ESP_ERR_NO_MEM;
+        }
+        // Worker sống suốt vòng đời firmware, dùng lại khi web server bật lại
+        for (int i = 0; i < kWorkerCount; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "http_async%d", i);
+            if (xTaskCreate(WorkerTask, name, kWorkerStackSize, nullptr, tskIDLE_PRIORITY + 5, nullptr) != pdPASS) {
+                ESP_LOGE(TAG, "Failed to create %s", name);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        ESP_LOGI(TAG, "✅ %d HTTP workers ready (max %d requests in flight)", kWorkerCount, kMaxInFlight);
+    }
+    accepting = true;
+
+    httpd_uri_t stats_uri = {};
+    stats_uri.uri = "/async_stats";
+    stats_uri.method = HTTP_GET;
+    stats_uri.handler = StatsHandler;
+    return httpd_register_uri_handler(server, &stats_uri);
+}
+
+esp_err_t otto_async_register_uri(httpd_handle_t server, const httpd_uri_t* uri) {
+    if (job_queue == nullptr) {
+        return httpd_register_uri_handler(server, uri);
+    }
+
+    // Cùng uri + method khi server khởi động lại: giữ nguyên thống kê
+    Endpoint* endpoint = nullptr;
+    for (int i = 0; i < endpoint_count; i++) {
+        if (endpoints[i].method == uri->method && strcmp(endpoints[i].uri, uri->uri) == 0) {
+            endpoint = &endpoints[i];
+            break;
+        }
+    }
+    if (endpoint == nullptr) {
+        if (endpoint_count >= kMaxEndpoints) {
+            ESP_LOGW(TAG, "Too many async endpoints, %s stays synchronous", uri->uri);
+            return httpd_register_uri_handler(server, uri);
+        }
+        endpoint = &endpoints[endpoint_count++];
+        strncpy(endpoint->uri, uri->uri, sizeof(endpoint->uri) - 1);
+        endpoint->method = uri->method;
+    }
+    endpoint->handler = uri->handler;
+
+    httpd_uri_t async_uri = *uri;
+    async_uri.handler = AsyncTrampoline;
+    async_uri.user_ctx = endpoint;
+    return httpd_register_uri_handler(server, &async_uri);
+}
+
+esp_err_t otto_async_pool_drain(void) {
+    if (job_queue == nullptr) {
+        return ESP_OK;
+    }
+    accepting = false;
+
+    // Mỗi request đang chạy/chờ giữ một slot: lấy đủ kMaxInFlight slot là worker đã xong hết
+    int64_t deadline_us = esp_timer_get_time() + (int64_t)kDrainTimeoutMs * 1000;
+    int taken = 0;
+    while (taken < kMaxInFlight) {
+        int64_t left_ms = (deadline_us - esp_timer_get_time()) / 1000;
+        if (left_ms <= 0 || xSemaphoreTake(slots, pdMS_TO_TICKS(left_ms)) != pdTRUE) {
+            break;
+        }
+        taken++;
+    }
+    for (int i = 0; i < taken; i++) {
+        xSemaphoreGive(slots);
+    }
+    if (taken < kMaxInFlight) {
+        accepting = true;  // Server vẫn chạy, nhận request lại
+        ESP_LOGE(TAG, "❌ %d async requests still running after %dms", kMaxInFlight - taken, kDrainTimeoutMs);
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <esp_http_server.h>
+
+/**
+ * @brief Worker pool cho các endpoint chậm (/draw, /api/ai/send, ...).
+ *
+ * httpd chỉ có một task: một request chậm làm treo cả web UI. Endpoint đăng ký
+ * qua otto_async_register_uri() được chuyển sang worker bằng
+ * httpd_req_async_handler_begin(), handler gốc chạy nguyên vẹn trên worker.
+ * Số request đang xử lý + chờ bị giới hạn; khi đầy trả 503 + Retry-After ngay
+ * thay vì xếp hàng vô hạn. Thời gian chờ/xử lý từng endpoint xem ở /async_stats.
+ */
+
+// Tạo worker (một lần) và đăng ký /async_stats trên server này
+esp_err_t otto_async_pool_start(httpd_handle_t server);
+
+// Như httpd_register_uri_handler, nhưng handler chạy trên worker pool
+esp_err_t otto_async_register_uri(httpd_handle_t server, const httpd_uri_t* uri);
+
+// Ngừng nhận request mới (trả 503) và chờ worker xử lý xong các request đang giữ.
+// Gọi trước httpd_stop: worker còn chạy sẽ dùng server đã bị giải phóng.
+// ESP_ERR_TIMEOUT nếu quá lâu; khi đó pool nhận request lại và server phải giữ nguyên
+esp_err_t otto_async_pool_drain(void);
@@ -5,9 +5,13 @@
 #include <cJSON.h>
 #include <esp_log.h>
 #include <esp_netif.h>
+#include <esp_timer.h>
+#include <freertos/event_groups.h>
 #include <nvs.h>
 
+#include <algorithm>
 #include <cstring>
+#include <mutex>
 
 #include "application.h"
 #include "board.h"
@@ -19,6 +23,8 @@
 #include "sdkconfig.h"
 #include "settings.h"
 #include "kiki_led_control.h"
+#include "otto_action_queue.h"
+#include "otto_actions.h"
 
 // Forward declarations for web server control
 extern "C" {
@@ -31,7 +37,10 @@ extern "C" {
 }
 
 #define TAG "OttoController"
-#define ACTION_DOG_WAG_TAIL 22
+
+// action_events_ bits
+#define QUEUE_READY_BIT    BIT0  // Something was queued
+#define QUEUE_PREEMPT_BIT  BIT1  // An urgent command wants the servos, cut the running action short
 
 // Static timer for QR display reset (avoids creating new tasks)
 static TimerHandle_t qr_reset_timer = nullptr;
@@ -47,8 +56,15 @@ class OttoController {
 private:
     Otto otto_;
     TaskHandle_t action_task_handle_ = nullptr;
-    QueueHandle_t action_queue_;
-    bool is_action_in_progress_ = false;
+    // Priority queue with cancel tokens (otto_action_queue.h); queue_mutex_ guards it and the
+    // running_/preempt_/latency_ fields below
+    std::mutex queue_mutex_;
+    ActionQueue action_queue_;
+    EventGroupHandle_t action_events_ = nullptr;
+    uint32_t running_token_ = 0;  // 0: no action running
+    uint8_t running_priority_ = OTTO_PRIORITY_NORMAL;
+    int64_t preempt_request_us_ = 0;  // When the pending preemption was asked for, 0 if none
+    OttoLatencyStats latency_ = {};
     // Idle management
     // Accumulated idle time in milliseconds (we increment by LOOP_IDLE_INCREMENT_MS each idle cycle)
     int idle_no_action_ticks_ = 0;    // milliseconds without actions
@@ -56,55 +72,9 @@ private:
     static constexpr int LOOP_IDLE_INCREMENT_MS = 20;   // Each idle loop adds 20 ms (vTaskDelay(20ms))
     bool idle_mode_ = false;          // true when idle behavior is active
 
-    struct OttoActionParams {
-        int action_type;
-        int steps;
-        int speed;
-        int direction;
-        int amount;
-    };
-
-    enum ActionType {
-        // Dog-style movement actions (new)
-        ACTION_DOG_WALK = 1,
-        ACTION_DOG_WALK_BACK = 2,
-        ACTION_DOG_TURN_LEFT = 3,
-        ACTION_DOG_TURN_RIGHT = 4,
-        ACTION_DOG_SIT_DOWN = 5,
-        ACTION_DOG_LIE_DOWN = 6,
-        ACTION_DOG_JUMP = 7,
-        ACTION_DOG_BOW = 8,
-        ACTION_DOG_DANCE = 9,
-        ACTION_DOG_WAVE_RIGHT_FOOT = 10,
-        ACTION_DOG_DANCE_4_FEET = 11,
-        ACTION_DOG_SWING = 12,
-        ACTION_DOG_STRETCH = 13,
-        ACTION_DOG_SCRATCH = 14,  // New: Sit + BR leg scratch (gãi ngứa)
-        
-        // Legacy actions (adapted for 4 servos)
-        ACTION_WALK = 15,
-        ACTION_TURN = 16,
-        ACTION_JUMP = 17,
-        ACTION_BEND = 18,
-        ACTION_HOME = 19,
-        // Utility actions
-        ACTION_DELAY = 20,  // Delay in milliseconds, use 'speed' as delay duration
-        ACTION_DOG_JUMP_HAPPY = 21,  // Special: Jump with happy emoji (for touch sensor)
-        ACTION_DOG_ROLL_OVER = 23,  // New: Roll over movement
-        ACTION_DOG_PLAY_DEAD = 24,  // New: Play dead movement
-        
-        // New poses (Priority 1 + 2)
-        ACTION_DOG_SHAKE_PAW = 25,  // New: Shake paw (bắt tay)
-        ACTION_DOG_SIDESTEP = 26,  // New: Sidestep (đi ngang)
-    ACTION_DOG_PUSHUP = 27,  // New: Pushup exercise
-    ACTION_DOG_BALANCE = 28,  // New: Balance on hind legs
-    ACTION_DOG_TOILET = 29,  // New: Toilet squat pose
-    ACTION_DOG_STAND_UP = 30  // New: Stand up from sitting/lying
-    };
-
     static void ActionTask(void* arg) {
         OttoController* controller = static_cast<OttoController*>(arg);
-        OttoActionParams params;
+        QueuedAction params;
         
         ESP_LOGI(TAG, "🚀 ActionTask started! Attaching servos...");
         controller->otto_.AttachServos();
@@ -112,10 +82,14 @@ private:
 
         while (true) {
             // Use shorter timeout (100ms) for faster response to new actions
-            if (xQueueReceive(controller->action_queue_, &params, pdMS_TO_TICKS(100)) == pdTRUE) {
-                ESP_LOGI(TAG, "⚡ Executing action: type=%d, steps=%d, speed=%d", 
-                         params.action_type, params.steps, params.speed);
-                controller->is_action_in_progress_ = true;
+            if (controller->WaitAction(&params)) {
+                // Beat steps arrive twice a second while dancing to music - keep them quiet
+                bool verbose = params.action_type != ACTION_DOG_BEAT_STEP;
+                if (verbose) {
+                    ESP_LOGI(TAG, "⚡ Executing action: %s (type=%d), steps=%d, speed=%d, priority=%d, queued %lld us",
+                             OttoActionName(params.action_type), params.action_type, params.steps, params.speed, params.priority,
+                             esp_timer_get_time() - params.enqueue_us);
+                }
                 controller->idle_no_action_ticks_ = 0; // reset idle timer on new action
                 
                 // Exit idle mode and re-attach servos if needed
@@ -142,214 +116,24 @@ private:
                 }
                 controller->idle_mode_ = false;
 
-                switch (params.action_type) {
-                    // Dog-style movement actions
-                    case ACTION_DOG_WALK:
-                        controller->otto_.DogWalk(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after walk
-                        break;
-                    case ACTION_DOG_WALK_BACK:
-                        ESP_LOGI(TAG, "🐕 DogWalkBack: steps=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogWalkBack(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after walk back
-                        break;
-                    case ACTION_DOG_TURN_LEFT:
-                        ESP_LOGI(TAG, "🐕 DogTurnLeft: steps=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogTurnLeft(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after turn
-                        break;
-                    case ACTION_DOG_TURN_RIGHT:
-                        ESP_LOGI(TAG, "🐕 DogTurnRight: steps=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogTurnRight(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after turn
-                        break;
-                    case ACTION_DOG_SIT_DOWN:
-                        ESP_LOGI(TAG, "🐕 DogSitDown: speed=%d", params.speed);
-                        controller->otto_.DogSitDown(params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after sit
-                        break;
-                    case ACTION_DOG_LIE_DOWN:
-                        ESP_LOGI(TAG, "🐕 DogLieDown: speed=%d (no tail wag)", params.speed);
-                        controller->otto_.DogLieDown(params.speed);
-                        // NO tail wag for lie down
-                        break;
-                    case ACTION_DOG_JUMP:
-                        {
-                            // Show angry emoji on jump and keep until complete
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("angry");
-                            controller->otto_.DogJump(params.speed);
-                            controller->otto_.WagTail(3, 100); // Wag tail after jump
-                            // Reset to neutral after jump completes
-                            if (display) display->SetEmotion("neutral");
-                        }
-                        break;
-                    case ACTION_DOG_JUMP_HAPPY:
-                        {
-                            // Touch-triggered happy jump
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("happy");
-                            controller->otto_.DogJump(params.speed);
-                            controller->otto_.WagTail(3, 100); // Wag tail after happy jump
-                            // Reset to neutral after jump completes
-                            if (display) display->SetEmotion("neutral");
-                        }
-                        break;
-                    case ACTION_DOG_BOW:
-                        controller->otto_.DogBow(params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after bow
-                        break;
-                    case ACTION_DOG_DANCE:
-                        controller->otto_.DogDance(params.steps, params.speed);
-                        controller->otto_.WagTail(5, 80); // More energetic tail wag after dance
-                        break;
-                    case ACTION_DOG_WAVE_RIGHT_FOOT:
-                        controller->otto_.DogWaveRightFoot(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after wave
-                        break;
-                    case ACTION_DOG_DANCE_4_FEET:
-                        controller->otto_.DogDance4Feet(params.steps, params.speed);
-                        controller->otto_.WagTail(5, 80); // More energetic tail wag after dance
-                        break;
-                    case ACTION_DOG_SWING:
-                        controller->otto_.DogSwing(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after swing
-                        break;
-                    case ACTION_DOG_STRETCH:
-                        {
-                            // Always show sleepy emoji during stretch and keep until complete
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("sleepy");
-                            controller->otto_.DogStretch(params.steps, params.speed);
-                            // NO tail wag for stretch (too sleepy!)
-                            // Reset to neutral after stretch completes
-                            if (display) display->SetEmotion("neutral");
-                        }
-                        break;
-                    case ACTION_DOG_SCRATCH:
-                        ESP_LOGI(TAG, "🐕 DogScratch: scratches=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogScratch(params.steps, params.speed);
-                        controller->otto_.WagTail(3, 100); // Wag tail after scratch
-                        break;
-                    case ACTION_DOG_WAG_TAIL:
-                        ESP_LOGI(TAG, "🐕 WagTail: wags=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.WagTail(params.steps, params.speed);
-                        break;
-                    
-                    case ACTION_DOG_ROLL_OVER:
-                        {
-                            ESP_LOGI(TAG, "🔄 DogRollOver: rolls=%d, speed=%d", params.steps, params.speed);
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("excited");
-                            // Roll over sequence: lie down → swing side to side → lie down opposite → back to home
-                            controller->otto_.DogLieDown(1000);
-                            vTaskDelay(pdMS_TO_TICKS(500));
-                            controller->otto_.DogSwing(3, 10);  // Swing to simulate rolling
-                            vTaskDelay(pdMS_TO_TICKS(500));
-                            controller->otto_.DogLieDown(1000);
-                            vTaskDelay(pdMS_TO_TICKS(500));
-                            controller->otto_.Home();
-                            controller->otto_.WagTail(5, 100); // Happy tail wag after roll
-                            if (display) display->SetEmotion("happy");
-                        }
-                        break;
-                    
-                    case ACTION_DOG_PLAY_DEAD:
-                        {
-                            ESP_LOGI(TAG, "💀 DogPlayDead: duration=%d seconds", params.speed);
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("neutral");
-                            // Play dead: lie down and stay still for specified seconds
-                            controller->otto_.DogLieDown(1000);
-                            vTaskDelay(pdMS_TO_TICKS(params.speed * 1000));  // Stay dead for speed seconds
-                            // Wake up slowly
-                            controller->otto_.DogSitDown(800);
-                            vTaskDelay(pdMS_TO_TICKS(500));
-                            controller->otto_.Home();
-                            if (display) display->SetEmotion("happy");
-                        }
-                        break;
-                    
-                    // New poses (Priority 1 + 2)
-                    case ACTION_DOG_SHAKE_PAW:
-                        ESP_LOGI(TAG, "🤝 DogShakePaw: shakes=%d, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogShakePaw(params.steps, params.speed);
-                        break;
-                    
-                    case ACTION_DOG_SIDESTEP:
-                        ESP_LOGI(TAG, "⬅️➡️ DogSidestep: steps=%d, speed=%d, direction=%d", 
-                                 params.steps, params.speed, params.direction);
-                        controller->otto_.DogSidestep(params.steps, params.speed, params.direction);
-                        break;
-                    
-                    case ACTION_DOG_PUSHUP:
-                        {
-                            ESP_LOGI(TAG, "💪 DogPushup: pushups=%d, speed=%d", params.steps, params.speed);
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("confused");
-                            // Execute pushup movement
-                            controller->otto_.DogPushup(params.steps, params.speed);
-                            // Keep confused emotion until pose completes (blocking LLM emoji changes)
-                            vTaskDelay(pdMS_TO_TICKS(500));
-                            if (display) display->SetEmotion("happy");
-                        }
-                        break;
-                    
-                    case ACTION_DOG_BALANCE:
-                        ESP_LOGI(TAG, "⚖️ DogBalance: duration=%d ms, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogBalance(params.steps, params.speed);
-                        break;
-                    case ACTION_DOG_TOILET:
-                        ESP_LOGI(TAG, "🚽 DogToilet: hold=%d ms, speed=%d", params.steps, params.speed);
-                        controller->otto_.DogToilet(params.steps, params.speed);
-                        break;
-                    
-                    case ACTION_DOG_STAND_UP:
-                        ESP_LOGI(TAG, "🧍 DogStandUp: Standing up to rest position");
-                        controller->otto_.StandUp();
-                        break;
-                        
-                    // Legacy actions (adapted for 4 servos)
-                    case ACTION_WALK:
-                        controller->otto_.Walk(params.steps, params.speed, params.direction);
-                        controller->otto_.WagTail(3, 100); // Wag tail after walk
-                        break;
-                    case ACTION_TURN:
-                        controller->otto_.Turn(params.steps, params.speed, params.direction);
-                        controller->otto_.WagTail(3, 100); // Wag tail after turn
-                        break;
-                    case ACTION_JUMP:
-                        {
-                            auto display = Board::GetInstance().GetDisplay();
-                            if (display) display->SetEmotion("angry");
-                            controller->otto_.Jump(params.steps, params.speed);
-                            controller->otto_.WagTail(3, 100); // Wag tail after jump
-                            // Reset to neutral after jump completes
-                            if (display) display->SetEmotion("neutral");
-                        }
-                        break;
-                    case ACTION_BEND:
-                        controller->otto_.Bend(params.steps, params.speed, params.direction);
-                        controller->otto_.WagTail(3, 100); // Wag tail after bend
-                        break;
-                    case ACTION_HOME:
-                        ESP_LOGI(TAG, "🏠 Going Home");
-                        controller->otto_.Home();
-                        break;
-                    case ACTION_DELAY:
-                        ESP_LOGI(TAG, "⏱️ Delay: %d ms", params.speed);
-                        vTaskDelay(pdMS_TO_TICKS(params.speed));
-                        break;
-                    default:
-                        ESP_LOGW(TAG, "⚠️ Unknown action type: %d", params.action_type);
-                        break;
+                OttoActionHooks hooks;
+                hooks.pause = [controller](int ms) { return controller->Pause(ms); };
+                hooks.set_emotion = [](const char* emotion) {
+                    auto display = Board::GetInstance().GetDisplay();
+                    if (display) display->SetEmotion(emotion);
+                };
+                hooks.beat_pulse = kiki_led_beat_pulse;
+                if (!OttoPlayAction(controller->otto_, params, hooks)) {
+                    ESP_LOGW(TAG, "⚠️ Unknown action type: %d", params.action_type);
                 }
                 
                 // Note: Removed auto-return-to-home logic to allow action sequences
                 // If you need to return home, queue ACTION_HOME explicitly
                 
-                controller->is_action_in_progress_ = false;
-                ESP_LOGI(TAG, "✅ Action completed");
+                bool preempted = controller->FinishAction(params);
+                if (verbose) {
+                    ESP_LOGI(TAG, preempted ? "⏭️ Action preempted" : "✅ Action completed");
+                }
                 vTaskDelay(pdMS_TO_TICKS(20));
             } else {
                 // No action received within the polling timeout -> accumulate idle time
@@ -415,40 +199,116 @@ private:
         }
     }
 
-    void QueueAction(int action_type, int steps, int speed, int direction, int amount) {
-        ESP_LOGI(TAG, "🎯 QueueAction called: type=%d, steps=%d, speed=%d, direction=%d, amount=%d", 
-                 action_type, steps, speed, direction, amount);
+    // Caller holds queue_mutex_. The running routine drops its clip now (servos stop at the
+    // next motion tick) and every later clip or Pause() of that action returns at once.
+    void PreemptLocked() {
+        if (running_token_ == 0 || preempt_request_us_ != 0) {
+            return;
+        }
+        preempt_request_us_ = esp_timer_get_time();
+        xEventGroupSetBits(action_events_, QUEUE_PREEMPT_BIT);
+        otto_.Interrupt();
+    }
 
-        if (action_queue_ == nullptr) {
+    uint32_t QueueAction(int action_type, int steps, int speed, int direction, int amount,
+                         int priority = OTTO_PRIORITY_NORMAL) {
+        ESP_LOGI(TAG, "🎯 QueueAction called: type=%d, steps=%d, speed=%d, direction=%d, amount=%d, priority=%d", 
+                 action_type, steps, speed, direction, amount, priority);
+
+        if (action_events_ == nullptr) {
             ESP_LOGE(TAG, "❌ Action queue is NULL! Cannot queue action.");
-            return;
+            return 0;
         }
 
-        OttoActionParams params = {action_type, steps, speed, direction, amount};
-        
-        // Use short timeout (100ms) instead of portMAX_DELAY to avoid blocking
-        BaseType_t result = xQueueSend(action_queue_, &params, pdMS_TO_TICKS(100));
-        if (result == pdTRUE) {
-            ESP_LOGI(TAG, "✅ Action queued successfully. Queue space remaining: %d", 
-                     uxQueueSpacesAvailable(action_queue_));
-            StartActionTaskIfNeeded();
-        } else {
-            // Queue full - drop oldest action by receiving and discarding it, then retry
-            ESP_LOGW(TAG, "⚠️ Queue full, dropping oldest action...");
-            OttoActionParams dummy;
-            if (xQueueReceive(action_queue_, &dummy, 0) == pdTRUE) {
-                ESP_LOGW(TAG, "🗑️ Dropped action type %d to make room", dummy.action_type);
-                result = xQueueSend(action_queue_, &params, pdMS_TO_TICKS(100));
-                if (result == pdTRUE) {
-                    ESP_LOGI(TAG, "✅ Action queued after dropping oldest");
-                    StartActionTaskIfNeeded();
-                } else {
-                    ESP_LOGE(TAG, "❌ Failed to queue action even after dropping!");
+        QueuedAction action = {action_type, steps, speed, direction, amount,
+                               (uint8_t)std::max(OTTO_PRIORITY_NORMAL, std::min(priority, OTTO_PRIORITY_URGENT)),
+                               0, esp_timer_get_time()};
+        ActionPushResult result;
+        uint32_t token;
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            token = action_queue_.Push(action, OttoActionCoalesceMode(action_type), &result);
+            if (result == ACTION_PUSH_COALESCED) {
+                latency_.coalesced++;
+            } else if (result == ACTION_PUSH_DROPPED_OLDEST) {
+                latency_.dropped++;
+            }
+            // An urgent command doesn't cut another urgent one short (double-tapped home)
+            if (token != 0 && action.priority == OTTO_PRIORITY_URGENT && running_priority_ < OTTO_PRIORITY_URGENT) {
+                PreemptLocked();
+            }
+        }
+
+        switch (result) {
+            case ACTION_PUSH_COALESCED:
+                ESP_LOGI(TAG, "🔗 Merged into queued action #%lu", (unsigned long)token);
+                break;
+            case ACTION_PUSH_DROPPED_OLDEST:
+                ESP_LOGW(TAG, "🗑️ Queue full, dropped the oldest lowest-priority action");
+                break;
+            case ACTION_PUSH_FULL:
+                ESP_LOGE(TAG, "❌ Queue full of higher-priority actions, action rejected");
+                return 0;
+            default:
+                break;
+        }
+        ESP_LOGI(TAG, "✅ Action #%lu queued. Pending: %d", (unsigned long)token, PendingActions());
+        xEventGroupSetBits(action_events_, QUEUE_READY_BIT);
+        StartActionTaskIfNeeded();
+        return token;
+    }
+
+    // Action task side: next action, waiting up to 100 ms for one (false on timeout)
+    bool WaitAction(QueuedAction* action) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                if (action_queue_.Pop(action)) {
+                    running_token_ = action->token;
+                    running_priority_ = action->priority;
+                    // Preemption was aimed at the previous action
+                    preempt_request_us_ = 0;
+                    xEventGroupClearBits(action_events_, QUEUE_PREEMPT_BIT);
+                    otto_.Resume();
+
+                    int64_t wait_us = esp_timer_get_time() - action->enqueue_us;
+                    latency_.last_start_us = wait_us;
+                    latency_.max_start_us = std::max(latency_.max_start_us, wait_us);
+                    latency_.avg_start_us = latency_.started == 0 ? wait_us
+                                                                  : latency_.avg_start_us + (wait_us - latency_.avg_start_us) / 8;
+                    latency_.started++;
+                    return true;
                 }
-            } else {
-                ESP_LOGE(TAG, "❌ Queue full but failed to receive - inconsistent state");
+            }
+            if (attempt == 0) {
+                xEventGroupWaitBits(action_events_, QUEUE_READY_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(100));
             }
         }
+        return false;
+    }
+
+    // Action task side; true if the action was preempted
+    bool FinishAction(const QueuedAction& action) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_token_ = 0;
+        running_priority_ = OTTO_PRIORITY_NORMAL;
+        if (preempt_request_us_ == 0) {
+            return false;
+        }
+        int64_t preempt_us = esp_timer_get_time() - preempt_request_us_;
+        latency_.last_preempt_us = preempt_us;
+        latency_.max_preempt_us = std::max(latency_.max_preempt_us, preempt_us);
+        latency_.preempted++;
+        ESP_LOGI(TAG, "⏭️ Action #%lu released the servos %lld us after preemption",
+                 (unsigned long)action.token, preempt_us);
+        return true;
+    }
+
+    // vTaskDelay for the action task that an urgent command cuts short; false if preempted
+    bool Pause(int ms) {
+        EventBits_t bits = xEventGroupWaitBits(action_events_, QUEUE_PREEMPT_BIT, pdFALSE, pdFALSE,
+                                               pdMS_TO_TICKS(std::max(ms, 0)));
+        return (bits & QUEUE_PREEMPT_BIT) == 0;
     }
 
     void LoadTrimsFromNVS() {
@@ -520,14 +380,14 @@ private:
 public:
     ~OttoController() {
         // Cleanup resources
-        if (action_queue_ != nullptr) {
-            vQueueDelete(action_queue_);
-            action_queue_ = nullptr;
-        }
         if (action_task_handle_ != nullptr) {
             vTaskDelete(action_task_handle_);
             action_task_handle_ = nullptr;
         }
+        if (action_events_ != nullptr) {
+            vEventGroupDelete(action_events_);
+            action_events_ = nullptr;
+        }
         otto_.DetachServos();
         ESP_LOGI(TAG, "🧹 OttoController resources cleaned up");
     }
@@ -551,10 +411,10 @@ public:
         LoadServoHomeFromNVS();  // Load calibrated home positions
         LoadIdleTimeoutFromNVS();  // Load idle timeout setting
 
-        ESP_LOGI(TAG, "📦 Creating action queue (size=10)...");
-        action_queue_ = xQueueCreate(10, sizeof(OttoActionParams));
+        ESP_LOGI(TAG, "📦 Creating action queue (size=%d)...", ACTION_QUEUE_SIZE);
+        action_events_ = xEventGroupCreate();
         
-        if (action_queue_ == nullptr) {
+        if (action_events_ == nullptr) {
             ESP_LOGE(TAG, "❌ FATAL: Failed to create action queue!");
         } else {
             ESP_LOGI(TAG, "✅ Action queue created successfully");
@@ -701,18 +561,12 @@ public:
                 }
                 else if (action == "stop") {
                     ESP_LOGI(TAG, "🛑 Stopping all actions");
-                    if (action_task_handle_ != nullptr) {
-                        vTaskDelete(action_task_handle_);
-                        action_task_handle_ = nullptr;
-                    }
-                    is_action_in_progress_ = false;
-                    xQueueReset(action_queue_);
-                    otto_.Home();
+                    StopAll();
                     return true;
                 }
                 else if (action == "home") {
                     ESP_LOGI(TAG, "🏠 Going to home position");
-                    otto_.Home();
+                    QueueAction(ACTION_HOME, 1, 500, 0, 0, OTTO_PRIORITY_URGENT);
                     return true;
                 }
                 else {
@@ -849,16 +703,8 @@ public:
                            "Example: 'Otto, stop!' or 'Freeze!' or 'Stay!'", 
                            PropertyList(),
                            [this](const PropertyList& properties) -> ReturnValue {
-                               if (action_task_handle_ != nullptr) {
-                                   vTaskDelete(action_task_handle_);
-                                   action_task_handle_ = nullptr;
-                               }
-                               is_action_in_progress_ = false;
-                               xQueueReset(action_queue_);
-
+                               StopAll();
                                ESP_LOGI(TAG, "🐾 Kiki stopped! 🛑");
-                               // FAST RESPONSE: Execute immediately like esp-hi
-                               otto_.Home();
                                return true;
                            });
         */
@@ -1051,27 +897,78 @@ public:
     }
 
     // Public method for web server to queue actions
-    void ExecuteAction(int action_type, int steps, int speed, int direction, int amount) {
-        QueueAction(action_type, steps, speed, direction, amount);
+    uint32_t ExecuteAction(int action_type, int steps, int speed, int direction, int amount, int priority) {
+        return QueueAction(action_type, steps, speed, direction, amount, priority);
+    }
+    
+    // Public method for beat-synced dancing: never waits and never displaces
+    // queued actions - a beat that can't start right now is simply skipped
+    bool QueueBeatStep(int style, int beat, int move_ms) {
+        if (action_events_ == nullptr) {
+            return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (running_token_ != 0 || action_queue_.Count() > 0) {
+                return false;
+            }
+            QueuedAction action = {ACTION_DOG_BEAT_STEP, beat, move_ms, style, 0, OTTO_PRIORITY_NORMAL, 0,
+                                   esp_timer_get_time()};
+            ActionPushResult result;
+            if (action_queue_.Push(action, ACTION_COALESCE_NONE, &result) == 0) {
+                return false;
+            }
+        }
+        xEventGroupSetBits(action_events_, QUEUE_READY_BIT);
+        StartActionTaskIfNeeded();
+        return true;
+    }
+    
+    // Queued actions plus the one running, for web clients to show progress
+    int PendingActions() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return action_queue_.Count() + (running_token_ != 0 ? 1 : 0);
+    }
+    
+    // Drops a queued action, or cuts it short if it is the one running
+    bool CancelAction(uint32_t token) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (token == 0) {
+            return false;
+        }
+        if (action_queue_.Remove(token)) {
+            ESP_LOGI(TAG, "🚫 Queued action #%lu cancelled", (unsigned long)token);
+            return true;
+        }
+        if (token == running_token_) {
+            ESP_LOGI(TAG, "🚫 Running action #%lu cancelled", (unsigned long)token);
+            PreemptLocked();
+            return true;
+        }
+        return false;
+    }
+    
+    OttoLatencyStats GetLatencyStats() {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return latency_;
     }
     
     // Public method to stop all actions and clear queue
     void StopAll() {
         ESP_LOGI(TAG, "🛑 StopAll() called - clearing queue");
         
-        // Reset the queue to clear all pending actions
-        if (action_queue_ != nullptr) {
-            xQueueReset(action_queue_);
-            ESP_LOGI(TAG, "✅ Queue cleared");
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            int cleared = action_queue_.Clear();
+            ESP_LOGI(TAG, "✅ Queue cleared (%d actions)", cleared);
+            // Stop cuts short whatever runs, urgent or not
+            PreemptLocked();
         }
         
-        // Set flag to stop current action
-        is_action_in_progress_ = false;
+        // Home runs on the action task right after the current routine lets go of the servos
+        QueueAction(ACTION_HOME, 1, 500, 0, 0, OTTO_PRIORITY_URGENT);
         
-        // Go to home position immediately
-        otto_.Home();
-        
-        ESP_LOGI(TAG, "✅ Robot stopped and at home position");
+        ESP_LOGI(TAG, "✅ Robot stopping, going home");
     }
 
     // Public method to set servo angle (for servo calibration)
@@ -1111,16 +1008,51 @@ void InitializeOttoController() {
 // C interface for webserver to access controller
 extern "C" {
     esp_err_t otto_controller_queue_action(int action_type, int steps, int speed, int direction, int amount) {
-        ESP_LOGI(TAG, "🌐 Web/Voice request: action=%d, steps=%d, speed=%d, dir=%d, amt=%d", 
-                 action_type, steps, speed, direction, amount);
+        return otto_controller_queue_action_ex(action_type, steps, speed, direction, amount,
+                                               OTTO_PRIORITY_NORMAL) != 0 ? ESP_OK : ESP_FAIL;
+    }
+    
+    uint32_t otto_controller_queue_action_ex(int action_type, int steps, int speed, int direction, int amount,
+                                             int priority) {
+        ESP_LOGI(TAG, "🌐 Web/Voice request: action=%d, steps=%d, speed=%d, dir=%d, amt=%d, priority=%d", 
+                 action_type, steps, speed, direction, amount, priority);
         
         if (g_otto_controller == nullptr) {
             ESP_LOGE(TAG, "❌ FATAL: Kiki controller not initialized!");
-            return ESP_ERR_INVALID_STATE;
+            return 0;
         }
         
-        g_otto_controller->ExecuteAction(action_type, steps, speed, direction, amount);
-        return ESP_OK;
+        return g_otto_controller->ExecuteAction(action_type, steps, speed, direction, amount, priority);
+    }
+    
+    bool otto_controller_cancel_action(uint32_t token) {
+        if (g_otto_controller == nullptr) {
+            return false;
+        }
+        return g_otto_controller->CancelAction(token);
+    }
+    
+    void otto_controller_get_latency(OttoLatencyStats* stats) {
+        if (g_otto_controller == nullptr) {
+            *stats = OttoLatencyStats();
+            return;
+        }
+        *stats = g_otto_controller->GetLatencyStats();
+    }
+    
+    // Beat-synced dance step, called from the music beat timer
+    bool otto_controller_queue_beat_step(int style, int beat, int move_ms) {
+        if (g_otto_controller == nullptr) {
+            return false;
+        }
+        return g_otto_controller->QueueBeatStep(style, beat, move_ms);
+    }
+    
+    int otto_controller_pending_actions() {
+        if (g_otto_controller == nullptr) {
+            return 0;
+        }
+        return g_otto_controller->PendingActions();
     }
     
     // Stop and clear all queued actions
@@ -1160,9 +1092,11 @@ extern "C" {
         angles[1] = g_otto_controller->GetServoAngle(1);  // RF
         angles[2] = g_otto_controller->GetServoAngle(2);  // LB
         angles[3] = g_otto_controller->GetServoAngle(3);  // RB
+        angles[4] = g_otto_controller->GetServoAngle(SERVO_TAIL);
         
-        ESP_LOGI(TAG, "📐 Current servo angles: LF=%d RF=%d LB=%d RB=%d", 
-            angles[0], angles[1], angles[2], angles[3]);
+        // Polled by the web UI state push - debug level only
+        ESP_LOGD(TAG, "📐 Current servo angles: LF=%d RF=%d LB=%d RB=%d TAIL=%d", 
+            angles[0], angles[1], angles[2], angles[3], angles[4]);
     }
     
     void otto_controller_apply_servo_home(int lf, int rf, int lb, int rb) {
@@ -31,6 +31,10 @@ extern "C" {
 
 #define TAG "OttoEmojiDisplay"
 
+// Live GIF decoders kept for fast emotion switches (5 bytes/pixel each, PSRAM)
+static constexpr size_t kGifCacheEntries = 6;
+static constexpr size_t kGifCacheBytes = 2 * 1024 * 1024;
+
 // 表情映射表 - 将原版21种表情映射到现有6个GIF
 const OttoEmojiDisplay::EmotionMap OttoEmojiDisplay::emotion_maps_[] = {
     // 中性/平静类表情 -> staticstate
@@ -71,9 +75,11 @@ const OttoEmojiDisplay::EmotionMap OttoEmojiDisplay::emotion_maps_[] = {
 
 OttoEmojiDisplay::OttoEmojiDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_t panel,
                                    int width, int height, int offset_x, int offset_y, bool mirror_x,
-                                   bool mirror_y, bool swap_xy)
-    : SpiLcdDisplay(panel_io, panel, width, height, offset_x, offset_y, mirror_x, mirror_y, swap_xy),
+                                   bool mirror_y, bool swap_xy, const LcdRenderConfig& render_config)
+    : SpiLcdDisplay(panel_io, panel, width, height, offset_x, offset_y, mirror_x, mirror_y, swap_xy,
+                    render_config),
       emotion_gif_(nullptr), 
+      gif_cache_(kGifCacheEntries, kGifCacheBytes),
       use_otto_emoji_(true),  // Default, will be overridden by NVS below
       drawing_canvas_(nullptr),
       drawing_canvas_buf_(nullptr),
@@ -239,22 +245,12 @@ void OttoEmojiDisplay::SetupGifContainer() {
     // Set visibility based on initial mode
     if (use_otto_emoji_) {
         // Otto GIF mode: show GIF, hide label
-        gif_controller_ = std::make_unique<LvglGif>(&happy);
-        if (gif_controller_->IsLoaded()) {
-            gif_controller_->SetFrameCallback([this]() {
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-            });
-            lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-            gif_controller_->Start();
-        }
+        ShowGif(&happy, true);
         lv_obj_remove_flag(emotion_gif_, LV_OBJ_FLAG_HIDDEN);
         lv_obj_add_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
     } else {
         // Twemoji text mode: hide GIF, show label
-        gif_controller_ = std::make_unique<LvglGif>(&staticstate);
-        if (gif_controller_->IsLoaded()) {
-            lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-        }
+        ShowGif(&staticstate, false);
         lv_obj_add_flag(emotion_gif_, LV_OBJ_FLAG_HIDDEN);
         lv_obj_remove_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
     }
@@ -288,6 +284,35 @@ void OttoEmojiDisplay::SetupGifContainer() {
     }
 }
 
+bool OttoEmojiDisplay::ShowGif(const lv_img_dsc_t* gif, bool animate) {
+    LvglGif* controller = gif_cache_.Acquire(gif);
+    if (!controller) {
+        gif_controller_ = nullptr;
+        return false;
+    }
+    gif_controller_ = controller;
+    controller->SetFrameCallback([this, controller]() {
+        LvglImage::InvalidateArea(emotion_gif_, controller->image_dsc(), controller->dirty_area());
+    });
+    lv_img_set_src(emotion_gif_, controller->image_dsc());
+    if (animate) {
+        controller->Start();
+    }
+
+    auto stats = gif_cache_.GetStats();
+    if ((stats.hits + stats.misses) % 50 == 0) {
+        ESP_LOGI(TAG, "🎞️ GIF cache: %lu hits / %lu misses, %lu entries (%u KB), switch avg %luus hit / %luus miss",
+                 (unsigned long)stats.hits, (unsigned long)stats.misses, (unsigned long)stats.entries,
+                 (unsigned)(stats.bytes / 1024), (unsigned long)stats.avg_hit_us, (unsigned long)stats.avg_miss_us);
+        auto gif_stats = controller->GetStats();
+        ESP_LOGI(TAG, "🎞️ GIF %s: %lu frames / %lu wakeups, %lu%% redrawn per frame",
+                 controller->image_dsc()->header.cf == LV_COLOR_FORMAT_RGB565 ? "RGB565" : "ARGB8888",
+                 (unsigned long)gif_stats.frames, (unsigned long)gif_stats.wakeups,
+                 (unsigned long)gif_stats.dirty_percent);
+    }
+    return true;
+}
+
 void OttoEmojiDisplay::SetEmotion(const char* emotion) {
     if (!emotion) return;
     
@@ -357,45 +382,20 @@ void OttoEmojiDisplay::SetEmotion(const char* emotion) {
     
     DisplayLockGuard lock(this);
     
-    // Find emotion in emoji maps first (with cache check)
-    if (emotion_to_use && cached_emotion == emotion_to_use && cached_gif) {
-        gif_controller_ = std::make_unique<LvglGif>(cached_gif);
-        if (gif_controller_->IsLoaded()) {
-            gif_controller_->SetFrameCallback([this]() {
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-            });
-            lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-            gif_controller_->Start();
-        }
-        ESP_LOGI(TAG, "🤖 Otto表情(缓存): %s", emotion);
-        return;
-    }
-    
     // Find emotion in map
     for (const auto& map : emotion_maps_) {
         if (map.name && strcmp(map.name, emotion_to_use) == 0) {
-            gif_controller_ = std::make_unique<LvglGif>(map.gif);
-            if (gif_controller_->IsLoaded()) {
-                gif_controller_->SetFrameCallback([this]() {
-                    lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-                });
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-                gif_controller_->Start();
-            }
-            // Cache the result
+            ShowGif(map.gif, true);
             cached_emotion = map.name;
             cached_gif = map.gif;
             last_emotion_time = current_time;
-            ESP_LOGI(TAG, "🤖 Otto表情: %s", emotion);
+            ESP_LOGI(TAG, "🤖 Otto表情: %s (%luus)", emotion, (unsigned long)gif_cache_.GetStats().last_switch_us);
             return;
         }
     }
     
     // Default fallback
-    gif_controller_ = std::make_unique<LvglGif>(&staticstate);
-    if (gif_controller_->IsLoaded()) {
-        lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-    }
+    ShowGif(&staticstate, false);
     cached_emotion = "default";
     cached_gif = &staticstate;
     last_emotion_time = current_time;
@@ -492,10 +492,7 @@ void OttoEmojiDisplay::SetEmojiMode(bool use_otto_emoji) {
         if (emotion_gif_) {
             lv_obj_remove_flag(emotion_gif_, LV_OBJ_FLAG_HIDDEN);
             // CRITICAL: Re-activate the GIF by resetting the source
-            gif_controller_ = std::make_unique<LvglGif>(&staticstate);
-            if (gif_controller_->IsLoaded()) {
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
-            }
+            ShowGif(&staticstate, false);
             ESP_LOGI(TAG, "🔄 GIF重新激活");
         }
         if (emoji_label_) {
@@ -670,6 +667,28 @@ void OttoEmojiDisplay::SetDrawingImage(const uint16_t* rgb565_data, int width, i
     ESP_LOGI(TAG, "✅ Drawing image set (%dx%d)", width, height);
 }
 
+bool OttoEmojiDisplay::EditDrawingCanvas(
+    const std::function<bool(uint16_t* pixels, int width, int height, lv_area_t& dirty)>& edit) {
+    if (!drawing_canvas_enabled_) {
+        EnableDrawingCanvas(true);
+    }
+
+    DisplayLockGuard lock(this);
+    if (!drawing_canvas_ || !drawing_canvas_buf_) {
+        return false;
+    }
+
+    lv_area_t dirty = {0, 0, -1, -1};
+    bool ok = edit((uint16_t*)drawing_canvas_buf_, width_, height_, dirty);
+    if (dirty.x2 >= dirty.x1 && dirty.y2 >= dirty.y1) {
+        lv_area_t coords;
+        lv_obj_get_coords(drawing_canvas_, &coords);
+        lv_area_move(&dirty, coords.x1, coords.y1);
+        lv_obj_invalidate_area(drawing_canvas_, &dirty);
+    }
+    return ok;
+}
+
 // ==================== Display Power Management ====================
 
 void OttoEmojiDisplay::AutoOffTimerCallback(void* arg) {
@@ -2,7 +2,9 @@
 
 #include "display/lcd_display.h"
 #include "display/lvgl_display/gif/lvgl_gif.h"
+#include "display/lvgl_display/gif/lvgl_gif_cache.h"
 #include "otto_emoji_gif.h"
+#include <functional>
 #include <memory>
 
 /**
@@ -16,7 +18,7 @@ public:
      */
     OttoEmojiDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_t panel, int width,
                      int height, int offset_x, int offset_y, bool mirror_x, bool mirror_y,
-                     bool swap_xy);
+                     bool swap_xy, const LcdRenderConfig& render_config = LcdRenderConfig::Default());
 
     virtual ~OttoEmojiDisplay();
 
@@ -50,6 +52,9 @@ public:
     void DrawPixel(int x, int y, bool state);
     bool IsDrawingCanvasEnabled() const { return drawing_canvas_enabled_; }
     void SetDrawingImage(const uint16_t* rgb565_data, int width, int height);  // Set image from RGB565 buffer
+    // Sửa trực tiếp buffer RGB565 của canvas vẽ dưới khóa LVGL (tự bật canvas);
+    // chỉ vùng `dirty` mà `edit` trả về được vẽ lại
+    bool EditDrawingCanvas(const std::function<bool(uint16_t* pixels, int width, int height, lv_area_t& dirty)>& edit);
 
     // Display power management
     void TurnOn();  // Turn on display and reset auto-off timer
@@ -83,9 +88,12 @@ private:
     void SetupGifContainer();
     void InitializeDrawingCanvas();
     void CleanupDrawingCanvas();
+    // Switch emotion_gif_ to a cached decoder; returns false if the GIF cannot be opened
+    bool ShowGif(const lv_img_dsc_t* gif, bool animate);
 
     lv_obj_t* emotion_gif_;  ///< GIF表情组件 (lv_img object)
-    std::unique_ptr<LvglGif> gif_controller_;  ///< GIF controller for animation
+    LvglGifCache gif_cache_;  ///< Live decoders of recently shown GIFs
+    LvglGif* gif_controller_ = nullptr;  ///< Active GIF, owned by gif_cache_
     bool use_otto_emoji_;    ///< 是否使用Otto emoji (true) 还是默认emoji (false)
 
     // UDP Drawing canvas
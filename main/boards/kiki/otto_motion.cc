@@ -0,0 +1,223 @@
+#include "otto_motion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+///////////////////////////////////////////////////////////////////
+//-- MOTION BUILDER ---------------------------------------------//
+///////////////////////////////////////////////////////////////////
+MotionBuilder::MotionBuilder(const int start_pose[MOTION_SERVO_COUNT]) {
+    for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+        pose_[i] = start_pose[i];
+    }
+}
+
+void MotionBuilder::AddKey(int servo, int angle, int ramp_ms, TrajectoryProfile profile, int accel_percent) {
+    if (servo < 0 || servo >= MOTION_SERVO_COUNT) {
+        return;
+    }
+    ramp_ms = std::max(0, std::min(ramp_ms, 65535));
+    keys_.push_back(
+        {now_ms_, (uint16_t)ramp_ms, (uint8_t)servo, (uint8_t)profile, (int16_t)angle, (uint8_t)accel_percent});
+    pose_[servo] = angle;
+    end_ms_ = std::max(end_ms_, now_ms_ + ramp_ms);
+}
+
+MotionBuilder& MotionBuilder::Set(int servo, int angle) {
+    AddKey(servo, angle, 0);
+    return *this;
+}
+
+MotionBuilder& MotionBuilder::Ramp(int servo, int angle, int ramp_ms) {
+    AddKey(servo, angle, ramp_ms);
+    return *this;
+}
+
+MotionBuilder& MotionBuilder::Legs(int lf, int rf, int lb, int rb) {
+    AddKey(0, lf, 0);
+    AddKey(1, rf, 0);
+    AddKey(2, lb, 0);
+    AddKey(3, rb, 0);
+    return *this;
+}
+
+MotionBuilder& MotionBuilder::RampLegs(int lf, int rf, int lb, int rb, int ramp_ms) {
+    AddKey(0, lf, ramp_ms);
+    AddKey(1, rf, ramp_ms);
+    AddKey(2, lb, ramp_ms);
+    AddKey(3, rb, ramp_ms);
+    return *this;
+}
+
+MotionBuilder& MotionBuilder::Wait(int ms) {
+    if (ms > 0) {
+        now_ms_ += ms;
+    }
+    return *this;
+}
+
+MotionBuilder& MotionBuilder::Move(uint8_t mask, const int to[MOTION_SERVO_COUNT], TrajectoryProfile profile,
+                                   const JointLimits limits[MOTION_SERVO_COUNT], int min_ms) {
+    // Unmasked servos stay put, so they never limit the plan
+    int target[MOTION_SERVO_COUNT];
+    for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+        target[i] = (mask & (1 << i)) ? to[i] : pose_[i];
+    }
+    TrajectoryPlan plan = PlanTrajectory(profile, pose_, target, limits, MOTION_SERVO_COUNT, std::max(0, min_ms));
+    for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+        if (mask & (1 << i)) {
+            AddKey(i, target[i], plan.duration_ms, profile, plan.accel_percent);
+        }
+    }
+    return Wait(plan.duration_ms);
+}
+
+MotionBuilder& MotionBuilder::Sweep(uint8_t mask, const int from[MOTION_SERVO_COUNT],
+                                    const int to[MOTION_SERVO_COUNT], int count, int step_ms) {
+    if (count <= 0) {
+        return *this;
+    }
+    for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+        if (mask & (1 << i)) {
+            AddKey(i, from[i], 0);
+        }
+    }
+    // The last write of the loop happens (count - 1) steps after the first
+    if (count > 1) {
+        for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+            if (mask & (1 << i)) {
+                AddKey(i, to[i], (count - 1) * step_ms);
+            }
+        }
+    }
+    return Wait(count * step_ms);
+}
+
+MotionClip MotionBuilder::Build(const char* name, bool loop) {
+    MotionClip clip;
+    clip.name = name;
+    clip.keys = std::move(keys_);
+    clip.duration_ms = std::max(now_ms_, end_ms_);
+    clip.loop = loop;
+    keys_.clear();
+    now_ms_ = 0;
+    end_ms_ = 0;
+    return clip;
+}
+
+///////////////////////////////////////////////////////////////////
+//-- MOTION PLAYER ----------------------------------------------//
+///////////////////////////////////////////////////////////////////
+MotionPlayer::MotionPlayer(Writer writer, Reader reader)
+    : writer_(std::move(writer)), reader_(std::move(reader)) {
+}
+
+void MotionPlayer::Play(MotionClip clip, int blend_ms) {
+    if (blend_ms > 0) {
+        bool blended[MOTION_SERVO_COUNT] = {};
+        for (auto& key : clip.keys) {
+            if (key.at_ms >= (uint32_t)blend_ms) {
+                break;
+            }
+            if (!blended[key.servo]) {
+                blended[key.servo] = true;
+                key.ramp_ms = std::max<uint32_t>(key.ramp_ms, blend_ms - key.at_ms);
+                clip.duration_ms = std::max<uint32_t>(clip.duration_ms, key.at_ms + key.ramp_ms);
+            }
+        }
+    }
+    clip_ = std::move(clip);
+    next_key_ = 0;
+    time_us_ = 0;
+    for (auto& channel : channels_) {
+        channel.ramping = false;
+    }
+    active_ = true;
+    // Keys at t=0 go out right away instead of waiting for the first tick
+    Advance(0);
+}
+
+void MotionPlayer::Cancel() {
+    active_ = false;
+    for (auto& channel : channels_) {
+        channel.ramping = false;
+    }
+}
+
+void MotionPlayer::SetSpeed(int percent) {
+    speed_percent_ = std::max(10, std::min(percent, 400));
+}
+
+void MotionPlayer::Write(int servo, int angle) {
+    writer_(servo, angle);
+    writes_++;
+}
+
+void MotionPlayer::Fire(const MotionKey& key) {
+    Channel& channel = channels_[key.servo];
+    if (key.ramp_ms == 0) {
+        channel.ramping = false;
+        Write(key.servo, key.angle);
+        return;
+    }
+    channel.ramping = true;
+    channel.from = reader_(key.servo);
+    channel.to = key.angle;
+    channel.start_ms = key.at_ms;
+    channel.ramp_ms = key.ramp_ms;
+    channel.profile = (TrajectoryProfile)key.profile;
+    channel.accel_percent = key.accel_percent;
+}
+
+bool MotionPlayer::Advance(uint32_t elapsed_us) {
+    if (!active_) {
+        return false;
+    }
+    time_us_ += (uint64_t)elapsed_us * speed_percent_ / 100;
+
+    while (true) {
+        uint32_t now_ms = (uint32_t)(time_us_ / 1000);
+        while (next_key_ < clip_.keys.size() && clip_.keys[next_key_].at_ms <= now_ms) {
+            Fire(clip_.keys[next_key_++]);
+        }
+
+        bool ramping = false;
+        for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+            Channel& channel = channels_[i];
+            if (!channel.ramping) {
+                continue;
+            }
+            uint32_t t = now_ms - channel.start_ms;
+            if (t >= channel.ramp_ms) {
+                channel.ramping = false;
+                Write(i, channel.to);
+                continue;
+            }
+            int angle;
+            if (channel.profile == TRAJECTORY_LINEAR) {
+                // Truncates toward the start pose like the old step loops did
+                angle = channel.from + (int)((channel.to - channel.from) * (float)t / channel.ramp_ms);
+            } else {
+                float progress = TrajectoryProgress(channel.profile, (float)t / channel.ramp_ms, channel.accel_percent);
+                angle = channel.from + (int)std::lround((channel.to - channel.from) * progress);
+            }
+            if (angle != reader_(i)) {
+                Write(i, angle);
+            }
+            ramping = true;
+        }
+
+        if (ramping || next_key_ < clip_.keys.size() || now_ms < clip_.duration_ms) {
+            return true;
+        }
+        if (!clip_.loop || clip_.duration_ms == 0) {
+            active_ = false;
+            return false;
+        }
+        // Loop: carry the overshoot into the next pass so the cadence does not drift
+        time_us_ -= (uint64_t)clip_.duration_ms * 1000;
+        next_key_ = 0;
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef __OTTO_MOTION_H__
+#define __OTTO_MOTION_H__
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "servo_trajectory.h"
+
+// Keyframe motion core for the dog servos.
+// Plain C++ on purpose: the host simulator (scripts/otto_motion_sim) links it as-is.
+
+#define MOTION_SERVO_COUNT 5  // Same order as SERVO_LF..SERVO_TAIL
+#define MOTION_TICK_MS 10     // Engine tick, one servo update per joint per tick
+
+#define MOTION_MASK_LEGS 0x0F
+#define MOTION_MASK_ALL 0x1F
+
+//-- One keyframe: at clip time at_ms the servo starts heading to angle.
+//-- ramp_ms == 0 jumps (like ServoAngleSet), otherwise moves along `profile` from
+//-- wherever the servo is at that moment.
+struct MotionKey {
+    uint32_t at_ms;
+    uint16_t ramp_ms;
+    uint8_t servo;
+    uint8_t profile;  // TrajectoryProfile
+    int16_t angle;
+    uint8_t accel_percent;  // TRAJECTORY_TRAPEZOID only
+};
+
+struct MotionClip {
+    const char* name = "";
+    std::vector<MotionKey> keys;  // Sorted by at_ms
+    uint32_t duration_ms = 0;     // Keys + trailing holds
+    bool loop = false;            // Restart until cancelled (continuous walks)
+};
+
+//-- Records a routine the way the old blocking code was written: set angles,
+//-- wait, set angles... Nothing moves until the clip is played.
+class MotionBuilder {
+public:
+    explicit MotionBuilder(const int start_pose[MOTION_SERVO_COUNT]);
+
+    MotionBuilder& Set(int servo, int angle);                   // Jump now
+    MotionBuilder& Ramp(int servo, int angle, int ramp_ms);     // Start a ramp now
+    MotionBuilder& Legs(int lf, int rf, int lb, int rb);        // Jump all four legs now
+    MotionBuilder& RampLegs(int lf, int rf, int lb, int rb, int ramp_ms);
+    MotionBuilder& Wait(int ms);
+    // Planned move of the masked servos to `to`: one shared duration, at least
+    // min_ms and long enough for every joint's limits, then waits for it
+    MotionBuilder& Move(uint8_t mask, const int to[MOTION_SERVO_COUNT], TrajectoryProfile profile,
+                        const JointLimits limits[MOTION_SERVO_COUNT], int min_ms);
+    // Same as "for count steps: write pose, wait step_ms" with the pose changing
+    // linearly from `from` to `to`; masked servos only
+    MotionBuilder& Sweep(uint8_t mask, const int from[MOTION_SERVO_COUNT], const int to[MOTION_SERVO_COUNT],
+                         int count, int step_ms);
+
+    int Angle(int servo) const { return pose_[servo]; }  // Pose once everything so far has landed
+    uint32_t Now() const { return now_ms_; }
+
+    MotionClip Build(const char* name, bool loop = false);
+
+private:
+    void AddKey(int servo, int angle, int ramp_ms, TrajectoryProfile profile = TRAJECTORY_LINEAR,
+                int accel_percent = 50);
+
+    std::vector<MotionKey> keys_;
+    uint32_t now_ms_ = 0;
+    uint32_t end_ms_ = 0;  // Latest ramp end, a clip never ends mid-ramp
+    int pose_[MOTION_SERVO_COUNT];
+};
+
+//-- Plays one clip at a time. Not thread safe and has no clock of its own:
+//-- the caller feeds elapsed time through Advance().
+class MotionPlayer {
+public:
+    using Writer = std::function<void(int servo, int angle)>;
+    using Reader = std::function<int(int servo)>;
+
+    MotionPlayer(Writer writer, Reader reader);
+
+    // Replaces whatever is playing. With blend_ms > 0 the first key of each servo
+    // inside the blend window becomes a ramp that lands at blend_ms, so a new
+    // action starts from the current pose instead of snapping.
+    void Play(MotionClip clip, int blend_ms = 0);
+    void Cancel();  // Servos hold where they are
+    bool Active() const { return active_; }
+
+    // Advances clip time by elapsed_us * speed; returns false once the clip has ended
+    bool Advance(uint32_t elapsed_us);
+
+    void SetSpeed(int percent);  // 100 = as authored, 50 = half speed
+    int GetSpeed() const { return speed_percent_; }
+    const char* ClipName() const { return clip_.name; }
+    uint32_t ClipTimeMs() const { return (uint32_t)(time_us_ / 1000); }
+    uint32_t writes() const { return writes_; }
+
+private:
+    struct Channel {
+        bool ramping = false;
+        int from = 0;
+        int to = 0;
+        uint32_t start_ms = 0;
+        uint32_t ramp_ms = 0;
+        TrajectoryProfile profile = TRAJECTORY_LINEAR;
+        int accel_percent = 50;
+    };
+
+    void Fire(const MotionKey& key);
+    void Write(int servo, int angle);
+
+    Writer writer_;
+    Reader reader_;
+    MotionClip clip_;
+    size_t next_key_ = 0;
+    uint64_t time_us_ = 0;
+    bool active_ = false;
+    int speed_percent_ = 100;
+    uint32_t writes_ = 0;
+    Channel channels_[MOTION_SERVO_COUNT];
+};
+
+#endif  // __OTTO_MOTION_H__
@@ -0,0 +1,152 @@
+#include "otto_motion_engine.h"
+
+#include <esp_log.h>
+
+#include <algorithm>
+#include <utility>
+
+static const char* TAG = "OttoMotion";
+
+MotionEngine::MotionEngine(MotionPlayer::Writer writer, MotionPlayer::Reader reader)
+    : player_(std::move(writer), std::move(reader)) {
+    esp_timer_create_args_t timer_args = {
+        .callback = TimerCallback,
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "otto_motion",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer_));
+}
+
+MotionEngine::~MotionEngine() {
+    Cancel();
+    if (timer_ != nullptr) {
+        esp_timer_stop(timer_);
+        esp_timer_delete(timer_);
+    }
+}
+
+void MotionEngine::TimerCallback(void* arg) {
+    static_cast<MotionEngine*>(arg)->Tick();
+}
+
+void MotionEngine::StartTimerLocked() {
+    last_tick_us_ = esp_timer_get_time();
+    if (!timer_running_) {
+        ESP_ERROR_CHECK(esp_timer_start_periodic(timer_, MOTION_TICK_MS * 1000));
+        timer_running_ = true;
+    }
+}
+
+void MotionEngine::NotifyLocked() {
+    // Wakes every Run() caller; each one re-checks its generation. A caller
+    // only takes its own semaphore, so one waking up cannot eat another's wake-up
+    for (SemaphoreHandle_t waiter : waiters_) {
+        xSemaphoreGive(waiter);
+    }
+}
+
+void MotionEngine::Tick() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now_us = esp_timer_get_time();
+    // Real elapsed time, so a late tick catches up instead of stretching the clip
+    uint32_t elapsed_us = (uint32_t)(now_us - last_tick_us_);
+    last_tick_us_ = now_us;
+
+    if (player_.Active() && player_.Advance(elapsed_us)) {
+        return;
+    }
+    if (!player_.Active() && finished_generation_ != generation_) {
+        finished_generation_ = generation_;
+        ESP_LOGD(TAG, "Clip %s done, %lu servo writes so far", player_.ClipName(),
+                 (unsigned long)player_.writes());
+    }
+    esp_timer_stop(timer_);
+    timer_running_ = false;
+    NotifyLocked();
+}
+
+void MotionEngine::Play(MotionClip clip, int blend_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (interrupted_) {
+        return;
+    }
+    generation_++;
+    player_.Play(std::move(clip), blend_ms);
+    // Waiters of the replaced clip wake up and see a new generation
+    NotifyLocked();
+    if (player_.Active()) {
+        StartTimerLocked();
+    } else {
+        finished_generation_ = generation_;
+    }
+}
+
+bool MotionEngine::Run(MotionClip clip, int blend_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (interrupted_) {
+        return false;
+    }
+    uint32_t generation = ++generation_;
+    player_.Play(std::move(clip), blend_ms);
+    NotifyLocked();
+    if (!player_.Active()) {
+        finished_generation_ = generation;
+        return true;
+    }
+    StartTimerLocked();
+
+    StaticSemaphore_t wake_buffer;
+    SemaphoreHandle_t wake = xSemaphoreCreateBinaryStatic(&wake_buffer);
+    waiters_.push_back(wake);
+    while (generation_ == generation && finished_generation_ != generation) {
+        lock.unlock();
+        // Given between the check and the take, the semaphore stays given, so no wake-up is lost
+        xSemaphoreTake(wake, portMAX_DELAY);
+        lock.lock();
+    }
+    waiters_.erase(std::find(waiters_.begin(), waiters_.end(), wake));
+    vSemaphoreDelete(wake);
+    return finished_generation_ == generation;
+}
+
+void MotionEngine::Cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    player_.Cancel();
+    NotifyLocked();
+}
+
+void MotionEngine::Interrupt() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    interrupted_ = true;
+    generation_++;
+    player_.Cancel();
+    NotifyLocked();
+}
+
+void MotionEngine::Resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    interrupted_ = false;
+}
+
+bool MotionEngine::IsInterrupted() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return interrupted_;
+}
+
+bool MotionEngine::IsBusy() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return player_.Active();
+}
+
+void MotionEngine::SetSpeed(int percent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    player_.SetSpeed(percent);
+}
+
+int MotionEngine::GetSpeed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return player_.GetSpeed();
+}
@@ -0,0 +1,58 @@
+#ifndef __OTTO_MOTION_ENGINE_H__
+#define __OTTO_MOTION_ENGINE_H__
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "otto_motion.h"
+
+//-- Runs MotionClips from a fixed-rate esp_timer tick (MOTION_TICK_MS).
+//-- The timer only runs while a clip is playing. Play/Cancel/SetSpeed are safe
+//-- from any task; servo writes happen on the esp_timer task.
+//-- Each Run() call blocks on its own semaphore so Cancel() from any task (the
+//-- controller preempting a routine for an urgent command) releases it right
+//-- away, even with several callers waiting; the servos stop moving at the
+//-- next tick. Interrupt() is a Cancel() that also
+//-- refuses every later Play/Run until Resume(), checked under the same mutex,
+//-- so a routine that was between two clips cannot start the next one.
+class MotionEngine {
+public:
+    MotionEngine(MotionPlayer::Writer writer, MotionPlayer::Reader reader);
+    ~MotionEngine();
+
+    // Starts a clip right away, replacing (and blending out of) the current one
+    void Play(MotionClip clip, int blend_ms = 0);
+    // Play + wait. Returns false if the clip was cancelled or replaced before its end
+    bool Run(MotionClip clip, int blend_ms = 0);
+    void Cancel();
+    void Interrupt();
+    void Resume();
+    bool IsInterrupted();
+    bool IsBusy();
+
+    void SetSpeed(int percent);
+    int GetSpeed();
+
+private:
+    static void TimerCallback(void* arg);
+    void Tick();
+    void StartTimerLocked();
+    void NotifyLocked();
+
+    MotionPlayer player_;
+    std::mutex mutex_;
+    std::vector<SemaphoreHandle_t> waiters_;  // One per blocked Run(), given when a clip finished or was replaced
+    uint32_t generation_ = 0;        // Bumped by every Play/Cancel
+    uint32_t finished_generation_ = 0;
+    bool interrupted_ = false;
+    esp_timer_handle_t timer_ = nullptr;
+    bool timer_running_ = false;
+    int64_t last_tick_us_ = 0;
+};
+
+#endif  // __OTTO_MOTION_ENGINE_H__
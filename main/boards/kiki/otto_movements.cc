@@ -8,9 +8,14 @@
 
 static const char* TAG = "OttoMovements";
 
-Otto::Otto() {
+Otto::Otto()
+    : motion_([this](int servo, int angle) { ServoWrite(servo, angle); },
+              [this](int servo) { return GetServoAngle(servo); }) {
     is_otto_resting_ = false;
     speed_delay_ = 100;  // Reduced to 100ms for faster movement
+    motion_blend_ms_ = 0;  // Routines start exactly as authored
+    motion_profile_ = TRAJECTORY_MIN_JERK;
+    clip_stands_up_ = false;
     
     // Initialize event group for action control (from PetDog)
     action_event_group_ = xEventGroupCreate();
@@ -23,6 +28,8 @@ Otto::Otto() {
         servo_pins_[i] = -1;
         servo_trim_[i] = 0;
         servo_compensate_[i] = 0;  // Compensation angles
+        joint_limits_[i].max_speed = JOINT_SPEED_LIMIT_DEFAULT;
+        joint_limits_[i].max_accel = JOINT_ACCEL_LIMIT_DEFAULT;
     }
     
     // Initialize home angles to default 90°
@@ -33,6 +40,8 @@ Otto::Otto() {
 }
 
 Otto::~Otto() {
+    motion_.Cancel();
+
     // Stop idle task if running
     if (idle_task_handle_ != nullptr) {
         idle_task_running_ = false;
@@ -49,10 +58,6 @@ Otto::~Otto() {
     DetachServos();
 }
 
-unsigned long IRAM_ATTR millis() {
-    return (unsigned long)(esp_timer_get_time() / 1000ULL);
-}
-
 void Otto::Init(int left_front, int right_front, int left_back, int right_back, int tail) {
     servo_pins_[SERVO_LF] = left_front;
     servo_pins_[SERVO_RF] = right_front;
@@ -178,49 +183,132 @@ void Otto::ServoInit(int lf_angle, int rf_angle, int lb_angle, int rb_angle, int
              lf_angle, rf_angle, lb_angle, rb_angle, tail_angle);
 }
 
-void Otto::ExecuteDogMovement(int lf, int rf, int lb, int rb, int delay_time) {
-    ServoAngleSet(SERVO_LF, lf, 0);
-    ServoAngleSet(SERVO_RF, rf, 0);
-    ServoAngleSet(SERVO_LB, lb, 0);
-    ServoAngleSet(SERVO_RB, rb, delay_time);
+MotionBuilder Otto::BeginClip() {
+    int pose[SERVO_COUNT];
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        pose[i] = GetServoAngle(i);
+    }
+    clip_stands_up_ = false;
+    return MotionBuilder(pose);
 }
 
-void Otto::MoveToPosition(int target_angles[SERVO_COUNT], int move_time) {
-    if (GetRestState() == true) {
-        SetRestState(false);
+// Plays the clip on the engine tick and waits for it. Returns false if Stop(),
+// Interrupt() or another routine cut it short.
+bool Otto::RunClip(MotionBuilder& clip, const char* name) {
+    bool stands_up = clip_stands_up_;
+    bool completed = motion_.Run(clip.Build(name), motion_blend_ms_);
+    if (!completed) {
+        ESP_LOGI(TAG, "Motion %s interrupted", name);
+    } else if (stands_up) {
+        is_otto_resting_ = true;
     }
+    return completed;
+}
 
-    final_time_ = millis() + move_time;
-    if (move_time > 10) {
-        for (int i = 0; i < SERVO_COUNT; i++) {
-            if (servo_pins_[i] != -1) {
-                increment_[i] = (target_angles[i] - servo_[i].GetPosition()) / (move_time / 10.0);
-            }
-        }
+// Old step loops moved the furthest leg one degree every 12 ms, then wrote the target once more.
+// That stays the move time; the planner shapes it and only stretches it for the joint limits.
+void Otto::AddSmoothMove(MotionBuilder& clip, int lf, int rf, int lb, int rb) {
+    const int step_delay = 12;
+    int max_steps = 0;
+    max_steps = std::max(max_steps, abs(lf - clip.Angle(SERVO_LF)));
+    max_steps = std::max(max_steps, abs(rf - clip.Angle(SERVO_RF)));
+    max_steps = std::max(max_steps, abs(lb - clip.Angle(SERVO_LB)));
+    max_steps = std::max(max_steps, abs(rb - clip.Angle(SERVO_RB)));
+
+    const int target[SERVO_COUNT] = {lf, rf, lb, rb, clip.Angle(SERVO_TAIL)};
+    clip.Move(MOTION_MASK_LEGS, target, motion_profile_, joint_limits_, max_steps * step_delay);
+    clip.Wait(step_delay);
+}
 
-        for (int iteration = 1; millis() < final_time_; iteration++) {
-            for (int i = 0; i < SERVO_COUNT; i++) {
-                if (servo_pins_[i] != -1) {
-                    ServoWrite(i, servo_[i].GetPosition() + increment_[i]);
-                }
-            }
-            vTaskDelay(pdMS_TO_TICKS(10));
-        }
-    } else {
-        for (int i = 0; i < SERVO_COUNT; i++) {
-            if (servo_pins_[i] != -1) {
-                ServoWrite(i, target_angles[i]);
-            }
-        }
-        vTaskDelay(pdMS_TO_TICKS(move_time));
+void Otto::AddStandUp(MotionBuilder& clip) {
+    // Target standing position: all servos to 90°, ~1 second for a full swing
+    AddSmoothMove(clip, 90, 90, 90, 90);
+
+    // Final position ensure, tail back to center (no-op when not connected)
+    clip.Legs(90, 90, 90, 90);
+    clip.Set(SERVO_TAIL, 90);
+    clip.Wait(300);  // Brief pause after standing
+    clip_stands_up_ = true;
+}
+
+void Otto::AddSitDown(MotionBuilder& clip, int delay_time) {
+    // Target sitting position: front legs at 90°, back legs at 30°
+    AddSmoothMove(clip, 90, 90, 30, 30);
+    clip.Legs(90, 90, 30, 30);
+    clip.Wait(delay_time);
+}
+
+void Otto::AddLieDown(MotionBuilder& clip) {
+    // Target lying position: all servos to 5°
+    AddSmoothMove(clip, 5, 5, 5, 5);
+    clip.Legs(5, 5, 5, 5);
+    clip.Wait(500);  // Brief pause after lying down
+}
+
+void Otto::AddWagTail(MotionBuilder& clip, int wags, int speed_delay) {
+    if (servo_pins_[SERVO_TAIL] == -1) {
+        ESP_LOGW(TAG, "Tail servo not connected, skipping wag tail");
+        return;
     }
 
-    // Final adjustment to target
-    for (int i = 0; i < SERVO_COUNT; i++) {
-        if (servo_pins_[i] != -1) {
-            ServoWrite(i, target_angles[i]);
-        }
+    // Center position for tail
+    const int tail_center = 90;
+    const int tail_left = 30;    // Increased swing angle: was 45, now 30 (more left)
+    const int tail_right = 150;  // Increased swing angle: was 135, now 150 (more right)
+
+    // Reset to center first
+    clip.Set(SERVO_TAIL, tail_center).Wait(200);
+
+    // Wag left and right
+    for (int wag_count = 0; wag_count < wags; wag_count++) {
+        clip.Set(SERVO_TAIL, tail_right).Wait(speed_delay);
+        clip.Set(SERVO_TAIL, tail_left).Wait(speed_delay);
+    }
+
+    // Return to center
+    clip.Set(SERVO_TAIL, tail_center);
+}
+
+void Otto::SetMotionSpeed(int percent) {
+    motion_.SetSpeed(percent);
+    ESP_LOGI(TAG, "Motion speed set to %d%%", motion_.GetSpeed());
+}
+
+int Otto::GetMotionSpeed() {
+    return motion_.GetSpeed();
+}
+
+void Otto::SetMotionBlend(int blend_ms) {
+    motion_blend_ms_ = std::max(0, blend_ms);
+}
+
+bool Otto::IsMoving() {
+    return motion_.IsBusy();
+}
+
+// Latched in the engine: a routine between two clips must not start the next one
+void Otto::Interrupt() {
+    motion_.Interrupt();
+}
+
+void Otto::Resume() {
+    motion_.Resume();
+}
+
+bool Otto::IsInterrupted() {
+    return motion_.IsInterrupted();
+}
+
+void Otto::SetMotionProfile(TrajectoryProfile profile) {
+    motion_profile_ = profile;
+}
+
+void Otto::SetJointLimits(int servo_id, float max_speed, float max_accel) {
+    if (servo_id < 0 || servo_id >= SERVO_COUNT) {
+        return;
     }
+    joint_limits_[servo_id].max_speed = max_speed;
+    joint_limits_[servo_id].max_accel = max_accel;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -232,45 +320,12 @@ void Otto::Home() {
 
 void Otto::StandUp() {
     ESP_LOGI(TAG, "Dog standing up to rest position (smooth relaxed style)");
-    
-    // Get current positions
-    int current_lf = GetServoAngle(SERVO_LF);
-    int current_rf = GetServoAngle(SERVO_RF);
-    int current_lb = GetServoAngle(SERVO_LB);
-    int current_rb = GetServoAngle(SERVO_RB);
-    
-    // Target standing position: all servos to 90°
-    const int target = 90;
-    const int step_delay = 12;  // 12ms per step = ~1 second total for smooth movement
-    
-    // Calculate max distance to move
-    int max_steps = 0;
-    max_steps = std::max(max_steps, abs(target - current_lf));
-    max_steps = std::max(max_steps, abs(target - current_rf));
-    max_steps = std::max(max_steps, abs(target - current_lb));
-    max_steps = std::max(max_steps, abs(target - current_rb));
-    
-    // Move all servos smoothly toward 90° simultaneously
-    for (int step = 0; step <= max_steps; step++) {
-        float progress = (max_steps > 0) ? (float)step / max_steps : 1.0f;
-        
-        int lf = current_lf + (int)((target - current_lf) * progress);
-        int rf = current_rf + (int)((target - current_rf) * progress);
-        int lb = current_lb + (int)((target - current_lb) * progress);
-        int rb = current_rb + (int)((target - current_rb) * progress);
-        
-        ServoAngleSet(SERVO_LF, lf, 0);
-        ServoAngleSet(SERVO_RF, rf, 0);
-        ServoAngleSet(SERVO_LB, lb, 0);
-        ServoAngleSet(SERVO_RB, rb, step_delay);
+
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    if (RunClip(clip, "stand_up")) {
+        ESP_LOGI(TAG, "Dog standing up completed smoothly");
     }
-    
-    // Final position ensure
-    ServoInit(90, 90, 90, 90, 0, 90);
-    
-    is_otto_resting_ = true;
-    vTaskDelay(pdMS_TO_TICKS(300));  // Brief pause after standing
-    ESP_LOGI(TAG, "Dog standing up completed smoothly");
 }
 
 bool Otto::GetRestState() {
@@ -285,42 +340,89 @@ void Otto::SetRestState(bool state) {
 //-- DOG-STYLE MOVEMENT FUNCTIONS (from DogMaster) -------------//
 ///////////////////////////////////////////////////////////////////
 
+//-- One gait step: move one or two servos together, then wait speed_delay
+struct GaitStep {
+    int servo_a;
+    int angle_a;
+    int servo_b;  // -1 = single servo step
+    int angle_b;
+};
+
+// DogMaster sequence - LF+RB diagonal, then RF+LB, back to neutral, then the
+// opposite diagonal. 35°/145° instead of 30°/150° for gentler movement
+static const GaitStep kWalkForward[] = {
+    {SERVO_LF, 35, SERVO_RB, 35},   {SERVO_RF, 145, SERVO_LB, 145},
+    {SERVO_LF, 90, SERVO_RB, 90},   {SERVO_RF, 90, SERVO_LB, 90},
+    {SERVO_RF, 35, SERVO_LB, 35},   {SERVO_LF, 145, SERVO_RB, 145},
+    {SERVO_RF, 90, SERVO_LB, 90},   {SERVO_LF, 90, SERVO_RB, 90},
+};
+
+// Same sequence with reversed angles
+static const GaitStep kWalkBackward[] = {
+    {SERVO_LF, 145, SERVO_RB, 145}, {SERVO_RF, 35, SERVO_LB, 35},
+    {SERVO_LF, 90, SERVO_RB, 90},   {SERVO_RF, 90, SERVO_LB, 90},
+    {SERVO_RF, 145, SERVO_LB, 145}, {SERVO_LF, 35, SERVO_RB, 35},
+    {SERVO_RF, 90, SERVO_LB, 90},   {SERVO_LF, 90, SERVO_RB, 90},
+};
+
+// DogMaster Action_TurnLeft: RF+LB first, then LF+RB
+static const GaitStep kTurnLeft[] = {
+    {SERVO_RF, 45, SERVO_LB, 135},
+    {SERVO_LF, 45, SERVO_RB, 135},
+    {SERVO_RF, 90, SERVO_LB, 90},
+    {SERVO_LF, 90, SERVO_RB, 90},
+};
+
+// DogMaster Action_TurnRight: LF+RB first, then RF+LB
+static const GaitStep kTurnRight[] = {
+    {SERVO_LF, 45, SERVO_RB, 135},
+    {SERVO_RF, 45, SERVO_LB, 135},
+    {SERVO_LF, 90, SERVO_RB, 90},
+    {SERVO_RF, 90, SERVO_LB, 90},
+};
+
+// PetDog turnLeft / turnRight move one servo per step
+static const GaitStep kContinuousTurnLeft[] = {
+    {SERVO_RF, 90, -1, 0},  {SERVO_RB, 90, -1, 0},  {SERVO_LF, 90, -1, 0},  {SERVO_LB, 90, -1, 0},
+    {SERVO_RF, 90, -1, 0},  {SERVO_RB, 50, -1, 0},  {SERVO_LF, 130, -1, 0}, {SERVO_LB, 90, -1, 0},
+    {SERVO_RF, 130, -1, 0}, {SERVO_RB, 50, -1, 0},  {SERVO_LF, 130, -1, 0}, {SERVO_LB, 50, -1, 0},
+    {SERVO_RF, 130, -1, 0}, {SERVO_RB, 90, -1, 0},  {SERVO_LF, 90, -1, 0},  {SERVO_LB, 50, -1, 0},
+};
+
+static const GaitStep kContinuousTurnRight[] = {
+    {SERVO_RF, 130, -1, 0}, {SERVO_RB, 90, -1, 0},  {SERVO_LF, 90, -1, 0},  {SERVO_LB, 50, -1, 0},
+    {SERVO_RF, 130, -1, 0}, {SERVO_RB, 50, -1, 0},  {SERVO_LF, 130, -1, 0}, {SERVO_LB, 50, -1, 0},
+    {SERVO_RF, 90, -1, 0},  {SERVO_RB, 50, -1, 0},  {SERVO_LF, 130, -1, 0}, {SERVO_LB, 90, -1, 0},
+    {SERVO_RF, 90, -1, 0},  {SERVO_RB, 90, -1, 0},  {SERVO_LF, 90, -1, 0},  {SERVO_LB, 90, -1, 0},
+};
+
+template <size_t N>
+static void AddGait(MotionBuilder& clip, const GaitStep (&steps)[N], int speed_delay) {
+    for (const GaitStep& step : steps) {
+        clip.Set(step.servo_a, step.angle_a);
+        if (step.servo_b >= 0) {
+            clip.Set(step.servo_b, step.angle_b);
+        }
+        clip.Wait(speed_delay);
+    }
+}
+
 //-- Dog Walk Forward (adapted from DogMaster Action_Advance)
 void Otto::DogWalk(int steps, int speed_delay) {
     ESP_LOGI(TAG, "Dog walking forward for %d steps", steps);
     
     // Preparation movement to avoid interference
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(120));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(120);
 
     for (int i = 0; i < steps; i++) {
-        // Step 1: DogMaster sequence - LF+RB diagonal, then RF+LB
-        // Changed from 30°/150° to 35°/145° (reduced by 5° for gentler movement)
-        ServoAngleSet(SERVO_LF, 35, 0);
-        ServoAngleSet(SERVO_RB, 35, speed_delay);
-        ServoAngleSet(SERVO_RF, 145, 0);
-        ServoAngleSet(SERVO_LB, 145, speed_delay);
-
-        // Return to neutral with same sequence
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        // Step 2: Opposite diagonal - RF+LB, then LF+RB  
-        ServoAngleSet(SERVO_RF, 35, 0);
-        ServoAngleSet(SERVO_LB, 35, speed_delay);
-        ServoAngleSet(SERVO_LF, 145, 0);
-        ServoAngleSet(SERVO_RB, 145, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
+        AddGait(clip, kWalkForward, speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog walk forward completed");
+    if (RunClip(clip, "walk")) {
+        ESP_LOGI(TAG, "Dog walk forward completed");
+    }
 }
 
 //-- Dog Walk Backward (adapted from DogMaster Action_Back)
@@ -328,389 +430,295 @@ void Otto::DogWalkBack(int steps, int speed_delay) {
     ESP_LOGI(TAG, "Dog walking backward for %d steps", steps);
     
     // Preparation movement - same delay as forward
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(120));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(120);
 
     for (int i = 0; i < steps; i++) {
-        // Step 1: DogMaster sequence - LF+RB diagonal (reversed angles)
-        // Changed from 30°/150° to 35°/145° (reduced by 5° for gentler movement)
-        ServoAngleSet(SERVO_LF, 145, 0);    // Reversed: from 35 → 145
-        ServoAngleSet(SERVO_RB, 145, speed_delay);
-        ServoAngleSet(SERVO_RF, 35, 0);     // Reversed: from 145 → 35
-        ServoAngleSet(SERVO_LB, 35, speed_delay);
-
-        // Return to neutral with same sequence
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        // Step 2: Opposite diagonal - RF+LB (reversed angles)
-        ServoAngleSet(SERVO_RF, 145, 0);    // Reversed: from 35 → 145
-        ServoAngleSet(SERVO_LB, 145, speed_delay);
-        ServoAngleSet(SERVO_LF, 35, 0);     // Reversed: from 145 → 35
-        ServoAngleSet(SERVO_RB, 35, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
+        AddGait(clip, kWalkBackward, speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog walk backward completed");
+    if (RunClip(clip, "walk_back")) {
+        ESP_LOGI(TAG, "Dog walk backward completed");
+    }
 }
 
 //-- Dog Turn Left (adapted from DogMaster Action_TurnLeft)
 void Otto::DogTurnLeft(int steps, int speed_delay) {
     ESP_LOGI(TAG, "Dog turning left for %d steps", steps);
     
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(500);
 
     for (int i = 0; i < steps; i++) {
-        // DogMaster sequence: RF+LB first, then LF+RB
-        ServoAngleSet(SERVO_RF, 45, 0);
-        ServoAngleSet(SERVO_LB, 135, speed_delay);
-        ServoAngleSet(SERVO_LF, 45, 0);
-        ServoAngleSet(SERVO_RB, 135, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
+        AddGait(clip, kTurnLeft, speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog turn left completed");
+    if (RunClip(clip, "turn_left")) {
+        ESP_LOGI(TAG, "Dog turn left completed");
+    }
 }
 
 //-- Dog Turn Right (adapted from DogMaster Action_TurnRight)
 void Otto::DogTurnRight(int steps, int speed_delay) {
     ESP_LOGI(TAG, "Dog turning right for %d steps", steps);
     
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(500);
 
     for (int i = 0; i < steps; i++) {
-        // DogMaster sequence: LF+RB first, then RF+LB  
-        ServoAngleSet(SERVO_LF, 45, 0);
-        ServoAngleSet(SERVO_RB, 135, speed_delay);
-        ServoAngleSet(SERVO_RF, 45, 0);
-        ServoAngleSet(SERVO_LB, 135, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
+        AddGait(clip, kTurnRight, speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog turn right completed");
+    if (RunClip(clip, "turn_right")) {
+        ESP_LOGI(TAG, "Dog turn right completed");
+    }
 }
 
 //-- Dog Sit Down (adapted from DogMaster Action_SitDown)
 void Otto::DogSitDown(int delay_time) {
     ESP_LOGI(TAG, "Dog sitting down smoothly");
     
-    // Get current positions
-    int current_lf = GetServoAngle(SERVO_LF);
-    int current_rf = GetServoAngle(SERVO_RF);
-    int current_lb = GetServoAngle(SERVO_LB);
-    int current_rb = GetServoAngle(SERVO_RB);
-    
-    // Target sitting position: front legs at 90°, back legs at 30°
-    const int target_lf = 90;
-    const int target_rf = 90;
-    const int target_lb = 30;
-    const int target_rb = 30;
-    const int step_delay = 12;  // 12ms per step = ~1 second for smooth movement
-    
-    // Calculate max distance to move
-    int max_steps = 0;
-    max_steps = std::max(max_steps, abs(target_lf - current_lf));
-    max_steps = std::max(max_steps, abs(target_rf - current_rf));
-    max_steps = std::max(max_steps, abs(target_lb - current_lb));
-    max_steps = std::max(max_steps, abs(target_rb - current_rb));
-    
-    // Move all servos smoothly toward target simultaneously
-    for (int step = 0; step <= max_steps; step++) {
-        float progress = (max_steps > 0) ? (float)step / max_steps : 1.0f;
-        
-        int lf = current_lf + (int)((target_lf - current_lf) * progress);
-        int rf = current_rf + (int)((target_rf - current_rf) * progress);
-        int lb = current_lb + (int)((target_lb - current_lb) * progress);
-        int rb = current_rb + (int)((target_rb - current_rb) * progress);
-        
-        ServoAngleSet(SERVO_LF, lf, 0);
-        ServoAngleSet(SERVO_RF, rf, 0);
-        ServoAngleSet(SERVO_LB, lb, 0);
-        ServoAngleSet(SERVO_RB, rb, step_delay);
+    MotionBuilder clip = BeginClip();
+    AddSitDown(clip, delay_time);
+    if (RunClip(clip, "sit_down")) {
+        ESP_LOGI(TAG, "Dog sit down completed smoothly");
     }
-    
-    // Final position ensure
-    ExecuteDogMovement(90, 90, 30, 30, 0);
-    
-    vTaskDelay(pdMS_TO_TICKS(delay_time));
-    ESP_LOGI(TAG, "Dog sit down completed smoothly");
 }
 
 //-- Dog Lie Down (adapted from DogMaster Action_LieDown)
-void Otto::DogLieDown(int delay_time) {
+void Otto::DogLieDown(int /*delay_time*/) {
     ESP_LOGI(TAG, "Dog lying down completely (smooth relaxed style)");
     
-    // Get current positions
-    int current_lf = GetServoAngle(SERVO_LF);
-    int current_rf = GetServoAngle(SERVO_RF);
-    int current_lb = GetServoAngle(SERVO_LB);
-    int current_rb = GetServoAngle(SERVO_RB);
-    
-    // Target lying position: all servos to 5°
-    const int target = 5;
-    const int step_delay = 12;  // 12ms per step = ~1 second total for smooth movement
-    
-    // Calculate max distance to move
-    int max_steps = 0;
-    max_steps = std::max(max_steps, abs(target - current_lf));
-    max_steps = std::max(max_steps, abs(target - current_rf));
-    max_steps = std::max(max_steps, abs(target - current_lb));
-    max_steps = std::max(max_steps, abs(target - current_rb));
-    
-    // Move all servos smoothly toward 5° simultaneously
-    for (int step = 0; step <= max_steps; step++) {
-        float progress = (max_steps > 0) ? (float)step / max_steps : 1.0f;
-        
-        int lf = current_lf + (int)((target - current_lf) * progress);
-        int rf = current_rf + (int)((target - current_rf) * progress);
-        int lb = current_lb + (int)((target - current_lb) * progress);
-        int rb = current_rb + (int)((target - current_rb) * progress);
-        
-        ServoAngleSet(SERVO_LF, lf, 0);
-        ServoAngleSet(SERVO_RF, rf, 0);
-        ServoAngleSet(SERVO_LB, lb, 0);
-        ServoAngleSet(SERVO_RB, rb, step_delay);
+    MotionBuilder clip = BeginClip();
+    AddLieDown(clip);
+    if (RunClip(clip, "lie_down")) {
+        ESP_LOGI(TAG, "Dog lying down completed smoothly");
     }
-    
-    // Final position ensure
-    ExecuteDogMovement(5, 5, 5, 5, 0);
-    
-    vTaskDelay(pdMS_TO_TICKS(500));  // Brief pause after lying down
-    ESP_LOGI(TAG, "Dog lying down completed smoothly");
 }
 
 //-- Dog Jump (adapted from DogMaster Action_Jump)
 void Otto::DogJump(int delay_time) {
     ESP_LOGI(TAG, "Dog jumping");
     
+    MotionBuilder clip = BeginClip();
+
     // Prepare to jump - crouch down
-    ExecuteDogMovement(60, 60, 60, 60, delay_time);
+    clip.Legs(60, 60, 60, 60).Wait(delay_time);
     
     // Jump up - extend all legs
-    ExecuteDogMovement(120, 120, 120, 120, 100);
+    clip.Legs(120, 120, 120, 120).Wait(100);
     
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Wait(300);
     
     // Land - return to standing
-    StandUp();
+    AddStandUp(clip);
     
-    ESP_LOGI(TAG, "Dog jump completed");
+    if (RunClip(clip, "jump")) {
+        ESP_LOGI(TAG, "Dog jump completed");
+    }
 }
 
 //-- Dog Bow (adapted from DogMaster Action_Bow)
 void Otto::DogBow(int delay_time) {
     ESP_LOGI(TAG, "Dog bowing smoothly");
     
-    // Get current positions
-    int current_lf = GetServoAngle(SERVO_LF);
-    int current_rf = GetServoAngle(SERVO_RF);
-    int current_lb = GetServoAngle(SERVO_LB);
-    int current_rb = GetServoAngle(SERVO_RB);
-    
     // Target bow position: front legs at 0°, back legs at 90°
-    const int target_lf = 0;
-    const int target_rf = 0;
-    const int target_lb = 90;
-    const int target_rb = 90;
-    const int step_delay = 12;  // 12ms per step = ~1 second for smooth movement
-    
-    // Calculate max distance to move
-    int max_steps = 0;
-    max_steps = std::max(max_steps, abs(target_lf - current_lf));
-    max_steps = std::max(max_steps, abs(target_rf - current_rf));
-    max_steps = std::max(max_steps, abs(target_lb - current_lb));
-    max_steps = std::max(max_steps, abs(target_rb - current_rb));
-    
-    // Move all servos smoothly toward target simultaneously
-    for (int step = 0; step <= max_steps; step++) {
-        float progress = (max_steps > 0) ? (float)step / max_steps : 1.0f;
-        
-        int lf = current_lf + (int)((target_lf - current_lf) * progress);
-        int rf = current_rf + (int)((target_rf - current_rf) * progress);
-        int lb = current_lb + (int)((target_lb - current_lb) * progress);
-        int rb = current_rb + (int)((target_rb - current_rb) * progress);
-        
-        ServoAngleSet(SERVO_LF, lf, 0);
-        ServoAngleSet(SERVO_RF, rf, 0);
-        ServoAngleSet(SERVO_LB, lb, 0);
-        ServoAngleSet(SERVO_RB, rb, step_delay);
-    }
-    
-    // Final position ensure
-    ExecuteDogMovement(0, 0, 90, 90, 0);
+    MotionBuilder clip = BeginClip();
+    AddSmoothMove(clip, 0, 0, 90, 90);
+    clip.Legs(0, 0, 90, 90);
     
-    vTaskDelay(pdMS_TO_TICKS(delay_time));  // Hold bow position
+    clip.Wait(delay_time);  // Hold bow position
     
     // Stand up again smoothly
-    StandUp();
+    AddStandUp(clip);
     
-    ESP_LOGI(TAG, "Dog bow completed smoothly");
+    if (RunClip(clip, "bow")) {
+        ESP_LOGI(TAG, "Dog bow completed smoothly");
+    }
 }
 
 //-- Dog Dance (adapted from DogMaster Action_Dance)
-void Otto::DogDance(int cycles, int speed_delay) {
+void Otto::DogDance(int cycles, int /*speed_delay*/) {
     ESP_LOGI(TAG, "Dog dancing for %d cycles", cycles);
     
+    MotionBuilder clip = BeginClip();
     for (int i = 0; i < cycles; i++) {
         // Step 1: Lean left (left side down, right side up)
-        ExecuteDogMovement(60, 120, 60, 120, 200);
+        clip.Legs(60, 120, 60, 120).Wait(200);
         
         // Step 2: Lean right (left side up, right side down)
-        ExecuteDogMovement(120, 60, 120, 60, 200);
+        clip.Legs(120, 60, 120, 60).Wait(200);
         
         // Step 3: Small jump - crouch down
-        ExecuteDogMovement(75, 75, 105, 105, 150);
-        vTaskDelay(pdMS_TO_TICKS(100));
+        clip.Legs(75, 75, 105, 105).Wait(150);
+        clip.Wait(100);
         
         // Jump up
-        ExecuteDogMovement(105, 105, 75, 75, 150);
+        clip.Legs(105, 105, 75, 75).Wait(150);
     }
     
     // End with standing position
-    StandUp();
+    AddStandUp(clip);
     
-    ESP_LOGI(TAG, "Dog dance completed");
+    if (RunClip(clip, "dance")) {
+        ESP_LOGI(TAG, "Dog dance completed");
+    }
 }
 
 //-- Dog Wave Right Foot (adapted from DogMaster Action_WaveRightFoot) - SITTING VERSION
 void Otto::DogWaveRightFoot(int waves, int speed_delay) {
     ESP_LOGI(TAG, "Dog waving right front foot %d times (sitting)", waves);
     
+    MotionBuilder clip = BeginClip();
+
     // Prepare sitting position: LF standing (90°), RF ready to wave (90°), back legs sitting (30°)
-    ExecuteDogMovement(90, 90, 30, 30, 300);
+    clip.Legs(90, 90, 30, 30).Wait(300);
     
-    // Wave right front leg from 90° to 0° (slower: 16ms delay instead of 8ms)
+    // Wave right front leg 90° -> 0° -> 90° in 5° steps of 16ms (19 steps each way)
     // LF stays at 90° (standing), LB and RB stay at 30° (sitting)
     for (int wave_count = 0; wave_count < waves; wave_count++) {
-        ESP_LOGI(TAG, "Wave %d (sitting)", wave_count + 1);
-        
-        // Wave down from 90° to 0°
-        for (int angle = 90; angle >= 0; angle -= 5) {
-            ServoAngleSet(SERVO_RF, angle, 0);
-            vTaskDelay(pdMS_TO_TICKS(16));  // Slower: 16ms (was 8ms)
-        }
+        clip.Set(SERVO_RF, 90).Ramp(SERVO_RF, 0, 18 * 16).Wait(19 * 16);
+        clip.Wait(speed_delay);
         
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
-        
-        // Wave up from 0° to 90°
-        for (int angle = 0; angle <= 90; angle += 5) {
-            ServoAngleSet(SERVO_RF, angle, 0);
-            vTaskDelay(pdMS_TO_TICKS(16));  // Slower: 16ms (was 8ms)
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
+        clip.Set(SERVO_RF, 0).Ramp(SERVO_RF, 90, 18 * 16).Wait(19 * 16);
+        clip.Wait(speed_delay);
     }
     
-    ESP_LOGI(TAG, "Right foot wave completed (sitting)");
-    
     // End with sitting position (already sitting, just ensure proper posture)
-    DogSitDown(300);
+    AddSitDown(clip, 300);
+
+    if (RunClip(clip, "wave_right_foot")) {
+        ESP_LOGI(TAG, "Right foot wave completed (sitting)");
+    }
 }
 
 //-- Dog Dance 4 Feet (adapted from DogMaster Action_Dance4Feet)
 void Otto::DogDance4Feet(int cycles, int speed_delay) {
     ESP_LOGI(TAG, "Dog dancing with 4 feet for %d cycles", cycles);
     
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(200));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(200);
     
     for (int cycle = 0; cycle < cycles; cycle++) {
         // PHASE 1: All feet move forward together
-        ESP_LOGI(TAG, "All feet forward");
-        ExecuteDogMovement(60, 60, 60, 60, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(400));
+        clip.Legs(60, 60, 60, 60).Wait(speed_delay);
+        clip.Wait(400);
         
         // PHASE 2: All feet move backward together
-        ESP_LOGI(TAG, "All feet backward");
-        ExecuteDogMovement(120, 120, 120, 120, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(400));
+        clip.Legs(120, 120, 120, 120).Wait(speed_delay);
+        clip.Wait(400);
         
         // PHASE 3: Return to center (90°)
-        ExecuteDogMovement(90, 90, 90, 90, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(200));
+        clip.Legs(90, 90, 90, 90).Wait(speed_delay);
+        clip.Wait(200);
     }
     
     // End with firm standing position
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(500));
+    AddStandUp(clip);
+    clip.Wait(500);
     
-    ESP_LOGI(TAG, "4-feet dance completed");
+    if (RunClip(clip, "dance_4_feet")) {
+        ESP_LOGI(TAG, "4-feet dance completed");
+    }
 }
 
 //-- Dog Swing (adapted from DogMaster Action_Swing)
 void Otto::DogSwing(int cycles, int speed_delay) {
     ESP_LOGI(TAG, "Dog swinging for %d cycles", cycles);
     
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(500);
 
-    // Initial lean to prepare
-    for (int i = 90; i > 30; i--) {
-        ExecuteDogMovement(i, i, i, i, 0);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
-    }
+    // Initial lean to prepare: 90 -> 31, one degree per step
+    static const int upright[SERVO_COUNT] = {90, 90, 90, 90, 90};
+    static const int leaned[SERVO_COUNT] = {31, 31, 31, 31, 90};
+    clip.Sweep(MOTION_MASK_LEGS, upright, leaned, 60, speed_delay);
     
-    // Swing back and forth
+    // Swing back and forth: left legs 30 <-> 90, right legs mirrored around 55
+    static const int swing_out_from[SERVO_COUNT] = {30, 80, 30, 80, 90};
+    static const int swing_out_to[SERVO_COUNT] = {89, 21, 89, 21, 90};
+    static const int swing_back_from[SERVO_COUNT] = {90, 20, 90, 20, 90};
+    static const int swing_back_to[SERVO_COUNT] = {31, 79, 31, 79, 90};
     for (int temp = 0; temp < cycles; temp++) {
-        for (int i = 30; i < 90; i++) {
-            ExecuteDogMovement(i, 110 - i, i, 110 - i, 0);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
-        }
-        for (int i = 90; i > 30; i--) {
-            ExecuteDogMovement(i, 110 - i, i, 110 - i, 0);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
-        }
+        clip.Sweep(MOTION_MASK_LEGS, swing_out_from, swing_out_to, 60, speed_delay);
+        clip.Sweep(MOTION_MASK_LEGS, swing_back_from, swing_back_to, 60, speed_delay);
     }
     
-    DogSitDown(0);
+    AddSitDown(clip, 0);
     
-    ESP_LOGI(TAG, "Dog swing completed");
+    if (RunClip(clip, "swing")) {
+        ESP_LOGI(TAG, "Dog swing completed");
+    }
+}
+
+//-- Dog Beat Step - one pose of DogDance/DogSwing per music beat
+// The move takes move_time ms so the pose lands on the beat when started move_time early
+void Otto::DogBeatStep(int style, int beat, int move_time) {
+    // DogDance poses: lean left, lean right, crouch, jump up
+    static const int dance_poses[4][4] = {
+        {60, 120, 60, 120},
+        {120, 60, 120, 60},
+        {75, 75, 105, 105},
+        {105, 105, 75, 75},
+    };
+    // DogSwing extremes
+    static const int swing_poses[2][4] = {
+        {30, 80, 30, 80},
+        {90, 20, 90, 20},
+    };
+
+    if (GetRestState() == true) {
+        SetRestState(false);
+    }
+
+    const int* pose = style == BEAT_STYLE_SWING ? swing_poses[beat % 2] : dance_poses[beat % 4];
+    int tail = (beat % 2) ? 60 : 120;  // Tail flicks every beat
+
+    MotionBuilder clip = BeginClip();
+    if (move_time > 10) {
+        clip.RampLegs(pose[0], pose[1], pose[2], pose[3], move_time);
+        clip.Ramp(SERVO_TAIL, tail, move_time);
+    } else {
+        clip.Legs(pose[0], pose[1], pose[2], pose[3]);
+        clip.Set(SERVO_TAIL, tail);
+    }
+    clip.Wait(move_time);
+    RunClip(clip, "beat_step");
 }
 
 //-- Dog Stretch (adapted from DogMaster Action_Stretch)
 void Otto::DogStretch(int cycles, int speed_delay) {
     ESP_LOGI(TAG, "Dog stretching for %d cycles", cycles);
     
-    ExecuteDogMovement(90, 90, 90, 90, 80);
-
+    MotionBuilder clip = BeginClip();
+    clip.Legs(90, 90, 90, 90).Wait(80);
+
+    // Each sweep moves one degree per step, 80 steps
+    static const int neutral[SERVO_COUNT] = {90, 90, 90, 90, 90};
+    static const int front_down_to[SERVO_COUNT] = {11, 11, 90, 90, 90};
+    static const int front_up_from[SERVO_COUNT] = {10, 10, 90, 90, 90};
+    static const int front_up_to[SERVO_COUNT] = {89, 89, 90, 90, 90};
+    static const int back_up_to[SERVO_COUNT] = {90, 90, 169, 169, 90};
+    static const int back_down_from[SERVO_COUNT] = {90, 90, 170, 170, 90};
+    static const int back_down_to[SERVO_COUNT] = {90, 90, 91, 91, 90};
     for (int i = 0; i < cycles; i++) {
         // Stretch front legs down
-        for (int j = 90; j > 10; j--) {
-            ExecuteDogMovement(j, j, 90, 90, speed_delay);
-        }
-        for (int j = 10; j < 90; j++) {
-            ExecuteDogMovement(j, j, 90, 90, speed_delay);
-        }
+        clip.Sweep(MOTION_MASK_LEGS, neutral, front_down_to, 80, speed_delay);
+        clip.Sweep(MOTION_MASK_LEGS, front_up_from, front_up_to, 80, speed_delay);
         
         // Stretch back legs up
-        for (int j = 90; j < 170; j++) {
-            ExecuteDogMovement(90, 90, j, j, speed_delay);
-        }
-        for (int j = 170; j > 90; j--) {
-            ExecuteDogMovement(90, 90, j, j, speed_delay);
-        }
+        clip.Sweep(MOTION_MASK_LEGS, neutral, back_up_to, 80, speed_delay);
+        clip.Sweep(MOTION_MASK_LEGS, back_down_from, back_down_to, 80, speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog stretch completed");
+    if (RunClip(clip, "stretch")) {
+        ESP_LOGI(TAG, "Dog stretch completed");
+    }
 }
 
 //-- Dog Scratch (gãi ngứa): Sit + BR leg wave continuously
@@ -718,32 +726,24 @@ void Otto::DogScratch(int scratches, int speed_delay) {
     ESP_LOGI(TAG, "Dog scratching %d times", scratches);
     
     // Sit down first
-    DogSitDown(500);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    MotionBuilder clip = BeginClip();
+    AddSitDown(clip, 500);
+    clip.Wait(300);
     
     // Wave back-right leg continuously while sitting
     for (int scratch_count = 0; scratch_count < scratches; scratch_count++) {
-        ESP_LOGI(TAG, "Scratch %d", scratch_count + 1);
+        // Scratch motion: RB from 30° down to 0° (then back up to 30°), 10° every 20ms
+        clip.Set(SERVO_RB, 30).Ramp(SERVO_RB, 0, 3 * 20).Wait(4 * 20);
+        clip.Wait(speed_delay);
         
-        // Scratch motion: RB from 30° down to 0° (then back up to 30°)
-        for (int angle = 30; angle >= 0; angle -= 10) {
-            ServoAngleSet(SERVO_RB, angle, 0);
-            vTaskDelay(pdMS_TO_TICKS(20));
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
-        
-        for (int angle = 0; angle <= 30; angle += 10) {
-            ServoAngleSet(SERVO_RB, angle, 0);
-            vTaskDelay(pdMS_TO_TICKS(20));
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
+        clip.Set(SERVO_RB, 0).Ramp(SERVO_RB, 30, 3 * 20).Wait(4 * 20);
+        clip.Wait(speed_delay);
     }
     
-    ESP_LOGI(TAG, "Dog scratch completed");
-    
     // Stay sitting (no auto stand-up)
+    if (RunClip(clip, "scratch")) {
+        ESP_LOGI(TAG, "Dog scratch completed");
+    }
 }
 
 //-- Otto wag tail (new movement with SERVO_TAIL)
@@ -755,31 +755,11 @@ void Otto::WagTail(int wags, int speed_delay) {
     
     ESP_LOGI(TAG, "🐕 Wagging tail %d times", wags);
     
-    // Center position for tail
-    const int tail_center = 90;
-    const int tail_left = 30;    // Increased swing angle: was 45, now 30 (more left)
-    const int tail_right = 150;  // Increased swing angle: was 135, now 150 (more right)
-    
-    // Reset to center first
-    ServoAngleSet(SERVO_TAIL, tail_center, 0);
-    vTaskDelay(pdMS_TO_TICKS(200));
-    
-    // Wag left and right
-    for (int wag_count = 0; wag_count < wags; wag_count++) {
-        ESP_LOGI(TAG, "Wag %d", wag_count + 1);
-        
-        // Wag to right
-        ServoAngleSet(SERVO_TAIL, tail_right, 0);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
-        
-        // Wag to left
-        ServoAngleSet(SERVO_TAIL, tail_left, 0);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
+    MotionBuilder clip = BeginClip();
+    AddWagTail(clip, wags, speed_delay);
+    if (RunClip(clip, "wag_tail")) {
+        ESP_LOGI(TAG, "🐕 Tail wag completed");
     }
-    
-    // Return to center
-    ServoAngleSet(SERVO_TAIL, tail_center, 0);
-    ESP_LOGI(TAG, "🐕 Tail wag completed");
 }
 
 //-- Dog Roll Over (new movement - lăn qua lăn lại)
@@ -787,33 +767,34 @@ void Otto::DogRollOver(int rolls, int speed_delay) {
     ESP_LOGI(TAG, "🐕 Rolling over %d times", rolls);
     
     // Start from lying down position
-    DogLieDown(800);
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddLieDown(clip);
+    clip.Wait(500);
     
     for (int roll_count = 0; roll_count < rolls; roll_count++) {
-        ESP_LOGI(TAG, "Roll %d", roll_count + 1);
-        
         // Roll to the right side - all servos move together (SYNC)
         // Lift left side legs up, right side legs stay down
-        ExecuteDogMovement(150, 30, 150, 30, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay * 2));
+        clip.Legs(150, 30, 150, 30).Wait(speed_delay);
+        clip.Wait(speed_delay * 2);
         
         // Complete the roll - all legs on ground briefly (SYNC)
-        ExecuteDogMovement(90, 90, 90, 90, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
+        clip.Legs(90, 90, 90, 90).Wait(speed_delay);
+        clip.Wait(speed_delay);
         
         // Now roll back to left - all servos move together (SYNC)
-        ExecuteDogMovement(30, 150, 30, 150, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay * 2));
+        clip.Legs(30, 150, 30, 150).Wait(speed_delay);
+        clip.Wait(speed_delay * 2);
         
         // Complete the roll back to original position (SYNC)
-        ExecuteDogMovement(90, 90, 90, 90, speed_delay);
-        vTaskDelay(pdMS_TO_TICKS(speed_delay));
+        clip.Legs(90, 90, 90, 90).Wait(speed_delay);
+        clip.Wait(speed_delay);
     }
     
     // End by standing up
-    StandUp();
-    ESP_LOGI(TAG, "🐕 Roll over completed");
+    AddStandUp(clip);
+    if (RunClip(clip, "roll_over")) {
+        ESP_LOGI(TAG, "🐕 Roll over completed");
+    }
 }
 
 //-- Dog Play Dead (new movement - giả chết)
@@ -821,25 +802,20 @@ void Otto::DogPlayDead(int duration_seconds) {
     ESP_LOGI(TAG, "💀 Playing dead for %d seconds", duration_seconds);
     
     // Lie down dramatically
-    DogLieDown(1200);
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddLieDown(clip);
+    clip.Wait(500);
     
     // Stay completely still for the specified duration
     // Legs stay at 5° (lying flat), no movement
-    int total_delay = duration_seconds * 1000; // Convert to milliseconds
-    int check_interval = 1000; // Check every 1 second
-    int checks = total_delay / check_interval;
-    
-    for (int i = 0; i < checks; i++) {
-        ESP_LOGI(TAG, "💀 Still playing dead... (%d/%d seconds)", i + 1, duration_seconds);
-        vTaskDelay(pdMS_TO_TICKS(check_interval));
-    }
+    clip.Wait(duration_seconds * 1000);
     
     // Slowly "come back to life" - gentle stand up
-    ESP_LOGI(TAG, "🐕 Coming back to life...");
-    StandUp();
+    AddStandUp(clip);
     
-    ESP_LOGI(TAG, "🐕 Play dead completed");
+    if (RunClip(clip, "play_dead")) {
+        ESP_LOGI(TAG, "🐕 Play dead completed");
+    }
 }
 
 //-- Dog Shake Paw (bắt tay)
@@ -847,26 +823,29 @@ void Otto::DogShakePaw(int shakes, int speed_delay) {
     ESP_LOGI(TAG, "🤝 Shaking paw %d times (fast mode)", shakes);
     
     // Start from standing position
-    Home();
-    vTaskDelay(pdMS_TO_TICKS(50));  // Faster start
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(50);  // Faster start
     
     for (int i = 0; i < shakes; i++) {
         // Shift weight slightly to left for balance (SYNC - all servos together)
-        ExecuteDogMovement(80, 75, 70, 110, speed_delay / 2);
-        vTaskDelay(pdMS_TO_TICKS(40));  // Faster delay
+        clip.Legs(80, 75, 70, 110).Wait(speed_delay / 2);
+        clip.Wait(40);  // Faster delay
         
         // Lift right front paw (RF to high position) - keep other legs stable
-        ExecuteDogMovement(80, 0, 70, 110, speed_delay / 4);
-        vTaskDelay(pdMS_TO_TICKS(150));  // Faster hold
+        clip.Legs(80, 0, 70, 110).Wait(speed_delay / 4);
+        clip.Wait(150);  // Faster hold
         
         // Put paw down quickly (SYNC)
-        ExecuteDogMovement(80, 90, 70, 110, speed_delay / 4);
-        vTaskDelay(pdMS_TO_TICKS(40));  // Faster delay
+        clip.Legs(80, 90, 70, 110).Wait(speed_delay / 4);
+        clip.Wait(40);  // Faster delay
     }
     
     // Return to standing
-    Home();
-    ESP_LOGI(TAG, "🤝 Shake paw completed (fast & high)");
+    AddStandUp(clip);
+    if (RunClip(clip, "shake_paw")) {
+        ESP_LOGI(TAG, "🤝 Shake paw completed (fast & high)");
+    }
 }
 
 //-- Dog Wave Left Foot (vẫy chân trái)
@@ -875,31 +854,30 @@ void Otto::DogSidestep(int steps, int speed_delay, int direction) {
     ESP_LOGI(TAG, "⬅️➡️ Sidestepping %d steps, direction=%d", steps, direction);
     
     // direction: 1 = right, -1 = left
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(200));
+    MotionBuilder clip = BeginClip();
+    AddStandUp(clip);
+    clip.Wait(200);
     
     for (int i = 0; i < steps; i++) {
         if (direction > 0) {
             // Sidestep RIGHT: lift left side, shift right (SYNC)
-            ExecuteDogMovement(120, 80, 120, 80, speed_delay);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
+            clip.Legs(120, 80, 120, 80).Wait(speed_delay * 2);
             
             // Plant left, lift right (SYNC)
-            ExecuteDogMovement(80, 120, 80, 120, speed_delay);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
+            clip.Legs(80, 120, 80, 120).Wait(speed_delay * 2);
         } else {
             // Sidestep LEFT: lift right side, shift left (SYNC)
-            ExecuteDogMovement(80, 120, 80, 120, speed_delay);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
+            clip.Legs(80, 120, 80, 120).Wait(speed_delay * 2);
             
             // Lift left, plant right (SYNC)
-            ExecuteDogMovement(120, 80, 120, 80, speed_delay);
-            vTaskDelay(pdMS_TO_TICKS(speed_delay));
+            clip.Legs(120, 80, 120, 80).Wait(speed_delay * 2);
         }
     }
     
-    Home();
-    ESP_LOGI(TAG, "⬅️➡️ Sidestep completed");
+    AddStandUp(clip);
+    if (RunClip(clip, "sidestep")) {
+        ESP_LOGI(TAG, "⬅️➡️ Sidestep completed");
+    }
 }
 
 //-- Dog Pushup (chống đẩy)
@@ -907,22 +885,25 @@ void Otto::DogPushup(int pushups, int speed_delay) {
     ESP_LOGI(TAG, "💪 Doing %d pushups", pushups);
     
     // Start in lie down position
-    DogLieDown(speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    AddLieDown(clip);
+    clip.Wait(500);
     
     for (int i = 0; i < pushups; i++) {
         // Push up - front legs extend, back legs stay down (SYNC)
-        ExecuteDogMovement(35, 35, 95, 95, speed_delay * 2);
-        vTaskDelay(pdMS_TO_TICKS(500));
+        clip.Legs(35, 35, 95, 95).Wait(speed_delay * 2);
+        clip.Wait(500);
         
         // Down - front legs bend back down (SYNC)
-        ExecuteDogMovement(100, 100, 95, 95, speed_delay * 2);
-        vTaskDelay(pdMS_TO_TICKS(500));
+        clip.Legs(100, 100, 95, 95).Wait(speed_delay * 2);
+        clip.Wait(500);
     }
     
     // Return to standing
-    StandUp();
-    ESP_LOGI(TAG, "💪 Pushup completed");
+    AddStandUp(clip);
+    if (RunClip(clip, "pushup")) {
+        ESP_LOGI(TAG, "💪 Pushup completed");
+    }
 }
 
 //-- Dog Toilet (đi vệ sinh / squat pose)
@@ -930,24 +911,27 @@ void Otto::DogToilet(int hold_ms, int speed_delay) {
     ESP_LOGI(TAG, "🚽 Starting toilet squat pose, hold %d ms", hold_ms);
 
     // Move to a sitting position first for stability
-    DogSitDown(speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(400));
+    MotionBuilder clip = BeginClip();
+    AddSitDown(clip, speed_delay * 2);
+    clip.Wait(400);
 
     // Squat pose: lower hind legs further, front legs slightly forward (SYNC)
-    ExecuteDogMovement(100, 100, 130, 130, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Legs(100, 100, 130, 130).Wait(speed_delay * 2);
+    clip.Wait(300);
 
     // Small tail wag for realism if tail servo exists
-    WagTail(2, 120);
+    AddWagTail(clip, 2, 120);
 
     // Hold squat
-    vTaskDelay(pdMS_TO_TICKS(hold_ms));
+    clip.Wait(hold_ms);
 
     // Return via sit then home
-    DogSitDown(speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
-    Home();
-    ESP_LOGI(TAG, "🚽 Toilet pose complete");
+    AddSitDown(clip, speed_delay * 2);
+    clip.Wait(300);
+    AddStandUp(clip);
+    if (RunClip(clip, "toilet")) {
+        ESP_LOGI(TAG, "🚽 Toilet pose complete");
+    }
 }
 
 //-- Dog Balance (đứng 2 chân sau - stand on hind legs like kiki-robot)
@@ -961,34 +945,37 @@ void Otto::DogBalance(int duration_ms, int speed_delay) {
     }
     
     // Prepare: shift weight back gradually (SYNC)
-    ExecuteDogMovement(70, 70, 60, 60, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(500));
+    MotionBuilder clip = BeginClip();
+    clip.Legs(70, 70, 60, 60).Wait(speed_delay * 2);
+    clip.Wait(500);
     
     // Lift front legs gradually - stage 1 (SYNC)
-    ExecuteDogMovement(100, 100, 50, 50, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Legs(100, 100, 50, 50).Wait(speed_delay * 2);
+    clip.Wait(300);
     
     // Lift front legs more - stage 2 (SYNC)
-    ExecuteDogMovement(120, 120, 45, 45, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Legs(120, 120, 45, 45).Wait(speed_delay * 2);
+    clip.Wait(300);
     
     // Balance position - front legs high (SYNC)
-    ExecuteDogMovement(140, 140, 40, 40, speed_delay * 2);
+    clip.Legs(140, 140, 40, 40).Wait(speed_delay * 2);
     
     // Hold balance
-    vTaskDelay(pdMS_TO_TICKS(duration_ms));
+    clip.Wait(duration_ms);
     
     // Slowly return down - stage 1 (SYNC)
-    ExecuteDogMovement(110, 110, 50, 50, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Legs(110, 110, 50, 50).Wait(speed_delay * 2);
+    clip.Wait(300);
     
     // Return to standing - stage 2 (SYNC)
-    ExecuteDogMovement(90, 90, 75, 75, speed_delay * 2);
-    vTaskDelay(pdMS_TO_TICKS(300));
+    clip.Legs(90, 90, 75, 75).Wait(speed_delay * 2);
+    clip.Wait(300);
     
     // Return to home position
-    Home();
-    ESP_LOGI(TAG, "⚖️ Balance completed");
+    AddStandUp(clip);
+    if (RunClip(clip, "balance")) {
+        ESP_LOGI(TAG, "⚖️ Balance completed");
+    }
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -996,7 +983,7 @@ void Otto::DogBalance(int duration_ms, int speed_delay) {
 ///////////////////////////////////////////////////////////////////
 
 //-- Otto Jump (simplified for 4 servos)
-void Otto::Jump(float steps, int period) {
+void Otto::Jump(float /*steps*/, int period) {
     ESP_LOGI(TAG, "Legacy jump function");
     DogJump(period / 2);
 }
@@ -1028,7 +1015,7 @@ void Otto::Turn(float steps, int period, int dir) {
 }
 
 //-- Otto Bend (adapted for 4 servos)
-void Otto::Bend(int steps, int period, int dir) {
+void Otto::Bend(int /*steps*/, int period, int /*dir*/) {
     ESP_LOGI(TAG, "Legacy bend function");
     DogBow(period);
 }
@@ -1062,6 +1049,9 @@ void Otto::Stop() {
     
     // Set stop bit for continuous movements
     xEventGroupSetBits(action_event_group_, STOP_ACTION_BIT);
+
+    // Drop the playing clip, the routine waiting on it returns at once
+    motion_.Cancel();
     
     // Stop and reset all servo oscillators immediately
     servo_[SERVO_LF].Stop();
@@ -1099,52 +1089,9 @@ bool Otto::IsActionStopped() {
 void Otto::ContinuousWalk(int speed_delay) {
     ESP_LOGI(TAG, "🚶 Starting continuous walk forward");
     
-    // Clear stop bit before starting
-    xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-    
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(120));
-    
-    while (true) {
-        // Check for stop signal
-        if (IsActionStopped()) {
-            ESP_LOGI(TAG, "🛑 Continuous walk stopped");
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-        
-        // Step 1: LF+RB diagonal forward
-        ServoAngleSet(SERVO_LF, 35, 0);
-        ServoAngleSet(SERVO_RB, 35, speed_delay);
-        ServoAngleSet(SERVO_RF, 145, 0);
-        ServoAngleSet(SERVO_LB, 145, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        // Check for stop again
-        if (IsActionStopped()) {
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-
-        // Step 2: RF+LB diagonal forward
-        ServoAngleSet(SERVO_RF, 35, 0);
-        ServoAngleSet(SERVO_LB, 35, speed_delay);
-        ServoAngleSet(SERVO_LF, 145, 0);
-        ServoAngleSet(SERVO_RB, 145, speed_delay);
-
-        // Return to neutral
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-    }
-    
-    StandUp();
+    MotionBuilder cycle = BeginClip();
+    AddGait(cycle, kWalkForward, speed_delay);
+    RunContinuous(cycle, 120, "walk_loop");
     ESP_LOGI(TAG, "🚶 Continuous walk completed");
 }
 
@@ -1152,47 +1099,9 @@ void Otto::ContinuousWalk(int speed_delay) {
 void Otto::ContinuousWalkBack(int speed_delay) {
     ESP_LOGI(TAG, "🔙 Starting continuous walk backward");
     
-    xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-    
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(120));
-    
-    while (true) {
-        if (IsActionStopped()) {
-            ESP_LOGI(TAG, "🛑 Continuous walk back stopped");
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-        
-        // Step 1: Reversed angles for backward
-        ServoAngleSet(SERVO_LF, 145, 0);
-        ServoAngleSet(SERVO_RB, 145, speed_delay);
-        ServoAngleSet(SERVO_RF, 35, 0);
-        ServoAngleSet(SERVO_LB, 35, speed_delay);
-
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        if (IsActionStopped()) {
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-
-        // Step 2
-        ServoAngleSet(SERVO_RF, 145, 0);
-        ServoAngleSet(SERVO_LB, 145, speed_delay);
-        ServoAngleSet(SERVO_LF, 35, 0);
-        ServoAngleSet(SERVO_RB, 35, speed_delay);
-
-        ServoAngleSet(SERVO_RF, 90, 0);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, 0);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-    }
-    
-    StandUp();
+    MotionBuilder cycle = BeginClip();
+    AddGait(cycle, kWalkBackward, speed_delay);
+    RunContinuous(cycle, 120, "walk_back_loop");
     ESP_LOGI(TAG, "🔙 Continuous walk back completed");
 }
 
@@ -1200,46 +1109,10 @@ void Otto::ContinuousWalkBack(int speed_delay) {
 void Otto::ContinuousTurnLeft(int speed_delay) {
     ESP_LOGI(TAG, "↩️ Starting continuous turn left");
     
-    xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-    
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(200));
-    
-    while (true) {
-        if (IsActionStopped()) {
-            ESP_LOGI(TAG, "🛑 Continuous turn left stopped");
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-        
-        // Turn left sequence (from PetDog)
-        ServoAngleSet(SERVO_RF, 90, speed_delay);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, speed_delay);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        ServoAngleSet(SERVO_RF, 90, speed_delay);
-        ServoAngleSet(SERVO_RB, 50, speed_delay);
-        ServoAngleSet(SERVO_LF, 130, speed_delay);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
-
-        if (IsActionStopped()) {
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-
-        ServoAngleSet(SERVO_RF, 130, speed_delay);
-        ServoAngleSet(SERVO_RB, 50, speed_delay);
-        ServoAngleSet(SERVO_LF, 130, speed_delay);
-        ServoAngleSet(SERVO_LB, 50, speed_delay);
-
-        ServoAngleSet(SERVO_RF, 130, speed_delay);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, speed_delay);
-        ServoAngleSet(SERVO_LB, 50, speed_delay);
-    }
-    
-    StandUp();
+    // Turn left sequence (from PetDog)
+    MotionBuilder cycle = BeginClip();
+    AddGait(cycle, kContinuousTurnLeft, speed_delay);
+    RunContinuous(cycle, 200, "turn_left_loop");
     ESP_LOGI(TAG, "↩️ Continuous turn left completed");
 }
 
@@ -1247,47 +1120,34 @@ void Otto::ContinuousTurnLeft(int speed_delay) {
 void Otto::ContinuousTurnRight(int speed_delay) {
     ESP_LOGI(TAG, "↪️ Starting continuous turn right");
     
+    // Turn right sequence (from PetDog - reversed from turn left)
+    MotionBuilder cycle = BeginClip();
+    AddGait(cycle, kContinuousTurnRight, speed_delay);
+    RunContinuous(cycle, 200, "turn_right_loop");
+    ESP_LOGI(TAG, "↪️ Continuous turn right completed");
+}
+
+//-- Stand up, settle for settle_ms, then loop the cycle clip until Stop()
+void Otto::RunContinuous(MotionBuilder& cycle, int settle_ms, const char* name) {
+    // Clear stop bit before starting
     xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-    
-    StandUp();
-    vTaskDelay(pdMS_TO_TICKS(200));
-    
-    while (true) {
-        if (IsActionStopped()) {
-            ESP_LOGI(TAG, "🛑 Continuous turn right stopped");
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
-        
-        // Turn right sequence (from PetDog - reversed from turn left)
-        ServoAngleSet(SERVO_RF, 130, speed_delay);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, speed_delay);
-        ServoAngleSet(SERVO_LB, 50, speed_delay);
-
-        ServoAngleSet(SERVO_RF, 130, speed_delay);
-        ServoAngleSet(SERVO_RB, 50, speed_delay);
-        ServoAngleSet(SERVO_LF, 130, speed_delay);
-        ServoAngleSet(SERVO_LB, 50, speed_delay);
-
-        if (IsActionStopped()) {
-            xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
-            break;
-        }
 
-        ServoAngleSet(SERVO_RF, 90, speed_delay);
-        ServoAngleSet(SERVO_RB, 50, speed_delay);
-        ServoAngleSet(SERVO_LF, 130, speed_delay);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
+    MotionBuilder prepare = BeginClip();
+    AddStandUp(prepare);
+    prepare.Wait(settle_ms);
 
-        ServoAngleSet(SERVO_RF, 90, speed_delay);
-        ServoAngleSet(SERVO_RB, 90, speed_delay);
-        ServoAngleSet(SERVO_LF, 90, speed_delay);
-        ServoAngleSet(SERVO_LB, 90, speed_delay);
+    // A looped clip only ends when cancelled; the stop bit tells Stop() apart
+    // from another routine taking over the servos
+    if (RunClip(prepare, "stand_up") && !IsActionStopped()) {
+        motion_.Run(cycle.Build(name, true));
     }
-    
+    if (!IsActionStopped()) {
+        return;  // Replaced by another routine, leave the servos to it
+    }
+    ESP_LOGI(TAG, "🛑 Continuous %s stopped", name);
+    xEventGroupClearBits(action_event_group_, STOP_ACTION_BIT);
+
     StandUp();
-    ESP_LOGI(TAG, "↪️ Continuous turn right completed");
 }
 
 ///////////////////////////////////////////////////////////////////
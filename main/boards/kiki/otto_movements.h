@@ -8,6 +8,8 @@
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "oscillator.h"
+#include "otto_motion.h"
+#include "otto_motion_engine.h"
 #include <functional>
 
 //-- Event bits for action control (from PetDog)
@@ -26,6 +28,9 @@
 
 // -- Servo delta limit default. degree / sec
 #define SERVO_LIMIT_DEFAULT 240
+// -- Planned moves (stand/sit/lie transitions): per-joint limits, degree / sec and degree / sec^2
+#define JOINT_SPEED_LIMIT_DEFAULT SERVO_LIMIT_DEFAULT
+#define JOINT_ACCEL_LIMIT_DEFAULT 2400
 
 // -- Dog-style servo indexes (5 servos - added tail)
 #define SERVO_LF 0  // Left Front leg
@@ -35,6 +40,10 @@
 #define SERVO_TAIL 4 // Tail servo
 #define SERVO_COUNT 5
 
+// -- Beat-synced choreography styles (DogBeatStep)
+#define BEAT_STYLE_DANCE 0
+#define BEAT_STYLE_SWING 1
+
 // Legacy compatibility (deprecated)
 #define LEFT_LEG SERVO_LF
 #define RIGHT_LEG SERVO_RF
@@ -91,6 +100,7 @@ public:
     void DogPushup(int pushups = 3, int speed_delay = 150);  // New: Pushup exercise
     void DogBalance(int duration_ms = 2000, int speed_delay = 150);  // New: Balance on hind legs
     void DogToilet(int hold_ms = 3000, int speed_delay = 150); // New: Toilet squat pose
+    void DogBeatStep(int style, int beat, int move_time);  // One dance/swing pose timed to a music beat
 
     //-- Continuous movement functions (from PetDog - run until Stop() is called)
     void ContinuousWalk(int speed_delay = 150);       // Walk forward continuously
@@ -105,6 +115,24 @@ public:
     void SetIdleCallback(std::function<void()> callback);  // Set callback when idle action triggers
     void TriggerRandomIdleAction();  // Perform random idle action
 
+    //-- Motion engine tuning: playback speed in percent (100 = as authored) and
+    //-- blend time used when a routine starts away from its first pose
+    void SetMotionSpeed(int percent);
+    int GetMotionSpeed();
+    void SetMotionBlend(int blend_ms);
+    bool IsMoving();
+
+    //-- Preemption for urgent commands: Interrupt() drops the playing clip, and every
+    //-- routine returns without moving until Resume(). Safe from any task.
+    void Interrupt();
+    void Resume();
+    bool IsInterrupted();
+
+    //-- Trajectory planner for pose transitions: profile shape and per-joint limits.
+    //-- Moves keep their authored time unless a joint would exceed its limits.
+    void SetMotionProfile(TrajectoryProfile profile);
+    void SetJointLimits(int servo_id, float max_speed, float max_accel);
+
     //-- Legacy movement functions (adapted to work with 4 servos)
     void Jump(float steps = 1, int period = 2000);
     void Walk(float steps = 4, int period = 1000, int dir = FORWARD);
@@ -123,16 +151,25 @@ private:
     int servo_compensate_[SERVO_COUNT];  // Compensation angles like DogMaster
     int servo_home_[4];  // Home angles for 4 leg servos: LF, RF, LB, RB
 
-    unsigned long final_time_;
-    unsigned long partial_time_;
-    float increment_[SERVO_COUNT];
-
     bool is_otto_resting_;
     int speed_delay_;  // Default speed delay for movements
 
+    //-- Routines are recorded as clips and played by the engine tick
+    MotionEngine motion_;
+    int motion_blend_ms_;
+    TrajectoryProfile motion_profile_;
+    JointLimits joint_limits_[SERVO_COUNT];
+    bool clip_stands_up_;  // Set by AddStandUp, the clip ends in rest pose
+
     // Helper functions for dog movements
-    void ExecuteDogMovement(int lf, int rf, int lb, int rb, int delay_time);
-    void MoveToPosition(int target_angles[SERVO_COUNT], int move_time);
+    MotionBuilder BeginClip();
+    bool RunClip(MotionBuilder& clip, const char* name);
+    void AddSmoothMove(MotionBuilder& clip, int lf, int rf, int lb, int rb);
+    void AddStandUp(MotionBuilder& clip);
+    void AddSitDown(MotionBuilder& clip, int delay_time);
+    void AddLieDown(MotionBuilder& clip);
+    void AddWagTail(MotionBuilder& clip, int wags, int speed_delay);
+    void RunContinuous(MotionBuilder& cycle, int settle_ms, const char* name);
     
     //-- Event group for action control (from PetDog)
     EventGroupHandle_t action_event_group_;
@@ -6,8 +6,11 @@
 #include <esp_log.h>
 #include <esp_netif.h>
 #include <esp_random.h>
+#include <esp_timer.h>
 #include <nvs_flash.h>
 #include <wifi_station.h>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <string>
 
@@ -29,6 +32,7 @@
 #include "wifi_board.h"
 #include "boards/common/esp32_music.h"
 #include "kiki_led_control.h"
+#include "otto_movements.h"
 
 #define TAG "OttoRobot"
 
@@ -89,8 +93,8 @@ private:
                     display_->SetEmotion("relaxed");
                 }
                 
-                // Go to home position immediately
-                otto_controller_queue_action(ACTION_HOME, 1, 500, 0, 0);
+                // Go to home position immediately, cutting short whatever is running
+                otto_controller_queue_action_ex(ACTION_HOME, 1, 500, 0, 0, OTTO_PRIORITY_URGENT);
                 
                 ESP_LOGI(TAG, "🔋 Robot in charging mode - holding home position");
             } else if (!is_charging && is_charging_mode_) {
@@ -209,9 +213,12 @@ private:
                      rotation_angle, swap_xy, mirror_x, mirror_y);
         }
 
+        LcdRenderConfig render_config = LcdRenderConfig::Default();
+        render_config.double_buffer = DISPLAY_RENDER_DOUBLE_BUFFER;
+        render_config.buffer_lines = DISPLAY_RENDER_BUFFER_LINES;
         display_ = new OttoEmojiDisplay(
             panel_io, panel, DISPLAY_WIDTH, DISPLAY_HEIGHT, DISPLAY_OFFSET_X, DISPLAY_OFFSET_Y,
-            DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y, DISPLAY_SWAP_XY);
+            DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y, DISPLAY_SWAP_XY, render_config);
         
         // Show happy emoji on boot (emoji mode is already loaded from NVS in constructor)
         if (display_) {
@@ -327,26 +334,27 @@ private:
             auto display = GetDisplay();
             if (display) display->SetEmotion(chosen_action.emoji);
             
-            // Queue random action (handle sequences specially)
+            // Queue random action (handle sequences specially). A touch reacts right away:
+            // the first move preempts whatever runs, the rest of a sequence goes ahead of older actions
             if (chosen_action.is_sequence) {
                 if (chosen_action.action_type == 100) {
                     // Greet sequence: home → wave → bow
                     ESP_LOGI(TAG, "👋 Executing Greet sequence");
-                    otto_controller_queue_action(ACTION_HOME, 1, 500, 0, 0);
-                    otto_controller_queue_action(ACTION_DOG_WAVE_RIGHT_FOOT, 3, 150, 0, 0);
-                    otto_controller_queue_action(ACTION_DOG_BOW, 2, 150, 0, 0);
+                    otto_controller_queue_action_ex(ACTION_HOME, 1, 500, 0, 0, OTTO_PRIORITY_URGENT);
+                    otto_controller_queue_action_ex(ACTION_DOG_WAVE_RIGHT_FOOT, 3, 150, 0, 0, OTTO_PRIORITY_HIGH);
+                    otto_controller_queue_action_ex(ACTION_DOG_BOW, 2, 150, 0, 0, OTTO_PRIORITY_HIGH);
                 } else if (chosen_action.action_type == 101) {
                     // Celebrate sequence: dance → wave → swing
                     ESP_LOGI(TAG, "🎉 Executing Celebrate sequence");
-                    otto_controller_queue_action(ACTION_DOG_DANCE, 2, 200, 0, 0);
-                    otto_controller_queue_action(ACTION_DOG_WAVE_RIGHT_FOOT, 5, 100, 0, 0);
-                    otto_controller_queue_action(ACTION_DOG_SWING, 3, 10, 0, 0);  // Changed from 150 to 10 for faster swing
+                    otto_controller_queue_action_ex(ACTION_DOG_DANCE, 2, 200, 0, 0, OTTO_PRIORITY_URGENT);
+                    otto_controller_queue_action_ex(ACTION_DOG_WAVE_RIGHT_FOOT, 5, 100, 0, 0, OTTO_PRIORITY_HIGH);
+                    otto_controller_queue_action_ex(ACTION_DOG_SWING, 3, 10, 0, 0, OTTO_PRIORITY_HIGH);  // Changed from 150 to 10 for faster swing
                 }
             } else {
                 // Simple single action
-                otto_controller_queue_action(chosen_action.action_type, 
-                                            chosen_action.param1, 
-                                            chosen_action.param2, 0, 0);
+                otto_controller_queue_action_ex(chosen_action.action_type, 
+                                                chosen_action.param1, 
+                                                chosen_action.param2, 0, 0, OTTO_PRIORITY_URGENT);
             }
         });
 #endif // TOUCH_TTP223_GPIO
@@ -602,9 +610,68 @@ extern "C" {
     // Music player helper functions for web UI
     static Esp32Music* s_music_player = nullptr;
     
+    // Beat-synced choreography: the tracker reports each beat ~250ms before it
+    // is heard, a one-shot timer then starts the step early enough for the
+    // pose to land on the beat. -1 = off, otherwise BEAT_STYLE_*
+    static std::atomic<int> s_beat_style{-1};
+    static esp_timer_handle_t s_beat_timer = nullptr;
+    static std::atomic<int> s_beat_index{0};
+    static std::atomic<int> s_beat_move_ms{0};
+    
+    static void otto_beat_timer_callback(void* arg) {
+        int style = s_beat_style.load();
+        if (style >= 0) {
+            otto_controller_queue_beat_step(style, s_beat_index.load(), s_beat_move_ms.load());
+        }
+    }
+    
+    static void otto_on_music_beat(const BeatTracker::BeatEvent& beat) {
+        if (s_beat_style.load() < 0 || s_beat_timer == nullptr) {
+            return;
+        }
+        // Servo moves take ~45% of the beat, bounded so fast songs still read as steps
+        int move_ms = std::clamp(beat.period_ms * 45 / 100, 80, 250);
+        int start_ms = std::max(0, beat.delay_ms - move_ms);
+        esp_timer_stop(s_beat_timer);
+        s_beat_index = (int)beat.index;
+        s_beat_move_ms = move_ms;
+        esp_timer_start_once(s_beat_timer, (uint64_t)start_ms * 1000 + 1);
+    }
+    
+    // "dance"/"swing" music poses follow the beat; other poses stay one-shot
+    static void otto_music_load_beat_style() {
+        int style = -1;
+        nvs_handle_t nvs_handle;
+        if (nvs_open("storage", NVS_READONLY, &nvs_handle) == ESP_OK) {
+            char pose[32] = "none";
+            size_t pose_len = sizeof(pose);
+            nvs_get_str(nvs_handle, "music_pose", pose, &pose_len);
+            nvs_close(nvs_handle);
+            if (strcmp(pose, "dance") == 0) style = BEAT_STYLE_DANCE;
+            else if (strcmp(pose, "swing") == 0) style = BEAT_STYLE_SWING;
+        }
+        s_beat_style = style;
+    }
+    
     void otto_set_music_player(void* player) {
         s_music_player = static_cast<Esp32Music*>(player);
         ESP_LOGI("OttoMusic", "🎵 Music player pointer set");
+        
+        if (s_music_player && s_beat_timer == nullptr) {
+            const esp_timer_create_args_t timer_args = {
+                .callback = otto_beat_timer_callback,
+                .arg = nullptr,
+                .dispatch_method = ESP_TIMER_TASK,
+                .name = "music_beat",
+                .skip_unhandled_events = true,
+            };
+            if (esp_timer_create(&timer_args, &s_beat_timer) == ESP_OK) {
+                s_music_player->SetBeatCallback(otto_on_music_beat);
+                otto_music_load_beat_style();
+            } else {
+                ESP_LOGW("OttoMusic", "⚠️ Beat timer unavailable, dancing stays unsynced");
+            }
+        }
     }
     
     bool otto_music_download_and_play(const std::string& song) {
@@ -619,6 +686,9 @@ extern "C" {
         s_music_player->StopStreaming(false);
         vTaskDelay(pdMS_TO_TICKS(100));
         
+        // Pick up a music pose changed from the web UI since the last song
+        otto_music_load_beat_style();
+        
         // Download and play the song
         bool result = s_music_player->Download(song, "");
         if (result) {
@@ -651,7 +721,7 @@ extern "C" {
                 }
                 
                 // Execute saved memory slot action
-                if (action_slot >= 1 && action_slot <= 3) {
+                if (action_slot >= 1 && action_slot <= ACTION_SLOT_COUNT) {
                     ESP_LOGI("OttoMusic", "🎭 Executing music action slot %d", action_slot);
                     otto_play_memory_slot(action_slot);
                 }
@@ -699,4 +769,24 @@ extern "C" {
         }
         return true;
     }
+    
+    bool otto_music_get_beat_stats(char* json, int json_len) {
+        if (!s_music_player || !json || json_len <= 0) {
+            return false;
+        }
+        std::string stats = s_music_player->GetBeatStatsJson();
+        strncpy(json, stats.c_str(), json_len - 1);
+        json[json_len - 1] = '\0';
+        return true;
+    }
+    
+    bool otto_music_get_buffer_stats(char* json, int json_len) {
+        if (!s_music_player || !json || json_len <= 0) {
+            return false;
+        }
+        std::string stats = s_music_player->GetBufferStatsJson();
+        strncpy(json, stats.c_str(), json_len - 1);
+        json[json_len - 1] = '\0';
+        return true;
+    }
 }
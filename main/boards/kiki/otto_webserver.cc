@@ -4,13 +4,31 @@
 #include "otto_emoji_display.h"
 #include "board.h"
 #include "settings.h"
+#include "music_cache.h"
 #include "assets/lang_config.h"
 #include "boards/kiki/config.h"  // For DISPLAY_MIRROR_X, DISPLAY_MIRROR_Y, DISPLAY_SWAP_XY
 #include "boards/kiki/kiki_led_control.h"  // For LED control
+#include "boards/kiki/mjpeg_streamer.h"
+#include "boards/kiki/lvgl_frame_source.h"
+#include "boards/kiki/draw_tile_decoder.h"
+#include "boards/kiki/web_ui_assets.h"
+#include "boards/kiki/otto_ws_control.h"
+#include "boards/kiki/otto_async_http.h"
+#include "boards/kiki/otto_action_program.h"
+#include "image_to_jpeg.h"
+#include "jpg/jpeg_thumbnail_cache.h"
 #include <cJSON.h>
 #include <stdio.h>
 #include <nvs_flash.h>
 #include <esp_heap_caps.h>  // For heap_caps_malloc
+#include <esp_timer.h>
+#include <freertos/queue.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 // TAG used by both C and C++ code
 static const char *TAG = "OttoWeb";
@@ -22,121 +40,138 @@ bool webserver_enabled = false;
 static httpd_handle_t server = NULL;
 static int s_retry_num = 0;
 
-// Action memory slots - 3 slots to save and replay action sequences
-struct ActionSlot {
-    char actions[512];  // Action sequence: "walk,3,150;sit,1,500;bow,1,200"
-    char emotion[32];   // Associated emotion/GIF name
-    bool used;          // Whether this slot has data
-};
-static ActionSlot memory_slots[3] = {
-    {"", "", false},
-    {"", "", false},
-    {"", "", false}
-};
+// Action memory slots - compiled action programs (otto_action_program.h), one NVS blob per slot.
+// Slot n (1..ACTION_SLOT_COUNT) lives in memory_slots[n-1]; empty vector = unused
+static std::vector<uint8_t> memory_slots[ACTION_SLOT_COUNT];
+static std::mutex memory_slots_mutex;
+
+// Copy a slot's program out under the lock (players run for seconds, the web task may save meanwhile)
+static bool get_memory_slot(int slot, std::vector<uint8_t>& code) {
+    if (slot < 1 || slot > ACTION_SLOT_COUNT) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(memory_slots_mutex);
+    code = memory_slots[slot - 1];
+    return !code.empty();
+}
+
+// Write only the changed slot: one blob instead of rewriting every slot
+static esp_err_t save_memory_slot_to_nvs(nvs_handle_t nvs_handle, int idx, const std::vector<uint8_t>& code) {
+    char key[16];
+    snprintf(key, sizeof(key), "prog%d", idx);
+    if (code.empty()) {
+        esp_err_t err = nvs_erase_key(nvs_handle, key);
+        return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+    }
+    return nvs_set_blob(nvs_handle, key, code.data(), code.size());
+}
 
-// NVS functions for persistent storage of memory slots
-static void save_memory_slots_to_nvs() {
+static esp_err_t save_memory_slot(int slot, std::vector<uint8_t>&& code) {
     nvs_handle_t nvs_handle;
     esp_err_t err = nvs_open("otto_slots", NVS_READWRITE, &nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS for memory slots: %s", esp_err_to_name(err));
-        return;
+        return err;
     }
-    
+    err = save_memory_slot_to_nvs(nvs_handle, slot - 1, code);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save slot %d: %s", slot, esp_err_to_name(err));
+        return err;
+    }
+
+    std::lock_guard<std::mutex> lock(memory_slots_mutex);
+    memory_slots[slot - 1] = std::move(code);
+    ESP_LOGI(TAG, "💾 Saved slot %d to NVS (%u bytes)", slot, (unsigned)memory_slots[slot - 1].size());
+    return ESP_OK;
+}
+
+// Firmware before the bytecode stored 3 text slots (slot%d_act/_emo/_used): compile them once
+// (unknown steps are dropped), store the blob and erase the old keys
+static void migrate_legacy_memory_slots(nvs_handle_t nvs_handle) {
+    bool changed = false;
     for (int i = 0; i < 3; i++) {
         char key_actions[16], key_emotion[16], key_used[16];
         snprintf(key_actions, sizeof(key_actions), "slot%d_act", i);
         snprintf(key_emotion, sizeof(key_emotion), "slot%d_emo", i);
         snprintf(key_used, sizeof(key_used), "slot%d_used", i);
-        
-        nvs_set_str(nvs_handle, key_actions, memory_slots[i].actions);
-        nvs_set_str(nvs_handle, key_emotion, memory_slots[i].emotion);
-        nvs_set_u8(nvs_handle, key_used, memory_slots[i].used ? 1 : 0);
+
+        char actions[512] = {0};
+        char emotion[32] = {0};
+        size_t len_actions = sizeof(actions);
+        size_t len_emotion = sizeof(emotion);
+        uint8_t used = 0;
+        if (nvs_get_str(nvs_handle, key_actions, actions, &len_actions) != ESP_OK) {
+            continue;
+        }
+        nvs_get_str(nvs_handle, key_emotion, emotion, &len_emotion);
+        nvs_get_u8(nvs_handle, key_used, &used);
+
+        if (used == 1 && memory_slots[i].empty()) {
+            std::vector<uint8_t> code;
+            std::string error;
+            if (ActionProgramCompile(actions, emotion, false, code, &error) &&
+                save_memory_slot_to_nvs(nvs_handle, i, code) == ESP_OK) {
+                ESP_LOGI(TAG, "📂 Migrated slot %d: %u chars -> %u bytes", i + 1,
+                         (unsigned)strlen(actions), (unsigned)code.size());
+                memory_slots[i] = std::move(code);
+            } else {
+                ESP_LOGW(TAG, "⚠️ Slot %d could not be migrated: %s", i + 1, error.c_str());
+            }
+        }
+        nvs_erase_key(nvs_handle, key_actions);
+        nvs_erase_key(nvs_handle, key_emotion);
+        nvs_erase_key(nvs_handle, key_used);
+        changed = true;
+    }
+    if (changed) {
+        nvs_commit(nvs_handle);
     }
-    
-    nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
-    ESP_LOGI(TAG, "💾 Saved memory slots to NVS");
 }
 
 static void load_memory_slots_from_nvs() {
     nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("otto_slots", NVS_READONLY, &nvs_handle);
+    esp_err_t err = nvs_open("otto_slots", NVS_READWRITE, &nvs_handle);
     if (err != ESP_OK) {
         ESP_LOGI(TAG, "No saved memory slots in NVS (first boot?)");
         return;
     }
-    
-    for (int i = 0; i < 3; i++) {
-        char key_actions[16], key_emotion[16], key_used[16];
-        snprintf(key_actions, sizeof(key_actions), "slot%d_act", i);
-        snprintf(key_emotion, sizeof(key_emotion), "slot%d_emo", i);
-        snprintf(key_used, sizeof(key_used), "slot%d_used", i);
-        
-        size_t len_actions = sizeof(memory_slots[i].actions);
-        size_t len_emotion = sizeof(memory_slots[i].emotion);
-        uint8_t used = 0;
-        
-        if (nvs_get_str(nvs_handle, key_actions, memory_slots[i].actions, &len_actions) == ESP_OK &&
-            nvs_get_str(nvs_handle, key_emotion, memory_slots[i].emotion, &len_emotion) == ESP_OK &&
-            nvs_get_u8(nvs_handle, key_used, &used) == ESP_OK) {
-            memory_slots[i].used = (used == 1);
-            ESP_LOGI(TAG, "📂 Loaded slot %d from NVS: %s", i+1, memory_slots[i].used ? "has data" : "empty");
+
+    std::lock_guard<std::mutex> lock(memory_slots_mutex);
+    int loaded = 0;
+    size_t total_bytes = 0;
+    for (int i = 0; i < ACTION_SLOT_COUNT; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "prog%d", i);
+        size_t size = 0;
+        if (nvs_get_blob(nvs_handle, key, nullptr, &size) != ESP_OK || size == 0) {
+            continue;
         }
+        std::vector<uint8_t> code(size);
+        if (nvs_get_blob(nvs_handle, key, code.data(), &size) != ESP_OK ||
+            !ActionProgramInspect(code.data(), size, nullptr)) {
+            ESP_LOGW(TAG, "⚠️ Slot %d blob is invalid, ignored", i + 1);
+            continue;
+        }
+        memory_slots[i] = std::move(code);
+        loaded++;
+        total_bytes += size;
     }
-    
+    migrate_legacy_memory_slots(nvs_handle);
     nvs_close(nvs_handle);
+    ESP_LOGI(TAG, "📂 Loaded %d memory slots from NVS (%u bytes)", loaded, (unsigned)total_bytes);
 }
 
-// Static buffer pool cho draw handler - tránh heap fragmentation
-// Buffer được allocate khi cần, không phải static để tiết kiệm RAM
-static struct {
-    uint8_t* buffer;  // Allocate on first use (PSRAM if available)
-    bool in_use;
-    bool initialized;
-    SemaphoreHandle_t mutex;
-} draw_buffer_pool = {
-    .buffer = NULL,
-    .in_use = false,
-    .initialized = false,
-    .mutex = NULL
+struct SlotPlayOptions {
+    bool action_emoji;  // Show each step's emoji (the alarm keeps the slot emotion only)
+    int gap_ms;         // Pause after each action, none after stop
+    int max_actions;    // Emoji steps are not counted
 };
-
-// Initialize draw buffer on first use (lazy allocation to save RAM at startup)
-static bool init_draw_buffer() {
-    if (draw_buffer_pool.initialized) return true;
-    if (draw_buffer_pool.mutex == NULL) {
-        draw_buffer_pool.mutex = xSemaphoreCreateMutex();
-    }
-    // Allocate in PSRAM if available, otherwise internal
-    draw_buffer_pool.buffer = (uint8_t*)heap_caps_malloc(120000, MALLOC_CAP_SPIRAM);
-    if (!draw_buffer_pool.buffer) {
-        draw_buffer_pool.buffer = (uint8_t*)heap_caps_malloc(120000, MALLOC_CAP_INTERNAL);
-    }
-    if (draw_buffer_pool.buffer) {
-        draw_buffer_pool.initialized = true;
-        ESP_LOGI(TAG, "🎨 Draw buffer allocated: 120KB");
-        return true;
-    }
-    ESP_LOGE(TAG, "❌ Failed to allocate draw buffer");
-    return false;
-}
-
-// Cleanup draw buffer when webserver stops
-static void cleanup_draw_buffer() {
-    if (draw_buffer_pool.mutex) {
-        xSemaphoreTake(draw_buffer_pool.mutex, portMAX_DELAY);
-    }
-    if (draw_buffer_pool.buffer) {
-        free(draw_buffer_pool.buffer);
-        draw_buffer_pool.buffer = NULL;
-        draw_buffer_pool.initialized = false;
-        ESP_LOGI(TAG, "🧹 Draw buffer freed: 120KB");
-    }
-    if (draw_buffer_pool.mutex) {
-        xSemaphoreGive(draw_buffer_pool.mutex);
-    }
-}
+static int run_memory_slot(int slot, const std::vector<uint8_t>& code, const SlotPlayOptions& options,
+                           int64_t* dispatch_us);
 
 // Auto pose change variables
 static bool auto_pose_enabled = false;
@@ -165,7 +200,7 @@ static char scheduled_message[512] = "";  // Tin nhắn đã hẹn giờ
 static uint32_t schedule_remaining_seconds = 0;  // Số giây còn lại
 static int64_t schedule_target_timestamp = 0;  // Unix timestamp khi đến giờ gửi
 static char schedule_mode[16] = "alarm";  // "alarm" hoặc "message"
-static int scheduled_action_slot = 0;  // 0=none, 1-3=memory slot to play when triggered
+static int scheduled_action_slot = 0;  // 0=none, 1-ACTION_SLOT_COUNT=memory slot to play when triggered
 static TaskHandle_t alarm_task_handle = NULL;  // Prevent multiple alarm tasks
 
 // Power save idle timeout (configurable from web UI)
@@ -423,9 +458,7 @@ void schedule_countdown_callback(TimerHandle_t xTimer) {
             char msg[256];  // Reduced size - 256 chars should be enough
             bool is_alarm_mode;
             int action_slot;  // Memory slot to play
-            char slot_actions[512];  // Copy actions here to avoid accessing memory_slots from task
-            char slot_emotion[32];
-            bool slot_valid;
+            std::vector<uint8_t> slot_code;  // Copy of the slot program, empty if none
         };
         AlarmTaskParams* params = new AlarmTaskParams();
         strncpy(params->msg, scheduled_message, sizeof(params->msg) - 1);
@@ -433,21 +466,8 @@ void schedule_countdown_callback(TimerHandle_t xTimer) {
         params->is_alarm_mode = is_alarm_mode;
         params->action_slot = scheduled_action_slot;
         
-        // Copy slot data to params if slot is selected (avoid accessing memory_slots from task)
-        if (scheduled_action_slot >= 1 && scheduled_action_slot <= 3) {
-            int idx = scheduled_action_slot - 1;
-            if (memory_slots[idx].used && strlen(memory_slots[idx].actions) > 0) {
-                strncpy(params->slot_actions, memory_slots[idx].actions, sizeof(params->slot_actions) - 1);
-                params->slot_actions[sizeof(params->slot_actions) - 1] = '\0';
-                strncpy(params->slot_emotion, memory_slots[idx].emotion, sizeof(params->slot_emotion) - 1);
-                params->slot_emotion[sizeof(params->slot_emotion) - 1] = '\0';
-                params->slot_valid = true;
-            } else {
-                params->slot_valid = false;
-            }
-        } else {
-            params->slot_valid = false;
-        }
+        // Copy the slot program to params (avoid accessing memory_slots from task)
+        get_memory_slot(scheduled_action_slot, params->slot_code);
         
         // Create alarm task with larger stack to prevent overflow
         BaseType_t task_result = xTaskCreate([](void* param) {
@@ -490,58 +510,14 @@ void schedule_countdown_callback(TimerHandle_t xTimer) {
             }
             
             // Play action from memory slot if selected and valid
-            if (p->action_slot >= 1 && p->action_slot <= 3 && p->slot_valid) {
+            if (!p->slot_code.empty()) {
                 ESP_LOGI(TAG, "🎭 Playing action from slot %d", p->action_slot);
                 
-                // Use simple parsing without large stack buffers - work directly on params
-                char* actions_ptr = p->slot_actions;
-                char* saveptr = NULL;
-                char* token = strtok_r(actions_ptr, ";", &saveptr);
-                int action_count = 0;
-                
-                while (token != NULL && action_count < 20) {  // Limit max actions
-                    char action[32] = {0};
-                    char emoji[24] = {0};
-                    int p1 = 0, p2 = 0;
-                    
-                    // Parse token - simplified
-                    if (sscanf(token, "%31[^,],%d,%d,%23s", action, &p1, &p2, emoji) < 3) {
-                        sscanf(token, "%31[^,],%d,%d", action, &p1, &p2);
-                    }
-                    
-                    if (strlen(action) > 0) {
-                        // Skip emoji-only actions
-                        if (strcmp(action, "emoji") != 0) {
-                            // Apply speed multiplier
-                            int adjusted_speed = p2;
-                            if (p2 > 0) {
-                                adjusted_speed = (p2 * speed_multiplier) / 100;
-                                if (adjusted_speed < 10) adjusted_speed = 10;
-                            }
-                            
-                            ESP_LOGI(TAG, "▶️ Action: %s (p1:%d, p2:%d)", action, p1, adjusted_speed);
-                            otto_execute_web_action(action, p1, adjusted_speed);
-                            action_count++;
-                            
-                            // Delay between actions
-                            vTaskDelay(pdMS_TO_TICKS(150));
-                        } else if (strlen(emoji) > 0) {
-                            // Set emoji via Schedule to avoid direct display access
-                            std::string emo_str(emoji);
-                            Application::GetInstance().Schedule([emo_str]() {
-                                auto display = Board::GetInstance().GetDisplay();
-                                if (display) {
-                                    display->SetEmotion(emo_str.c_str());
-                                }
-                            });
-                            vTaskDelay(pdMS_TO_TICKS(50));
-                        }
-                    }
-                    
-                    token = strtok_r(NULL, ";", &saveptr);
-                }
+                // Limit max actions; only explicit emoji steps change the face
+                SlotPlayOptions options = {false, 150, 20};
+                int action_count = run_memory_slot(p->action_slot, p->slot_code, options, nullptr);
                 
-                ESP_LOGI(TAG, "✅ Completed %d actions from slot %d", action_count, p->action_slot);
+                ESP_LOGI(TAG, "✅ Completed %d steps from slot %d", action_count, p->action_slot);
             }
             
             // Cleanup and exit
@@ -564,15 +540,9 @@ void schedule_countdown_callback(TimerHandle_t xTimer) {
 
 // Load speed multiplier from NVS
 void load_speed_from_nvs() {
-    nvs_handle_t nvs_handle;
-    if (nvs_open("storage", NVS_READONLY, &nvs_handle) == ESP_OK) {
-        int32_t speed = 100;
-        if (nvs_get_i32(nvs_handle, "speed_mult", &speed) == ESP_OK) {
-            speed_multiplier = (int)speed;
-            ESP_LOGI(TAG, "📐 Loaded speed multiplier from NVS: %d%%", speed_multiplier);
-        }
-        nvs_close(nvs_handle);
-    }
+    Settings settings("storage", false);
+    speed_multiplier = settings.GetInt("speed_mult", speed_multiplier);
+    ESP_LOGI(TAG, "📐 Loaded speed multiplier from NVS: %d%%", speed_multiplier);
 }
 
 // Timer callback for auto pose change
@@ -785,1778 +755,26 @@ esp_err_t otto_wifi_init_sta(void) {
     return ESP_OK;
 }
 
-// Send main control page HTML
-void send_otto_control_page(httpd_req_t *req) {
-    httpd_resp_set_type(req, "text/html");
-    
-    // Modern responsive HTML with Otto Robot theme
-    httpd_resp_sendstr_chunk(req, "<!DOCTYPE html><html><head><meta charset='UTF-8'>");
-    httpd_resp_sendstr_chunk(req, "<meta name='viewport' content='width=device-width, initial-scale=1.0, user-scalable=no'>");
-    httpd_resp_sendstr_chunk(req, "<title>Kiki Control - miniZ</title>");
-    
-    // CSS Styling - Optimized for Mobile
-    httpd_resp_sendstr_chunk(req, "<style>");
-    httpd_resp_sendstr_chunk(req, "* { margin: 0; padding: 0; box-sizing: border-box; -webkit-tap-highlight-color: transparent; }");
-    httpd_resp_sendstr_chunk(req, "body { font-family: 'Segoe UI', 'Roboto', sans-serif; background: linear-gradient(135deg, #f8f8f8 0%, #ffffff 100%); min-height: 100vh; display: flex; justify-content: center; align-items: flex-start; color: #000000; padding: 8px; padding-top: 10px; }");
-    httpd_resp_sendstr_chunk(req, ".container { max-width: 600px; width: 100%; background: #ffffff; border-radius: 15px; padding: 15px; box-shadow: 0 4px 15px rgba(0,0,0,0.1); border: 2px solid #000000; } @media (min-width: 768px) { .container { max-width: 800px; padding: 25px; } }");
-    httpd_resp_sendstr_chunk(req, ".header { text-align: center; margin-bottom: 15px; }");
-    httpd_resp_sendstr_chunk(req, ".header h1 { font-size: 1.5em; margin-bottom: 5px; color: #000000; font-weight: bold; } @media (min-width: 768px) { .header h1 { font-size: 2.2em; } }");
-    httpd_resp_sendstr_chunk(req, ".status { background: #f0f0f0; color: #000; padding: 10px; border-radius: 10px; margin-bottom: 15px; text-align: center; border: 2px solid #000000; font-weight: bold; font-size: 0.9em; }");
-    
-    // Compact button styling for mobile
-    httpd_resp_sendstr_chunk(req, ".control-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(100px, 1fr)); gap: 8px; margin-bottom: 15px; } @media (min-width: 768px) { .control-grid { grid-template-columns: repeat(auto-fit, minmax(130px, 1fr)); gap: 12px; } }");
-    httpd_resp_sendstr_chunk(req, ".btn { background: #ffffff; border: 2px solid #000000; color: #000000; padding: 10px 12px; border-radius: 10px; cursor: pointer; font-size: 13px; font-weight: bold; transition: all 0.15s; box-shadow: 0 2px 5px rgba(0,0,0,0.15); touch-action: manipulation; user-select: none; } @media (min-width: 768px) { .btn { padding: 14px 18px; font-size: 15px; } }");
-    httpd_resp_sendstr_chunk(req, ".btn:active { transform: scale(0.95); box-shadow: 0 1px 3px rgba(0,0,0,0.2); background: #f0f0f0; }");
-    httpd_resp_sendstr_chunk(req, ".paw-btn { font-size: 18px; }");
-    
-    // Compact sections for mobile
-    httpd_resp_sendstr_chunk(req, ".movement-section { margin-bottom: 15px; }");
-    httpd_resp_sendstr_chunk(req, ".section-title { font-size: 1.1em; margin-bottom: 10px; text-align: center; color: #000000; font-weight: bold; } @media (min-width: 768px) { .section-title { font-size: 1.4em; } }");
-    httpd_resp_sendstr_chunk(req, ".direction-pad { display: grid; grid-template-columns: 1fr 1fr 1fr; grid-template-rows: 1fr 1fr 1fr; gap: 8px; max-width: 250px; margin: 0 auto; } @media (min-width: 768px) { .direction-pad { gap: 12px; max-width: 300px; } }");
-    httpd_resp_sendstr_chunk(req, ".direction-pad .btn { padding: 15px; font-size: 14px; font-weight: 700; min-height: 50px; } @media (min-width: 768px) { .direction-pad .btn { padding: 20px; font-size: 16px; } }");
-    httpd_resp_sendstr_chunk(req, ".btn-forward { grid-column: 2; grid-row: 1; }");
-    httpd_resp_sendstr_chunk(req, ".btn-left { grid-column: 1; grid-row: 2; }");
-    httpd_resp_sendstr_chunk(req, ".btn-stop { grid-column: 2; grid-row: 2; background: #ffeeee; border-color: #cc0000; color: #cc0000; }");
-    httpd_resp_sendstr_chunk(req, ".btn-right { grid-column: 3; grid-row: 2; }");
-    httpd_resp_sendstr_chunk(req, ".btn-backward { grid-column: 2; grid-row: 3; }");
-    // Auto pose toggle styling
-    httpd_resp_sendstr_chunk(req, ".auto-toggle { background: #e8f5e9; border: 2px solid #4caf50; padding: 12px; border-radius: 10px; margin: 15px 0; text-align: center; }");
-    httpd_resp_sendstr_chunk(req, ".toggle-btn { background: #ffffff; border: 2px solid #000; padding: 10px 20px; border-radius: 8px; font-weight: bold; font-size: 14px; cursor: pointer; }");
-    httpd_resp_sendstr_chunk(req, ".toggle-btn.active { background: #4caf50; color: white; border-color: #2e7d32; }");
-    // Page navigation styling
-    httpd_resp_sendstr_chunk(req, ".page { display: none; }");
-    httpd_resp_sendstr_chunk(req, ".page.active { display: block; }");
-    httpd_resp_sendstr_chunk(req, ".nav-tabs { display: flex; gap: 10px; margin-bottom: 20px; }");
-    httpd_resp_sendstr_chunk(req, ".nav-tab { flex: 1; background: #f0f0f0; border: 2px solid #000; padding: 12px; border-radius: 10px; text-align: center; font-weight: bold; cursor: pointer; transition: all 0.2s; }");
-    httpd_resp_sendstr_chunk(req, ".nav-tab.active { background: #4caf50; color: white; border-color: #2e7d32; }");
-    // Auto pose config styling - 3 columns for mobile
-    httpd_resp_sendstr_chunk(req, ".pose-config { background: #f8f8f8; border: 2px solid #000; border-radius: 10px; padding: 12px; margin: 10px 0; }");
-    httpd_resp_sendstr_chunk(req, ".pose-grid { display: grid; grid-template-columns: repeat(3, 1fr); gap: 6px; }");
-    httpd_resp_sendstr_chunk(req, ".pose-item { display: flex; align-items: center; gap: 4px; padding: 6px; background: white; border-radius: 6px; border: 1px solid #ddd; font-size: 12px; }");
-    httpd_resp_sendstr_chunk(req, ".pose-item input[type='checkbox'] { width: 16px; height: 16px; cursor: pointer; flex-shrink: 0; }");
-    httpd_resp_sendstr_chunk(req, ".pose-item label { cursor: pointer; font-weight: 500; font-size: 11px; line-height: 1.2; }");
-    httpd_resp_sendstr_chunk(req, ".time-input { width: 70px; padding: 5px; border: 2px solid #000; border-radius: 5px; font-weight: bold; text-align: center; }");
-    
-    // Compact fun actions grid
-    httpd_resp_sendstr_chunk(req, ".fun-actions { margin-top: 15px; }");
-    httpd_resp_sendstr_chunk(req, ".action-grid { display: grid; grid-template-columns: repeat(3, 1fr); gap: 8px; } @media (min-width: 768px) { .action-grid { grid-template-columns: repeat(4, 1fr); gap: 10px; } }");
-    
-    // Compact emoji sections
-    httpd_resp_sendstr_chunk(req, ".emoji-section, .emoji-mode-section { margin-top: 15px; }");
-    httpd_resp_sendstr_chunk(req, ".emoji-grid { display: grid; grid-template-columns: repeat(4, 1fr); gap: 8px; }");
-    httpd_resp_sendstr_chunk(req, ".mode-grid { display: grid; grid-template-columns: repeat(auto-fit, minmax(150px, 1fr)); gap: 10px; margin-bottom: 12px; }");
-    httpd_resp_sendstr_chunk(req, ".emoji-btn { background: #fff8e1; border: 2px solid #ff6f00; color: #e65100; padding: 10px; font-size: 13px; }");
-    httpd_resp_sendstr_chunk(req, ".emoji-btn:hover { background: #ffecb3; border-color: #e65100; }");
-    httpd_resp_sendstr_chunk(req, ".mode-btn { background: #e8f5e8; border: 2px solid #4caf50; color: #2e7d32; padding: 12px 16px; }");
-    httpd_resp_sendstr_chunk(req, ".mode-btn:hover { background: #c8e6c9; }");
-    httpd_resp_sendstr_chunk(req, ".mode-btn.active { background: #4caf50; color: white; }");
-    
-    // Compact response area
-    httpd_resp_sendstr_chunk(req, ".response { margin-top: 15px; padding: 15px; background: #f8f8f8; border-radius: 12px; min-height: 60px; box-shadow: inset 2px 2px 4px rgba(0,0,0,0.1); border: 2px solid #000; font-family: 'Courier New', monospace; font-size: 13px; }");
-    
-    // Volume control styling
-    httpd_resp_sendstr_chunk(req, ".volume-section { margin-top: 25px; }");
-    httpd_resp_sendstr_chunk(req, "input[type='range'] { -webkit-appearance: none; width: 100%; height: 10px; border-radius: 5px; background: linear-gradient(145deg, #e0e0e0, #f0f0f0); outline: none; border: 1px solid #000; }");
-    httpd_resp_sendstr_chunk(req, "input[type='range']::-webkit-slider-thumb { -webkit-appearance: none; appearance: none; width: 24px; height: 24px; border-radius: 50%; background: linear-gradient(145deg, #ffffff, #f0f0f0); border: 2px solid #000; cursor: pointer; box-shadow: 2px 2px 4px rgba(0,0,0,0.2); }");
-    httpd_resp_sendstr_chunk(req, "input[type='range']::-moz-range-thumb { width: 24px; height: 24px; border-radius: 50%; background: linear-gradient(145deg, #ffffff, #f0f0f0); border: 2px solid #000; cursor: pointer; }");
-    
-    httpd_resp_sendstr_chunk(req, "</style>");
-    
-    httpd_resp_sendstr_chunk(req, "</head><body>");
-    
-    // HTML Content
-    httpd_resp_sendstr_chunk(req, "<div class='container'>");
-    httpd_resp_sendstr_chunk(req, "<div class='header'>");
-    httpd_resp_sendstr_chunk(req, "<h1 style='margin: 0 0 10px 0;'>🐕 Kiki Control</h1>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size: 0.9em; color: #666; font-style: italic; margin-bottom: 15px;'>by miniZ</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='status' id='status'>🟢 Sẵn Sàng Điều Khiển</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Navigation Tabs
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tabs'>");
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tab active' onclick='showPage(1)' id='tab1'>🎮 Điều Khiển</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tab' onclick='showPage(2)' id='tab2'>😊 Cảm Xúc</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tab' onclick='window.location.href=\"/music\"' id='tabMusic'>🎵 Nhạc</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tab' onclick='showPage(4)' id='tab4'>🎨 Vẽ</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='nav-tab' onclick='window.location.href=\"/servo_calibration\"' id='tab3'>⚙️</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Page 1: Main Controls
-    httpd_resp_sendstr_chunk(req, "<div class='page active' id='page1'>");
-    
-    // Movement Controls
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🎮 Điều Khiển Di Chuyển</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='direction-pad'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn btn-forward paw-btn' onclick='sendAction(\"dog_walk\", 3, 150)'>🐾 Tiến</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn btn-left paw-btn' onclick='sendAction(\"dog_turn_left\", 2, 150)'>🐾 Trái</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn btn-stop' onclick='sendAction(\"dog_stop\", 0, 0)'>🛑 DỪNG</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn btn-right paw-btn' onclick='sendAction(\"dog_turn_right\", 2, 150)'>🐾 Phải</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn btn-backward paw-btn' onclick='sendAction(\"dog_walk_back\", 3, 150)'>🐾 Lùi</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Auto Pose Toggle Section
-    httpd_resp_sendstr_chunk(req, "<div class='auto-pose-section' style='margin-top: 15px; text-align: center;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn toggle-btn' id='autoPoseBtn' onclick='toggleAutoPose()'>🔄 Tự Đổi Tư Thế (1 phút)</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Volume Control Section (moved to Page 1 for mobile)
-    httpd_resp_sendstr_chunk(req, "<div class='volume-section' style='margin-top: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🔊 Âm Lượng</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #f8f8f8, #ffffff); border: 2px solid #000000; border-radius: 12px; padding: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold; color: #000;'>🔈</span>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' id='volumeSlider' min='0' max='100' value='50' style='flex: 1; height: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<span id='volumeValue' style='font-weight: bold; color: #000; min-width: 40px;'>50%</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Fun Actions
-    httpd_resp_sendstr_chunk(req, "<div class='fun-actions'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🎪 Hành Động Vui</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='action-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_dance\", 3, 200)'>💃 Nhảy Múa</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_jump\", 1, 200)'>🦘 Nhảy Cao</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_bow\", 1, 2000)'>🙇 Cúi Chào</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_sit_down\", 1, 500)'>🪑 Ngồi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_lie_down\", 1, 4500)'>🛏️ Nằm</button>");
-    // New Defend and Scratch buttons  
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_defend\", 1, 500)'>� Giả Chết</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn paw-btn' onclick='sendAction(\"dog_scratch\", 5, 50)'>🐾 Gãi Ngứa</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_wave_right_foot\", 5, 50)'>👋 Vẫy Tay</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_wag_tail\", 5, 100)'>🐕 Vẫy Đuôi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_swing\", 5, 10)'>🎯 Lắc Lư</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_stretch\", 2, 15)'>🧘 Thư Giản</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_home\", 1, 4500)'>🏠 Về Nhà</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_dance_4_feet\", 3, 200)'>🕺 Nhảy 4 Chân</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_greet\", 1, 500)'>👋 Chào Hỏi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_attack\", 1, 500)'>⚔️ Tấn Công</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_celebrate\", 1, 500)'>🎉 Ăn Mừng</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_search\", 1, 500)'>🔍 Tìm Kiếm</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"show_clock\", 10, 0)' style='background: linear-gradient(145deg, #2196f3, #42a5f5); color: white; border-color: #1976d2;'>⏰ Đồng Hồ</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // New Poses Section (reduced - removed tools with >32 limit)
-    httpd_resp_sendstr_chunk(req, "<div class='fun-actions'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🎭 Tư Thế Mới</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='action-grid'>");
-    // Comment out removed tools: shake_paw, sidestep (đã xóa để giảm xuống <32 tools)
-    // httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_shake_paw\", 3, 150)'>🤝 Bắt Tay</button>");
-    // httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_sidestep_right\", 3, 80)'>➡️ Đi Ngang Phải</button>");
-    // httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_sidestep_left\", 3, 80)'>⬅️ Đi Ngang Trái</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_pushup\", 3, 150)'>💪 Chống Đẩy</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_balance\", 2000, 150)'>🚽 Đi Vệ Sinh</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // New Special Actions section (HIDDEN)
-    httpd_resp_sendstr_chunk(req, "<div class='fun-actions' style='display:none;'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🎪 Hành Động Đặc Biệt</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='action-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_roll_over\", 1, 200)'>🔄 Lăn Qua Lăn Lại</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendAction(\"dog_play_dead\", 5, 0)'>💀 Giả Chết</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // ALL EMOJI Section on Page 1 - Match server emoji list
-    httpd_resp_sendstr_chunk(req, "<div class='emoji-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>😊 TẤT CẢ EMOJI</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='emoji-grid'>");
-    // Row 1: Neutral, Happy, Laughing, Funny, Sad, Angry, Crying
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"neutral\")'>😐 Neutral</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"happy\")'>🤗 Happy</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"laughing\")'>🤣 Laughing</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"funny\")'>🥳 Funny</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"sad\")'>😔 Sad</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"angry\")'>😠 Angry</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"crying\")'>😭 Crying</button>");
-    // Row 2: Loving, Embarrassed, Surprised, Shocked, Thinking, Winking, Cool
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"loving\")'>😍 Loving</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"embarrassed\")'>😳 Embarrassed</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"surprised\")'>😲 Surprised</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"shocked\")'>🤯 Shocked</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"thinking\")'>🤔 Thinking</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"winking\")'>😉 Winking</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"cool\")'>😎 Cool</button>");
-    // Row 3: Relaxed, Delicious, Kiss, Confident, Sleepy, Silly, Confused
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"relaxed\")'>😌 Relaxed</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"delicious\")'>🤤 Delicious</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"kiss\")'>😘 Kiss</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"confident\")'>🤨 Confident</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"sleepy\")'>😴 Sleepy</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"silly\")'>🤪 Silly</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn emoji-btn' onclick='sendEmotion(\"confused\")'>😕 Confused</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Action Memory Slots Section
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section' style='margin-top: 20px;'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>💾 Lưu Và Phát Lại Hành Động</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #fff3e0, #ffffff); border: 2px solid #ff9800; border-radius: 15px; padding: 15px;'>");
-    
-    // Slot 1
-    httpd_resp_sendstr_chunk(req, "<div style='background: #fff; border: 2px solid #4caf50; border-radius: 10px; padding: 12px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; justify-content: space-between; align-items: center; gap: 10px; margin-bottom: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; color: #2e7d32;'>📍 Vị trí 1</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot1-status' style='font-size: 11px; color: #666;'>⚪ Chưa ghi</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 6px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='record1-btn' onclick='startRecording(1)' style='background: linear-gradient(145deg, #ff5722, #ff7043); color: white; border-color: #d84315; font-size: 12px; padding: 8px 12px;'>🔴 Bắt đầu ghi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='save1-btn' onclick='saveSlot(1)' disabled style='background: #e0e0e0; color: #999; font-size: 12px; padding: 8px 12px; cursor: not-allowed;'>💾 Lưu</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='playSlot(1)' style='background: linear-gradient(145deg, #2196f3, #42a5f5); color: white; border-color: #1565c0; font-size: 12px; padding: 8px 12px;'>▶️ Phát</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot1-info' style='margin-top: 8px; font-size: 11px; color: #666;'>📦 Chưa có dữ liệu</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Slot 2
-    httpd_resp_sendstr_chunk(req, "<div style='background: #fff; border: 2px solid #2196f3; border-radius: 10px; padding: 12px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; justify-content: space-between; align-items: center; gap: 10px; margin-bottom: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; color: #1565c0;'>📍 Vị trí 2</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot2-status' style='font-size: 11px; color: #666;'>⚪ Chưa ghi</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 6px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='record2-btn' onclick='startRecording(2)' style='background: linear-gradient(145deg, #ff5722, #ff7043); color: white; border-color: #d84315; font-size: 12px; padding: 8px 12px;'>🔴 Bắt đầu ghi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='save2-btn' onclick='saveSlot(2)' disabled style='background: #e0e0e0; color: #999; font-size: 12px; padding: 8px 12px; cursor: not-allowed;'>💾 Lưu</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='playSlot(2)' style='background: linear-gradient(145deg, #2196f3, #42a5f5); color: white; border-color: #1565c0; font-size: 12px; padding: 8px 12px;'>▶️ Phát</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot2-info' style='margin-top: 8px; font-size: 11px; color: #666;'>📦 Chưa có dữ liệu</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Slot 3
-    httpd_resp_sendstr_chunk(req, "<div style='background: #fff; border: 2px solid #9c27b0; border-radius: 10px; padding: 12px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; justify-content: space-between; align-items: center; gap: 10px; margin-bottom: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; color: #6a1b9a;'>📍 Vị trí 3</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot3-status' style='font-size: 11px; color: #666;'>⚪ Chưa ghi</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 6px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='record3-btn' onclick='startRecording(3)' style='background: linear-gradient(145deg, #ff5722, #ff7043); color: white; border-color: #d84315; font-size: 12px; padding: 8px 12px;'>🔴 Bắt đầu ghi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' id='save3-btn' onclick='saveSlot(3)' disabled style='background: #e0e0e0; color: #999; font-size: 12px; padding: 8px 12px; cursor: not-allowed;'>💾 Lưu</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='playSlot(3)' style='background: linear-gradient(145deg, #2196f3, #42a5f5); color: white; border-color: #1565c0; font-size: 12px; padding: 8px 12px;'>▶️ Phát</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='slot3-info' style='margin-top: 8px; font-size: 11px; color: #666;'>📦 Chưa có dữ liệu</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Instructions
-    httpd_resp_sendstr_chunk(req, "<div style='margin-top: 12px; padding: 10px; background: #e3f2fd; border-radius: 8px; font-size: 12px; color: #1565c0; line-height: 1.6;'>");
-    httpd_resp_sendstr_chunk(req, "💡 <strong>Hướng dẫn:</strong><br>");
-    httpd_resp_sendstr_chunk(req, "1️⃣ Bấm <strong>🔴 Bắt đầu ghi</strong> → Nút chuyển thành 🟢 Đang ghi...<br>");
-    httpd_resp_sendstr_chunk(req, "2️⃣ Thực hiện các hành động (đi, nhảy, ngồi...) và chọn emoji<br>");
-    httpd_resp_sendstr_chunk(req, "3️⃣ Bấm <strong>💾 Lưu</strong> → Ghi vào vị trí và dừng recording<br>");
-    httpd_resp_sendstr_chunk(req, "4️⃣ Bấm <strong>▶️ Phát</strong> → Robot thực hiện lại toàn bộ");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // AI Chat Section - MOVED TO PAGE 1
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>💬 Chat với Kiki AI</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #e3f2fd, #ffffff); border: 2px solid #1976d2; border-radius: 15px; padding: 15px; margin-bottom: 20px;'>");
-    
-    // Chat history area
-    httpd_resp_sendstr_chunk(req, "<div id='chat-history' style='background: #fff; border: 1px solid #ddd; border-radius: 10px; padding: 10px; height: 150px; overflow-y: auto; margin-bottom: 10px; font-size: 14px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='color: #999; text-align: center;'>💬 Lịch sử chat sẽ hiển thị ở đây...</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Input area
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 8px; margin-bottom: 5px;'>");
-    httpd_resp_sendstr_chunk(req, "<textarea id='ai_text_input' placeholder='Nhập tin nhắn cho Kiki...' rows='2' maxlength='1500' style='flex:1; padding: 10px; border: 2px solid #1976d2; border-radius: 8px; font-size: 14px; resize: none;' oninput='updateCharCount()'></textarea>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendTextToAI()' style='background: linear-gradient(145deg, #1976d2, #42a5f5); color: white; border: none; padding: 10px 20px; font-size: 16px;'>📤 Gửi</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Character counter
-    httpd_resp_sendstr_chunk(req, "<div id='char-counter' style='text-align: right; font-size: 11px; color: #666; margin-bottom: 8px;'>0 / 1500 ký tự</div>");
-    
-    // Quick buttons
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-wrap: wrap; gap: 6px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='quickSend(\"Xin chào Kiki\")' style='font-size: 12px; padding: 6px 12px; background: #e3f2fd; border-color: #1976d2; color: #1976d2;'>👋 Xin chào</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='quickSend(\"Hôm nay thời tiết thế nào\")' style='font-size: 12px; padding: 6px 12px; background: #e3f2fd; border-color: #1976d2; color: #1976d2;'>🌤️ Thời tiết</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='quickSend(\"Kể cho tôi một câu chuyện vui\")' style='font-size: 12px; padding: 6px 12px; background: #e3f2fd; border-color: #1976d2; color: #1976d2;'>📖 Kể chuyện</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='quickSend(\"Bạn có thể làm gì\")' style='font-size: 12px; padding: 6px 12px; background: #e3f2fd; border-color: #1976d2; color: #1976d2;'>❓ Trợ giúp</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='clearChatHistory()' style='font-size: 12px; padding: 6px 12px; background: #ffebee; border-color: #f44336; color: #f44336;'>🗑️ Xóa</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Status area
-    httpd_resp_sendstr_chunk(req, "<div id='ai-text-status' style='padding: 8px; background: #e8f5e9; border-radius: 6px; font-size: 13px; text-align: center; color: #2e7d32;'>✅ Sẵn sàng chat với Kiki</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Schedule Section - Hẹn giờ (Báo thức hoặc Tin nhắn)
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>⏰ Hẹn Giờ & Báo Thức</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #fff3e0, #ffffff); border: 2px solid #ff9800; border-radius: 15px; padding: 15px;'>");
-    
-    // Mode selection - Radio buttons
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px; padding: 10px; background: #fafafa; border-radius: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #e65100;'>🎯 Chọn chế độ:</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 15px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: flex; align-items: center; gap: 8px; cursor: pointer; padding: 10px 15px; background: #fff; border: 2px solid #4caf50; border-radius: 8px; flex: 1; min-width: 140px;'>");
-    httpd_resp_sendstr_chunk(req, "<input type='radio' name='schedule_mode' value='alarm' id='mode_alarm' checked onchange='updateScheduleMode()' style='width: 18px; height: 18px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-size: 14px;'>🔔 <strong>Báo thức</strong></span>");
-    httpd_resp_sendstr_chunk(req, "</label>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: flex; align-items: center; gap: 8px; cursor: pointer; padding: 10px 15px; background: #fff; border: 2px solid #2196f3; border-radius: 8px; flex: 1; min-width: 140px;'>");
-    httpd_resp_sendstr_chunk(req, "<input type='radio' name='schedule_mode' value='message' id='mode_message' onchange='updateScheduleMode()' style='width: 18px; height: 18px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-size: 14px;'>💬 <strong>Hẹn tin nhắn</strong></span>");
-    httpd_resp_sendstr_chunk(req, "</label>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Message input for scheduled message (hidden by default for alarm mode)
-    httpd_resp_sendstr_chunk(req, "<div id='message_input_section' style='margin-bottom: 12px; display: none;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: block; font-weight: bold; margin-bottom: 5px; color: #1976d2;'>📝 Tin nhắn sẽ gửi:</label>");
-    httpd_resp_sendstr_chunk(req, "<textarea id='schedule_message' placeholder='Nhập tin nhắn muốn hẹn giờ gửi...' rows='2' maxlength='500' style='width: 100%; padding: 10px; border: 2px solid #2196f3; border-radius: 8px; font-size: 14px; resize: none;'></textarea>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Action slot selection dropdown
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: block; font-weight: bold; margin-bottom: 5px; color: #9c27b0;'>🎭 Hành động kèm theo:</label>");
-    httpd_resp_sendstr_chunk(req, "<select id='schedule_action_slot' style='width: 100%; padding: 10px; border: 2px solid #9c27b0; border-radius: 8px; font-size: 14px; background: white;'>");
-    httpd_resp_sendstr_chunk(req, "<option value='0'>⚪ Không chọn hành động</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='1'>📍 Vị trí 1</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='2'>📍 Vị trí 2</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='3'>📍 Vị trí 3</option>");
-    httpd_resp_sendstr_chunk(req, "</select>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size: 12px; color: #666; margin-top: 4px;'>💡 Chọn hành động đã lưu để tự động thực hiện khi đến giờ</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Date input - ngày tháng năm
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: block; font-weight: bold; margin-bottom: 5px; color: #e65100;'>📅 Ngày:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='date' id='schedule_date' style='width: 100%; padding: 10px; border: 2px solid #ff9800; border-radius: 8px; font-size: 16px;'>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Time input - giờ phút
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='display: block; font-weight: bold; margin-bottom: 5px; color: #e65100;'>🕐 Giờ:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='time' id='schedule_time' style='width: 100%; padding: 10px; border: 2px solid #ff9800; border-radius: 8px; font-size: 16px;'>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Quick time buttons
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-wrap: wrap; gap: 6px; margin-bottom: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setQuickSchedule(1)' style='font-size: 12px; padding: 6px 12px; background: #fff3e0; border-color: #ff9800; color: #e65100;'>+1 phút</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setQuickSchedule(5)' style='font-size: 12px; padding: 6px 12px; background: #fff3e0; border-color: #ff9800; color: #e65100;'>+5 phút</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setQuickSchedule(10)' style='font-size: 12px; padding: 6px 12px; background: #fff3e0; border-color: #ff9800; color: #e65100;'>+10 phút</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setQuickSchedule(30)' style='font-size: 12px; padding: 6px 12px; background: #fff3e0; border-color: #ff9800; color: #e65100;'>+30 phút</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setQuickSchedule(60)' style='font-size: 12px; padding: 6px 12px; background: #fff3e0; border-color: #ff9800; color: #e65100;'>+1 giờ</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Control buttons
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 10px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<button id='scheduleStartBtn' class='btn' onclick='startSchedule()' style='flex: 1; background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border: none; padding: 12px; font-size: 16px; font-weight: bold;'>🔔 Đặt Báo Thức</button>");
-    httpd_resp_sendstr_chunk(req, "<button id='scheduleCancelBtn' class='btn' onclick='cancelSchedule()' style='flex: 1; background: linear-gradient(145deg, #f44336, #e57373); color: white; border: none; padding: 12px; font-size: 16px; font-weight: bold; display: none;'>⏹️ Hủy</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Countdown display - show target time and remaining time
-    httpd_resp_sendstr_chunk(req, "<div id='schedule-countdown' style='padding: 12px; background: #e8f5e9; border-radius: 8px; font-size: 16px; text-align: center; color: #2e7d32; font-weight: bold; display: none;'>");
-    httpd_resp_sendstr_chunk(req, "<div id='countdown-mode-label'>🔔 Báo thức lúc: <span id='target-datetime'>--</span></div>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size: 20px; margin-top: 8px;'>⏰ Còn lại: <span id='countdown-time'>00:00:00</span></div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Status area
-    httpd_resp_sendstr_chunk(req, "<div id='schedule-status' style='padding: 8px; background: #fff3e0; border-radius: 6px; font-size: 13px; text-align: center; color: #e65100;'>💡 Chọn chế độ, đặt ngày giờ, sau đó nhấn nút để bắt đầu</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Response area for Page 1
-    httpd_resp_sendstr_chunk(req, "<div class='response' id='response'>Ready for commands...</div>");
-    httpd_resp_sendstr_chunk(req, "</div>"); // End Page 1
-    
-    // Page 2: Settings & Configuration
-    httpd_resp_sendstr_chunk(req, "<div class='page' id='page2'>");
-    
-    // Touch Sensor Control Section
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section' style='display:none;'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🖐️ Cảm Biến Chạm TTP223</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='mode-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setTouchSensor(true)' id='touch-on' style='background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border-color: #2e7d32; font-size: 16px; font-weight: bold;'>🖐️ BẬT Cảm Biến Chạm</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setTouchSensor(false)' id='touch-off' style='background: linear-gradient(145deg, #f44336, #e57373); color: white; border-color: #c62828; font-size: 16px; font-weight: bold;'>🚫 TẮT Cảm Biến Chạm</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='text-align: center; margin-top: 10px; color: #666; font-size: 14px;'>");
-    httpd_resp_sendstr_chunk(req, "Khi BẬT: chạm vào cảm biến → robot nhảy + emoji cười<br>");
-    httpd_resp_sendstr_chunk(req, "Khi TẮT: chạm vào cảm biến không có phản ứng");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // System Controls Section
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>⚙️ Điều Khiển Hệ Thống</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='mode-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' id='powerSaveBtn' onclick='toggleScreen()' style='background: linear-gradient(145deg, #9e9e9e, #bdbdbd); color: white; border-color: #616161; font-size: 16px; font-weight: bold;'>📱 Tiết Kiệm: TẮT</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' id='micBtn' onclick='toggleMic()' style='background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border-color: #2e7d32; font-size: 16px; font-weight: bold;'>🎤 Mic: TẮT</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' id='idleClockBtn' onclick='toggleIdleClock()' style='background: linear-gradient(145deg, #9e9e9e, #bdbdbd); color: white; border-color: #616161; font-size: 16px; font-weight: bold;'>⏰ Đồng Hồ Chờ: TẮT</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='forgetWiFi()' style='background: linear-gradient(145deg, #ff5722, #ff7043); color: white; border-color: #d84315; font-size: 16px; font-weight: bold;'>🔄 Quên WiFi & Tạo AP</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='text-align: center; margin-top: 10px; color: #666; font-size: 14px;'>");
-    httpd_resp_sendstr_chunk(req, "<strong>Tiết Kiệm Năng Lượng:</strong> TẮT = bình thường, BẬT = giảm tiêu thụ WiFi<br>");
-    httpd_resp_sendstr_chunk(req, "<strong>Mic:</strong> TẮT/BẬT microphone để lắng nghe giọng nói<br>");
-    httpd_resp_sendstr_chunk(req, "<strong>Đồng Hồ Chờ:</strong> BẬT = hiển thị đồng hồ khi robot nghỉ<br>");
-    httpd_resp_sendstr_chunk(req, "<strong>Quên WiFi & Tạo AP:</strong> xóa WiFi hiện tại, robot sẽ tạo Access Point để cấu hình WiFi mới");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // LED Control Section - GPIO 12 (8 LEDs WS2812)
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>💡 Điều Khiển LED Strip (GPIO 12)</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #e8f5e9, #ffffff); border: 2px solid #4caf50; border-radius: 15px; padding: 15px;'>");
-    
-    // LED Mode Selection
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #2e7d32; font-size: 15px;'>🎨 Chế Độ LED:</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='mode-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"off\")' style='background: #9e9e9e; color: white; border-color: #616161; font-size: 14px;'>⚫ Tắt</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"solid\")' style='background: #2196f3; color: white; border-color: #1565c0; font-size: 14px;'>🔵 Đơn Sắc</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"rainbow\")' style='background: linear-gradient(90deg, #f44336, #ff9800, #ffeb3b, #4caf50, #2196f3, #9c27b0); color: white; border-color: #000; font-size: 14px;'>🌈 Cầu Vồng</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"breathing\")' style='background: #ff9800; color: white; border-color: #e65100; font-size: 14px;'>💨 Thở</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"chase\")' style='background: #9c27b0; color: white; border-color: #6a1b9a; font-size: 14px;'>🏃 Đuổi</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' onclick='setLedMode(\"blink\")' style='background: #f44336; color: white; border-color: #c62828; font-size: 14px;'>⚡ Nhấp Nháy</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Color Picker for Solid Mode
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px; padding: 12px; background: #fff; border: 2px solid #2196f3; border-radius: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #1565c0; font-size: 14px;'>🎨 Chọn Màu (Chế độ Đơn Sắc):</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: grid; grid-template-columns: repeat(4, 1fr); gap: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(255,0,0)' style='background: #f44336; color: white; border-color: #c62828; font-size: 12px; padding: 8px;'>🔴 Đỏ</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(0,255,0)' style='background: #4caf50; color: white; border-color: #2e7d32; font-size: 12px; padding: 8px;'>🟢 Xanh Lá</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(0,0,255)' style='background: #2196f3; color: white; border-color: #1565c0; font-size: 12px; padding: 8px;'>🔵 Xanh Dương</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(255,255,0)' style='background: #ffeb3b; color: #000; border-color: #f9a825; font-size: 12px; padding: 8px;'>🟡 Vàng</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(255,0,255)' style='background: #e91e63; color: white; border-color: #880e4f; font-size: 12px; padding: 8px;'>🟣 Tím Hồng</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(0,255,255)' style='background: #00bcd4; color: white; border-color: #006064; font-size: 12px; padding: 8px;'>🩵 Cyan</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(255,165,0)' style='background: #ff9800; color: white; border-color: #e65100; font-size: 12px; padding: 8px;'>🟠 Cam</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='setLedColor(255,255,255)' style='background: #ffffff; color: #000; border-color: #000; font-size: 12px; padding: 8px;'>⚪ Trắng</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Brightness Control
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px; padding: 12px; background: #fff; border: 2px solid #ff9800; border-radius: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #e65100; font-size: 14px;'>💡 Độ Sáng:</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold; color: #000;'>🔅</span>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' id='ledBrightness' min='10' max='255' value='128' oninput='updateLedBrightness(this.value)' style='flex: 1; height: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<span id='ledBrightnessValue' style='font-weight: bold; color: #000; min-width: 50px; text-align: center;'>128</span>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold; color: #000;'>🔆</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Speed Control
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px; padding: 12px; background: #fff; border: 2px solid #9c27b0; border-radius: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #6a1b9a; font-size: 14px;'>⚡ Tốc Độ Animation:</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold; color: #000;'>🐢</span>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' id='ledSpeed' min='10' max='500' value='50' oninput='updateLedSpeed(this.value)' style='flex: 1; height: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<span id='ledSpeedValue' style='font-weight: bold; color: #000; min-width: 50px; text-align: center;'>50ms</span>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold; color: #000;'>🐇</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Control Buttons
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 10px; margin-bottom: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='turnOffLed()' style='flex: 1; background: linear-gradient(145deg, #f44336, #e57373); color: white; border: none; padding: 12px; font-size: 14px; font-weight: bold;'>⚫ Tắt Tất Cả</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='saveLedSettings()' style='flex: 1; background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border: none; padding: 12px; font-size: 14px; font-weight: bold;'>💾 Lưu Cài Đặt</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // LED Status Display
-    httpd_resp_sendstr_chunk(req, "<div id='led-status' style='padding: 12px; background: #e8f5e9; border-radius: 8px; font-size: 13px; text-align: center; color: #2e7d32; font-weight: bold;'>💡 Trạng thái: Đang tải...</div>");
-    
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Screen Rotation Control
-    httpd_resp_sendstr_chunk(req, "<div style='margin-top: 15px; padding: 12px; background: #fff3e0; border: 2px solid #ff9800; border-radius: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 10px; color: #e65100; font-size: 15px; text-align: center;'>🔄 Xoay Màn Hình</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-direction: column; gap: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='rotateScreen90()' style='flex: 1; background: #fff; border-color: #ff9800; color: #e65100; padding: 12px; font-size: 16px; font-weight: bold;'>🔄 Xoay 90°</button>");
-    httpd_resp_sendstr_chunk(req, "<div id='currentRotation' style='padding: 8px 16px; background: #ffe0b2; border-radius: 6px; font-weight: bold; color: #e65100; white-space: nowrap;'>0°</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='saveScreenRotation()' style='background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border: none; padding: 12px; font-size: 16px; font-weight: bold;'>💾 Lưu Vĩnh Viễn</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='margin-top: 8px; font-size: 12px; color: #666; text-align: center;'>💡 Bấm 'Xoay 90°' để xem trước, 'Lưu' để giữ sau khi reboot</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Idle Timeout Setting
-    httpd_resp_sendstr_chunk(req, "<div style='margin-top: 10px; padding: 10px; background: #e8f5e9; border: 2px solid #4caf50; border-radius: 8px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='font-weight: bold; color: #2e7d32; font-size: 14px;'>⏱️ Tự động tiết kiệm pin sau:</label>");
-    // Dynamic idle timeout value
-    {
-        char timeout_input[128];
-        snprintf(timeout_input, sizeof(timeout_input), 
-            "<input type='number' id='idleTimeoutInput' class='time-input' value='%lu' min='5' max='180' style='width: 60px;'>",
-            idle_timeout_minutes);
-        httpd_resp_sendstr_chunk(req, timeout_input);
-    }
-    httpd_resp_sendstr_chunk(req, "<span style='font-size: 14px; color: #2e7d32;'>phút</span>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='updateIdleTimeout()' style='padding: 6px 12px; font-size: 12px; background: #4caf50; color: white;'>✓ Lưu</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='margin-top: 8px; font-size: 12px; color: #666;'>💡 Robot sẽ nằm xuống + tắt màn hình + detach servo sau thời gian không hoạt động</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Auto Pose Advanced Configuration
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🔄 Cấu Hình Auto Pose</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-config'>");
-    
-    // Time interval setting - compact
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 10px; padding: 8px; background: #e3f2fd; border: 2px solid #2196f3; border-radius: 6px; display: flex; align-items: center; gap: 8px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='font-weight: bold; color: #000; font-size: 12px;'>⏱️ Giữa tư thế:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='number' id='poseInterval' class='time-input' value='60' min='5' max='300'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-size: 12px;'>giây</span>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='updateInterval()' style='padding: 6px 12px; font-size: 12px;'>✓</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Pose selection checkboxes - 3 columns
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 8px; color: #000; font-size: 13px;'>✅ Chọn tư thế Auto:</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-grid'>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_sit' checked><label for='pose_sit'>🪑 Ngồi</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_jump' checked><label for='pose_jump'>🦘 Nhảy</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_wave' checked><label for='pose_wave'>👋 Vẫy</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_bow' checked><label for='pose_bow'>🙇 Cúi</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_stretch' checked><label for='pose_stretch'>🧘 Giãn</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_swing' checked><label for='pose_swing'>🎯 Lắc</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='pose_dance' checked><label for='pose_dance'>💃 Múa</label></div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "<button class='btn toggle-btn' id='autoPoseBtn2' onclick='toggleAutoPose()' style='width: 100%; margin-top: 15px; font-size: 16px;'>🔄 Bật/Tắt Auto Pose</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Auto Emoji Advanced Configuration
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>😊 Cấu Hình Auto Emoji</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-config'>");
-    
-    // Time interval setting for emoji - compact
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 10px; padding: 8px; background: #fff3e0; border: 2px solid #ff9800; border-radius: 6px; display: flex; align-items: center; gap: 8px; flex-wrap: wrap;'>");
-    httpd_resp_sendstr_chunk(req, "<label style='font-weight: bold; color: #000; font-size: 12px;'>⏱️ Giữa emoji:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='number' id='emojiInterval' class='time-input' value='10' min='3' max='120'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-size: 12px;'>giây</span>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='updateEmojiInterval()' style='padding: 6px 12px; font-size: 12px;'>✓</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Emoji selection checkboxes - 3 columns
-    httpd_resp_sendstr_chunk(req, "<div style='font-weight: bold; margin-bottom: 8px; color: #000; font-size: 13px;'>✅ Chọn emoji Auto:</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-grid'>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_happy' checked><label for='emoji_happy'>😊 Vui</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_laughing' checked><label for='emoji_laughing'>😂 Cười</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_winking' checked><label for='emoji_winking'>😜 Nháy</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_cool' checked><label for='emoji_cool'>😎 Ngầu</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_love' checked><label for='emoji_love'>😍 Yêu</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_surprised' checked><label for='emoji_surprised'>😮 Ngạc</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_excited' checked><label for='emoji_excited'>🤩 Khích</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_sleepy' checked><label for='emoji_sleepy'>😴 Ngủ</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_sad' checked><label for='emoji_sad'>😢 Buồn</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_angry' checked><label for='emoji_angry'>😠 Giận</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_confused' checked><label for='emoji_confused'>😕 Rối</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_thinking' checked><label for='emoji_thinking'>🤔 Nghĩ</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_neutral' checked><label for='emoji_neutral'>😐 Thường</label></div>");
-    httpd_resp_sendstr_chunk(req, "<div class='pose-item'><input type='checkbox' id='emoji_shocked' checked><label for='emoji_shocked'>😱 Sốc</label></div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "<button class='btn toggle-btn' id='autoEmojiBtn' onclick='toggleAutoEmoji()' style='width: 100%; margin-top: 15px; font-size: 16px; background: linear-gradient(145deg, #ff9800, #ffa726);'>😊 Bật/Tắt Auto Emoji</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Emoji Mode Selector Section
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>🎨 Chế Độ Hiển Thị Emoji</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='mode-grid'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' id='otto-mode' onclick='setEmojiMode(true)' style='background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border: 3px solid #2e7d32; font-size: 18px; font-weight: bold; box-shadow: 0 4px 8px rgba(0,0,0,0.2);'>🤖 OTTO GIF MODE (ACTIVE)</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn mode-btn' id='default-mode' onclick='setEmojiMode(false)' style='font-size: 16px; font-weight: bold;'>😊 Twemoji Text Mode</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='text-align: center; margin-top: 10px; color: #666; font-size: 14px;'>");
-    httpd_resp_sendstr_chunk(req, "<strong>🤖 OTTO GIF:</strong> Hiển thị emoji động GIF (Otto robot)<br>");
-    httpd_resp_sendstr_chunk(req, "<strong>😊 Twemoji:</strong> Hiển thị emoji văn bản chuẩn Unicode");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-
-    // MQTT Configuration Section
-    httpd_resp_sendstr_chunk(req, "<div class='movement-section' style='display:none;'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title'>📡 Cấu Hình MQTT</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='background: linear-gradient(145deg, #f8f8f8, #ffffff); border: 2px solid #ff9800; border-radius: 15px; padding: 20px; margin-bottom: 20px;'>");
-    httpd_resp_sendstr_chunk(req, "<div style='margin-bottom: 15px; color: #666; font-size: 14px;'>");
-    httpd_resp_sendstr_chunk(req, "📡 Cấu hình MQTT server để Otto kết nối và giao tiếp qua MQTT protocol.<br>");
-    httpd_resp_sendstr_chunk(req, "⚠️ <strong>Endpoint là bắt buộc</strong> (ví dụ: mqtt.example.com:8883 hoặc 192.168.1.100:8883)");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-direction: column; gap: 12px;'>");
-    httpd_resp_sendstr_chunk(req, "<div><label style='display: block; font-weight: bold; margin-bottom: 5px; color: #000;'>Endpoint <span style='color: red;'>*</span>:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='text' id='mqttEndpoint' placeholder='mqtt.example.com:8883' style='width: 100%; padding: 10px; border: 2px solid #ddd; border-radius: 8px; font-size: 14px;'></div>");
-    httpd_resp_sendstr_chunk(req, "<div><label style='display: block; font-weight: bold; margin-bottom: 5px; color: #000;'>Client ID:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='text' id='mqttClientId' placeholder='otto-robot-001' style='width: 100%; padding: 10px; border: 2px solid #ddd; border-radius: 8px; font-size: 14px;'></div>");
-    httpd_resp_sendstr_chunk(req, "<div><label style='display: block; font-weight: bold; margin-bottom: 5px; color: #000;'>Username:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='text' id='mqttUsername' placeholder='(tùy chọn)' style='width: 100%; padding: 10px; border: 2px solid #ddd; border-radius: 8px; font-size: 14px;'></div>");
-    httpd_resp_sendstr_chunk(req, "<div><label style='display: block; font-weight: bold; margin-bottom: 5px; color: #000;'>Password:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='password' id='mqttPassword' placeholder='(tùy chọn)' style='width: 100%; padding: 10px; border: 2px solid #ddd; border-radius: 8px; font-size: 14px;'></div>");
-    httpd_resp_sendstr_chunk(req, "<div><label style='display: block; font-weight: bold; margin-bottom: 5px; color: #000;'>Publish Topic:</label>");
-    httpd_resp_sendstr_chunk(req, "<input type='text' id='mqttPublishTopic' placeholder='otto/robot/001' style='width: 100%; padding: 10px; border: 2px solid #ddd; border-radius: 8px; font-size: 14px;'></div>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='saveMqttConfig()' style='background: linear-gradient(145deg, #ff9800, #ffa726); color: white; border-color: #f57c00; font-weight: bold; padding: 12px 20px; width: 100%; margin-top: 10px;'>💾 Lưu Cấu Hình MQTT</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='mqttConfigStatus' style='margin-top: 10px; font-size: 14px; color: #666;'></div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-
-    // Response area for Page 2
-    httpd_resp_sendstr_chunk(req, "<div class='response' id='response2'>Cấu hình sẵn sàng...</div>");
-    httpd_resp_sendstr_chunk(req, "</div>"); // End Page 2
-    
-    // Page 4: Drawing Canvas
-    httpd_resp_sendstr_chunk(req, "<div class='page' id='page4'>");
-    httpd_resp_sendstr_chunk(req, "<div class='section-title' style='text-align: center; margin-bottom: 15px;'>🎨 Vẽ & Hiển Thị Lên Robot</div>");
-    
-    // Canvas container
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-direction: column; align-items: center;'>");
-    httpd_resp_sendstr_chunk(req, "<canvas id='drawCanvas' width='240' height='240' style='border: 3px solid #333; border-radius: 12px; background: #fff; touch-action: none;'></canvas>");
-    
-    // Drawing tools
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-wrap: wrap; gap: 10px; justify-content: center; margin-top: 15px;'>");
-    
-    // Color palette
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; flex-wrap: wrap; gap: 5px; justify-content: center;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#000000\")' style='width: 35px; height: 35px; border-radius: 50%; background: #000; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#ff0000\")' style='width: 35px; height: 35px; border-radius: 50%; background: #ff0000; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#00ff00\")' style='width: 35px; height: 35px; border-radius: 50%; background: #00ff00; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#0000ff\")' style='width: 35px; height: 35px; border-radius: 50%; background: #0000ff; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#ffff00\")' style='width: 35px; height: 35px; border-radius: 50%; background: #ffff00; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#ff9800\")' style='width: 35px; height: 35px; border-radius: 50%; background: #ff9800; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#9c27b0\")' style='width: 35px; height: 35px; border-radius: 50%; background: #9c27b0; border: 2px solid #fff; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "<button class='color-btn' onclick='setColor(\"#ffffff\")' style='width: 35px; height: 35px; border-radius: 50%; background: #fff; border: 2px solid #333; box-shadow: 0 2px 4px rgba(0,0,0,0.3);'></button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Brush size
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; align-items: center; gap: 10px; margin-top: 10px;'>");
-    httpd_resp_sendstr_chunk(req, "<span style='font-weight: bold;'>🖌️ Cọ:</span>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' id='brushSize' min='1' max='20' value='5' style='flex: 1;' onchange='updateBrushSize()'>");
-    httpd_resp_sendstr_chunk(req, "<span id='brushSizeValue' style='min-width: 30px;'>5px</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Action buttons
-    httpd_resp_sendstr_chunk(req, "<div style='display: flex; gap: 10px; margin-top: 15px; flex-wrap: wrap; justify-content: center;'>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='clearCanvas()' style='background: linear-gradient(145deg, #f44336, #e57373); color: white; border-color: #c62828; padding: 12px 25px; font-size: 16px;'>🗑️ Xóa</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='sendDrawing()' style='background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border-color: #2e7d32; padding: 12px 25px; font-size: 16px;'>📤 Gửi Đến Robot</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='btn' onclick='exitDrawing()' style='background: linear-gradient(145deg, #9e9e9e, #bdbdbd); color: white; border-color: #616161; padding: 12px 25px; font-size: 16px;'>↩️ Quay Lại Emoji</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Response area for Page 4
-    httpd_resp_sendstr_chunk(req, "<div class='response' id='response4'>Vẽ và gửi hình đến robot!</div>");
-    httpd_resp_sendstr_chunk(req, "</div>"); // End Page 4
-    
-    httpd_resp_sendstr_chunk(req, "</div>"); // End container
-    
-    // JavaScript - Simple and clean
-    httpd_resp_sendstr_chunk(req, "<script>");
-    // showStatus function - From kytuoi repository
-    httpd_resp_sendstr_chunk(req, "function showStatus(message, isError) {");
-    httpd_resp_sendstr_chunk(req, "  const status = document.getElementById('status');");
-    httpd_resp_sendstr_chunk(req, "  if (status) {");
-    httpd_resp_sendstr_chunk(req, "    status.className = 'status ' + (isError ? 'error' : 'success');");
-    httpd_resp_sendstr_chunk(req, "    status.textContent = message;");
-    httpd_resp_sendstr_chunk(req, "    setTimeout(() => status.textContent = '', 3000);");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Page navigation
-    httpd_resp_sendstr_chunk(req, "function showPage(pageNum) {");
-    httpd_resp_sendstr_chunk(req, "  document.querySelectorAll('.page').forEach(p => p.classList.remove('active'));");
-    httpd_resp_sendstr_chunk(req, "  document.querySelectorAll('.nav-tab').forEach(t => t.classList.remove('active'));");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('page' + pageNum).classList.add('active');");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('tab' + pageNum).classList.add('active');");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Speed multiplier is now handled server-side
-    // Track action recording for memory slots with explicit START/STOP
-    httpd_resp_sendstr_chunk(req, "let recordedActions = [];");
-    httpd_resp_sendstr_chunk(req, "let lastEmotion = 'neutral';");
-    httpd_resp_sendstr_chunk(req, "let isRecording = false;");
-    httpd_resp_sendstr_chunk(req, "let recordingSlot = 0;");
-    httpd_resp_sendstr_chunk(req, "function sendAction(action, param1, param2) {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Action:', action, 'p1:', param1, 'p2:', param2, 'emoji:', lastEmotion);");
-    httpd_resp_sendstr_chunk(req, "  if (isRecording) {");
-    httpd_resp_sendstr_chunk(req, "    recordedActions.push({action: action, p1: param1, p2: param2, emoji: lastEmotion});");
-    httpd_resp_sendstr_chunk(req, "    updateRecordingStatus();");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  var url = '/action?cmd=' + action + '&p1=' + param1 + '&p2=' + param2;");
-    httpd_resp_sendstr_chunk(req, "  fetch(url).then(r => r.text()).then(d => console.log('Success:', d));");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function sendEmotion(emotion) {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Emotion:', emotion);");
-    httpd_resp_sendstr_chunk(req, "  lastEmotion = emotion;");
-    httpd_resp_sendstr_chunk(req, "  if (isRecording) {");
-    httpd_resp_sendstr_chunk(req, "    recordedActions.push({action: 'emoji', p1: 0, p2: 0, emoji: emotion});");
-    httpd_resp_sendstr_chunk(req, "    updateRecordingStatus();");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  fetch('/emotion?emotion=' + emotion).then(r => r.text()).then(d => console.log('Success:', d));");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function updateRecordingStatus() {");
-    httpd_resp_sendstr_chunk(req, "  if (isRecording && recordingSlot > 0) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById(`slot${recordingSlot}-status`).innerHTML = `🟢 Đang ghi: ${recordedActions.length} hành động`;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Memory slot functions
-    httpd_resp_sendstr_chunk(req, "function startRecording(slotNum) {");
-    httpd_resp_sendstr_chunk(req, "  if (isRecording) {");
-    httpd_resp_sendstr_chunk(req, "    alert('⚠️ Đang ghi vị trí ' + recordingSlot + '! Hãy lưu hoặc hủy trước.');");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  isRecording = true;");
-    httpd_resp_sendstr_chunk(req, "  recordingSlot = slotNum;");
-    httpd_resp_sendstr_chunk(req, "  recordedActions = [];");
-    httpd_resp_sendstr_chunk(req, "  lastEmotion = 'neutral';");
-    httpd_resp_sendstr_chunk(req, "  const recordBtn = document.getElementById(`record${slotNum}-btn`);");
-    httpd_resp_sendstr_chunk(req, "  const saveBtn = document.getElementById(`save${slotNum}-btn`);");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.innerHTML = '🟢 Đang ghi...';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.style.background = 'linear-gradient(145deg, #4caf50, #66bb6a)';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.style.borderColor = '#2e7d32';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.onclick = () => stopRecording(slotNum);");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.disabled = false;");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.background = 'linear-gradient(145deg, #4caf50, #66bb6a)';");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.color = 'white';");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.borderColor = '#2e7d32';");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.cursor = 'pointer';");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById(`slot${slotNum}-status`).innerHTML = '🟢 Đang ghi: 0 hành động';");
-    httpd_resp_sendstr_chunk(req, "  console.log('🔴 Started recording for slot', slotNum);");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function stopRecording(slotNum) {");
-    httpd_resp_sendstr_chunk(req, "  if (!isRecording || recordingSlot !== slotNum) return;");
-    httpd_resp_sendstr_chunk(req, "  isRecording = false;");
-    httpd_resp_sendstr_chunk(req, "  const recordBtn = document.getElementById(`record${slotNum}-btn`);");
-    httpd_resp_sendstr_chunk(req, "  const saveBtn = document.getElementById(`save${slotNum}-btn`);");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.innerHTML = '🔴 Bắt đầu ghi';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.style.background = 'linear-gradient(145deg, #ff5722, #ff7043)';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.style.borderColor = '#d84315';");
-    httpd_resp_sendstr_chunk(req, "  recordBtn.onclick = () => startRecording(slotNum);");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.disabled = true;");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.background = '#e0e0e0';");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.color = '#999';");
-    httpd_resp_sendstr_chunk(req, "  saveBtn.style.cursor = 'not-allowed';");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById(`slot${slotNum}-status`).innerHTML = '⚪ Đã dừng ghi';");
-    httpd_resp_sendstr_chunk(req, "  recordedActions = [];");
-    httpd_resp_sendstr_chunk(req, "  recordingSlot = 0;");
-    httpd_resp_sendstr_chunk(req, "  console.log('⏹️ Stopped recording for slot', slotNum);");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function saveSlot(slotNum) {");
-    httpd_resp_sendstr_chunk(req, "  if (!isRecording || recordingSlot !== slotNum) {");
-    httpd_resp_sendstr_chunk(req, "    alert('⚠️ Chưa bắt đầu ghi! Bấm \"🔴 Bắt đầu ghi\" trước.');");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  if (recordedActions.length === 0) {");
-    httpd_resp_sendstr_chunk(req, "    alert('⚠️ Chưa có hành động nào! Thực hiện hành động (đi, nhảy, ngồi...) rồi bấm Lưu.');");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  let actionsStr = recordedActions.map(a => `${a.action},${a.p1},${a.p2},${a.emoji}`).join(';');");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/save_slot?slot=${slotNum}&actions=${encodeURIComponent(actionsStr)}&emotion=${lastEmotion}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.json())");
-    httpd_resp_sendstr_chunk(req, "    .then(data => {");
-    httpd_resp_sendstr_chunk(req, "      if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "        alert(`✅ Đã lưu ${data.count} hành động vào vị trí ${slotNum}!`);");
-    httpd_resp_sendstr_chunk(req, "        document.getElementById(`slot${slotNum}-info`).innerHTML = `📦 ${data.count} hành động • Emoji: ${data.emotion}`;");
-    httpd_resp_sendstr_chunk(req, "        document.getElementById(`slot${slotNum}-status`).innerHTML = '✅ Đã lưu';");
-    httpd_resp_sendstr_chunk(req, "        stopRecording(slotNum);");
-    httpd_resp_sendstr_chunk(req, "      } else {");
-    httpd_resp_sendstr_chunk(req, "        alert('❌ Lỗi: ' + data.error);");
-    httpd_resp_sendstr_chunk(req, "      }");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => alert('❌ Lỗi kết nối: ' + e));");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function playSlot(slotNum) {");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/play_slot?slot=${slotNum}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.json())");
-    httpd_resp_sendstr_chunk(req, "    .then(data => {");
-    httpd_resp_sendstr_chunk(req, "      if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "        alert(`▶️ Đang phát lại ${data.count} hành động từ vị trí ${slotNum}`);");
-    httpd_resp_sendstr_chunk(req, "      } else {");
-    httpd_resp_sendstr_chunk(req, "        alert('❌ ' + data.error);");
-    httpd_resp_sendstr_chunk(req, "      }");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => alert('❌ Lỗi: ' + e));");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // LED Control Functions
-    httpd_resp_sendstr_chunk(req, "function setLedMode(mode) {");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/led_mode?mode=${mode}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('led-status').textContent = '💡 ' + d;");
-    httpd_resp_sendstr_chunk(req, "      getLedState();");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function setLedColor(r, g, b) {");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/led?r=${r}&g=${g}&b=${b}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('led-status').textContent = '💡 ' + d;");
-    httpd_resp_sendstr_chunk(req, "      setLedMode('solid');");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function updateLedBrightness(value) {");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('ledBrightnessValue').textContent = value;");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/led_brightness?value=${value}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => document.getElementById('led-status').textContent = '💡 ' + d)");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function updateLedSpeed(value) {");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('ledSpeedValue').textContent = value + 'ms';");
-    httpd_resp_sendstr_chunk(req, "  fetch(`/led_speed?value=${value}`)");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => document.getElementById('led-status').textContent = '💡 ' + d)");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function turnOffLed() {");
-    httpd_resp_sendstr_chunk(req, "  fetch('/led_off')");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('led-status').textContent = '⚫ ' + d;");
-    httpd_resp_sendstr_chunk(req, "      getLedState();");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function saveLedSettings() {");
-    httpd_resp_sendstr_chunk(req, "  fetch('/led_save')");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => document.getElementById('led-status').textContent = '💾 ' + d)");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Lỗi: ' + e);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function getLedState() {");
-    httpd_resp_sendstr_chunk(req, "  fetch('/led_state')");
-    httpd_resp_sendstr_chunk(req, "    .then(r => r.json())");
-    httpd_resp_sendstr_chunk(req, "    .then(d => {");
-    httpd_resp_sendstr_chunk(req, "      const modes = {0:'⚫ Tắt', 1:'🔵 Đơn Sắc', 2:'🌈 Cầu Vồng', 3:'💨 Thở', 4:'🏃 Đuổi', 5:'⚡ Nhấp Nháy'};");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('led-status').textContent = `💡 ${modes[d.mode]} • Màu: RGB(${d.r},${d.g},${d.b}) • Sáng: ${d.brightness} • Tốc độ: ${d.speed}ms`;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('ledBrightness').value = d.brightness;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('ledBrightnessValue').textContent = d.brightness;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('ledSpeed').value = d.speed;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('ledSpeedValue').textContent = d.speed + 'ms';");
-    httpd_resp_sendstr_chunk(req, "    })");
-    httpd_resp_sendstr_chunk(req, "    .catch(e => document.getElementById('led-status').textContent = '❌ Không thể tải trạng thái');");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "window.onload = function() {");
-    httpd_resp_sendstr_chunk(req, "  getLedState();");
-    httpd_resp_sendstr_chunk(req, "  for(let i=1; i<=3; i++) {");
-    httpd_resp_sendstr_chunk(req, "    fetch(`/slot_info?slot=${i}`).then(r => r.json()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      if(d.used) {");
-    httpd_resp_sendstr_chunk(req, "        document.getElementById(`slot${i}-info`).innerHTML = `📦 ${d.count} hành động • Emoji: ${d.emotion}`;");
-    httpd_resp_sendstr_chunk(req, "        document.getElementById(`slot${i}-status`).innerHTML = '✅ Đã lưu';");
-    httpd_resp_sendstr_chunk(req, "      }");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "};");
-    httpd_resp_sendstr_chunk(req, "function setEmojiMode(useOttoEmoji) {");
-    // For compatibility, send 'gif' when Otto mode is selected (server also accepts 'otto')
-    httpd_resp_sendstr_chunk(req, "  var mode = useOttoEmoji ? 'gif' : 'default';");
-    httpd_resp_sendstr_chunk(req, "  fetch('/emoji_mode?mode=' + mode).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Mode:', d);");
-    // Update button styles
-    httpd_resp_sendstr_chunk(req, "    var ottoBtn = document.getElementById('otto-mode');");
-    httpd_resp_sendstr_chunk(req, "    var defaultBtn = document.getElementById('default-mode');");
-    httpd_resp_sendstr_chunk(req, "    if (useOttoEmoji) {");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.classList.add('active');");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.style.cssText = 'background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border-color: #2e7d32; font-size: 18px; font-weight: bold;';");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.innerHTML = '🤖 OTTO GIF MODE (ACTIVE)';");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.classList.remove('active');");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.style.cssText = '';");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.innerHTML = '😊 Twemoji Text Mode';");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.classList.add('active');");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.style.cssText = 'background: linear-gradient(145deg, #4caf50, #66bb6a); color: white; border-color: #2e7d32; font-size: 18px; font-weight: bold;';");
-    httpd_resp_sendstr_chunk(req, "      defaultBtn.innerHTML = '😊 TWEMOJI TEXT MODE (ACTIVE)';");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.classList.remove('active');");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.style.cssText = '';");
-    httpd_resp_sendstr_chunk(req, "      ottoBtn.innerHTML = '🤖 Otto GIF Mode';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function setTouchSensor(enabled) {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Touch sensor:', enabled);");
-    httpd_resp_sendstr_chunk(req, "  fetch('/touch_sensor?enabled=' + enabled).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Touch sensor result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Screen toggle JavaScript with state tracking
-    httpd_resp_sendstr_chunk(req, "let powerSaveState = false;"); // Track state
-    httpd_resp_sendstr_chunk(req, "function toggleScreen() {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Toggling screen...');");
-    httpd_resp_sendstr_chunk(req, "  const btn = document.getElementById('powerSaveBtn');");
-    httpd_resp_sendstr_chunk(req, "  fetch('/screen_toggle').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Screen toggle result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    powerSaveState = !powerSaveState;"); // Toggle state
-    httpd_resp_sendstr_chunk(req, "    if (powerSaveState) {"); // ON - blue
-    httpd_resp_sendstr_chunk(req, "      btn.style.background = 'linear-gradient(145deg, #2196f3, #42a5f5)';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.borderColor = '#1565c0';");
-    httpd_resp_sendstr_chunk(req, "      btn.innerHTML = '📱 Tiết Kiệm: <strong>BẬT</strong>';");
-    httpd_resp_sendstr_chunk(req, "    } else {"); // OFF - grey
-    httpd_resp_sendstr_chunk(req, "      btn.style.background = 'linear-gradient(145deg, #9e9e9e, #bdbdbd)';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.borderColor = '#616161';");
-    httpd_resp_sendstr_chunk(req, "      btn.innerHTML = '📱 Tiết Kiệm: <strong>TẮT</strong>';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Screen rotation JavaScript - rotate 90 degrees at a time
-    httpd_resp_sendstr_chunk(req, "let currentRotation = 0;");
-    httpd_resp_sendstr_chunk(req, "function rotateScreen90() {");
-    httpd_resp_sendstr_chunk(req, "  currentRotation = (currentRotation + 90) % 360;");
-    httpd_resp_sendstr_chunk(req, "  console.log('Rotating screen to:', currentRotation);");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('currentRotation').textContent = currentRotation + '°';");
-    httpd_resp_sendstr_chunk(req, "  fetch('/screen_rotation?angle=' + currentRotation + '&save=0').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Screen rotation result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '🔄 Xoay màn hình: ' + currentRotation + '° (chưa lưu)';");
-    httpd_resp_sendstr_chunk(req, "  }).catch(err => {");
-    httpd_resp_sendstr_chunk(req, "    console.error('Screen rotation error:', err);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '❌ Lỗi xoay màn hình';");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function saveScreenRotation() {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Saving screen rotation:', currentRotation);");
-    httpd_resp_sendstr_chunk(req, "  fetch('/screen_rotation?angle=' + currentRotation + '&save=1').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Save result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '✅ Đã lưu: ' + currentRotation + '° (sẽ giữ sau reboot)';");
-    httpd_resp_sendstr_chunk(req, "  }).catch(err => {");
-    httpd_resp_sendstr_chunk(req, "    console.error('Save error:', err);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '❌ Lỗi lưu cài đặt';");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Toggle microphone JavaScript - with state tracking
-    httpd_resp_sendstr_chunk(req, "let micActive = false;");
-    httpd_resp_sendstr_chunk(req, "function toggleMic() {");
-    httpd_resp_sendstr_chunk(req, "  const micBtn = document.getElementById('micBtn');");
-    httpd_resp_sendstr_chunk(req, "  if (micActive) {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Stopping microphone...');");
-    httpd_resp_sendstr_chunk(req, "    fetch('/wake_mic?action=stop').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      console.log('Mic stopped:', d);");
-    httpd_resp_sendstr_chunk(req, "      micActive = false;");
-    httpd_resp_sendstr_chunk(req, "      micBtn.innerHTML = '🎤 Mic: TẮT';");
-    httpd_resp_sendstr_chunk(req, "      micBtn.style.background = 'linear-gradient(145deg, #9e9e9e, #bdbdbd)';");
-    httpd_resp_sendstr_chunk(req, "      micBtn.style.borderColor = '#616161';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  } else {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Starting microphone...');");
-    httpd_resp_sendstr_chunk(req, "    fetch('/wake_mic').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      console.log('Mic started:', d);");
-    httpd_resp_sendstr_chunk(req, "      micActive = true;");
-    httpd_resp_sendstr_chunk(req, "      micBtn.innerHTML = '🎤 Mic: BẬT';");
-    httpd_resp_sendstr_chunk(req, "      micBtn.style.background = 'linear-gradient(145deg, #4caf50, #66bb6a)';");
-    httpd_resp_sendstr_chunk(req, "      micBtn.style.borderColor = '#2e7d32';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Toggle idle clock JavaScript - with state tracking
-    httpd_resp_sendstr_chunk(req, "let idleClockActive = false;");
-    httpd_resp_sendstr_chunk(req, "function toggleIdleClock() {");
-    httpd_resp_sendstr_chunk(req, "  const btn = document.getElementById('idleClockBtn');");
-    httpd_resp_sendstr_chunk(req, "  if (idleClockActive) {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Disabling idle clock...');");
-    httpd_resp_sendstr_chunk(req, "    fetch('/idle_clock?enable=0').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      console.log('Idle clock disabled:', d);");
-    httpd_resp_sendstr_chunk(req, "      idleClockActive = false;");
-    httpd_resp_sendstr_chunk(req, "      btn.innerHTML = '⏰ Đồng Hồ Chờ: TẮT';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.background = 'linear-gradient(145deg, #9e9e9e, #bdbdbd)';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.borderColor = '#616161';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  } else {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Enabling idle clock...');");
-    httpd_resp_sendstr_chunk(req, "    fetch('/idle_clock?enable=1').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      console.log('Idle clock enabled:', d);");
-    httpd_resp_sendstr_chunk(req, "      idleClockActive = true;");
-    httpd_resp_sendstr_chunk(req, "      btn.innerHTML = '⏰ Đồng Hồ Chờ: BẬT';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.background = 'linear-gradient(145deg, #2196f3, #42a5f5)';");
-    httpd_resp_sendstr_chunk(req, "      btn.style.borderColor = '#1976d2';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Update idle timeout JavaScript
-    httpd_resp_sendstr_chunk(req, "function updateIdleTimeout() {");
-    httpd_resp_sendstr_chunk(req, "  const minutes = document.getElementById('idleTimeoutInput').value;");
-    httpd_resp_sendstr_chunk(req, "  if (minutes < 5 || minutes > 180) {");
-    httpd_resp_sendstr_chunk(req, "    alert('Thời gian phải từ 5-180 phút!');");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  console.log('Setting idle timeout:', minutes, 'minutes');");
-    httpd_resp_sendstr_chunk(req, "  fetch('/idle_timeout?minutes=' + minutes).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Idle timeout result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Forget WiFi JavaScript
-    httpd_resp_sendstr_chunk(req, "function forgetWiFi() {");
-    httpd_resp_sendstr_chunk(req, "  if (confirm('Quên WiFi hiện tại và tạo Access Point?\\n\\nRobot sẽ khởi động lại và tạo AP để bạn có thể:\\n1. Kết nối vào AP của robot\\n2. Cấu hình WiFi mới qua trình duyệt\\n\\nBạn có chắc không?')) {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Forgetting WiFi and entering AP mode...');");
-    httpd_resp_sendstr_chunk(req, "    fetch('/forget_wifi').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "      console.log('Forget WiFi result:', d);");
-    httpd_resp_sendstr_chunk(req, "      alert('WiFi đã được quên!\\nRobot sẽ khởi động lại và tạo Access Point.\\nHãy kết nối vào AP của robot để cấu hình WiFi mới.');");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('response2').innerHTML = d;");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Volume control JavaScript
-    httpd_resp_sendstr_chunk(req, "function setVolume(volume) {");
-    httpd_resp_sendstr_chunk(req, "  console.log('Setting volume:', volume);");
-    httpd_resp_sendstr_chunk(req, "  fetch('/volume?level=' + volume).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    console.log('Volume result:', d);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response').innerHTML = 'Âm lượng: ' + volume + '%';");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Auto pose toggle JavaScript with pose selection
-    httpd_resp_sendstr_chunk(req, "var autoPoseEnabled = false;");
-    httpd_resp_sendstr_chunk(req, "var selectedPoses = ['sit','jump'  ,'wave','bow','stretch','swing','dance'];"); // Default all enabled
-    httpd_resp_sendstr_chunk(req, "function toggleAutoPose() {");
-    httpd_resp_sendstr_chunk(req, "  autoPoseEnabled = !autoPoseEnabled;");
-    httpd_resp_sendstr_chunk(req, "  var btn = document.getElementById('autoPoseBtn');");
-    httpd_resp_sendstr_chunk(req, "  var btn2 = document.getElementById('autoPoseBtn2');");
-    httpd_resp_sendstr_chunk(req, "  if (autoPoseEnabled) {");
-    httpd_resp_sendstr_chunk(req, "    if(btn) { btn.classList.add('active'); btn.style.background = '#4caf50'; btn.style.color = 'white'; }");
-    httpd_resp_sendstr_chunk(req, "    if(btn2) { btn2.classList.add('active'); btn2.style.background = '#4caf50'; btn2.style.color = 'white'; }");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response').innerHTML = '✅ Tự động đổi tư thế BẬT';");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('response2')) document.getElementById('response2').innerHTML = '✅ Tự động đổi tư thế BẬT';");
-    httpd_resp_sendstr_chunk(req, "  } else {");
-    httpd_resp_sendstr_chunk(req, "    if(btn) { btn.classList.remove('active'); btn.style.background = ''; btn.style.color = ''; }");
-    httpd_resp_sendstr_chunk(req, "    if(btn2) { btn2.classList.remove('active'); btn2.style.background = ''; btn2.style.color = ''; }");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response').innerHTML = '⛔ Tự động đổi tư thế TẮT';");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('response2')) document.getElementById('response2').innerHTML = '⛔ Tự động đổi tư thế TẮT';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    // Get selected poses
-    httpd_resp_sendstr_chunk(req, "  updateSelectedPoses();");
-    httpd_resp_sendstr_chunk(req, "  var posesParam = selectedPoses.join(',');");
-    httpd_resp_sendstr_chunk(req, "  fetch('/auto_pose?enabled=' + (autoPoseEnabled ? 'true' : 'false') + '&poses=' + posesParam).then(r => r.text()).then(d => console.log('Auto pose:', d));");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Update interval function
-    httpd_resp_sendstr_chunk(req, "function updateInterval() {");
-    httpd_resp_sendstr_chunk(req, "  var interval = document.getElementById('poseInterval').value;");
-    httpd_resp_sendstr_chunk(req, "  fetch('/auto_pose_interval?seconds=' + interval).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '⏱️ Đã đặt thời gian: ' + interval + ' giây';");
-    httpd_resp_sendstr_chunk(req, "    console.log('Interval updated:', d);");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Update selected poses
-    httpd_resp_sendstr_chunk(req, "function updateSelectedPoses() {");
-    httpd_resp_sendstr_chunk(req, "  selectedPoses = [];");
-    httpd_resp_sendstr_chunk(req, "  ['sit','jump','wave','bow','stretch','swing','dance'].forEach(p => {");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('pose_' + p) && document.getElementById('pose_' + p).checked) selectedPoses.push(p);");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Auto emoji toggle JavaScript with emoji selection
-    httpd_resp_sendstr_chunk(req, "var autoEmojiEnabled = false;");
-    httpd_resp_sendstr_chunk(req, "var selectedEmojis = ['happy','laughing','winking','cool','love','surprised','excited','sleepy','sad','angry','confused','thinking','neutral','shocked'];"); // Default all enabled
-    httpd_resp_sendstr_chunk(req, "function toggleAutoEmoji() {");
-    httpd_resp_sendstr_chunk(req, "  autoEmojiEnabled = !autoEmojiEnabled;");
-    httpd_resp_sendstr_chunk(req, "  var btn = document.getElementById('autoEmojiBtn');");
-    httpd_resp_sendstr_chunk(req, "  if (autoEmojiEnabled) {");
-    httpd_resp_sendstr_chunk(req, "    if(btn) { btn.classList.add('active'); btn.style.background = '#ff9800'; btn.style.color = 'white'; }");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('response2')) document.getElementById('response2').innerHTML = '✅ Tự động đổi biểu cảm BẬT';");
-    httpd_resp_sendstr_chunk(req, "  } else {");
-    httpd_resp_sendstr_chunk(req, "    if(btn) { btn.classList.remove('active'); btn.style.background = ''; btn.style.color = ''; }");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('response2')) document.getElementById('response2').innerHTML = '⛔ Tự động đổi biểu cảm TẮT';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    // Get selected emojis
-    httpd_resp_sendstr_chunk(req, "  updateSelectedEmojis();");
-    httpd_resp_sendstr_chunk(req, "  var emojisParam = selectedEmojis.join(',');");
-    httpd_resp_sendstr_chunk(req, "  fetch('/auto_emoji?enabled=' + (autoEmojiEnabled ? 'true' : 'false') + '&emojis=' + emojisParam).then(r => r.text()).then(d => console.log('Auto emoji:', d));");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Update emoji interval function
-    httpd_resp_sendstr_chunk(req, "function updateEmojiInterval() {");
-    httpd_resp_sendstr_chunk(req, "  var interval = document.getElementById('emojiInterval').value;");
-    httpd_resp_sendstr_chunk(req, "  fetch('/auto_emoji_interval?seconds=' + interval).then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response2').innerHTML = '⏱️ Đã đặt thời gian emoji: ' + interval + ' giây';");
-    httpd_resp_sendstr_chunk(req, "    console.log('Emoji interval updated:', d);");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Update selected emojis
-    httpd_resp_sendstr_chunk(req, "function updateSelectedEmojis() {");
-    httpd_resp_sendstr_chunk(req, "  selectedEmojis = [];");
-    httpd_resp_sendstr_chunk(req, "  ['happy','laughing','winking','cool','love','surprised','excited','sleepy','sad','angry','confused','thinking','neutral','shocked'].forEach(e => {");
-    httpd_resp_sendstr_chunk(req, "    if(document.getElementById('emoji_' + e) && document.getElementById('emoji_' + e).checked) selectedEmojis.push(e);");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Gemini API Key functions (REMOVED - Not needed)
-    /*
-    httpd_resp_sendstr_chunk(req, "function saveGeminiKey() {");
-    httpd_resp_sendstr_chunk(req, "  var apiKey = document.getElementById('geminiApiKey').value;");
-    httpd_resp_sendstr_chunk(req, "  if (!apiKey || apiKey.trim() === '') {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('geminiKeyStatus').innerHTML = '❌ Vui lòng nhập API key!';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('geminiKeyStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('geminiKeyStatus').innerHTML = '⏳ Đang lưu...';");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('geminiKeyStatus').style.color = '#666';");
-    httpd_resp_sendstr_chunk(req, "  fetch('/gemini_api_key', {");
-    httpd_resp_sendstr_chunk(req, "    method: 'POST',");
-    httpd_resp_sendstr_chunk(req, "    headers: {'Content-Type': 'application/json'},");
-    httpd_resp_sendstr_chunk(req, "    body: JSON.stringify({api_key: apiKey})");
-    httpd_resp_sendstr_chunk(req, "  }).then(r => r.json()).then(data => {");
-    httpd_resp_sendstr_chunk(req, "    if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').innerHTML = '✅ API key đã được lưu thành công!';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').style.color = '#4caf50';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiApiKey').value = '';");
-    httpd_resp_sendstr_chunk(req, "      loadGeminiKeyStatus();");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').innerHTML = '❌ Lỗi: ' + data.error;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  }).catch(e => {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('geminiKeyStatus').innerHTML = '❌ Lỗi kết nối: ' + e;");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('geminiKeyStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function loadGeminiKeyStatus() {");
-    httpd_resp_sendstr_chunk(req, "  fetch('/gemini_api_key').then(r => r.json()).then(data => {");
-    httpd_resp_sendstr_chunk(req, "    if (data.configured) {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').innerHTML = '✅ API key đã cấu hình: ' + data.key_preview;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').style.color = '#4caf50';");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').innerHTML = '⚠️ Chưa có API key. Nhập key để kích hoạt Gemini AI.';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('geminiKeyStatus').style.color = '#ff9800';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    */
-    
-    // AI text chat function - IMPROVED VERSION
-    httpd_resp_sendstr_chunk(req, "let chatHistory = [];");
-    httpd_resp_sendstr_chunk(req, "function addToChatHistory(sender, message) {");
-    httpd_resp_sendstr_chunk(req, "  chatHistory.push({sender, message, time: new Date().toLocaleTimeString('vi-VN', {hour: '2-digit', minute: '2-digit'})});");
-    httpd_resp_sendstr_chunk(req, "  if(chatHistory.length > 20) chatHistory.shift();");
-    httpd_resp_sendstr_chunk(req, "  updateChatDisplay();");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function updateChatDisplay() {");
-    httpd_resp_sendstr_chunk(req, "  const historyDiv = document.getElementById('chat-history');");
-    httpd_resp_sendstr_chunk(req, "  if(chatHistory.length === 0) {");
-    httpd_resp_sendstr_chunk(req, "    historyDiv.innerHTML = '<div style=\"color:#999;text-align:center;\">💬 Lịch sử chat sẽ hiển thị ở đây...</div>';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  let html = '';");
-    httpd_resp_sendstr_chunk(req, "  chatHistory.forEach(c => {");
-    httpd_resp_sendstr_chunk(req, "    const isUser = c.sender === 'user';");
-    httpd_resp_sendstr_chunk(req, "    const align = isUser ? 'right' : 'left';");
-    httpd_resp_sendstr_chunk(req, "    const bg = isUser ? '#1976d2' : '#e0e0e0';");
-    httpd_resp_sendstr_chunk(req, "    const color = isUser ? 'white' : '#333';");
-    httpd_resp_sendstr_chunk(req, "    const icon = isUser ? '👤' : '🤖';");
-    httpd_resp_sendstr_chunk(req, "    html += `<div style='text-align:${align};margin:5px 0;'><span style='display:inline-block;max-width:80%;padding:8px 12px;border-radius:12px;background:${bg};color:${color};font-size:13px;'>${icon} ${c.message}<span style='font-size:10px;opacity:0.7;margin-left:8px;'>${c.time}</span></span></div>`;");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "  historyDiv.innerHTML = html;");
-    httpd_resp_sendstr_chunk(req, "  historyDiv.scrollTop = historyDiv.scrollHeight;");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function clearChatHistory() {");
-    httpd_resp_sendstr_chunk(req, "  chatHistory = [];");
-    httpd_resp_sendstr_chunk(req, "  updateChatDisplay();");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('ai-text-status').innerHTML = '🗑️ Đã xóa lịch sử chat';");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function quickSend(text) {");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('ai_text_input').value = text;");
-    httpd_resp_sendstr_chunk(req, "  sendTextToAI();");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "async function sendTextToAI() {");
-    httpd_resp_sendstr_chunk(req, "  const input = document.getElementById('ai_text_input');");
-    httpd_resp_sendstr_chunk(req, "  let text = input.value.trim();");
-    httpd_resp_sendstr_chunk(req, "  if (!text) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').innerHTML = '⚠️ Vui lòng nhập tin nhắn';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').style.background = '#fff3e0';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').style.color = '#e65100';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    // Add text length validation - max 1500 characters (same as MAX_TEXT_LENGTH in application.cc)
-    httpd_resp_sendstr_chunk(req, "  const maxLen = 1500;");
-    httpd_resp_sendstr_chunk(req, "  if (text.length > maxLen) {");
-    httpd_resp_sendstr_chunk(req, "    text = text.substring(0, maxLen);");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').innerHTML = '⚠️ Tin nhắn quá dài, đã cắt bớt còn ' + maxLen + ' ký tự';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').style.background = '#fff3e0';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('ai-text-status').style.color = '#e65100';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  addToChatHistory('user', text);");
-    httpd_resp_sendstr_chunk(req, "  input.value = '';");
-    httpd_resp_sendstr_chunk(req, "  const statusDiv = document.getElementById('ai-text-status');");
-    httpd_resp_sendstr_chunk(req, "  statusDiv.innerHTML = '⏳ Đang gửi đến Kiki...';");
-    httpd_resp_sendstr_chunk(req, "  statusDiv.style.background = '#e3f2fd';");
-    httpd_resp_sendstr_chunk(req, "  statusDiv.style.color = '#1976d2';");
-    httpd_resp_sendstr_chunk(req, "  try {");
-    httpd_resp_sendstr_chunk(req, "    const res = await fetch('/api/ai/send', {");
-    httpd_resp_sendstr_chunk(req, "      method: 'POST',");
-    httpd_resp_sendstr_chunk(req, "      headers: {'Content-Type': 'application/json'},");
-    httpd_resp_sendstr_chunk(req, "      body: JSON.stringify({ text: text })");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "    const data = await res.json();");
-    httpd_resp_sendstr_chunk(req, "    if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.innerHTML = '✅ Kiki đã nhận tin nhắn! Đang xử lý...';");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.style.background = '#e8f5e9';");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.style.color = '#2e7d32';");
-    httpd_resp_sendstr_chunk(req, "      addToChatHistory('kiki', 'Đang trả lời...');");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.innerHTML = '❌ Lỗi: ' + data.message;");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "      statusDiv.style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  } catch (e) {");
-    httpd_resp_sendstr_chunk(req, "    statusDiv.innerHTML = '❌ Lỗi kết nối: ' + e.message;");
-    httpd_resp_sendstr_chunk(req, "    statusDiv.style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "    statusDiv.style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "document.getElementById('ai_text_input').addEventListener('keydown', function(e) {");
-    httpd_resp_sendstr_chunk(req, "  if (e.key === 'Enter' && !e.shiftKey) {");
-    httpd_resp_sendstr_chunk(req, "    e.preventDefault();");
-    httpd_resp_sendstr_chunk(req, "    sendTextToAI();");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "});");
-    
-    // Character counter function for AI text input
-    httpd_resp_sendstr_chunk(req, "function updateCharCount() {");
-    httpd_resp_sendstr_chunk(req, "  const input = document.getElementById('ai_text_input');");
-    httpd_resp_sendstr_chunk(req, "  const counter = document.getElementById('char-counter');");
-    httpd_resp_sendstr_chunk(req, "  const len = input.value.length;");
-    httpd_resp_sendstr_chunk(req, "  counter.textContent = len + ' / 1500 ký tự';");
-    httpd_resp_sendstr_chunk(req, "  if (len > 1400) { counter.style.color = '#f44336'; }");
-    httpd_resp_sendstr_chunk(req, "  else if (len > 1200) { counter.style.color = '#ff9800'; }");
-    httpd_resp_sendstr_chunk(req, "  else { counter.style.color = '#666'; }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Schedule Message JavaScript functions - với ngày tháng năm giờ phút
-    httpd_resp_sendstr_chunk(req, "let scheduleActive = false;");
-    httpd_resp_sendstr_chunk(req, "let countdownInterval = null;");
-    httpd_resp_sendstr_chunk(req, "let targetTimestamp = 0;");
-    httpd_resp_sendstr_chunk(req, "let currentScheduleMode = 'alarm';");
-    
-    // Update schedule mode when radio button changes
-    httpd_resp_sendstr_chunk(req, "function updateScheduleMode() {");
-    httpd_resp_sendstr_chunk(req, "  const mode = document.querySelector('input[name=\"schedule_mode\"]:checked').value;");
-    httpd_resp_sendstr_chunk(req, "  currentScheduleMode = mode;");
-    httpd_resp_sendstr_chunk(req, "  const msgSection = document.getElementById('message_input_section');");
-    httpd_resp_sendstr_chunk(req, "  const startBtn = document.getElementById('scheduleStartBtn');");
-    httpd_resp_sendstr_chunk(req, "  if (mode === 'message') {");
-    httpd_resp_sendstr_chunk(req, "    msgSection.style.display = 'block';");
-    httpd_resp_sendstr_chunk(req, "    startBtn.innerHTML = '💬 Hẹn Gửi Tin Nhắn';");
-    httpd_resp_sendstr_chunk(req, "    startBtn.style.background = 'linear-gradient(145deg, #2196f3, #64b5f6)';");
-    httpd_resp_sendstr_chunk(req, "  } else {");
-    httpd_resp_sendstr_chunk(req, "    msgSection.style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "    startBtn.innerHTML = '🔔 Đặt Báo Thức';");
-    httpd_resp_sendstr_chunk(req, "    startBtn.style.background = 'linear-gradient(145deg, #4caf50, #66bb6a)';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Initialize date/time inputs với thời gian hiện tại + 5 phút
-    httpd_resp_sendstr_chunk(req, "function initScheduleDateTime() {");
-    httpd_resp_sendstr_chunk(req, "  const now = new Date();");
-    httpd_resp_sendstr_chunk(req, "  now.setMinutes(now.getMinutes() + 5);");
-    httpd_resp_sendstr_chunk(req, "  const dateStr = now.toISOString().split('T')[0];");
-    httpd_resp_sendstr_chunk(req, "  const timeStr = now.toTimeString().slice(0,5);");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('schedule_date').value = dateStr;");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('schedule_time').value = timeStr;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Đặt nhanh thời gian: thêm X phút vào thời gian hiện tại
-    httpd_resp_sendstr_chunk(req, "function setQuickSchedule(minutes) {");
-    httpd_resp_sendstr_chunk(req, "  const now = new Date();");
-    httpd_resp_sendstr_chunk(req, "  now.setMinutes(now.getMinutes() + minutes);");
-    httpd_resp_sendstr_chunk(req, "  const dateStr = now.toISOString().split('T')[0];");
-    httpd_resp_sendstr_chunk(req, "  const timeStr = now.toTimeString().slice(0,5);");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('schedule_date').value = dateStr;");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('schedule_time').value = timeStr;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function formatTime(totalSeconds) {");
-    httpd_resp_sendstr_chunk(req, "  if (totalSeconds < 0) totalSeconds = 0;");
-    httpd_resp_sendstr_chunk(req, "  const d = Math.floor(totalSeconds / 86400);");
-    httpd_resp_sendstr_chunk(req, "  const h = Math.floor((totalSeconds % 86400) / 3600);");
-    httpd_resp_sendstr_chunk(req, "  const m = Math.floor((totalSeconds % 3600) / 60);");
-    httpd_resp_sendstr_chunk(req, "  const s = totalSeconds % 60;");
-    httpd_resp_sendstr_chunk(req, "  if (d > 0) return d + ' ngày ' + String(h).padStart(2,'0') + ':' + String(m).padStart(2,'0') + ':' + String(s).padStart(2,'0');");
-    httpd_resp_sendstr_chunk(req, "  return String(h).padStart(2,'0') + ':' + String(m).padStart(2,'0') + ':' + String(s).padStart(2,'0');");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function formatDateTime(timestamp) {");
-    httpd_resp_sendstr_chunk(req, "  const d = new Date(timestamp * 1000);");
-    httpd_resp_sendstr_chunk(req, "  return d.toLocaleDateString('vi-VN') + ' ' + d.toLocaleTimeString('vi-VN', {hour:'2-digit', minute:'2-digit'});");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function updateCountdown() {");
-    httpd_resp_sendstr_chunk(req, "  const now = Math.floor(Date.now() / 1000);");
-    httpd_resp_sendstr_chunk(req, "  const remaining = targetTimestamp - now;");
-    httpd_resp_sendstr_chunk(req, "  if (remaining <= 0) {");
-    httpd_resp_sendstr_chunk(req, "    clearInterval(countdownInterval);");
-    httpd_resp_sendstr_chunk(req, "    scheduleActive = false;");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-countdown').style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('scheduleStartBtn').style.display = 'block';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('scheduleCancelBtn').style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "    const msg = currentScheduleMode === 'alarm' ? '🔔 Báo thức đã reo!' : '✅ Tin nhắn đã được gửi!';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').innerHTML = msg;");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.background = '#e8f5e9';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.color = '#2e7d32';");
-    httpd_resp_sendstr_chunk(req, "    updateScheduleMode();");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('countdown-time').textContent = formatTime(remaining);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "async function startSchedule() {");
-    httpd_resp_sendstr_chunk(req, "  const mode = currentScheduleMode;");
-    httpd_resp_sendstr_chunk(req, "  let message = '';");
-    httpd_resp_sendstr_chunk(req, "  if (mode === 'message') {");
-    httpd_resp_sendstr_chunk(req, "    message = document.getElementById('schedule_message').value.trim();");
-    httpd_resp_sendstr_chunk(req, "    if (!message) {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').innerHTML = '⚠️ Vui lòng nhập tin nhắn!';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "      return;");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  const dateVal = document.getElementById('schedule_date').value;");
-    httpd_resp_sendstr_chunk(req, "  const timeVal = document.getElementById('schedule_time').value;");
-    httpd_resp_sendstr_chunk(req, "  if (!dateVal || !timeVal) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').innerHTML = '⚠️ Vui lòng chọn ngày và giờ!';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  const targetDate = new Date(dateVal + 'T' + timeVal + ':00');");
-    httpd_resp_sendstr_chunk(req, "  const targetTs = Math.floor(targetDate.getTime() / 1000);");
-    httpd_resp_sendstr_chunk(req, "  const nowTs = Math.floor(Date.now() / 1000);");
-    httpd_resp_sendstr_chunk(req, "  const totalSeconds = targetTs - nowTs;");
-    httpd_resp_sendstr_chunk(req, "  if (totalSeconds < 10) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').innerHTML = '⚠️ Thời gian phải ít nhất 10 giây trong tương lai!';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  try {");
-    httpd_resp_sendstr_chunk(req, "    const actionSlot = parseInt(document.getElementById('schedule_action_slot').value) || 0;");
-    httpd_resp_sendstr_chunk(req, "    const res = await fetch('/schedule_message', {");
-    httpd_resp_sendstr_chunk(req, "      method: 'POST',");
-    httpd_resp_sendstr_chunk(req, "      headers: {'Content-Type': 'application/json'},");
-    httpd_resp_sendstr_chunk(req, "      body: JSON.stringify({ message: message, seconds: totalSeconds, target_timestamp: targetTs, mode: mode, action_slot: actionSlot })");
-    httpd_resp_sendstr_chunk(req, "    });");
-    httpd_resp_sendstr_chunk(req, "    const data = await res.json();");
-    httpd_resp_sendstr_chunk(req, "    if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "      scheduleActive = true;");
-    httpd_resp_sendstr_chunk(req, "      targetTimestamp = targetTs;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-countdown').style.display = 'block';");
-    httpd_resp_sendstr_chunk(req, "      const modeLabel = mode === 'alarm' ? '🔔 Báo thức lúc: ' : '💬 Gửi tin nhắn lúc: ';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('countdown-mode-label').innerHTML = modeLabel + '<span id=\"target-datetime\">' + formatDateTime(targetTs) + '</span>';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('countdown-time').textContent = formatTime(totalSeconds);");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('scheduleStartBtn').style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('scheduleCancelBtn').style.display = 'block';");
-    httpd_resp_sendstr_chunk(req, "      const statusMsg = mode === 'alarm' ? '🔔 Đang đếm ngược... Kiki sẽ reo chuông!' : '💬 Đang đếm ngược... Kiki sẽ gửi tin nhắn!';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').innerHTML = statusMsg;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.background = '#e3f2fd';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.color = '#1976d2';");
-    httpd_resp_sendstr_chunk(req, "      countdownInterval = setInterval(updateCountdown, 1000);");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').innerHTML = '❌ Lỗi: ' + data.message;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.color = '#c62828';");;
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  } catch (e) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').innerHTML = '❌ Lỗi kết nối: ' + e.message;");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.background = '#ffebee';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('schedule-status').style.color = '#c62828';");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "async function cancelSchedule() {");
-    httpd_resp_sendstr_chunk(req, "  try {");
-    httpd_resp_sendstr_chunk(req, "    const res = await fetch('/schedule_message?action=cancel');");
-    httpd_resp_sendstr_chunk(req, "    const data = await res.json();");
-    httpd_resp_sendstr_chunk(req, "    if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "      if (countdownInterval) clearInterval(countdownInterval);");
-    httpd_resp_sendstr_chunk(req, "      scheduleActive = false;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-countdown').style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('scheduleStartBtn').style.display = 'block';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('scheduleCancelBtn').style.display = 'none';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').innerHTML = '⏹️ Đã hủy hẹn giờ';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.background = '#fff3e0';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('schedule-status').style.color = '#e65100';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  } catch (e) {");
-    httpd_resp_sendstr_chunk(req, "    console.error('Cancel error:', e);");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // MQTT Configuration JavaScript functions
-    httpd_resp_sendstr_chunk(req, "function saveMqttConfig() {");
-    httpd_resp_sendstr_chunk(req, "  const endpoint = document.getElementById('mqttEndpoint').value.trim();");
-    httpd_resp_sendstr_chunk(req, "  if (!endpoint) {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('mqttConfigStatus').innerHTML = '❌ Endpoint là bắt buộc!';");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('mqttConfigStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "    return;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "  const config = {");
-    httpd_resp_sendstr_chunk(req, "    endpoint: endpoint,");
-    httpd_resp_sendstr_chunk(req, "    client_id: document.getElementById('mqttClientId').value.trim(),");
-    httpd_resp_sendstr_chunk(req, "    username: document.getElementById('mqttUsername').value.trim(),");
-    httpd_resp_sendstr_chunk(req, "    password: document.getElementById('mqttPassword').value.trim(),");
-    httpd_resp_sendstr_chunk(req, "    publish_topic: document.getElementById('mqttPublishTopic').value.trim()");
-    httpd_resp_sendstr_chunk(req, "  };");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('mqttConfigStatus').innerHTML = '⏳ Đang lưu...';");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('mqttConfigStatus').style.color = '#666';");
-    httpd_resp_sendstr_chunk(req, "  fetch('/mqtt_config', {");
-    httpd_resp_sendstr_chunk(req, "    method: 'POST',");
-    httpd_resp_sendstr_chunk(req, "    headers: {'Content-Type': 'application/json'},");
-    httpd_resp_sendstr_chunk(req, "    body: JSON.stringify(config)");
-    httpd_resp_sendstr_chunk(req, "  }).then(r => r.json()).then(data => {");
-    httpd_resp_sendstr_chunk(req, "    if (data.success) {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').innerHTML = '✅ Cấu hình MQTT đã được lưu thành công! Robot sẽ tự động kết nối lại.';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').style.color = '#4caf50';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttPassword').value = '';");
-    httpd_resp_sendstr_chunk(req, "      loadMqttConfig();");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').innerHTML = '❌ Lỗi: ' + data.error;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  }).catch(e => {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('mqttConfigStatus').innerHTML = '❌ Lỗi kết nối: ' + e;");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('mqttConfigStatus').style.color = '#f44336';");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function loadMqttConfig() {");
-    httpd_resp_sendstr_chunk(req, "  fetch('/mqtt_config').then(r => r.json()).then(data => {");
-    httpd_resp_sendstr_chunk(req, "    if (data.configured) {");
-    httpd_resp_sendstr_chunk(req, "      if (data.endpoint) document.getElementById('mqttEndpoint').value = data.endpoint;");
-    httpd_resp_sendstr_chunk(req, "      if (data.client_id) document.getElementById('mqttClientId').value = data.client_id;");
-    httpd_resp_sendstr_chunk(req, "      if (data.username) document.getElementById('mqttUsername').value = data.username;");
-    httpd_resp_sendstr_chunk(req, "      if (data.publish_topic) document.getElementById('mqttPublishTopic').value = data.publish_topic;");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').innerHTML = '✅ MQTT đã được cấu hình. Endpoint: ' + (data.endpoint || 'N/A');");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').style.color = '#4caf50';");
-    httpd_resp_sendstr_chunk(req, "    } else {");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').innerHTML = '⚠️ Chưa có cấu hình MQTT. Vui lòng nhập endpoint để kết nối.';");
-    httpd_resp_sendstr_chunk(req, "      document.getElementById('mqttConfigStatus').style.color = '#ff9800';");
-    httpd_resp_sendstr_chunk(req, "    }");
-    httpd_resp_sendstr_chunk(req, "  }).catch(e => {");
-    httpd_resp_sendstr_chunk(req, "    console.error('Error loading MQTT config:', e);");
-    httpd_resp_sendstr_chunk(req, "  });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Drawing canvas JavaScript
-    httpd_resp_sendstr_chunk(req, "var drawCanvas, drawCtx, isDrawing = false;");
-    httpd_resp_sendstr_chunk(req, "var currentColor = '#000000';");
-    httpd_resp_sendstr_chunk(req, "var brushSize = 5;");
-    httpd_resp_sendstr_chunk(req, "var lastX = 0, lastY = 0;");
-    
-    httpd_resp_sendstr_chunk(req, "function initCanvas() {");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas = document.getElementById('drawCanvas');");
-    httpd_resp_sendstr_chunk(req, "  if (!drawCanvas) return;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx = drawCanvas.getContext('2d');");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.fillStyle = '#ffffff';");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.fillRect(0, 0, 240, 240);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineCap = 'round';");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineJoin = 'round';");
-    // Mouse events
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('mousedown', startDraw);");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('mousemove', draw);");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('mouseup', stopDraw);");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('mouseout', stopDraw);");
-    // Touch events
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('touchstart', handleTouchStart, {passive: false});");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('touchmove', handleTouchMove, {passive: false});");
-    httpd_resp_sendstr_chunk(req, "  drawCanvas.addEventListener('touchend', stopDraw);");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function getPos(e) {");
-    httpd_resp_sendstr_chunk(req, "  var rect = drawCanvas.getBoundingClientRect();");
-    httpd_resp_sendstr_chunk(req, "  var scaleX = 240 / rect.width;");
-    httpd_resp_sendstr_chunk(req, "  var scaleY = 240 / rect.height;");
-    httpd_resp_sendstr_chunk(req, "  return { x: (e.clientX - rect.left) * scaleX, y: (e.clientY - rect.top) * scaleY };");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function startDraw(e) {");
-    httpd_resp_sendstr_chunk(req, "  isDrawing = true;");
-    httpd_resp_sendstr_chunk(req, "  var pos = getPos(e);");
-    httpd_resp_sendstr_chunk(req, "  lastX = pos.x; lastY = pos.y;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function draw(e) {");
-    httpd_resp_sendstr_chunk(req, "  if (!isDrawing) return;");
-    httpd_resp_sendstr_chunk(req, "  var pos = getPos(e);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.strokeStyle = currentColor;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineWidth = brushSize;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.beginPath();");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.moveTo(lastX, lastY);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineTo(pos.x, pos.y);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.stroke();");
-    httpd_resp_sendstr_chunk(req, "  lastX = pos.x; lastY = pos.y;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function stopDraw() { isDrawing = false; }");
-    
-    httpd_resp_sendstr_chunk(req, "function handleTouchStart(e) {");
-    httpd_resp_sendstr_chunk(req, "  e.preventDefault();");
-    httpd_resp_sendstr_chunk(req, "  var touch = e.touches[0];");
-    httpd_resp_sendstr_chunk(req, "  var rect = drawCanvas.getBoundingClientRect();");
-    httpd_resp_sendstr_chunk(req, "  var scaleX = 240 / rect.width;");
-    httpd_resp_sendstr_chunk(req, "  var scaleY = 240 / rect.height;");
-    httpd_resp_sendstr_chunk(req, "  isDrawing = true;");
-    httpd_resp_sendstr_chunk(req, "  lastX = (touch.clientX - rect.left) * scaleX;");
-    httpd_resp_sendstr_chunk(req, "  lastY = (touch.clientY - rect.top) * scaleY;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function handleTouchMove(e) {");
-    httpd_resp_sendstr_chunk(req, "  e.preventDefault();");
-    httpd_resp_sendstr_chunk(req, "  if (!isDrawing) return;");
-    httpd_resp_sendstr_chunk(req, "  var touch = e.touches[0];");
-    httpd_resp_sendstr_chunk(req, "  var rect = drawCanvas.getBoundingClientRect();");
-    httpd_resp_sendstr_chunk(req, "  var scaleX = 240 / rect.width;");
-    httpd_resp_sendstr_chunk(req, "  var scaleY = 240 / rect.height;");
-    httpd_resp_sendstr_chunk(req, "  var x = (touch.clientX - rect.left) * scaleX;");
-    httpd_resp_sendstr_chunk(req, "  var y = (touch.clientY - rect.top) * scaleY;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.strokeStyle = currentColor;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineWidth = brushSize;");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.beginPath();");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.moveTo(lastX, lastY);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.lineTo(x, y);");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.stroke();");
-    httpd_resp_sendstr_chunk(req, "  lastX = x; lastY = y;");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function setColor(color) { currentColor = color; }");
-    httpd_resp_sendstr_chunk(req, "function updateBrushSize() {");
-    httpd_resp_sendstr_chunk(req, "  brushSize = document.getElementById('brushSize').value;");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('brushSizeValue').textContent = brushSize + 'px';");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function clearCanvas() {");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.fillStyle = '#ffffff';");
-    httpd_resp_sendstr_chunk(req, "  drawCtx.fillRect(0, 0, 240, 240);");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('response4').textContent = '🗑️ Đã xóa canvas!';");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    httpd_resp_sendstr_chunk(req, "function sendDrawing() {");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('response4').textContent = '📤 Đang gửi...';");
-    httpd_resp_sendstr_chunk(req, "  var imageData = drawCtx.getImageData(0, 0, 240, 240);");
-    httpd_resp_sendstr_chunk(req, "  var data = imageData.data;");
-    // Convert RGBA to RGB565
-    httpd_resp_sendstr_chunk(req, "  var rgb565 = new Uint16Array(240 * 240);");
-    httpd_resp_sendstr_chunk(req, "  for (var i = 0; i < 240 * 240; i++) {");
-    httpd_resp_sendstr_chunk(req, "    var r = data[i * 4] >> 3;");
-    httpd_resp_sendstr_chunk(req, "    var g = data[i * 4 + 1] >> 2;");
-    httpd_resp_sendstr_chunk(req, "    var b = data[i * 4 + 2] >> 3;");
-    httpd_resp_sendstr_chunk(req, "    rgb565[i] = (r << 11) | (g << 5) | b;");
-    httpd_resp_sendstr_chunk(req, "  }");
-    // Send as binary
-    httpd_resp_sendstr_chunk(req, "  fetch('/draw', { method: 'POST', body: rgb565.buffer, headers: {'Content-Type': 'application/octet-stream'} })");
-    httpd_resp_sendstr_chunk(req, "  .then(r => r.text())");
-    httpd_resp_sendstr_chunk(req, "  .then(d => { document.getElementById('response4').textContent = '✅ ' + d; })");
-    httpd_resp_sendstr_chunk(req, "  .catch(e => { document.getElementById('response4').textContent = '❌ Lỗi: ' + e; });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Exit drawing mode and return to emoji
-    httpd_resp_sendstr_chunk(req, "function exitDrawing() {");
-    httpd_resp_sendstr_chunk(req, "  document.getElementById('response4').textContent = '↩️ Đang quay lại...';");
-    httpd_resp_sendstr_chunk(req, "  fetch('/draw_exit').then(r => r.text()).then(d => {");
-    httpd_resp_sendstr_chunk(req, "    document.getElementById('response4').textContent = '✅ ' + d;");
-    httpd_resp_sendstr_chunk(req, "  }).catch(e => { document.getElementById('response4').textContent = '❌ Lỗi: ' + e; });");
-    httpd_resp_sendstr_chunk(req, "}");
-    
-    // Initialize volume slider and schedule date/time
-    httpd_resp_sendstr_chunk(req, "window.onload = function() {");
-    httpd_resp_sendstr_chunk(req, "  loadMqttConfig();");
-    httpd_resp_sendstr_chunk(req, "  initScheduleDateTime();");
-    httpd_resp_sendstr_chunk(req, "  initCanvas();");
-    httpd_resp_sendstr_chunk(req, "  var slider = document.getElementById('volumeSlider');");
-    httpd_resp_sendstr_chunk(req, "  var output = document.getElementById('volumeValue');");
-    httpd_resp_sendstr_chunk(req, "  slider.oninput = function() {");
-    httpd_resp_sendstr_chunk(req, "    output.innerHTML = this.value + '%';");
-    httpd_resp_sendstr_chunk(req, "    setVolume(this.value);");
-    httpd_resp_sendstr_chunk(req, "  }");
-    httpd_resp_sendstr_chunk(req, "};");
-    httpd_resp_sendstr_chunk(req, "</script>");
-    httpd_resp_sendstr_chunk(req, "</body></html>");
-    
-    httpd_resp_sendstr_chunk(req, NULL); // End of chunks
-}
-
 // Root page handler
 esp_err_t otto_root_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "Root page requested");
     webserver_reset_auto_stop_timer();  // Reset 5-minute timer on page access
-    send_otto_control_page(req);
-    return ESP_OK;
+    return web_ui_send_page(req, WebUiPage::kControl);
 }
 
 } // extern "C"
 
-// C++ function to execute Otto actions (with real controller integration)
-void otto_execute_web_action(const char* action, int param1, int param2) {
-    ESP_LOGI(TAG, "🎮 Web Control: %s (param1:%d, param2:%d)", action, param1, param2);
-    
-    // Map web actions to controller actions (order matters - check specific first)
+// Run one compiled action (opcode from otto_action_program.h) on the controller
+static void otto_execute_web_op(uint8_t op, int param1, int param2) {
     esp_err_t ret = ESP_OK;
     
-    if (strstr(action, "walk_back")) {
-        ret = otto_controller_queue_action(ACTION_DOG_WALK_BACK, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Walking backward: %d steps, speed %d", param1, param2);
-    } else if (strstr(action, "walk_forward") || strstr(action, "walk")) {
-        ret = otto_controller_queue_action(ACTION_DOG_WALK, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Walking forward: %d steps, speed %d", param1, param2);
-    } else if (strstr(action, "turn_left") || (strstr(action, "turn") && param1 < 0)) {
-        ret = otto_controller_queue_action(ACTION_DOG_TURN_LEFT, abs(param1), param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Turning left: %d steps, speed %d", abs(param1), param2);
-    } else if (strstr(action, "turn_right") || (strstr(action, "turn") && param1 > 0)) {
-        ret = otto_controller_queue_action(ACTION_DOG_TURN_RIGHT, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Turning right: %d steps, speed %d", param1, param2);
-    } else if (strstr(action, "turn")) {
-        // Default turn right if no direction specified
-        ret = otto_controller_queue_action(ACTION_DOG_TURN_RIGHT, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Turning right (default): %d steps, speed %d", param1, param2);
-    } else if (strstr(action, "sit")) {
-        ret = otto_controller_queue_action(ACTION_DOG_SIT_DOWN, 1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Sitting down with delay %d", param2);
-    } else if (strstr(action, "lie")) {
-        ret = otto_controller_queue_action(ACTION_DOG_LIE_DOWN, 1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Lying down with delay %d", param2);
-    } else if (strstr(action, "bow")) {
-        ret = otto_controller_queue_action(ACTION_DOG_BOW, 1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Bowing with delay %d", param2);
-    } else if (strstr(action, "jump")) {
-        // Angry emoji when jumping
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("angry");
-        ret = otto_controller_queue_action(ACTION_DOG_JUMP, 1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Jumping with delay %d", param2);
-    } else if (strstr(action, "dance")) {
-        // Happy emoji when dancing
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        ret = otto_controller_queue_action(ACTION_DOG_DANCE, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Dancing: %d cycles, speed %d", param1, param2);
-    } else if (strstr(action, "wave")) {
-        ret = otto_controller_queue_action(ACTION_DOG_WAVE_RIGHT_FOOT, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Waving: %d times, speed %d", param1, param2);
-    } else if (strstr(action, "swing")) {
-        // Happy emoji when swinging
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        ret = otto_controller_queue_action(ACTION_DOG_SWING, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Swinging: %d cycles, speed %d", param1, param2);
-    } else if (strstr(action, "stretch")) {
-        // Sleepy emoji during stretch
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("sleepy");
-        ret = otto_controller_queue_action(ACTION_DOG_STRETCH, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Stretching: %d cycles, speed %d", param1, param2);
-    } else if (strstr(action, "scratch")) {
-        ret = otto_controller_queue_action(ACTION_DOG_SCRATCH, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Scratching: %d times, speed %d", param1, param2);
-    } else if (strstr(action, "wag_tail")) {
-        // Happy emoji when wagging tail
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        ret = otto_controller_queue_action(ACTION_DOG_WAG_TAIL, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🐕 Wagging tail: %d wags, speed %d", param1, param2);
-    } else if (strstr(action, "defend")) {
-        // Shocked emoji when defending
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("shocked");
-        // Defend sequence: walk back EXACTLY 1 journey -> sit (3000) -> lie (1500) -> delay(3000) -> home
-        otto_controller_queue_action(ACTION_DOG_WALK_BACK, 1, 100, 0, 0);  // Changed: speed=100 for full 1 journey
-        otto_controller_queue_action(ACTION_DOG_SIT_DOWN, 1, 3000, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_LIE_DOWN, 1, 1500, 0, 0);
-        otto_controller_queue_action(ACTION_DELAY, 0, 3000, 0, 0);
-        otto_controller_queue_action(ACTION_HOME, 1, 500, 0, 0);
-        ret = ESP_OK;
-        ESP_LOGI(TAG, "🛡️ Defend sequence queued: walk_back(1,100) -> sit(3000) -> lie_down(1500) -> delay(3000) -> home");
-    } else if (strstr(action, "home")) {
-        ret = otto_controller_queue_action(ACTION_HOME, 1, param2, 0, 0);
-        ESP_LOGI(TAG, "🏠 Going to home position with speed %d", param2);
-    } else if (strstr(action, "dance_4_feet")) {
-        // Happy emoji when dancing with 4 feet
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        ret = otto_controller_queue_action(ACTION_DOG_DANCE_4_FEET, param1, param2, 0, 0);
-        ESP_LOGI(TAG, "🕺 Dancing with 4 feet: %d cycles, speed %d", param1, param2);
-    } else if (strstr(action, "greet")) {
-        // Happy emoji when greeting
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        // Greet sequence: home → wave → bow
-        otto_controller_queue_action(ACTION_HOME, 1, 500, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_WAVE_RIGHT_FOOT, 3, 150, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_BOW, 2, 150, 0, 0);
-        ret = ESP_OK;
-        ESP_LOGI(TAG, "👋 Greet sequence queued: home → wave → bow");
-    } else if (strstr(action, "attack")) {
-        // Angry emoji when attacking
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("angry");
-        // Attack sequence: forward → jump → bow
-        otto_controller_queue_action(ACTION_DOG_WALK, 2, 100, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_JUMP, 2, 200, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_BOW, 1, 150, 0, 0);
-        ret = ESP_OK;
-        ESP_LOGI(TAG, "⚔️ Attack sequence queued: forward → jump → bow");
-    } else if (strstr(action, "celebrate")) {
-        // Happy emoji when celebrating
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("happy");
-        // Celebrate sequence: dance → wave → swing
-        otto_controller_queue_action(ACTION_DOG_DANCE, 2, 200, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_WAVE_RIGHT_FOOT, 5, 100, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_SWING, 3, 10, 0, 0);  // Changed from 150 to 10 for faster swing
-        ret = ESP_OK;
-        ESP_LOGI(TAG, "🎉 Celebrate sequence queued: dance → wave → swing");
-    } else if (strstr(action, "search")) {
-        // Scared emoji when searching (cautious)
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("scared");
-        // Search sequence: look left → look right → walk forward
-        otto_controller_queue_action(ACTION_DOG_TURN_LEFT, 2, 150, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_TURN_RIGHT, 4, 150, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_TURN_LEFT, 2, 150, 0, 0);
-        otto_controller_queue_action(ACTION_DOG_WALK, 3, 120, 0, 0);
-        ret = ESP_OK;
-        ESP_LOGI(TAG, "🔍 Search sequence queued: look around → walk forward");
-    } else if (strstr(action, "roll_over")) {
-        // Excited emoji when rolling over
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("excited");
-        ret = otto_controller_queue_action(ACTION_DOG_ROLL_OVER, param1 > 0 ? param1 : 1, param2 > 0 ? param2 : 200, 0, 0);
-        ESP_LOGI(TAG, "🐕 Rolling over: %d rolls, speed %d", param1 > 0 ? param1 : 1, param2 > 0 ? param2 : 200);
-    } else if (strstr(action, "play_dead")) {
-        // Shocked emoji when playing dead
-        if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion("shocked");
-        ret = otto_controller_queue_action(ACTION_DOG_PLAY_DEAD, 1, param1 > 0 ? param1 : 5, 0, 0);
-        ESP_LOGI(TAG, "💀 Playing dead for %d seconds", param1 > 0 ? param1 : 5);
-    } else if (strstr(action, "shake_paw")) {
-        ret = otto_controller_queue_action(ACTION_DOG_SHAKE_PAW, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150, 0, 0);
-        ESP_LOGI(TAG, "🤝 Shaking paw: %d shakes, speed %d", param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150);
-    // Removed sidestep actions (tools deleted to stay under 32 limit)
-    /*
-    } else if (strstr(action, "sidestep_right")) {
-        ret = otto_controller_queue_action(ACTION_DOG_SIDESTEP, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 80, 1, 0);  // direction = 1 (right)
-        ESP_LOGI(TAG, "➡️ Sidestepping right: %d steps, speed %d", param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 80);
-    } else if (strstr(action, "sidestep_left")) {
-        ret = otto_controller_queue_action(ACTION_DOG_SIDESTEP, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 80, -1, 0);  // direction = -1 (left)
-        ESP_LOGI(TAG, "⬅️ Sidestepping left: %d steps, speed %d", param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 80);
-    */
-    } else if (strstr(action, "pushup")) {
-        ret = otto_controller_queue_action(ACTION_DOG_PUSHUP, param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150, 0, 0);
-        ESP_LOGI(TAG, "💪 Doing pushups: %d pushups, speed %d", param1 > 0 ? param1 : 3, param2 > 0 ? param2 : 150);
-    } else if (strstr(action, "balance")) {
-        ret = otto_controller_queue_action(ACTION_DOG_BALANCE, param1 > 0 ? param1 : 2000, param2 > 0 ? param2 : 150, 0, 0);
-        ESP_LOGI(TAG, "⚖️ Balancing: %d ms duration, speed %d", param1 > 0 ? param1 : 2000, param2 > 0 ? param2 : 150);
-    } else if (strstr(action, "stop")) {
+    switch (op) {
+    case ACTION_OP_STOP:
         // Stop action - clear queue and go to home position
         ret = otto_controller_stop_all();  // This will clear all queued actions
         ESP_LOGI(TAG, "🛑 STOP - all actions cancelled, robot at home");
-    } else if (strstr(action, "show_clock")) {
+        break;
+    case ACTION_OP_SHOW_CLOCK: {
         // Show clock on display
         auto display = Board::GetInstance().GetDisplay();
         if (display) {
@@ -2568,9 +786,30 @@ void otto_execute_web_action(const char* action, int param1, int param2) {
             }
         }
         ret = ESP_OK;
-    } else {
-        ESP_LOGW(TAG, "❌ Unknown action: %s", action);
-        return;
+        break;
+    }
+    default: {
+        // Movement ops: the action table is shared with the host simulator (otto_actions.h)
+        WebOpAction actions[WEB_OP_MAX_ACTIONS];
+        int count = OttoWebOpActions(op, param1, param2, actions);
+        if (count == 0) {
+            ESP_LOGW(TAG, "❌ Unknown action op: 0x%02x", op);
+            return;
+        }
+        if (const char* emotion = OttoWebOpEmotion(op)) {
+            if (auto display = Board::GetInstance().GetDisplay()) display->SetEmotion(emotion);
+        }
+        for (int i = 0; i < count; i++) {
+            const WebOpAction& action = actions[i];
+            if (otto_controller_queue_action_ex(action.action_type, action.steps, action.speed, 0, 0,
+                                                action.priority) == 0) {
+                ret = ESP_FAIL;
+            }
+        }
+        ESP_LOGI(TAG, "🐕 %s: %d action(s) queued, first %s (%d, %d)", ActionOpName(op), count,
+                 OttoActionName(actions[0].action_type), actions[0].steps, actions[0].speed);
+        break;
+    }
     }
     
     if (ret == ESP_OK) {
@@ -2580,8 +819,76 @@ void otto_execute_web_action(const char* action, int param1, int param2) {
     }
 }
 
+// C++ function to execute Otto actions (with real controller integration)
+void otto_execute_web_action(const char* action, int param1, int param2) {
+    ESP_LOGI(TAG, "🎮 Web Control: %s (param1:%d, param2:%d)", action, param1, param2);
+    
+    // Same substring rules as the memory slot compiler (walk_back before walk, turn by param1 sign)
+    uint8_t op = ActionOpFromName(action, param1);
+    if (op == ACTION_OP_END) {
+        ESP_LOGW(TAG, "❌ Unknown action: %s", action);
+        return;
+    }
+    otto_execute_web_op(op, param1, param2);
+}
+
 extern "C" {
 
+// Apply the speed multiplier and run a web action (shared by /action and /ws)
+void otto_web_run_action(const char* cmd, int param1, int param2) {
+    // Apply speed multiplier: lower multiplier = faster (less delay)
+    // speed_multiplier: 50 = fastest (50%), 100 = normal, 200 = slowest (200%)
+    int adjusted_speed = (param2 * speed_multiplier) / 100;
+    if (adjusted_speed < 10) adjusted_speed = 10;  // Minimum speed
+    
+    ESP_LOGI(TAG, "Action: %s, P1: %d, P2: %d (speed_mult: %d%% -> adjusted: %d)", 
+             cmd, param1, param2, speed_multiplier, adjusted_speed);
+    
+    // Execute action with adjusted speed
+    otto_execute_web_action(cmd, param1, adjusted_speed);
+}
+
+// Show an emotion, GIF on the Otto display or text emoji elsewhere
+bool otto_web_set_emotion(const char* emotion) {
+    auto display = Board::GetInstance().GetDisplay();
+    if (!display) {
+        return false;
+    }
+    // Try Otto display first for GIF support
+    auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
+    if (otto_display) {
+        otto_display->SetEmotion(emotion);
+    } else {
+        // Fallback to regular display for text emoji
+        display->SetEmotion(emotion);
+    }
+    return true;
+}
+
+// Set speaker volume (0-100) and show it on the display
+void otto_web_set_volume(int volume_level) {
+    if (volume_level < 0) volume_level = 0;
+    if (volume_level > 100) volume_level = 100;
+    
+    ESP_LOGI(TAG, "🔊 Setting volume to: %d%%", volume_level);
+    
+    // Get AudioCodec instance and set volume
+    Board& board = Board::GetInstance();
+    if (board.GetAudioCodec()) {
+        board.GetAudioCodec()->SetOutputVolume(volume_level);
+        ESP_LOGI(TAG, "✅ Audio volume set successfully to %d%%", volume_level);
+    } else {
+        ESP_LOGW(TAG, "⚠️ AudioCodec not available");
+    }
+    
+    // Also show volume change on display
+    if (board.GetDisplay()) {
+        char volume_msg[64];
+        snprintf(volume_msg, sizeof(volume_msg), "Âm lượng: %d%%", volume_level);
+        board.GetDisplay()->SetChatMessage("system", volume_msg);
+    }
+}
+
 // Action handler
 esp_err_t otto_action_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "🎯 ACTION HANDLER CALLED!"); // Debug logging
@@ -2607,16 +914,7 @@ esp_err_t otto_action_handler(httpd_req_t *req) {
         int param1 = atoi(p1_str);
         int param2 = atoi(p2_str);
         
-        // Apply speed multiplier: lower multiplier = faster (less delay)
-        // speed_multiplier: 50 = fastest (50%), 100 = normal, 200 = slowest (200%)
-        int adjusted_speed = (param2 * speed_multiplier) / 100;
-        if (adjusted_speed < 10) adjusted_speed = 10;  // Minimum speed
-        
-        ESP_LOGI(TAG, "Action: %s, P1: %d, P2: %d (speed_mult: %d%% -> adjusted: %d)", 
-                 cmd, param1, param2, speed_multiplier, adjusted_speed);
-        
-        // Execute action with adjusted speed
-        otto_execute_web_action(cmd, param1, adjusted_speed);
+        otto_web_run_action(cmd, param1, param2);
         
         // Send response
         httpd_resp_set_type(req, "text/plain");
@@ -2660,17 +958,7 @@ esp_err_t otto_emotion_handler(httpd_req_t *req) {
         ESP_LOGI(TAG, "Setting emotion: %s", emotion);
         
         // Send emotion to display system with fallback
-        auto display = Board::GetInstance().GetDisplay();
-        if (display) {
-            // Try Otto display first for GIF support
-            auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-            if (otto_display) {
-                otto_display->SetEmotion(emotion);
-            } else {
-                // Fallback to regular display for text emoji
-                display->SetEmotion(emotion);
-            }
-            
+        if (otto_web_set_emotion(emotion)) {
             httpd_resp_set_type(req, "text/plain");
             char response[100];
             snprintf(response, sizeof(response), "✅ Emotion set to: %s", emotion);
@@ -2687,6 +975,80 @@ esp_err_t otto_emotion_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+// One interpreter for /play_slot, otto_play_memory_slot() and the alarm: decodes a few bytes
+// per step and queues the controller action directly, no string parsing at play time
+static int run_memory_slot(int slot, const std::vector<uint8_t>& code, const SlotPlayOptions& options,
+                           int64_t* dispatch_us) {
+    ActionProgramInfo info;
+    if (!ActionProgramInspect(code.data(), code.size(), &info)) {
+        ESP_LOGW(TAG, "❌ Slot %d program is invalid", slot);
+        return 0;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    int64_t wait_us = 0;
+    
+    // Set emotion first
+    if (options.action_emoji && info.emotion != ACTION_EMOJI_NONE) {
+        otto_web_set_emotion(ActionEmojiName(info.emotion));
+        ESP_LOGI(TAG, "▶️ Set emotion: %s", ActionEmojiName(info.emotion));
+    }
+    
+    int actions = 0;
+    int count = ActionProgramRun(code.data(), code.size(), options.max_actions * 4, [&](const ActionStep& step) {
+        if (step.op == ACTION_OP_EMOJI) {
+            ESP_LOGI(TAG, "▶️ Emoji change: %s", ActionEmojiName(step.emoji));
+            otto_web_set_emotion(ActionEmojiName(step.emoji));
+            return true;
+        }
+        if (actions >= options.max_actions) {
+            return false;
+        }
+        
+        // Set emoji for this action
+        if (options.action_emoji && step.emoji != ACTION_EMOJI_NONE) {
+            otto_web_set_emotion(ActionEmojiName(step.emoji));
+        }
+        
+        // Apply speed multiplier only if p2 > 0 (it's a speed parameter)
+        int adjusted_speed = step.p2;
+        if (step.p2 > 0) {
+            adjusted_speed = (step.p2 * speed_multiplier) / 100;
+            if (adjusted_speed < 10) adjusted_speed = 10;
+        }
+        ESP_LOGI(TAG, "▶️ Action %d: %s (p1:%ld, p2:%d)", actions + 1, ActionOpName(step.op), (long)step.p1,
+                 adjusted_speed);
+        // Back-pressure: a full queue drops its oldest action, so long or looped slots would
+        // lose steps. Wait for room instead (stop clears the queue and needs none)
+        if (step.op != ACTION_OP_STOP) {
+            int64_t wait_start = esp_timer_get_time();
+            while (otto_controller_pending_actions() >= ACTION_QUEUE_SIZE) {
+                vTaskDelay(pdMS_TO_TICKS(20));
+            }
+            wait_us += esp_timer_get_time() - wait_start;
+        }
+        otto_execute_web_op(step.op, step.p1, adjusted_speed);
+        actions++;
+        
+        // Add delay between actions to ensure robot completes previous action (stop: no delay)
+        if (step.op != ACTION_OP_STOP && options.gap_ms > 0) {
+            int64_t wait_start = esp_timer_get_time();
+            vTaskDelay(pdMS_TO_TICKS(options.gap_ms));
+            wait_us += esp_timer_get_time() - wait_start;
+        }
+        return true;
+    });
+    
+    // Decode + dispatch only, the pauses between actions are not counted
+    int64_t busy_us = esp_timer_get_time() - start_us - wait_us;
+    ESP_LOGI(TAG, "▶️ Completed: Played %d steps (%d actions) from slot %d, %u bytes, dispatch %lld us",
+             count, actions, slot, (unsigned)code.size(), busy_us);
+    if (dispatch_us != nullptr) {
+        *dispatch_us = busy_us;
+    }
+    return count;
+}
+
 // Save action slot handler
 esp_err_t otto_save_slot_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "💾 SAVE SLOT HANDLER CALLED!");
@@ -2710,7 +1072,7 @@ esp_err_t otto_save_slot_handler(httpd_req_t *req) {
     httpd_query_key_value(query, "emotion", emotion, sizeof(emotion));
     
     int slot = atoi(slot_str);
-    if (slot < 1 || slot > 3) {
+    if (slot < 1 || slot > ACTION_SLOT_COUNT) {
         httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"Invalid slot number\"}");
         return ESP_OK;
     }
@@ -2730,35 +1092,83 @@ esp_err_t otto_save_slot_handler(httpd_req_t *req) {
         }
     }
     
-    // Save to memory slot (slot numbers are 1-3, array is 0-2)
-    int idx = slot - 1;
-    strncpy(memory_slots[idx].actions, decoded_actions, sizeof(memory_slots[idx].actions) - 1);
-    strncpy(memory_slots[idx].emotion, emotion, sizeof(memory_slots[idx].emotion) - 1);
-    memory_slots[idx].used = true;
-    
-    // Count actions (separated by ';')
-    int count = 0;
-    if (strlen(decoded_actions) > 0) {
-        count = 1;
-        for (size_t i = 0; i < strlen(decoded_actions); i++) {
-            if (decoded_actions[i] == ';') count++;
-        }
+    // Compile once here, playback only decodes bytes
+    int64_t compile_start = esp_timer_get_time();
+    std::vector<uint8_t> code;
+    std::string error;
+    bool compiled = ActionProgramCompile(decoded_actions, emotion, true, code, &error);
+    int64_t compile_us = esp_timer_get_time() - compile_start;
+    if (!compiled) {
+        ESP_LOGW(TAG, "💾 Slot %d rejected: %s", slot, error.c_str());
+        cJSON* json = cJSON_CreateObject();
+        cJSON_AddBoolToObject(json, "success", false);
+        cJSON_AddStringToObject(json, "error", error.c_str());
+        char* body = cJSON_PrintUnformatted(json);
+        httpd_resp_sendstr(req, body);
+        cJSON_free(body);
+        cJSON_Delete(json);
+        return ESP_OK;
     }
     
-    ESP_LOGI(TAG, "💾 Saved %d actions to slot %d: '%s' with emotion '%s'", count, slot, decoded_actions, emotion);
+    ActionProgramInfo info;
+    ActionProgramInspect(code.data(), code.size(), &info);
+    size_t text_bytes = strlen(decoded_actions);
+    ESP_LOGI(TAG, "💾 Compiled %d steps for slot %d: %u chars -> %u bytes in %lld us, emotion '%s'",
+             info.steps, slot, (unsigned)text_bytes, (unsigned)info.bytes, compile_us, emotion);
     
-    // Save to NVS for persistence
-    save_memory_slots_to_nvs();
+    // Save to NVS for persistence (only this slot's blob)
+    if (save_memory_slot(slot, std::move(code)) != ESP_OK) {
+        httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"NVS write failed\"}");
+        return ESP_OK;
+    }
     
-    char response[150];
+    char response[200];
     snprintf(response, sizeof(response), 
-             "{\"success\":true,\"slot\":%d,\"count\":%d,\"emotion\":\"%s\"}", 
-             slot, count, emotion);
+             "{\"success\":true,\"slot\":%d,\"count\":%d,\"emotion\":\"%s\",\"bytes\":%u,\"text_bytes\":%u,\"compile_us\":%lld}", 
+             slot, info.steps, emotion, (unsigned)info.bytes, (unsigned)text_bytes, compile_us);
     httpd_resp_sendstr(req, response);
     
     return ESP_OK;
 }
 
+// /play_slot playback runs on its own task, so a slow slot holds neither an httpd task nor
+// an async worker. One slot plays at a time; a newer request replaces the one waiting.
+static QueueHandle_t slot_play_queue = NULL;
+static std::mutex slot_play_mutex;
+
+static void slot_play_task(void* arg) {
+    int slot;
+    while (xQueueReceive(slot_play_queue, &slot, portMAX_DELAY) == pdTRUE) {
+        std::vector<uint8_t> code;
+        if (!get_memory_slot(slot, code)) {
+            continue;  // Cleared since the request
+        }
+        // Other actions: 100ms delay between each
+        SlotPlayOptions options = {true, 100, ACTION_SLOT_MAX_ACTIONS};
+        run_memory_slot(slot, code, options, nullptr);
+    }
+    vTaskDelete(NULL);
+}
+
+static bool start_slot_playback(int slot) {
+    std::lock_guard<std::mutex> lock(slot_play_mutex);
+    if (slot_play_queue == NULL) {
+        QueueHandle_t queue = xQueueCreate(1, sizeof(int));
+        if (queue == NULL) {
+            return false;
+        }
+        slot_play_queue = queue;
+        if (xTaskCreate(slot_play_task, "slot_play", 4096, NULL, 5, NULL) != pdPASS) {
+            ESP_LOGE(TAG, "❌ Failed to create slot playback task");
+            vQueueDelete(queue);
+            slot_play_queue = NULL;
+            return false;
+        }
+    }
+    xQueueOverwrite(slot_play_queue, &slot);
+    return true;
+}
+
 // Play action slot handler
 esp_err_t otto_play_slot_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "▶️ PLAY SLOT HANDLER CALLED!");
@@ -2777,106 +1187,28 @@ esp_err_t otto_play_slot_handler(httpd_req_t *req) {
     httpd_query_key_value(query, "slot", slot_str, sizeof(slot_str));
     
     int slot = atoi(slot_str);
-    if (slot < 1 || slot > 3) {
+    if (slot < 1 || slot > ACTION_SLOT_COUNT) {
         httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"Invalid slot number\"}");
         return ESP_OK;
     }
     
-    int idx = slot - 1;
-    if (!memory_slots[idx].used || strlen(memory_slots[idx].actions) == 0) {
+    std::vector<uint8_t> code;
+    ActionProgramInfo info;
+    if (!get_memory_slot(slot, code) || !ActionProgramInspect(code.data(), code.size(), &info)) {
         httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"Vị trí này chưa có dữ liệu\"}");
         return ESP_OK;
     }
     
-    // Set emotion first
-    if (strlen(memory_slots[idx].emotion) > 0) {
-        auto display = Board::GetInstance().GetDisplay();
-        if (display) {
-            auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-            if (otto_display) {
-                otto_display->SetEmotion(memory_slots[idx].emotion);
-            } else {
-                display->SetEmotion(memory_slots[idx].emotion);
-            }
-        }
-        ESP_LOGI(TAG, "▶️ Set emotion: %s", memory_slots[idx].emotion);
-    }
-    
-    // Parse and execute actions with delay between each
-    char actions_copy[512];
-    strncpy(actions_copy, memory_slots[idx].actions, sizeof(actions_copy) - 1);
-    actions_copy[sizeof(actions_copy) - 1] = '\0';
-    
-    ESP_LOGI(TAG, "▶️ Actions string: '%s'", actions_copy);
-    
-    int count = 0;
-    char* token = strtok(actions_copy, ";");
-    while (token != NULL) {
-        // Parse "action,param1,param2,emoji"
-        char action[50] = {0};
-        char emoji[32] = {0};
-        int p1 = 0, p2 = 0;
-        
-        // Try to parse with emoji first (new format)
-        int parsed = sscanf(token, "%[^,],%d,%d,%[^\n]", action, &p1, &p2, emoji);
-        if (parsed < 3) {
-            // Fallback to old format without emoji
-            parsed = sscanf(token, "%[^,],%d,%d", action, &p1, &p2);
-            strcpy(emoji, "neutral");
-        }
-        
-        if (parsed >= 1) {
-            ESP_LOGI(TAG, "▶️ Action %d: '%s' (p1:%d, p2:%d, emoji:%s)", count+1, action, p1, p2, emoji);
-            
-            // Set emoji for this action
-            if (strlen(emoji) > 0) {
-                auto display = Board::GetInstance().GetDisplay();
-                if (display) {
-                    auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-                    if (otto_display) {
-                        otto_display->SetEmotion(emoji);
-                    } else {
-                        display->SetEmotion(emoji);
-                    }
-                }
-            }
-            
-            // Check if this is an emoji-only action (no movement)
-            if (strcmp(action, "emoji") == 0) {
-                ESP_LOGI(TAG, "▶️ Emoji change: %s", emoji);
-                count++;
-            } else {
-                // Apply speed multiplier only if p2 > 0 (it's a speed parameter)
-                int adjusted_speed = p2;
-                if (p2 > 0) {
-                    adjusted_speed = (p2 * speed_multiplier) / 100;
-                    if (adjusted_speed < 10) adjusted_speed = 10;
-                }
-                
-                // Execute action
-                otto_execute_web_action(action, p1, adjusted_speed);
-                count++;
-                
-                // Add delay between actions to ensure robot completes previous action
-                // Stop action: no delay
-                // Other actions: 100ms delay
-                if (strstr(action, "stop") == NULL) {
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                }
-            }
-        } else {
-            ESP_LOGW(TAG, "▶️ Failed to parse token: '%s'", token);
-        }
-        
-        token = strtok(NULL, ";");
+    // Reply as soon as playback is handed over; the dispatch time is logged by run_memory_slot()
+    if (!start_slot_playback(slot)) {
+        httpd_resp_sendstr(req, "{\"success\":false,\"error\":\"Playback task unavailable\"}");
+        return ESP_OK;
     }
     
-    ESP_LOGI(TAG, "▶️ Completed: Played %d actions from slot %d", count, slot);
-    
     char response[100];
     snprintf(response, sizeof(response), 
-             "{\"success\":true,\"slot\":%d,\"count\":%d}", 
-             slot, count);
+             "{\"success\":true,\"slot\":%d,\"count\":%d,\"bytes\":%u}", 
+             slot, info.steps, (unsigned)code.size());
     httpd_resp_sendstr(req, response);
     
     return ESP_OK;
@@ -2897,135 +1229,37 @@ esp_err_t otto_slot_info_handler(httpd_req_t *req) {
     httpd_query_key_value(query, "slot", slot_str, sizeof(slot_str));
     
     int slot = atoi(slot_str);
-    if (slot < 1 || slot > 3) {
-        httpd_resp_sendstr(req, "{\"used\":false}");
-        return ESP_OK;
-    }
-    
-    int idx = slot - 1;
-    if (!memory_slots[idx].used) {
+    std::vector<uint8_t> code;
+    ActionProgramInfo info;
+    if (!get_memory_slot(slot, code) || !ActionProgramInspect(code.data(), code.size(), &info)) {
         httpd_resp_sendstr(req, "{\"used\":false}");
         return ESP_OK;
     }
     
-    // Count actions
-    int count = 1;
-    for (size_t i = 0; i < strlen(memory_slots[idx].actions); i++) {
-        if (memory_slots[idx].actions[i] == ';') count++;
-    }
-    
+    const char* emotion = ActionEmojiName(info.emotion);
     char response[150];
     snprintf(response, sizeof(response), 
-             "{\"used\":true,\"count\":%d,\"emotion\":\"%s\"}", 
-             count, memory_slots[idx].emotion);
+             "{\"used\":true,\"count\":%d,\"emotion\":\"%s\",\"bytes\":%u}", 
+             info.steps, emotion != nullptr ? emotion : "", (unsigned)info.bytes);
     httpd_resp_sendstr(req, response);
     
     return ESP_OK;
 }
 
 // Play memory slot directly - can be called from other modules like application.cc
-// slot: 1-3 (slot number)
-// Returns: number of actions played, 0 if slot empty or invalid
+// slot: 1-ACTION_SLOT_COUNT (slot number)
+// Returns: number of steps played, 0 if slot empty or invalid
 int otto_play_memory_slot(int slot) {
     ESP_LOGI(TAG, "🎭 otto_play_memory_slot(%d) called", slot);
     
-    if (slot < 1 || slot > 3) {
-        ESP_LOGW(TAG, "❌ Invalid slot number: %d", slot);
+    std::vector<uint8_t> code;
+    if (!get_memory_slot(slot, code)) {
+        ESP_LOGW(TAG, "❌ Slot %d is empty or invalid", slot);
         return 0;
     }
     
-    int idx = slot - 1;
-    if (!memory_slots[idx].used || strlen(memory_slots[idx].actions) == 0) {
-        ESP_LOGW(TAG, "❌ Slot %d is empty", slot);
-        return 0;
-    }
-    
-    // Set emotion first
-    if (strlen(memory_slots[idx].emotion) > 0) {
-        auto display = Board::GetInstance().GetDisplay();
-        if (display) {
-            auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-            if (otto_display) {
-                otto_display->SetEmotion(memory_slots[idx].emotion);
-            } else {
-                display->SetEmotion(memory_slots[idx].emotion);
-            }
-        }
-        ESP_LOGI(TAG, "▶️ Set emotion: %s", memory_slots[idx].emotion);
-    }
-    
-    // Parse and execute actions with delay between each
-    char actions_copy[512];
-    strncpy(actions_copy, memory_slots[idx].actions, sizeof(actions_copy) - 1);
-    actions_copy[sizeof(actions_copy) - 1] = '\0';
-    
-    ESP_LOGI(TAG, "▶️ Actions string: '%s'", actions_copy);
-    
-    int count = 0;
-    char* saveptr = NULL;
-    char* token = strtok_r(actions_copy, ";", &saveptr);
-    while (token != NULL) {
-        // Parse "action,param1,param2,emoji"
-        char action[50] = {0};
-        char emoji[32] = {0};
-        int p1 = 0, p2 = 0;
-        
-        // Try to parse with emoji first (new format)
-        int parsed = sscanf(token, "%[^,],%d,%d,%[^\n]", action, &p1, &p2, emoji);
-        if (parsed < 3) {
-            // Fallback to old format without emoji
-            parsed = sscanf(token, "%[^,],%d,%d", action, &p1, &p2);
-            strcpy(emoji, "neutral");
-        }
-        
-        if (parsed >= 1) {
-            ESP_LOGI(TAG, "▶️ Action %d: '%s' (p1:%d, p2:%d, emoji:%s)", count+1, action, p1, p2, emoji);
-            
-            // Set emoji for this action
-            if (strlen(emoji) > 0) {
-                auto display = Board::GetInstance().GetDisplay();
-                if (display) {
-                    auto otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-                    if (otto_display) {
-                        otto_display->SetEmotion(emoji);
-                    } else {
-                        display->SetEmotion(emoji);
-                    }
-                }
-            }
-            
-            // Check if this is an emoji-only action (no movement)
-            if (strcmp(action, "emoji") == 0) {
-                ESP_LOGI(TAG, "▶️ Emoji change: %s", emoji);
-                count++;
-            } else {
-                // Apply speed multiplier only if p2 > 0 (it's a speed parameter)
-                int adjusted_speed = p2;
-                if (p2 > 0) {
-                    adjusted_speed = (p2 * speed_multiplier) / 100;
-                    if (adjusted_speed < 10) adjusted_speed = 10;
-                }
-                
-                // Execute action
-                otto_execute_web_action(action, p1, adjusted_speed);
-                count++;
-                
-                // Add delay between actions to ensure robot completes previous action
-                // Stop action: no delay
-                // Other actions: 100ms delay
-                if (strstr(action, "stop") == NULL) {
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                }
-            }
-        } else {
-            ESP_LOGW(TAG, "▶️ Failed to parse token: '%s'", token);
-        }
-        
-        token = strtok_r(NULL, ";", &saveptr);
-    }
-    
-    ESP_LOGI(TAG, "▶️ Completed: Played %d actions from slot %d", count, slot);
-    return count;
+    SlotPlayOptions options = {true, 100, ACTION_SLOT_MAX_ACTIONS};
+    return run_memory_slot(slot, code, options, nullptr);
 }
 
 // Emoji mode handler
@@ -3137,24 +1371,7 @@ esp_err_t otto_volume_handler(httpd_req_t *req) {
         int volume_level = atoi(level_str);
         if (volume_level < 0) volume_level = 0;
         if (volume_level > 100) volume_level = 100;
-        
-        ESP_LOGI(TAG, "🔊 Setting volume to: %d%%", volume_level);
-        
-        // Get AudioCodec instance and set volume
-        Board& board = Board::GetInstance();
-        if (board.GetAudioCodec()) {
-            board.GetAudioCodec()->SetOutputVolume(volume_level);
-            ESP_LOGI(TAG, "✅ Audio volume set successfully to %d%%", volume_level);
-        } else {
-            ESP_LOGW(TAG, "⚠️ AudioCodec not available");
-        }
-        
-        // Also show volume change on display
-        if (board.GetDisplay()) {
-            char volume_msg[64];
-            snprintf(volume_msg, sizeof(volume_msg), "Âm lượng: %d%%", volume_level);
-            board.GetDisplay()->SetChatMessage("system", volume_msg);
-        }
+        otto_web_set_volume(volume_level);
         
         httpd_resp_set_type(req, "text/plain");
         char response[100];
@@ -3360,14 +1577,150 @@ esp_err_t otto_auto_emoji_interval_handler(httpd_req_t *req) {
             httpd_resp_set_status(req, "400 Bad Request");
             httpd_resp_sendstr(req, "❌ Thời gian phải từ 3-300 giây");
         }
-    } else {
-        httpd_resp_set_status(req, "400 Bad Request");
-        httpd_resp_sendstr(req, "❌ Missing seconds parameter");
+    } else {
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_sendstr(req, "❌ Missing seconds parameter");
+    }
+    
+    return ESP_OK;
+}
+
+// ===== Screen stream (MJPEG) - xem màn hình robot từ xa =====
+// Mỗi lần chỉ một client; stream chạy trong task riêng (async request) để
+// không chặn HTTP server, và chỉ giữ khóa display lúc chụp snapshot.
+struct ScreenStreamArgs {
+    httpd_req_t* req;
+    MjpegStreamConfig config;
+    bool test_pattern;
+};
+static std::atomic<bool> screen_stream_active{false};
+static std::mutex screen_stream_mutex;
+static MjpegStreamer* screen_streamer = nullptr;
+
+static bool screen_stream_encode(const ScreenFrame& frame, int quality, std::string& jpeg) {
+    // image_to_jpeg_cb dùng JPEG phần cứng nếu chip có
+    return image_to_jpeg_cb(frame.data, frame.size, frame.width, frame.height, V4L2_PIX_FMT_RGB565, quality,
+        [](void* arg, size_t index, const void* data, size_t len) -> size_t {
+            static_cast<std::string*>(arg)->append(static_cast<const char*>(data), len);
+            return len;
+        }, &jpeg);
+}
+
+static void screen_stream_task(void* param) {
+    auto args = static_cast<ScreenStreamArgs*>(param);
+    httpd_req_t* req = args->req;
+
+    // Source và streamer phải hủy trước vTaskDelete: LvglFrameSource giữ buffer snapshot
+    // và callback invalidate trên display
+    MjpegStreamStats stats;
+    {
+        std::unique_ptr<ScreenFrameSource> source;
+        auto lvgl_display = dynamic_cast<LvglDisplay*>(Board::GetInstance().GetDisplay());
+        if (args->test_pattern || lvgl_display == nullptr) {
+            source = std::make_unique<SyntheticFrameSource>(240, 240);
+        } else {
+            source = std::make_unique<LvglFrameSource>(lvgl_display);
+        }
+
+        MjpegStreamer streamer(*source, screen_stream_encode, args->config);
+        {
+            std::lock_guard<std::mutex> lock(screen_stream_mutex);
+            screen_streamer = &streamer;
+        }
+
+        httpd_resp_set_type(req, MjpegStreamer::kContentType);
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+        // Client chậm/treo: httpd_resp_send_chunk lỗi sau send_wait_timeout và stream kết thúc
+        int64_t last_activity_us = 0;
+        stats = streamer.Run([req, &last_activity_us](const char* data, size_t len) {
+            int64_t now = esp_timer_get_time();
+            if (now - last_activity_us > 10 * 1000000) {
+                webserver_reset_auto_stop_timer();  // Đang xem thì không tự tắt web server
+                last_activity_us = now;
+            }
+            return httpd_resp_send_chunk(req, data, len) == ESP_OK;
+        });
+
+        std::lock_guard<std::mutex> lock(screen_stream_mutex);
+        screen_streamer = nullptr;
+    }
+    httpd_resp_send_chunk(req, NULL, 0);
+    httpd_req_async_handler_complete(req);
+
+    uint32_t frames = stats.frames_sent > 0 ? stats.frames_sent : 1;
+    ESP_LOGI(TAG, "📺 Screen stream ended: %lu frames, %lu unchanged skipped, avg %lu KB, capture %lums, encode %lums, send %lums",
+             (unsigned long)stats.frames_sent, (unsigned long)stats.frames_unchanged,
+             (unsigned long)(stats.bytes_sent / frames / 1024), (unsigned long)(stats.capture_us / frames / 1000),
+             (unsigned long)(stats.encode_us / frames / 1000), (unsigned long)(stats.send_us / frames / 1000));
+
+    delete args;
+    screen_stream_active = false;
+    vTaskDelete(NULL);
+}
+
+// GET /screen/stream?fps=5&q=60[&test=1]
+esp_err_t otto_screen_stream_handler(httpd_req_t *req) {
+    webserver_reset_auto_stop_timer();
+
+    bool expected = false;
+    if (!screen_stream_active.compare_exchange_strong(expected, true)) {
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+        httpd_resp_sendstr(req, "Screen stream already in use");
+        return ESP_OK;
+    }
+
+    auto args = new ScreenStreamArgs();
+    args->test_pattern = false;
+    char query[64] = {0};
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[8];
+        if (httpd_query_key_value(query, "fps", value, sizeof(value)) == ESP_OK) {
+            args->config.max_fps = atoi(value);
+        }
+        if (httpd_query_key_value(query, "q", value, sizeof(value)) == ESP_OK) {
+            args->config.quality = atoi(value);
+        }
+        if (httpd_query_key_value(query, "test", value, sizeof(value)) == ESP_OK) {
+            args->test_pattern = atoi(value) != 0;
+        }
+    }
+    // Giữ tải vừa phải cho ESP32-S3: tối đa 10 fps
+    args->config.max_fps = args->config.max_fps < 1 ? 1 : (args->config.max_fps > 10 ? 10 : args->config.max_fps);
+
+    if (httpd_req_async_handler_begin(req, &args->req) != ESP_OK) {
+        delete args;
+        screen_stream_active = false;
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "📺 Screen stream starting (%d fps, quality %d%s)", args->config.max_fps, args->config.quality,
+             args->test_pattern ? ", test pattern" : "");
+    httpd_req_t* async_req = args->req;
+    if (xTaskCreate(screen_stream_task, "screen_stream", 6144, args, 3, NULL) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create screen stream task");
+        httpd_req_async_handler_complete(async_req);
+        delete args;
+        screen_stream_active = false;
+        return ESP_FAIL;
     }
-    
     return ESP_OK;
 }
 
+// Dừng stream đang chạy và chờ task kết thúc (tối đa 2s)
+static void screen_stream_stop() {
+    {
+        std::lock_guard<std::mutex> lock(screen_stream_mutex);
+        if (screen_streamer != nullptr) {
+            screen_streamer->Stop();
+        }
+    }
+    for (int i = 0; i < 20 && screen_stream_active; i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
 // Screen toggle handler - now with auto-off control
 esp_err_t otto_screen_toggle_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "📱 SCREEN TOGGLE HANDLER CALLED!");
@@ -3457,24 +1810,9 @@ esp_err_t otto_screen_rotation_handler(httpd_req_t *req) {
             
             // Save rotation to NVS only if requested
             if (should_save) {
-                nvs_handle_t nvs_handle;
-                esp_err_t err = nvs_open("display", NVS_READWRITE, &nvs_handle);
-                if (err != ESP_OK) {
-                    ESP_LOGE(TAG, "❌ Failed to open NVS: %s", esp_err_to_name(err));
-                } else {
-                    err = nvs_set_i32(nvs_handle, "rotation", rotation_angle);
-                    if (err != ESP_OK) {
-                        ESP_LOGE(TAG, "❌ Failed to set rotation in NVS: %s", esp_err_to_name(err));
-                    } else {
-                        err = nvs_commit(nvs_handle);
-                        if (err != ESP_OK) {
-                            ESP_LOGE(TAG, "❌ Failed to commit NVS: %s", esp_err_to_name(err));
-                        } else {
-                            ESP_LOGI(TAG, "💾 Rotation saved to NVS: %d°", rotation_angle);
-                        }
-                    }
-                    nvs_close(nvs_handle);
-                }
+                Settings settings("display", true);
+                settings.SetInt("rotation", rotation_angle);
+                ESP_LOGI(TAG, "💾 Rotation saved to NVS: %d°", rotation_angle);
             }
             
             // Apply rotation settings based on angle
@@ -3551,97 +1889,211 @@ esp_err_t otto_screen_rotation_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
-// Drawing handler - receive RGB565 image data from web and display on robot LCD
+// Drawing handler - nhận ảnh/tile và giải mã thẳng vào canvas vẽ trên LCD
+//
+// POST /draw?fmt=raw|rle|jpeg&x=&y=&w=&h=
+// - raw: w*h pixel RGB565 little-endian (mặc định, tương thích client cũ gửi nguyên 240x240)
+// - rle: opcode RLE565 (xem DrawTileDecoder), skip giữ pixel cũ => client chỉ gửi phần thay đổi
+// - jpeg: ảnh JPEG thu nhỏ vừa w/h (giữ tỉ lệ) rồi đặt tại (x, y)
+// Thiếu x/y/w/h: tile là cả canvas. fmt mặc định lấy từ Content-Type.
+static const size_t DRAW_MAX_RLE_BYTES = 256 * 1024;
+static const size_t DRAW_MAX_JPEG_BYTES = 64 * 1024;
+static const size_t DRAW_CHUNK_SIZE = 4096;
+static const int DRAW_MAX_RECV_TIMEOUTS = 5;  // Liên tiếp, mỗi lần chờ bằng recv_wait_timeout của server
+
+static esp_err_t draw_reply(httpd_req_t *req, const char* status, const char* message) {
+    if (status) {
+        httpd_resp_set_status(req, status);
+    }
+    httpd_resp_set_type(req, "text/plain");
+    httpd_resp_sendstr(req, message);
+    return ESP_OK;
+}
+
+// Blit ảnh RGB565 (đã giải mã) vào tile, cắt theo canvas
+static bool draw_blit_image(OttoEmojiDisplay* display, const uint16_t* image, int image_w, int image_h,
+                            int stride_px, const DrawTile& tile) {
+    return display->EditDrawingCanvas([&](uint16_t* pixels, int width, int height, lv_area_t& dirty) {
+        int w = std::min({image_w, tile.w, width - tile.x});
+        int h = std::min({image_h, tile.h, height - tile.y});
+        if (w <= 0 || h <= 0) {
+            return false;
+        }
+        for (int y = 0; y < h; y++) {
+            memcpy(pixels + (tile.y + y) * width + tile.x, image + y * stride_px, w * sizeof(uint16_t));
+        }
+        dirty = {tile.x, tile.y, tile.x + w - 1, tile.y + h - 1};
+        return true;
+    });
+}
+
 esp_err_t otto_draw_handler(httpd_req_t *req) {
-    ESP_LOGI(TAG, "🎨 DRAW HANDLER CALLED!");
     webserver_reset_auto_stop_timer();
-    
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
-    
-    // Expected size: 240x240 pixels * 2 bytes per pixel (RGB565) = 115200 bytes
-    static const size_t EXPECTED_SIZE = 240 * 240 * 2;
+    int64_t start_us = esp_timer_get_time();
+
+    auto display = Board::GetInstance().GetDisplay();
+    OttoEmojiDisplay* otto_display = display ? dynamic_cast<OttoEmojiDisplay*>(display) : nullptr;
+    if (!otto_display) {
+        return draw_reply(req, "500 Internal Server Error", "Lỗi: Display không hỗ trợ");
+    }
+    const int canvas_w = otto_display->width();
+    const int canvas_h = otto_display->height();
+
+    // Định dạng: ?fmt= trước, sau đó Content-Type
+    char fmt[8] = "raw";
+    char content_type[32] = {0};
+    if (httpd_req_get_hdr_value_str(req, "Content-Type", content_type, sizeof(content_type)) == ESP_OK) {
+        if (strstr(content_type, "image/jpeg")) {
+            strcpy(fmt, "jpeg");
+        } else if (strstr(content_type, "image/png")) {
+            strcpy(fmt, "png");
+        }
+    }
+    DrawTile tile = {0, 0, canvas_w, canvas_h};
+    char query[96] = {0};
+    bool has_size = false;
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK) {
+        char value[8];
+        httpd_query_key_value(query, "fmt", fmt, sizeof(fmt));
+        if (httpd_query_key_value(query, "x", value, sizeof(value)) == ESP_OK) tile.x = atoi(value);
+        if (httpd_query_key_value(query, "y", value, sizeof(value)) == ESP_OK) tile.y = atoi(value);
+        if (httpd_query_key_value(query, "w", value, sizeof(value)) == ESP_OK) {
+            tile.w = atoi(value);
+            has_size = true;
+        }
+        if (httpd_query_key_value(query, "h", value, sizeof(value)) == ESP_OK) {
+            tile.h = atoi(value);
+            has_size = true;
+        }
+    }
+    if (!has_size) {
+        tile.w = canvas_w - tile.x;
+        tile.h = canvas_h - tile.y;
+    }
+
     size_t content_len = req->content_len;
-    
-    ESP_LOGI(TAG, "🎨 Received drawing data: %d bytes (expected %d)", (int)content_len, (int)EXPECTED_SIZE);
-    
-    if (content_len != EXPECTED_SIZE) {
-        ESP_LOGE(TAG, "Invalid drawing data size: %d (expected %d)", (int)content_len, (int)EXPECTED_SIZE);
-        httpd_resp_set_type(req, "text/plain");
-        httpd_resp_sendstr(req, "Lỗi: Kích thước dữ liệu không đúng");
-        return ESP_FAIL;
+    if (tile.x < 0 || tile.y < 0 || tile.w <= 0 || tile.h <= 0 ||
+        tile.x + tile.w > canvas_w || tile.y + tile.h > canvas_h) {
+        ESP_LOGW(TAG, "🎨 Invalid tile %dx%d@(%d,%d)", tile.w, tile.h, tile.x, tile.y);
+        return draw_reply(req, "400 Bad Request", "Lỗi: Vùng vẽ nằm ngoài màn hình");
     }
-    
-    // Lazy init draw buffer on first use
-    if (!init_draw_buffer()) {
-        httpd_resp_set_type(req, "text/plain");
-        httpd_resp_sendstr(req, "Lỗi: Không đủ bộ nhớ");
-        return ESP_FAIL;
+
+    bool is_raw = strcmp(fmt, "raw") == 0;
+    bool is_rle = strcmp(fmt, "rle") == 0;
+    bool is_jpeg = strcmp(fmt, "jpeg") == 0 || strcmp(fmt, "jpg") == 0;
+    if (!is_raw && !is_rle && !is_jpeg) {
+        // Chưa có PNG decoder trong firmware
+        return draw_reply(req, "415 Unsupported Media Type", "Lỗi: Chỉ hỗ trợ raw, rle, jpeg");
     }
-    
-    // Dùng static buffer thay vì malloc - tránh fragmentation
-    if (xSemaphoreTake(draw_buffer_pool.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        ESP_LOGW(TAG, "Draw buffer busy, request dropped");
-        httpd_resp_set_type(req, "text/plain");
-        httpd_resp_sendstr(req, "Lỗi: Bận xử lý, thử lại");
-        return ESP_FAIL;
+    if ((is_raw && content_len != (size_t)tile.w * tile.h * 2) ||
+        (is_rle && (content_len == 0 || content_len > DRAW_MAX_RLE_BYTES)) ||
+        (is_jpeg && (content_len == 0 || content_len > DRAW_MAX_JPEG_BYTES))) {
+        ESP_LOGW(TAG, "🎨 Invalid %s body size %d for tile %dx%d", fmt, (int)content_len, tile.w, tile.h);
+        return draw_reply(req, "400 Bad Request", "Lỗi: Kích thước dữ liệu không đúng");
     }
-    
-    if (draw_buffer_pool.in_use) {
-        xSemaphoreGive(draw_buffer_pool.mutex);
-        ESP_LOGW(TAG, "Draw buffer in use");
-        httpd_resp_set_type(req, "text/plain");
-        httpd_resp_sendstr(req, "Lỗi: Đang xử lý, thử lại");
-        return ESP_FAIL;
+
+    // JPEG cần cả file để giải mã; raw/RLE đi qua buffer nhỏ theo từng chunk
+    size_t buffer_size = is_jpeg ? content_len : std::min(content_len, DRAW_CHUNK_SIZE);
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(buffer_size, is_jpeg ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL);
+    if (!buffer) {
+        buffer = (uint8_t*)malloc(buffer_size);
     }
-    
-    draw_buffer_pool.in_use = true;
-    xSemaphoreGive(draw_buffer_pool.mutex);
-    
-    // Read image data vào static buffer
+    if (!buffer) {
+        return draw_reply(req, "503 Service Unavailable", "Lỗi: Không đủ bộ nhớ");
+    }
+
+    DrawTileDecoder decoder(is_rle ? DrawTileDecoder::Format::kRle : DrawTileDecoder::Format::kRaw, tile);
+    int64_t recv_us = 0;
+    int64_t decode_us = 0;
     size_t received = 0;
-    while (received < EXPECTED_SIZE) {
-        int ret = httpd_req_recv(req, (char*)draw_buffer_pool.buffer + received, EXPECTED_SIZE - received);
+    size_t buffered = 0;
+    int timeouts = 0;
+    bool ok = true;
+    const char* status = "400 Bad Request";
+    const char* error = nullptr;
+
+    while (received < content_len) {
+        int64_t t0 = esp_timer_get_time();
+        size_t want = is_jpeg ? content_len - received : std::min(buffer_size, content_len - received);
+        int ret = httpd_req_recv(req, (char*)buffer + buffered, want);
+        recv_us += esp_timer_get_time() - t0;
         if (ret <= 0) {
-            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+            // Client im lặng quá lâu: trả 408 thay vì giữ worker httpd mãi
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT && ++timeouts < DRAW_MAX_RECV_TIMEOUTS) {
                 continue;
             }
-            ESP_LOGE(TAG, "Failed to receive drawing data");
-            xSemaphoreTake(draw_buffer_pool.mutex, portMAX_DELAY);
-            draw_buffer_pool.in_use = false;
-            xSemaphoreGive(draw_buffer_pool.mutex);
-            httpd_resp_set_type(req, "text/plain");
-            httpd_resp_sendstr(req, "Lỗi: Không nhận được dữ liệu");
-            return ESP_FAIL;
+            ok = false;
+            if (ret == HTTPD_SOCK_ERR_TIMEOUT) {
+                status = "408 Request Timeout";
+                error = "Lỗi: Hết thời gian chờ dữ liệu";
+            } else {
+                error = "Lỗi: Không nhận được dữ liệu";
+            }
+            break;
         }
+        timeouts = 0;
         received += ret;
+        if (is_jpeg) {
+            buffered += ret;
+            continue;
+        }
+
+        // Mỗi chunk giữ khóa LVGL trong thời gian giải mã ngắn, không giữ qua lúc chờ mạng
+        t0 = esp_timer_get_time();
+        ok = otto_display->EditDrawingCanvas([&](uint16_t* pixels, int width, int height, lv_area_t& dirty) {
+            int first_row, last_row;
+            bool fed = decoder.Feed(buffer, ret, pixels, width, &first_row, &last_row);
+            if (first_row <= last_row) {
+                dirty = {tile.x, first_row, tile.x + tile.w - 1, last_row};
+            }
+            return fed;
+        });
+        decode_us += esp_timer_get_time() - t0;
+        if (!ok) {
+            error = "Lỗi: Dữ liệu RLE không hợp lệ";
+            break;
+        }
     }
-    
-    ESP_LOGI(TAG, "🎨 Received %d bytes of drawing data", (int)received);
-    
-    // Get display and show the drawing
-    auto display = Board::GetInstance().GetDisplay();
-    if (display) {
-        OttoEmojiDisplay* otto_display = dynamic_cast<OttoEmojiDisplay*>(display);
-        if (otto_display) {
-            otto_display->SetDrawingImage((uint16_t*)draw_buffer_pool.buffer, 240, 240);
-            ESP_LOGI(TAG, "🎨 Drawing displayed on robot LCD!");
-            
-            httpd_resp_set_type(req, "text/plain");
-            httpd_resp_sendstr(req, "Đã hiển thị hình vẽ lên robot!");
+
+    uint32_t pixels = decoder.pixels_written();
+    if (ok && is_jpeg) {
+        // Giải mã thu nhỏ vừa tile; cùng ảnh gửi lại (sticker, ảnh mẫu) lấy luôn từ cache
+        int64_t t0 = esp_timer_get_time();
+        auto thumbnail = JpegThumbnailCache::GetInstance().Get(buffer, buffered, tile.w, tile.h);
+        if (thumbnail) {
+            if (!has_size) {
+                tile.w = thumbnail->width;
+                tile.h = thumbnail->height;
+            }
+            ok = draw_blit_image(otto_display, (const uint16_t*)thumbnail->data, thumbnail->width, thumbnail->height,
+                                 thumbnail->stride / 2, tile);
+            pixels = std::min(thumbnail->width, tile.w) * std::min(thumbnail->height, tile.h);
         } else {
-            httpd_resp_set_type(req, "text/plain");
-            httpd_resp_sendstr(req, "Lỗi: Display không hỗ trợ");
+            ok = false;
         }
-    } else {
-        httpd_resp_set_type(req, "text/plain");
-        httpd_resp_sendstr(req, "Lỗi: Không có display");
+        decode_us += esp_timer_get_time() - t0;
+        if (!ok) {
+            error = "Lỗi: Không giải mã được JPEG";
+        }
+    } else if (ok && !decoder.Done()) {
+        ok = false;
+        error = "Lỗi: Dữ liệu RLE không phủ hết vùng vẽ";
     }
-    
-    // Release buffer
-    xSemaphoreTake(draw_buffer_pool.mutex, portMAX_DELAY);
-    draw_buffer_pool.in_use = false;
-    xSemaphoreGive(draw_buffer_pool.mutex);
-    return ESP_OK;
+    heap_caps_free(buffer);
+
+    int64_t total_us = esp_timer_get_time() - start_us;
+    ESP_LOGI(TAG, "🎨 /draw %s %dx%d@(%d,%d): %d B, %lu px, recv %lums, decode %lums, total %lums%s", fmt,
+             tile.w, tile.h, tile.x, tile.y, (int)content_len, (unsigned long)pixels, (unsigned long)(recv_us / 1000),
+             (unsigned long)(decode_us / 1000), (unsigned long)(total_us / 1000), ok ? "" : " FAILED");
+    if (!ok) {
+        return draw_reply(req, status, error);
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "Đã hiển thị hình vẽ lên robot! (%s, %d bytes, %lu ms)", fmt,
+             (int)content_len, (unsigned long)(total_us / 1000));
+    return draw_reply(req, nullptr, message);
 }
 
 // Exit drawing mode and return to emoji display
@@ -3678,605 +2130,7 @@ esp_err_t otto_draw_exit_handler(httpd_req_t *req) {
 esp_err_t otto_music_page_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "🎵 Music page requested");
     webserver_reset_auto_stop_timer();
-    
-    // HTML page for music player with search and playback - Modern UI with YouTube Thumbnail
-    static const char MUSIC_PAGE[] = R"rawliteral(
-<!DOCTYPE html>
-<html lang="vi">
-<head>
-<meta charset="UTF-8">
-<meta name="viewport" content="width=device-width, initial-scale=1.0, maximum-scale=1.0, user-scalable=no">
-<title>🎵 Kiki Music Player</title>
-<style>
-* { box-sizing: border-box; margin: 0; padding: 0; }
-body { 
-    font-family: 'Segoe UI', system-ui, sans-serif; 
-    background: linear-gradient(135deg, #0f0c29 0%, #302b63 50%, #24243e 100%);
-    color: #fff; 
-    min-height: 100vh;
-    padding: 10px;
-}
-.container { max-width: 500px; margin: 0 auto; }
-h1 { 
-    text-align: center; 
-    font-size: 1.6em; 
-    margin: 10px 0;
-    background: linear-gradient(90deg, #f953c6, #b91d73, #f953c6);
-    background-size: 200% auto;
-    -webkit-background-clip: text;
-    -webkit-text-fill-color: transparent;
-    animation: shine 3s linear infinite;
-}
-@keyframes shine { to { background-position: 200% center; } }
-
-.search-box {
-    display: flex;
-    gap: 8px;
-    margin: 12px 0;
-}
-.search-box input {
-    flex: 1;
-    padding: 14px 18px;
-    border: none;
-    border-radius: 30px;
-    font-size: 15px;
-    background: rgba(255,255,255,0.15);
-    color: #fff;
-    outline: none;
-    transition: all 0.3s;
-}
-.search-box input:focus {
-    background: rgba(255,255,255,0.25);
-    box-shadow: 0 0 20px rgba(249,83,198,0.4);
-}
-.search-box input::placeholder { color: rgba(255,255,255,0.5); }
-.btn-search {
-    padding: 14px 22px;
-    border: none;
-    border-radius: 30px;
-    font-size: 16px;
-    cursor: pointer;
-    background: linear-gradient(135deg, #f953c6, #b91d73);
-    color: #fff;
-    font-weight: bold;
-    transition: all 0.3s;
-}
-.btn-search:hover { transform: scale(1.05); box-shadow: 0 5px 25px rgba(249,83,198,0.5); }
-.btn-search:active { transform: scale(0.95); }
-
-.player-card {
-    background: linear-gradient(145deg, rgba(255,255,255,0.1) 0%, rgba(255,255,255,0.05) 100%);
-    border-radius: 25px;
-    padding: 20px;
-    margin: 15px 0;
-    backdrop-filter: blur(15px);
-    border: 1px solid rgba(255,255,255,0.15);
-    box-shadow: 0 10px 40px rgba(0,0,0,0.3);
-}
-
-.thumbnail-container {
-    position: relative;
-    width: 100%;
-    padding-bottom: 56.25%;
-    border-radius: 15px;
-    overflow: hidden;
-    margin-bottom: 15px;
-    background: linear-gradient(135deg, #1a1a2e 0%, #302b63 100%);
-}
-.thumbnail {
-    position: absolute;
-    top: 0;
-    left: 0;
-    width: 100%;
-    height: 100%;
-    object-fit: cover;
-    transition: transform 0.5s, opacity 0.5s;
-}
-.thumbnail.loading { opacity: 0.5; }
-.thumbnail-overlay {
-    position: absolute;
-    top: 0;
-    left: 0;
-    width: 100%;
-    height: 100%;
-    background: linear-gradient(transparent 50%, rgba(0,0,0,0.8) 100%);
-    pointer-events: none;
-}
-.vinyl-animation {
-    position: absolute;
-    top: 50%;
-    left: 50%;
-    transform: translate(-50%, -50%);
-    width: 80px;
-    height: 80px;
-    border-radius: 50%;
-    background: radial-gradient(circle at 30% 30%, #333 0%, #111 100%);
-    border: 3px solid #444;
-    display: none;
-}
-.vinyl-animation.playing {
-    display: block;
-    animation: spin 3s linear infinite;
-}
-.vinyl-animation::before {
-    content: '';
-    position: absolute;
-    top: 50%;
-    left: 50%;
-    transform: translate(-50%, -50%);
-    width: 20px;
-    height: 20px;
-    border-radius: 50%;
-    background: linear-gradient(135deg, #f953c6, #b91d73);
-}
-@keyframes spin { to { transform: translate(-50%, -50%) rotate(360deg); } }
-
-.song-info {
-    text-align: center;
-    margin-bottom: 15px;
-}
-.song-title {
-    font-size: 1.3em;
-    font-weight: bold;
-    margin-bottom: 5px;
-    color: #fff;
-    text-shadow: 0 2px 10px rgba(0,0,0,0.3);
-}
-.song-artist {
-    color: rgba(255,255,255,0.7);
-    font-size: 0.95em;
-}
-
-.progress-bar {
-    width: 100%;
-    height: 4px;
-    background: rgba(255,255,255,0.2);
-    border-radius: 2px;
-    margin: 15px 0;
-    overflow: hidden;
-}
-.progress-fill {
-    height: 100%;
-    width: 0%;
-    background: linear-gradient(90deg, #f953c6, #b91d73);
-    border-radius: 2px;
-    transition: width 0.3s;
-}
-
-.player-controls {
-    display: flex;
-    justify-content: center;
-    align-items: center;
-    gap: 20px;
-}
-.ctrl-btn {
-    width: 55px;
-    height: 55px;
-    border-radius: 50%;
-    border: none;
-    font-size: 22px;
-    cursor: pointer;
-    transition: all 0.3s;
-    display: flex;
-    align-items: center;
-    justify-content: center;
-    background: rgba(255,255,255,0.1);
-    color: #fff;
-}
-.ctrl-btn.stop {
-    width: 65px;
-    height: 65px;
-    font-size: 26px;
-    background: linear-gradient(135deg, #ff416c, #ff4b2b);
-}
-.ctrl-btn:hover { transform: scale(1.1); box-shadow: 0 5px 20px rgba(255,65,108,0.4); }
-.ctrl-btn:active { transform: scale(0.95); }
-
-.status-bar {
-    display: flex;
-    justify-content: space-between;
-    align-items: center;
-    padding: 10px 15px;
-    background: rgba(0,0,0,0.2);
-    border-radius: 12px;
-    margin: 10px 0;
-    font-size: 0.85em;
-}
-.status-dot {
-    width: 8px;
-    height: 8px;
-    border-radius: 50%;
-    margin-right: 8px;
-    display: inline-block;
-}
-.status-dot.idle { background: #7f8c8d; }
-.status-dot.playing { background: #2ecc71; animation: pulse 1s infinite; }
-.status-dot.loading { background: #f39c12; animation: pulse 0.5s infinite; }
-@keyframes pulse { 0%,100% { opacity: 1; } 50% { opacity: 0.4; } }
-
-.section-title {
-    color: #f953c6;
-    font-size: 0.9em;
-    margin: 15px 0 10px 0;
-    display: flex;
-    align-items: center;
-    gap: 6px;
-}
-
-.quick-songs {
-    display: flex;
-    flex-wrap: wrap;
-    gap: 8px;
-}
-.quick-btn {
-    padding: 10px 16px;
-    background: rgba(255,255,255,0.08);
-    border: 1px solid rgba(255,255,255,0.15);
-    border-radius: 25px;
-    color: #fff;
-    font-size: 0.85em;
-    cursor: pointer;
-    transition: all 0.3s;
-}
-.quick-btn:hover {
-    background: linear-gradient(135deg, rgba(249,83,198,0.3), rgba(185,29,115,0.3));
-    border-color: #f953c6;
-    transform: translateY(-2px);
-}
-
-.history-list {
-    max-height: 180px;
-    overflow-y: auto;
-}
-.history-item {
-    display: flex;
-    align-items: center;
-    padding: 10px 12px;
-    background: rgba(255,255,255,0.05);
-    border-radius: 10px;
-    margin-bottom: 6px;
-    cursor: pointer;
-    transition: all 0.3s;
-}
-.history-item:hover {
-    background: rgba(249,83,198,0.2);
-    transform: translateX(5px);
-}
-.history-thumb {
-    width: 45px;
-    height: 45px;
-    border-radius: 8px;
-    margin-right: 12px;
-    object-fit: cover;
-    background: #333;
-}
-.history-info { flex: 1; }
-.history-info .song { font-size: 0.9em; margin-bottom: 2px; }
-.history-info .time { color: rgba(255,255,255,0.5); font-size: 0.75em; }
-
-.back-btn {
-    display: block;
-    text-align: center;
-    padding: 14px;
-    background: rgba(255,255,255,0.08);
-    border-radius: 15px;
-    color: #fff;
-    text-decoration: none;
-    margin-top: 15px;
-    transition: all 0.3s;
-    border: 1px solid rgba(255,255,255,0.1);
-}
-.back-btn:hover { background: rgba(255,255,255,0.15); }
-
-.toast {
-    position: fixed;
-    bottom: 20px;
-    left: 50%;
-    transform: translateX(-50%) translateY(100px);
-    background: linear-gradient(135deg, #f953c6, #b91d73);
-    color: #fff;
-    padding: 12px 25px;
-    border-radius: 25px;
-    transition: transform 0.3s;
-    z-index: 1000;
-    font-weight: bold;
-    box-shadow: 0 5px 25px rgba(249,83,198,0.4);
-}
-.toast.show { transform: translateX(-50%) translateY(0); }
-</style>
-</head>
-<body>
-<div class="container">
-    <h1>🎵 Kiki Music</h1>
-    
-    <div class="search-box">
-        <input type="text" id="searchInput" placeholder="Tìm bài hát, ca sĩ..." autocomplete="off">
-        <button class="btn-search" onclick="searchMusic()">🔍</button>
-    </div>
-    
-    <div class="player-card">
-        <div class="thumbnail-container">
-            <img class="thumbnail" id="thumbnail" src="data:image/svg+xml,%3Csvg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 100 56'%3E%3Crect fill='%23302b63' width='100' height='56'/%3E%3Ctext x='50' y='30' font-size='12' fill='%23fff' text-anchor='middle'%3E🎵%3C/text%3E%3C/svg%3E" alt="thumbnail">
-            <div class="thumbnail-overlay"></div>
-            <div class="vinyl-animation" id="vinyl"></div>
-        </div>
-        <div class="song-info">
-            <div class="song-title" id="songTitle">Chọn bài hát để phát</div>
-            <div class="song-artist" id="songArtist">Kiki Music Player</div>
-        </div>
-        <div class="progress-bar"><div class="progress-fill" id="progressFill"></div></div>
-        <div class="player-controls">
-            <button class="ctrl-btn stop" onclick="stopMusic()">⏹️</button>
-        </div>
-    </div>
-    
-    <div class="pose-section" style="background:linear-gradient(145deg,rgba(255,193,7,0.15),rgba(255,152,0,0.1));border:1px solid rgba(255,193,7,0.3);border-radius:15px;padding:15px;margin:10px 0">
-        <div style="font-weight:bold;color:#ffc107;margin-bottom:8px">🐕 Hành động khi phát nhạc</div>
-        <div style="display:flex;gap:8px;flex-wrap:wrap">
-            <select id="musicPose" onchange="saveMusicPose()" style="flex:1;min-width:140px;padding:10px;border:2px solid #ffc107;border-radius:8px;font-size:14px;background:#1a1a2e;color:#fff">
-                <option value="none">❌ Không có Pose</option>
-                <option value="sit">🪑 Ngồi (Sit)</option>
-                <option value="wave">👋 Vẫy tay (Wave)</option>
-                <option value="bow">🙇 Cúi chào (Bow)</option>
-                <option value="stretch">🙆 Vươn vai (Stretch)</option>
-                <option value="swing">💃 Lắc lư (Swing)</option>
-                <option value="dance">🕺 Nhảy (Dance)</option>
-            </select>
-            <select id="musicActionSlot" onchange="saveMusicPose()" style="flex:1;min-width:140px;padding:10px;border:2px solid #9c27b0;border-radius:8px;font-size:14px;background:#1a1a2e;color:#fff">
-                <option value="0">⚪ Không hành động lưu</option>
-                <option value="1">📍 Vị trí 1</option>
-                <option value="2">📍 Vị trí 2</option>
-                <option value="3">📍 Vị trí 3</option>
-            </select>
-        </div>
-        <div style="font-size:11px;color:#aaa;margin-top:6px">💡 Chọn pose/hành động sẽ tự động thực hiện mỗi khi phát nhạc</div>
-        <div id="poseStatus" style="display:none;padding:8px;border-radius:8px;margin-top:8px;font-size:13px;text-align:center"></div>
-    </div>
-
-    <div class="status-bar">
-        <span><span class="status-dot idle" id="statusDot"></span><span id="statusText">Sẵn sàng</span></span>
-        <span id="bufferInfo"></span>
-    </div>
-    
-    <div class="section-title">🔥 Đề xuất</div>
-    <div class="quick-songs">
-        <button class="quick-btn" onclick="playQuick('Chúng Ta Của Hiện Tại')">Chúng Ta Của Hiện Tại</button>
-        <button class="quick-btn" onclick="playQuick('Lạc Trôi')">Lạc Trôi</button>
-        <button class="quick-btn" onclick="playQuick('See You Again')">See You Again</button>
-        <button class="quick-btn" onclick="playQuick('Despacito')">Despacito</button>
-        <button class="quick-btn" onclick="playQuick('Shape of You')">Shape of You</button>
-        <button class="quick-btn" onclick="playQuick('Có Chắc Yêu Là Đây')">Có Chắc Yêu Là Đây</button>
-    </div>
-    
-    <div class="section-title">📜 Lịch sử</div>
-    <div class="history-list" id="historyList"></div>
-    
-    <a href="/" class="back-btn">⬅️ Quay lại trang chính</a>
-</div>
-
-<div class="toast" id="toast"></div>
-
-<script>
-let isPlaying = false;
-let currentSong = '';
-let currentThumbnail = '';
-let progressInterval = null;
-let history = JSON.parse(localStorage.getItem('musicHistory') || '[]');
-const defaultThumb = "data:image/svg+xml,%3Csvg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 100 56'%3E%3Crect fill='%23302b63' width='100' height='56'/%3E%3Ctext x='50' y='30' font-size='12' fill='%23fff' text-anchor='middle'%3E🎵%3C/text%3E%3C/svg%3E";
-
-function showToast(msg) {
-    const t = document.getElementById('toast');
-    t.textContent = msg;
-    t.classList.add('show');
-    setTimeout(() => t.classList.remove('show'), 2500);
-}
-
-function setStatus(status, text) {
-    const dot = document.getElementById('statusDot');
-    const txt = document.getElementById('statusText');
-    dot.className = 'status-dot ' + status;
-    txt.textContent = text;
-}
-
-function setThumbnail(url) {
-    const thumb = document.getElementById('thumbnail');
-    const vinyl = document.getElementById('vinyl');
-    thumb.classList.add('loading');
-    if (url && url.length > 10) {
-        thumb.src = url;
-        thumb.onload = () => { thumb.classList.remove('loading'); vinyl.classList.remove('playing'); };
-        thumb.onerror = () => { thumb.src = defaultThumb; thumb.classList.remove('loading'); };
-        currentThumbnail = url;
-    } else {
-        thumb.src = defaultThumb;
-        thumb.classList.remove('loading');
-        vinyl.classList.add('playing');
-    }
-}
-
-function updateUI(playing, song, artist, thumbnail) {
-    isPlaying = playing;
-    document.getElementById('songTitle').textContent = song || 'Chọn bài hát để phát';
-    document.getElementById('songArtist').textContent = artist || 'Kiki Music Player';
-    const vinyl = document.getElementById('vinyl');
-    if (playing) {
-        setStatus('playing', 'Đang phát');
-        currentSong = song;
-        vinyl.classList.add('playing');
-        startProgress();
-        if (thumbnail) setThumbnail(thumbnail);
-    } else {
-        setStatus('idle', 'Sẵn sàng');
-        vinyl.classList.remove('playing');
-        stopProgress();
-        setThumbnail('');
-    }
-}
-
-function startProgress() {
-    stopProgress();
-    let progress = 0;
-    const fill = document.getElementById('progressFill');
-    progressInterval = setInterval(() => {
-        progress += 0.5;
-        if (progress > 100) progress = 0;
-        fill.style.width = progress + '%';
-    }, 500);
-}
-
-function stopProgress() {
-    if (progressInterval) { clearInterval(progressInterval); progressInterval = null; }
-    document.getElementById('progressFill').style.width = '0%';
-}
-
-function addToHistory(song, thumbnail) {
-    if (!song) return;
-    history = history.filter(h => h.song !== song);
-    history.unshift({ song: song, time: new Date().toLocaleTimeString(), thumb: thumbnail || '' });
-    if (history.length > 10) history.pop();
-    localStorage.setItem('musicHistory', JSON.stringify(history));
-    renderHistory();
-}
-
-function renderHistory() {
-    const list = document.getElementById('historyList');
-    let html = '';
-    history.forEach(h => {
-        const thumbUrl = h.thumb || defaultThumb;
-        html += `<div class="history-item" onclick="playQuick('${h.song.replace(/'/g, "\\'")}')">
-            <img class="history-thumb" src="${thumbUrl}" onerror="this.src='${defaultThumb}'">
-            <div class="history-info">
-                <div class="song">${h.song}</div>
-                <div class="time">${h.time}</div>
-            </div>
-        </div>`;
-    });
-    list.innerHTML = html;
-}
-
-function searchMusic() {
-    const input = document.getElementById('searchInput');
-    const query = input.value.trim();
-    if (!query) {
-        showToast('Vui lòng nhập tên bài hát!');
-        return;
-    }
-    playMusic(query);
-}
-
-function playQuick(song) {
-    document.getElementById('searchInput').value = song;
-    playMusic(song);
-}
-
-function playMusic(song) {
-    setStatus('loading', 'Đang tìm kiếm...');
-    showToast('🔍 Đang tìm: ' + song);
-    setThumbnail('');
-    
-    fetch('/music/play?song=' + encodeURIComponent(song))
-        .then(r => r.json())
-        .then(data => {
-            if (data.success) {
-                const thumb = data.thumbnail || '';
-                updateUI(true, data.title || song, data.artist || '', thumb);
-                addToHistory(data.title || song, thumb);
-                showToast('🎵 Đang phát: ' + (data.title || song));
-            } else {
-                setStatus('idle', 'Lỗi');
-                showToast('❌ ' + (data.error || 'Không tìm thấy bài hát'));
-            }
-        })
-        .catch(e => {
-            setStatus('idle', 'Lỗi kết nối');
-            showToast('❌ Lỗi kết nối!');
-        });
-}
-
-function stopMusic() {
-    fetch('/music/stop')
-        .then(r => r.json())
-        .then(data => {
-            updateUI(false, '', '', '');
-            showToast('⏹️ Đã dừng phát');
-        })
-        .catch(e => {
-            showToast('❌ Lỗi kết nối!');
-        });
-}
-
-// Check status periodically
-function checkStatus() {
-    fetch('/music/status')
-        .then(r => r.json())
-        .then(data => {
-            if (data.playing !== isPlaying || data.song !== currentSong) {
-                updateUI(data.playing, data.song, data.artist, data.thumbnail);
-            }
-            if (data.buffer_size) {
-                document.getElementById('bufferInfo').textContent = 'Buffer: ' + Math.round(data.buffer_size/1024) + 'KB';
-            }
-        })
-        .catch(() => {});
-}
-
-// Enter key to search
-document.getElementById('searchInput').addEventListener('keypress', e => {
-    if (e.key === 'Enter') searchMusic();
-});
-
-function saveMusicPose() {
-    var pose = document.getElementById('musicPose').value;
-    var slot = document.getElementById('musicActionSlot').value;
-    var ps = document.getElementById('poseStatus');
-    ps.style.display = 'block';
-    ps.style.background = 'rgba(255,193,7,0.2)';
-    ps.style.color = '#ffc107';
-    ps.textContent = '⏳ Đang lưu...';
-    fetch('/music/pose_save?pose=' + pose + '&action_slot=' + slot)
-        .then(function(r) { return r.json(); })
-        .then(function(d) {
-            if (d.success) {
-                ps.style.background = 'rgba(76,175,80,0.2)';
-                ps.style.color = '#4caf50';
-                ps.textContent = '✅ ' + d.message;
-            } else {
-                ps.style.background = 'rgba(244,67,54,0.2)';
-                ps.style.color = '#f44336';
-                ps.textContent = '❌ ' + d.message;
-            }
-            setTimeout(function() { ps.style.display = 'none'; }, 2000);
-        })
-        .catch(function(e) {
-            ps.style.background = 'rgba(244,67,54,0.2)';
-            ps.style.color = '#f44336';
-            ps.textContent = '❌ Lỗi kết nối';
-        });
-}
-
-function loadMusicPose() {
-    fetch('/music/pose_save?get=1')
-        .then(function(r) { return r.json(); })
-        .then(function(d) {
-            if (d.pose) document.getElementById('musicPose').value = d.pose;
-            if (d.action_slot !== undefined) document.getElementById('musicActionSlot').value = d.action_slot;
-        })
-        .catch(function(e) {});
-}
-
-// Init
-renderHistory();
-checkStatus();
-loadMusicPose();
-setInterval(checkStatus, 3000);
-</script>
-</body>
-</html>
-)rawliteral";
-
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, MUSIC_PAGE, HTTPD_RESP_USE_STRLEN);
-    return ESP_OK;
+    return web_ui_send_page(req, WebUiPage::kMusic);
 }
 
 // Music play handler
@@ -4376,7 +2230,7 @@ esp_err_t otto_music_pose_handler(httpd_req_t *req) {
         httpd_query_key_value(buf, "action_slot", action_slot_str, sizeof(action_slot_str));
         
         int8_t action_slot = (int8_t)atoi(action_slot_str);
-        if (action_slot < 0 || action_slot > 3) action_slot = 0;
+        if (action_slot < 0 || action_slot > ACTION_SLOT_COUNT) action_slot = 0;
         
         nvs_handle_t nvs_handle;
         esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
@@ -4421,21 +2275,27 @@ esp_err_t otto_music_status_handler(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
     httpd_resp_set_type(req, "application/json");
     
-    // Get status from music player
-    extern bool otto_music_get_status(bool* playing, size_t* buffer_size, char* song, int song_len, char* artist, int artist_len, char* thumbnail, int thumb_len);
-    
     bool playing = false;
     size_t buffer_size = 0;
     char song[200] = {0};
     char artist[100] = {0};
     char thumbnail[300] = {0};
     
+    // Get status from music player
     otto_music_get_status(&playing, &buffer_size, song, sizeof(song), artist, sizeof(artist), thumbnail, sizeof(thumbnail));
     
-    char response[700];
+    char buffer_stats[256] = "{}";
+    otto_music_get_buffer_stats(buffer_stats, sizeof(buffer_stats));
+    
+    char beat_stats[192] = "{}";
+    otto_music_get_beat_stats(beat_stats, sizeof(beat_stats));
+    
+    std::string cache_stats = MusicCache::GetInstance().GetStatsJson();
+    
+    char response[1500];
     snprintf(response, sizeof(response), 
-             "{\"playing\":%s,\"song\":\"%s\",\"artist\":\"%s\",\"thumbnail\":\"%s\",\"buffer_size\":%d}",
-             playing ? "true" : "false", song, artist, thumbnail, (int)buffer_size);
+             "{\"playing\":%s,\"song\":\"%s\",\"artist\":\"%s\",\"thumbnail\":\"%s\",\"buffer_size\":%d,\"buffering\":%s,\"beat\":%s,\"cache\":%s}",
+             playing ? "true" : "false", song, artist, thumbnail, (int)buffer_size, buffer_stats, beat_stats, cache_stats.c_str());
     httpd_resp_send(req, response, HTTPD_RESP_USE_STRLEN);
     return ESP_OK;
 }
@@ -4623,7 +2483,7 @@ esp_err_t otto_schedule_message_handler(httpd_req_t *req) {
     int action_slot = 0;
     if (cJSON_IsNumber(action_slot_item)) {
         action_slot = action_slot_item->valueint;
-        if (action_slot < 0 || action_slot > 3) {
+        if (action_slot < 0 || action_slot > ACTION_SLOT_COUNT) {
             action_slot = 0;
         }
     }
@@ -4820,16 +2680,12 @@ esp_err_t otto_forget_wifi_handler(httpd_req_t *req) {
     }
     
     // Set force_ap flag in wifi namespace to enter AP mode
-    nvs_handle_t settings_handle;
-    err = nvs_open("wifi", NVS_READWRITE, &settings_handle);
-    if (err == ESP_OK) {
-        nvs_set_i32(settings_handle, "force_ap", 1);
-        nvs_commit(settings_handle);
-        nvs_close(settings_handle);
+    {
+        Settings settings("wifi", true);
+        settings.SetInt("force_ap", 1);
+        Settings::Flush();
         ESP_LOGI(TAG, "✅ force_ap flag set to 1 in wifi namespace");
         success = true;
-    } else {
-        ESP_LOGE(TAG, "⚠️ Failed to open wifi NVS: %s", esp_err_to_name(err));
     }
     
     if (success) {
@@ -5099,268 +2955,7 @@ esp_err_t otto_gemini_get_key_handler(httpd_req_t *req) {
 esp_err_t otto_servo_calibration_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "Servo calibration page requested");
     webserver_reset_auto_stop_timer();
-    
-    httpd_resp_set_type(req, "text/html");
-    httpd_resp_sendstr_chunk(req, "<!DOCTYPE html><html><head>");
-    httpd_resp_sendstr_chunk(req, "<meta charset='UTF-8'>");
-    httpd_resp_sendstr_chunk(req, "<meta name='viewport' content='width=device-width, initial-scale=1.0'>");
-    httpd_resp_sendstr_chunk(req, "<title>Servo Calibration - Kiki</title>");
-    httpd_resp_sendstr_chunk(req, "<style>");
-    httpd_resp_sendstr_chunk(req, "body{font-family:Arial,sans-serif;max-width:800px;margin:20px auto;padding:20px;background:#f0f0f0}");
-    httpd_resp_sendstr_chunk(req, "h1{color:#333;text-align:center}");
-    httpd_resp_sendstr_chunk(req, ".servo-control{background:white;padding:20px;margin:10px 0;border-radius:8px;box-shadow:0 2px 4px rgba(0,0,0,0.1)}");
-    httpd_resp_sendstr_chunk(req, ".servo-name{font-size:18px;font-weight:bold;margin-bottom:10px}");
-    httpd_resp_sendstr_chunk(req, ".slider-container{display:flex;align-items:center;gap:10px;margin:10px 0}");
-    httpd_resp_sendstr_chunk(req, "input[type='range']{flex:1;height:30px}");
-    httpd_resp_sendstr_chunk(req, ".value-display{min-width:50px;font-weight:bold;font-size:18px}");
-    httpd_resp_sendstr_chunk(req, "button{background:#4CAF50;color:white;padding:12px 24px;border:none;border-radius:4px;cursor:pointer;font-size:16px;margin:5px}");
-    httpd_resp_sendstr_chunk(req, "button:hover{background:#45a049}");
-    httpd_resp_sendstr_chunk(req, "button.reset{background:#f44336}");
-    httpd_resp_sendstr_chunk(req, "button.reset:hover{background:#da190b}");
-    httpd_resp_sendstr_chunk(req, ".button-group{text-align:center;margin:20px 0}");
-    httpd_resp_sendstr_chunk(req, ".status{padding:10px;margin:10px 0;border-radius:4px;text-align:center}");
-    httpd_resp_sendstr_chunk(req, ".success{background:#d4edda;color:#155724}");
-    httpd_resp_sendstr_chunk(req, ".error{background:#f8d7da;color:#721c24}");
-    httpd_resp_sendstr_chunk(req, "</style></head><body>");
-    
-    httpd_resp_sendstr_chunk(req, "<h1>🤖 Kiki Servo Calibration</h1>");
-    httpd_resp_sendstr_chunk(req, "<div id='status' class='status' style='display:none'></div>");
-    
-    // Servo LF
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🦵 Left Front (LF)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='180' value='90' id='lf' oninput='updateServo(\"lf\",this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='lf-val'>90°</span>");
-    httpd_resp_sendstr_chunk(req, "</div></div>");
-    
-    // Servo RF
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🦵 Right Front (RF)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='180' value='90' id='rf' oninput='updateServo(\"rf\",this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='rf-val'>90°</span>");
-    httpd_resp_sendstr_chunk(req, "</div></div>");
-    
-    // Servo LB
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🦵 Left Back (LB)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='180' value='90' id='lb' oninput='updateServo(\"lb\",this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='lb-val'>90°</span>");
-    httpd_resp_sendstr_chunk(req, "</div></div>");
-    
-    // Servo RB
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🦵 Right Back (RB)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='180' value='90' id='rb' oninput='updateServo(\"rb\",this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='rb-val'>90°</span>");
-    httpd_resp_sendstr_chunk(req, "</div></div>");
-    
-    // Servo Tail
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control' style='background:linear-gradient(145deg,#fff3e0,#ffe0b2);border:2px solid #ff9800'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🐕 Tail Servo (GPIO 39)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='180' value='90' id='tail' oninput='updateServo(\"tail\",this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='tail-val'>90°</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size:12px;color:#666;margin-top:5px'>⚙️ Góc chuẩn: 90° (vị trí giữa)</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Speed Multiplier Section
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control' style='background:linear-gradient(145deg,#e8f5e9,#c8e6c9);border:2px solid #4caf50'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>⚡ Tốc Độ Di Chuyển (Speed)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='25' max='200' value='100' id='speed_mult' oninput='updateSpeed(this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='speed_mult-val'>100%</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size:12px;color:#666;margin-top:8px'>");
-    httpd_resp_sendstr_chunk(req, "📝 <strong>Hướng dẫn:</strong><br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>25-50%:</strong> Rất nhanh - robot di chuyển nhanh gấp 2-4 lần<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>50-75%:</strong> Nhanh - phù hợp chơi đùa<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>100%:</strong> Bình thường - tốc độ mặc định<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>125-150%:</strong> Chậm - chuyển động mượt hơn<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>150-200%:</strong> Rất chậm - xem rõ từng động tác<br>");
-    httpd_resp_sendstr_chunk(req, "⚠️ <em>Giá trị thấp = tốc độ cao, giá trị cao = tốc độ thấp</em>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<button onclick='saveSpeed()' style='margin-top:10px;background:#4caf50;color:white;padding:12px 24px;border:none;border-radius:8px;font-size:16px;font-weight:bold;cursor:pointer'>⚡ Lưu Tốc Độ</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Mic Gain Section
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control' style='background:linear-gradient(145deg,#e3f2fd,#bbdefb);border:2px solid #2196f3'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🎤 Độ Nhạy Microphone (Input Gain)</div>");
-    httpd_resp_sendstr_chunk(req, "<div class='slider-container'>");
-    httpd_resp_sendstr_chunk(req, "<input type='range' min='0' max='100' value='30' id='mic_gain' oninput='updateMicGain(this.value)'>");
-    httpd_resp_sendstr_chunk(req, "<span class='value-display' id='mic_gain-val'>30</span>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size:12px;color:#666;margin-top:8px'>");
-    httpd_resp_sendstr_chunk(req, "📝 <strong>Hướng dẫn điều chỉnh:</strong><br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>0-20:</strong> Rất thấp - chỉ nghe giọng nói lớn, gần<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>20-40:</strong> Thấp - phù hợp môi trường yên tĩnh<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>40-60:</strong> Trung bình - mặc định, cân bằng<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>60-80:</strong> Cao - nghe giọng nói xa hơn<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>80-100:</strong> Rất cao - nhạy với tiếng ồn<br>");
-    httpd_resp_sendstr_chunk(req, "⚠️ <em>Tăng quá cao có thể gây nhận diện sai wakeword</em>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    // Custom Keyword Emoji Section
-    httpd_resp_sendstr_chunk(req, "<div class='servo-control' style='background:linear-gradient(145deg,#fff8e1,#ffecb3);border:2px solid #ffc107'>");
-    httpd_resp_sendstr_chunk(req, "<div class='servo-name'>🍕 Từ Khóa Kích Hoạt Emoji + Pose</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='margin:10px 0'>");
-    httpd_resp_sendstr_chunk(req, "<input type='text' id='delicious_keyword' placeholder='Nhập từ khóa tiếng Việt hoặc tiếng Anh (VD: ngon quá, yummy, tuyệt vời...)' style='width:100%;padding:12px;border:2px solid #ffc107;border-radius:8px;font-size:14px;box-sizing:border-box'>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='margin:10px 0'>");
-    httpd_resp_sendstr_chunk(req, "<label style='font-weight:bold;color:#666'>🐕 Chọn Pose kèm theo:</label><br>");
-    httpd_resp_sendstr_chunk(req, "<select id='delicious_pose' style='width:100%;padding:12px;border:2px solid #ffc107;border-radius:8px;font-size:14px;margin-top:5px'>");
-    httpd_resp_sendstr_chunk(req, "<option value='none'>❌ Không có Pose</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='sit'>🪑 Ngồi (Sit)</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='wave'>👋 Vẫy tay (Wave)</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='bow'>🙇 Cúi chào (Bow)</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='stretch'>🙆 Vươn vai (Stretch)</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='swing'>💃 Lắc lư (Swing)</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='dance'>🕺 Nhảy (Dance)</option>");
-    httpd_resp_sendstr_chunk(req, "</select>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    // Action slot selection for keyword
-    httpd_resp_sendstr_chunk(req, "<div style='margin:10px 0'>");
-    httpd_resp_sendstr_chunk(req, "<label style='font-weight:bold;color:#9c27b0'>🎭 Hành động đã lưu:</label><br>");
-    httpd_resp_sendstr_chunk(req, "<select id='keyword_action_slot' style='width:100%;padding:12px;border:2px solid #9c27b0;border-radius:8px;font-size:14px;margin-top:5px;background:#f3e5f5'>");
-    httpd_resp_sendstr_chunk(req, "<option value='0'>⚪ Không chọn hành động</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='1'>📍 Vị trí 1</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='2'>📍 Vị trí 2</option>");
-    httpd_resp_sendstr_chunk(req, "<option value='3'>📍 Vị trí 3</option>");
-    httpd_resp_sendstr_chunk(req, "</select>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size:11px;color:#9c27b0;margin-top:4px'>💡 Chọn hành động đã lưu ở trang Điều Khiển</div>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div style='font-size:12px;color:#666;margin-top:8px'>");;
-    httpd_resp_sendstr_chunk(req, "📝 <strong>Hướng dẫn sử dụng từ khóa:</strong><br>");
-    httpd_resp_sendstr_chunk(req, "• Nhập từ khóa bạn muốn kích hoạt emoji 'Delicious' 😋<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>Nhiều từ khóa:</strong> cách nhau bằng dấu phẩy (,) hoặc chấm phẩy (;)<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>Ví dụ tiếng Việt:</strong> ngon quá, tuyệt vời, xuất sắc, thích quá<br>");
-    httpd_resp_sendstr_chunk(req, "• <strong>Ví dụ tiếng Anh:</strong> yummy, delicious, awesome, great<br>");
-    httpd_resp_sendstr_chunk(req, "• Từ khóa không phân biệt HOA/thường<br>");
-    httpd_resp_sendstr_chunk(req, "• Khi nói từ khóa, Kiki sẽ hiển thị emoji + thực hiện Pose");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    httpd_resp_sendstr_chunk(req, "<div id='keyword_status' style='display:none;padding:12px;border-radius:8px;margin-top:10px;font-weight:bold;text-align:center'></div>");
-    httpd_resp_sendstr_chunk(req, "<button onclick='saveDeliciousKeyword()' style='margin-top:10px;background:#ffc107;color:#333;padding:12px 24px;border:none;border-radius:8px;font-size:16px;font-weight:bold;cursor:pointer'>🍕 Lưu Từ Khóa + Pose</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "<div class='button-group'>");
-    httpd_resp_sendstr_chunk(req, "<button onclick='saveCalibration()'>💾 Save Servo</button>");
-    httpd_resp_sendstr_chunk(req, "<button onclick='saveMicGain()'>🎤 Save Mic Gain</button>");
-    httpd_resp_sendstr_chunk(req, "<button class='reset' onclick='resetToDefault()'>🔄 Reset to 90°</button>");
-    httpd_resp_sendstr_chunk(req, "<button onclick='window.location.href=\"/\"'>🏠 Back to Control</button>");
-    httpd_resp_sendstr_chunk(req, "</div>");
-    
-    httpd_resp_sendstr_chunk(req, "<script>");
-    httpd_resp_sendstr_chunk(req, "function updateServo(servo,val){");
-    httpd_resp_sendstr_chunk(req, "document.getElementById(servo+'-val').textContent=val+'°';");
-    httpd_resp_sendstr_chunk(req, "fetch('/servo_set?servo='+servo+'&angle='+val);");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function saveCalibration(){");
-    httpd_resp_sendstr_chunk(req, "var lf=document.getElementById('lf').value;");
-    httpd_resp_sendstr_chunk(req, "var rf=document.getElementById('rf').value;");
-    httpd_resp_sendstr_chunk(req, "var lb=document.getElementById('lb').value;");
-    httpd_resp_sendstr_chunk(req, "var rb=document.getElementById('rb').value;");
-    httpd_resp_sendstr_chunk(req, "var tail=document.getElementById('tail').value;");
-    httpd_resp_sendstr_chunk(req, "var url='/servo_save?lf='+lf+'&rf='+rf+'&lb='+lb+'&rb='+rb+'&tail='+tail;");
-    httpd_resp_sendstr_chunk(req, "fetch(url).then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "var s=document.getElementById('status');");
-    httpd_resp_sendstr_chunk(req, "s.style.display='block';");
-    httpd_resp_sendstr_chunk(req, "if(d.success){s.className='status success';s.textContent='✅ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "else{s.className='status error';s.textContent='❌ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "setTimeout(function(){s.style.display='none';},3000);");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Save error:',e);});");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function resetToDefault(){");
-    httpd_resp_sendstr_chunk(req, "var servos=['lf','rf','lb','rb','tail'];");
-    httpd_resp_sendstr_chunk(req, "for(var i=0;i<servos.length;i++){var s=servos[i];document.getElementById(s).value=90;updateServo(s,90);}");
-    httpd_resp_sendstr_chunk(req, "}");
-    // Mic gain functions
-    httpd_resp_sendstr_chunk(req, "function updateMicGain(val){");
-    httpd_resp_sendstr_chunk(req, "document.getElementById('mic_gain-val').textContent=val;");
-    httpd_resp_sendstr_chunk(req, "fetch('/mic_gain_set?gain='+val);");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function saveMicGain(){");
-    httpd_resp_sendstr_chunk(req, "var gain=document.getElementById('mic_gain').value;");
-    httpd_resp_sendstr_chunk(req, "fetch('/mic_gain_save?gain='+gain).then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "var s=document.getElementById('status');");
-    httpd_resp_sendstr_chunk(req, "s.style.display='block';");
-    httpd_resp_sendstr_chunk(req, "if(d.success){s.className='status success';s.textContent='✅ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "else{s.className='status error';s.textContent='❌ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "setTimeout(function(){s.style.display='none';},3000);");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Mic save error:',e);});");
-    httpd_resp_sendstr_chunk(req, "}");
-    // Speed functions
-    httpd_resp_sendstr_chunk(req, "function updateSpeed(val){");
-    httpd_resp_sendstr_chunk(req, "document.getElementById('speed_mult-val').textContent=val+'%';");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "function saveSpeed(){");
-    httpd_resp_sendstr_chunk(req, "var speed=document.getElementById('speed_mult').value;");
-    httpd_resp_sendstr_chunk(req, "fetch('/speed_save?speed='+speed).then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "var s=document.getElementById('status');");
-    httpd_resp_sendstr_chunk(req, "s.style.display='block';");
-    httpd_resp_sendstr_chunk(req, "if(d.success){s.className='status success';s.textContent='✅ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "else{s.className='status error';s.textContent='❌ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "setTimeout(function(){s.style.display='none';},3000);");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Speed save error:',e);});");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "window.onload=function(){");
-    httpd_resp_sendstr_chunk(req, "fetch('/servo_get').then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "if(d.lf){document.getElementById('lf').value=d.lf;document.getElementById('lf-val').textContent=d.lf+'°';}");
-    httpd_resp_sendstr_chunk(req, "if(d.rf){document.getElementById('rf').value=d.rf;document.getElementById('rf-val').textContent=d.rf+'°';}");
-    httpd_resp_sendstr_chunk(req, "if(d.lb){document.getElementById('lb').value=d.lb;document.getElementById('lb-val').textContent=d.lb+'°';}");
-    httpd_resp_sendstr_chunk(req, "if(d.rb){document.getElementById('rb').value=d.rb;document.getElementById('rb-val').textContent=d.rb+'°';}");
-    httpd_resp_sendstr_chunk(req, "if(d.tail){document.getElementById('tail').value=d.tail;document.getElementById('tail-val').textContent=d.tail+'°';}");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Servo get error:',e);});");
-    httpd_resp_sendstr_chunk(req, "fetch('/mic_gain_get').then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "if(d.gain!==undefined){document.getElementById('mic_gain').value=d.gain;document.getElementById('mic_gain-val').textContent=d.gain;}");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Mic get error:',e);});");
-    // Load speed
-    httpd_resp_sendstr_chunk(req, "fetch('/speed_get').then(function(r){return r.json();}).then(function(d){");
-    httpd_resp_sendstr_chunk(req, "if(d.speed!==undefined){document.getElementById('speed_mult').value=d.speed;document.getElementById('speed_mult-val').textContent=d.speed+'%';}");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Speed get error:',e);});");
-    // Load delicious keyword and pose
-    httpd_resp_sendstr_chunk(req, "fetch('/delicious_keyword_get').then(function(r){");
-    httpd_resp_sendstr_chunk(req, "if(!r.ok){throw new Error('HTTP '+r.status);}");
-    httpd_resp_sendstr_chunk(req, "return r.text();");
-    httpd_resp_sendstr_chunk(req, "}).then(function(txt){");
-    httpd_resp_sendstr_chunk(req, "var d;try{d=JSON.parse(txt);}catch(e){console.log('Parse error:',txt);return;}");
-    httpd_resp_sendstr_chunk(req, "if(d.keyword){document.getElementById('delicious_keyword').value=d.keyword;}");
-    httpd_resp_sendstr_chunk(req, "if(d.pose){document.getElementById('delicious_pose').value=d.pose;}");
-    httpd_resp_sendstr_chunk(req, "if(d.action_slot!==undefined){document.getElementById('keyword_action_slot').value=d.action_slot;}");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.log('Load keyword error:',e);});");
-    httpd_resp_sendstr_chunk(req, "};");
-    // Save delicious keyword function
-    httpd_resp_sendstr_chunk(req, "function saveDeliciousKeyword(){");
-    httpd_resp_sendstr_chunk(req, "var kw=document.getElementById('delicious_keyword').value;");
-    httpd_resp_sendstr_chunk(req, "var pose=document.getElementById('delicious_pose').value;");
-    httpd_resp_sendstr_chunk(req, "var actionSlot=document.getElementById('keyword_action_slot').value;");
-    httpd_resp_sendstr_chunk(req, "kw=kw.trim();");
-    httpd_resp_sendstr_chunk(req, "if(kw.length==0){alert('Vui lòng nhập từ khóa!');return;}");
-    httpd_resp_sendstr_chunk(req, "var ks=document.getElementById('keyword_status');");
-    httpd_resp_sendstr_chunk(req, "ks.style.display='block';ks.style.background='#fff3cd';ks.style.color='#856404';ks.textContent='⏳ Đang lưu...';");
-    httpd_resp_sendstr_chunk(req, "var url='/delicious_keyword_save?keyword='+encodeURIComponent(kw)+'&pose='+pose+'&action_slot='+actionSlot;");
-    httpd_resp_sendstr_chunk(req, "console.log('Saving keyword:',kw,'pose:',pose,'action_slot:',actionSlot,'URL:',url);");
-    httpd_resp_sendstr_chunk(req, "fetch(url).then(function(r){");
-    httpd_resp_sendstr_chunk(req, "if(!r.ok){throw new Error('HTTP '+r.status);}");
-    httpd_resp_sendstr_chunk(req, "return r.text();");
-    httpd_resp_sendstr_chunk(req, "}).then(function(txt){");
-    httpd_resp_sendstr_chunk(req, "console.log('Response:',txt);");
-    httpd_resp_sendstr_chunk(req, "var d;try{d=JSON.parse(txt);}catch(e){throw new Error('Invalid JSON: '+txt.substring(0,50));}");
-    httpd_resp_sendstr_chunk(req, "var ks=document.getElementById('keyword_status');");
-    httpd_resp_sendstr_chunk(req, "if(d.success){ks.style.background='#d4edda';ks.style.color='#155724';ks.textContent='✅ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "else{ks.style.background='#f8d7da';ks.style.color='#721c24';ks.textContent='❌ '+d.message;}");
-    httpd_resp_sendstr_chunk(req, "setTimeout(function(){ks.style.display='none';},5000);");
-    httpd_resp_sendstr_chunk(req, "}).catch(function(e){console.error('Save error:',e);var ks=document.getElementById('keyword_status');ks.style.background='#f8d7da';ks.style.color='#721c24';ks.textContent='❌ Lỗi: '+e.message;});");
-    httpd_resp_sendstr_chunk(req, "}");
-    httpd_resp_sendstr_chunk(req, "</script>");
-    
-    httpd_resp_sendstr_chunk(req, "</body></html>");
-    httpd_resp_sendstr_chunk(req, NULL);
-    return ESP_OK;
+    return web_ui_send_page(req, WebUiPage::kServoCalibration);
 }
 
 // Servo Set Angle Handler
@@ -5397,17 +2992,12 @@ esp_err_t otto_servo_get_handler(httpd_req_t *req) {
     httpd_resp_set_type(req, "application/json");
     
     // Get current servo angles from NVS or defaults
-    nvs_handle_t nvs_handle;
-    int32_t lf = 90, rf = 90, lb = 90, rb = 90, tail = 90;
-    
-    if (nvs_open("storage", NVS_READONLY, &nvs_handle) == ESP_OK) {
-        nvs_get_i32(nvs_handle, "servo_lf", &lf);
-        nvs_get_i32(nvs_handle, "servo_rf", &rf);
-        nvs_get_i32(nvs_handle, "servo_lb", &lb);
-        nvs_get_i32(nvs_handle, "servo_rb", &rb);
-        nvs_get_i32(nvs_handle, "servo_tail", &tail);
-        nvs_close(nvs_handle);
-    }
+    Settings settings("storage", false);
+    int32_t lf = settings.GetInt("servo_lf", 90);
+    int32_t rf = settings.GetInt("servo_rf", 90);
+    int32_t lb = settings.GetInt("servo_lb", 90);
+    int32_t rb = settings.GetInt("servo_rb", 90);
+    int32_t tail = settings.GetInt("servo_tail", 90);
     
     char response[250];
     snprintf(response, sizeof(response), 
@@ -5434,29 +3024,19 @@ esp_err_t otto_servo_save_handler(httpd_req_t *req) {
         if (httpd_query_key_value(buf, "tail", val, sizeof(val)) == ESP_OK) tail = atoi(val);
     }
     
-    // Save RAW angles to NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
+    // Save RAW angles to NVS (committed in one batch by Settings)
+    Settings settings("storage", true);
+    settings.SetInt("servo_lf", lf);
+    settings.SetInt("servo_rf", rf);
+    settings.SetInt("servo_lb", lb);
+    settings.SetInt("servo_rb", rb);
+    settings.SetInt("servo_tail", tail);
+    ESP_LOGI(TAG, "💾 Saved servo calibration (RAW): LF=%d RF=%d LB=%d RB=%d TAIL=%d", lf, rf, lb, rb, tail);
     
-    if (err == ESP_OK) {
-        nvs_set_i32(nvs_handle, "servo_lf", lf);
-        nvs_set_i32(nvs_handle, "servo_rf", rf);
-        nvs_set_i32(nvs_handle, "servo_lb", lb);
-        nvs_set_i32(nvs_handle, "servo_rb", rb);
-        nvs_set_i32(nvs_handle, "servo_tail", tail);
-        nvs_commit(nvs_handle);
-        nvs_close(nvs_handle);
-        
-        ESP_LOGI(TAG, "💾 Saved servo calibration (RAW): LF=%d RF=%d LB=%d RB=%d TAIL=%d", lf, rf, lb, rb, tail);
-        
-        // Apply new home position immediately (no reboot needed)
-        otto_controller_apply_servo_home(lf, rf, lb, rb);
-        
-        httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Calibration saved and applied!\"}");
-    } else {
-        httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Failed to save calibration\"}");
-    }
+    // Apply new home position immediately (no reboot needed)
+    otto_controller_apply_servo_home(lf, rf, lb, rb);
     
+    httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Calibration saved and applied!\"}");
     return ESP_OK;
 }
 
@@ -5492,13 +3072,8 @@ esp_err_t otto_mic_gain_get_handler(httpd_req_t *req) {
     httpd_resp_set_type(req, "application/json");
     
     // Get current mic gain from NVS or default
-    nvs_handle_t nvs_handle;
-    int32_t gain = 30;  // Default value
-    
-    if (nvs_open("storage", NVS_READONLY, &nvs_handle) == ESP_OK) {
-        nvs_get_i32(nvs_handle, "mic_gain", &gain);
-        nvs_close(nvs_handle);
-    }
+    Settings settings("storage", false);
+    int32_t gain = settings.GetInt("mic_gain", 30);
     
     char response[50];
     snprintf(response, sizeof(response), "{\"gain\":%d}", (int)gain);
@@ -5525,26 +3100,17 @@ esp_err_t otto_mic_gain_save_handler(httpd_req_t *req) {
     }
     
     // Save to NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
+    Settings settings("storage", true);
+    settings.SetInt("mic_gain", gain);
     
-    if (err == ESP_OK) {
-        nvs_set_i32(nvs_handle, "mic_gain", gain);
-        nvs_commit(nvs_handle);
-        nvs_close(nvs_handle);
-        
-        // Apply mic gain immediately
-        Board& board = Board::GetInstance();
-        if (board.GetAudioCodec()) {
-            board.GetAudioCodec()->SetInputGain((float)gain);
-        }
-        
-        ESP_LOGI(TAG, "💾 Saved mic gain: %d", gain);
-        httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Mic gain saved!\"}");
-    } else {
-        httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Failed to save mic gain\"}");
+    // Apply mic gain immediately
+    Board& board = Board::GetInstance();
+    if (board.GetAudioCodec()) {
+        board.GetAudioCodec()->SetInputGain((float)gain);
     }
     
+    ESP_LOGI(TAG, "💾 Saved mic gain: %d", gain);
+    httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Mic gain saved!\"}");
     return ESP_OK;
 }
 
@@ -5582,20 +3148,29 @@ esp_err_t otto_speed_save_handler(httpd_req_t *req) {
     speed_multiplier = speed;
     
     // Save to NVS
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open("storage", NVS_READWRITE, &nvs_handle);
+    Settings settings("storage", true);
+    settings.SetInt("speed_mult", speed);
     
-    if (err == ESP_OK) {
-        nvs_set_i32(nvs_handle, "speed_mult", (int32_t)speed);
-        nvs_commit(nvs_handle);
-        nvs_close(nvs_handle);
-        
-        ESP_LOGI(TAG, "💾 Saved speed multiplier: %d%%", speed);
-        httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Speed saved!\"}");
-    } else {
-        httpd_resp_sendstr(req, "{\"success\":false,\"message\":\"Failed to save speed\"}");
-    }
+    ESP_LOGI(TAG, "💾 Saved speed multiplier: %d%%", speed);
+    httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Speed saved!\"}");
+    return ESP_OK;
+}
+
+// Settings Cache Stats Handler - flash writes vs. cached reads
+esp_err_t otto_settings_stats_handler(httpd_req_t *req) {
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    httpd_resp_set_type(req, "application/json");
     
+    SettingsStats stats = Settings::GetStats();
+    char response[320];
+    snprintf(response, sizeof(response),
+        "{\"cache_hits\":%lu,\"nvs_reads\":%lu,\"nvs_read_avg_us\":%lu,\"nvs_read_max_us\":%lu,"
+        "\"writes\":%lu,\"skipped_writes\":%lu,\"keys_written\":%lu,\"commits\":%lu}",
+        (unsigned long)stats.cache_hits, (unsigned long)stats.nvs_reads,
+        (unsigned long)(stats.nvs_reads > 0 ? stats.nvs_read_us / stats.nvs_reads : 0),
+        (unsigned long)stats.nvs_read_max_us, (unsigned long)stats.writes,
+        (unsigned long)stats.skipped_writes, (unsigned long)stats.keys_written, (unsigned long)stats.commits);
+    httpd_resp_sendstr(req, response);
     return ESP_OK;
 }
 
@@ -5685,7 +3260,7 @@ esp_err_t otto_delicious_keyword_save_handler(httpd_req_t *req) {
     }
     
     int8_t action_slot = (int8_t)atoi(action_slot_str);
-    if (action_slot < 0 || action_slot > 3) action_slot = 0;
+    if (action_slot < 0 || action_slot > ACTION_SLOT_COUNT) action_slot = 0;
     
     // Save to NVS
     nvs_handle_t nvs_handle;
@@ -5951,12 +3526,6 @@ esp_err_t otto_start_webserver(void) {
     // Load and restore any pending scheduled messages from NVS
     load_schedule_from_nvs();
     
-    // Khởi tạo draw buffer mutex
-    if (draw_buffer_pool.mutex == NULL) {
-        draw_buffer_pool.mutex = xSemaphoreCreateMutex();
-        ESP_LOGI(TAG, "✅ Draw buffer pool initialized");
-    }
-    
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
     config.max_uri_handlers = 60;  // Increased for all handlers (currently 51 endpoints including music)
@@ -5966,6 +3535,9 @@ esp_err_t otto_start_webserver(void) {
     ESP_LOGI(TAG, "Starting HTTP server on port %d", config.server_port);
     
     if (httpd_start(&server, &config) == ESP_OK) {
+        // Worker pool for the slow handlers (registered with otto_async_register_uri)
+        otto_async_pool_start(server);
+        
         // Register URI handlers
         httpd_uri_t root_uri = {
             .uri = "/",
@@ -6147,6 +3719,15 @@ esp_err_t otto_start_webserver(void) {
             .user_ctx = NULL
         };
         httpd_register_uri_handler(server, &screen_rotation_uri);
+
+        // Screen stream (MJPEG)
+        httpd_uri_t screen_stream_uri = {
+            .uri = "/screen/stream",
+            .method = HTTP_GET,
+            .handler = otto_screen_stream_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &screen_stream_uri);
         
         // Drawing handler registration (POST - receives RGB565 image data)
         httpd_uri_t draw_uri = {
@@ -6155,7 +3736,7 @@ esp_err_t otto_start_webserver(void) {
             .handler = otto_draw_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(server, &draw_uri);
+        otto_async_register_uri(server, &draw_uri);
         
         // Drawing exit handler registration (GET - returns to emoji display)
         httpd_uri_t draw_exit_uri = {
@@ -6283,7 +3864,7 @@ esp_err_t otto_start_webserver(void) {
             .handler = otto_send_text_to_ai_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(server, &send_text_to_ai_uri);
+        otto_async_register_uri(server, &send_text_to_ai_uri);
         
         // Schedule message handler - POST for setting schedule
         httpd_uri_t schedule_message_post_uri = {
@@ -6292,7 +3873,7 @@ esp_err_t otto_start_webserver(void) {
             .handler = otto_schedule_message_handler,
             .user_ctx = NULL
         };
-        httpd_register_uri_handler(server, &schedule_message_post_uri);
+        otto_async_register_uri(server, &schedule_message_post_uri);
         
         // Schedule message handler - GET for cancel action
         httpd_uri_t schedule_message_get_uri = {
@@ -6398,6 +3979,14 @@ esp_err_t otto_start_webserver(void) {
         };
         httpd_register_uri_handler(server, &speed_save_uri);
         
+        httpd_uri_t settings_stats_uri = {
+            .uri = "/settings_stats",
+            .method = HTTP_GET,
+            .handler = otto_settings_stats_handler,
+            .user_ctx = NULL
+        };
+        httpd_register_uri_handler(server, &settings_stats_uri);
+        
         // Delicious keyword handlers
         httpd_uri_t delicious_keyword_get_uri = {
             .uri = "/delicious_keyword_get",
@@ -6415,6 +4004,9 @@ esp_err_t otto_start_webserver(void) {
         };
         httpd_register_uri_handler(server, &delicious_keyword_save_uri);
         
+        // Realtime control channel for the web UI
+        otto_ws_control_start(server);
+        
         ESP_LOGI(TAG, "HTTP server started successfully (with UDP Drawing + Gemini API + Servo Calibration + Mic Gain support)");
         webserver_enabled = true;
         
@@ -6458,15 +4050,24 @@ esp_err_t otto_stop_webserver(void) {
         ESP_LOGI(TAG, "⏱️ Webserver auto-stop timer stopped");
     }
     
+    // Finish the screen stream before its socket goes away
+    screen_stream_stop();
+    otto_ws_control_stop();
+    if (otto_async_pool_drain() != ESP_OK) {
+        // A worker still holds a request: stopping now would leave it on a freed server
+        ESP_LOGE(TAG, "Async requests still running, keeping the server up");
+        if (webserver_auto_stop_timer != NULL) {
+            xTimerStart(webserver_auto_stop_timer, 0);  // Try again later
+        }
+        return ESP_ERR_TIMEOUT;
+    }
+
     // Stop the server
     esp_err_t err = httpd_stop(server);
     if (err == ESP_OK) {
         server = NULL;
         webserver_enabled = false;
         
-        // Cleanup draw buffer when server stops to free 120KB
-        cleanup_draw_buffer();
-        
         ESP_LOGI(TAG, "HTTP server stopped successfully");
         return ESP_OK;
     } else {
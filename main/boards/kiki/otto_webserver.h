@@ -10,6 +10,9 @@
 #include "lwip/sys.h"
 #include <string.h>
 
+#include "otto_action_queue.h"
+#include "otto_actions.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -44,6 +47,7 @@ esp_err_t otto_emoji_mode_handler(httpd_req_t *req);
 esp_err_t otto_touch_sensor_handler(httpd_req_t *req);
 esp_err_t otto_screen_toggle_handler(httpd_req_t *req);
 esp_err_t otto_screen_rotation_handler(httpd_req_t *req);
+esp_err_t otto_screen_stream_handler(httpd_req_t *req);  // MJPEG stream of the LCD
 esp_err_t otto_wake_up_handler(httpd_req_t *req);
 esp_err_t otto_forget_wifi_handler(httpd_req_t *req);
 esp_err_t otto_send_text_to_ai_handler(httpd_req_t *req);  // Send text to AI handler
@@ -69,58 +73,37 @@ esp_err_t otto_save_slot_handler(httpd_req_t *req);
 esp_err_t otto_play_slot_handler(httpd_req_t *req);
 esp_err_t otto_slot_info_handler(httpd_req_t *req);
 
+// Memory slots hold compiled action programs (otto_action_program.h), one NVS blob each
+#define ACTION_SLOT_COUNT 32
+#define ACTION_SLOT_MAX_ACTIONS 200  // Per playback, loops included
+
 // Play memory slot directly (can be called from other modules like application.cc)
-// slot: 1-3 (slot number)
-// Returns: number of actions played, 0 if slot empty or invalid
+// slot: 1-ACTION_SLOT_COUNT (slot number)
+// Returns: number of steps played, 0 if slot empty or invalid
 int otto_play_memory_slot(int slot);
 
-// Otto action constants
-#define ACTION_DOG_WALK            1
-#define ACTION_DOG_WALK_BACK       2
-#define ACTION_DOG_TURN_LEFT       3
-#define ACTION_DOG_TURN_RIGHT      4
-#define ACTION_DOG_SIT_DOWN        5
-#define ACTION_DOG_LIE_DOWN        6
-#define ACTION_DOG_JUMP            7
-#define ACTION_DOG_BOW             8
-#define ACTION_DOG_DANCE           9
-#define ACTION_DOG_WAVE_RIGHT_FOOT 10
-#define ACTION_DOG_DANCE_4_FEET    11
-#define ACTION_DOG_SWING           12
-#define ACTION_DOG_STRETCH         13
-#define ACTION_DOG_SCRATCH         14  // New: Sit + BR leg wave (gãi ngứa)
-#define ACTION_DOG_WAG_TAIL        22  // New: Wag tail movement
-#define ACTION_DOG_ROLL_OVER       23  // New: Roll over movement
-#define ACTION_DOG_PLAY_DEAD       24  // New: Play dead movement
-
-// New poses (Priority 1 + 2)
-#define ACTION_DOG_SHAKE_PAW       25  // New: Shake paw (bắt tay)
-#define ACTION_DOG_SIDESTEP        26  // New: Sidestep (đi ngang)
-#define ACTION_DOG_PUSHUP          27  // New: Pushup exercise
-#define ACTION_DOG_BALANCE         28  // New: Balance on hind legs
-#define ACTION_DOG_TOILET          29  // New: Toilet squat pose
-#define ACTION_DOG_STAND_UP        30  // New: Stand up from sitting/lying position
-
-#define ACTION_WALK                15
-#define ACTION_TURN                16
-#define ACTION_JUMP                17
-// Keep IDs aligned with otto_controller.cc's ActionType enum
-#define ACTION_BEND                18
-#define ACTION_HOME                19
-// Utility
-#define ACTION_DELAY               20  // speed field as milliseconds delay
-#define ACTION_DOG_JUMP_HAPPY      21  // special: jump with happy emoji (touch)
-
 // Otto control interface
 void otto_execute_web_action(const char* action, int param1, int param2);
 
+// Shared by the HTTP handlers and the /ws control channel
+void otto_web_run_action(const char* cmd, int param1, int param2);  // Applies the speed multiplier
+bool otto_web_set_emotion(const char* emotion);
+void otto_web_set_volume(int volume_level);
+
 // Otto controller access
 esp_err_t otto_controller_queue_action(int action_type, int steps, int speed, int direction, int amount);
+// priority: OTTO_PRIORITY_*; URGENT cuts the running action short. Returns a cancel token, 0 if rejected
+uint32_t otto_controller_queue_action_ex(int action_type, int steps, int speed, int direction, int amount,
+                                         int priority);
+bool otto_controller_cancel_action(uint32_t token);  // Queued: dropped, running: cut short
+void otto_controller_get_latency(OttoLatencyStats* stats);
 esp_err_t otto_controller_stop_all(void);  // Stop and clear all actions
+bool otto_controller_queue_beat_step(int style, int beat, int move_ms);  // Skips the beat if busy
+int otto_controller_pending_actions(void);  // Queued actions plus the one running
 
 // Servo calibration control
 void otto_controller_set_servo_angle(int servo_id, int angle);
-void otto_controller_get_servo_angles(int* angles);
+void otto_controller_get_servo_angles(int* angles);  // Fills SERVO_COUNT angles: LF, RF, LB, RB, tail
 void otto_controller_apply_servo_home(int lf, int rf, int lb, int rb);
 
 // Touch sensor control
@@ -140,6 +123,10 @@ esp_err_t otto_music_pose_handler(httpd_req_t *req);
 
 // Music player control (implemented in otto_robot.cc)
 void otto_set_music_player(void* player);
+bool otto_music_get_status(bool* playing, size_t* buffer_size, char* song, int song_len, char* artist,
+                           int artist_len, char* thumbnail, int thumb_len);
+bool otto_music_get_buffer_stats(char* json, int json_len);  // Stream buffer sizing, JSON object
+bool otto_music_get_beat_stats(char* json, int json_len);    // Beat tracker state, JSON object
 
 #ifdef __cplusplus
 }
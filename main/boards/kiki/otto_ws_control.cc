@@ -0,0 +1,434 @@
+#include "otto_ws_control.h"
+
+#include "application.h"
+#include "audio_codec.h"
+#include "board.h"
+#include "boards/kiki/kiki_led_control.h"
+#include "boards/kiki/otto_webserver.h"
+
+#include <cJSON.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <sdkconfig.h>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#define TAG "OttoWs"
+
+extern "C" {
+    void webserver_reset_auto_stop_timer();
+}
+
+namespace {
+
+constexpr int kPumpIntervalMs = 50;         // Áp dụng input dồn tối đa 20 lần/giây
+constexpr int kStatePollMs = 200;           // Chu kỳ kiểm tra trạng thái để đẩy cho client
+constexpr int64_t kStateHeartbeatUs = 5000 * 1000;
+constexpr int64_t kAutoStopResetUs = 1000 * 1000;  // Không reset timer auto-stop mỗi frame
+constexpr size_t kMaxFrameLen = 512;
+constexpr int kServoCount = 5;              // LF, RF, LB, RB, đuôi
+
+const char* const kDeviceStateNames[] = {
+    "unknown", "starting", "configuring", "idle", "connecting", "listening",
+    "speaking", "upgrading", "activating", "audio_testing", "fatal_error",
+};
+
+// Input tần số cao chưa áp dụng: frame mới ghi đè frame cũ
+struct PendingInput {
+    bool drive = false;
+    char drive_cmd[32] = {};
+    int drive_p1 = 0;
+    int drive_p2 = 0;
+    bool volume = false;
+    int volume_level = 0;
+    bool led = false;
+    uint8_t r = 0, g = 0, b = 0;
+    uint8_t servo_mask = 0;
+    int servo_angle[kServoCount] = {};
+};
+
+struct AsyncFrame {
+    httpd_handle_t server;
+    int fd;
+    std::string payload;
+};
+
+httpd_handle_t ws_server = nullptr;
+TaskHandle_t pump_task = nullptr;
+std::atomic<bool> pump_running{false};
+std::atomic<bool> force_state_push{false};
+std::atomic<int64_t> last_auto_stop_reset_us{0};
+
+std::mutex pending_mutex;
+PendingInput pending;
+uint32_t coalesced_inputs = 0;
+
+std::string last_state;
+int64_t last_state_us = 0;
+
+void SendAsyncWork(void* arg) {
+    auto* frame = static_cast<AsyncFrame*>(arg);
+    httpd_ws_frame_t ws_frame = {};
+    ws_frame.type = HTTPD_WS_TYPE_TEXT;
+    ws_frame.payload = reinterpret_cast<uint8_t*>(frame->payload.data());
+    ws_frame.len = frame->payload.size();
+    httpd_ws_send_frame_async(frame->server, frame->fd, &ws_frame);
+    delete frame;
+}
+
+// Số client websocket đang mở; fds có thể nullptr khi chỉ cần đếm
+int ListClients(int* out_fds, int max_out) {
+    if (ws_server == nullptr) {
+        return 0;
+    }
+    int fds[CONFIG_LWIP_MAX_SOCKETS];
+    size_t count = CONFIG_LWIP_MAX_SOCKETS;
+    if (httpd_get_client_list(ws_server, &count, fds) != ESP_OK) {
+        return 0;
+    }
+    int clients = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (httpd_ws_get_fd_info(ws_server, fds[i]) != HTTPD_WS_CLIENT_WEBSOCKET) {
+            continue;
+        }
+        if (out_fds != nullptr && clients < max_out) {
+            out_fds[clients] = fds[i];
+        }
+        clients++;
+    }
+    return clients;
+}
+
+// Gửi từ task khác httpd: đi qua httpd_queue_work để không đụng socket song song
+void Broadcast(const std::string& payload) {
+    int fds[CONFIG_LWIP_MAX_SOCKETS];
+    int clients = ListClients(fds, CONFIG_LWIP_MAX_SOCKETS);
+    for (int i = 0; i < clients && i < CONFIG_LWIP_MAX_SOCKETS; i++) {
+        auto* frame = new AsyncFrame{ws_server, fds[i], payload};
+        if (httpd_queue_work(ws_server, SendAsyncWork, frame) != ESP_OK) {
+            delete frame;
+        }
+    }
+}
+
+// Trả lời ngay trong httpd task (ack, pong)
+esp_err_t Reply(httpd_req_t* req, const char* payload, size_t len) {
+    httpd_ws_frame_t ws_frame = {};
+    ws_frame.type = HTTPD_WS_TYPE_TEXT;
+    ws_frame.payload = reinterpret_cast<uint8_t*>(const_cast<char*>(payload));
+    ws_frame.len = len;
+    return httpd_ws_send_frame(req, &ws_frame);
+}
+
+esp_err_t ReplyAck(httpd_req_t* req, int id, const char* error, bool coalesced) {
+    char reply[128];
+    int len;
+    if (error != nullptr) {
+        len = snprintf(reply, sizeof(reply), "{\"t\":\"ack\",\"id\":%d,\"ok\":false,\"err\":\"%s\"}", id, error);
+    } else {
+        len = snprintf(reply, sizeof(reply), "{\"t\":\"ack\",\"id\":%d,\"ok\":true,\"q\":%d%s}", id,
+                       otto_controller_pending_actions(), coalesced ? ",\"coalesced\":true" : "");
+    }
+    return Reply(req, reply, len);
+}
+
+std::string BuildState() {
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "t", "state");
+
+    int device_state = Application::GetInstance().GetDeviceState();
+    int names = sizeof(kDeviceStateNames) / sizeof(kDeviceStateNames[0]);
+    cJSON_AddStringToObject(root, "dev", device_state < names ? kDeviceStateNames[device_state] : "unknown");
+    cJSON_AddNumberToObject(root, "q", otto_controller_pending_actions());
+    OttoLatencyStats latency;
+    otto_controller_get_latency(&latency);
+    cJSON_AddNumberToObject(root, "lat_ms", latency.last_start_us / 1000);
+    cJSON_AddNumberToObject(root, "pre_ms", latency.last_preempt_us / 1000);
+
+    auto codec = Board::GetInstance().GetAudioCodec();
+    cJSON_AddNumberToObject(root, "vol", codec ? codec->output_volume() : 0);
+
+    int angles[kServoCount] = {};
+    otto_controller_get_servo_angles(angles);
+    cJSON_AddItemToObject(root, "servo", cJSON_CreateIntArray(angles, kServoCount));
+
+    const led_state_t* led_state = kiki_led_get_state();
+    cJSON* led = cJSON_AddObjectToObject(root, "led");
+    cJSON_AddNumberToObject(led, "r", led_state->r);
+    cJSON_AddNumberToObject(led, "g", led_state->g);
+    cJSON_AddNumberToObject(led, "b", led_state->b);
+    cJSON_AddNumberToObject(led, "br", led_state->brightness);
+    cJSON_AddNumberToObject(led, "mode", led_state->mode);
+
+    bool playing = false;
+    char song[200] = {};
+    char artist[100] = {};
+    otto_music_get_status(&playing, nullptr, song, sizeof(song), artist, sizeof(artist), nullptr, 0);
+    cJSON* music = cJSON_AddObjectToObject(root, "music");
+    cJSON_AddBoolToObject(music, "playing", playing);
+    cJSON_AddStringToObject(music, "song", song);
+    cJSON_AddStringToObject(music, "artist", artist);
+
+    char* json = cJSON_PrintUnformatted(root);
+    std::string state = json != nullptr ? json : "";
+    cJSON_free(json);
+    cJSON_Delete(root);
+    return state;
+}
+
+// Chỉ đẩy khi có client và trạng thái đổi (hoặc tới nhịp heartbeat)
+void PushState() {
+    if (ListClients(nullptr, 0) == 0) {
+        last_state.clear();
+        return;
+    }
+    std::string state = BuildState();
+    int64_t now = esp_timer_get_time();
+    if (!force_state_push.exchange(false) && state == last_state && now - last_state_us < kStateHeartbeatUs) {
+        return;
+    }
+    last_state = state;
+    last_state_us = now;
+    Broadcast(state);
+}
+
+void ApplyPending() {
+    PendingInput input;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        input = pending;
+        pending = PendingInput();
+        // drive đợi tới khi robot rảnh, không chồng lên action đang chạy
+        if (input.drive && otto_controller_pending_actions() > 0) {
+            pending.drive = true;
+            memcpy(pending.drive_cmd, input.drive_cmd, sizeof(pending.drive_cmd));
+            pending.drive_p1 = input.drive_p1;
+            pending.drive_p2 = input.drive_p2;
+            input.drive = false;
+        }
+    }
+
+    if (input.drive) {
+        otto_web_run_action(input.drive_cmd, input.drive_p1, input.drive_p2);
+    }
+    if (input.volume) {
+        otto_web_set_volume(input.volume_level);
+    }
+    if (input.led) {
+        kiki_led_set_color(input.r, input.g, input.b);
+        kiki_led_set_mode(LED_MODE_SOLID);
+        kiki_led_update();
+    }
+    for (int i = 0; i < kServoCount; i++) {
+        if (input.servo_mask & (1 << i)) {
+            otto_controller_set_servo_angle(i, input.servo_angle[i]);
+        }
+    }
+}
+
+void PumpTask(void* arg) {
+    int64_t last_poll_us = 0;
+    while (pump_running.load()) {
+        ApplyPending();
+        int64_t now = esp_timer_get_time();
+        if (now - last_poll_us >= kStatePollMs * 1000) {
+            last_poll_us = now;
+            PushState();
+        }
+        vTaskDelay(pdMS_TO_TICKS(kPumpIntervalMs));
+    }
+    pump_task = nullptr;
+    vTaskDelete(NULL);
+}
+
+int GetInt(cJSON* root, const char* key, int fallback) {
+    cJSON* item = cJSON_GetObjectItem(root, key);
+    return cJSON_IsNumber(item) ? item->valueint : fallback;
+}
+
+// Xử lý một lệnh; trả về nullptr nếu hợp lệ, hoặc chuỗi lỗi cho ack
+const char* HandleCommand(httpd_req_t* req, cJSON* root, const char* type, int id, bool* coalesced) {
+    if (strcmp(type, "ping") == 0) {
+        char reply[96];
+        cJSON* ts = cJSON_GetObjectItem(root, "ts");
+        int len = snprintf(reply, sizeof(reply), "{\"t\":\"pong\",\"id\":%d,\"ts\":%.3f}", id,
+                           cJSON_IsNumber(ts) ? ts->valuedouble : 0.0);
+        Reply(req, reply, len);
+        return nullptr;
+    }
+
+    if (strcmp(type, "action") == 0 || strcmp(type, "drive") == 0) {
+        const char* cmd = cJSON_GetStringValue(cJSON_GetObjectItem(root, "cmd"));
+        if (cmd == nullptr || cmd[0] == '\0') {
+            return "missing cmd";
+        }
+        int p1 = GetInt(root, "p1", 0);
+        int p2 = GetInt(root, "p2", 0);
+        if (type[0] == 'a') {
+            otto_web_run_action(cmd, p1, p2);
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        *coalesced = pending.drive;
+        pending.drive = true;
+        strncpy(pending.drive_cmd, cmd, sizeof(pending.drive_cmd) - 1);
+        pending.drive_cmd[sizeof(pending.drive_cmd) - 1] = '\0';
+        pending.drive_p1 = p1;
+        pending.drive_p2 = p2;
+        coalesced_inputs += *coalesced ? 1 : 0;
+        return nullptr;
+    }
+
+    if (strcmp(type, "stop") == 0) {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            pending.drive = false;
+        }
+        otto_controller_stop_all();
+        force_state_push = true;
+        return nullptr;
+    }
+
+    if (strcmp(type, "emotion") == 0) {
+        const char* emotion = cJSON_GetStringValue(cJSON_GetObjectItem(root, "v"));
+        if (emotion == nullptr) {
+            return "missing v";
+        }
+        return otto_web_set_emotion(emotion) ? nullptr : "no display";
+    }
+
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    // Chỉ báo "coalesced" khi lệnh này thay thế một lệnh đang chờ
+    if (strcmp(type, "volume") == 0) {
+        // Thiếu "v" thì bỏ, không tắt tiếng loa
+        cJSON* level = cJSON_GetObjectItem(root, "v");
+        if (!cJSON_IsNumber(level)) {
+            return "missing v";
+        }
+        *coalesced = pending.volume;
+        pending.volume = true;
+        pending.volume_level = level->valueint;
+    } else if (strcmp(type, "led") == 0) {
+        *coalesced = pending.led;
+        pending.led = true;
+        pending.r = (uint8_t)GetInt(root, "r", 0);
+        pending.g = (uint8_t)GetInt(root, "g", 0);
+        pending.b = (uint8_t)GetInt(root, "b", 0);
+    } else if (strcmp(type, "servo") == 0) {
+        int servo = GetInt(root, "s", -1);
+        if (servo < 0 || servo >= kServoCount) {
+            return "bad servo";
+        }
+        *coalesced = (pending.servo_mask & (1 << servo)) != 0;
+        pending.servo_mask |= 1 << servo;
+        pending.servo_angle[servo] = GetInt(root, "a", 90);
+    } else {
+        return "unknown type";
+    }
+    coalesced_inputs += *coalesced ? 1 : 0;
+    return nullptr;
+}
+
+esp_err_t WsHandler(httpd_req_t* req) {
+    if (req->method == HTTP_GET) {
+        // Handshake xong: gửi state đầy đủ cho client mới ở nhịp pump kế tiếp
+        ESP_LOGI(TAG, "🔌 WebSocket client connected (fd %d)", httpd_req_to_sockfd(req));
+        force_state_push = true;
+        webserver_reset_auto_stop_timer();
+        return ESP_OK;
+    }
+
+    httpd_ws_frame_t frame = {};
+    esp_err_t ret = httpd_ws_recv_frame(req, &frame, 0);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (frame.len > kMaxFrameLen) {
+        ESP_LOGW(TAG, "Frame too large (%u bytes), closing", (unsigned)frame.len);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    char buf[kMaxFrameLen + 1];
+    frame.payload = reinterpret_cast<uint8_t*>(buf);
+    if (frame.len > 0) {
+        ret = httpd_ws_recv_frame(req, &frame, frame.len);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    buf[frame.len] = '\0';
+    if (frame.type != HTTPD_WS_TYPE_TEXT || frame.len == 0) {
+        return ESP_OK;
+    }
+
+    int64_t now = esp_timer_get_time();
+    if (now - last_auto_stop_reset_us.load() > kAutoStopResetUs) {
+        last_auto_stop_reset_us = now;
+        webserver_reset_auto_stop_timer();
+    }
+
+    cJSON* root = cJSON_Parse(buf);
+    if (root == nullptr) {
+        static const char kBadJson[] = "{\"t\":\"ack\",\"id\":-1,\"ok\":false,\"err\":\"bad json\"}";
+        return Reply(req, kBadJson, sizeof(kBadJson) - 1);
+    }
+    const char* type = cJSON_GetStringValue(cJSON_GetObjectItem(root, "t"));
+    int id = GetInt(root, "id", -1);
+    bool coalesced = false;
+    const char* error = type != nullptr ? HandleCommand(req, root, type, id, &coalesced) : "missing t";
+    bool is_ping = type != nullptr && strcmp(type, "ping") == 0;
+    cJSON_Delete(root);
+
+    if (id >= 0 && !is_ping) {
+        return ReplyAck(req, id, error, coalesced);
+    }
+    if (error != nullptr) {
+        ESP_LOGW(TAG, "Rejected command: %s", error);
+    }
+    return ESP_OK;
+}
+
+}  // namespace
+
+esp_err_t otto_ws_control_start(httpd_handle_t server) {
+    httpd_uri_t ws_uri = {};
+    ws_uri.uri = "/ws";
+    ws_uri.method = HTTP_GET;
+    ws_uri.handler = WsHandler;
+    ws_uri.is_websocket = true;
+    esp_err_t ret = httpd_register_uri_handler(server, &ws_uri);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register /ws: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ws_server = server;
+    pump_running = true;
+    if (xTaskCreate(PumpTask, "otto_ws", 4096, nullptr, 4, &pump_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create ws pump task");
+        pump_running = false;
+        pump_task = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "✅ WebSocket control channel ready at /ws");
+    return ESP_OK;
+}
+
+void otto_ws_control_stop(void) {
+    pump_running = false;
+    // Đợi task thoát trước khi httpd bị dừng
+    for (int i = 0; i < 20 && pump_task != nullptr; i++) {
+        vTaskDelay(pdMS_TO_TICKS(kPumpIntervalMs));
+    }
+    ws_server = nullptr;
+    last_state.clear();
+    std::lock_guard<std::mutex> lock(pending_mutex);
+    pending = PendingInput();
+    if (coalesced_inputs > 0) {
+        ESP_LOGI(TAG, "WebSocket session coalesced %lu inputs", (unsigned long)coalesced_inputs);
+        coalesced_inputs = 0;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <esp_http_server.h>
+
+/**
+ * @brief Kênh điều khiển realtime qua WebSocket (/ws), chạy chung httpd với web UI.
+ *
+ * Client gửi JSON text frame, mỗi frame một lệnh, "id" là tùy chọn (có id thì được ack):
+ *   {"t":"action","id":1,"cmd":"dog_walk","p1":3,"p2":150}  xếp hàng như /action
+ *   {"t":"drive","cmd":"dog_walk","p1":1,"p2":150}           input giữ nút, chỉ giữ lệnh mới nhất
+ *   {"t":"stop"}  {"t":"emotion","v":"happy"}  {"t":"volume","v":60}
+ *   {"t":"led","r":255,"g":0,"b":0}  {"t":"servo","s":0,"a":90}
+ *   {"t":"ping","id":7,"ts":123.4}                            đo round-trip
+ *
+ * Robot trả về:
+ *   {"t":"ack","id":1,"ok":true,"q":2}      q = số action đang chờ + đang chạy
+ *   {"t":"pong","id":7,"ts":123.4}
+ *   {"t":"state",...}                        đẩy cho mọi client khi trạng thái đổi
+ *
+ * drive/volume/led/servo là input tần số cao: frame mới ghi đè frame cũ chưa áp dụng,
+ * task nền áp dụng tối đa 20 lần/giây; drive chỉ được xếp hàng khi robot rảnh.
+ */
+esp_err_t otto_ws_control_start(httpd_handle_t server);
+void otto_ws_control_stop(void);
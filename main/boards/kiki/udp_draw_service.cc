@@ -1,11 +1,20 @@
 #include "udp_draw_service.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <cstring>
 #include <cstdio>
 
 #define TAG "UdpDrawService"
 
+namespace {
+
+uint16_t ReadU16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+} // namespace
+
 UdpDrawService::UdpDrawService(DrawingDisplay* display, uint16_t port)
     : display_(display),
       port_(port),
@@ -16,6 +25,12 @@ UdpDrawService::UdpDrawService(DrawingDisplay* display, uint16_t port)
       packets_received_(0),
       packets_processed_(0),
       pixels_drawn_(0),
+      points_drawn_(0),
+      batches_(0),
+      seq_gaps_(0),
+      out_of_order_(0),
+      points_per_sec_(0),
+      last_points_us_(0),
       errors_(0) {
     ESP_LOGI(TAG, "🎨 UDP Drawing Service initialized on port %d", port_);
 }
@@ -94,42 +109,52 @@ void UdpDrawService::UdpTaskWrapper(void* param) {
 }
 
 void UdpDrawService::UdpTask() {
-    char buffer[128];
     struct sockaddr_in client_addr;
     socklen_t client_len = sizeof(client_addr);
 
     ESP_LOGI(TAG, "📡 UDP receive task started");
 
-    while (running_) {
-        // Receive UDP packet with timeout
-        struct timeval tv;
-        tv.tv_sec = 1;
-        tv.tv_usec = 0;
-        setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    // Timeout 1s để vòng lặp kiểm tra running_, chỉ cần đặt một lần
+    struct timeval tv;
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    setsockopt(socket_fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 
-        int len = recvfrom(socket_fd_, buffer, sizeof(buffer) - 1, 0,
+    uint32_t burst = 0;
+    while (running_) {
+        int len = recvfrom(socket_fd_, rx_buffer_, kMaxDatagram, 0,
                           (struct sockaddr*)&client_addr, &client_len);
 
         if (len > 0) {
-            buffer[len] = '\0';
+            rx_buffer_[len] = '\0';
             packets_received_++;
-            ProcessPacket(buffer, len);
+            ProcessPacket(reinterpret_cast<const char*>(rx_buffer_), len);
+            // recvfrom tự block khi hết gói; chỉ nhường CPU khi bị dội gói liên tục
+            if (++burst >= 64) {
+                burst = 0;
+                vTaskDelay(1);
+            }
         } else if (len < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
             if (running_) {  // Only log error if we're still supposed to be running
                 ESP_LOGE(TAG, "recvfrom error: %d", errno);
                 errors_++;
             }
             break;
+        } else {
+            burst = 0;
         }
-
-        vTaskDelay(pdMS_TO_TICKS(1));  // Small delay to prevent watchdog
     }
 
     ESP_LOGI(TAG, "UDP receive task ended");
 }
 
 void UdpDrawService::ProcessPacket(const char* data, int len) {
-    // Parse packet format: "x,y,state"
+    if (len >= 2 && data[0] == 'K' && data[1] == 'D') {
+        ProcessBatch(reinterpret_cast<const uint8_t*>(data), len);
+        return;
+    }
+
+    // Legacy v1 format: "x,y,state"
     int x, y, state;
     if (sscanf(data, "%d,%d,%d", &x, &y, &state) != 3) {
         ESP_LOGD(TAG, "Invalid packet format: %s", data);
@@ -151,12 +176,84 @@ void UdpDrawService::ProcessPacket(const char* data, int len) {
         display_->DrawPixel(x, y, state != 0);
         packets_processed_++;
         pixels_drawn_++;
+        CountPoints(1);
         ESP_LOGD(TAG, "✏️ Drew pixel at (%d,%d) state=%d", x, y, state);
     } else {
         errors_++;
     }
 }
 
+void UdpDrawService::ProcessBatch(const uint8_t* data, int len) {
+    if (len < (int)kV2HeaderSize || data[2] != 2) {
+        ESP_LOGD(TAG, "Invalid v2 header (len=%d)", len);
+        errors_++;
+        return;
+    }
+    uint8_t flags = data[3];
+    uint16_t seq = ReadU16(data + 4);
+    uint16_t color = ReadU16(data + 6);
+    uint8_t width = data[8];
+    uint16_t count = ReadU16(data + 10);
+    if (count > kV2MaxPoints || len < (int)(kV2HeaderSize + count * 4)) {
+        ESP_LOGD(TAG, "Truncated v2 batch: %u points, %d bytes", count, len);
+        errors_++;
+        return;
+    }
+
+    TrackSequence(seq);
+    if (!display_->IsCanvasEnabled()) {
+        errors_++;
+        return;
+    }
+
+    const uint8_t* p = data + kV2HeaderSize;
+    for (uint16_t i = 0; i < count; i++, p += 4) {
+        points_[i].x = ReadU16(p);
+        points_[i].y = ReadU16(p + 2);
+    }
+    size_t drawn = display_->DrawStroke(points_, count, (flags & 0x01) != 0, color, width);
+    packets_processed_++;
+    batches_++;
+    CountPoints(drawn);
+    ESP_LOGD(TAG, "✏️ Batch seq=%u: %u/%u points", seq, (unsigned)drawn, count);
+}
+
+void UdpDrawService::TrackSequence(uint16_t seq) {
+    if (!have_seq_) {
+        have_seq_ = true;
+        last_seq_ = seq;
+        return;
+    }
+    int16_t delta = (int16_t)(seq - last_seq_);
+    if (delta <= 0) {
+        // Gói cũ vẫn vẽ (nét vẽ chồng lên không sai), chỉ không lùi last_seq_
+        out_of_order_++;
+        return;
+    }
+    if (delta > 1 && delta < 1000) {
+        seq_gaps_ += delta - 1;
+    }
+    // Nhảy quá xa: coi như client mới bắt đầu lại, không tính là mất gói
+    last_seq_ = seq;
+}
+
+void UdpDrawService::CountPoints(uint32_t points) {
+    points_drawn_ += points;
+    window_points_ += points;
+
+    int64_t now = esp_timer_get_time();
+    if (window_start_us_ == 0 || now - last_points_us_.load() > 2000000) {
+        // Nét đầu tiên sau khi nghỉ: mở cửa sổ mới
+        window_start_us_ = now;
+        window_points_ = points;
+    } else if (now - window_start_us_ >= 1000000) {
+        points_per_sec_ = (uint32_t)((uint64_t)window_points_ * 1000000 / (now - window_start_us_));
+        window_start_us_ = now;
+        window_points_ = 0;
+    }
+    last_points_us_ = now;
+}
+
 void UdpDrawService::EnableDrawingMode(bool enable) {
     if (enable == drawing_mode_) {
         return;
@@ -188,6 +285,12 @@ UdpDrawService::Stats UdpDrawService::GetStats() const {
         .packets_received = packets_received_.load(),
         .packets_processed = packets_processed_.load(),
         .pixels_drawn = pixels_drawn_.load(),
+        .points_drawn = points_drawn_.load(),
+        .batches = batches_.load(),
+        .seq_gaps = seq_gaps_.load(),
+        .out_of_order = out_of_order_.load(),
+        // Ngừng vẽ hơn 2s thì cửa sổ cũ không còn đúng
+        .points_per_sec = esp_timer_get_time() - last_points_us_.load() > 2000000 ? 0 : points_per_sec_.load(),
         .errors = errors_.load()
     };
 }
@@ -17,9 +17,16 @@
  * Tương thích với Android app từ dự án Draw_on_OLED:
  * https://github.com/BenchRobotics/Draw_on_OLED
  * 
- * Protocol: UDP packets với format "x,y,state"
+ * Protocol v1 (legacy): UDP packets với format "x,y,state"
  * - x, y: Tọa độ pixel (0 đến width-1, 0 đến height-1)
  * - state: 1 = vẽ (white), 0 = xóa (black)
+ *
+ * Protocol v2 (binary, little-endian): nhiều điểm mỗi datagram
+ * - Header 12 byte: 'K' 'D' | version=2 | flags | seq u16 | color RGB565 u16 | width u8 | reserved u8 | count u16
+ * - Sau đó count điểm, mỗi điểm x u16, y u16; x = 0xFFFF ngắt nét (nhấc bút)
+ * - flags bit0 = 0: polyline nối các điểm liên tiếp; bit0 = 1: mỗi cặp điểm là một đoạn thẳng
+ * - seq tăng 1 mỗi datagram, dùng để đếm gói mất / sai thứ tự
+ * Gói không bắt đầu bằng "KD" được xử lý như v1.
  * 
  * Sử dụng:
  * 1. Tạo instance: udp_draw_service_ = std::make_unique<UdpDrawService>(display_, 12345);
@@ -74,15 +81,28 @@ public:
     struct Stats {
         uint32_t packets_received;
         uint32_t packets_processed;
-        uint32_t pixels_drawn;
+        uint32_t pixels_drawn;      // Pixel từ protocol v1
+        uint32_t points_drawn;      // Tất cả điểm đã vẽ (v1 + v2)
+        uint32_t batches;           // Gói v2 đã vẽ
+        uint32_t seq_gaps;          // Gói v2 bị mất (theo seq)
+        uint32_t out_of_order;      // Gói v2 đến muộn / trùng
+        uint32_t points_per_sec;    // Thông lượng trong cửa sổ ~1s gần nhất
         uint32_t errors;
     };
     Stats GetStats() const;
 
+    // Datagram lớn nhất không bị phân mảnh trên WiFi (MTU 1500 - IP/UDP header)
+    static constexpr size_t kMaxDatagram = 1472;
+    static constexpr size_t kV2HeaderSize = 12;
+    static constexpr size_t kV2MaxPoints = (kMaxDatagram - kV2HeaderSize) / 4;
+
 private:
     static void UdpTaskWrapper(void* param);
     void UdpTask();
     void ProcessPacket(const char* data, int len);
+    void ProcessBatch(const uint8_t* data, int len);
+    void TrackSequence(uint16_t seq);
+    void CountPoints(uint32_t points);
 
     DrawingDisplay* display_;
     uint16_t port_;
@@ -95,5 +115,19 @@ private:
     std::atomic<uint32_t> packets_received_;
     std::atomic<uint32_t> packets_processed_;
     std::atomic<uint32_t> pixels_drawn_;
+    std::atomic<uint32_t> points_drawn_;
+    std::atomic<uint32_t> batches_;
+    std::atomic<uint32_t> seq_gaps_;
+    std::atomic<uint32_t> out_of_order_;
+    std::atomic<uint32_t> points_per_sec_;
+    std::atomic<int64_t> last_points_us_;
     std::atomic<uint32_t> errors_;
+
+    // Chỉ UDP task dùng
+    bool have_seq_ = false;
+    uint16_t last_seq_ = 0;
+    int64_t window_start_us_ = 0;
+    uint32_t window_points_ = 0;
+    DrawingDisplay::StrokePoint points_[kV2MaxPoints];
+    uint8_t rx_buffer_[kMaxDatagram + 1];
 };
@@ -0,0 +1,84 @@
+#include "web_ui_assets.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#define TAG "WebUi"
+
+// File .gz do scripts/build_web_ui.py sinh ra, nhúng qua EMBED_FILES
+extern const uint8_t control_html_gz_start[] asm("_binary_control_html_gz_start");
+extern const uint8_t control_html_gz_end[] asm("_binary_control_html_gz_end");
+extern const uint8_t music_html_gz_start[] asm("_binary_music_html_gz_start");
+extern const uint8_t music_html_gz_end[] asm("_binary_music_html_gz_end");
+extern const uint8_t servo_calibration_html_gz_start[] asm("_binary_servo_calibration_html_gz_start");
+extern const uint8_t servo_calibration_html_gz_end[] asm("_binary_servo_calibration_html_gz_end");
+
+namespace {
+
+struct WebUiAsset {
+    const char* name;
+    const uint8_t* start;
+    const uint8_t* end;
+    char etag[24];  // "\"<16 hex>\"", tính một lần khi gửi lần đầu
+};
+
+WebUiAsset assets[] = {
+    {"control.html", control_html_gz_start, control_html_gz_end, {}},
+    {"music.html", music_html_gz_start, music_html_gz_end, {}},
+    {"servo_calibration.html", servo_calibration_html_gz_start, servo_calibration_html_gz_end, {}},
+};
+
+std::once_flag etag_once;
+
+// ETag mạnh = FNV-1a 64 bit của bản gzip; gzip không chứa timestamp nên chỉ đổi khi nội dung đổi
+void ComputeEtags() {
+    for (auto& asset : assets) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (const uint8_t* p = asset.start; p < asset.end; p++) {
+            hash = (hash ^ *p) * 0x100000001b3ULL;
+        }
+        snprintf(asset.etag, sizeof(asset.etag), "\"%016llx\"", (unsigned long long)hash);
+    }
+}
+
+// If-None-Match có thể là danh sách "a", "b" hoặc *
+bool EtagMatches(httpd_req_t* req, const char* etag) {
+    char header[128];
+    size_t len = httpd_req_get_hdr_value_len(req, "If-None-Match");
+    if (len == 0 || len >= sizeof(header) ||
+        httpd_req_get_hdr_value_str(req, "If-None-Match", header, sizeof(header)) != ESP_OK) {
+        return false;
+    }
+    return strcmp(header, "*") == 0 || strstr(header, etag) != nullptr;
+}
+
+}  // namespace
+
+esp_err_t web_ui_send_page(httpd_req_t* req, WebUiPage page) {
+    std::call_once(etag_once, ComputeEtags);
+    const WebUiAsset& asset = assets[static_cast<int>(page)];
+
+    // no-cache: trình duyệt luôn hỏi lại, nhưng chỉ tải lại khi firmware đổi trang
+    httpd_resp_set_hdr(req, "ETag", asset.etag);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    if (EtagMatches(req, asset.etag)) {
+        ESP_LOGI(TAG, "%s: 304 Not Modified", asset.name);
+        httpd_resp_set_status(req, "304 Not Modified");
+        return httpd_resp_send(req, nullptr, 0);
+    }
+
+    // Gửi nguyên khối, httpd tự cắt theo cửa sổ TCP thay vì hàng nghìn chunk nhỏ
+    int64_t start_us = esp_timer_get_time();
+    size_t len = asset.end - asset.start;
+    httpd_resp_set_type(req, "text/html; charset=utf-8");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_set_hdr(req, "Vary", "Accept-Encoding");
+    esp_err_t ret = httpd_resp_send(req, reinterpret_cast<const char*>(asset.start), len);
+    ESP_LOGI(TAG, "%s: %u bytes gzip in %lums", asset.name, (unsigned)len,
+             (unsigned long)((esp_timer_get_time() - start_us) / 1000));
+    return ret;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <esp_http_server.h>
+
+/**
+ * @brief Các trang web nhúng trong firmware (thư mục web/ cạnh file này).
+ * Lúc build scripts/build_web_ui.py minify + gzip từng trang; ở đây chỉ gửi
+ * nguyên khối đã nén với Content-Encoding: gzip và ETag cố định theo nội dung,
+ * trình duyệt gửi lại If-None-Match thì trả 304 không kèm body.
+ */
+enum class WebUiPage {
+    kControl,           // "/"
+    kMusic,             // "/music"
+    kServoCalibration,  // "/servo_calibration"
+};
+
+// Gửi trang (hoặc 304 Not Modified nếu trình duyệt đã có bản này)
+esp_err_t web_ui_send_page(httpd_req_t* req, WebUiPage page);
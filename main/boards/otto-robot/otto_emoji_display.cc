@@ -214,7 +214,7 @@ void OttoEmojiDisplay::SetupGifContainer() {
         gif_controller_ = std::make_unique<LvglGif>(&happy);
         if (gif_controller_->IsLoaded()) {
             gif_controller_->SetFrameCallback([this]() {
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
+                LvglImage::InvalidateArea(emotion_gif_, gif_controller_->image_dsc(), gif_controller_->dirty_area());
             });
             lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
             gif_controller_->Start();
@@ -338,7 +338,7 @@ void OttoEmojiDisplay::SetEmotion(const char* emotion) {
         gif_controller_ = std::make_unique<LvglGif>(cached_gif);
         if (gif_controller_->IsLoaded()) {
             gif_controller_->SetFrameCallback([this]() {
-                lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
+                LvglImage::InvalidateArea(emotion_gif_, gif_controller_->image_dsc(), gif_controller_->dirty_area());
             });
             lv_img_set_src(emotion_gif_, gif_controller_->image_dsc());
             gif_controller_->Start();
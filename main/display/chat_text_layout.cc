@@ -0,0 +1,125 @@
+#include "chat_text_layout.h"
+
+namespace {
+
+// Decode one UTF-8 sequence, returns its length (invalid bytes decode as themselves)
+size_t DecodeUtf8(const char* s, uint32_t* codepoint) {
+    auto p = reinterpret_cast<const uint8_t*>(s);
+    if (p[0] < 0x80) {
+        *codepoint = p[0];
+        return 1;
+    }
+    size_t len = (p[0] & 0xE0) == 0xC0 ? 2 : (p[0] & 0xF0) == 0xE0 ? 3 : (p[0] & 0xF8) == 0xF0 ? 4 : 1;
+    uint32_t cp = len == 2 ? p[0] & 0x1F : len == 3 ? p[0] & 0x0F : len == 4 ? p[0] & 0x07 : p[0];
+    for (size_t i = 1; i < len; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *codepoint = p[0];
+            return 1;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *codepoint = cp;
+    return len;
+}
+
+} // namespace
+
+ChatTextLayout::ChatTextLayout(int max_width, GlyphWidth glyph_width)
+    : max_width_(max_width > 0 ? max_width : 1), glyph_width_(std::move(glyph_width)) {
+}
+
+void ChatTextLayout::Reset() {
+    open_.clear();
+    open_width_ = 0;
+    break_pos_ = 0;
+    width_at_break_ = 0;
+    has_lines_ = false;
+    last_codepoint_ = 0;
+}
+
+bool ChatTextLayout::IsCjk(uint32_t cp) {
+    return (cp >= 0x2E80 && cp <= 0x9FFF) ||   // CJK radicals, kana, unified ideographs
+           (cp >= 0xAC00 && cp <= 0xD7AF) ||   // Hangul
+           (cp >= 0xF900 && cp <= 0xFAFF) ||   // Compatibility ideographs
+           (cp >= 0xFF00 && cp <= 0xFFEF);     // Full-width forms
+}
+
+uint32_t ChatTextLayout::FirstCodepoint(const char* text) {
+    if (text == nullptr || *text == '\0') {
+        return 0;
+    }
+    uint32_t cp;
+    DecodeUtf8(text, &cp);
+    return cp;
+}
+
+void ChatTextLayout::BreakLine(std::vector<std::string>& completed) {
+    if (break_pos_ > 0 && break_pos_ < open_.size()) {
+        // Break at the last opportunity, carry the rest to the next line
+        std::string head = open_.substr(0, break_pos_);
+        while (!head.empty() && head.back() == ' ') {
+            head.pop_back();
+        }
+        completed.push_back(std::move(head));
+        open_.erase(0, break_pos_);
+        open_width_ -= width_at_break_;
+    } else {
+        while (!open_.empty() && open_.back() == ' ') {
+            open_.pop_back();
+        }
+        completed.push_back(std::move(open_));
+        open_.clear();
+        open_width_ = 0;
+    }
+    break_pos_ = 0;
+    width_at_break_ = 0;
+    has_lines_ = true;
+}
+
+void ChatTextLayout::Append(const char* text, std::vector<std::string>& completed) {
+    if (text == nullptr) {
+        return;
+    }
+    while (*text != '\0') {
+        uint32_t cp;
+        size_t len = DecodeUtf8(text, &cp);
+
+        if (cp == '\n') {
+            break_pos_ = 0;  // The whole line ends here
+            BreakLine(completed);
+            text += len;
+            last_codepoint_ = cp;
+            continue;
+        }
+        if (cp == '\r') {
+            text += len;
+            continue;
+        }
+
+        bool cjk = IsCjk(cp);
+        if (cjk && !open_.empty()) {
+            break_pos_ = open_.size();
+            width_at_break_ = open_width_;
+        }
+
+        int width = glyph_width_(cp);
+        if (open_width_ + width > max_width_ && !open_.empty()) {
+            BreakLine(completed);
+        }
+        // Spaces at the start of a wrapped line are dropped
+        if (cp == ' ' && open_.empty() && has_lines_) {
+            text += len;
+            last_codepoint_ = cp;
+            continue;
+        }
+
+        open_.append(text, len);
+        open_width_ += width;
+        if (cp == ' ' || cjk) {
+            break_pos_ = open_.size();
+            width_at_break_ = open_width_;
+        }
+        text += len;
+        last_codepoint_ = cp;
+    }
+}
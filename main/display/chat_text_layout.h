@@ -0,0 +1,58 @@
+#ifndef CHAT_TEXT_LAYOUT_H
+#define CHAT_TEXT_LAYOUT_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Incremental greedy line breaker for streamed chat text.
+ *
+ * Text arrives in fragments (one TTS sentence at a time). Only the open last
+ * line is ever re-measured: lines that are completed by an Append() are
+ * handed to the caller once and never laid out again, so the cost of an
+ * append is proportional to the fragment, not to the whole message.
+ *
+ * Lines break after spaces, before and after CJK characters, at '\n', and
+ * inside a word only when it is wider than a whole line.
+ */
+class ChatTextLayout {
+public:
+    // Advance width in pixels of one code point
+    using GlyphWidth = std::function<int(uint32_t codepoint)>;
+
+    ChatTextLayout(int max_width, GlyphWidth glyph_width);
+
+    void Reset();
+
+    // Lay out `text` (UTF-8) after what was appended before. Lines completed
+    // by this call are appended to `completed`, in order.
+    void Append(const char* text, std::vector<std::string>& completed);
+
+    // The line still being filled, may be empty
+    const std::string& open_line() const { return open_; }
+    int open_line_width() const { return open_width_; }
+    bool empty() const { return open_.empty() && !has_lines_; }
+
+    // Last code point appended, 0 if none
+    uint32_t last_codepoint() const { return last_codepoint_; }
+
+    static bool IsCjk(uint32_t codepoint);
+    static uint32_t FirstCodepoint(const char* text);
+
+private:
+    void BreakLine(std::vector<std::string>& completed);
+
+    int max_width_;
+    GlyphWidth glyph_width_;
+
+    std::string open_;
+    int open_width_ = 0;
+    size_t break_pos_ = 0;       // Byte offset in open_ where it may break, 0 = none
+    int width_at_break_ = 0;     // Width of open_[0, break_pos_)
+    bool has_lines_ = false;
+    uint32_t last_codepoint_ = 0;
+};
+
+#endif // CHAT_TEXT_LAYOUT_H
@@ -0,0 +1,350 @@
+#include "chat_view.h"
+#include "lvgl_theme.h"
+
+#include <esp_log.h>
+#include <algorithm>
+#include <cstring>
+
+#define TAG "ChatView"
+
+namespace {
+
+// Role names are interned so rows can compare them by pointer
+constexpr char kUser[] = "user";
+constexpr char kAssistant[] = "assistant";
+constexpr char kSystem[] = "system";
+constexpr char kImage[] = "image";
+
+const char* InternRole(const char* role) {
+    if (strcmp(role, kUser) == 0) {
+        return kUser;
+    }
+    if (strcmp(role, kSystem) == 0) {
+        return kSystem;
+    }
+    return kAssistant;
+}
+
+} // namespace
+
+ChatView::ChatView(lv_obj_t* content, size_t max_messages, LvglTheme* theme)
+    : content_(content), max_messages_(max_messages > 0 ? max_messages : 1), theme_(theme) {
+    lv_obj_add_event_cb(content_, [](lv_event_t* e) {
+        auto self = static_cast<ChatView*>(lv_event_get_user_data(e));
+        self->OnContentDeleted();
+    }, LV_EVENT_DELETE, this);
+}
+
+ChatView::~ChatView() {
+    if (content_ != nullptr) {
+        lv_obj_remove_event_cb_with_user_data(content_, nullptr, this);
+    }
+    // The LVGL objects are owned by content_
+    for (auto row : rows_) {
+        delete row;
+    }
+    for (auto row : free_) {
+        delete row;
+    }
+}
+
+void ChatView::OnContentDeleted() {
+    for (auto row : rows_) {
+        delete row;
+    }
+    for (auto row : free_) {
+        delete row;
+    }
+    rows_.clear();
+    free_.clear();
+    content_ = nullptr;
+}
+
+ChatView::Row* ChatView::CreateRow() {
+    auto row = new Row();
+
+    // A full-width transparent row, so the bubble can be aligned inside it
+    row->row = lv_obj_create(content_);
+    lv_obj_set_width(row->row, LV_HOR_RES);
+    lv_obj_set_height(row->row, LV_SIZE_CONTENT);
+    lv_obj_set_style_bg_opa(row->row, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_border_width(row->row, 0, 0);
+    lv_obj_set_style_pad_all(row->row, 0, 0);
+    lv_obj_set_scrollbar_mode(row->row, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_remove_flag(row->row, LV_OBJ_FLAG_SCROLLABLE);
+
+    row->bubble = lv_obj_create(row->row);
+    lv_obj_set_size(row->bubble, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+    lv_obj_set_style_radius(row->bubble, 8, 0);
+    lv_obj_set_style_border_width(row->bubble, 0, 0);
+    lv_obj_set_style_bg_opa(row->bubble, LV_OPA_70, 0);
+    lv_obj_set_style_flex_grow(row->bubble, 0, 0);
+    lv_obj_set_scrollbar_mode(row->bubble, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_remove_flag(row->bubble, LV_OBJ_FLAG_SCROLLABLE);
+
+    // One label per line, stacked without extra spacing
+    lv_obj_set_flex_flow(row->bubble, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_row(row->bubble, 0, 0);
+    return row;
+}
+
+// Keep at most max_messages_ rows visible; the oldest text row goes back to the pool
+void ChatView::MakeRoom() {
+    while (rows_.size() >= max_messages_) {
+        Row* oldest = rows_.front();
+        rows_.pop_front();
+        if (oldest->image) {
+            DeleteRow(oldest);
+        } else {
+            lv_obj_add_flag(oldest->row, LV_OBJ_FLAG_HIDDEN);
+            free_.push_back(oldest);
+        }
+    }
+}
+
+ChatView::Row* ChatView::AcquireRow(const char* role) {
+    MakeRoom();
+
+    Row* row;
+    if (!free_.empty()) {
+        row = free_.back();
+        free_.pop_back();
+        lv_obj_move_to_index(row->row, -1);
+        lv_obj_remove_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        row = CreateRow();
+    }
+    row->role = role;
+    ApplyRowStyle(row);
+    ResetText(row);
+    rows_.push_back(row);
+    return row;
+}
+
+void ChatView::ReleaseRow(Row* row) {
+    auto it = std::find(rows_.begin(), rows_.end(), row);
+    if (it != rows_.end()) {
+        rows_.erase(it);
+    }
+    if (row->image) {
+        DeleteRow(row);
+        return;
+    }
+    lv_obj_add_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+    free_.push_back(row);
+}
+
+void ChatView::DeleteRow(Row* row) {
+    // Image rows free their LvglImage from the image's delete event
+    lv_obj_del(row->row);
+    delete row;
+}
+
+void ChatView::ApplyRowStyle(Row* row) {
+    lv_color_t bg_color = theme_->assistant_bubble_color();
+    if (row->role == kUser) {
+        bg_color = theme_->user_bubble_color();
+    } else if (row->role == kSystem) {
+        bg_color = theme_->system_bubble_color();
+    }
+    lv_obj_set_style_bg_color(row->bubble, bg_color, 0);
+    lv_obj_set_style_border_color(row->bubble, theme_->border_color(), 0);
+    lv_obj_set_style_pad_all(row->bubble, theme_->spacing(4), 0);
+    // Set on the bubble so every line label inherits it
+    lv_obj_set_style_text_color(row->bubble,
+        row->role == kSystem ? theme_->system_text_color() : theme_->text_color(), 0);
+    lv_obj_set_user_data(row->bubble, (void*)row->role);
+
+    if (row->role == kUser) {
+        lv_obj_align(row->bubble, LV_ALIGN_RIGHT_MID, -25, 0);
+    } else if (row->role == kSystem) {
+        lv_obj_align(row->bubble, LV_ALIGN_CENTER, 0, 0);
+    } else {
+        lv_obj_align(row->bubble, LV_ALIGN_LEFT_MID, 0, 0);
+    }
+}
+
+void ChatView::ResetText(Row* row) {
+    auto font = theme_->text_font()->font();
+    if (row->layout == nullptr || row->font != font) {
+        // Lines are limited to 85% of the screen, like the old single-label bubbles
+        int max_width = LV_HOR_RES * 85 / 100 - 16;
+        row->layout = std::make_unique<ChatTextLayout>(max_width, [font](uint32_t codepoint) {
+            return (int)lv_font_get_glyph_width(font, codepoint, 0);
+        });
+        row->font = font;
+    } else {
+        row->layout->Reset();
+    }
+    row->text.clear();
+
+    for (size_t i = 1; i < row->lines.size(); i++) {
+        lv_obj_add_flag(row->lines[i], LV_OBJ_FLAG_HIDDEN);
+    }
+    row->open_line = 0;
+    SetLineText(row, 0, "");
+}
+
+void ChatView::SetLineText(Row* row, size_t index, const char* text) {
+    while (row->lines.size() <= index) {
+        lv_obj_t* label = lv_label_create(row->bubble);
+        lv_obj_set_style_min_width(label, 20, 0);
+        row->lines.push_back(label);
+    }
+    lv_obj_t* label = row->lines[index];
+    lv_label_set_text(label, text);
+    lv_obj_remove_flag(label, LV_OBJ_FLAG_HIDDEN);
+}
+
+bool ChatView::AppendText(Row* row, const char* text) {
+    bool open_was_visible = !lv_obj_has_flag(row->lines[row->open_line], LV_OBJ_FLAG_HIDDEN);
+    size_t visible_before = row->open_line + (open_was_visible ? 1 : 0);
+
+    std::vector<std::string> completed;
+    row->layout->Append(text, completed);
+    row->text += text;
+
+    // Completed lines are written once; only the open line is ever rewritten
+    for (auto& line : completed) {
+        SetLineText(row, row->open_line++, line.c_str());
+    }
+    const std::string& open = row->layout->open_line();
+    size_t visible_after = row->open_line;
+    if (open.empty() && row->open_line > 0) {
+        // Nothing after the last break yet, don't show a blank line
+        SetLineText(row, row->open_line, "");
+        lv_obj_add_flag(row->lines[row->open_line], LV_OBJ_FLAG_HIDDEN);
+    } else {
+        SetLineText(row, row->open_line, open.c_str());
+        visible_after++;
+    }
+    return visible_after > visible_before;
+}
+
+void ChatView::AddMessage(const char* role, const char* text) {
+    if (content_ == nullptr || role == nullptr || text == nullptr) {
+        return;
+    }
+    role = InternRole(role);
+
+    // Collapse system messages: a new one replaces the one before it
+    if (role == kSystem && !rows_.empty() && rows_.back()->role == kSystem) {
+        ReleaseRow(rows_.back());
+    }
+
+    // Avoid empty message boxes
+    if (*text == '\0') {
+        return;
+    }
+
+    Row* row = AcquireRow(role);
+    AppendText(row, text);
+    lv_obj_scroll_to_view_recursive(row->row, LV_ANIM_ON);
+}
+
+void ChatView::AppendMessage(const char* role, const char* fragment) {
+    if (content_ == nullptr || role == nullptr || fragment == nullptr || *fragment == '\0') {
+        return;
+    }
+    role = InternRole(role);
+    if (role == kSystem || rows_.empty() || rows_.back()->role != role) {
+        AddMessage(role, fragment);
+        return;
+    }
+
+    Row* row = rows_.back();
+    // Sentences arrive without the space between them; CJK text has none
+    uint32_t last = row->layout->last_codepoint();
+    uint32_t first = ChatTextLayout::FirstCodepoint(fragment);
+    bool needs_space = last != ' ' && last != '\n' && !ChatTextLayout::IsCjk(last) &&
+                       first != ' ' && first != '\n' && !ChatTextLayout::IsCjk(first);
+    bool grew = needs_space && AppendText(row, " ");
+    grew = AppendText(row, fragment) || grew;
+
+    // Scrolling is only needed when the bubble got taller
+    if (grew) {
+        lv_obj_scroll_to_view_recursive(row->row, LV_ANIM_ON);
+    }
+}
+
+void ChatView::AddImage(std::unique_ptr<LvglImage> image) {
+    if (content_ == nullptr || image == nullptr) {
+        return;
+    }
+
+    // Image rows are never pooled, their content differs too much
+    MakeRoom();
+    Row* row = CreateRow();
+    row->role = kImage;
+    row->image = true;
+    rows_.push_back(row);
+    ApplyRowStyle(row);
+    lv_obj_set_style_layout(row->bubble, LV_LAYOUT_NONE, 0);
+
+    lv_obj_t* preview_image = lv_image_create(row->bubble);
+
+    // Calculate appropriate size for the image
+    lv_coord_t max_width = LV_HOR_RES * 70 / 100;  // 70% of screen width
+    lv_coord_t max_height = LV_VER_RES * 50 / 100; // 50% of screen height
+
+    // Calculate zoom factor to fit within maximum dimensions
+    auto img_dsc = image->image_dsc();
+    lv_coord_t img_width = img_dsc->header.w;
+    lv_coord_t img_height = img_dsc->header.h;
+    if (img_width == 0 || img_height == 0) {
+        ESP_LOGW(TAG, "Invalid image dimensions: %ld x %ld, using default dimensions: %ld x %ld", img_width, img_height, max_width, max_height);
+        img_width = max_width;
+        img_height = max_height;
+    }
+
+    lv_coord_t zoom_w = (max_width * 256) / img_width;
+    lv_coord_t zoom_h = (max_height * 256) / img_height;
+    lv_coord_t zoom = (zoom_w < zoom_h) ? zoom_w : zoom_h;
+
+    // Ensure zoom doesn't exceed 256 (100%)
+    if (zoom > 256) zoom = 256;
+
+    lv_image_set_src(preview_image, img_dsc);
+    lv_image_set_scale(preview_image, zoom);
+
+    // The image object owns the LvglImage from here on
+    LvglImage* raw_image = image.release();
+    lv_obj_add_event_cb(preview_image, [](lv_event_t* e) {
+        LvglImage* img = (LvglImage*)lv_event_get_user_data(e);
+        if (img != nullptr) {
+            delete img;
+        }
+    }, LV_EVENT_DELETE, (void*)raw_image);
+
+    // Bubble is 16 pixels larger than the scaled image (8 pixels on each side)
+    lv_coord_t scaled_width = (img_width * zoom) / 256;
+    lv_coord_t scaled_height = (img_height * zoom) / 256;
+    lv_obj_set_size(row->bubble, scaled_width + 16, scaled_height + 16);
+    lv_obj_center(preview_image);
+
+    lv_obj_scroll_to_view_recursive(row->row, LV_ANIM_ON);
+}
+
+void ChatView::SetTheme(LvglTheme* theme) {
+    theme_ = theme;
+    if (content_ == nullptr) {
+        return;
+    }
+
+    auto font = theme_->text_font()->font();
+    for (auto row : rows_) {
+        ApplyRowStyle(row);
+        if (!row->image && row->font != font) {
+            // Line breaks depend on the font, lay the whole message out again
+            std::string text = std::move(row->text);
+            ResetText(row);
+            AppendText(row, text.c_str());
+        }
+    }
+}
+
+void ChatView::Clear() {
+    while (!rows_.empty()) {
+        ReleaseRow(rows_.back());
+    }
+}
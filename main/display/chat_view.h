@@ -0,0 +1,85 @@
+#ifndef CHAT_VIEW_H
+#define CHAT_VIEW_H
+
+#include "chat_text_layout.h"
+#include "lvgl_image.h"
+
+#include <lvgl.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+class LvglTheme;
+
+/**
+ * Append-only chat message list for the WeChat-style LCD layout.
+ *
+ * Each message is a full-width transparent row holding a bubble, and the
+ * bubble holds one label per laid-out line. Text is wrapped by
+ * ChatTextLayout, so appending a streamed fragment only rewrites the open
+ * last line and adds labels for new lines; completed lines are never laid
+ * out or invalidated again. Rows are recycled: when the message limit is
+ * reached the oldest row moves to the end and is refilled instead of being
+ * deleted and recreated.
+ *
+ * Call with the display lock held. The LVGL objects belong to `content`;
+ * if a board deletes `content` the view detaches itself.
+ */
+class ChatView {
+public:
+    ChatView(lv_obj_t* content, size_t max_messages, LvglTheme* theme);
+    ~ChatView();
+    ChatView(const ChatView&) = delete;
+    ChatView& operator=(const ChatView&) = delete;
+
+    // Start a new message bubble. A system message replaces a system
+    // message right before it; an empty one just removes it.
+    void AddMessage(const char* role, const char* text);
+
+    // Append to the last bubble if it has the same role, else start one
+    void AppendMessage(const char* role, const char* fragment);
+
+    // Image bubble; image rows are deleted rather than recycled
+    void AddImage(std::unique_ptr<LvglImage> image);
+
+    void SetTheme(LvglTheme* theme);
+    void Clear();
+
+    // False once `content` has been deleted; the view is inert after that
+    bool attached() const { return content_ != nullptr; }
+
+private:
+    struct Row {
+        lv_obj_t* row = nullptr;
+        lv_obj_t* bubble = nullptr;
+        std::vector<lv_obj_t*> lines;  // Labels, [0, open_line] in use
+        size_t open_line = 0;          // Index of the label showing the open line
+        const char* role = nullptr;    // Static string, also the bubble user data
+        bool image = false;
+        std::string text;              // Whole message, to lay out again on a font change
+        const lv_font_t* font = nullptr;  // Font the layout measures with
+        std::unique_ptr<ChatTextLayout> layout;
+    };
+
+    Row* CreateRow();
+    Row* AcquireRow(const char* role);
+    void MakeRoom();
+    void ReleaseRow(Row* row);
+    void DeleteRow(Row* row);
+    void ResetText(Row* row);
+    // Returns true if the bubble gained lines
+    bool AppendText(Row* row, const char* text);
+    void SetLineText(Row* row, size_t index, const char* text);
+    void ApplyRowStyle(Row* row);
+    void OnContentDeleted();
+
+    lv_obj_t* content_;
+    size_t max_messages_;
+    LvglTheme* theme_;
+    std::deque<Row*> rows_;    // Visible, oldest first
+    std::vector<Row*> free_;   // Hidden, ready for reuse
+};
+
+#endif // CHAT_VIEW_H
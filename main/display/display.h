@@ -35,6 +35,9 @@ public:
     virtual void ShowNotification(const std::string &notification, int duration_ms = 3000);
     virtual void SetEmotion(const char* emotion);
     virtual void SetChatMessage(const char* role, const char* content);
+    // Continue the current message with a streamed fragment (e.g. the next TTS sentence).
+    // Displays without a message history just show the fragment.
+    virtual void AppendChatMessage(const char* role, const char* content) { SetChatMessage(role, content); }
     virtual void SetMusicInfo(const char* song_name) { SetChatMessage("music", song_name); }  // Display music info
     virtual void SetTheme(Theme* theme);
     virtual Theme* GetTheme() { return current_theme_; }
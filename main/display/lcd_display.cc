@@ -13,6 +13,7 @@
 #include <esp_lvgl_port.h>
 #include <esp_psram.h>
 #include <esp_heap_caps.h>
+#include <soc/soc_caps.h>
 #include <cstring>
 
 #include "board.h"
@@ -90,8 +91,154 @@ LcdDisplay::LcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_
     esp_timer_create(&preview_timer_args, &preview_timer_);
 }
 
+// Internal DMA-capable RAM left free for Wi-Fi/TLS and SPI transactions
+static constexpr size_t kRenderInternalReserve = 48 * 1024;
+static constexpr int kRenderMinLines = 10;
+// DMA bounce buffer used when LVGL renders into PSRAM
+static constexpr int kRenderBounceLines = 10;
+static constexpr int64_t kRenderProbeWindowUs = 10 * 1000 * 1000;
+
+LcdRenderConfig LcdRenderConfig::Default() {
+    LcdRenderConfig config;
+#if CONFIG_LCD_RENDER_FULL_REFRESH
+    config.mode = kFullRefresh;
+    config.double_buffer = true;
+#elif CONFIG_LCD_RENDER_DIRECT
+    config.mode = kDirect;
+    config.double_buffer = true;
+#elif CONFIG_LCD_RENDER_PARTIAL_DOUBLE
+    config.double_buffer = true;
+#endif
+#ifdef CONFIG_LCD_RENDER_BUFFER_LINES
+    config.buffer_lines = CONFIG_LCD_RENDER_BUFFER_LINES;
+#endif
+    return config;
+}
+
+void LcdDisplay::ApplyRenderConfig(const LcdRenderConfig& config, lvgl_port_display_cfg_t& display_cfg) {
+    const size_t line_bytes = width_ * sizeof(uint16_t);
+    LcdRenderConfig::Mode mode = config.mode;
+    int lines = mode == LcdRenderConfig::kPartial ? std::max(1, std::min(config.buffer_lines, height_)) : height_;
+    int buffers = config.double_buffer ? 2 : 1;
+
+    auto fits_internal = [&](int lines, int buffers) {
+        size_t buffer_bytes = line_bytes * lines;
+        size_t free_bytes = heap_caps_get_free_size(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        return buffer_bytes <= largest && buffer_bytes * buffers + kRenderInternalReserve <= free_bytes;
+    };
+
+    bool use_psram = false;
+    if (!fits_internal(lines, buffers)) {
+#if CONFIG_SPIRAM
+        // Whole-screen buffers never fit internal RAM on these chips
+        use_psram = config.psram_fallback || mode != LcdRenderConfig::kPartial;
+#endif
+        if (!use_psram) {
+            if (mode != LcdRenderConfig::kPartial) {
+                ESP_LOGW(TAG, "No PSRAM for full-screen buffers, using partial rendering");
+                mode = LcdRenderConfig::kPartial;
+                lines = std::max(1, std::min(config.buffer_lines, height_));
+            }
+            while (lines > kRenderMinLines && !fits_internal(lines, buffers)) {
+                lines = std::max(kRenderMinLines, lines / 2);
+            }
+            if (buffers == 2 && !fits_internal(lines, buffers)) {
+                buffers = 1;
+            }
+        }
+    }
+
+    display_cfg.buffer_size = static_cast<uint32_t>(width_ * lines);
+    display_cfg.double_buffer = buffers == 2;
+    display_cfg.trans_size = use_psram ? static_cast<uint32_t>(width_ * kRenderBounceLines) : 0;
+    display_cfg.flags.buff_dma = use_psram ? 0 : 1;
+    display_cfg.flags.buff_spiram = use_psram ? 1 : 0;
+    display_cfg.flags.full_refresh = mode == LcdRenderConfig::kFullRefresh;
+    display_cfg.flags.direct_mode = mode == LcdRenderConfig::kDirect;
+
+    const char* mode_name = mode == LcdRenderConfig::kFullRefresh ? "full refresh" :
+                            (mode == LcdRenderConfig::kDirect ? "direct" : "partial");
+    ESP_LOGI(TAG, "Render strategy: %s, %d lines x %d buffer(s) in %s (%u KB)", mode_name, lines, buffers,
+             use_psram ? "PSRAM" : "internal DMA RAM", (unsigned)(line_bytes * lines * buffers / 1024));
+}
+
+void LcdDisplay::InstallRenderProbe() {
+#if CONFIG_LCD_RENDER_PROBE
+    if (display_ == nullptr) {
+        return;
+    }
+    render_probe_.window_start_us = esp_timer_get_time();
+    lv_display_add_event_cb(display_, RenderProbeEventCallback, LV_EVENT_RENDER_START, this);
+    lv_display_add_event_cb(display_, RenderProbeEventCallback, LV_EVENT_RENDER_READY, this);
+    lv_display_add_event_cb(display_, RenderProbeEventCallback, LV_EVENT_FLUSH_START, this);
+    lv_display_add_event_cb(display_, RenderProbeEventCallback, LV_EVENT_FLUSH_WAIT_START, this);
+    lv_display_add_event_cb(display_, RenderProbeEventCallback, LV_EVENT_FLUSH_WAIT_FINISH, this);
+#endif
+}
+
+// Runs in the LVGL task
+void LcdDisplay::RenderProbeEventCallback(lv_event_t* e) {
+    auto self = static_cast<LcdDisplay*>(lv_event_get_user_data(e));
+    auto& probe = self->render_probe_;
+    int64_t now = esp_timer_get_time();
+
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_RENDER_START:
+        probe.render_start_us = now;
+        break;
+    case LV_EVENT_FLUSH_START: {
+        auto area = static_cast<const lv_area_t*>(lv_event_get_param(e));
+        if (area) {
+            probe.flushed_px += lv_area_get_size(area);
+        }
+        break;
+    }
+    case LV_EVENT_FLUSH_WAIT_START:
+        probe.flush_wait_start_us = now;
+        break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        if (probe.flush_wait_start_us != 0) {
+            probe.flush_wait_us += now - probe.flush_wait_start_us;
+            probe.flush_wait_start_us = 0;
+        }
+        break;
+    case LV_EVENT_RENDER_READY:
+        if (probe.render_start_us != 0) {
+            probe.frame_us += now - probe.render_start_us;
+            probe.render_start_us = 0;
+        }
+        probe.frames++;
+        if (now - probe.window_start_us >= kRenderProbeWindowUs) {
+            LcdRenderStats& stats = probe.last;
+            stats.frames = probe.frames;
+            stats.fps = probe.frames * 1e6f / (now - probe.window_start_us);
+            stats.avg_frame_us = probe.frame_us / probe.frames;
+            stats.avg_flush_wait_us = probe.flush_wait_us / probe.frames;
+            stats.avg_flush_kpx = probe.flushed_px / probe.frames / 1000;
+            ESP_LOGI(TAG, "Render: %.1f fps, %luus/frame (%luus waiting for DMA), %lu kpx/frame",
+                     stats.fps, (unsigned long)stats.avg_frame_us, (unsigned long)stats.avg_flush_wait_us,
+                     (unsigned long)stats.avg_flush_kpx);
+            probe.frames = 0;
+            probe.frame_us = 0;
+            probe.flush_wait_us = 0;
+            probe.flushed_px = 0;
+            probe.window_start_us = now;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+LcdRenderStats LcdDisplay::GetRenderStats() {
+    DisplayLockGuard lock(this);
+    return render_probe_.last;
+}
+
 SpiLcdDisplay::SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_t panel,
-                           int width, int height, int offset_x, int offset_y, bool mirror_x, bool mirror_y, bool swap_xy)
+                           int width, int height, int offset_x, int offset_y, bool mirror_x, bool mirror_y, bool swap_xy,
+                           const LcdRenderConfig& render_config)
     : LcdDisplay(panel_io, panel, width, height) {
 
     // draw white
@@ -135,7 +282,7 @@ SpiLcdDisplay::SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
     lvgl_port_init(&port_cfg);
 
     ESP_LOGI(TAG, "Adding LCD display");
-    const lvgl_port_display_cfg_t display_cfg = {
+    lvgl_port_display_cfg_t display_cfg = {
         .io_handle = panel_io_,
         .panel_handle = panel_,
         .control_handle = nullptr,
@@ -160,6 +307,7 @@ SpiLcdDisplay::SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
             .direct_mode = 0,
         },
     };
+    ApplyRenderConfig(render_config, display_cfg);
 
     display_ = lvgl_port_add_disp(&display_cfg);
     if (display_ == nullptr) {
@@ -170,6 +318,7 @@ SpiLcdDisplay::SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
     if (offset_x != 0 || offset_y != 0) {
         lv_display_set_offset(display_, offset_x, offset_y);
     }
+    InstallRenderProbe();
 
     SetupUI();
 }
@@ -298,6 +447,7 @@ LcdDisplay::~LcdDisplay() {
         gif_controller_->Stop();
         gif_controller_.reset();
     }
+    anim_controller_.reset();
     
     if (preview_timer_ != nullptr) {
         esp_timer_stop(preview_timer_);
@@ -357,6 +507,11 @@ void LcdDisplay::Unlock() {
     lvgl_port_unlock();
 }
 
+#if CONFIG_IDF_TARGET_ESP32P4
+#define  MAX_MESSAGES 40
+#else
+#define  MAX_MESSAGES 20
+#endif
 #if CONFIG_USE_WECHAT_MESSAGE_STYLE
 void LcdDisplay::SetupUI() {
     DisplayLockGuard lock(this);
@@ -472,8 +627,9 @@ void LcdDisplay::SetupUI() {
     lv_obj_set_flex_align(content_, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
     lv_obj_set_style_pad_row(content_, lvgl_theme->spacing(4), 0); // Space between messages
 
-    // We'll create chat messages dynamically in SetChatMessage
+    // Message bubbles are created and recycled by the chat view
     chat_message_label_ = nullptr;
+    chat_view_ = std::make_unique<ChatView>(content_, MAX_MESSAGES, lvgl_theme);
 
     low_battery_popup_ = lv_obj_create(screen);
     lv_obj_set_scrollbar_mode(low_battery_popup_, LV_SCROLLBAR_MODE_OFF);
@@ -501,281 +657,39 @@ void LcdDisplay::SetupUI() {
     lv_obj_set_style_text_color(emoji_label_, lvgl_theme->text_color(), 0);
     lv_label_set_text(emoji_label_, FONT_AWESOME_MICROCHIP_AI);
 }
-#if CONFIG_IDF_TARGET_ESP32P4
-#define  MAX_MESSAGES 40
-#else
-#define  MAX_MESSAGES 20
-#endif
 void LcdDisplay::SetChatMessage(const char* role, const char* content) {
     DisplayLockGuard lock(this);
-    if (content_ == nullptr) {
+    if (chat_view_ == nullptr || role == nullptr || content == nullptr) {
         return;
     }
-    
-    // Check if message count exceeds limit
-    uint32_t child_count = lv_obj_get_child_cnt(content_);
-    if (child_count >= MAX_MESSAGES) {
-        // Delete the oldest message (first child object)
-        lv_obj_t* first_child = lv_obj_get_child(content_, 0);
-        lv_obj_t* last_child = lv_obj_get_child(content_, child_count - 1);
-        if (first_child != nullptr) {
-            lv_obj_del(first_child);
-        }
-        // Scroll to the last message immediately
-        if (last_child != nullptr) {
-            lv_obj_scroll_to_view_recursive(last_child, LV_ANIM_OFF);
-        }
-    }
-    
-    // Collapse system messages (if it's a system message, check if the last message is also a system message)
-    if (strcmp(role, "system") == 0) {
-        if (child_count > 0) {
-            // Get the last message container
-            lv_obj_t* last_container = lv_obj_get_child(content_, child_count - 1);
-            if (last_container != nullptr && lv_obj_get_child_cnt(last_container) > 0) {
-                // Get the bubble inside the container
-                lv_obj_t* last_bubble = lv_obj_get_child(last_container, 0);
-                if (last_bubble != nullptr) {
-                    // Check if bubble type is system message
-                    void* bubble_type_ptr = lv_obj_get_user_data(last_bubble);
-                    if (bubble_type_ptr != nullptr && strcmp((const char*)bubble_type_ptr, "system") == 0) {
-                        // If the last message is also a system message, delete it
-                        lv_obj_del(last_container);
-                    }
-                }
-            }
-        }
-    } else {
+    if (strcmp(role, "system") != 0) {
         // Hide the centered AI logo
         lv_obj_add_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
     }
+    chat_view_->AddMessage(role, content);
+}
 
-    // Avoid empty message boxes
-    if(strlen(content) == 0) {
-        return;
-    }
-
-    auto lvgl_theme = static_cast<LvglTheme*>(current_theme_);
-    auto text_font = lvgl_theme->text_font()->font();
-
-    // Create a message bubble
-    lv_obj_t* msg_bubble = lv_obj_create(content_);
-    lv_obj_set_style_radius(msg_bubble, 8, 0);
-    lv_obj_set_scrollbar_mode(msg_bubble, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_set_style_border_width(msg_bubble, 0, 0);
-    lv_obj_set_style_pad_all(msg_bubble, lvgl_theme->spacing(4), 0);
-
-    // Create the message text
-    lv_obj_t* msg_text = lv_label_create(msg_bubble);
-    lv_label_set_text(msg_text, content);
-    
-    // Calculate actual text width
-    lv_coord_t text_width = lv_txt_get_width(content, strlen(content), text_font, 0);
-
-    // Calculate bubble width
-    lv_coord_t max_width = LV_HOR_RES * 85 / 100 - 16;  // 85% of screen width
-    lv_coord_t min_width = 20;  
-    lv_coord_t bubble_width;
-    
-    // Ensure text width is not less than minimum width
-    if (text_width < min_width) {
-        text_width = min_width;
-    }
-
-    // If text width is less than max width, use text width
-    if (text_width < max_width) {
-        bubble_width = text_width; 
-    } else {
-        bubble_width = max_width;
-    }
-    
-    // Set message text width
-    lv_obj_set_width(msg_text, bubble_width);  // Subtract padding
-    lv_label_set_long_mode(msg_text, LV_LABEL_LONG_WRAP);
-
-    // Set bubble width
-    lv_obj_set_width(msg_bubble, bubble_width);
-    lv_obj_set_height(msg_bubble, LV_SIZE_CONTENT);
-
-    // Set alignment and style based on message role
-    if (strcmp(role, "user") == 0) {
-        // User messages are right-aligned with green background
-        lv_obj_set_style_bg_color(msg_bubble, lvgl_theme->user_bubble_color(), 0);
-        lv_obj_set_style_bg_opa(msg_bubble, LV_OPA_70, 0);
-        // Set text color for contrast
-        lv_obj_set_style_text_color(msg_text, lvgl_theme->text_color(), 0);
-        
-        // Set custom attribute to mark bubble type
-        lv_obj_set_user_data(msg_bubble, (void*)"user");
-        
-        // Set appropriate width for content
-        lv_obj_set_width(msg_bubble, LV_SIZE_CONTENT);
-        lv_obj_set_height(msg_bubble, LV_SIZE_CONTENT);
-        
-        // Don't grow
-        lv_obj_set_style_flex_grow(msg_bubble, 0, 0);
-    } else if (strcmp(role, "assistant") == 0) {
-        // Assistant messages are left-aligned with white background
-        lv_obj_set_style_bg_color(msg_bubble, lvgl_theme->assistant_bubble_color(), 0);
-        lv_obj_set_style_bg_opa(msg_bubble, LV_OPA_70, 0);
-        // Set text color for contrast
-        lv_obj_set_style_text_color(msg_text, lvgl_theme->text_color(), 0);
-        
-        // Set custom attribute to mark bubble type
-        lv_obj_set_user_data(msg_bubble, (void*)"assistant");
-        
-        // Set appropriate width for content
-        lv_obj_set_width(msg_bubble, LV_SIZE_CONTENT);
-        lv_obj_set_height(msg_bubble, LV_SIZE_CONTENT);
-        
-        // Don't grow
-        lv_obj_set_style_flex_grow(msg_bubble, 0, 0);
-    } else if (strcmp(role, "system") == 0) {
-        // System messages are center-aligned with light gray background
-        lv_obj_set_style_bg_color(msg_bubble, lvgl_theme->system_bubble_color(), 0);
-        lv_obj_set_style_bg_opa(msg_bubble, LV_OPA_70, 0);
-        // Set text color for contrast
-        lv_obj_set_style_text_color(msg_text, lvgl_theme->system_text_color(), 0);
-        
-        // Set custom attribute to mark bubble type
-        lv_obj_set_user_data(msg_bubble, (void*)"system");
-        
-        // Set appropriate width for content
-        lv_obj_set_width(msg_bubble, LV_SIZE_CONTENT);
-        lv_obj_set_height(msg_bubble, LV_SIZE_CONTENT);
-        
-        // Don't grow
-        lv_obj_set_style_flex_grow(msg_bubble, 0, 0);
-    }
-    
-    // Create a full-width container for user messages to ensure right alignment
-    if (strcmp(role, "user") == 0) {
-        // Create a full-width container
-        lv_obj_t* container = lv_obj_create(content_);
-        lv_obj_set_width(container, LV_HOR_RES);
-        lv_obj_set_height(container, LV_SIZE_CONTENT);
-        
-        // Make container transparent and borderless
-        lv_obj_set_style_bg_opa(container, LV_OPA_TRANSP, 0);
-        lv_obj_set_style_border_width(container, 0, 0);
-        lv_obj_set_style_pad_all(container, 0, 0);
-        
-        // Move the message bubble into this container
-        lv_obj_set_parent(msg_bubble, container);
-        
-        // Right align the bubble in the container
-        lv_obj_align(msg_bubble, LV_ALIGN_RIGHT_MID, -25, 0);
-        
-        // Auto-scroll to this container
-        lv_obj_scroll_to_view_recursive(container, LV_ANIM_ON);
-    } else if (strcmp(role, "system") == 0) {
-        // Create full-width container for system messages to ensure center alignment
-        lv_obj_t* container = lv_obj_create(content_);
-        lv_obj_set_width(container, LV_HOR_RES);
-        lv_obj_set_height(container, LV_SIZE_CONTENT);
-        
-        lv_obj_set_style_bg_opa(container, LV_OPA_TRANSP, 0);
-        lv_obj_set_style_border_width(container, 0, 0);
-        lv_obj_set_style_pad_all(container, 0, 0);
-        
-        lv_obj_set_parent(msg_bubble, container);
-        lv_obj_align(msg_bubble, LV_ALIGN_CENTER, 0, 0);
-        lv_obj_scroll_to_view_recursive(container, LV_ANIM_ON);
-    } else {
-        // For assistant messages
-        // Left align assistant messages
-        lv_obj_align(msg_bubble, LV_ALIGN_LEFT_MID, 0, 0);
-
-        // Auto-scroll to the message bubble
-        lv_obj_scroll_to_view_recursive(msg_bubble, LV_ANIM_ON);
+void LcdDisplay::AppendChatMessage(const char* role, const char* content) {
+    {
+        DisplayLockGuard lock(this);
+        if (chat_view_ != nullptr && chat_view_->attached() && role != nullptr && content != nullptr) {
+            if (strcmp(role, "system") != 0) {
+                lv_obj_add_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
+            }
+            chat_view_->AppendMessage(role, content);
+            return;
+        }
     }
-    
-    // Store reference to the latest message label
-    chat_message_label_ = msg_text;
+    // Boards that replaced the chat area handle messages in SetChatMessage
+    SetChatMessage(role, content);
 }
 
 void LcdDisplay::SetPreviewImage(std::unique_ptr<LvglImage> image) {
     DisplayLockGuard lock(this);
-    if (content_ == nullptr) {
-        return;
-    }
-
-    if (image == nullptr) {
+    if (chat_view_ == nullptr || image == nullptr) {
         return;
     }
-    
-    auto lvgl_theme = static_cast<LvglTheme*>(current_theme_);
-    // Create a message bubble for image preview
-    lv_obj_t* img_bubble = lv_obj_create(content_);
-    lv_obj_set_style_radius(img_bubble, 8, 0);
-    lv_obj_set_scrollbar_mode(img_bubble, LV_SCROLLBAR_MODE_OFF);
-    lv_obj_set_style_border_width(img_bubble, 0, 0);
-    lv_obj_set_style_pad_all(img_bubble, lvgl_theme->spacing(4), 0);
-    
-    // Set image bubble background color (similar to system message)
-    lv_obj_set_style_bg_color(img_bubble, lvgl_theme->assistant_bubble_color(), 0);
-    lv_obj_set_style_bg_opa(img_bubble, LV_OPA_70, 0);
-    
-    // Set custom attribute to mark bubble type
-    lv_obj_set_user_data(img_bubble, (void*)"image");
-
-    // Create the image object inside the bubble
-    lv_obj_t* preview_image = lv_image_create(img_bubble);
-    
-    // Calculate appropriate size for the image
-    lv_coord_t max_width = LV_HOR_RES * 70 / 100;  // 70% of screen width
-    lv_coord_t max_height = LV_VER_RES * 50 / 100; // 50% of screen height
-    
-    // Calculate zoom factor to fit within maximum dimensions
-    auto img_dsc = image->image_dsc();
-    lv_coord_t img_width = img_dsc->header.w;
-    lv_coord_t img_height = img_dsc->header.h;
-    if (img_width == 0 || img_height == 0) {
-        img_width = max_width;
-        img_height = max_height;
-        ESP_LOGW(TAG, "Invalid image dimensions: %ld x %ld, using default dimensions: %ld x %ld", img_width, img_height, max_width, max_height);
-    }
-    
-    lv_coord_t zoom_w = (max_width * 256) / img_width;
-    lv_coord_t zoom_h = (max_height * 256) / img_height;
-    lv_coord_t zoom = (zoom_w < zoom_h) ? zoom_w : zoom_h;
-    
-    // Ensure zoom doesn't exceed 256 (100%)
-    if (zoom > 256) zoom = 256;
-    
-    // Set image properties
-    lv_image_set_src(preview_image, img_dsc);
-    lv_image_set_scale(preview_image, zoom);
-    
-    // Add event handler to clean up LvglImage when image is deleted
-    // We need to transfer ownership of the unique_ptr to the event callback
-    LvglImage* raw_image = image.release(); // Release ownership of smart pointer
-    lv_obj_add_event_cb(preview_image, [](lv_event_t* e) {
-        LvglImage* img = (LvglImage*)lv_event_get_user_data(e);
-        if (img != nullptr) {
-            delete img; // Properly release memory by deleting LvglImage object
-        }
-    }, LV_EVENT_DELETE, (void*)raw_image);
-    
-    // Calculate actual scaled image dimensions
-    lv_coord_t scaled_width = (img_width * zoom) / 256;
-    lv_coord_t scaled_height = (img_height * zoom) / 256;
-    
-    // Set bubble size to be 16 pixels larger than the image (8 pixels on each side)
-    lv_obj_set_width(img_bubble, scaled_width + 16);
-    lv_obj_set_height(img_bubble, scaled_height + 16);
-    
-    // Don't grow in flex layout
-    lv_obj_set_style_flex_grow(img_bubble, 0, 0);
-    
-    // Center the image within the bubble
-    lv_obj_center(preview_image);
-    
-    // Left align the image bubble like assistant messages
-    lv_obj_align(img_bubble, LV_ALIGN_LEFT_MID, 0, 0);
-
-    // Auto-scroll to the image bubble
-    lv_obj_scroll_to_view_recursive(img_bubble, LV_ANIM_ON);
+    chat_view_->AddImage(std::move(image));
 }
 #else
 void LcdDisplay::SetupUI() {
@@ -947,6 +861,9 @@ void LcdDisplay::SetPreviewImage(std::unique_ptr<LvglImage> image) {
         if (gif_controller_) {
             gif_controller_->Start();
         }
+        if (anim_controller_) {
+            anim_controller_->Start();
+        }
         return;
     }
 
@@ -962,6 +879,9 @@ void LcdDisplay::SetPreviewImage(std::unique_ptr<LvglImage> image) {
     if (gif_controller_) {
         gif_controller_->Stop();
     }
+    if (anim_controller_) {
+        anim_controller_->Stop();
+    }
     lv_obj_add_flag(emoji_box_, LV_OBJ_FLAG_HIDDEN);
     lv_obj_remove_flag(preview_image_, LV_OBJ_FLAG_HIDDEN);
     esp_timer_stop(preview_timer_);
@@ -1061,6 +981,10 @@ void LcdDisplay::SetEmotion(const char* emotion) {
         gif_controller_->Stop();
         gif_controller_.reset();
     }
+    if (anim_controller_) {
+        DisplayLockGuard lock(this);
+        anim_controller_.reset();
+    }
     
     if (emoji_image_ == nullptr) {
         return;
@@ -1091,7 +1015,7 @@ void LcdDisplay::SetEmotion(const char* emotion) {
         if (gif_controller_->IsLoaded()) {
             // Set up frame update callback
             gif_controller_->SetFrameCallback([this]() {
-                lv_image_set_src(emoji_image_, gif_controller_->image_dsc());
+                LvglImage::InvalidateArea(emoji_image_, gif_controller_->image_dsc(), gif_controller_->dirty_area());
             });
             
             // Set initial frame and start animation
@@ -1105,6 +1029,22 @@ void LcdDisplay::SetEmotion(const char* emotion) {
             ESP_LOGE(TAG, "Failed to load GIF for emotion: %s", emotion);
             gif_controller_.reset();
         }
+    } else if (image->IsRleAnimation()) {
+        anim_controller_ = std::make_unique<LvglRleAnimation>(image->image_dsc());
+        if (anim_controller_->IsLoaded()) {
+            // Frames are decoded in place, only redraw the part that changed
+            anim_controller_->SetFrameCallback([this](const lv_area_t& dirty) {
+                LvglImage::InvalidateArea(emoji_image_, anim_controller_->image_dsc(), dirty);
+            });
+            lv_image_set_src(emoji_image_, anim_controller_->image_dsc());
+            anim_controller_->Start();
+
+            lv_obj_add_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
+            lv_obj_remove_flag(emoji_image_, LV_OBJ_FLAG_HIDDEN);
+        } else {
+            ESP_LOGE(TAG, "Failed to load animation for emotion: %s", emotion);
+            anim_controller_.reset();
+        }
     } else {
         lv_image_set_src(emoji_image_, image->image_dsc());
         lv_obj_add_flag(emoji_label_, LV_OBJ_FLAG_HIDDEN);
@@ -1172,69 +1112,8 @@ void LcdDisplay::SetTheme(Theme* theme) {
     // Set content background opacity
     lv_obj_set_style_bg_opa(content_, LV_OPA_TRANSP, 0);
 
-    // Iterate through all children of content (message containers or bubbles)
-    uint32_t child_count = lv_obj_get_child_cnt(content_);
-    for (uint32_t i = 0; i < child_count; i++) {
-        lv_obj_t* obj = lv_obj_get_child(content_, i);
-        if (obj == nullptr) continue;
-        
-        lv_obj_t* bubble = nullptr;
-        
-        // Check if this object is a container or bubble
-        // If it's a container (user or system message), get its child as bubble
-        // If it's a bubble (assistant message), use it directly
-        if (lv_obj_get_child_cnt(obj) > 0) {
-            // Might be a container, check if it's a user or system message container
-            // User and system message containers are transparent
-            lv_opa_t bg_opa = lv_obj_get_style_bg_opa(obj, 0);
-            if (bg_opa == LV_OPA_TRANSP) {
-                // This is a user or system message container
-                bubble = lv_obj_get_child(obj, 0);
-            } else {
-                // This might be an assistant message bubble itself
-                bubble = obj;
-            }
-        } else {
-            // No child elements, might be other UI elements, skip
-            continue;
-        }
-        
-        if (bubble == nullptr) continue;
-        
-        // Use saved user data to identify bubble type
-        void* bubble_type_ptr = lv_obj_get_user_data(bubble);
-        if (bubble_type_ptr != nullptr) {
-            const char* bubble_type = static_cast<const char*>(bubble_type_ptr);
-            
-            // Apply correct color based on bubble type
-            if (strcmp(bubble_type, "user") == 0) {
-                lv_obj_set_style_bg_color(bubble, lvgl_theme->user_bubble_color(), 0);
-            } else if (strcmp(bubble_type, "assistant") == 0) {
-                lv_obj_set_style_bg_color(bubble, lvgl_theme->assistant_bubble_color(), 0); 
-            } else if (strcmp(bubble_type, "system") == 0) {
-                lv_obj_set_style_bg_color(bubble, lvgl_theme->system_bubble_color(), 0);
-            } else if (strcmp(bubble_type, "image") == 0) {
-                lv_obj_set_style_bg_color(bubble, lvgl_theme->system_bubble_color(), 0);
-            }
-            
-            // Update border color
-            lv_obj_set_style_border_color(bubble, lvgl_theme->border_color(), 0);
-            
-            // Update text color for the message
-            if (lv_obj_get_child_cnt(bubble) > 0) {
-                lv_obj_t* text = lv_obj_get_child(bubble, 0);
-                if (text != nullptr) {
-                    // Set text color based on bubble type
-                    if (strcmp(bubble_type, "system") == 0) {
-                        lv_obj_set_style_text_color(text, lvgl_theme->system_text_color(), 0);
-                    } else {
-                        lv_obj_set_style_text_color(text, lvgl_theme->text_color(), 0);
-                    }
-                }
-            }
-        } else {
-            ESP_LOGW(TAG, "child[%lu] Bubble type is not found", i);
-        }
+    if (chat_view_ != nullptr) {
+        chat_view_->SetTheme(lvgl_theme);
     }
 #else
     // Simple UI mode - just update the main chat message
@@ -1286,11 +1165,12 @@ void LcdDisplay::periodicUpdateTaskWrapper(void* arg) {
 void LcdDisplay::periodicUpdateTask() {
     ESP_LOGI(TAG, "FFT Task Started");
     
-    const TickType_t displayInterval = pdMS_TO_TICKS(40);   // 25 FPS display
+    const TickType_t displayInterval = pdMS_TO_TICKS(33);   // 30 FPS display
     const TickType_t audioProcessInterval = pdMS_TO_TICKS(15); // Audio processing
     
     TickType_t lastDisplayTime = xTaskGetTickCount();
     TickType_t lastAudioTime = xTaskGetTickCount();
+    TickType_t lastStatsTime = xTaskGetTickCount();
     
     while (!fft_task_should_stop_) {
         TickType_t currentTime = xTaskGetTickCount();
@@ -1315,6 +1195,14 @@ void LcdDisplay::periodicUpdateTask() {
             }
         }
         
+        if (spectrum_ && currentTime - lastStatsTime >= pdMS_TO_TICKS(10000)) {
+            auto stats = spectrum_->GetStats();
+            ESP_LOGI(TAG, "Spectrum: %.1f fps, analysis %luus, paint %luus, %lu rows repainted",
+                     stats.fps, (unsigned long)stats.avg_analysis_us, (unsigned long)stats.avg_paint_us,
+                     (unsigned long)stats.rows_painted);
+            lastStatsTime = currentTime;
+        }
+        
         vTaskDelay(pdMS_TO_TICKS(10));
     }
     
@@ -1335,35 +1223,9 @@ void LcdDisplay::processAudioData() {
         }
         audio_display_last_update_++;
     } else {
-        const int HOP_SIZE = LCD_FFT_SIZE;
-        const int NUM_SEGMENTS = 1 + (1152 - LCD_FFT_SIZE) / HOP_SIZE;
-        
-        // Reset power spectrum
-        memset(avg_power_spectrum_, 0, sizeof(avg_power_spectrum_));
-        
-        for (int seg = 0; seg < NUM_SEGMENTS; seg++) {
-            int start = seg * HOP_SIZE;
-            if (start + LCD_FFT_SIZE > 1152) break;
-            
-            // Apply Hanning window
-            for (int i = 0; i < LCD_FFT_SIZE; i++) {
-                float sample = frame_audio_data_[start + i] / 32768.0f;
-                fft_real_[i] = sample * hanning_window_[i];
-                fft_imag_[i] = 0.0f;
-            }
-            
-            // Compute FFT
-            compute(fft_real_, fft_imag_, LCD_FFT_SIZE, true);
-            
-            // Accumulate power spectrum
-            for (int i = 0; i < LCD_FFT_SIZE / 2; i++) {
-                avg_power_spectrum_[i] += fft_real_[i] * fft_real_[i] + fft_imag_[i] * fft_imag_[i];
-            }
-        }
-        
-        // Average
-        for (int i = 0; i < LCD_FFT_SIZE / 2; i++) {
-            avg_power_spectrum_[i] /= NUM_SEGMENTS;
+        // Windowed real FFT over the accumulated frames, mapped to log-spaced bars
+        if (spectrum_) {
+            spectrum_->Process(frame_audio_data_, 1152);
         }
         
         audio_display_last_update_ = 0;
@@ -1372,44 +1234,6 @@ void LcdDisplay::processAudioData() {
     }
 }
 
-// Cooley-Tukey FFT
-void LcdDisplay::compute(float* real, float* imag, int n, bool forward) {
-    int j = 0;
-    for (int i = 0; i < n; i++) {
-        if (j > i) {
-            std::swap(real[i], real[j]);
-            std::swap(imag[i], imag[j]);
-        }
-        int m = n >> 1;
-        while (m >= 1 && j >= m) { j -= m; m >>= 1; }
-        j += m;
-    }
-    
-    for (int s = 1; s <= (int)log2(n); s++) {
-        int m = 1 << s;
-        int m2 = m >> 1;
-        float w_real = 1.0f, w_imag = 0.0f;
-        float angle = (forward ? -2.0f : 2.0f) * M_PI / m;
-        float wn_real = cosf(angle);
-        float wn_imag = sinf(angle);
-        
-        for (int k = 0; k < m2; k++) {
-            for (int i = k; i < n; i += m) {
-                int i2 = i + m2;
-                float t_real = w_real * real[i2] - w_imag * imag[i2];
-                float t_imag = w_real * imag[i2] + w_imag * real[i2];
-                real[i2] = real[i] - t_real;
-                imag[i2] = imag[i] - t_imag;
-                real[i] = real[i] + t_real;
-                imag[i] = imag[i] + t_imag;
-            }
-            float tmp = w_real * wn_real - w_imag * wn_imag;
-            w_imag = w_real * wn_imag + w_imag * wn_real;
-            w_real = tmp;
-        }
-    }
-}
-
 void LcdDisplay::create_fft_canvas() {
     if (fft_canvas_ != nullptr) return;
     
@@ -1418,7 +1242,6 @@ void LcdDisplay::create_fft_canvas() {
     // Calculate canvas dimensions
     fft_canvas_width_ = width_;
     fft_canvas_height_ = height_ / 3;  // Bottom 1/3 of screen
-    bar_max_height_ = fft_canvas_height_ - 4;
     
     // Allocate canvas buffer in PSRAM
     size_t buf_size = fft_canvas_width_ * fft_canvas_height_ * sizeof(uint16_t);
@@ -1434,121 +1257,36 @@ void LcdDisplay::create_fft_canvas() {
     lv_canvas_set_buffer(fft_canvas_, fft_canvas_buffer_, fft_canvas_width_, fft_canvas_height_, LV_COLOR_FORMAT_RGB565);
     lv_obj_align(fft_canvas_, LV_ALIGN_BOTTOM_MID, 0, 0);
     
-    // Fill with black
+    // Fill with black; bars are painted incrementally on top of it
     lv_canvas_fill_bg(fft_canvas_, lv_color_black(), LV_OPA_COVER);
+    if (spectrum_) {
+        spectrum_->ResetPainted();
+    }
     
     ESP_LOGI(TAG, "FFT canvas created: %dx%d", fft_canvas_width_, fft_canvas_height_);
 }
 
 void LcdDisplay::drawSpectrum() {
-    if (fft_canvas_ == nullptr) return;
-    draw_spectrum(avg_power_spectrum_, LCD_FFT_SIZE / 2);
-}
-
-void LcdDisplay::draw_spectrum(float* power_spectrum, int fft_size) {
-    if (fft_canvas_ == nullptr || fft_canvas_buffer_ == nullptr) return;
-    
-    const int bartotal = BAR_COL_NUM;
-    const int bar_width = fft_canvas_width_ / bartotal;
-    int x_pos = 0;
-    int y_pos = fft_canvas_height_ - 1;
-    
-    float magnitude[BAR_COL_NUM] = {0};
-    float max_magnitude = 0;
-    
-    const float MIN_DB = -25.0f;
-    const float MAX_DB = 0.0f;
-    
-    // Calculate magnitude per bar
-    for (int bin = 0; bin < bartotal; bin++) {
-        int start = bin * (fft_size / bartotal);
-        int end = (bin + 1) * (fft_size / bartotal);
-        magnitude[bin] = 0;
-        int count = 0;
-        for (int k = start; k < end; k++) {
-            magnitude[bin] += sqrtf(power_spectrum[k]);
-            count++;
-        }
-        if (count > 0) {
-            magnitude[bin] /= count;
-        }
-        if (magnitude[bin] > max_magnitude) {
-            max_magnitude = magnitude[bin];
-        }
-    }
-    
-    // Bass boost compensation
-    if (bartotal > 5) {
-        magnitude[1] *= 0.6f;
-        magnitude[2] *= 0.7f;
-        magnitude[3] *= 0.8f;
-        magnitude[4] *= 0.8f;
-        magnitude[5] *= 0.9f;
-    }
-    
-    // Convert to dB scale
-    for (int bin = 1; bin < bartotal; bin++) {
-        if (magnitude[bin] > 0.0f && max_magnitude > 0.0f) {
-            magnitude[bin] = 20.0f * log10f(magnitude[bin] / max_magnitude + 1e-10f);
-        } else {
-            magnitude[bin] = MIN_DB;
-        }
-    }
-    
-    // Clear canvas
-    lv_canvas_fill_bg(fft_canvas_, lv_color_black(), LV_OPA_COVER);
-    
-    // Draw bars (skip DC component k=0)
-    for (int k = 1; k < bartotal; k++) {
-        x_pos = bar_width * (k - 1);
-        float mag = (magnitude[k] - MIN_DB) / (MAX_DB - MIN_DB);
-        mag = std::max(0.0f, std::min(1.0f, mag));
-        int bar_height = (int)(mag * bar_max_height_);
-        
-        // Smooth transition
-        int target_height = bar_height;
-        int current = current_heights_[k - 1];
-        if (target_height > current) {
-            current_heights_[k - 1] = target_height;
-        } else {
-            current_heights_[k - 1] = current - (current - target_height) / 4;
-        }
-        bar_height = current_heights_[k - 1];
-        
-        // Color gradient based on height
-        uint16_t color;
-        if (bar_height > bar_max_height_ * 0.7f) {
-            color = 0xF800;  // Red
-        } else if (bar_height > bar_max_height_ * 0.4f) {
-            color = 0xFFE0;  // Yellow
-        } else {
-            color = 0x07E0;  // Green
-        }
-        
-        draw_bar(x_pos, y_pos, bar_width - 2, bar_height, color, k - 1);
+    if (fft_canvas_ == nullptr || fft_canvas_buffer_ == nullptr || !spectrum_) return;
+    
+    // Only the rows whose bar height changed are written, and only their
+    // bounding box is invalidated, so LVGL flushes a fraction of the canvas
+    lv_draw_buf_t* draw_buf = lv_canvas_get_draw_buf(fft_canvas_);
+    int stride_px = draw_buf ? draw_buf->header.stride / sizeof(uint16_t) : fft_canvas_width_;
+    SpectrumAnalyzer::Rect dirty;
+    if (!spectrum_->PaintBars(fft_canvas_buffer_, stride_px, fft_canvas_width_, fft_canvas_height_, &dirty)) {
+        return;
     }
-}
-
-void LcdDisplay::draw_bar(int x, int y, int bar_width, int bar_height, uint16_t color, int bar_index) {
-    if (fft_canvas_ == nullptr) return;
     
-    lv_layer_t layer;
-    lv_canvas_init_layer(fft_canvas_, &layer);
-    
-    lv_draw_rect_dsc_t rect_dsc;
-    lv_draw_rect_dsc_init(&rect_dsc);
-    rect_dsc.bg_color = lv_color_hex(color == 0xF800 ? 0xFF0000 : (color == 0xFFE0 ? 0xFFFF00 : 0x00FF00));
-    rect_dsc.bg_opa = LV_OPA_COVER;
-    rect_dsc.radius = 2;
-    
-    lv_area_t area;
-    area.x1 = x + 1;
-    area.x2 = x + bar_width;
-    area.y1 = y - bar_height;
-    area.y2 = y;
-    
-    lv_draw_rect(&layer, &rect_dsc, &area);
-    lv_canvas_finish_layer(fft_canvas_, &layer);
+    lv_area_t coords;
+    lv_obj_get_coords(fft_canvas_, &coords);
+    lv_area_t area = {
+        .x1 = (int32_t)(coords.x1 + dirty.x1),
+        .y1 = (int32_t)(coords.y1 + dirty.y1),
+        .x2 = (int32_t)(coords.x1 + dirty.x2),
+        .y2 = (int32_t)(coords.y1 + dirty.y2),
+    };
+    lv_obj_invalidate_area(fft_canvas_, &area);
 }
 
 void LcdDisplay::StartFFT() {
@@ -1556,19 +1294,20 @@ void LcdDisplay::StartFFT() {
     
     ESP_LOGI(TAG, "Starting FFT display");
     
-    // Allocate FFT buffers in PSRAM
-    if (fft_real_ == nullptr) {
-        fft_real_ = (float*)heap_caps_malloc(LCD_FFT_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-    }
-    if (fft_imag_ == nullptr) {
-        fft_imag_ = (float*)heap_caps_malloc(LCD_FFT_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-    }
-    if (hanning_window_ == nullptr) {
-        hanning_window_ = (float*)heap_caps_malloc(LCD_FFT_SIZE * sizeof(float), MALLOC_CAP_SPIRAM);
-        // Initialize Hanning window
-        for (int i = 0; i < LCD_FFT_SIZE; i++) {
-            hanning_window_[i] = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (LCD_FFT_SIZE - 1)));
-        }
+    // Allocate FFT tables in PSRAM
+    if (!spectrum_) {
+        SpectrumAnalyzer::Config config;
+        config.fft_size = LCD_FFT_SIZE;
+        config.bars = BAR_COL_NUM;
+#if !SOC_CPU_HAS_FPU
+        config.fixed_point = true;  // Soft-float FFT is too slow for 30 fps
+#endif
+        spectrum_ = std::make_unique<SpectrumAnalyzer>(config);
+    }
+    if (!spectrum_->Initialize()) {
+        ESP_LOGE(TAG, "Failed to initialize spectrum analyzer");
+        spectrum_.reset();
+        return;
     }
     if (audio_data_ == nullptr) {
         audio_data_ = (int16_t*)heap_caps_malloc(sizeof(int16_t) * 1152, MALLOC_CAP_SPIRAM);
@@ -1589,7 +1328,7 @@ void LcdDisplay::StartFFT() {
     fft_task_should_stop_ = false;
     fft_data_ready_ = false;
     audio_display_last_update_ = 0;
-    memset(current_heights_, 0, sizeof(current_heights_));
+    spectrum_->Reset();
     
     // Start FFT task
     xTaskCreatePinnedToCore(
@@ -1629,7 +1368,9 @@ void LcdDisplay::StopFFT() {
     // Reset state
     fft_data_ready_ = false;
     audio_display_last_update_ = 0;
-    memset(current_heights_, 0, sizeof(current_heights_));
+    if (spectrum_) {
+        spectrum_->Reset();
+    }
     
     // Delete canvas
     {
@@ -1672,18 +1413,7 @@ void LcdDisplay::ReleaseAudioBuffFFT(int16_t* buffer) {
     }
     
     // Also free other FFT buffers
-    if (fft_real_ != nullptr) {
-        heap_caps_free(fft_real_);
-        fft_real_ = nullptr;
-    }
-    if (fft_imag_ != nullptr) {
-        heap_caps_free(fft_imag_);
-        fft_imag_ = nullptr;
-    }
-    if (hanning_window_ != nullptr) {
-        heap_caps_free(hanning_window_);
-        hanning_window_ = nullptr;
-    }
+    spectrum_.reset();
     if (audio_data_ != nullptr) {
         heap_caps_free(audio_data_);
         audio_data_ = nullptr;
@@ -3,9 +3,13 @@
 
 #include "lvgl_display.h"
 #include "gif/lvgl_gif.h"
+#include "lvgl_rle_animation.h"
+#include "spectrum_analyzer.h"
+#include "chat_view.h"
 
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
+#include <esp_lvgl_port.h>
 #include <font_emoji.h>
 
 #include <atomic>
@@ -19,6 +23,30 @@
 #define LCD_FFT_SIZE 256
 #define BAR_COL_NUM 16
 
+// How LVGL renders into and flushes to an SPI panel. Boards can pass their own;
+// Default() comes from Kconfig (LCD_RENDER_*).
+struct LcdRenderConfig {
+    enum Mode {
+        kPartial,      // Strips of `buffer_lines` lines
+        kFullRefresh,  // Whole-screen buffers, every frame redrawn
+        kDirect,       // Whole-screen buffers, only dirty areas redrawn and flushed
+    };
+    Mode mode = kPartial;
+    int buffer_lines = 20;        // Partial mode only
+    bool double_buffer = false;   // Render the next strip while DMA sends the last one
+    bool psram_fallback = true;   // Use PSRAM buffers (with a DMA bounce buffer) if internal DMA RAM is short
+
+    static LcdRenderConfig Default();
+};
+
+struct LcdRenderStats {
+    uint32_t frames = 0;
+    float fps = 0;
+    uint32_t avg_frame_us = 0;       // Render + flush per frame
+    uint32_t avg_flush_wait_us = 0;  // Time LVGL blocked waiting for DMA per frame
+    uint32_t avg_flush_kpx = 0;      // Pixels sent per frame / 1000
+};
+
 
 class LcdDisplay : public LvglDisplay {
 protected:
@@ -36,8 +64,10 @@ protected:
     lv_obj_t* emoji_label_ = nullptr;
     lv_obj_t* emoji_image_ = nullptr;
     std::unique_ptr<LvglGif> gif_controller_ = nullptr;
+    std::unique_ptr<LvglRleAnimation> anim_controller_ = nullptr;
     lv_obj_t* emoji_box_ = nullptr;
     lv_obj_t* chat_message_label_ = nullptr;
+    std::unique_ptr<ChatView> chat_view_;  // WeChat message style only
     esp_timer_handle_t preview_timer_ = nullptr;
     std::unique_ptr<LvglImage> preview_image_cached_ = nullptr;
     bool hide_subtitle_ = false;  // Control whether to hide chat messages/subtitles
@@ -51,21 +81,14 @@ protected:
     void processAudioData();
     void periodicUpdateTask();
     static void periodicUpdateTaskWrapper(void* arg);
-    void compute(float* real, float* imag, int n, bool forward);
     void drawSpectrum();
-    void draw_spectrum(float* power_spectrum, int fft_size);
-    void draw_bar(int x, int y, int bar_width, int bar_height, uint16_t color, int bar_index);
     void create_fft_canvas();
     
     // FFT buffers (allocated in PSRAM)
     int16_t* final_pcm_data_fft_ = nullptr;
     int16_t* audio_data_ = nullptr;
     int16_t* frame_audio_data_ = nullptr;
-    float* fft_real_ = nullptr;
-    float* fft_imag_ = nullptr;
-    float* hanning_window_ = nullptr;
-    float avg_power_spectrum_[LCD_FFT_SIZE / 2] = {0};
-    int current_heights_[BAR_COL_NUM] = {0};
+    std::unique_ptr<SpectrumAnalyzer> spectrum_;
     
     // FFT state
     int audio_display_last_update_ = 0;
@@ -78,7 +101,21 @@ protected:
     uint16_t* fft_canvas_buffer_ = nullptr;
     int fft_canvas_width_ = 0;
     int fft_canvas_height_ = 0;
-    int bar_max_height_ = 0;
+
+    // Render strategy / probe
+    void ApplyRenderConfig(const LcdRenderConfig& config, lvgl_port_display_cfg_t& display_cfg);
+    void InstallRenderProbe();
+    static void RenderProbeEventCallback(lv_event_t* e);
+    struct RenderProbe {
+        int64_t window_start_us = 0;
+        int64_t render_start_us = 0;
+        int64_t flush_wait_start_us = 0;
+        int64_t frame_us = 0;
+        int64_t flush_wait_us = 0;
+        uint64_t flushed_px = 0;
+        uint32_t frames = 0;
+        LcdRenderStats last;
+    } render_probe_;
 
 protected:
     // Add protected constructor
@@ -88,6 +125,9 @@ public:
     ~LcdDisplay();
     virtual void SetEmotion(const char* emotion) override;
     virtual void SetChatMessage(const char* role, const char* content) override; 
+#if CONFIG_USE_WECHAT_MESSAGE_STYLE
+    virtual void AppendChatMessage(const char* role, const char* content) override;
+#endif
     virtual void SetPreviewImage(std::unique_ptr<LvglImage> image) override;
 
     // Add theme switching function
@@ -95,6 +135,9 @@ public:
     
     // Set whether to hide chat messages/subtitles
     void SetHideSubtitle(bool hide);
+
+    // fps/flush figures of the last probe window (CONFIG_LCD_RENDER_PROBE)
+    LcdRenderStats GetRenderStats();
     
     // FFT Spectrum methods
     virtual void StartFFT() override;
@@ -109,7 +152,8 @@ class SpiLcdDisplay : public LcdDisplay {
 public:
     SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handle_t panel,
                   int width, int height, int offset_x, int offset_y,
-                  bool mirror_x, bool mirror_y, bool swap_xy);
+                  bool mirror_x, bool mirror_y, bool swap_xy,
+                  const LcdRenderConfig& render_config = LcdRenderConfig::Default());
 };
 
 // RGB LCD display
@@ -29,6 +29,9 @@ typedef struct Table {
 #endif
 
 static gd_GIF  * gif_open(gd_GIF * gif);
+static void fill_canvas_bg(gd_GIF * gif);
+static bool scan_opaque(gd_GIF * gif, uint16_t width, uint16_t height);
+static void update_lut565(gd_GIF * gif);
 static bool f_gif_open(gd_GIF * gif, const void * path, bool is_file);
 static void f_gif_read(gd_GIF * gif, void * buf, size_t len);
 static int f_gif_seek(gd_GIF * gif, size_t pos, int k);
@@ -71,13 +74,43 @@ gd_open_gif_data(const void * data)
     return gif_open(&gif_base);
 }
 
+static inline uint16_t
+rgb565(const uint8_t * color)
+{
+    return ((color[0] & 0xF8) << 8) | ((color[1] & 0xFC) << 3) | (color[2] >> 3);
+}
+
+static void fill_canvas_bg(gd_GIF * gif)
+{
+    uint8_t * bgcolor = &gif->palette->colors[gif->bgindex * 3];
+    if(gif->rgb565) {
+        uint16_t * canvas = (uint16_t *) gif->canvas;
+        uint16_t bg = rgb565(bgcolor);
+        for(int i = 0; i < gif->width * gif->height; i++) {
+            canvas[i] = bg;
+        }
+        return;
+    }
+#ifdef GIFDEC_FILL_BG
+    GIFDEC_FILL_BG(gif->canvas, gif->width * gif->height, 1, gif->width * gif->height, bgcolor, 0x00);
+#else
+    for(int i = 0; i < gif->width * gif->height; i++) {
+        gif->canvas[i * 4 + 0] = *(bgcolor + 2);
+        gif->canvas[i * 4 + 1] = *(bgcolor + 1);
+        gif->canvas[i * 4 + 2] = *(bgcolor + 0);
+        gif->canvas[i * 4 + 3] = 0x00;  // 初始化为透明，让第一帧根据自己的透明度设置来渲染
+    }
+#endif
+}
+
 static gd_GIF * gif_open(gd_GIF * gif_base)
 {
     uint8_t sigver[3];
     uint16_t width, height, depth;
     uint8_t fdsz, bgidx, aspect;
-    uint8_t * bgcolor;
     int gct_sz;
+    bool opaque;
+    int canvas_bpp;
     gd_GIF * gif = NULL;
 
     /* Header */
@@ -116,49 +149,50 @@ static gd_GIF * gif_open(gd_GIF * gif_base)
         ESP_LOGW(TAG, "Zero size image");
         goto fail;
     }
+    /* Fully opaque GIFs get a 2 bytes/pixel canvas */
+    {
+        int32_t gct_pos = f_gif_seek(gif_base, 0, LV_FS_SEEK_CUR);
+        f_gif_seek(gif_base, 3 * gct_sz, LV_FS_SEEK_CUR);
+        opaque = scan_opaque(gif_base, width, height);
+        f_gif_seek(gif_base, gct_pos, LV_FS_SEEK_SET);
+    }
+    canvas_bpp = opaque ? 2 : 4;
 #if LV_GIF_CACHE_DECODE_DATA
     if(0 == (INT_MAX - sizeof(gd_GIF) - LZW_CACHE_SIZE) / width / height / 5){
         ESP_LOGW(TAG, "Image dimensions are too large");
         goto fail;
     } 
-    gif = lv_malloc(sizeof(gd_GIF) + 5 * width * height + LZW_CACHE_SIZE);
+    gif = lv_malloc(sizeof(gd_GIF) + (canvas_bpp + 1) * width * height + LZW_CACHE_SIZE);
 #else
     if(0 == (INT_MAX - sizeof(gd_GIF)) / width / height / 5){
         ESP_LOGW(TAG, "Image dimensions are too large");
         goto fail;
     } 
-    gif = lv_malloc(sizeof(gd_GIF) + 5 * width * height);
+    gif = lv_malloc(sizeof(gd_GIF) + (canvas_bpp + 1) * width * height);
 #endif
     if(!gif) goto fail;
     memcpy(gif, gif_base, sizeof(gd_GIF));
     gif->width  = width;
     gif->height = height;
     gif->depth  = depth;
+    gif->rgb565 = opaque;
     /* Read GCT */
     gif->gct.size = gct_sz;
     f_gif_read(gif, gif->gct.colors, 3 * gif->gct.size);
     gif->palette = &gif->gct;
+    gif->lut_palette = NULL;
+    update_lut565(gif);
     gif->bgindex = bgidx;
     gif->canvas = (uint8_t *) &gif[1];
-    gif->frame = &gif->canvas[4 * width * height];
+    gif->frame = &gif->canvas[canvas_bpp * width * height];
     if(gif->bgindex) {
         memset(gif->frame, gif->bgindex, gif->width * gif->height);
     }
-    bgcolor = &gif->palette->colors[gif->bgindex * 3];
     #if LV_GIF_CACHE_DECODE_DATA
     gif->lzw_cache = gif->frame + width * height;
     #endif
 
-#ifdef GIFDEC_FILL_BG
-    GIFDEC_FILL_BG(gif->canvas, gif->width * gif->height, 1, gif->width * gif->height, bgcolor, 0x00);
-#else
-    for(int i = 0; i < gif->width * gif->height; i++) {
-        gif->canvas[i * 4 + 0] = *(bgcolor + 2);
-        gif->canvas[i * 4 + 1] = *(bgcolor + 1);
-        gif->canvas[i * 4 + 2] = *(bgcolor + 0);
-        gif->canvas[i * 4 + 3] = 0x00;  // 初始化为透明，让第一帧根据自己的透明度设置来渲染
-    }
-#endif
+    fill_canvas_bg(gif);
     gif->anim_start = f_gif_seek(gif, 0, LV_FS_SEEK_CUR);
     gif->loop_count = -1;
     goto ok;
@@ -179,6 +213,77 @@ discard_sub_blocks(gd_GIF * gif)
     } while(size);
 }
 
+/* Walk the block structure without decoding. True if the first frame is
+ * opaque and covers the whole image and no frame is disposed to a
+ * transparent background, so every canvas pixel stays opaque. Transparent
+ * pixels in later frames only leave the canvas unchanged, which is how
+ * optimised GIFs encode deltas. */
+static bool
+scan_opaque(gd_GIF * gif, uint16_t width, uint16_t height)
+{
+    bool first_image = true;
+    bool transparent = false;
+    uint8_t sep, label, flags;
+
+    for(;;) {
+        f_gif_read(gif, &sep, 1);
+        if(sep == ';') {
+            return !first_image;
+        }
+        else if(sep == '!') {
+            f_gif_read(gif, &label, 1);
+            if(label == 0xF9) {
+                /* Block size, then packed fields */
+                f_gif_seek(gif, 1, LV_FS_SEEK_CUR);
+                f_gif_read(gif, &flags, 1);
+                transparent = flags & 1;
+                /* Disposal 2 with transparency clears to alpha 0 */
+                if(transparent && ((flags >> 2) & 3) == 2) {
+                    return false;
+                }
+                /* Delay, transparent index, terminator */
+                f_gif_seek(gif, 4, LV_FS_SEEK_CUR);
+            }
+            else {
+                discard_sub_blocks(gif);
+            }
+        }
+        else if(sep == ',') {
+            uint16_t x = read_num(gif);
+            uint16_t y = read_num(gif);
+            uint16_t w = read_num(gif);
+            uint16_t h = read_num(gif);
+            if(first_image && (transparent || x != 0 || y != 0 || w != width || h != height)) {
+                return false;
+            }
+            first_image = false;
+            transparent = false;
+            f_gif_read(gif, &flags, 1);
+            if(flags & 0x80) {
+                f_gif_seek(gif, 3 * (1 << ((flags & 0x07) + 1)), LV_FS_SEEK_CUR);
+            }
+            /* LZW minimum code size, then the data sub-blocks */
+            f_gif_seek(gif, 1, LV_FS_SEEK_CUR);
+            discard_sub_blocks(gif);
+        }
+        else {
+            return false;
+        }
+    }
+}
+
+static void
+update_lut565(gd_GIF * gif)
+{
+    if(!gif->rgb565) {
+        return;
+    }
+    for(int i = 0; i < gif->palette->size; i++) {
+        gif->lut565[i] = rgb565(&gif->palette->colors[i * 3]);
+    }
+    gif->lut_palette = gif->palette;
+}
+
 static void
 read_plain_text_ext(gd_GIF * gif)
 {
@@ -650,16 +755,55 @@ read_image(gd_GIF * gif)
         gif->lct.size = 1 << ((fisrz & 0x07) + 1);
         f_gif_read(gif, gif->lct.colors, 3 * gif->lct.size);
         gif->palette = &gif->lct;
+        update_lut565(gif);
     }
-    else
+    else {
         gif->palette = &gif->gct;
+        if(gif->lut_palette != gif->palette) {
+            update_lut565(gif);
+        }
+    }
     /* Image Data. */
     return read_image_data(gif, interlace);
 }
 
+static void
+render_frame_rect_565(gd_GIF * gif, uint16_t * buffer)
+{
+    const uint8_t * src = &gif->frame[gif->fy * gif->width + gif->fx];
+    uint16_t * dst = &buffer[gif->fy * gif->width + gif->fx];
+    const uint16_t * lut = gif->lut565;
+
+    if(!gif->gce.transparency) {
+        for(int j = 0; j < gif->fh; j++) {
+            for(int k = 0; k < gif->fw; k++) {
+                dst[k] = lut[src[k]];
+            }
+            src += gif->width;
+            dst += gif->width;
+        }
+        return;
+    }
+
+    uint8_t tindex = gif->gce.tindex;
+    for(int j = 0; j < gif->fh; j++) {
+        for(int k = 0; k < gif->fw; k++) {
+            if(src[k] != tindex) {
+                dst[k] = lut[src[k]];
+            }
+        }
+        src += gif->width;
+        dst += gif->width;
+    }
+}
+
 static void
 render_frame_rect(gd_GIF * gif, uint8_t * buffer)
 {
+    if(gif->rgb565) {
+        render_frame_rect_565(gif, (uint16_t *) buffer);
+        return;
+    }
     int i = gif->fy * gif->width + gif->fx;
 #ifdef GIFDEC_RENDER_FRAME
     GIFDEC_RENDER_FRAME(&buffer[i * 4], gif->fw, gif->fh, gif->width,
@@ -693,6 +837,16 @@ dispose(gd_GIF * gif)
     switch(gif->gce.disposal) {
         case 2: /* Restore to background color. */
             bgcolor = &gif->palette->colors[gif->bgindex * 3];
+            if(gif->rgb565) {
+                uint16_t bg = rgb565(bgcolor);
+                uint16_t * row = &((uint16_t *) gif->canvas)[gif->fy * gif->width + gif->fx];
+                for(int j = 0; j < gif->fh; j++, row += gif->width) {
+                    for(int k = 0; k < gif->fw; k++) {
+                        row[k] = bg;
+                    }
+                }
+                break;
+            }
 
             uint8_t opa = 0xff;
             if(gif->gce.transparency) opa = 0x00;
@@ -762,6 +916,21 @@ gd_rewind(gd_GIF * gif)
     f_gif_seek(gif, gif->anim_start, LV_FS_SEEK_SET);
 }
 
+/* Back to the state right after opening: first frame next, blank canvas */
+void
+gd_reset(gd_GIF * gif)
+{
+    gd_rewind(gif);
+    memset(&gif->gce, 0, sizeof(gif->gce));
+    gif->fx = gif->fy = gif->fw = gif->fh = 0;
+    gif->palette = &gif->gct;
+    update_lut565(gif);
+    if(gif->bgindex) {
+        memset(gif->frame, gif->bgindex, gif->width * gif->height);
+    }
+    fill_canvas_bg(gif);
+}
+
 void
 gd_close_gif(gd_GIF * gif)
 {
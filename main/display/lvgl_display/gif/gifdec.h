@@ -45,6 +45,12 @@ typedef struct _gd_GIF {
     void (*application)(struct _gd_GIF * gif, char id[8], char auth[3]);
     uint16_t fx, fy, fw, fh;
     uint8_t bgindex;
+    /* Canvas holds RGB565 (2 bytes/pixel) instead of ARGB8888. Chosen at
+     * open time when no canvas pixel can become transparent, the common
+     * case for emoji. */
+    uint8_t rgb565;
+    const gd_Palette * lut_palette;
+    uint16_t lut565[0x100];
     uint8_t * canvas, * frame;
 #if LV_GIF_CACHE_DECODE_DATA
     uint8_t *lzw_cache;
@@ -59,6 +65,7 @@ void gd_render_frame(gd_GIF * gif, uint8_t * buffer);
 
 int gd_get_frame(gd_GIF * gif);
 void gd_rewind(gd_GIF * gif);
+void gd_reset(gd_GIF * gif);
 void gd_close_gif(gd_GIF * gif);
 
 #ifdef __cplusplus
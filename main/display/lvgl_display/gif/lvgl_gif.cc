@@ -4,6 +4,9 @@
 
 #define TAG "LvglGif"
 
+// LVGL timer resolution floor; GIF delays are in 10 ms units
+static constexpr uint32_t kMinFrameDelayMs = 10;
+
 LvglGif::LvglGif(const lv_img_dsc_t* img_dsc)
     : gif_(nullptr), timer_(nullptr), last_call_(0), playing_(false), loaded_(false) {
     if (!img_dsc || !img_dsc->data) {
@@ -17,16 +20,19 @@ LvglGif::LvglGif(const lv_img_dsc_t* img_dsc)
         return;
     }
 
-    // Setup LVGL image descriptor
+    // Setup LVGL image descriptor. Opaque GIFs are decoded to RGB565, which
+    // is half the memory and needs no alpha blending when drawn
+    uint32_t bpp = gif_->rgb565 ? 2 : 4;
     memset(&img_dsc_, 0, sizeof(img_dsc_));
     img_dsc_.header.magic = LV_IMAGE_HEADER_MAGIC;
     img_dsc_.header.flags = LV_IMAGE_FLAGS_MODIFIABLE;
-    img_dsc_.header.cf = LV_COLOR_FORMAT_ARGB8888;
+    img_dsc_.header.cf = gif_->rgb565 ? LV_COLOR_FORMAT_RGB565 : LV_COLOR_FORMAT_ARGB8888;
     img_dsc_.header.w = gif_->width;
     img_dsc_.header.h = gif_->height;
-    img_dsc_.header.stride = gif_->width * 4;
+    img_dsc_.header.stride = gif_->width * bpp;
     img_dsc_.data = gif_->canvas;
-    img_dsc_.data_size = gif_->width * gif_->height * 4;
+    img_dsc_.data_size = gif_->width * gif_->height * bpp;
+    dirty_area_ = {0, 0, gif_->width - 1, gif_->height - 1};
 
     // Render first frame
     if (gif_->canvas) {
@@ -57,11 +63,14 @@ void LvglGif::Start() {
         return;
     }
 
+    // The timer period is set to each frame's delay in NextFrame(), so the
+    // timer only fires when a frame is due
     if (!timer_) {
         timer_ = lv_timer_create([](lv_timer_t* timer) {
             LvglGif* gif_obj = static_cast<LvglGif*>(lv_timer_get_user_data(timer));
+            gif_obj->wakeups_++;
             gif_obj->NextFrame();
-        }, 10, this);
+        }, kMinFrameDelayMs, this);
     }
 
     if (timer_) {
@@ -70,7 +79,7 @@ void LvglGif::Start() {
         lv_timer_resume(timer_);
         lv_timer_reset(timer_);
         
-        // Render first frame
+        // Render the current frame now, the timer takes over from its delay
         NextFrame();
         
         ESP_LOGD(TAG, "GIF animation started");
@@ -111,6 +120,21 @@ void LvglGif::Stop() {
     }
 }
 
+void LvglGif::Rewind() {
+    if (timer_) {
+        playing_ = false;
+        lv_timer_pause(timer_);
+    }
+
+    if (gif_) {
+        gd_reset(gif_);
+        if (gif_->canvas) {
+            gd_render_frame(gif_, gif_->canvas);
+        }
+        last_call_ = lv_tick_get();
+    }
+}
+
 bool LvglGif::IsPlaying() const {
     return playing_;
 }
@@ -148,6 +172,23 @@ uint16_t LvglGif::height() const {
     return gif_->height;
 }
 
+size_t LvglGif::memory_size() const {
+    if (!loaded_ || !gif_) {
+        return 0;
+    }
+    return sizeof(gd_GIF) + (size_t)(img_dsc_.header.stride + gif_->width) * gif_->height;
+}
+
+LvglGif::Stats LvglGif::GetStats() const {
+    Stats stats;
+    stats.frames = frames_;
+    stats.wakeups = wakeups_;
+    if (frames_ > 0 && loaded_) {
+        stats.dirty_percent = dirty_pixels_ * 100 / ((uint64_t)frames_ * gif_->width * gif_->height);
+    }
+    return stats;
+}
+
 void LvglGif::SetFrameCallback(std::function<void()> callback) {
     frame_callback_ = callback;
 }
@@ -157,14 +198,12 @@ void LvglGif::NextFrame() {
         return;
     }
 
-    // Check if enough time has passed for the next frame
-    uint32_t elapsed = lv_tick_elaps(last_call_);
-    if (elapsed < gif_->gce.delay * 10) {
-        return;
-    }
-
     last_call_ = lv_tick_get();
 
+    // The previous frame's rect changes again if it is disposed to background
+    lv_area_t previous = {gif_->fx, gif_->fy, gif_->fx + gif_->fw - 1, gif_->fy + gif_->fh - 1};
+    bool previous_cleared = gif_->gce.disposal == 2 && gif_->fw > 0 && gif_->fh > 0;
+
     // Get next frame
     int has_next = gd_get_frame(gif_);
     if (has_next == 0) {
@@ -179,12 +218,27 @@ void LvglGif::NextFrame() {
     // Render current frame
     if (gif_->canvas) {
         gd_render_frame(gif_, gif_->canvas);
-        
+
+        dirty_area_ = {gif_->fx, gif_->fy, gif_->fx + gif_->fw - 1, gif_->fy + gif_->fh - 1};
+        if (previous_cleared) {
+            dirty_area_.x1 = LV_MIN(dirty_area_.x1, previous.x1);
+            dirty_area_.y1 = LV_MIN(dirty_area_.y1, previous.y1);
+            dirty_area_.x2 = LV_MAX(dirty_area_.x2, previous.x2);
+            dirty_area_.y2 = LV_MAX(dirty_area_.y2, previous.y2);
+        }
+        frames_++;
+        dirty_pixels_ += (uint64_t)(dirty_area_.x2 - dirty_area_.x1 + 1) * (dirty_area_.y2 - dirty_area_.y1 + 1);
+
         // Call frame callback if set
         if (frame_callback_) {
             frame_callback_();
         }
     }
+
+    // Sleep until this frame's delay has passed
+    if (playing_ && timer_) {
+        lv_timer_set_period(timer_, LV_MAX(gif_->gce.delay * 10, kMinFrameDelayMs));
+    }
 }
 
 void LvglGif::Cleanup() {
@@ -12,6 +12,12 @@
  */
 class LvglGif {
 public:
+    struct Stats {
+        uint32_t frames = 0;         // Frames rendered
+        uint32_t wakeups = 0;        // Timer callbacks
+        uint32_t dirty_percent = 0;  // Average share of the image redrawn per frame
+    };
+
     explicit LvglGif(const lv_img_dsc_t* img_dsc);
     virtual ~LvglGif();
 
@@ -38,6 +44,12 @@ public:
      */
     void Stop();
 
+    /**
+     * Reset the decoder to its freshly-opened state (blank canvas, first
+     * frame next) without re-opening it; the timer is left paused
+     */
+    void Rewind();
+
     /**
      * Check if GIF is currently playing
      */
@@ -64,6 +76,19 @@ public:
     uint16_t width() const;
     uint16_t height() const;
 
+    /**
+     * Decoder memory (header, canvas and frame indices) in bytes
+     */
+    size_t memory_size() const;
+
+    /**
+     * Area changed by the last frame, in image coordinates. Frame callbacks
+     * can invalidate just this instead of the whole image.
+     */
+    const lv_area_t& dirty_area() const { return dirty_area_; }
+
+    Stats GetStats() const;
+
     /**
      * Set frame update callback
      */
@@ -81,6 +106,11 @@ private:
     
     // Last frame update time
     uint32_t last_call_;
+
+    lv_area_t dirty_area_;
+    uint32_t frames_ = 0;
+    uint32_t wakeups_ = 0;
+    uint64_t dirty_pixels_ = 0;
     
     // Animation state
     bool playing_;
@@ -0,0 +1,107 @@
+#include "lvgl_gif_cache.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
+
+#define TAG "LvglGifCache"
+
+// Upper bound of what opening the GIF will allocate, from the logical screen size
+// in its header: 4 bytes/pixel canvas (transparent GIFs) + 1 byte/pixel frame
+static size_t EstimateOpenBytes(const lv_img_dsc_t* img_dsc) {
+    const uint8_t* data = img_dsc->data;
+    if (!data || img_dsc->data_size < 10 || memcmp(data, "GIF", 3) != 0) {
+        return 0;
+    }
+    size_t width = data[6] | (data[7] << 8);
+    size_t height = data[8] | (data[9] << 8);
+    return 5 * width * height;
+}
+
+LvglGifCache::LvglGifCache(size_t max_entries, size_t max_bytes)
+    : max_entries_(max_entries > 0 ? max_entries : 1), max_bytes_(max_bytes) {
+}
+
+LvglGifCache::~LvglGifCache() {
+    Clear();
+}
+
+LvglGif* LvglGifCache::Acquire(const lv_img_dsc_t* img_dsc) {
+    if (!img_dsc) {
+        return nullptr;
+    }
+    int64_t start_us = esp_timer_get_time();
+
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->key != img_dsc) {
+            continue;
+        }
+        entries_.splice(entries_.begin(), entries_, it);
+        LvglGif* gif = entries_.front().gif.get();
+        if (active_ && active_ != gif) {
+            active_->Pause();
+        }
+        gif->Rewind();
+        active_ = gif;
+
+        uint32_t elapsed = esp_timer_get_time() - start_us;
+        stats_.hits++;
+        stats_.last_switch_us = elapsed;
+        hit_us_total_ += elapsed;
+        return gif;
+    }
+
+    if (active_) {
+        active_->Pause();
+    }
+
+    // Make room before opening, so the evicted buffers are free for the new one
+    EvictToFit(EstimateOpenBytes(img_dsc));
+    auto gif = std::make_unique<LvglGif>(img_dsc);
+    if (!gif->IsLoaded()) {
+        ESP_LOGE(TAG, "Failed to open GIF %p", img_dsc);
+        return nullptr;
+    }
+
+    size_t bytes = gif->memory_size();
+    EvictToFit(bytes);
+    entries_.push_front({img_dsc, std::move(gif), bytes});
+    bytes_ += bytes;
+    active_ = entries_.front().gif.get();
+
+    uint32_t elapsed = esp_timer_get_time() - start_us;
+    stats_.misses++;
+    stats_.last_switch_us = elapsed;
+    miss_us_total_ += elapsed;
+    ESP_LOGI(TAG, "Cached GIF %dx%d (%u KB), %u entries / %u KB, open took %luus",
+             active_->width(), active_->height(), (unsigned)(bytes / 1024),
+             (unsigned)entries_.size(), (unsigned)(bytes_ / 1024), (unsigned long)elapsed);
+    return active_;
+}
+
+void LvglGifCache::EvictToFit(size_t incoming_bytes) {
+    while (!entries_.empty() &&
+           (entries_.size() + 1 > max_entries_ || bytes_ + incoming_bytes > max_bytes_)) {
+        Entry& victim = entries_.back();
+        if (victim.gif.get() == active_) {
+            active_ = nullptr;
+        }
+        bytes_ -= victim.bytes;
+        entries_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+void LvglGifCache::Clear() {
+    entries_.clear();
+    bytes_ = 0;
+    active_ = nullptr;
+}
+
+LvglGifCache::Stats LvglGifCache::GetStats() const {
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    stats.avg_hit_us = stats_.hits ? hit_us_total_ / stats_.hits : 0;
+    stats.avg_miss_us = stats_.misses ? miss_us_total_ / stats_.misses : 0;
+    return stats;
+}
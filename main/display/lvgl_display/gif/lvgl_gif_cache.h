@@ -0,0 +1,66 @@
+#pragma once
+
+#include "lvgl_gif.h"
+#include <lvgl.h>
+#include <list>
+#include <memory>
+
+/**
+ * Bounded LRU cache of live GIF decoders keyed by image descriptor.
+ *
+ * Opening a GIF allocates canvas + frame buffers (3-5 bytes per pixel) and
+ * re-parses the header; keeping the decoders alive turns an emotion switch
+ * into a rewind plus a pointer swap. Entries are evicted least recently used
+ * first when the entry count or byte budget is exceeded. Large allocations
+ * land in PSRAM through lv_malloc.
+ *
+ * Not thread-safe: call with the display lock held (decoders own LVGL timers).
+ */
+class LvglGifCache {
+public:
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+        uint32_t entries = 0;
+        size_t bytes = 0;
+        uint32_t last_switch_us = 0;
+        uint32_t avg_hit_us = 0;
+        uint32_t avg_miss_us = 0;
+    };
+
+    LvglGifCache(size_t max_entries, size_t max_bytes);
+    ~LvglGifCache();
+    LvglGifCache(const LvglGifCache&) = delete;
+    LvglGifCache& operator=(const LvglGifCache&) = delete;
+
+    /**
+     * Get the decoder for `img_dsc`, rewound to its first frame and paused.
+     * The previously acquired decoder is paused. Returns nullptr if the GIF
+     * cannot be opened. The pointer stays valid until the entry is evicted,
+     * i.e. at least until the next Acquire() or Clear().
+     */
+    LvglGif* Acquire(const lv_img_dsc_t* img_dsc);
+
+    void Clear();
+    Stats GetStats() const;
+
+private:
+    struct Entry {
+        const lv_img_dsc_t* key;
+        std::unique_ptr<LvglGif> gif;
+        size_t bytes;
+    };
+
+    void EvictToFit(size_t incoming_bytes);
+
+    std::list<Entry> entries_;  // Front = most recently used
+    size_t max_entries_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    LvglGif* active_ = nullptr;
+
+    Stats stats_;
+    uint64_t hit_us_total_ = 0;
+    uint64_t miss_us_total_ = 0;
+};
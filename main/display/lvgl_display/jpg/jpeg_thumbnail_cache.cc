@@ -0,0 +1,100 @@
+#include "jpeg_thumbnail_cache.h"
+#ifndef CONFIG_IDF_TARGET_ESP32
+
+#include "jpeg_to_image.h"
+
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdio>
+
+#define TAG "JpegThumbnailCache"
+
+JpegThumbnailCache::Thumbnail::~Thumbnail() {
+    heap_caps_free(data);
+}
+
+JpegThumbnailCache& JpegThumbnailCache::GetInstance() {
+    static JpegThumbnailCache instance(CONFIG_JPEG_THUMBNAIL_CACHE_SIZE_KB * 1024);
+    return instance;
+}
+
+JpegThumbnailCache::JpegThumbnailCache(size_t max_bytes) : max_bytes_(max_bytes) {
+}
+
+std::string JpegThumbnailCache::MakeKey(const uint8_t* jpeg, size_t len, int max_width, int max_height) {
+    // FNV-1a over the whole file, plus the length to make collisions even less likely
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ jpeg[i]) * 0x100000001b3ULL;
+    }
+    char key[48];
+    snprintf(key, sizeof(key), "%016llx-%u@%dx%d", (unsigned long long)hash, (unsigned)len, max_width, max_height);
+    return key;
+}
+
+std::shared_ptr<const JpegThumbnailCache::Thumbnail> JpegThumbnailCache::Lookup(const std::string& full_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(full_key);
+    if (found == index_.end()) {
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, found->second);
+    return found->second->thumbnail;
+}
+
+void JpegThumbnailCache::Insert(const std::string& full_key, std::shared_ptr<const Thumbnail> thumbnail) {
+    if (thumbnail->size > max_bytes_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Decoded twice in parallel: keep the one already cached
+    if (index_.count(full_key) > 0) {
+        return;
+    }
+    while (!lru_.empty() && bytes_ + thumbnail->size > max_bytes_) {
+        auto last = std::prev(lru_.end());
+        bytes_ -= last->thumbnail->size;
+        index_.erase(last->key);
+        lru_.erase(last);
+    }
+    bytes_ += thumbnail->size;
+    lru_.push_front({full_key, std::move(thumbnail)});
+    index_[full_key] = lru_.begin();
+}
+
+std::shared_ptr<const JpegThumbnailCache::Thumbnail> JpegThumbnailCache::Get(const uint8_t* jpeg, size_t len,
+                                                                             int max_width, int max_height) {
+    if (jpeg == nullptr || len == 0 || max_width <= 0 || max_height <= 0) {
+        return nullptr;
+    }
+    std::string full_key = MakeKey(jpeg, len, max_width, max_height);
+    auto cached = Lookup(full_key);
+    if (cached) {
+        return cached;
+    }
+
+    // Decode outside the lock, it can take a while
+    int64_t start_us = esp_timer_get_time();
+    uint8_t* data = nullptr;
+    size_t size = 0, width = 0, height = 0, stride = 0;
+    esp_err_t ret = jpeg_to_image_fit(jpeg, len, max_width, max_height, &data, &size, &width, &height, &stride);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to decode %u byte JPEG: %s", (unsigned)len, esp_err_to_name(ret));
+        return nullptr;
+    }
+    auto thumbnail = std::make_shared<Thumbnail>();
+    thumbnail->data = data;
+    thumbnail->size = size;
+    thumbnail->width = width;
+    thumbnail->height = height;
+    thumbnail->stride = stride;
+
+    uint32_t decode_ms = (esp_timer_get_time() - start_us) / 1000;
+    ESP_LOGI(TAG, "Decoded %u byte JPEG to %ux%u in %lums", (unsigned)len, (unsigned)width, (unsigned)height,
+             (unsigned long)decode_ms);
+    Insert(full_key, thumbnail);
+    return thumbnail;
+}
+
+#endif  // CONFIG_IDF_TARGET_ESP32
@@ -0,0 +1,56 @@
+#pragma once
+#include "sdkconfig.h"
+#ifndef CONFIG_IDF_TARGET_ESP32
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * LRU cache of JPEGs decoded to screen-sized RGB565 thumbnails.
+ *
+ * Entries are keyed by a hash of the JPEG bytes plus the requested size, so
+ * the same picture sent again is found without a URL or name. Decoding goes
+ * through jpeg_to_image_fit(), so a miss never holds the full-resolution
+ * image. Thumbnails are shared: one handed out stays valid after the entry is
+ * evicted.
+ */
+class JpegThumbnailCache {
+public:
+    struct Thumbnail {
+        uint8_t* data = nullptr;  // RGB565, PSRAM when available
+        size_t size = 0;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        ~Thumbnail();
+    };
+
+    static JpegThumbnailCache& GetInstance();
+
+    // Cached thumbnail, or decode `jpeg` to fit max_width x max_height and cache it
+    std::shared_ptr<const Thumbnail> Get(const uint8_t* jpeg, size_t len, int max_width, int max_height);
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const Thumbnail> thumbnail;
+    };
+
+    explicit JpegThumbnailCache(size_t max_bytes);
+    static std::string MakeKey(const uint8_t* jpeg, size_t len, int max_width, int max_height);
+    std::shared_ptr<const Thumbnail> Lookup(const std::string& full_key);
+    void Insert(const std::string& full_key, std::shared_ptr<const Thumbnail> thumbnail);
+
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    std::mutex mutex_;
+    std::list<Entry> lru_;  // Front = most recently used
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+#endif  // CONFIG_IDF_TARGET_ESP32
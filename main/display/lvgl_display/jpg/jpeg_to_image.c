@@ -1,6 +1,8 @@
 #include <esp_check.h>
 #include <esp_err.h>
 #include <esp_heap_caps.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/param.h>
 
 #include "esp_jpeg_common.h"
@@ -262,3 +264,212 @@ esp_err_t jpeg_to_image(const uint8_t* src, size_t src_len, uint8_t** out, size_
 #endif
     return decode_with_new_jpeg(src, src_len, out, out_len, width, height, stride);
 }
+
+// Largest size with the aspect ratio of w x h that fits in max_w x max_h, never upscaled
+static void fit_size(size_t w, size_t h, size_t max_w, size_t max_h, size_t* out_w, size_t* out_h) {
+    if (w <= max_w && h <= max_h) {
+        *out_w = w;
+        *out_h = h;
+    } else if (w * max_h > h * max_w) {
+        *out_w = max_w;
+        *out_h = MAX(h * max_w / w, 1);
+    } else {
+        *out_h = max_h;
+        *out_w = MAX(w * max_h / h, 1);
+    }
+}
+
+#ifndef CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+// Largest DCT scale 1/n whose output still covers out_w x out_h. esp_new_jpeg wants the
+// scaled size to be an exact 1/n of the source and a multiple of 8.
+static int pick_scale(size_t w, size_t h, size_t out_w, size_t out_h) {
+    for (int n = 8; n >= 2; n /= 2) {
+        if (w % n == 0 && h % n == 0 && (w / n) % 8 == 0 && (h / n) % 8 == 0 && w / n >= out_w && h / n >= out_h) {
+            return n;
+        }
+    }
+    return 1;
+}
+#endif  // CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+
+// Nearest-neighbour: fill every output row whose source row falls in [src_y0, src_y0 + rows)
+static void resample_rows(const uint8_t* src, size_t src_stride, size_t src_y0, size_t rows, size_t src_h,
+                          uint16_t* dst, size_t dst_w, size_t dst_h, const uint16_t* x_map) {
+    for (size_t oy = (src_y0 * dst_h + src_h - 1) / src_h; oy < dst_h; oy++) {
+        size_t sy = oy * src_h / dst_h;
+        if (sy >= src_y0 + rows) {
+            break;
+        }
+        const uint16_t* line = (const uint16_t*)(src + (sy - src_y0) * src_stride);
+        uint16_t* out = dst + oy * dst_w;
+        for (size_t x = 0; x < dst_w; x++) {
+            out[x] = line[x_map[x]];
+        }
+    }
+}
+
+static uint16_t* alloc_fit_output(size_t src_w, size_t out_w, size_t out_h, uint16_t** x_map) {
+    uint16_t* out = heap_caps_malloc(out_w * out_h * 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (out == NULL) {
+        out = heap_caps_malloc(out_w * out_h * 2, MALLOC_CAP_8BIT);
+    }
+    *x_map = malloc(out_w * sizeof(uint16_t));
+    if (out == NULL || *x_map == NULL) {
+        heap_caps_free(out);
+        free(*x_map);
+        *x_map = NULL;
+        return NULL;
+    }
+    for (size_t x = 0; x < out_w; x++) {
+        (*x_map)[x] = x * src_w / out_w;
+    }
+    return out;
+}
+
+// Resample an already decoded image (hardware path / fallback)
+static esp_err_t resample_image(const uint8_t* src, size_t src_w, size_t src_h, size_t src_stride, size_t out_w,
+                                size_t out_h, uint8_t** out) {
+    uint16_t* x_map = NULL;
+    uint16_t* dst = alloc_fit_output(src_w, out_w, out_h, &x_map);
+    if (dst == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    resample_rows(src, src_stride, 0, src_h, src_h, dst, out_w, out_h, x_map);
+    free(x_map);
+    *out = (uint8_t*)dst;
+    return ESP_OK;
+}
+
+#ifndef CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+static esp_err_t decode_fit_with_new_jpeg(const uint8_t* src, size_t src_len, size_t max_width, size_t max_height,
+                                          uint8_t** out, size_t* width, size_t* height) {
+    esp_err_t ret = ESP_OK;
+    jpeg_dec_handle_t jpeg_dec = NULL;
+    jpeg_dec_io_t jpeg_io = {0};
+    jpeg_dec_header_info_t info = {0};
+    uint8_t* strip = NULL;
+    uint16_t* dst = NULL;
+    uint16_t* x_map = NULL;
+
+    // The header decides the scale, and the scale has to be set before opening
+    jpeg_dec_config_t config = DEFAULT_JPEG_DEC_CONFIG();
+    config.output_type = JPEG_PIXEL_FORMAT_RGB565_LE;
+    config.rotate = JPEG_ROTATE_0D;
+    if (jpeg_dec_open(&config, &jpeg_dec) != JPEG_ERR_OK) {
+        return ESP_FAIL;
+    }
+    jpeg_io.inbuf = (uint8_t*)src;
+    jpeg_io.inbuf_len = (int)src_len;
+    jpeg_error_t jpeg_ret = jpeg_dec_parse_header(jpeg_dec, &jpeg_io, &info);
+    jpeg_dec_close(jpeg_dec);
+    jpeg_dec = NULL;
+    if (jpeg_ret != JPEG_ERR_OK || info.width == 0 || info.height == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t out_w, out_h;
+    fit_size(info.width, info.height, max_width, max_height, &out_w, &out_h);
+    int scale = pick_scale(info.width, info.height, out_w, out_h);
+    size_t scaled_w = info.width / scale;
+    size_t scaled_h = info.height / scale;
+
+    config.block_enable = true;
+    if (scale > 1) {
+        config.scale.width = scaled_w;
+        config.scale.height = scaled_h;
+    }
+    if (jpeg_dec_open(&config, &jpeg_dec) != JPEG_ERR_OK) {
+        return ESP_FAIL;
+    }
+    memset(&jpeg_io, 0, sizeof(jpeg_io));
+    jpeg_io.inbuf = (uint8_t*)src;
+    jpeg_io.inbuf_len = (int)src_len;
+    int block_len = 0;
+    int block_count = 0;
+    if (jpeg_dec_parse_header(jpeg_dec, &jpeg_io, &info) != JPEG_ERR_OK ||
+        jpeg_dec_get_outbuf_len(jpeg_dec, &block_len) != JPEG_ERR_OK ||
+        jpeg_dec_get_process_count(jpeg_dec, &block_count) != JPEG_ERR_OK || block_len <= 0 ||
+        block_len % (scaled_w * 2) != 0) {
+        ret = ESP_FAIL;
+        goto jpeg_fit_failed;
+    }
+    size_t strip_rows = block_len / (scaled_w * 2);
+
+    strip = jpeg_calloc_align(block_len, 16);
+    dst = alloc_fit_output(scaled_w, out_w, out_h, &x_map);
+    if (strip == NULL || dst == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto jpeg_fit_failed;
+    }
+
+    for (int i = 0; i < block_count; i++) {
+        jpeg_io.outbuf = strip;
+        if (jpeg_dec_process(jpeg_dec, &jpeg_io) != JPEG_ERR_OK) {
+            ret = ESP_FAIL;
+            goto jpeg_fit_failed;
+        }
+        size_t y0 = i * strip_rows;
+        if (y0 < scaled_h) {
+            resample_rows(strip, scaled_w * 2, y0, MIN(strip_rows, scaled_h - y0), scaled_h, dst, out_w, out_h, x_map);
+        }
+    }
+
+    ESP_LOGD(TAG, "Decoded %dx%d at 1/%d in %d strips of %d rows -> %dx%d", info.width, info.height, scale,
+             block_count, (int)strip_rows, (int)out_w, (int)out_h);
+    jpeg_free_align(strip);
+    free(x_map);
+    jpeg_dec_close(jpeg_dec);
+    *out = (uint8_t*)dst;
+    *width = out_w;
+    *height = out_h;
+    return ESP_OK;
+
+jpeg_fit_failed:
+    if (strip) {
+        jpeg_free_align(strip);
+    }
+    heap_caps_free(dst);
+    free(x_map);
+    if (jpeg_dec) {
+        jpeg_dec_close(jpeg_dec);
+    }
+    return ret;
+}
+#endif  // CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+
+esp_err_t jpeg_to_image_fit(const uint8_t* src, size_t src_len, size_t max_width, size_t max_height, uint8_t** out,
+                            size_t* out_len, size_t* width, size_t* height, size_t* stride) {
+    if (src == NULL || src_len == 0 || max_width == 0 || max_height == 0 || out == NULL || out_len == NULL ||
+        width == NULL || height == NULL || stride == NULL) {
+        ESP_LOGE(TAG, "Invalid parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = NULL;
+    *out_len = 0;
+
+    esp_err_t ret = ESP_FAIL;
+#ifndef CONFIG_XIAOZHI_ENABLE_HARDWARE_JPEG_DECODER
+    // The hardware decoder can't scale, it goes through the full-size fallback below
+    ret = decode_fit_with_new_jpeg(src, src_len, max_width, max_height, out, width, height);
+    if (ret == ESP_ERR_NO_MEM || ret == ESP_ERR_INVALID_ARG) {
+        return ret;
+    }
+#endif
+    if (ret != ESP_OK) {
+        uint8_t* full = NULL;
+        size_t full_len, full_w, full_h, full_stride;
+        ret = jpeg_to_image(src, src_len, &full, &full_len, &full_w, &full_h, &full_stride);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        fit_size(full_w, full_h, max_width, max_height, width, height);
+        ret = resample_image(full, full_w, full_h, full_stride, *width, *height, out);
+        heap_caps_free(full);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    *stride = *width * 2;
+    *out_len = *stride * *height;
+    return ESP_OK;
+}
@@ -55,6 +55,21 @@ extern "C" {
 esp_err_t jpeg_to_image(const uint8_t* src, size_t src_len, uint8_t** out, size_t* out_len, size_t* width,
                         size_t* height, size_t* stride);
 
+/**
+ * @brief Decodes a JPEG image to RGB565 no larger than max_width x max_height, keeping the aspect ratio
+ *
+ * Meant for previews and thumbnails shown on a small screen. The software path picks the
+ * largest DCT scale (1/2, 1/4, 1/8) whose output still covers the target size, decodes
+ * it one MCU row strip at a time and resamples each strip straight into the output, so
+ * the full-resolution image is never resident. Images already within the target are
+ * decoded as-is.
+ *
+ * Parameters, return values and ownership of `*out` are the same as jpeg_to_image().
+ * The output is tightly packed: *stride == *width * 2.
+ */
+esp_err_t jpeg_to_image_fit(const uint8_t* src, size_t src_len, size_t max_width, size_t max_height, uint8_t** out,
+                            size_t* out_len, size_t* width, size_t* height, size_t* stride);
+
 #ifdef __cplusplus
 }
 #endif
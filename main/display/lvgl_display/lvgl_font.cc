@@ -1,4 +1,5 @@
 #include "lvgl_font.h"
+#include "lvgl_glyph_cache.h"
 #include <cbin_font.h>
 
 
@@ -7,7 +8,22 @@ LvglCBinFont::LvglCBinFont(void* data) {
 }
 
 LvglCBinFont::~LvglCBinFont() {
+    glyph_cache_.reset();
     if (font_ != nullptr) {
         cbin_font_delete(font_);
     }
-}
\ No newline at end of file
+}
+
+const lv_font_t* LvglCBinFont::font() const {
+    if (glyph_cache_ != nullptr) {
+        return glyph_cache_->font();
+    }
+    return font_;
+}
+
+void LvglCBinFont::EnableGlyphCache(size_t max_bytes) {
+    if (font_ == nullptr || glyph_cache_ != nullptr || max_bytes == 0) {
+        return;
+    }
+    glyph_cache_ = std::make_unique<LvglGlyphCache>(font_, max_bytes);
+}
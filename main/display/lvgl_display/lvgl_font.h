@@ -1,7 +1,9 @@
 #pragma once
 
 #include <lvgl.h>
+#include <memory>
 
+class LvglGlyphCache;
 
 class LvglFont {
 public:
@@ -24,8 +26,14 @@ class LvglCBinFont : public LvglFont {
 public:
     LvglCBinFont(void* data);
     virtual ~LvglCBinFont();
-    virtual const lv_font_t* font() const override { return font_; }
+    virtual const lv_font_t* font() const override;
+
+    // Keep decoded glyph bitmaps in PSRAM (see LvglGlyphCache). Call before
+    // font() is handed to LVGL, it returns the caching font afterwards.
+    void EnableGlyphCache(size_t max_bytes);
+    LvglGlyphCache* glyph_cache() const { return glyph_cache_.get(); }
 
 private:
     lv_font_t* font_;
+    std::unique_ptr<LvglGlyphCache> glyph_cache_;
 };
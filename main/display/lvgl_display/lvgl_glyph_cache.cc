@@ -0,0 +1,208 @@
+#include "lvgl_glyph_cache.h"
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+
+#define TAG "LvglGlyphCache"
+
+namespace {
+
+bool IsBitmapGlyph(const lv_font_glyph_dsc_t* g_dsc) {
+    return g_dsc->format >= LV_FONT_GLYPH_FORMAT_A1 && g_dsc->format <= LV_FONT_GLYPH_FORMAT_A8;
+}
+
+} // namespace
+
+LvglGlyphCache::LvglGlyphCache(const lv_font_t* font, size_t max_bytes)
+    : original_(font->get_glyph_bitmap), max_bytes_(max_bytes) {
+    wrapper_.font = *font;
+    wrapper_.font.get_glyph_bitmap = GetGlyphBitmap;
+    wrapper_.cache = this;
+}
+
+LvglGlyphCache::~LvglGlyphCache() {
+    Clear();
+}
+
+const void* LvglGlyphCache::GetGlyphBitmap(lv_font_glyph_dsc_t* g_dsc, lv_draw_buf_t* draw_buf) {
+    // LVGL calls this on the font that resolved the glyph, i.e. our wrapper
+    auto wrapper = reinterpret_cast<const Wrapper*>(g_dsc->resolved_font);
+    return wrapper->cache->Lookup(g_dsc, draw_buf);
+}
+
+const void* LvglGlyphCache::Lookup(lv_font_glyph_dsc_t* g_dsc, lv_draw_buf_t* draw_buf) {
+    if (draw_buf == nullptr || !IsBitmapGlyph(g_dsc)) {
+        return original_(g_dsc, draw_buf);
+    }
+
+    uint32_t glyph_id = g_dsc->gid.index;
+    uint32_t stride = draw_buf->header.stride;
+    uint32_t size = stride * g_dsc->box_h;
+
+    auto found = index_.find(glyph_id);
+    if (found != index_.end()) {
+        auto it = found->second;
+        if (it->stride == stride && it->size <= draw_buf->data_size) {
+            lru_.splice(lru_.begin(), lru_, it);
+            memcpy(draw_buf->data, it->data, it->size);
+            lv_draw_buf_flush_cache(draw_buf, nullptr);
+            stats_.hits++;
+            return draw_buf;
+        }
+        // Decoded for a differently shaped buffer, decode again
+        Erase(it);
+    }
+
+    stats_.misses++;
+    const void* result = original_(g_dsc, draw_buf);
+    if (result == draw_buf && size > 0 && size <= draw_buf->data_size) {
+        Insert(glyph_id, draw_buf, size);
+    }
+
+#if CONFIG_FONT_GLYPH_CACHE_BENCHMARK
+    if ((stats_.hits + stats_.misses) % 10000 == 0) {
+        auto stats = GetStats();
+        ESP_LOGI(TAG, "Hit rate %lu%% (%lu hits, %lu misses, %lu evictions), %lu glyphs / %u KB",
+                 (unsigned long)(stats.hits * 100 / (stats.hits + stats.misses)), (unsigned long)stats.hits,
+                 (unsigned long)stats.misses, (unsigned long)stats.evictions, (unsigned long)stats.entries,
+                 (unsigned)(stats.bytes / 1024));
+    }
+#endif
+    return result;
+}
+
+void LvglGlyphCache::Insert(uint32_t glyph_id, const lv_draw_buf_t* draw_buf, uint32_t size) {
+    if (size > max_bytes_) {
+        return;
+    }
+    while (!lru_.empty() && bytes_ + size > max_bytes_) {
+        Erase(std::prev(lru_.end()));
+        stats_.evictions++;
+    }
+
+    // Only worth it in PSRAM; internal RAM is better spent elsewhere
+    auto data = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (data == nullptr) {
+        return;
+    }
+    memcpy(data, draw_buf->data, size);
+    lru_.push_front({glyph_id, data, size, draw_buf->header.stride});
+    index_[glyph_id] = lru_.begin();
+    bytes_ += size;
+}
+
+void LvglGlyphCache::Erase(std::list<Entry>::iterator it) {
+    heap_caps_free(it->data);
+    bytes_ -= it->size;
+    index_.erase(it->glyph_id);
+    lru_.erase(it);
+}
+
+bool LvglGlyphCache::PrepareGlyph(uint32_t codepoint, lv_font_glyph_dsc_t& g_dsc, lv_draw_buf_t*& draw_buf) {
+    memset(&g_dsc, 0, sizeof(g_dsc));
+    if (!lv_font_get_glyph_dsc(font(), &g_dsc, codepoint, 0) || g_dsc.resolved_font != font() ||
+        !IsBitmapGlyph(&g_dsc) || g_dsc.box_w == 0 || g_dsc.box_h == 0) {
+        return false;
+    }
+
+    // The label renderer reshapes its A8 buffer to the glyph box; do the same
+    // so the cached bitmaps have the stride it will ask for
+    if (draw_buf == nullptr ||
+        lv_draw_buf_reshape(draw_buf, LV_COLOR_FORMAT_A8, g_dsc.box_w, g_dsc.box_h, LV_STRIDE_AUTO) == nullptr) {
+        if (draw_buf != nullptr) {
+            lv_draw_buf_destroy(draw_buf);
+        }
+        draw_buf = lv_draw_buf_create((g_dsc.box_w + 31) & ~31u, (g_dsc.box_h + 31) & ~31u,
+                                      LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+        if (draw_buf == nullptr) {
+            return false;
+        }
+        lv_draw_buf_reshape(draw_buf, LV_COLOR_FORMAT_A8, g_dsc.box_w, g_dsc.box_h, LV_STRIDE_AUTO);
+    }
+    return true;
+}
+
+size_t LvglGlyphCache::Prewarm(const char* text) {
+    if (text == nullptr) {
+        return 0;
+    }
+    int64_t start_us = esp_timer_get_time();
+    lv_draw_buf_t* draw_buf = nullptr;
+    size_t added = 0;
+
+    uint32_t i = 0;
+    while (text[i] != '\0') {
+        uint32_t codepoint = lv_text_encoded_next(text, &i);
+        lv_font_glyph_dsc_t g_dsc;
+        if (!PrepareGlyph(codepoint, g_dsc, draw_buf) || index_.count(g_dsc.gid.index) > 0) {
+            continue;
+        }
+        Lookup(&g_dsc, draw_buf);
+        if (index_.count(g_dsc.gid.index) > 0) {
+            added++;
+        }
+    }
+    if (draw_buf != nullptr) {
+        lv_draw_buf_destroy(draw_buf);
+    }
+
+    ESP_LOGI(TAG, "Prewarmed %u glyphs in %lums, %u glyphs / %u KB cached", (unsigned)added,
+             (unsigned long)((esp_timer_get_time() - start_us) / 1000), (unsigned)lru_.size(),
+             (unsigned)(bytes_ / 1024));
+    return added;
+}
+
+void LvglGlyphCache::Benchmark(const char* text) {
+    if (text == nullptr) {
+        return;
+    }
+    lv_draw_buf_t* draw_buf = nullptr;
+    uint32_t glyphs = 0;
+    int64_t flash_us = 0;
+    int64_t cached_us = 0;
+
+    uint32_t i = 0;
+    while (text[i] != '\0') {
+        uint32_t codepoint = lv_text_encoded_next(text, &i);
+        lv_font_glyph_dsc_t g_dsc;
+        if (!PrepareGlyph(codepoint, g_dsc, draw_buf)) {
+            continue;
+        }
+        Lookup(&g_dsc, draw_buf);  // Make sure it is cached
+
+        int64_t t0 = esp_timer_get_time();
+        original_(&g_dsc, draw_buf);
+        int64_t t1 = esp_timer_get_time();
+        Lookup(&g_dsc, draw_buf);
+        int64_t t2 = esp_timer_get_time();
+        flash_us += t1 - t0;
+        cached_us += t2 - t1;
+        glyphs++;
+    }
+    if (draw_buf != nullptr) {
+        lv_draw_buf_destroy(draw_buf);
+    }
+    if (glyphs == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "Bitmap fetch for %lu glyphs: %luus decoded from flash, %luus from cache (%.1fx)",
+             (unsigned long)glyphs, (unsigned long)flash_us, (unsigned long)cached_us,
+             (float)flash_us / LV_MAX(cached_us, (int64_t)1));
+}
+
+void LvglGlyphCache::Clear() {
+    for (auto& entry : lru_) {
+        heap_caps_free(entry.data);
+    }
+    lru_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+LvglGlyphCache::Stats LvglGlyphCache::GetStats() const {
+    Stats stats = stats_;
+    stats.entries = lru_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <lvgl.h>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+/**
+ * LRU cache of decoded glyph bitmaps for a font read from mapped flash.
+ *
+ * A cbin font keeps its glyph bitmaps (often compressed) in the assets
+ * partition, so every glyph LVGL draws is decoded again from SPI flash.
+ * This wraps the font: font() is a copy of it whose get_glyph_bitmap serves
+ * the decoded A1-A8 bitmap from PSRAM and only falls through to the
+ * original callback on a miss. Metrics, kerning and fallback fonts are
+ * untouched. The wrapped font must outlive the cache.
+ *
+ * Not thread-safe: call with the display lock held, as LVGL does.
+ */
+class LvglGlyphCache {
+public:
+    struct Stats {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint32_t evictions = 0;
+        uint32_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    LvglGlyphCache(const lv_font_t* font, size_t max_bytes);
+    ~LvglGlyphCache();
+    LvglGlyphCache(const LvglGlyphCache&) = delete;
+    LvglGlyphCache& operator=(const LvglGlyphCache&) = delete;
+
+    // The caching font to hand to LVGL
+    const lv_font_t* font() const { return &wrapper_.font; }
+
+    // Decode the glyphs of `text` (UTF-8) into the cache, returns how many were added
+    size_t Prewarm(const char* text);
+
+    // Time fetching the glyphs of `text` from flash and from the cache, and log it
+    void Benchmark(const char* text);
+
+    void Clear();
+    Stats GetStats() const;
+
+private:
+    // lv_font_t first, so the callback can get back to the cache from the font
+    struct Wrapper {
+        lv_font_t font;
+        LvglGlyphCache* cache;
+    };
+
+    struct Entry {
+        uint32_t glyph_id;
+        uint8_t* data;   // PSRAM
+        uint32_t size;
+        uint32_t stride; // Of the draw buffer the bitmap was decoded into
+    };
+
+    using GetBitmapCallback = const void* (*)(lv_font_glyph_dsc_t*, lv_draw_buf_t*);
+
+    static const void* GetGlyphBitmap(lv_font_glyph_dsc_t* g_dsc, lv_draw_buf_t* draw_buf);
+    const void* Lookup(lv_font_glyph_dsc_t* g_dsc, lv_draw_buf_t* draw_buf);
+    void Insert(uint32_t glyph_id, const lv_draw_buf_t* draw_buf, uint32_t size);
+    void Erase(std::list<Entry>::iterator it);
+    // Glyph descriptor and a draw buffer shaped for it, as the label renderer does
+    bool PrepareGlyph(uint32_t codepoint, lv_font_glyph_dsc_t& g_dsc, lv_draw_buf_t*& draw_buf);
+
+    Wrapper wrapper_;
+    GetBitmapCallback original_;
+    size_t max_bytes_;
+    size_t bytes_ = 0;
+    std::list<Entry> lru_;  // Front = most recently used
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> index_;
+    Stats stats_;
+};
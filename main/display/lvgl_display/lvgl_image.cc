@@ -1,4 +1,5 @@
 #include "lvgl_image.h"
+#include "lvgl_rle_animation.h"
 #include <cbin_font.h>
 
 #include <esp_log.h>
@@ -24,6 +25,33 @@ bool LvglRawImage::IsGif() const {
     return ptr[0] == 'G' && ptr[1] == 'I' && ptr[2] == 'F';
 }
 
+bool LvglRawImage::IsRleAnimation() const {
+    return LvglRleAnimation::IsRleAnimation(image_dsc_.data, image_dsc_.data_size);
+}
+
+void LvglImage::InvalidateArea(lv_obj_t* widget, const lv_img_dsc_t* image, const lv_area_t& area) {
+    if (widget == nullptr || image == nullptr) {
+        return;
+    }
+    if (area.x2 < area.x1 || area.y2 < area.y1) {
+        return;
+    }
+    // The pixels changed in place, don't let a cached decode be drawn
+    lv_image_cache_drop(image);
+    if (lv_image_get_scale(widget) != LV_SCALE_NONE || lv_image_get_rotation(widget) != 0 ||
+        lv_image_get_inner_align(widget) != LV_IMAGE_ALIGN_CENTER) {
+        lv_obj_invalidate(widget);
+        return;
+    }
+
+    lv_area_t content;
+    lv_obj_get_content_coords(widget, &content);
+    int32_t x = content.x1 + (lv_area_get_width(&content) - (int32_t)image->header.w) / 2;
+    int32_t y = content.y1 + (lv_area_get_height(&content) - (int32_t)image->header.h) / 2;
+    lv_area_t dirty = {x + area.x1, y + area.y1, x + area.x2, y + area.y2};
+    lv_obj_invalidate_area(widget, &dirty);
+}
+
 LvglCBinImage::LvglCBinImage(void* data) {
     image_dsc_ = cbin_img_dsc_create(static_cast<uint8_t*>(data));
 }
@@ -8,7 +8,13 @@ class LvglImage {
 public:
     virtual const lv_img_dsc_t* image_dsc() const = 0;
     virtual bool IsGif() const { return false; }
+    virtual bool IsRleAnimation() const { return false; }
     virtual ~LvglImage() = default;
+
+    // Invalidate `area` (in image coordinates) of an lv_image widget showing
+    // `image`, so animations redraw only what changed. Falls back to the
+    // whole widget when the image is scaled, rotated or not centered.
+    static void InvalidateArea(lv_obj_t* widget, const lv_img_dsc_t* image, const lv_area_t& area);
 };
 
 
@@ -17,6 +23,7 @@ public:
     LvglRawImage(void* data, size_t size);
     virtual const lv_img_dsc_t* image_dsc() const override { return &image_dsc_; }
     virtual bool IsGif() const;
+    virtual bool IsRleAnimation() const;
 
 private:
     lv_img_dsc_t image_dsc_;
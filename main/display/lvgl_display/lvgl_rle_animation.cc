@@ -0,0 +1,345 @@
+#include "lvgl_rle_animation.h"
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+
+#define TAG "LvglRleAnimation"
+
+namespace {
+
+constexpr char kMagic[4] = {'A', '5', '6', '5'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr uint32_t kFlagLoopEntry = 0x1;
+
+constexpr uint16_t kOpMask = 0xC000;
+constexpr uint16_t kCountMask = 0x3FFF;
+constexpr uint16_t kOpLiteral = 0x0000;
+constexpr uint16_t kOpFill = 0x4000;
+constexpr uint16_t kOpSkip = 0x8000;
+
+constexpr uint32_t kMinDelayMs = 10;
+
+struct RectHeader {
+    uint16_t x, y, w, h;
+    uint32_t size;
+};
+static_assert(sizeof(RectHeader) == 12, "RectHeader must match the file layout");
+
+template <typename T>
+T Read(const uint8_t* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+bool LvglRleAnimation::IsRleAnimation(const void* data, size_t size) {
+    return data != nullptr && size >= kHeaderSize && memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+LvglRleAnimation::LvglRleAnimation(const lv_img_dsc_t* img_dsc) {
+    memset(&img_dsc_, 0, sizeof(img_dsc_));
+    if (!img_dsc || !IsRleAnimation(img_dsc->data, img_dsc->data_size)) {
+        ESP_LOGE(TAG, "Invalid animation data");
+        return;
+    }
+
+    data_ = img_dsc->data;
+    data_size_ = img_dsc->data_size;
+    if (Read<uint16_t>(data_ + 4) != kVersion) {
+        ESP_LOGE(TAG, "Unsupported animation version %u", Read<uint16_t>(data_ + 4));
+        return;
+    }
+    width_ = Read<uint16_t>(data_ + 8);
+    height_ = Read<uint16_t>(data_ + 10);
+    frame_count_ = Read<uint16_t>(data_ + 12);
+    loop_count_ = Read<uint16_t>(data_ + 14);
+    uint32_t table_offset = Read<uint32_t>(data_ + 16);
+    has_loop_entry_ = (Read<uint32_t>(data_ + 20) & kFlagLoopEntry) != 0;
+
+    size_t entries = frame_count_ + (has_loop_entry_ ? 1 : 0);
+    if (width_ == 0 || height_ == 0 || frame_count_ == 0 || (table_offset & 3) != 0 ||
+        table_offset > data_size_ || entries * sizeof(FrameEntry) > data_size_ - table_offset) {
+        ESP_LOGE(TAG, "Corrupt animation header");
+        return;
+    }
+
+    // Tables and payloads are read in place. The converter aligns them
+    // relative to the file start and build_default_assets.py aligns the file,
+    // as 16/32-bit loads from mapped flash must be aligned
+    if (reinterpret_cast<uintptr_t>(data_) & 3) {
+        ESP_LOGE(TAG, "Animation data at %p is not 4-byte aligned", data_);
+        return;
+    }
+    frames_ = reinterpret_cast<const FrameEntry*>(data_ + table_offset);
+
+    if (!Validate()) {
+        ESP_LOGE(TAG, "Corrupt animation frame data");
+        return;
+    }
+
+    size_t buffer_size = (size_t)width_ * height_ * sizeof(uint16_t);
+    buffer_ = (uint16_t*)heap_caps_malloc(buffer_size, MALLOC_CAP_SPIRAM);
+    if (buffer_ == nullptr) {
+        buffer_ = (uint16_t*)heap_caps_malloc(buffer_size, MALLOC_CAP_8BIT);
+    }
+    if (buffer_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %ux%u frame buffer", width_, height_);
+        return;
+    }
+
+    img_dsc_.header.magic = LV_IMAGE_HEADER_MAGIC;
+    img_dsc_.header.flags = LV_IMAGE_FLAGS_MODIFIABLE;
+    img_dsc_.header.cf = LV_COLOR_FORMAT_RGB565;
+    img_dsc_.header.w = width_;
+    img_dsc_.header.h = height_;
+    img_dsc_.header.stride = width_ * sizeof(uint16_t);
+    img_dsc_.data = reinterpret_cast<const uint8_t*>(buffer_);
+    img_dsc_.data_size = buffer_size;
+
+    // Frame 0 is a full keyframe
+    ShowFrame(0, nullptr);
+    loaded_ = true;
+    ESP_LOGD(TAG, "Animation loaded: %ux%u, %u frames, %u bytes", width_, height_, frame_count_,
+             (unsigned)data_size_);
+}
+
+LvglRleAnimation::~LvglRleAnimation() {
+    Cleanup();
+}
+
+const lv_img_dsc_t* LvglRleAnimation::image_dsc() const {
+    return loaded_ ? &img_dsc_ : nullptr;
+}
+
+// Walk every frame once at load so playback can trust the data
+bool LvglRleAnimation::Validate() const {
+    size_t entries = frame_count_ + (has_loop_entry_ ? 1 : 0);
+    for (size_t i = 0; i < entries; i++) {
+        if (!ValidateFrame(frames_[i])) {
+            ESP_LOGE(TAG, "Frame %u is invalid", (unsigned)i);
+            return false;
+        }
+    }
+    // The keyframe must cover the whole image, the buffer starts uninitialised
+    if (frames_[0].rect_count != 1) {
+        return false;
+    }
+    auto key = Read<RectHeader>(data_ + frames_[0].offset);
+    return key.x == 0 && key.y == 0 && key.w == width_ && key.h == height_;
+}
+
+bool LvglRleAnimation::ValidateFrame(const FrameEntry& entry) const {
+    if ((entry.offset & 3) != 0 || entry.offset > data_size_ ||
+        (size_t)entry.rect_count * sizeof(RectHeader) > data_size_ - entry.offset) {
+        return false;
+    }
+    const uint8_t* rect_ptr = data_ + entry.offset;
+    size_t payload_offset = entry.offset + entry.rect_count * sizeof(RectHeader);
+
+    for (int r = 0; r < entry.rect_count; r++, rect_ptr += sizeof(RectHeader)) {
+        auto rect = Read<RectHeader>(rect_ptr);
+        if (rect.w == 0 || rect.h == 0 || rect.x + rect.w > width_ || rect.y + rect.h > height_ ||
+            (rect.size & 1) != 0 || rect.size > data_size_ - payload_offset) {
+            return false;
+        }
+        const uint16_t* op = reinterpret_cast<const uint16_t*>(data_ + payload_offset);
+        const uint16_t* end = op + rect.size / 2;
+        for (int y = 0; y < rect.h; y++) {
+            int x = 0;
+            while (x < rect.w) {
+                if (op >= end) {
+                    return false;
+                }
+                uint16_t code = *op++;
+                int count = code & kCountMask;
+                if (count == 0 || x + count > rect.w) {
+                    return false;
+                }
+                switch (code & kOpMask) {
+                case kOpLiteral:
+                    op += count;
+                    break;
+                case kOpFill:
+                    op += 1;
+                    break;
+                case kOpSkip:
+                    break;
+                default:
+                    return false;
+                }
+                if (op > end) {
+                    return false;
+                }
+                x += count;
+            }
+        }
+        if (op != end) {
+            return false;
+        }
+        payload_offset += rect.size;
+    }
+    return true;
+}
+
+void LvglRleAnimation::ShowFrame(int index, lv_area_t* dirty) {
+    const FrameEntry& entry = frames_[index];
+    const uint8_t* rect_ptr = data_ + entry.offset;
+    const uint16_t* op = reinterpret_cast<const uint16_t*>(rect_ptr + entry.rect_count * sizeof(RectHeader));
+
+    if (dirty) {
+        dirty->x1 = width_;
+        dirty->y1 = height_;
+        dirty->x2 = -1;
+        dirty->y2 = -1;
+    }
+
+    for (int r = 0; r < entry.rect_count; r++, rect_ptr += sizeof(RectHeader)) {
+        auto rect = Read<RectHeader>(rect_ptr);
+        uint16_t* row = buffer_ + (size_t)rect.y * width_ + rect.x;
+        for (int y = 0; y < rect.h; y++, row += width_) {
+            uint16_t* dst = row;
+            uint16_t* row_end = row + rect.w;
+            while (dst < row_end) {
+                uint16_t code = *op++;
+                int count = code & kCountMask;
+                switch (code & kOpMask) {
+                case kOpLiteral:
+                    memcpy(dst, op, count * sizeof(uint16_t));
+                    op += count;
+                    break;
+                case kOpFill: {
+                    uint16_t color = *op++;
+                    for (int i = 0; i < count; i++) {
+                        dst[i] = color;
+                    }
+                    break;
+                }
+                default:  // kOpSkip
+                    break;
+                }
+                dst += count;
+            }
+        }
+
+        if (dirty) {
+            dirty->x1 = LV_MIN(dirty->x1, rect.x);
+            dirty->y1 = LV_MIN(dirty->y1, rect.y);
+            dirty->x2 = LV_MAX(dirty->x2, rect.x + rect.w - 1);
+            dirty->y2 = LV_MAX(dirty->y2, rect.y + rect.h - 1);
+        }
+    }
+    current_ = index;
+}
+
+void LvglRleAnimation::Start() {
+    if (!loaded_) {
+        ESP_LOGW(TAG, "Animation not loaded, cannot start");
+        return;
+    }
+
+    if (current_ != 0) {
+        Stop();
+    }
+    loops_done_ = 0;
+    if (frame_count_ < 2) {
+        return;
+    }
+
+    // The timer period follows the current frame's delay instead of polling
+    if (!timer_) {
+        timer_ = lv_timer_create([](lv_timer_t* timer) {
+            auto self = static_cast<LvglRleAnimation*>(lv_timer_get_user_data(timer));
+            self->NextFrame();
+        }, kMinDelayMs, this);
+    }
+    if (timer_) {
+        playing_ = true;
+        lv_timer_set_period(timer_, LV_MAX(frames_[current_].delay_ms, kMinDelayMs));
+        lv_timer_reset(timer_);
+        lv_timer_resume(timer_);
+    }
+}
+
+void LvglRleAnimation::Pause() {
+    if (timer_) {
+        playing_ = false;
+        lv_timer_pause(timer_);
+    }
+}
+
+void LvglRleAnimation::Resume() {
+    if (!loaded_ || !timer_) {
+        return;
+    }
+    playing_ = true;
+    lv_timer_resume(timer_);
+}
+
+void LvglRleAnimation::Stop() {
+    Pause();
+    if (!loaded_ || current_ == 0) {
+        return;
+    }
+
+    lv_area_t dirty;
+    if (has_loop_entry_ && current_ == frame_count_ - 1) {
+        ShowFrame(frame_count_, &dirty);
+    } else {
+        ShowFrame(0, &dirty);
+    }
+    current_ = 0;
+    if (frame_callback_) {
+        frame_callback_(dirty);
+    }
+}
+
+void LvglRleAnimation::SetFrameCallback(std::function<void(const lv_area_t& dirty)> callback) {
+    frame_callback_ = callback;
+}
+
+void LvglRleAnimation::NextFrame() {
+    if (!playing_) {
+        return;
+    }
+
+    int next = current_ + 1;
+    if (next >= frame_count_) {
+        if (loop_count_ != 0 && ++loops_done_ >= loop_count_) {
+            Pause();
+            return;
+        }
+        next = 0;
+    }
+
+    lv_area_t dirty;
+    if (next == 0) {
+        // Delta from the last frame back to the first; without it the
+        // keyframe is redrawn in full
+        ShowFrame(has_loop_entry_ ? frame_count_ : 0, &dirty);
+        current_ = 0;
+    } else {
+        ShowFrame(next, &dirty);
+    }
+    lv_timer_set_period(timer_, LV_MAX(frames_[current_].delay_ms, kMinDelayMs));
+
+    if (frame_callback_ && dirty.x2 >= dirty.x1) {
+        frame_callback_(dirty);
+    }
+}
+
+void LvglRleAnimation::Cleanup() {
+    if (timer_) {
+        lv_timer_delete(timer_);
+        timer_ = nullptr;
+    }
+    if (buffer_) {
+        heap_caps_free(buffer_);
+        buffer_ = nullptr;
+    }
+    playing_ = false;
+    loaded_ = false;
+    memset(&img_dsc_, 0, sizeof(img_dsc_));
+}
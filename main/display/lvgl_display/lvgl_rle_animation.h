@@ -0,0 +1,75 @@
+#pragma once
+
+#include "lvgl_image.h"
+#include <lvgl.h>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Player for pre-rendered RLE565 animations (.anim, see
+ * scripts/Image_Converter/gif_to_anim.py).
+ *
+ * Frames are stored as run-length encoded RGB565 deltas with dirty rects, so
+ * playback only copies the changed pixels from the (memory-mapped) source
+ * into one RGB565 frame buffer: no LZW, palette or disposal work at runtime,
+ * and 2 bytes per pixel instead of the 5 a GIF decoder needs. The source data
+ * must stay valid for the lifetime of the player.
+ *
+ * The frame callback receives the area that changed, in image coordinates,
+ * so the caller can invalidate just that part of the widget.
+ */
+class LvglRleAnimation : public LvglImage {
+public:
+    explicit LvglRleAnimation(const lv_img_dsc_t* img_dsc);
+    virtual ~LvglRleAnimation();
+
+    // Check for the .anim magic
+    static bool IsRleAnimation(const void* data, size_t size);
+
+    virtual const lv_img_dsc_t* image_dsc() const override;
+
+    void Start();
+    void Pause();
+    void Resume();
+    // Pause and show the first frame again
+    void Stop();
+
+    bool IsPlaying() const { return playing_; }
+    bool IsLoaded() const { return loaded_; }
+    uint16_t width() const { return width_; }
+    uint16_t height() const { return height_; }
+
+    void SetFrameCallback(std::function<void(const lv_area_t& dirty)> callback);
+
+private:
+    struct FrameEntry {
+        uint32_t offset;
+        uint16_t delay_ms;
+        uint16_t rect_count;
+    };
+
+    bool Validate() const;
+    bool ValidateFrame(const FrameEntry& entry) const;
+    void ShowFrame(int index, lv_area_t* dirty);
+    void NextFrame();
+    void Cleanup();
+
+    const uint8_t* data_ = nullptr;
+    size_t data_size_ = 0;
+    const FrameEntry* frames_ = nullptr;
+    uint16_t width_ = 0;
+    uint16_t height_ = 0;
+    uint16_t frame_count_ = 0;
+    uint16_t loop_count_ = 0;   // 0 = forever
+    bool has_loop_entry_ = false;
+
+    uint16_t* buffer_ = nullptr;
+    lv_img_dsc_t img_dsc_;
+    lv_timer_t* timer_ = nullptr;
+    int current_ = 0;
+    uint16_t loops_done_ = 0;
+    bool playing_ = false;
+    bool loaded_ = false;
+
+    std::function<void(const lv_area_t& dirty)> frame_callback_;
+};
@@ -0,0 +1,459 @@
+#include "spectrum_analyzer.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define TAG "SpectrumAnalyzer"
+
+// Levels below this (relative to a full-scale sine) are treated as silence
+static constexpr float kSilencePower = 1e-6f;
+
+static constexpr uint16_t kColorRed = 0xF800;
+static constexpr uint16_t kColorYellow = 0xFFE0;
+static constexpr uint16_t kColorGreen = 0x07E0;
+static constexpr uint16_t kColorBlack = 0x0000;
+
+template <typename T>
+static T* AllocTable(size_t count) {
+    void* ptr = heap_caps_malloc(count * sizeof(T), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == nullptr) {
+        ptr = heap_caps_malloc(count * sizeof(T), MALLOC_CAP_8BIT);
+    }
+    if (ptr != nullptr) {
+        memset(ptr, 0, count * sizeof(T));
+    }
+    return static_cast<T*>(ptr);
+}
+
+template <typename T>
+static void FreeTable(T*& ptr) {
+    if (ptr != nullptr) {
+        heap_caps_free(ptr);
+        ptr = nullptr;
+    }
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(const Config& config) : config_(config) {
+    int size = 16;
+    while (size < config_.fft_size && size < 1024) {
+        size <<= 1;
+    }
+    config_.fft_size = size;
+    half_ = size / 2;
+    while ((1 << log2_half_) < half_) {
+        log2_half_++;
+    }
+    // Every bar needs at least one bin above DC
+    config_.bars = std::max(1, std::min(config_.bars, half_ - 1));
+    if (config_.min_db >= 0) {
+        config_.min_db = -25.0f;
+    }
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    FreeBuffers();
+}
+
+void SpectrumAnalyzer::FreeBuffers() {
+    FreeTable(window_f_);
+    FreeTable(cos_f_);
+    FreeTable(sin_f_);
+    FreeTable(split_cos_f_);
+    FreeTable(split_sin_f_);
+    FreeTable(re_f_);
+    FreeTable(im_f_);
+    FreeTable(window_q15_);
+    FreeTable(cos_q15_);
+    FreeTable(sin_q15_);
+    FreeTable(split_cos_q15_);
+    FreeTable(split_sin_q15_);
+    FreeTable(re_q_);
+    FreeTable(im_q_);
+    FreeTable(bit_reverse_);
+    FreeTable(power_);
+    FreeTable(bar_start_);
+    FreeTable(bar_gain_);
+    FreeTable(bar_power_);
+    FreeTable(levels_);
+    FreeTable(painted_);
+}
+
+bool SpectrumAnalyzer::Initialize() {
+    if (initialized()) {
+        return true;
+    }
+
+    const int n = config_.fft_size;
+    const int bars = config_.bars;
+    bit_reverse_ = AllocTable<uint16_t>(half_);
+    power_ = AllocTable<float>(half_);
+    bar_start_ = AllocTable<uint16_t>(bars + 1);
+    bar_gain_ = AllocTable<float>(bars);
+    bar_power_ = AllocTable<float>(bars);
+    levels_ = AllocTable<float>(bars);
+    painted_ = AllocTable<int>(bars);
+
+    bool ok = bit_reverse_ && power_ && bar_start_ && bar_gain_ && bar_power_ && levels_ && painted_;
+    if (config_.fixed_point) {
+        window_q15_ = AllocTable<int16_t>(n);
+        cos_q15_ = AllocTable<int16_t>(half_ / 2);
+        sin_q15_ = AllocTable<int16_t>(half_ / 2);
+        split_cos_q15_ = AllocTable<int16_t>(half_);
+        split_sin_q15_ = AllocTable<int16_t>(half_);
+        re_q_ = AllocTable<int32_t>(half_);
+        im_q_ = AllocTable<int32_t>(half_);
+        ok = ok && window_q15_ && cos_q15_ && sin_q15_ && split_cos_q15_ && split_sin_q15_ && re_q_ && im_q_;
+    } else {
+        window_f_ = AllocTable<float>(n);
+        cos_f_ = AllocTable<float>(half_ / 2);
+        sin_f_ = AllocTable<float>(half_ / 2);
+        split_cos_f_ = AllocTable<float>(half_);
+        split_sin_f_ = AllocTable<float>(half_);
+        re_f_ = AllocTable<float>(half_);
+        im_f_ = AllocTable<float>(half_);
+        ok = ok && window_f_ && cos_f_ && sin_f_ && split_cos_f_ && split_sin_f_ && re_f_ && im_f_;
+    }
+
+    if (!ok) {
+        ESP_LOGE(TAG, "Failed to allocate spectrum tables");
+        // Free everything so initialized() stays false and a retry starts clean
+        FreeBuffers();
+        return false;
+    }
+
+    BuildTables();
+    window_start_us_ = esp_timer_get_time();
+    ESP_LOGI(TAG, "Initialized: %d-point %s real FFT, %d log-spaced bars",
+             n, config_.fixed_point ? "Q15" : "float", bars);
+    return true;
+}
+
+void SpectrumAnalyzer::BuildTables() {
+    const int n = config_.fft_size;
+    const int bars = config_.bars;
+
+    for (int i = 0; i < half_; i++) {
+        int reversed = 0;
+        for (int b = 0; b < log2_half_; b++) {
+            if (i & (1 << b)) {
+                reversed |= 1 << (log2_half_ - 1 - b);
+            }
+        }
+        bit_reverse_[i] = reversed;
+    }
+
+    for (int i = 0; i < n; i++) {
+        float w = 0.5f * (1.0f - cosf(2.0f * M_PI * i / (n - 1)));
+        if (config_.fixed_point) {
+            window_q15_[i] = (int16_t)lrintf(w * 32767.0f);
+        } else {
+            window_f_[i] = w;
+        }
+    }
+    for (int i = 0; i < half_ / 2; i++) {
+        float angle = 2.0f * M_PI * i / half_;
+        if (config_.fixed_point) {
+            cos_q15_[i] = (int16_t)lrintf(cosf(angle) * 32767.0f);
+            sin_q15_[i] = (int16_t)lrintf(sinf(angle) * 32767.0f);
+        } else {
+            cos_f_[i] = cosf(angle);
+            sin_f_[i] = sinf(angle);
+        }
+    }
+    for (int i = 0; i < half_; i++) {
+        float angle = 2.0f * M_PI * i / n;
+        if (config_.fixed_point) {
+            split_cos_q15_[i] = (int16_t)lrintf(cosf(angle) * 32767.0f);
+            split_sin_q15_[i] = (int16_t)lrintf(sinf(angle) * 32767.0f);
+        } else {
+            split_cos_f_[i] = cosf(angle);
+            split_sin_f_[i] = sinf(angle);
+        }
+    }
+
+    // Log-spaced bin edges from bin 1 (skip DC) to Nyquist, at least one bin per bar
+    const float lo = 1.0f;
+    const float hi = (float)half_;
+    bar_start_[0] = 1;
+    for (int i = 1; i <= bars; i++) {
+        int edge = (int)lrintf(lo * powf(hi / lo, (float)i / bars));
+        int min_edge = bar_start_[i - 1] + 1;
+        int max_edge = half_ - (bars - i);
+        bar_start_[i] = std::min(std::max(edge, min_edge), max_edge);
+    }
+    bar_start_[bars] = half_;
+
+    // Spectral tilt so a typical mix does not leave the treble bars empty
+    float first_center = sqrtf((float)bar_start_[0] * bar_start_[1]);
+    for (int i = 0; i < bars; i++) {
+        float center = sqrtf((float)bar_start_[i] * bar_start_[i + 1]);
+        float octaves = log2f(center / first_center);
+        bar_gain_[i] = powf(10.0f, config_.tilt_db_per_octave * octaves / 10.0f);
+    }
+}
+
+void SpectrumAnalyzer::Process(const int16_t* pcm, size_t samples) {
+    if (!initialized() || pcm == nullptr) {
+        return;
+    }
+    int64_t start_us = esp_timer_get_time();
+
+    memset(power_, 0, half_ * sizeof(float));
+    frames_ = 0;
+    for (size_t offset = 0; offset + config_.fft_size <= samples; offset += config_.fft_size) {
+        if (config_.fixed_point) {
+            ComputePowerFixed(pcm + offset);
+        } else {
+            ComputePowerFloat(pcm + offset);
+        }
+        frames_++;
+    }
+    if (frames_ > 0) {
+        UpdateLevels();
+    }
+
+    analysis_us_ += esp_timer_get_time() - start_us;
+    analyses_++;
+}
+
+void SpectrumAnalyzer::ComputePowerFloat(const int16_t* pcm) {
+    float* re = re_f_;
+    float* im = im_f_;
+
+    // Pack even/odd samples into one complex sequence, in bit-reversed order
+    const float scale = 1.0f / 32768.0f;
+    for (int i = 0; i < half_; i++) {
+        int r = bit_reverse_[i];
+        re[r] = pcm[2 * i] * window_f_[2 * i] * scale;
+        im[r] = pcm[2 * i + 1] * window_f_[2 * i + 1] * scale;
+    }
+
+    for (int size = 2, step = half_ / 2; size <= half_; size <<= 1, step >>= 1) {
+        int half_size = size >> 1;
+        for (int start = 0; start < half_; start += size) {
+            for (int k = 0; k < half_size; k++) {
+                float wr = cos_f_[k * step];
+                float wi = -sin_f_[k * step];
+                int a = start + k;
+                int b = a + half_size;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    // Split into the spectrum of the real input: X[k] = E[k] + W^k * O[k]
+    for (int k = 0; k < half_; k++) {
+        int m = (half_ - k) & (half_ - 1);
+        float er = 0.5f * (re[k] + re[m]);
+        float ei = 0.5f * (im[k] - im[m]);
+        float orr = 0.5f * (im[k] + im[m]);
+        float oi = -0.5f * (re[k] - re[m]);
+        float c = split_cos_f_[k];
+        float s = split_sin_f_[k];
+        float xr = er + c * orr + s * oi;
+        float xi = ei + c * oi - s * orr;
+        power_[k] += xr * xr + xi * xi;
+    }
+}
+
+void SpectrumAnalyzer::ComputePowerFixed(const int16_t* pcm) {
+    int32_t* re = re_q_;
+    int32_t* im = im_q_;
+
+    for (int i = 0; i < half_; i++) {
+        int r = bit_reverse_[i];
+        re[r] = ((int32_t)pcm[2 * i] * window_q15_[2 * i]) >> 15;
+        im[r] = ((int32_t)pcm[2 * i + 1] * window_q15_[2 * i + 1]) >> 15;
+    }
+
+    // Halve every stage so values stay within 16 bits (result is scaled by 1/half_)
+    for (int size = 2, step = half_ / 2; size <= half_; size <<= 1, step >>= 1) {
+        int half_size = size >> 1;
+        for (int start = 0; start < half_; start += size) {
+            for (int k = 0; k < half_size; k++) {
+                int32_t wr = cos_q15_[k * step];
+                int32_t wi = -sin_q15_[k * step];
+                int a = start + k;
+                int b = a + half_size;
+                int32_t tr = (re[b] * wr - im[b] * wi) >> 15;
+                int32_t ti = (re[b] * wi + im[b] * wr) >> 15;
+                int32_t ar = re[a];
+                int32_t ai = im[a];
+                re[b] = (ar - tr) >> 1;
+                im[b] = (ai - ti) >> 1;
+                re[a] = (ar + tr) >> 1;
+                im[a] = (ai + ti) >> 1;
+            }
+        }
+    }
+
+    // Same units as the float path: undo the 1/half_ stage scaling and Q15 input
+    const float scale = (float)half_ / 32768.0f;
+    const float power_scale = scale * scale;
+    for (int k = 0; k < half_; k++) {
+        int m = (half_ - k) & (half_ - 1);
+        int32_t er = (re[k] + re[m]) >> 1;
+        int32_t ei = (im[k] - im[m]) >> 1;
+        int32_t orr = (im[k] + im[m]) >> 1;
+        int32_t oi = -((re[k] - re[m]) >> 1);
+        int32_t c = split_cos_q15_[k];
+        int32_t s = split_sin_q15_[k];
+        int32_t xr = er + ((c * orr + s * oi) >> 15);
+        int32_t xi = ei + ((c * oi - s * orr) >> 15);
+        int64_t p = (int64_t)xr * xr + (int64_t)xi * xi;
+        power_[k] += (float)p * power_scale;
+    }
+}
+
+// 10*log10(power) from the float exponent plus a mantissa lookup table
+float SpectrumAnalyzer::PowerToDb(float power) {
+    static constexpr int kLutSize = 64;
+    static float lut[kLutSize + 1];
+    static bool lut_ready = false;
+    if (!lut_ready) {
+        for (int i = 0; i <= kLutSize; i++) {
+            lut[i] = log2f(0.5f + 0.5f * i / kLutSize);
+        }
+        lut_ready = true;
+    }
+
+    if (power <= 0) {
+        return -200.0f;
+    }
+    int exponent;
+    float mantissa = frexpf(power, &exponent);  // [0.5, 1)
+    float pos = (mantissa - 0.5f) * 2.0f * kLutSize;
+    int index = (int)pos;
+    float frac = pos - index;
+    float log2_value = exponent + lut[index] + (lut[index + 1] - lut[index]) * frac;
+    return 3.0103f * log2_value;
+}
+
+void SpectrumAnalyzer::UpdateLevels() {
+    const int bars = config_.bars;
+    float* bar_power = bar_power_;
+    float max_power = 0;
+    const float inv_frames = 1.0f / frames_;
+
+    for (int i = 0; i < bars; i++) {
+        float sum = 0;
+        for (int k = bar_start_[i]; k < bar_start_[i + 1]; k++) {
+            sum += power_[k];
+        }
+        int count = bar_start_[i + 1] - bar_start_[i];
+        bar_power[i] = sum * inv_frames / count * bar_gain_[i];
+        max_power = std::max(max_power, bar_power[i]);
+    }
+
+    for (int i = 0; i < bars; i++) {
+        float target = 0;
+        if (max_power > kSilencePower) {
+            float db = PowerToDb(bar_power[i] / max_power);
+            target = std::max(0.0f, std::min(1.0f, (db - config_.min_db) / -config_.min_db));
+        }
+        // Instant attack, slow decay
+        if (target > levels_[i]) {
+            levels_[i] = target;
+        } else {
+            levels_[i] -= (levels_[i] - target) * 0.25f;
+        }
+    }
+}
+
+bool SpectrumAnalyzer::PaintBars(uint16_t* buffer, int stride_px, int width, int height, Rect* dirty) {
+    if (!initialized() || buffer == nullptr || width <= 0 || height <= 4) {
+        return false;
+    }
+    int64_t start_us = esp_timer_get_time();
+
+    const int bars = config_.bars;
+    const int bar_width = width / bars;
+    const int max_height = height - 4;
+    const int red_from = (int)(max_height * 0.7f);
+    const int yellow_from = (int)(max_height * 0.4f);
+    const int bottom = height - 1;
+
+    bool changed = false;
+    Rect area = {width, height, -1, -1};
+    for (int i = 0; i < bars; i++) {
+        int new_height = (int)(levels_[i] * max_height + 0.5f);
+        int old_height = painted_[i];
+        if (new_height == old_height) {
+            continue;
+        }
+
+        int x1 = i * bar_width + 1;
+        int x2 = i * bar_width + bar_width - 2;
+        if (x2 < x1) {
+            x2 = x1;
+        }
+        // Rows are counted from the bottom: row d (1-based) sits at y = bottom - d + 1
+        int from = std::min(old_height, new_height) + 1;
+        int to = std::max(old_height, new_height);
+        bool grow = new_height > old_height;
+        for (int d = from; d <= to; d++) {
+            uint16_t color = kColorBlack;
+            if (grow) {
+                color = d > red_from ? kColorRed : (d > yellow_from ? kColorYellow : kColorGreen);
+            }
+            uint16_t* row = buffer + (bottom - d + 1) * stride_px;
+            std::fill(row + x1, row + x2 + 1, color);
+        }
+        rows_painted_ += to - from + 1;
+        painted_[i] = new_height;
+
+        area.x1 = std::min(area.x1, x1);
+        area.x2 = std::max(area.x2, x2);
+        area.y1 = std::min(area.y1, bottom - to + 1);
+        area.y2 = std::max(area.y2, bottom - from + 1);
+        changed = true;
+    }
+
+    paint_us_ += esp_timer_get_time() - start_us;
+    paints_++;
+    window_paints_++;
+    if (changed && dirty != nullptr) {
+        *dirty = area;
+    }
+    return changed;
+}
+
+void SpectrumAnalyzer::ResetPainted() {
+    if (painted_ != nullptr) {
+        memset(painted_, 0, config_.bars * sizeof(int));
+    }
+}
+
+void SpectrumAnalyzer::Reset() {
+    if (levels_ != nullptr) {
+        memset(levels_, 0, config_.bars * sizeof(float));
+    }
+    ResetPainted();
+}
+
+SpectrumAnalyzer::Stats SpectrumAnalyzer::GetStats() {
+    Stats stats;
+    stats.analyses = analyses_;
+    stats.paints = paints_;
+    stats.avg_analysis_us = analyses_ ? (uint32_t)(analysis_us_ / analyses_) : 0;
+    stats.avg_paint_us = paints_ ? (uint32_t)(paint_us_ / paints_) : 0;
+    stats.rows_painted = rows_painted_;
+
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed_us = now - window_start_us_;
+    stats.fps = elapsed_us > 0 ? window_paints_ * 1e6f / elapsed_us : 0;
+    window_paints_ = 0;
+    rows_painted_ = 0;
+    window_start_us_ = now;
+    return stats;
+}
@@ -0,0 +1,120 @@
+#ifndef SPECTRUM_ANALYZER_H
+#define SPECTRUM_ANALYZER_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Audio spectrum analyser for music visualisers.
+ *
+ * A real FFT (N real samples packed into an N/2-point complex FFT plus a
+ * split step) with precomputed Hann window, twiddle and bit-reverse tables.
+ * The fixed-point (Q15) path is meant for targets without an FPU. Bins are
+ * grouped into log-spaced bars through a precomputed table and converted to
+ * dB with a lookup instead of log10f.
+ *
+ * The class has no LVGL dependency: any Display can feed PCM, read the bar
+ * levels, or let PaintBars() draw only the changed rows into an RGB565 buffer.
+ */
+class SpectrumAnalyzer {
+public:
+    struct Config {
+        int fft_size = 256;        // Power of two, 16..1024
+        int bars = 16;
+        bool fixed_point = false;  // Q15 FFT instead of float
+        float min_db = -25.0f;     // Level 0 of a bar
+        float tilt_db_per_octave = 3.0f;  // Lifts treble bars, music energy falls with frequency
+    };
+
+    struct Rect {
+        int x1, y1, x2, y2;  // Inclusive
+    };
+
+    struct Stats {
+        uint32_t analyses = 0;
+        uint32_t paints = 0;
+        uint32_t avg_analysis_us = 0;
+        uint32_t avg_paint_us = 0;
+        uint32_t rows_painted = 0;  // Since the last GetStats()
+        float fps = 0;              // Paints per second since the last GetStats()
+    };
+
+    explicit SpectrumAnalyzer(const Config& config);
+    SpectrumAnalyzer() : SpectrumAnalyzer(Config()) {}
+    ~SpectrumAnalyzer();
+    SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+
+    // Allocates tables and work buffers (PSRAM preferred); false on OOM
+    bool Initialize();
+    bool initialized() const { return window_f_ != nullptr || window_q15_ != nullptr; }
+
+    // Averages the power spectrum of every full FFT window in `pcm` and
+    // updates the bar levels
+    void Process(const int16_t* pcm, size_t samples);
+
+    // Smoothed bar levels in 0..1
+    int bars() const { return config_.bars; }
+    const float* levels() const { return levels_; }
+
+    // Paint bar deltas into an RGB565 buffer of `width` x `height` pixels.
+    // The buffer must hold what the previous call painted (or be black after
+    // ResetPainted()). Returns false if nothing changed, else the dirty area.
+    bool PaintBars(uint16_t* buffer, int stride_px, int width, int height, Rect* dirty);
+    void ResetPainted();
+    void Reset();
+
+    Stats GetStats();
+
+private:
+    void FreeBuffers();
+    void BuildTables();
+    void ComputePowerFloat(const int16_t* pcm);
+    void ComputePowerFixed(const int16_t* pcm);
+    void UpdateLevels();
+    static float PowerToDb(float power);
+
+    Config config_;
+    int half_ = 0;      // Complex FFT size (fft_size / 2)
+    int log2_half_ = 0;
+
+    // Float path
+    float* window_f_ = nullptr;
+    float* cos_f_ = nullptr;      // Complex FFT twiddles, half_/2 entries
+    float* sin_f_ = nullptr;
+    float* split_cos_f_ = nullptr;  // Real split twiddles, half_ entries
+    float* split_sin_f_ = nullptr;
+    float* re_f_ = nullptr;
+    float* im_f_ = nullptr;
+
+    // Q15 path
+    int16_t* window_q15_ = nullptr;
+    int16_t* cos_q15_ = nullptr;
+    int16_t* sin_q15_ = nullptr;
+    int16_t* split_cos_q15_ = nullptr;
+    int16_t* split_sin_q15_ = nullptr;
+    int32_t* re_q_ = nullptr;
+    int32_t* im_q_ = nullptr;
+
+    uint16_t* bit_reverse_ = nullptr;
+    float* power_ = nullptr;      // fft_size / 2 bins
+    int frames_ = 0;              // Windows accumulated in power_
+
+    // Log-spaced bar mapping
+    uint16_t* bar_start_ = nullptr;  // bars + 1 bin edges
+    float* bar_gain_ = nullptr;
+    float* bar_power_ = nullptr;     // Scratch for UpdateLevels()
+    float* levels_ = nullptr;
+    int* painted_ = nullptr;         // Bar heights currently in the paint buffer
+
+    // Stats
+    int64_t analysis_us_ = 0;
+    int64_t paint_us_ = 0;
+    uint32_t analyses_ = 0;
+    uint32_t paints_ = 0;
+    uint32_t rows_painted_ = 0;
+    uint32_t window_paints_ = 0;
+    int64_t window_start_us_ = 0;
+};
+
+#endif // SPECTRUM_ANALYZER_H
@@ -1,88 +1,400 @@
 #include "settings.h"
 
 #include <esp_log.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <nvs_flash.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #define TAG "Settings"
 
-Settings::Settings(const std::string& ns, bool read_write) : ns_(ns), read_write_(read_write) {
-    nvs_open(ns.c_str(), read_write_ ? NVS_READWRITE : NVS_READONLY, &nvs_handle_);
-}
+namespace {
+
+enum class ValueType : uint8_t {
+    kInt32,
+    kUint8,
+    kString,
+};
+
+struct Entry {
+    ValueType type = ValueType::kInt32;
+    bool present = false;   // false 表示 NVS 中没有这个键（或等待删除）
+    bool dirty = false;     // 尚未提交到 flash
+    int32_t int_value = 0;
+    std::string str_value;
 
-Settings::~Settings() {
-    if (nvs_handle_ != 0) {
-        if (read_write_ && dirty_) {
-            ESP_ERROR_CHECK(nvs_commit(nvs_handle_));
+    bool SameValue(const Entry& other) const {
+        if (present != other.present) {
+            return false;
         }
-        nvs_close(nvs_handle_);
+        if (!present) {
+            return true;
+        }
+        if (type != other.type) {
+            return false;
+        }
+        return type == ValueType::kString ? str_value == other.str_value : int_value == other.int_value;
     }
-}
+};
 
-std::string Settings::GetString(const std::string& key, const std::string& default_value) {
-    if (nvs_handle_ == 0) {
-        return default_value;
+struct ListenerEntry {
+    int id;
+    std::string ns;
+    std::string key;
+    Settings::Listener listener;
+};
+
+class SettingsStore {
+public:
+    static SettingsStore& GetInstance() {
+        static SettingsStore instance;
+        return instance;
     }
 
-    size_t length = 0;
-    if (nvs_get_str(nvs_handle_, key.c_str(), nullptr, &length) != ESP_OK) {
-        return default_value;
+    bool Get(const std::string& ns, const std::string& key, ValueType type, Entry* value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entries = cache_[ns];
+        auto it = entries.find(key);
+        // 缓存的“不存在”只对同类型有效：同名键可能以另一种类型存在 NVS 中
+        if (it != entries.end() && (it->second.type == type || it->second.present || it->second.dirty)) {
+            stats_.cache_hits++;
+        } else {
+            Entry loaded = ReadNvs(ns, key, type);
+            it = entries.insert_or_assign(key, std::move(loaded)).first;
+        }
+        if (!it->second.present || it->second.type != type) {
+            return false;
+        }
+        *value = it->second;
+        return true;
+    }
+
+    // value.present 为 false 时删除该键
+    void Set(const std::string& ns, const std::string& key, Entry value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.writes++;
+            auto& entries = cache_[ns];
+            auto it = entries.find(key);
+            if (it != entries.end() && it->second.SameValue(value)) {
+                stats_.skipped_writes++;
+                return;
+            }
+            value.dirty = true;
+            entries.insert_or_assign(key, std::move(value));
+            ScheduleFlush();
+        }
+        Notify(ns, key);
+    }
+
+    void EraseAll(const std::string& ns) {
+        {
+            // 直接擦除：同时持有两把锁，期间既不会提交旧值，也不会从 NVS 读到旧值
+            std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.writes++;
+            cache_[ns].clear();
+            nvs_handle_t nvs_handle;
+            esp_err_t err = nvs_open(ns.c_str(), NVS_READWRITE, &nvs_handle);
+            if (err == ESP_OK) {
+                err = nvs_erase_all(nvs_handle);
+                if (err == ESP_OK) {
+                    err = nvs_commit(nvs_handle);
+                    stats_.commits++;
+                }
+                nvs_close(nvs_handle);
+            }
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to erase namespace %s: %s", ns.c_str(), esp_err_to_name(err));
+            }
+        }
+        Notify(ns, "");
+    }
+
+    void Flush() {
+        std::lock_guard<std::mutex> flush_lock(flush_mutex_);
+        std::vector<std::pair<std::string, std::vector<std::pair<std::string, Entry>>>> batches;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_pending_ = false;
+            for (auto& [ns, entries] : cache_) {
+                std::vector<std::pair<std::string, Entry>> batch;
+                for (auto& [key, entry] : entries) {
+                    if (entry.dirty) {
+                        batch.emplace_back(key, entry);
+                        entry.dirty = false;
+                    }
+                }
+                if (!batch.empty()) {
+                    batches.emplace_back(ns, std::move(batch));
+                }
+            }
+        }
+        if (batches.empty()) {
+            return;
+        }
+
+        int64_t start_us = esp_timer_get_time();
+        uint32_t keys_written = 0;
+        uint32_t commits = 0;
+        // 写入失败的键：之后重新标记为 dirty 再试，否则重启后修改就丢了
+        std::vector<std::pair<std::string, std::pair<std::string, Entry>>> failed;
+        for (auto& [ns, batch] : batches) {
+            nvs_handle_t nvs_handle;
+            esp_err_t err = nvs_open(ns.c_str(), NVS_READWRITE, &nvs_handle);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Failed to open namespace %s: %s", ns.c_str(), esp_err_to_name(err));
+                for (auto& item : batch) {
+                    failed.emplace_back(ns, std::move(item));
+                }
+                continue;
+            }
+            std::vector<std::pair<std::string, Entry>> written;
+            for (auto& item : batch) {
+                err = WriteNvs(nvs_handle, item.first, item.second);
+                if (err == ESP_OK) {
+                    written.push_back(std::move(item));
+                } else {
+                    ESP_LOGE(TAG, "Failed to write %s/%s: %s", ns.c_str(), item.first.c_str(), esp_err_to_name(err));
+                    failed.emplace_back(ns, std::move(item));
+                }
+            }
+            err = nvs_commit(nvs_handle);
+            if (err == ESP_OK) {
+                commits++;
+                keys_written += written.size();
+            } else {
+                ESP_LOGE(TAG, "Failed to commit namespace %s: %s", ns.c_str(), esp_err_to_name(err));
+                for (auto& item : written) {
+                    failed.emplace_back(ns, std::move(item));
+                }
+            }
+            nvs_close(nvs_handle);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.keys_written += keys_written;
+        stats_.commits += commits;
+        if (!failed.empty()) {
+            uint32_t retried = 0;
+            for (auto& [ns, item] : failed) {
+                // 期间被改过（已是 dirty）或被擦除的键不用恢复
+                auto& entries = cache_[ns];
+                auto it = entries.find(item.first);
+                if (it != entries.end() && !it->second.dirty && it->second.SameValue(item.second)) {
+                    it->second.dirty = true;
+                    retried++;
+                }
+            }
+            if (retried > 0) {
+                ESP_LOGW(TAG, "Retrying %lu keys later", (unsigned long)retried);
+                ScheduleFlush();
+            }
+        }
+        ESP_LOGI(TAG, "Committed %lu keys in %lu namespaces (%lldms), total writes %lu, skipped %lu, commits %lu",
+                 (unsigned long)keys_written, (unsigned long)batches.size(),
+                 (long long)((esp_timer_get_time() - start_us) / 1000), (unsigned long)stats_.writes,
+                 (unsigned long)stats_.skipped_writes, (unsigned long)stats_.commits);
+    }
+
+    int AddListener(const std::string& ns, const std::string& key, Settings::Listener listener) {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        int id = next_listener_id_++;
+        listeners_.push_back({id, ns, key, std::move(listener)});
+        return id;
+    }
+
+    void RemoveListener(int id) {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                        [id](const ListenerEntry& entry) { return entry.id == id; }),
+                         listeners_.end());
+    }
+
+    SettingsStats GetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    std::mutex mutex_;          // 保护 cache_、stats_、flush_pending_
+    std::mutex flush_mutex_;    // 串行化写 flash；加锁顺序：flush_mutex_ -> mutex_
+    std::map<std::string, std::map<std::string, Entry>> cache_;
+    SettingsStats stats_;
+    TaskHandle_t flush_task_ = nullptr;
+    bool flush_pending_ = false;
+
+    std::mutex listener_mutex_;
+    std::vector<ListenerEntry> listeners_;
+    int next_listener_id_ = 1;
+
+    // 调用时已持有 mutex_
+    Entry ReadNvs(const std::string& ns, const std::string& key, ValueType type) {
+        int64_t start_us = esp_timer_get_time();
+        Entry entry;
+        entry.type = type;
+        nvs_handle_t nvs_handle;
+        if (nvs_open(ns.c_str(), NVS_READONLY, &nvs_handle) == ESP_OK) {
+            switch (type) {
+            case ValueType::kInt32:
+                entry.present = nvs_get_i32(nvs_handle, key.c_str(), &entry.int_value) == ESP_OK;
+                break;
+            case ValueType::kUint8: {
+                uint8_t value = 0;
+                entry.present = nvs_get_u8(nvs_handle, key.c_str(), &value) == ESP_OK;
+                entry.int_value = value;
+                break;
+            }
+            case ValueType::kString: {
+                size_t length = 0;
+                if (nvs_get_str(nvs_handle, key.c_str(), nullptr, &length) == ESP_OK) {
+                    entry.str_value.resize(length);
+                    entry.present = nvs_get_str(nvs_handle, key.c_str(), entry.str_value.data(), &length) == ESP_OK;
+                    while (!entry.str_value.empty() && entry.str_value.back() == '\0') {
+                        entry.str_value.pop_back();
+                    }
+                }
+                break;
+            }
+            }
+            nvs_close(nvs_handle);
+        }
+
+        uint32_t elapsed_us = esp_timer_get_time() - start_us;
+        stats_.nvs_reads++;
+        stats_.nvs_read_us += elapsed_us;
+        stats_.nvs_read_max_us = std::max(stats_.nvs_read_max_us, elapsed_us);
+        return entry;
+    }
+
+    static esp_err_t WriteNvs(nvs_handle_t nvs_handle, const std::string& key, const Entry& entry) {
+        if (!entry.present) {
+            esp_err_t err = nvs_erase_key(nvs_handle, key.c_str());
+            return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+        }
+        switch (entry.type) {
+        case ValueType::kInt32:
+            return nvs_set_i32(nvs_handle, key.c_str(), entry.int_value);
+        case ValueType::kUint8:
+            return nvs_set_u8(nvs_handle, key.c_str(), (uint8_t)entry.int_value);
+        case ValueType::kString:
+            return nvs_set_str(nvs_handle, key.c_str(), entry.str_value.c_str());
+        }
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 调用时已持有 mutex_：第一次修改后唤醒后台任务，延迟一段时间再统一提交
+    void ScheduleFlush() {
+        if (flush_pending_) {
+            return;
+        }
+        flush_pending_ = true;
+        if (flush_task_ == nullptr) {
+            xTaskCreate(FlushTask, "settings", 4096, this, 2, &flush_task_);
+            if (flush_task_ == nullptr) {
+                // 下一次写入时重试
+                ESP_LOGE(TAG, "Failed to create settings task");
+                flush_pending_ = false;
+                return;
+            }
+            // 重启前提交未写入的修改
+            esp_register_shutdown_handler([]() { SettingsStore::GetInstance().Flush(); });
+        }
+        xTaskNotifyGive(flush_task_);
     }
 
-    std::string value;
-    value.resize(length);
-    ESP_ERROR_CHECK(nvs_get_str(nvs_handle_, key.c_str(), value.data(), &length));
-    while (!value.empty() && value.back() == '\0') {
-        value.pop_back();
+    static void FlushTask(void* arg) {
+        auto* store = static_cast<SettingsStore*>(arg);
+        while (true) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_SETTINGS_COMMIT_DELAY_MS));
+            store->Flush();
+        }
+    }
+
+    void Notify(const std::string& ns, const std::string& key) {
+        std::vector<Settings::Listener> targets;
+        {
+            std::lock_guard<std::mutex> lock(listener_mutex_);
+            for (auto& entry : listeners_) {
+                if (entry.ns == ns && (entry.key.empty() || key.empty() || entry.key == key)) {
+                    targets.push_back(entry.listener);
+                }
+            }
+        }
+        for (auto& listener : targets) {
+            listener(ns, key);
+        }
+    }
+};
+
+}  // namespace
+
+Settings::Settings(const std::string& ns, bool read_write) : ns_(ns), read_write_(read_write) {
+}
+
+std::string Settings::GetString(const std::string& key, const std::string& default_value) {
+    Entry entry;
+    if (!SettingsStore::GetInstance().Get(ns_, key, ValueType::kString, &entry)) {
+        return default_value;
     }
-    return value;
+    return entry.str_value;
 }
 
 void Settings::SetString(const std::string& key, const std::string& value) {
     if (read_write_) {
-        ESP_ERROR_CHECK(nvs_set_str(nvs_handle_, key.c_str(), value.c_str()));
-        dirty_ = true;
+        Entry entry;
+        entry.type = ValueType::kString;
+        entry.present = true;
+        entry.str_value = value;
+        SettingsStore::GetInstance().Set(ns_, key, std::move(entry));
     } else {
         ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
     }
 }
 
 int32_t Settings::GetInt(const std::string& key, int32_t default_value) {
-    if (nvs_handle_ == 0) {
-        return default_value;
-    }
-
-    int32_t value;
-    if (nvs_get_i32(nvs_handle_, key.c_str(), &value) != ESP_OK) {
+    Entry entry;
+    if (!SettingsStore::GetInstance().Get(ns_, key, ValueType::kInt32, &entry)) {
         return default_value;
     }
-    return value;
+    return entry.int_value;
 }
 
 void Settings::SetInt(const std::string& key, int32_t value) {
     if (read_write_) {
-        ESP_ERROR_CHECK(nvs_set_i32(nvs_handle_, key.c_str(), value));
-        dirty_ = true;
+        Entry entry;
+        entry.type = ValueType::kInt32;
+        entry.present = true;
+        entry.int_value = value;
+        SettingsStore::GetInstance().Set(ns_, key, std::move(entry));
     } else {
         ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
     }
 }
 
 bool Settings::GetBool(const std::string& key, bool default_value) {
-    if (nvs_handle_ == 0) {
-        return default_value;
-    }
-
-    uint8_t value;
-    if (nvs_get_u8(nvs_handle_, key.c_str(), &value) != ESP_OK) {
+    Entry entry;
+    if (!SettingsStore::GetInstance().Get(ns_, key, ValueType::kUint8, &entry)) {
         return default_value;
     }
-    return value != 0;
+    return entry.int_value != 0;
 }
 
 void Settings::SetBool(const std::string& key, bool value) {
     if (read_write_) {
-        ESP_ERROR_CHECK(nvs_set_u8(nvs_handle_, key.c_str(), value ? 1 : 0));
-        dirty_ = true;
+        Entry entry;
+        entry.type = ValueType::kUint8;
+        entry.present = true;
+        entry.int_value = value ? 1 : 0;
+        SettingsStore::GetInstance().Set(ns_, key, std::move(entry));
     } else {
         ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
     }
@@ -90,10 +402,7 @@ void Settings::SetBool(const std::string& key, bool value) {
 
 void Settings::EraseKey(const std::string& key) {
     if (read_write_) {
-        auto ret = nvs_erase_key(nvs_handle_, key.c_str());
-        if (ret != ESP_ERR_NVS_NOT_FOUND) {
-            ESP_ERROR_CHECK(ret);
-        }
+        SettingsStore::GetInstance().Set(ns_, key, Entry());
     } else {
         ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
     }
@@ -101,8 +410,24 @@ void Settings::EraseKey(const std::string& key) {
 
 void Settings::EraseAll() {
     if (read_write_) {
-        ESP_ERROR_CHECK(nvs_erase_all(nvs_handle_));
+        SettingsStore::GetInstance().EraseAll(ns_);
     } else {
         ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
     }
 }
+
+int Settings::AddListener(const std::string& ns, const std::string& key, Listener listener) {
+    return SettingsStore::GetInstance().AddListener(ns, key, std::move(listener));
+}
+
+void Settings::RemoveListener(int id) {
+    SettingsStore::GetInstance().RemoveListener(id);
+}
+
+void Settings::Flush() {
+    SettingsStore::GetInstance().Flush();
+}
+
+SettingsStats Settings::GetStats() {
+    return SettingsStore::GetInstance().GetStats();
+}
@@ -2,12 +2,32 @@
 #define SETTINGS_H
 
 #include <string>
+#include <functional>
 #include <nvs_flash.h>
 
+// 进程内共享的设置缓存统计
+struct SettingsStats {
+    uint32_t cache_hits = 0;        // 直接由内存返回的读取
+    uint32_t nvs_reads = 0;         // 缓存未命中，实际读取 NVS
+    uint64_t nvs_read_us = 0;       // NVS 读取累计耗时
+    uint32_t nvs_read_max_us = 0;
+    uint32_t writes = 0;            // Set/Erase 调用次数
+    uint32_t skipped_writes = 0;    // 与缓存值相同而被忽略的写入
+    uint32_t keys_written = 0;      // 实际写入 flash 的键数
+    uint32_t commits = 0;           // nvs_commit 次数
+};
+
+/*
+ * Settings 是共享缓存的轻量视图：读取命中内存，写入先记在缓存中，
+ * 由后台任务在 CONFIG_SETTINGS_COMMIT_DELAY_MS 后按命名空间批量提交，
+ * 重启前（esp_restart）会自动提交未写入的修改。
+ * 同一个键在 NVS 中的类型保持不变：GetInt/SetInt 为 i32，GetBool/SetBool 为 u8。
+ */
 class Settings {
 public:
+    using Listener = std::function<void(const std::string& ns, const std::string& key)>;
+
     Settings(const std::string& ns, bool read_write = false);
-    ~Settings();
 
     std::string GetString(const std::string& key, const std::string& default_value = "");
     void SetString(const std::string& key, const std::string& value);
@@ -18,11 +38,16 @@ public:
     void EraseKey(const std::string& key);
     void EraseAll();
 
+    // 键值变化时在写入者的线程中回调，key 为空表示监听整个命名空间
+    static int AddListener(const std::string& ns, const std::string& key, Listener listener);
+    static void RemoveListener(int id);
+    // 立即提交所有未写入 flash 的修改
+    static void Flush();
+    static SettingsStats GetStats();
+
 private:
     std::string ns_;
-    nvs_handle_t nvs_handle_ = 0;
     bool read_write_ = false;
-    bool dirty_ = false;
 };
 
 #endif
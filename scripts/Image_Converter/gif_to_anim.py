@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""
+Convert GIF animations to the pre-rendered RLE565 animation format (.anim)
+
+GIF playback on the device runs LZW decoding, palette lookup and disposal
+compositing on every frame and needs a 5 bytes/pixel canvas. Emotion GIFs
+never change, so this script does all of that once at build time: frames are
+composited, converted to RGB565 and stored as deltas against the previous
+frame. Only the changed rectangles are stored, run-length encoded, so the
+player (LvglRleAnimation) decodes straight from the memory-mapped assets
+partition into a single RGB565 frame buffer.
+
+Usage:
+    ./gif_to_anim.py happy.gif sad.gif --output_dir out/ [--size 128x128] [--background 000000]
+
+Put the resulting .anim files into the emoji collection directory; they are
+packed into assets.bin like .png/.gif emoji.
+
+File layout (little endian, offsets from the start of the file):
+
+    Header (24 bytes)
+        char[4]  magic        "A565"
+        u16      version      1
+        u16      header_size  24
+        u16      width
+        u16      height
+        u16      frame_count
+        u16      loop_count   0 = forever
+        u32      table_offset
+        u32      flags        bit 0: table has a loop entry
+
+    Frame table, frame_count (+1 loop entry) x 8 bytes
+        u32      offset       Frame data, 4-byte aligned
+        u16      delay_ms     How long the frame stays on screen
+        u16      rect_count
+
+    Frame data
+        rect_count x { u16 x, y, w, h; u32 size }  Rect headers
+        rect_count x payload                      `size` bytes each
+
+Frame 0 is a full keyframe. The loop entry is the delta from the last frame
+back to frame 0, so wrapping around costs no more than any other frame.
+
+A payload is a sequence of u16 ops per row, each row covering exactly `w`
+pixels. The top two bits select the op and the low 14 bits hold a count:
+    00  literal  `count` RGB565 pixels follow
+    01  fill     one RGB565 pixel follows, repeated `count` times
+    10  skip     `count` pixels are unchanged from the previous frame
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+try:
+    from PIL import Image, ImageSequence
+except ImportError:
+    raise ImportError("Need Pillow package, do `pip3 install Pillow`")
+
+
+MAGIC = b"A565"
+VERSION = 1
+HEADER_SIZE = 24
+FLAG_LOOP_ENTRY = 0x1
+
+OP_LITERAL = 0x0000
+OP_FILL = 0x4000
+OP_SKIP = 0x8000
+MAX_COUNT = 0x3FFF
+
+MIN_FILL_RUN = 3    # Shorter runs are cheaper as literals
+MIN_SKIP_RUN = 4    # Shorter unchanged spans are cheaper to rewrite
+BAND_MERGE_GAP = 8  # Dirty row bands closer than this share one rect
+MAX_RECTS = 8
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def load_frames(path, size=None, background=(0, 0, 0)):
+    """Return (frames, delays_ms, loop_count, width, height), frames as flat RGB565 lists"""
+    frames = []
+    delays = []
+    width = height = 0
+    with Image.open(path) as im:
+        # No NETSCAPE extension means play once
+        loop_count = im.info.get("loop", 1)
+        for frame in ImageSequence.Iterator(im):
+            delay = frame.info.get("duration", 100) or 100
+            rgba = frame.convert("RGBA")
+            if size and rgba.size != size:
+                rgba = rgba.resize(size, Image.LANCZOS)
+            canvas = Image.new("RGBA", rgba.size, background + (255,))
+            canvas.alpha_composite(rgba)
+            rgb = canvas.convert("RGB").tobytes()
+            pixels = [rgb565(rgb[i], rgb[i + 1], rgb[i + 2]) for i in range(0, len(rgb), 3)]
+            frames.append(pixels)
+            delays.append(delay)
+            width, height = canvas.size
+    return frames, delays, loop_count, width, height
+
+
+def dedupe_frames(frames, delays):
+    """Fold identical consecutive frames into one with the summed delay"""
+    out_frames = []
+    out_delays = []
+    for pixels, delay in zip(frames, delays):
+        if out_frames and pixels == out_frames[-1]:
+            out_delays[-1] += delay
+            continue
+        out_frames.append(pixels)
+        out_delays.append(delay)
+    return out_frames, out_delays
+
+
+def dirty_rects(prev, cur, width, height):
+    """Bounding rects (x, y, w, h) of the rows that changed, grouped in bands"""
+    if prev is None:
+        return [(0, 0, width, height)]
+
+    bands = []  # [y0, y1, x0, x1] inclusive
+    for y in range(height):
+        row = y * width
+        x0 = x1 = -1
+        for x in range(width):
+            if prev[row + x] != cur[row + x]:
+                if x0 < 0:
+                    x0 = x
+                x1 = x
+        if x0 < 0:
+            continue
+        if bands and y - bands[-1][1] <= BAND_MERGE_GAP:
+            band = bands[-1]
+            band[1] = y
+            band[2] = min(band[2], x0)
+            band[3] = max(band[3], x1)
+        else:
+            bands.append([y, y, x0, x1])
+
+    # Merge the pair with the smallest gap until under the limit
+    while len(bands) > MAX_RECTS:
+        gaps = [bands[i + 1][0] - bands[i][1] for i in range(len(bands) - 1)]
+        i = gaps.index(min(gaps))
+        a, b = bands[i], bands[i + 1]
+        bands[i:i + 2] = [[a[0], b[1], min(a[2], b[2]), max(a[3], b[3])]]
+
+    return [(x0, y0, x1 - x0 + 1, y1 - y0 + 1) for y0, y1, x0, x1 in bands]
+
+
+def encode_rect(prev, cur, width, rect):
+    """RLE-encode one rect of `cur`, skipping pixels equal to `prev`"""
+    rx, ry, rw, rh = rect
+    words = []
+    for y in range(ry, ry + rh):
+        row = y * width + rx
+        x = 0
+        literal = []
+
+        def flush_literal():
+            for i in range(0, len(literal), MAX_COUNT):
+                chunk = literal[i:i + MAX_COUNT]
+                words.append(OP_LITERAL | len(chunk))
+                words.extend(chunk)
+            literal.clear()
+
+        while x < rw:
+            if prev is not None:
+                n = 0
+                while x + n < rw and prev[row + x + n] == cur[row + x + n]:
+                    n += 1
+                if n >= MIN_SKIP_RUN or (n > 0 and x + n == rw):
+                    flush_literal()
+                    while n > 0:
+                        step = min(n, MAX_COUNT)
+                        words.append(OP_SKIP | step)
+                        x += step
+                        n -= step
+                    continue
+
+            color = cur[row + x]
+            n = 1
+            while x + n < rw and cur[row + x + n] == color:
+                n += 1
+            if n >= MIN_FILL_RUN:
+                flush_literal()
+                while n > 0:
+                    step = min(n, MAX_COUNT)
+                    words.extend((OP_FILL | step, color))
+                    x += step
+                    n -= step
+                continue
+
+            literal.append(color)
+            x += 1
+        flush_literal()
+    return struct.pack(f"<{len(words)}H", *words)
+
+
+def encode_frame(prev, cur, width, height):
+    rects = dirty_rects(prev, cur, width, height)
+    headers = b""
+    payloads = b""
+    for rect in rects:
+        payload = encode_rect(prev, cur, width, rect)
+        headers += struct.pack("<4HI", *rect, len(payload))
+        payloads += payload
+    return headers + payloads, len(rects)
+
+
+def convert(path, output_path, size=None, background=(0, 0, 0), verbose=False):
+    frames, delays, loop_count, width, height = load_frames(path, size, background)
+    if not frames:
+        raise ValueError(f"{path}: no frames")
+    frames, delays = dedupe_frames(frames, delays)
+
+    # One extra entry: last frame -> first frame, used when looping
+    entries = []
+    for i, pixels in enumerate(frames):
+        prev = frames[i - 1] if i > 0 else None
+        entries.append((encode_frame(prev, pixels, width, height), delays[i]))
+    flags = 0
+    if len(frames) > 1:
+        entries.append((encode_frame(frames[-1], frames[0], width, height), delays[0]))
+        flags |= FLAG_LOOP_ENTRY
+
+    table_offset = HEADER_SIZE
+    data_offset = table_offset + 8 * len(entries)
+    table = b""
+    data = b""
+    for (blob, rect_count), delay in entries:
+        pad = (-(data_offset + len(data))) % 4
+        data += b"\0" * pad
+        table += struct.pack("<IHH", data_offset + len(data), min(delay, 0xFFFF), rect_count)
+        data += blob
+
+    header = MAGIC + struct.pack("<HHHHHHII", VERSION, HEADER_SIZE, width, height,
+                                 len(frames), loop_count, table_offset, flags)
+    with open(output_path, "wb") as f:
+        f.write(header + table + data)
+
+    raw = width * height * 2 * len(frames)
+    total = len(header) + len(table) + len(data)
+    print(f"{os.path.basename(path)} -> {os.path.basename(output_path)}: "
+          f"{width}x{height}, {len(frames)} frames, {total / 1024:.1f} KB "
+          f"({100.0 * total / raw:.1f}% of raw RGB565)")
+    if verbose:
+        for i, ((blob, rect_count), delay) in enumerate(entries):
+            name = "loop" if i == len(frames) else str(i)
+            print(f"  frame {name}: {rect_count} rects, {len(blob)} bytes, {delay} ms")
+    return total
+
+
+def parse_size(value):
+    try:
+        w, h = value.lower().split("x")
+        return int(w), int(h)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"invalid size '{value}', expected WxH")
+
+
+def parse_color(value):
+    value = value.lstrip("#")
+    if len(value) != 6:
+        raise argparse.ArgumentTypeError(f"invalid color '{value}', expected RRGGBB")
+    return tuple(int(value[i:i + 2], 16) for i in (0, 2, 4))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert GIF animations to RLE565 .anim files")
+    parser.add_argument("inputs", nargs="+", help="GIF files")
+    parser.add_argument("--output_dir", default=".", help="Output directory")
+    parser.add_argument("--size", type=parse_size, help="Resize frames to WxH")
+    parser.add_argument("--background", type=parse_color, default=(0, 0, 0),
+                        help="RRGGBB color transparent pixels are blended onto (default 000000)")
+    parser.add_argument("-v", "--verbose", action="store_true", help="Print per-frame statistics")
+    args = parser.parse_args()
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    failed = False
+    for path in args.inputs:
+        name = os.path.splitext(os.path.basename(path))[0] + ".anim"
+        try:
+            convert(path, os.path.join(args.output_dir, name), args.size, args.background, args.verbose)
+        except Exception as e:
+            print(f"Error: {path}: {e}", file=sys.stderr)
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""
+Tempo and phase lock check for the music beat tracker.
+
+Builds bench_main.cc with main/boards/common/beat_tracker.cc against the host
+mocks of scripts/otto_motion_sim and runs it over synthetic click tracks:
+decaying noise clicks over a sustained 220 Hz tone and background noise.
+
+Each case must, after the settle time:
+  - bpm:   report a tempo within --bpm-tolerance of the click track
+  - phase: put --min-hit-ratio of its beats within --phase-tolerance-ms of a click
+  - ahead: emit every beat before the audio reaching it has been decoded
+Tempo change cases are scored from change + settle on, against the new tempo.
+
+Usage:
+  python3 scripts/beat_tracker_bench/beat_tracker_bench.py
+  python3 scripts/beat_tracker_bench/beat_tracker_bench.py --verbose
+"""
+
+import argparse
+import bisect
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.abspath(os.path.join(HERE, "..", ".."))
+HOST = os.path.join(REPO, "scripts", "otto_motion_sim", "host")
+COMMON = os.path.join(REPO, "main", "boards", "common")
+
+SECONDS = 24
+SETTLE_MS = 8000
+
+# name, sample_rate, bpm, offset_ms, noise, (bpm2, change_ms) or None
+CASES = [
+    ("90bpm_44k", 44100, 90, 0, 0.02, None),
+    ("100bpm_48k", 48000, 100, 230, 0.02, None),
+    ("120bpm_44k", 44100, 120, 120, 0.02, None),
+    ("128bpm_24k", 24000, 128, 60, 0.02, None),
+    ("140bpm_16k", 16000, 140, 310, 0.02, None),
+    ("160bpm_44k", 44100, 160, 75, 0.02, None),
+    ("120bpm_noisy", 44100, 120, 400, 0.10, None),
+    ("96bpm_offbeat_start", 44100, 96, 517, 0.02, None),
+    ("100_to_130bpm", 44100, 100, 0, 0.02, (130, 8000)),
+]
+
+
+def build(workdir):
+    out = os.path.join(workdir, "beat_bench")
+    cmd = [os.environ.get("CXX", "g++"), "-std=c++17", "-O2", "-Wall", "-Wextra", "-Werror", "-I", HOST, "-I", COMMON,
+           os.path.join(HERE, "bench_main.cc"), os.path.join(COMMON, "beat_tracker.cc"),
+           os.path.join(HOST, "host_mocks.cc"), "-o", out]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit("build failed:\n" + " ".join(cmd) + "\n" + result.stderr)
+    return out
+
+
+def run_case(binary, case):
+    _, rate, bpm, offset, noise, change = case
+    cmd = [binary, str(rate), str(SECONDS), str(bpm), str(offset), str(noise)]
+    if change:
+        cmd += [str(change[0]), str(change[1])]
+    out = subprocess.run(cmd, check=True, capture_output=True, text=True).stdout
+    clicks, events, stats = [], [], {}
+    for line in out.splitlines():
+        parts = line.split()
+        if parts[0] == "C":
+            clicks.append(float(parts[1]))
+        elif parts[0] == "E":
+            events.append({"emit_ms": int(parts[1]), "beat_ms": int(parts[2]), "delay_ms": int(parts[3]),
+                           "bpm": float(parts[4]), "confidence": float(parts[5])})
+        elif parts[0] == "S":
+            stats = json.loads(line[2:])
+    return clicks, events, stats
+
+
+def nearest_error(clicks, t):
+    i = bisect.bisect_left(clicks, t)
+    candidates = [clicks[j] for j in (i - 1, i) if 0 <= j < len(clicks)]
+    return min((t - c for c in candidates), key=abs)
+
+
+def score(case, clicks, events, args):
+    _, _, bpm, _, _, change = case
+    scored_from = SETTLE_MS
+    if change:
+        bpm = change[0]
+        scored_from = change[1] + SETTLE_MS
+    # The flywheel keeps predicting past the last click; those beats have nothing to match
+    scored_to = clicks[-1] + 30000.0 / bpm
+    scored = [e for e in events if scored_from <= e["beat_ms"] <= scored_to]
+    result = {"beats": len(scored), "failures": []}
+    if not scored:
+        result["failures"].append("no beats after %d ms" % scored_from)
+        return result
+
+    bpm_error = max(abs(e["bpm"] - bpm) / bpm for e in scored)
+    errors = [nearest_error(clicks, e["beat_ms"]) for e in scored]
+    hits = sum(1 for err in errors if abs(err) <= args.phase_tolerance_ms)
+    late = [e for e in scored if e["beat_ms"] < e["emit_ms"]]
+    result.update({
+        "bpm": scored[-1]["bpm"],
+        "bpm_error": bpm_error,
+        "phase_median_ms": statistics.median(errors),
+        "phase_max_ms": max(errors, key=abs),
+        "hit_ratio": hits / len(scored),
+        "late": len(late),
+    })
+    if bpm_error > args.bpm_tolerance:
+        result["failures"].append("bpm off by %.1f%%" % (bpm_error * 100))
+    if result["hit_ratio"] < args.min_hit_ratio:
+        result["failures"].append("%.0f%% of beats within %d ms" % (result["hit_ratio"] * 100, args.phase_tolerance_ms))
+    if late:
+        result["failures"].append("%d beats emitted after they were decoded" % len(late))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bpm-tolerance", type=float, default=0.02, help="relative tempo error (default 2%%)")
+    parser.add_argument("--phase-tolerance-ms", type=int, default=35,
+                        help="beat to click distance that counts as locked (default 35 ms, ~3 onset frames)")
+    parser.add_argument("--min-hit-ratio", type=float, default=0.9, help="share of locked beats (default 0.9)")
+    parser.add_argument("--verbose", action="store_true", help="print every scored beat")
+    args = parser.parse_args()
+
+    workdir = tempfile.mkdtemp(prefix="beat_tracker_bench_")
+    failed = 0
+    try:
+        binary = build(workdir)
+        for case in CASES:
+            clicks, events, stats = run_case(binary, case)
+            result = score(case, clicks, events, args)
+            status = "FAIL" if result["failures"] else "ok"
+            failed += bool(result["failures"])
+            if "bpm" in result:
+                print("%-20s %-4s bpm %6.1f (err %4.1f%%)  phase median %+5.1f ms max %+6.1f ms  locked %3.0f%%  beats %d"
+                      % (case[0], status, result["bpm"], result["bpm_error"] * 100, result["phase_median_ms"],
+                         result["phase_max_ms"], result["hit_ratio"] * 100, result["beats"]))
+            else:
+                print("%-20s %-4s" % (case[0], status))
+            for failure in result["failures"]:
+                print("    " + failure)
+            if args.verbose:
+                print("    stats " + json.dumps(stats))
+                for e in events:
+                    print("    beat %6d ms (emitted %6d ms) err %+6.1f ms  %.1f BPM conf %.2f"
+                          % (e["beat_ms"], e["emit_ms"], nearest_error(clicks, e["beat_ms"]), e["bpm"], e["confidence"]))
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    print("%d/%d cases locked" % (len(CASES) - failed, len(CASES)))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,76 @@
+// Host harness for main/boards/common/beat_tracker.cc: synthesizes a click track,
+// feeds it to BeatTracker in decoder-sized blocks and prints what comes out.
+//   bench <sample_rate> <seconds> <bpm> <offset_ms> <noise> [<bpm2> <change_ms>]
+// Output, consumed by beat_tracker_bench.py:
+//   C <click_ms>                              every click in the track
+//   E <emit_ms> <beat_ms> <delay_ms> <bpm> <confidence>   every beat event
+//   S <stats json>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "beat_tracker.h"
+
+static constexpr int kBlockSamples = 1152;  // One MP3 frame, as the decoder hands it over
+static constexpr float kClickMs = 15.0f;
+
+// Deterministic noise so every run of a case is identical
+static uint32_t g_seed = 12345;
+static float Noise() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return (int32_t)g_seed / 2147483648.0f;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 6 && argc != 8) {
+        fprintf(stderr, "usage: %s <sample_rate> <seconds> <bpm> <offset_ms> <noise> [<bpm2> <change_ms>]\n", argv[0]);
+        return 2;
+    }
+    int sample_rate = atoi(argv[1]);
+    double seconds = atof(argv[2]);
+    double bpm = atof(argv[3]);
+    double offset_ms = atof(argv[4]);
+    float noise = (float)atof(argv[5]);
+    double bpm2 = argc == 8 ? atof(argv[6]) : bpm;
+    double change_ms = argc == 8 ? atof(argv[7]) : seconds * 1000;
+
+    // Click times; the tempo change keeps the beat grid continuous
+    std::vector<double> clicks;
+    for (double t = offset_ms; t < seconds * 1000; t += 60000.0 / (t < change_ms ? bpm : bpm2)) {
+        clicks.push_back(t);
+        printf("C %.1f\n", t);
+    }
+
+    // Decaying noise bursts over a sustained tone and background noise, which must not count as onsets
+    int total = (int)(seconds * sample_rate);
+    std::vector<int16_t> pcm(total);
+    size_t next_click = 0;
+    for (int i = 0; i < total; i++) {
+        double t_ms = i * 1000.0 / sample_rate;
+        while (next_click + 1 < clicks.size() && clicks[next_click + 1] <= t_ms) {
+            next_click++;
+        }
+        float value = 0.2f * sinf(2.0f * (float)M_PI * 220.0f * i / sample_rate) + noise * Noise();
+        if (!clicks.empty() && t_ms >= clicks[next_click] && t_ms < clicks[next_click] + kClickMs) {
+            value += 0.6f * expf(-(float)(t_ms - clicks[next_click]) / 4.0f) * Noise();
+        }
+        pcm[i] = (int16_t)std::max(-32767.0f, std::min(32767.0f, value * 32767.0f));
+    }
+
+    BeatTracker tracker;
+    int64_t emit_ms = 0;
+    tracker.SetCallback([&emit_ms](const BeatTracker::BeatEvent& event) {
+        printf("E %lld %lld %d %.2f %.3f\n", (long long)emit_ms, (long long)event.beat_ms, event.delay_ms,
+               event.bpm, event.confidence);
+    });
+    tracker.Reset();
+    for (int start = 0; start < total; start += kBlockSamples) {
+        int count = std::min(kBlockSamples, total - start);
+        // Media time of the end of the block: what has been decoded when the event fires
+        emit_ms = (int64_t)(start + count) * 1000 / sample_rate;
+        tracker.Process(pcm.data() + start, count, sample_rate, (int64_t)start * 1000 / sample_rate);
+    }
+    printf("S %s\n", tracker.GetStatsJson().c_str());
+    return 0;
+}
@@ -225,7 +225,7 @@ def process_emoji_collection(emoji_collection_dir, assets_dir):
     # Copy each image from input directory to build/assets directory
     for root, dirs, files in os.walk(emoji_collection_dir):
         for file in files:
-            if file.lower().endswith(('.png', '.gif')):
+            if file.lower().endswith(('.png', '.gif', '.anim')):
                 # Copy file
                 src_file = os.path.join(root, file)
                 dst_file = os.path.join(assets_dir, file)
@@ -309,7 +309,7 @@ def generate_config_json(build_dir, assets_dir):
         "image_file": os.path.join(build_dir, "output", "assets.bin"),
         "lvgl_ver": "9.3.0",
         "assets_size": "0x400000",
-        "support_format": ".png, .gif, .jpg, .bin, .json",
+        "support_format": ".png, .gif, .anim, .jpg, .bin, .json",
         "name_length": "32",
         "split_height": "0",
         "support_qoi": False,
@@ -356,18 +356,18 @@ def pack_assets_simple(target_path, include_path, out_file, assets_path, max_nam
     os.makedirs(os.path.dirname(out_file), exist_ok=True)
     os.makedirs(include_path, exist_ok=True)
 
-    file_list = sorted(os.listdir(target_path), key=sort_key)
-    for filename in file_list:
-        if filename in skip_files:
-            continue
+    file_list = [f for f in sorted(os.listdir(target_path), key=sort_key)
+                 if f not in skip_files and os.path.isfile(os.path.join(target_path, f))]
 
+    # Assets are used in place from the mmapped partition, keep each file
+    # 4-byte aligned (after the 2-byte prefix) so they can be read as words
+    data_base = 12 + len(file_list) * (max_name_len + 12)
+    for filename in file_list:
         file_path = os.path.join(target_path, filename)
-        if not os.path.isfile(file_path):
-            continue
-            
         file_name = os.path.basename(file_path)
         file_size = os.path.getsize(file_path)
 
+        merged_data.extend(b'\x00' * ((-(data_base + len(merged_data) + 2)) % 4))
         file_info_list.append((file_name, len(merged_data), file_size, 0, 0))
         # Add 0x5A5A prefix to merged_data
         merged_data.extend(b'\x5A' * 2)
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Minify and gzip the web UI pages so the firmware can embed them.
+
+Each input <name>.html becomes <output-dir>/<name>.html.gz. Minification is
+deliberately conservative (indentation, blank lines and whole-line comments
+only, newlines are kept) so inline JavaScript never changes meaning; gzip does
+the heavy lifting. The gzip header carries no timestamp, so the same sources
+always produce the same bytes and therefore the same ETag on the device.
+
+Unchanged .gz files are not rewritten, so the firmware embed step does not
+rerun; --stamp names a file that is touched on every run for the build system
+to track instead.
+
+    python scripts/build_web_ui.py --output-dir build/web main/boards/kiki/web/*.html
+"""
+import argparse
+import gzip
+import os
+import re
+
+HTML_COMMENT = re.compile(r"<!--(?!\[if).*?-->", re.S)
+# "<!--" inside a script or style body is code or a string, not markup
+RAW_TEXT = re.compile(r"(<(script|style)\b.*?</\2\s*>)", re.S | re.I)
+
+
+def strip_html_comments(html):
+    parts = RAW_TEXT.split(html)
+    # split() yields text, whole element, tag name, text, ...
+    out = []
+    for i in range(0, len(parts), 3):
+        out.append(HTML_COMMENT.sub("", parts[i]))
+        if i + 1 < len(parts):
+            out.append(parts[i + 1])
+    return "".join(out)
+
+
+def minify(html):
+    out = []
+    block = None  # None, "script" or "style"
+    in_css_comment = False
+    for raw in html.splitlines():
+        line = raw.strip()
+        lower = line.lower()
+        if in_css_comment:
+            if "*/" in line:
+                in_css_comment = False
+            continue
+        if block == "script" and line.startswith("//"):
+            continue
+        if block == "style" and line.startswith("/*"):
+            if "*/" not in line:
+                in_css_comment = True
+                continue
+            if line.endswith("*/"):
+                continue
+        if line:
+            out.append(line)
+        if "<script" in lower and "</script" not in lower:
+            block = "script"
+        elif "<style" in lower and "</style" not in lower:
+            block = "style"
+        elif "</script" in lower or "</style" in lower:
+            block = None
+    return strip_html_comments("\n".join(out) + "\n")
+
+
+def build(src, output_dir):
+    with open(src, "r", encoding="utf-8") as f:
+        html = f.read()
+    data = minify(html).encode("utf-8")
+    packed = gzip.compress(data, compresslevel=9, mtime=0)
+    dst = os.path.join(output_dir, os.path.basename(src) + ".gz")
+    # Leave the file alone when nothing changed, so the embed step is not rerun
+    if not os.path.exists(dst) or open(dst, "rb").read() != packed:
+        with open(dst, "wb") as f:
+            f.write(packed)
+    raw = len(html.encode("utf-8"))
+    print(f"{os.path.basename(src)}: {raw} -> {len(data)} minified -> {len(packed)} gzip "
+          f"({100 * len(packed) / raw:.0f}%)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--output-dir", required=True, help="directory for the .gz files")
+    parser.add_argument("--stamp", help="file to touch after a successful run")
+    parser.add_argument("pages", nargs="+", help="HTML sources")
+    args = parser.parse_args()
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    for page in args.pages:
+        build(page, args.output_dir)
+    if args.stamp:
+        with open(args.stamp, "w"):
+            pass
+
+
+if __name__ == "__main__":
+    main()
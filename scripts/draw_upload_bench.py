@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Measure /draw upload latency on a Kiki robot for typical sketches.
+
+Replays a few synthetic drawing sessions (strokes added one at a time on a
+white 240x240 canvas) and uploads each step as a full raw frame, a full RLE
+frame and an RLE diff tile, then prints bytes and round-trip time per mode.
+JPEG is included when Pillow is installed.
+
+    python scripts/draw_upload_bench.py 192.168.1.100
+"""
+import argparse
+import http.client
+import io
+import math
+import random
+import statistics
+import struct
+import time
+
+SIZE = 240
+WHITE = 0xFFFF
+OP_FILL = 0x4000
+OP_SKIP = 0x8000
+MAX_COUNT = 0x3FFF
+
+
+def rgb565(r, g, b):
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+
+
+def stroke(canvas, points, color, width):
+    """Draw a polyline with square brushes"""
+    half = width // 2
+    for (x0, y0), (x1, y1) in zip(points, points[1:]):
+        steps = max(abs(x1 - x0), abs(y1 - y0), 1)
+        for i in range(steps + 1):
+            x = round(x0 + (x1 - x0) * i / steps)
+            y = round(y0 + (y1 - y0) * i / steps)
+            for yy in range(max(y - half, 0), min(y + half + 1, SIZE)):
+                row = yy * SIZE
+                for xx in range(max(x - half, 0), min(x + half + 1, SIZE)):
+                    canvas[row + xx] = color
+
+
+def sketches(seed=1):
+    """Yield (name, strokes) for a few typical drawings"""
+    rnd = random.Random(seed)
+    face = [
+        [(120 + round(90 * math.cos(a / 20 * math.tau)), 120 + round(90 * math.sin(a / 20 * math.tau)))
+         for a in range(21)],
+        [(85, 95), (95, 95)],
+        [(145, 95), (155, 95)],
+        [(80, 150), (100, 170), (140, 170), (160, 150)],
+    ]
+    yield "face", [(pts, rgb565(0, 0, 0), 4) for pts in face]
+    scribble = []
+    for _ in range(8):
+        x, y = rnd.randrange(20, 220), rnd.randrange(20, 220)
+        pts = [(x, y)]
+        for _ in range(10):
+            x = min(max(x + rnd.randint(-25, 25), 0), SIZE - 1)
+            y = min(max(y + rnd.randint(-25, 25), 0), SIZE - 1)
+            pts.append((x, y))
+        scribble.append((pts, rgb565(rnd.randrange(256), rnd.randrange(256), rnd.randrange(256)), 6))
+    yield "scribble", scribble
+    yield "text", [([(30 + i * 40, 100), (30 + i * 40, 140), (50 + i * 40, 140)], rgb565(255, 0, 0), 3)
+                   for i in range(5)]
+
+
+def bbox(prev, cur):
+    xs, ys = [], []
+    for i, (a, b) in enumerate(zip(prev, cur)):
+        if a != b:
+            xs.append(i % SIZE)
+            ys.append(i // SIZE)
+    if not xs:
+        return None
+    return min(xs), min(ys), max(xs) - min(xs) + 1, max(ys) - min(ys) + 1
+
+
+def encode_rle(cur, prev, rect):
+    """Same opcodes as the .anim RLE565 stream, continuous across rows of the tile"""
+    x0, y0, w, h = rect
+    pixels = [cur[(y0 + j // w) * SIZE + x0 + j % w] for j in range(w * h)]
+    old = [prev[(y0 + j // w) * SIZE + x0 + j % w] for j in range(w * h)] if prev else None
+    words, literal = [], []
+
+    def flush():
+        if literal:
+            words.append(len(literal))
+            words.extend(literal)
+            literal.clear()
+
+    k = 0
+    while k < len(pixels):
+        run = 1
+        if old and pixels[k] == old[k]:
+            while k + run < len(pixels) and run < MAX_COUNT and pixels[k + run] == old[k + run]:
+                run += 1
+            flush()
+            words.append(OP_SKIP | run)
+        else:
+            while k + run < len(pixels) and run < MAX_COUNT and pixels[k + run] == pixels[k]:
+                run += 1
+            if run >= 3:
+                flush()
+                words.extend((OP_FILL | run, pixels[k]))
+            else:
+                run = 1
+                literal.append(pixels[k])
+                if len(literal) == MAX_COUNT:
+                    flush()
+        k += run
+    flush()
+    return struct.pack(f"<{len(words)}H", *words)
+
+
+def encode_jpeg(cur):
+    try:
+        from PIL import Image
+    except ImportError:
+        return None
+    img = Image.new("RGB", (SIZE, SIZE))
+    img.putdata([(((c >> 11) & 0x1F) << 3, ((c >> 5) & 0x3F) << 2, (c & 0x1F) << 3) for c in cur])
+    out = io.BytesIO()
+    img.save(out, "JPEG", quality=80)
+    return out.getvalue()
+
+
+def upload(conn, path, body, content_type="application/octet-stream"):
+    start = time.perf_counter()
+    conn.request("POST", path, body=body, headers={"Content-Type": content_type})
+    resp = conn.getresponse()
+    resp.read()
+    elapsed = (time.perf_counter() - start) * 1000
+    if resp.status != 200:
+        raise RuntimeError(f"{path}: HTTP {resp.status}")
+    return elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="robot IP address")
+    parser.add_argument("--port", type=int, default=80)
+    args = parser.parse_args()
+
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=10)
+    results = {}
+    for name, strokes in sketches():
+        prev = None
+        canvas = [WHITE] * SIZE * SIZE
+        for pts, color, width in strokes:
+            stroke(canvas, pts, color, width)
+            full = (0, 0, SIZE, SIZE)
+            modes = [
+                ("raw", "/draw?fmt=raw", struct.pack(f"<{SIZE * SIZE}H", *canvas)),
+                ("rle", "/draw?fmt=rle", encode_rle(canvas, None, full)),
+            ]
+            rect = bbox(prev, canvas) if prev else full
+            if rect:
+                x, y, w, h = rect
+                modes.append(("rle-diff", f"/draw?fmt=rle&x={x}&y={y}&w={w}&h={h}", encode_rle(canvas, prev, rect)))
+            jpeg = encode_jpeg(canvas)
+            if jpeg:
+                modes.append(("jpeg", "/draw?fmt=jpeg", jpeg))
+            for mode, path, body in modes:
+                ms = upload(conn, path, body)
+                results.setdefault((name, mode), []).append((len(body), ms))
+            prev = list(canvas)
+
+    print(f"{'sketch':<10} {'mode':<9} {'avg bytes':>10} {'avg ms':>8} {'max ms':>8}")
+    for (name, mode), samples in results.items():
+        sizes = [s for s, _ in samples]
+        times = [t for _, t in samples]
+        print(f"{name:<10} {mode:<9} {statistics.mean(sizes):>10.0f} {statistics.mean(times):>8.1f} "
+              f"{max(times):>8.1f}")
+
+
+if __name__ == "__main__":
+    main()
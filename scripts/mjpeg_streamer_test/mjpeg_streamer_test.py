@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""
+Host test for the screen MJPEG streamer.
+
+Builds test_main.cc with main/boards/kiki/mjpeg_streamer.cc and runs
+MjpegStreamer over a SyntheticFrameSource, a fake JPEG encoder and an
+in-memory sink:
+  - fps_cap:        a screen that changes every tick goes out at max_fps
+  - unchanged_skip: a static screen is encoded and sent once, Advance() sends one more
+  - keepalive:      a static screen resends the last JPEG every keepalive_ms
+  - sink_failure:   the first failed write ends Run() with nothing written after it
+
+The streamer paces itself on the real steady clock; the whole run takes ~2 s.
+
+Usage:
+  python3 scripts/mjpeg_streamer_test/mjpeg_streamer_test.py
+"""
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.abspath(os.path.join(HERE, "..", ".."))
+KIKI = os.path.join(REPO, "main", "boards", "kiki")
+
+
+def build(workdir):
+    out = os.path.join(workdir, "mjpeg_streamer_test")
+    cmd = [os.environ.get("CXX", "g++"), "-std=c++17", "-O2", "-Wall", "-Wextra", "-Werror", "-pthread", "-I", KIKI,
+           os.path.join(HERE, "test_main.cc"), os.path.join(KIKI, "mjpeg_streamer.cc"), "-o", out]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit("build failed:\n" + " ".join(cmd) + "\n" + result.stderr)
+    return out
+
+
+def main():
+    workdir = tempfile.mkdtemp(prefix="mjpeg_streamer_test_")
+    try:
+        binary = build(workdir)
+        return subprocess.run([binary]).returncode
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
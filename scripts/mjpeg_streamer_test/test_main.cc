@@ -0,0 +1,176 @@
+// Host test for main/boards/kiki/mjpeg_streamer.cc: runs MjpegStreamer over a
+// SyntheticFrameSource with a fake encoder and an in-memory sink.
+// MjpegStreamer paces itself with std::chrono::steady_clock, so the timing
+// checks run in real time and only bound from below plus a loose upper bound.
+// Output, consumed by mjpeg_streamer_test.py:
+//   <case> ok|FAIL <details>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mjpeg_streamer.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t ElapsedMs(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+// Stands in for image_to_jpeg: counts calls, output depends on the frame
+struct FakeEncoder {
+    std::atomic<int> calls{0};
+
+    MjpegStreamer::Encoder Bind() {
+        return [this](const ScreenFrame& frame, int quality, std::string& jpeg) {
+            calls++;
+            jpeg = "JPEG" + std::to_string(frame.width) + "x" + std::to_string(frame.height) + "q" +
+                   std::to_string(quality) + ":" + std::to_string(frame.data[0]);
+            return true;
+        };
+    }
+};
+
+// Collects the multipart stream; fails every write from call `fail_at` on (0 = never)
+struct Sink {
+    std::atomic<int> calls{0};
+    std::atomic<int> parts{0};
+    int fail_at = 0;
+    std::vector<int64_t> part_ms;
+    Clock::time_point start = Clock::now();
+
+    MjpegStreamer::Writer Bind() {
+        return [this](const char* data, size_t len) {
+            int call = ++calls;
+            if (fail_at > 0 && call >= fail_at) {
+                return false;
+            }
+            if (len > 2 && data[0] == '-' && data[1] == '-') {
+                part_ms.push_back(ElapsedMs(start));
+                parts++;
+            }
+            return true;
+        };
+    }
+};
+
+int g_failed = 0;
+
+void Report(const char* name, bool ok, const std::string& details) {
+    printf("%-16s %-4s %s\n", name, ok ? "ok" : "FAIL", details.c_str());
+    g_failed += !ok;
+}
+
+// A screen that changes every tick may not go out faster than max_fps
+void TestFpsCap() {
+    SyntheticFrameSource source(32, 16);
+    FakeEncoder encoder;
+    MjpegStreamConfig config;
+    config.max_fps = 20;
+    MjpegStreamer streamer(source, encoder.Bind(), config);
+    Sink sink;
+
+    const uint32_t frames = 11;
+    MjpegStreamStats stats = streamer.Run(sink.Bind(), frames);
+    int64_t elapsed = ElapsedMs(sink.start);
+
+    // 11 frames at 20 fps: 10 intervals of 50 ms
+    bool ok = stats.frames_sent == frames && encoder.calls == (int)frames && sink.parts == (int)frames &&
+              elapsed >= 480 && elapsed < 2000;
+    Report("fps_cap", ok,
+           "sent " + std::to_string(stats.frames_sent) + " encoded " + std::to_string(encoder.calls) + " in " +
+               std::to_string(elapsed) + " ms (min 500)");
+}
+
+// A static screen is encoded once; Advance() brings exactly one new frame
+void TestUnchangedSkip() {
+    SyntheticFrameSource source(32, 16, false);
+    FakeEncoder encoder;
+    MjpegStreamConfig config;
+    config.max_fps = 30;
+    config.keepalive_ms = 60000;
+    MjpegStreamer streamer(source, encoder.Bind(), config);
+    Sink sink;
+
+    MjpegStreamStats stats;
+    std::thread runner([&]() { stats = streamer.Run(sink.Bind()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    int parts_static = sink.parts;
+    int encodes_static = encoder.calls;
+    source.Advance();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    int parts_after = sink.parts;
+    int encodes_after = encoder.calls;
+    streamer.Stop();
+    runner.join();
+
+    bool ok = parts_static == 1 && encodes_static == 1 && parts_after == 2 && encodes_after == 2 &&
+              stats.frames_sent == 2 && stats.frames_unchanged >= 5;
+    Report("unchanged_skip", ok,
+           "static: " + std::to_string(parts_static) + " sent/" + std::to_string(encodes_static) +
+               " encoded, after Advance: " + std::to_string(parts_after) + "/" + std::to_string(encodes_after) +
+               ", skipped " + std::to_string(stats.frames_unchanged));
+}
+
+// A static screen resends the last JPEG every keepalive_ms without re-encoding it
+void TestKeepalive() {
+    SyntheticFrameSource source(32, 16, false);
+    FakeEncoder encoder;
+    MjpegStreamConfig config;
+    config.max_fps = 20;
+    config.keepalive_ms = 200;
+    MjpegStreamer streamer(source, encoder.Bind(), config);
+    Sink sink;
+
+    MjpegStreamStats stats = streamer.Run(sink.Bind(), 4);
+
+    int64_t min_gap = INT64_MAX;
+    int64_t max_gap = 0;
+    for (size_t i = 1; i < sink.part_ms.size(); i++) {
+        int64_t gap = sink.part_ms[i] - sink.part_ms[i - 1];
+        min_gap = std::min(min_gap, gap);
+        max_gap = std::max(max_gap, gap);
+    }
+    // Gaps are whole fps ticks (50 ms), so a resend lands on the first tick past 200 ms
+    bool ok = stats.frames_sent == 4 && encoder.calls == 1 && sink.part_ms.size() == 4 && min_gap >= 195 &&
+              max_gap < 1000;
+    Report("keepalive", ok,
+           "sent " + std::to_string(stats.frames_sent) + " encoded " + std::to_string(encoder.calls) + ", gaps " +
+               std::to_string(min_gap) + ".." + std::to_string(max_gap) + " ms (min 200)");
+}
+
+// The first failed write ends Run(): nothing more goes to the sink
+void TestSinkFailure() {
+    SyntheticFrameSource source(32, 16);
+    FakeEncoder encoder;
+    MjpegStreamConfig config;
+    config.max_fps = 30;
+    MjpegStreamer streamer(source, encoder.Bind(), config);
+    Sink sink;
+    // 3 writes per frame (part header, JPEG, CRLF): fail the second frame's JPEG
+    sink.fail_at = 5;
+
+    MjpegStreamStats stats = streamer.Run(sink.Bind());
+    int64_t elapsed = ElapsedMs(sink.start);
+
+    bool ok = stats.frames_sent == 1 && sink.calls == 5 && encoder.calls == 2 && elapsed < 1000;
+    Report("sink_failure", ok,
+           "sent " + std::to_string(stats.frames_sent) + ", " + std::to_string(sink.calls) + " writes, returned after " +
+               std::to_string(elapsed) + " ms");
+}
+
+}  // namespace
+
+int main() {
+    TestFpsCap();
+    TestUnchangedSkip();
+    TestKeepalive();
+    TestSinkFailure();
+    return g_failed ? 1 : 0;
+}
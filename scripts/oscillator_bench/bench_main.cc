@@ -0,0 +1,183 @@
+// Host harness for main/boards/common/oscillator.cc, built once against the old
+// per-board oscillator (-DOSC_BENCH_REF) and once against the shared one.
+//   bench exact   position sequences for the parameter grid (see oscillator_bench.py)
+//   bench speed   host ns per Refresh() sample
+//   bench group   (shared build) StartGroup ticks == per-oscillator Refresh() sequences
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "esp_timer.h"
+#include "host_sim.h"
+#include "oscillator.h"
+
+#ifdef OSC_BENCH_REF
+#define OSCILLATOR_SAMPLING_PERIOD_MS 30  // Hard-coded sampling_period_ of the old class
+
+// The old oscillator polls the movement code's millis()
+unsigned long millis() {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+#endif
+
+// Keep in sync with GRID_* in oscillator_bench.py
+static const int kOffsets[] = {0, -7, 12};
+static const int kPeriods[] = {90, 150, 300, 510, 700, 990, 1000, 1333, 2000, 4000};
+static const double kPhases[] = {0, M_PI / 2, -M_PI / 2, M_PI, DEG2RAD(30), 1.0};
+
+static int Samples(int period) {
+    return std::max(1, period / OSCILLATOR_SAMPLING_PERIOD_MS);
+}
+
+// One sample per call; the old Refresh() only samples once more than 30 ms have passed
+static void Sample(Oscillator& oscillator, std::vector<int>& out) {
+    host_advance_us((OSCILLATOR_SAMPLING_PERIOD_MS + 1) * 1000);
+    oscillator.Refresh();
+    out.push_back(oscillator.GetPosition());
+}
+
+// Segment schedule, mirrored by reference_values() in oscillator_bench.py:
+//   1. A, O, T, Ph for 3 periods
+//   2. SetT(T * 3 / 2 + 70) for 2 periods, phase carries on
+//   3. Reset(), SetPh(0.5 - Ph) for 1 period of T
+static void RunCase(int amplitude, int offset, int period, double phase, bool rev) {
+    Oscillator oscillator;
+    oscillator.Attach(HOST_SERVO_GPIO_BASE, rev);
+    oscillator.SetA(amplitude);
+    oscillator.SetO(offset);
+    oscillator.SetT(period);
+    oscillator.SetPh(phase);
+
+    std::vector<int> positions;
+    for (int i = 0; i < 3 * Samples(period); i++) {
+        Sample(oscillator, positions);
+    }
+    int period2 = period * 3 / 2 + 70;
+    oscillator.SetT(period2);
+    for (int i = 0; i < 2 * Samples(period2); i++) {
+        Sample(oscillator, positions);
+    }
+    oscillator.Reset();
+    oscillator.SetPh(0.5 - phase);
+    for (int i = 0; i < Samples(period); i++) {
+        Sample(oscillator, positions);
+    }
+
+    printf("C %d %d %d %.17g %d\n", amplitude, offset, period, phase, rev ? 1 : 0);
+    for (size_t i = 0; i < positions.size(); i++) {
+        printf(i ? " %d" : "%d", positions[i]);
+    }
+    printf("\n");
+}
+
+static int Exact() {
+    for (int amplitude = 0; amplitude <= 100; amplitude++) {
+        for (int offset : kOffsets) {
+            for (int period : kPeriods) {
+                for (double phase : kPhases) {
+                    RunCase(amplitude, offset, period, phase, false);
+                    RunCase(amplitude, offset, period, phase, true);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static int Speed() {
+    const int kServos = 5;
+    const int kSamples = 2000000;
+    Oscillator oscillators[kServos];
+    for (int i = 0; i < kServos; i++) {
+        oscillators[i].Attach(HOST_SERVO_GPIO_BASE + i);
+        oscillators[i].SetA(30 + i);
+        oscillators[i].SetO(i - 2);
+        oscillators[i].SetT(1000);
+        oscillators[i].SetPh(i * M_PI / 3);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    long checksum = 0;
+    for (int n = 0; n < kSamples; n++) {
+        host_advance_us((OSCILLATOR_SAMPLING_PERIOD_MS + 1) * 1000);
+        for (auto& oscillator : oscillators) {
+            oscillator.Refresh();
+            checksum += oscillator.GetPosition();
+        }
+    }
+    double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("ns_per_sample %.2f checksum %ld\n", elapsed_ns / ((double)kSamples * kServos), checksum);
+    return 0;
+}
+
+#ifndef OSC_BENCH_REF
+// The group timer must produce exactly what stepping each oscillator alone does
+static int Group() {
+    const int kServos = 6;
+    const int kTicks = 500;
+    Oscillator grouped[kServos];
+    Oscillator single[kServos];
+    for (int i = 0; i < kServos; i++) {
+        for (Oscillator* oscillator : {&grouped[i], &single[i]}) {
+            oscillator->Attach(HOST_SERVO_GPIO_BASE + i, i % 2);
+            oscillator->SetA(10 + 7 * i);
+            oscillator->SetO(3 - i);
+            oscillator->SetT(600 + 170 * i);
+            oscillator->SetPh(i * 0.7);
+        }
+    }
+
+    std::vector<int> expected[kServos];
+    for (int t = 0; t < kTicks; t++) {
+        for (int i = 0; i < kServos; i++) {
+            single[i].Refresh();
+            expected[i].push_back(single[i].GetPosition());
+        }
+    }
+
+    std::vector<int> actual[kServos];
+    Oscillator::StartGroup(grouped, kServos);  // Takes the first sample itself
+    for (int t = 0; t < kTicks; t++) {
+        if (t > 0 && host_fire_periodic_timers() != 1) {
+            printf("group FAIL: timer not running at tick %d\n", t);
+            return 1;
+        }
+        for (int i = 0; i < kServos; i++) {
+            actual[i].push_back(grouped[i].GetPosition());
+        }
+    }
+    Oscillator::StopGroup();
+    if (host_fire_periodic_timers() != 0) {
+        printf("group FAIL: timer still running after StopGroup\n");
+        return 1;
+    }
+
+    for (int i = 0; i < kServos; i++) {
+        if (actual[i] != expected[i]) {
+            printf("group FAIL: servo %d differs from its Refresh() sequence\n", i);
+            return 1;
+        }
+    }
+    printf("group ok %d servos x %d ticks\n", kServos, kTicks);
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv) {
+    const char* mode = argc > 1 ? argv[1] : "exact";
+    if (strcmp(mode, "exact") == 0) {
+        return Exact();
+    }
+    if (strcmp(mode, "speed") == 0) {
+        return Speed();
+    }
+#ifndef OSC_BENCH_REF
+    if (strcmp(mode, "group") == 0) {
+        return Group();
+    }
+#endif
+    fprintf(stderr, "unknown mode %s\n", mode);
+    return 2;
+}
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+"""
+Exactness and speed check for the shared fixed-point oscillator.
+
+Builds bench_main.cc twice against the host mocks of scripts/otto_motion_sim:
+once with the last per-board double/std::sin oscillator from git (ref) and once
+with main/boards/common/oscillator.cc (new).
+
+  - exact: every case of the A/O/T/Ph/rev grid is compared with the ref sample
+    by sample, including a period change and Reset() mid-run. Only samples
+    whose unrounded A * sin + O lies within the sine table error of x.5 may
+    differ, by one degree; other mismatches are listed for diagnosis.
+  - group: StartGroup() ticks must match per-oscillator Refresh() exactly.
+  - speed: host ns per Refresh() for both builds (relative only, the ESP32
+    has no FPU for doubles so the gap there is much larger).
+
+Usage:
+  python3 scripts/oscillator_bench/oscillator_bench.py
+  python3 scripts/oscillator_bench/oscillator_bench.py --no-speed
+"""
+
+import argparse
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.abspath(os.path.join(HERE, "..", ".."))
+HOST = os.path.join(REPO, "scripts", "otto_motion_sim", "host")
+COMMON = os.path.join(REPO, "main", "boards", "common")
+REF_REL = "main/boards/kiki"
+
+SAMPLING_PERIOD_MS = 30
+# Worst case |table lookup - 32768 * sin| in Q15 units of oscillator.cc: 0.5 table
+# rounding, 0.16 linear interpolation, 1 for dropping the interpolation remainder
+SINE_ERROR_Q15 = 2
+
+
+def git(*args):
+    return subprocess.run(["git", "-C", REPO] + list(args), check=True,
+                          capture_output=True, text=True).stdout
+
+
+def find_reference_rev():
+    # Newest revision that still has the per-board double oscillator
+    for rev in git("log", "--format=%H", "--", REF_REL + "/oscillator.cc").split():
+        try:
+            git("show", rev + ":" + REF_REL + "/oscillator.cc")
+            return rev
+        except subprocess.CalledProcessError:
+            continue
+    sys.exit("no reference revision of %s/oscillator.cc found" % REF_REL)
+
+
+def compile_bench(out, include_dirs, sources, defines, warnings=True):
+    # The reference oscillator comes from git history and stays as it was: no warnings for it
+    flags = ["-Wall", "-Wextra", "-Werror"] if warnings else ["-w"]
+    cmd = [os.environ.get("CXX", "g++"), "-std=c++17", "-O2"] + flags + ["-I", HOST]
+    for d in include_dirs:
+        cmd += ["-I", d]
+    cmd += ["-D" + d for d in defines]
+    cmd += [os.path.join(HERE, "bench_main.cc"), os.path.join(HOST, "host_mocks.cc")]
+    cmd += sources + ["-o", out]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit("build failed:\n" + " ".join(cmd) + "\n" + result.stderr)
+
+
+def build(workdir, ref_rev):
+    ref_dir = os.path.join(workdir, "ref")
+    os.makedirs(ref_dir)
+    for name in ("oscillator.h", "oscillator.cc"):
+        with open(os.path.join(ref_dir, name), "w") as f:
+            f.write(git("show", "%s:%s/%s" % (ref_rev, REF_REL, name)))
+
+    ref_bin = os.path.join(workdir, "bench_ref")
+    compile_bench(ref_bin, [ref_dir], [os.path.join(ref_dir, "oscillator.cc")], ["OSC_BENCH_REF"], warnings=False)
+    new_bin = os.path.join(workdir, "bench_new")
+    compile_bench(new_bin, [COMMON], [os.path.join(COMMON, "oscillator.cc")], [])
+    return ref_bin, new_bin
+
+
+def run(binary, mode):
+    return subprocess.run([binary, mode], check=True, capture_output=True, text=True).stdout
+
+
+def parse_cases(out):
+    cases = []
+    lines = out.splitlines()
+    for header, values in zip(lines[0::2], lines[1::2]):
+        parts = header.split()
+        key = (int(parts[1]), int(parts[2]), int(parts[3]), float(parts[4]), int(parts[5]))
+        cases.append((key, [int(v) for v in values.split()]))
+    return cases
+
+
+def samples(period):
+    return max(1, period // SAMPLING_PERIOD_MS)
+
+
+def reference_values(amplitude, offset, period, phase0):
+    """Unrounded A * sin + O of every sample, following RunCase() in bench_main.cc."""
+    values = []
+
+    def segment(phase, ph, period_ms, count):
+        inc = 2 * math.pi / float(samples(period_ms))
+        for _ in range(count):
+            values.append(amplitude * math.sin(phase + ph) + offset)
+            phase += inc
+        return phase
+
+    phase = segment(0.0, phase0, period, 3 * samples(period))
+    period2 = period * 3 // 2 + 70
+    segment(phase, phase0, period2, 2 * samples(period2))
+    # Reset() keeps the period set by SetT()
+    segment(0.0, 0.5 - phase0, period2, samples(period))
+    return values
+
+
+def check_exact(ref_out, new_out):
+    """The firmware takes the table value as is, so a sample that lands within the
+    table's error of x.5 may round the other way. Anything else is a bug."""
+    ref_cases = parse_cases(ref_out)
+    new_cases = parse_cases(new_out)
+    if [k for k, _ in ref_cases] != [k for k, _ in new_cases]:
+        print("exact: case lists differ")
+        return False
+
+    total, rounding, worst, bad = 0, 0, 0.0, []
+    for (key, ref), (_, new) in zip(ref_cases, new_cases):
+        total += len(ref)
+        if ref == new:
+            continue
+        if len(ref) != len(new):
+            bad.append((key, "length %d != %d" % (len(ref), len(new))))
+            continue
+        values = None
+        margin = key[0] * SINE_ERROR_Q15 / 32768.0 + 1e-9
+        for i, (a, b) in enumerate(zip(ref, new)):
+            if a == b:
+                continue
+            values = values or reference_values(key[0], key[1], key[2], key[3])
+            off_half = abs(abs(values[i] - math.floor(values[i])) - 0.5)
+            if abs(a - b) == 1 and off_half <= margin:
+                rounding += 1
+                worst = max(worst, off_half)
+                continue
+            bad.append((key, "sample %d: ref %d new %d (exact %.12f)" % (i, a, b, values[i])))
+
+    print("exact: %d cases, %d samples, %d bit-exact, %d rounded the other way at x.5 (within %.6f), %d mismatches"
+          % (len(ref_cases), total, total - rounding - len(bad), rounding, worst, len(bad)))
+    for key, message in bad[:20]:
+        print("  A=%d O=%d T=%d Ph=%g rev=%d: %s" % (key + (message,)))
+    return not bad
+
+
+def parse_speed(out):
+    return float(out.split()[1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--ref", help="reference git revision (default: last per-board oscillator)")
+    parser.add_argument("--no-speed", action="store_true", help="skip the timing run")
+    args = parser.parse_args()
+
+    ref_rev = args.ref or find_reference_rev()
+    workdir = tempfile.mkdtemp(prefix="oscillator_bench_")
+    try:
+        ref_bin, new_bin = build(workdir, ref_rev)
+        print("reference %s" % ref_rev[:10])
+        ok = check_exact(run(ref_bin, "exact"), run(new_bin, "exact"))
+
+        group = subprocess.run([new_bin, "group"], capture_output=True, text=True)
+        print(group.stdout.strip())
+        ok = ok and group.returncode == 0
+
+        if not args.no_speed:
+            ref_ns = parse_speed(run(ref_bin, "speed"))
+            new_ns = parse_speed(run(new_bin, "speed"))
+            print("speed: ref %.1f ns/sample, new %.1f ns/sample (%.2fx, host)" % (ref_ns, new_ns, ref_ns / new_ns))
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
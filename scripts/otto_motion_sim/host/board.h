@@ -0,0 +1,12 @@
+#pragma once
+#include "display/display.h"
+
+// Host stand-in: no display attached
+class Board {
+public:
+    static Board& GetInstance() {
+        static Board instance;
+        return instance;
+    }
+    Display* GetDisplay() { return nullptr; }
+};
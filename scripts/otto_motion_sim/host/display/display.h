@@ -0,0 +1,7 @@
+#pragma once
+// Host stand-in: the movement code only sets emotions
+class Display {
+public:
+    virtual ~Display() = default;
+    virtual void SetEmotion(const char* emotion) { (void)emotion; }
+};
@@ -0,0 +1,2 @@
+#pragma once
+// Host stand-in: the motion code only needs the include to resolve
@@ -0,0 +1,7 @@
+#pragma once
+// Host stand-in: routine logs are noise in the simulator
+#include "esp_err.h"
+#define ESP_LOGE(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGW(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGI(tag, fmt, ...) ((void)(tag))
+#define ESP_LOGD(tag, fmt, ...) ((void)(tag))
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include "esp_err.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void* TaskHandle_t;
+
+// Tick rate of the simulated build, see otto_motion_sim.py --tick-hz
+#ifndef configTICK_RATE_HZ
+#define configTICK_RATE_HZ 1000
+#endif
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portMAX_DELAY 0xffffffffu
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define IRAM_ATTR
+#define BIT0 0x01
+#define BIT1 0x02
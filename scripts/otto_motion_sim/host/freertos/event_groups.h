@@ -0,0 +1,11 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+typedef struct HostEventGroup* EventGroupHandle_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
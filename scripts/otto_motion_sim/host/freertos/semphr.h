@@ -0,0 +1,5 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// Declarations only: the virtual-time MotionEngine never blocks
+typedef struct HostSemaphore* SemaphoreHandle_t;
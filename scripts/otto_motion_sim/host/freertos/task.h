@@ -0,0 +1,8 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+// vTaskDelay advances the virtual clock, nothing else runs concurrently
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskCreate(void (*task)(void*), const char* name, uint32_t stack, void* arg, UBaseType_t priority,
+                       TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
@@ -0,0 +1,222 @@
+// Host implementations of the ESP-IDF / FreeRTOS calls used by the Otto movement code.
+// Time is virtual: only vTaskDelay() and host_advance_us() move the clock.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "host_sim.h"
+
+static int64_t g_now_us = 0;
+static int64_t g_stop_at_us = -1;
+static FILE* g_trace = nullptr;
+static std::map<int, int> g_channel_gpio;
+static std::map<int, uint32_t> g_channel_duty;
+static int g_duty_to_angle[8192];
+static std::multimap<int64_t, std::function<void()>> g_events;
+static int g_tick_jitter_us = 0;
+static uint32_t g_jitter_seed = 1;
+
+struct HostEventGroup {
+    EventBits_t bits = 0;
+};
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    uint64_t period_us = 0;
+};
+
+static std::vector<esp_timer*> g_timers;
+
+int64_t esp_timer_get_time(void) {
+    return g_now_us;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle) {
+    *out_handle = new esp_timer{*args};
+    g_timers.push_back(*out_handle);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    timer->period_us = period_us;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->period_us = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    g_timers.erase(std::remove(g_timers.begin(), g_timers.end(), timer), g_timers.end());
+    delete timer;
+    return ESP_OK;
+}
+
+int host_fire_periodic_timers() {
+    int fired = 0;
+    for (size_t i = 0; i < g_timers.size(); i++) {
+        if (g_timers[i]->period_us > 0) {
+            g_timers[i]->args.callback(g_timers[i]->args.arg);
+            fired++;
+        }
+    }
+    return fired;
+}
+
+void host_advance_us(int64_t us) {
+    int64_t end_us = g_now_us + us;
+    // Callbacks run at their own time, and may schedule more
+    while (!g_events.empty() && g_events.begin()->first <= end_us) {
+        auto event = g_events.begin();
+        std::function<void()> callback = std::move(event->second);
+        g_now_us = std::max(g_now_us, event->first);
+        g_events.erase(event);
+        callback();
+    }
+    g_now_us = end_us;
+}
+
+void host_reset_clock() {
+    g_now_us = 0;
+    g_stop_at_us = -1;
+    g_events.clear();
+    g_jitter_seed = 1;
+}
+
+void host_schedule_at(int64_t at_us, std::function<void()> callback) {
+    g_events.emplace(at_us, std::move(callback));
+}
+
+int64_t host_next_event_us() {
+    return g_events.empty() ? -1 : g_events.begin()->first;
+}
+
+void host_set_tick_jitter_us(int jitter_us) {
+    g_tick_jitter_us = std::max(jitter_us, 0);
+}
+
+int64_t host_tick_us(int64_t nominal_us) {
+    if (g_tick_jitter_us == 0) {
+        return nominal_us;
+    }
+    // Deterministic LCG so runs stay comparable
+    g_jitter_seed = g_jitter_seed * 1103515245u + 12345u;
+    int span = 2 * g_tick_jitter_us + 1;
+    return nominal_us + (int64_t)((g_jitter_seed >> 8) % span) - g_tick_jitter_us;
+}
+
+void host_set_trace(FILE* out) {
+    g_trace = out;
+}
+
+void host_request_stop_at(int64_t at_us) {
+    g_stop_at_us = at_us;
+}
+
+bool host_stop_due() {
+    return g_stop_at_us >= 0 && g_now_us >= g_stop_at_us;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    host_advance_us((int64_t)ticks * 1000000 / configTICK_RATE_HZ);
+}
+
+BaseType_t xTaskCreate(void (*)(void*), const char*, uint32_t, void*, UBaseType_t, TaskHandle_t* handle) {
+    if (handle != nullptr) {
+        *handle = nullptr;
+    }
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t) {
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    return new HostEventGroup();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+    delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    group->bits |= bits;
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    EventBits_t old = group->bits;
+    group->bits &= ~bits;
+    return old;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    // Stands in for Stop() being called from another task
+    if (host_stop_due()) {
+        g_stop_at_us = -1;
+        group->bits |= BIT0;
+    }
+    return group->bits;
+}
+
+// Same duty formula as Oscillator::Write, inverted
+static void BuildDutyTable() {
+    static bool built = false;
+    if (built) {
+        return;
+    }
+    for (auto& angle : g_duty_to_angle) {
+        angle = -1;
+    }
+    for (int angle = 0; angle <= 180; angle++) {
+        uint32_t duty = (uint32_t)(((angle / 180.0) * 2.0 + 0.5) * 8191 / 20.0);
+        g_duty_to_angle[duty] = angle;
+    }
+    built = true;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t*) {
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+    BuildDutyTable();
+    g_channel_gpio[config->channel] = config->gpio_num;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t, ledc_channel_t channel, uint32_t duty) {
+    g_channel_duty[channel] = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t channel) {
+    if (g_trace == nullptr) {
+        return ESP_OK;
+    }
+    int servo = g_channel_gpio[channel] - HOST_SERVO_GPIO_BASE;
+    uint32_t duty = g_channel_duty[channel];
+    int angle = duty < 8192 ? g_duty_to_angle[duty] : -1;
+    if (angle < 0) {
+        fprintf(stderr, "unexpected duty %u on servo %d\n", (unsigned)duty, servo);
+        exit(1);
+    }
+    // Right side servos are mounted mirrored, report the logical angle
+    if (servo == 1 || servo == 3) {
+        angle = 180 - angle;
+    }
+    fprintf(g_trace, "W %lld %d %d %u\n", (long long)g_now_us, servo, angle, (unsigned)duty);
+    return ESP_OK;
+}
+
+esp_err_t ledc_stop(ledc_mode_t, ledc_channel_t, uint32_t) {
+    return ESP_OK;
+}
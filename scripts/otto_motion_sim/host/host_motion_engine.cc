@@ -0,0 +1,88 @@
+// Virtual-time MotionEngine: same player, but Run() steps the clock one engine
+// tick at a time instead of waiting for the esp_timer task. Like the device
+// engine, the player advances by the measured time between ticks.
+#include "otto_motion_engine.h"
+
+#include <utility>
+
+#include "host_sim.h"
+
+MotionEngine::MotionEngine(MotionPlayer::Writer writer, MotionPlayer::Reader reader)
+    : player_(std::move(writer), std::move(reader)) {
+}
+
+MotionEngine::~MotionEngine() {
+}
+
+void MotionEngine::TimerCallback(void*) {
+}
+
+void MotionEngine::Tick() {
+}
+
+void MotionEngine::StartTimerLocked() {
+}
+
+void MotionEngine::NotifyLocked() {
+}
+
+void MotionEngine::Play(MotionClip clip, int blend_ms) {
+    if (interrupted_) {
+        return;
+    }
+    generation_++;
+    player_.Play(std::move(clip), blend_ms);
+}
+
+bool MotionEngine::Run(MotionClip clip, int blend_ms) {
+    if (interrupted_) {
+        return false;
+    }
+    Play(std::move(clip), blend_ms);
+    uint32_t generation = generation_;
+    while (player_.Active()) {
+        if (host_stop_due()) {
+            // What Stop() does from the other task
+            player_.Cancel();
+            return false;
+        }
+        int64_t elapsed_us = host_tick_us(MOTION_TICK_MS * 1000);
+        // Scheduled callbacks (an urgent action preempting this one) run during the wait
+        host_advance_us(elapsed_us);
+        if (generation_ != generation) {
+            return false;
+        }
+        player_.Advance((uint32_t)elapsed_us);
+    }
+    return true;
+}
+
+void MotionEngine::Cancel() {
+    generation_++;
+    player_.Cancel();
+}
+
+void MotionEngine::Interrupt() {
+    interrupted_ = true;
+    Cancel();
+}
+
+void MotionEngine::Resume() {
+    interrupted_ = false;
+}
+
+bool MotionEngine::IsInterrupted() {
+    return interrupted_;
+}
+
+bool MotionEngine::IsBusy() {
+    return player_.Active();
+}
+
+void MotionEngine::SetSpeed(int percent) {
+    player_.SetSpeed(percent);
+}
+
+int MotionEngine::GetSpeed() {
+    return player_.GetSpeed();
+}
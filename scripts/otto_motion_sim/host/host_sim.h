@@ -0,0 +1,24 @@
+#pragma once
+// Simulator hooks shared by the mocks, the host motion engine and sim_main.cc
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#define HOST_SERVO_GPIO_BASE 10  // Servo i is attached to GPIO 10 + i
+
+void host_advance_us(int64_t us);
+void host_reset_clock();
+void host_set_trace(FILE* out);
+// Emulates Stop() from another task: the stop bit reads as set from at_us on
+void host_request_stop_at(int64_t at_us);
+bool host_stop_due();
+// Runs the callback of every started periodic esp_timer once; returns how many fired
+int host_fire_periodic_timers();
+// Emulates another task acting at at_us (queueing an action, an urgent command): the callback
+// runs when the virtual clock passes at_us, from vTaskDelay() or an engine tick
+void host_schedule_at(int64_t at_us, std::function<void()> callback);
+// Time of the next scheduled callback, -1 if none
+int64_t host_next_event_us();
+// Engine ticks land up to +-jitter_us off the nominal MOTION_TICK_MS (esp_timer dispatch latency)
+void host_set_tick_jitter_us(int jitter_us);
+int64_t host_tick_us(int64_t nominal_us);
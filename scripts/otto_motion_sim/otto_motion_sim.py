@@ -0,0 +1,538 @@
+#!/usr/bin/env python3
+"""
+Host simulator for the kiki dog routines.
+
+Builds main/boards/kiki/otto_movements.cc twice against mocked LEDC/FreeRTOS
+(host/): once from the reference revision pinned in bench_baseline.json, the
+last one before the keyframe motion engine (blocking ServoAngleSet + vTaskDelay
+routines), and once from the working tree
+(clips played by otto_motion.cc in 10 ms engine ticks). Both run the same
+scenarios from sim_main.cc and the servo traces are compared:
+
+  - duration: when the routine returns
+  - final pose of every servo
+  - max deviation: worst angle difference at any millisecond, allowing the
+    new trace to lag or lead by the duration tolerance
+  - servo write counts (informational: ramps skip unchanged angles)
+
+The new build plans pose transitions with --profile (default linear, the
+shape of the old step loops; the firmware uses min_jerk). With a smooth profile
+the mid-move deviation is reported but not checked, and routines may run longer
+where the joint limits stretch a short move.
+
+--plan checks the trajectory planner itself (common/servo_trajectory.cc through
+MotionBuilder::Move) on a 1 ms grid: every joint starts and lands together,
+peak speed and acceleration stay within each joint's limits, and a move is only
+stretched past its authored time when a limit requires it.
+
+--bench times the working tree routines alone: total time, servo write rate and
+how far write batches land off the engine tick grid (--tick-jitter-us emulates
+esp_timer dispatch latency). --save-bench / --baseline store and compare the
+numbers as JSON, so a gait change that slows a routine or floods the LEDC shows up.
+
+--replay plays a memory slot ("dog_walk,3,150;loop,2;bow,1,2000;endloop") the way
+the web UI does: one action queued every --gap-ms through the firmware action
+queue and slot bytecode, while the action task plays them. --at adds commands
+from another client during playback (stop and home preempt).
+
+Usage:
+  python3 scripts/otto_motion_sim/otto_motion_sim.py
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --scenario walk --dump walk
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --tick-hz 100   # device FreeRTOS tick
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --profile min_jerk
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --plan --dump /tmp/plan
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --bench --save-bench bench.json
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --bench --baseline bench.json --tick-jitter-us 2000
+  python3 scripts/otto_motion_sim/otto_motion_sim.py --replay "dog_walk,3,150;bow,1,2000" --at 1500:home,0,500
+"""
+
+import argparse
+import json
+import math
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+REPO = os.path.abspath(os.path.join(HERE, "..", ".."))
+KIKI = os.path.join(REPO, "main", "boards", "kiki")
+KIKI_REL = "main/boards/kiki"
+COMMON = os.path.join(REPO, "main", "boards", "common")
+BASELINE = os.path.join(HERE, "bench_baseline.json")
+
+ENGINE_TICK_MS = 10
+SERVO_NAMES = ["LF", "RF", "LB", "RB", "TAIL"]
+PROFILES = ["linear", "min_jerk", "trapezoid"]
+
+# Finite differences on the 1 ms plan grid, relative slack over the limits
+PLAN_SPEED_SLACK = 1.01
+PLAN_ACCEL_SLACK = 1.02
+
+# Scenarios where the old routine was wrong and the new trace is expected to differ
+KNOWN_DIFFERENCES = {
+}
+
+
+def git(*args):
+    return subprocess.run(["git", "-C", REPO] + list(args), check=True,
+                          capture_output=True, text=True).stdout
+
+
+def pinned_reference_rev():
+    # Last otto_movements.cc with the blocking routines, pinned so the comparison never drifts
+    with open(BASELINE) as f:
+        return json.load(f).get("reference_rev")
+
+
+def compile_sim(out, include_dirs, sources, tick_hz, defines=(), warnings=True):
+    # The reference sources come from git history and stay as they were: no warnings for them
+    flags = ["-Wall", "-Wextra", "-Werror"] if warnings else ["-w"]
+    cmd = [os.environ.get("CXX", "g++"), "-std=c++17", "-O1"] + flags + [
+           "-DconfigTICK_RATE_HZ=%d" % tick_hz, "-I", os.path.join(HERE, "host")]
+    for d in include_dirs:
+        cmd += ["-I", d]
+    cmd += ["-D" + d for d in defines]
+    cmd += [os.path.join(HERE, "sim_main.cc"), os.path.join(HERE, "host", "host_mocks.cc")]
+    cmd += sources + ["-o", out]
+    result = subprocess.run(cmd, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit("build failed:\n" + " ".join(cmd) + "\n" + result.stderr)
+
+
+def build_new(workdir, tick_hz):
+    new_bin = os.path.join(workdir, "sim_new")
+    compile_sim(new_bin, [KIKI, COMMON],
+                [os.path.join(KIKI, "otto_movements.cc"), os.path.join(KIKI, "otto_motion.cc"),
+                 os.path.join(KIKI, "otto_action_program.cc"), os.path.join(KIKI, "otto_action_queue.cc"),
+                 os.path.join(KIKI, "otto_actions.cc"),
+                 os.path.join(COMMON, "oscillator.cc"), os.path.join(COMMON, "servo_trajectory.cc"),
+                 os.path.join(HERE, "host", "host_motion_engine.cc"), os.path.join(HERE, "sim_controller.cc")],
+                tick_hz, ["SIM_TRAJECTORY"])
+    return new_bin
+
+
+def build(workdir, ref_rev, tick_hz):
+    ref_dir = os.path.join(workdir, "ref")
+    os.makedirs(ref_dir)
+    for name in ("otto_movements.h", "otto_movements.cc", "oscillator.h", "oscillator.cc"):
+        try:
+            source = git("show", "%s:%s/%s" % (ref_rev, KIKI_REL, name))
+        except subprocess.CalledProcessError:
+            sys.exit("reference revision %s has no %s/%s (shallow clone?)" % (ref_rev, KIKI_REL, name))
+        with open(os.path.join(ref_dir, name), "w") as f:
+            f.write(source)
+
+    ref_bin = os.path.join(workdir, "sim_ref")
+    compile_sim(ref_bin, [ref_dir],
+                [os.path.join(ref_dir, "otto_movements.cc"), os.path.join(ref_dir, "oscillator.cc")],
+                tick_hz, warnings=False)
+    return ref_bin, build_new(workdir, tick_hz)
+
+
+def run(binary, scenario, extra_args=()):
+    args = [binary] + ([scenario] if scenario else []) + list(extra_args)
+    result = subprocess.run(args, capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit("%s failed:\n%s" % (" ".join(args), result.stderr))
+    traces = {}
+    name = None
+    for line in result.stdout.splitlines():
+        parts = line.split()
+        if parts[0] == "S":
+            name = parts[1]
+            traces[name] = {"writes": [], "duties": [], "actions": [], "end_us": 0}
+        elif parts[0] == "W":
+            traces[name]["writes"].append((int(parts[1]), int(parts[2]), int(parts[3])))
+            traces[name]["duties"].append(int(parts[4]) if len(parts) > 4 else -1)
+        elif parts[0] == "A":
+            traces[name]["actions"].append((int(parts[1]), int(parts[2]), parts[3], parts[4]))
+        elif parts[0] == "E":
+            traces[name]["end_us"] = int(parts[1])
+    return traces
+
+
+def timeline(trace, servo, end_ms, start_angle=None):
+    """Angle of one servo at every millisecond, None before its first write."""
+    angles = [start_angle] * (end_ms + 1)
+    for t_us, s, angle in trace["writes"]:
+        if s != servo:
+            continue
+        t = min(t_us // 1000, end_ms)
+        for i in range(t, end_ms + 1):
+            angles[i] = angle
+    return angles
+
+
+def max_deviation(ref, new, servo, end_ms, lag_ms):
+    a = timeline(ref, servo, end_ms)
+    b = timeline(new, servo, end_ms)
+    worst, worst_t = 0, 0
+    for t in range(end_ms + 1):
+        if b[t] is None:
+            continue
+        window = [a[i] for i in range(max(0, t - lag_ms), min(end_ms, t + lag_ms) + 1) if a[i] is not None]
+        if not window:
+            continue
+        diff = min(abs(b[t] - x) for x in window)
+        if diff > worst:
+            worst, worst_t = diff, t
+    return worst, worst_t
+
+
+def final_pose(trace):
+    pose = [None] * len(SERVO_NAMES)
+    for _, servo, angle in trace["writes"]:
+        pose[servo] = angle
+    return pose
+
+
+def dump_csv(path, trace):
+    with open(path, "w") as f:
+        f.write("t_ms,servo,angle,duty\n")
+        for (t_us, servo, angle), duty in zip(trace["writes"], trace["duties"]):
+            f.write("%.3f,%s,%d,%d\n" % (t_us / 1000.0, SERVO_NAMES[servo], angle, duty))
+
+
+def bench_stats(trace):
+    """Total time, write rate and how far write batches land off the engine tick grid."""
+    end_us = trace["end_us"]
+    times = [t_us for t_us, _, _ in trace["writes"]]
+    batches = sorted(set(times))
+    # Gaps between batches should be whole engine ticks (holds skip unchanged angles)
+    tick_us = ENGINE_TICK_MS * 1000
+    offsets = []
+    for a, b in zip(batches, batches[1:]):
+        gap = b - a
+        offsets.append(abs(gap - max(1, round(gap / tick_us)) * tick_us))
+    return {
+        "total_ms": end_us / 1000.0,
+        "writes": len(times),
+        "writes_per_s": len(times) * 1e6 / end_us if end_us else 0.0,
+        "peak_batch": max((times.count(t) for t in batches), default=0),
+        "jitter_rms_ms": math.sqrt(sum(o * o for o in offsets) / len(offsets)) / 1000 if offsets else 0.0,
+        "jitter_max_ms": max(offsets, default=0) / 1000.0,
+    }
+
+
+BENCH_HEADER = "%-22s %10s %8s %9s %6s %10s %10s" % ("scenario", "total ms", "writes", "writes/s", "batch",
+                                                     "jitter rms", "jitter max")
+
+
+def bench_line(name, stats):
+    return "%-22s %10.1f %8d %9.0f %6d %10.2f %10.2f" % (
+        name, stats["total_ms"], stats["writes"], stats["writes_per_s"], stats["peak_batch"],
+        stats["jitter_rms_ms"], stats["jitter_max_ms"])
+
+
+def compare_bench(name, stats, base, args):
+    problems = []
+    if abs(stats["total_ms"] - base["total_ms"]) > args.tolerance_ms:
+        problems.append("total %+.0f ms" % (stats["total_ms"] - base["total_ms"]))
+    if stats["writes"] > base["writes"] * (1 + args.max_write_growth / 100.0):
+        problems.append("writes %d -> %d" % (base["writes"], stats["writes"]))
+    return problems
+
+
+def run_bench(args):
+    workdir = tempfile.mkdtemp(prefix="otto_motion_sim_")
+    try:
+        new_bin = build_new(workdir, args.tick_hz)
+        traces = run(new_bin, args.scenario,
+                     ["--profile=" + args.profile, "--tick-jitter=%d" % args.tick_jitter_us])
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    baseline = {}
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["scenarios"]
+
+    print("FreeRTOS tick %d Hz, engine tick %d ms, tick jitter +-%d us, %s profile" % (
+        args.tick_hz, ENGINE_TICK_MS, args.tick_jitter_us, args.profile))
+    print(BENCH_HEADER)
+    results = {}
+    failed = 0
+    for name, trace in traces.items():
+        stats = bench_stats(trace)
+        results[name] = stats
+        status = ""
+        if name in baseline:
+            problems = compare_bench(name, stats, baseline[name], args)
+            failed += 1 if problems else 0
+            status = "FAIL " + ", ".join(problems) if problems else "ok"
+        elif baseline:
+            status = "new"
+        print(bench_line(name, stats) + " " + status)
+        if args.dump:
+            dump_csv("%s_%s.csv" % (args.dump, name), trace)
+
+    if args.save_bench:
+        with open(args.save_bench, "w") as f:
+            json.dump({"tick_hz": args.tick_hz, "tick_jitter_us": args.tick_jitter_us, "profile": args.profile,
+                       "reference_rev": pinned_reference_rev(), "scenarios": results}, f, indent=1, sort_keys=True)
+    if failed:
+        print("%d scenario(s) regressed against %s" % (failed, args.baseline))
+        return 1
+    return 0
+
+
+def run_replay(args):
+    workdir = tempfile.mkdtemp(prefix="otto_motion_sim_")
+    try:
+        new_bin = build_new(workdir, args.tick_hz)
+        extra = ["replay", args.replay, "--gap=%d" % args.gap_ms, "--profile=" + args.profile,
+                 "--tick-jitter=%d" % args.tick_jitter_us] + ["--at=" + a for a in args.at]
+        trace = run(new_bin, None, extra)["replay"]
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    # Per token: queued, start and end time (ms), how it ended
+    actions = {}
+    for t_us, token, action, event in trace["actions"]:
+        if token == 0:
+            print("%9.1f ms  %-16s rejected, queue full" % (t_us / 1000.0, action))
+            continue
+        entry = actions.setdefault(token, {"action": action, "queued": t_us, "start": None, "end": None,
+                                           "status": "dropped, queue full", "merged": 0})
+        if event == "coalesced":
+            entry["merged"] += 1
+        elif event == "start":
+            entry["start"] = t_us
+        elif event in ("done", "preempted"):
+            entry["end"] = t_us
+            entry["status"] = event
+        elif event == "cleared":
+            entry["status"] = "cleared by stop"
+
+    print("%5s %-16s %9s %9s %9s %9s %s" % ("token", "action", "queued", "wait ms", "start", "run ms", ""))
+    for token, entry in sorted(actions.items()):
+        wait = run_ms = "-"
+        start = "-"
+        if entry["start"] is not None:
+            start = "%.0f" % (entry["start"] / 1000.0)
+            wait = "%.0f" % ((entry["start"] - entry["queued"]) / 1000.0)
+        if entry["end"] is not None:
+            run_ms = "%.0f" % ((entry["end"] - entry["start"]) / 1000.0)
+        status = entry["status"] + (" (+%d merged)" % entry["merged"] if entry["merged"] else "")
+        print("%5d %-16s %9.0f %9s %9s %9s %s" % (token, entry["action"], entry["queued"] / 1000.0, wait, start,
+                                                  run_ms, status))
+    print(BENCH_HEADER)
+    print(bench_line("replay", bench_stats(trace)))
+    if args.dump:
+        dump_csv("%s_replay.csv" % args.dump, trace)
+    return 0
+
+
+def run_programs(args):
+    workdir = tempfile.mkdtemp(prefix="otto_motion_sim_")
+    try:
+        new_bin = build_new(workdir, args.tick_hz)
+        result = subprocess.run([new_bin, "programs"], capture_output=True, text=True)
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+    for line in result.stdout.splitlines():
+        print(line[2:])
+    if result.returncode != 0:
+        print("memory slot compiler checks failed")
+    return result.returncode
+
+
+def parse_plans(out):
+    plans = []
+    for line in out.splitlines():
+        parts = line.split()
+        if parts[0] == "P":
+            plans.append({"case": parts[1], "profile": parts[2], "duration_ms": int(parts[3]),
+                          "accel_percent": int(parts[4]), "min_ms": int(parts[5]), "joints": [], "angles": []})
+        elif parts[0] == "J":
+            plans[-1]["joints"].append((int(parts[2]), int(parts[3]), float(parts[4]), float(parts[5])))
+        elif parts[0] == "X":
+            plans[-1]["angles"].append([float(v) for v in parts[2:]])
+    return plans
+
+
+def plan_peaks(angles, servo):
+    """Peak |speed| (deg/s) and |acceleration| (deg/s^2) from central differences."""
+    x = [row[servo] for row in angles]
+    speed = max((abs(x[t + 1] - x[t - 1]) * 500 for t in range(1, len(x) - 1)), default=0)
+    # 2 ms stencil: the angles are printed with 6 decimals
+    accel = max((abs(x[t + 2] - 2 * x[t] + x[t - 2]) * 250000 for t in range(2, len(x) - 2)), default=0)
+    return speed, accel
+
+
+def check_plan(plan):
+    problems = []
+    angles = plan["angles"]
+    joints = plan["joints"]
+    if plan["duration_ms"] < plan["min_ms"]:
+        problems.append("shorter than authored")
+    for servo, (start, end, _, _) in enumerate(joints):
+        if abs(angles[0][servo] - start) > 1e-3 or abs(angles[-1][servo] - end) > 1e-3:
+            problems.append("%s does not start/land on its pose" % SERVO_NAMES[servo])
+
+    # Synchronized: every moving joint is at the same fraction of its move at every ms
+    moving = [i for i, (start, end, _, _) in enumerate(joints) if start != end]
+    for row in angles:
+        fractions = [(row[i] - joints[i][0]) / (joints[i][1] - joints[i][0]) for i in moving]
+        if fractions and max(fractions) - min(fractions) > 1e-4:
+            problems.append("joints out of step")
+            break
+
+    # Load: share of each joint's limit used at the peak; linear moves have no accel bound
+    speed_use, accel_use = 0.0, 0.0
+    for i in moving:
+        speed, accel = plan_peaks(angles, i)
+        max_speed, max_accel = joints[i][2], joints[i][3]
+        if max_speed > 0:
+            speed_use = max(speed_use, speed / max_speed)
+        if max_accel > 0 and plan["profile"] != "linear":
+            accel_use = max(accel_use, accel / max_accel)
+    if speed_use > PLAN_SPEED_SLACK:
+        problems.append("speed limit")
+    if accel_use > PLAN_ACCEL_SLACK:
+        problems.append("accel limit")
+    # Stretched past the authored time only if some limit is (nearly) reached
+    if plan["duration_ms"] > plan["min_ms"] + 1 and max(speed_use, accel_use) < 0.95:
+        problems.append("longer than the limits need")
+    return speed_use, accel_use, problems
+
+
+def run_plans(args):
+    workdir = tempfile.mkdtemp(prefix="otto_motion_sim_")
+    try:
+        new_bin = build_new(workdir, args.tick_hz)
+        plans = parse_plans(subprocess.run([new_bin, "plan"], check=True, capture_output=True, text=True).stdout)
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    print("%-18s %-10s %8s %8s %6s %8s %8s" % ("case", "profile", "min ms", "plan ms", "acc %", "speed", "accel"))
+    failed = 0
+    for plan in plans:
+        speed_use, accel_use, problems = check_plan(plan)
+        failed += 1 if problems else 0
+        print("%-18s %-10s %8d %8d %6s %7.0f%% %7.0f%% %s" % (
+            plan["case"], plan["profile"], plan["min_ms"], plan["duration_ms"],
+            plan["accel_percent"] if plan["profile"] == "trapezoid" else "-", speed_use * 100,
+            accel_use * 100, "FAIL " + ", ".join(problems) if problems else "ok"))
+        if args.dump:
+            dump_plan_csv("%s_plan_%s_%s.csv" % (args.dump, plan["case"], plan["profile"]), plan)
+
+    if failed:
+        print("%d plan(s) violate the planner contract" % failed)
+        return 1
+    return 0
+
+
+def dump_plan_csv(path, plan):
+    angles = plan["angles"]
+    with open(path, "w") as f:
+        f.write("t_ms,servo,angle,speed,accel\n")
+        for servo in range(len(SERVO_NAMES)):
+            x = [row[servo] for row in angles]
+            for t in range(len(x)):
+                lo, hi = max(t - 1, 0), min(t + 1, len(x) - 1)
+                speed = (x[hi] - x[lo]) * 1000 / max(1, hi - lo)
+                accel = (x[t + 1] - 2 * x[t] + x[t - 1]) * 1e6 if 0 < t < len(x) - 1 else 0.0
+                f.write("%d,%s,%.4f,%.1f,%.0f\n" % (t, SERVO_NAMES[servo], x[t], speed, accel))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--scenario", help="run a single scenario")
+    parser.add_argument("--ref", help="reference git revision (default: reference_rev in bench_baseline.json)")
+    parser.add_argument("--tick-hz", type=int, default=1000,
+                        help="FreeRTOS tick rate for vTaskDelay (default 1000 = exact ms; device runs 100)")
+    parser.add_argument("--tolerance-ms", type=int, default=2 * ENGINE_TICK_MS,
+                        help="allowed duration difference")
+    parser.add_argument("--max-dev", type=int, default=5, help="allowed angle deviation in degrees")
+    parser.add_argument("--dump", metavar="PREFIX",
+                        help="write PREFIX_<scenario>_{ref,new}.csv traces (--bench: _<scenario>, --replay: _replay)")
+    parser.add_argument("--profile", choices=PROFILES, default="linear",
+                        help="planner profile for the new build's pose transitions (default linear)")
+    parser.add_argument("--plan", action="store_true", help="check the trajectory planner instead of the routines")
+    parser.add_argument("--bench", action="store_true", help="time the working tree routines instead of comparing")
+    parser.add_argument("--programs", action="store_true", help="check the memory slot compiler instead of the routines")
+    parser.add_argument("--tick-jitter-us", type=int, default=0,
+                        help="engine ticks land up to +-this many us off schedule (--bench, --replay)")
+    parser.add_argument("--save-bench", metavar="FILE", help="write the --bench numbers as JSON")
+    parser.add_argument("--baseline", metavar="FILE", help="fail --bench if a scenario regressed against FILE")
+    parser.add_argument("--max-write-growth", type=int, default=10,
+                        help="allowed servo write count growth against --baseline, in percent")
+    parser.add_argument("--replay", metavar="SLOT", help="play a memory slot text through the action queue")
+    parser.add_argument("--gap-ms", type=int, default=100, help="--replay: time between queued actions")
+    parser.add_argument("--at", action="append", default=[], metavar="MS:ACTION[,P1,P2]",
+                        help="--replay: another client sends this action at MS (repeatable)")
+    args = parser.parse_args()
+
+    if args.plan:
+        return run_plans(args)
+    if args.programs:
+        return run_programs(args)
+    if args.replay:
+        return run_replay(args)
+    if args.bench:
+        return run_bench(args)
+
+    ref_rev = args.ref or pinned_reference_rev()
+    if not ref_rev:
+        sys.exit("no reference_rev in %s, pass --ref" % BASELINE)
+    workdir = tempfile.mkdtemp(prefix="otto_motion_sim_")
+    try:
+        ref_bin, new_bin = build(workdir, ref_rev, args.tick_hz)
+        ref_traces = run(ref_bin, args.scenario)
+        new_traces = run(new_bin, args.scenario, ["--profile=" + args.profile])
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+    print("reference %s, FreeRTOS tick %d Hz, engine tick %d ms, %s profile" % (
+        ref_rev[:10], args.tick_hz, ENGINE_TICK_MS, args.profile))
+    print("%-22s %10s %10s %7s %8s %13s %6s" % ("scenario", "ref ms", "new ms", "diff", "max dev", "writes", ""))
+    failed = 0
+    for name, ref in ref_traces.items():
+        new = new_traces.get(name)
+        if new is None:
+            print("%-22s missing in new build" % name)
+            failed += 1
+            continue
+        ref_ms = ref["end_us"] // 1000
+        new_ms = new["end_us"] // 1000
+        end_ms = max(ref_ms, new_ms)
+        dev, dev_t, dev_servo = 0, 0, 0
+        for servo in range(len(SERVO_NAMES)):
+            d, t = max_deviation(ref, new, servo, end_ms, args.tolerance_ms)
+            if d > dev:
+                dev, dev_t, dev_servo = d, t, servo
+
+        problems = []
+        notes = []
+        if args.profile != "linear" and new_ms - ref_ms > args.tolerance_ms:
+            notes.append("stretched by joint limits")
+        elif abs(new_ms - ref_ms) > args.tolerance_ms:
+            problems.append("duration")
+        if final_pose(ref) != final_pose(new):
+            problems.append("final pose %s != %s" % (final_pose(ref), final_pose(new)))
+        if dev > args.max_dev and args.profile == "linear":
+            problems.append("%s off by %d deg at %d ms" % (SERVO_NAMES[dev_servo], dev, dev_t))
+        if not problems:
+            status = " ".join(["ok"] + notes)
+        elif name in KNOWN_DIFFERENCES:
+            status = "expected: " + KNOWN_DIFFERENCES[name]
+        else:
+            status = "FAIL " + ", ".join(problems)
+            failed += 1
+        print("%-22s %10d %10d %+7d %8d %6d/%-6d %s" % (name, ref_ms, new_ms, new_ms - ref_ms, dev,
+                                                          len(ref["writes"]), len(new["writes"]), status))
+        if args.dump:
+            dump_csv("%s_%s_ref.csv" % (args.dump, name), ref)
+            dump_csv("%s_%s_new.csv" % (args.dump, name), new)
+
+    if failed:
+        print("%d scenario(s) out of tolerance" % failed)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,138 @@
+#include "sim_controller.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "host_sim.h"
+
+void SimController::Event(uint32_t token, int action_type, const char* event) {
+    printf("A %lld %lu %s %s\n", (long long)esp_timer_get_time(), (unsigned long)token, OttoActionName(action_type),
+           event);
+}
+
+void SimController::Preempt() {
+    if (running_token_ == 0 || preempted_) {
+        return;
+    }
+    preempted_ = true;
+    otto_.Interrupt();
+}
+
+uint32_t SimController::QueueAction(int action_type, int steps, int speed, int direction, int amount, int priority) {
+    QueuedAction action = {action_type, steps, speed, direction, amount,
+                           (uint8_t)std::max(OTTO_PRIORITY_NORMAL, std::min(priority, OTTO_PRIORITY_URGENT)), 0,
+                           esp_timer_get_time()};
+    ActionPushResult result;
+    uint32_t token = queue_.Push(action, OttoActionCoalesceMode(action_type), &result);
+    static const char* const kResults[] = {"queued", "coalesced", "dropped", "rejected"};
+    Event(token, action_type, kResults[result]);
+    if (token != 0 && action.priority == OTTO_PRIORITY_URGENT && running_priority_ < OTTO_PRIORITY_URGENT) {
+        Preempt();
+    }
+    return token;
+}
+
+void SimController::StopAll() {
+    // Same end state as ActionQueue::Clear(), but says which actions went
+    QueuedAction action;
+    while (queue_.Pop(&action)) {
+        Event(action.token, action.action_type, "cleared");
+    }
+    Preempt();
+    QueueAction(ACTION_HOME, 1, 500, 0, 0, OTTO_PRIORITY_URGENT);
+}
+
+int SimController::PendingActions() const {
+    return queue_.Count() + (running_token_ != 0 ? 1 : 0);
+}
+
+void SimController::QueueWebOp(uint8_t op, int param1, int param2) {
+    if (op == ACTION_OP_STOP) {
+        StopAll();
+        return;
+    }
+    // show_clock queues nothing: display only
+    WebOpAction actions[WEB_OP_MAX_ACTIONS];
+    int count = OttoWebOpActions(op, param1, param2, actions);
+    for (int i = 0; i < count; i++) {
+        QueueAction(actions[i].action_type, actions[i].steps, actions[i].speed, 0, 0, actions[i].priority);
+    }
+}
+
+int SimController::ScheduleProgram(const std::vector<uint8_t>& code, int64_t start_us, int gap_ms, int max_actions) {
+    program_.clear();
+    program_next_ = 0;
+    program_gap_ms_ = gap_ms;
+    ActionProgramRun(code.data(), code.size(), max_actions * 4, [&](const ActionStep& step) {
+        if (step.op == ACTION_OP_EMOJI) {
+            return true;
+        }
+        if ((int)program_.size() >= max_actions) {
+            return false;
+        }
+        program_.push_back(step);
+        return true;
+    });
+    if (!program_.empty()) {
+        host_schedule_at(start_us, [this]() { PlayNextStep(); });
+    }
+    return (int)program_.size();
+}
+
+// One pass of run_memory_slot()'s loop body on the web task
+void SimController::PlayNextStep() {
+    const ActionStep& step = program_[program_next_];
+    int64_t now_us = esp_timer_get_time();
+    // Back-pressure: wait for room instead of letting the queue drop its oldest action
+    if (step.op != ACTION_OP_STOP && PendingActions() >= ACTION_QUEUE_SIZE) {
+        host_schedule_at(now_us + 20 * 1000, [this]() { PlayNextStep(); });
+        return;
+    }
+    // Speed multiplier at its default 100 %
+    int speed = step.p2 > 0 ? std::max((int)step.p2, 10) : step.p2;
+    QueueWebOp(step.op, step.p1, speed);
+    if (++program_next_ >= program_.size()) {
+        return;
+    }
+    int64_t gap_us = step.op != ACTION_OP_STOP ? (int64_t)program_gap_ms_ * 1000 : 0;
+    host_schedule_at(now_us + gap_us, [this]() { PlayNextStep(); });
+}
+
+// OttoController::Pause: a delay an urgent command cuts short
+bool SimController::Pause(int ms) {
+    for (int i = 0; i < ms && !preempted_; i++) {
+        host_advance_us(1000);
+    }
+    return !preempted_;
+}
+
+void SimController::RunUntilIdle() {
+    OttoActionHooks hooks;
+    hooks.pause = [this](int ms) { return Pause(ms); };
+
+    while (true) {
+        QueuedAction action;
+        if (!queue_.Pop(&action)) {
+            int64_t next_us = host_next_event_us();
+            if (next_us < 0) {
+                return;
+            }
+            // The idle action task wakes up as soon as something is queued
+            host_advance_us(std::max<int64_t>(next_us - esp_timer_get_time(), 0));
+            continue;
+        }
+
+        running_token_ = action.token;
+        running_priority_ = action.priority;
+        preempted_ = false;
+        otto_.Resume();
+        Event(action.token, action.action_type, "start");
+        OttoPlayAction(otto_, action, hooks);
+        Event(action.token, action.action_type, preempted_ ? "preempted" : "done");
+        running_token_ = 0;
+        running_priority_ = OTTO_PRIORITY_NORMAL;
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+}
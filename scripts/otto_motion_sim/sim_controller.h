@@ -0,0 +1,57 @@
+#pragma once
+// Host model of the kiki action pipeline for replays: web op -> OttoController
+// queue -> action task -> Otto routine. The queue (otto_action_queue.cc), the
+// memory slot bytecode (otto_action_program.cc), the web op table, coalescing and
+// the action task's switch (otto_actions.cc) and the routines are the firmware
+// files. Only the glue is mirrored: otto_execute_web_op()'s stop case,
+// run_memory_slot()'s pacing and OttoController's queue/preempt bookkeeping,
+// which are tied to MCP/Board/Application and don't build on the host.
+//
+// Prints one line per queue event next to the servo writes:
+//   A <t_us> <token> <action> <event>   event: queued coalesced dropped rejected cleared start done preempted
+// "dropped" is queued too, after dropping the oldest lowest-priority action (which never starts)
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "otto_action_program.h"
+#include "otto_action_queue.h"
+#include "otto_actions.h"
+#include "otto_movements.h"
+
+class SimController {
+public:
+    explicit SimController(Otto& otto) : otto_(otto) {}
+
+    // OttoController::QueueAction: coalescing, drop-oldest, URGENT preempts the running action
+    uint32_t QueueAction(int action_type, int steps, int speed, int direction, int amount,
+                         int priority = OTTO_PRIORITY_NORMAL);
+    // otto_execute_web_op(): stop, or the actions OttoWebOpActions() lists
+    void QueueWebOp(uint8_t op, int param1, int param2);
+    // run_memory_slot() from start_us on, as the web task does while the action task plays:
+    // waits (20 ms polls) while ACTION_QUEUE_SIZE actions are pending, queues the op, then
+    // sleeps gap_ms. Returns the number of actions it will queue.
+    int ScheduleProgram(const std::vector<uint8_t>& code, int64_t start_us, int gap_ms, int max_actions);
+    void StopAll();
+    // OttoController::PendingActions: queued plus running
+    int PendingActions() const;
+
+    // The action task until the queue is empty and nothing more is scheduled
+    void RunUntilIdle();
+
+private:
+    void Preempt();
+    bool Pause(int ms);
+    void Event(uint32_t token, int action_type, const char* event);
+    void PlayNextStep();
+
+    Otto& otto_;
+    ActionQueue queue_;
+    uint32_t running_token_ = 0;
+    uint8_t running_priority_ = OTTO_PRIORITY_NORMAL;
+    bool preempted_ = false;
+    // Memory slot being played by ScheduleProgram
+    std::vector<ActionStep> program_;
+    size_t program_next_ = 0;
+    int program_gap_ms_ = 0;
+};
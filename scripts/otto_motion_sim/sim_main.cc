@@ -0,0 +1,330 @@
+// Runs the Otto dog routines against mocked LEDC/FreeRTOS and prints every servo write:
+//   S <scenario>            scenario start, clock reset to 0
+//   W <t_us> <servo> <deg> <duty>  servo write (logical angle, right side un-mirrored; raw LEDC duty)
+//   E <t_us>                routine returned
+// Working tree build only (SIM_TRAJECTORY):
+//   sim [scenario] --profile=<name>   pose transitions use that planner profile
+//   sim [scenario] --tick-jitter=<us> engine ticks land up to +-us off MOTION_TICK_MS
+//   sim plan                          planner dump, see DumpPlans()
+//   sim replay "<slot text>" [--gap=<ms>] [--at=<ms>:<action>[,p1,p2]]...
+//                                     plays a memory slot through the action queue, see Replay()
+//   sim programs                      memory slot compiler checks, see CheckPrograms()
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esp_timer.h"
+#include "host_sim.h"
+#include "otto_movements.h"
+#ifdef SIM_TRAJECTORY
+#include "otto_action_program.h"
+#include "sim_controller.h"
+#endif
+
+struct Scenario {
+    const char* name;
+    std::function<void(Otto&)> prepare;  // Untraced, sets the start pose
+    std::function<void(Otto&)> run;
+    int stop_at_ms;  // >= 0: Stop() requested at that time
+};
+
+static void Upright(Otto&) {
+}
+
+static const Scenario kScenarios[] = {
+    {"stand_up_from_lie", [](Otto& o) { o.ServoInit(5, 5, 5, 5, 0); }, [](Otto& o) { o.StandUp(); }, -1},
+    {"walk", Upright, [](Otto& o) { o.DogWalk(2, 150); }, -1},
+    {"walk_back", Upright, [](Otto& o) { o.DogWalkBack(2, 150); }, -1},
+    {"turn_left", Upright, [](Otto& o) { o.DogTurnLeft(3, 150); }, -1},
+    {"turn_right", Upright, [](Otto& o) { o.DogTurnRight(3, 150); }, -1},
+    {"sit_down", Upright, [](Otto& o) { o.DogSitDown(500); }, -1},
+    {"lie_down", Upright, [](Otto& o) { o.DogLieDown(1000); }, -1},
+    {"jump", Upright, [](Otto& o) { o.DogJump(200); }, -1},
+    {"bow", Upright, [](Otto& o) { o.DogBow(2000); }, -1},
+    {"dance", Upright, [](Otto& o) { o.DogDance(3, 200); }, -1},
+    {"wave_right_foot", Upright, [](Otto& o) { o.DogWaveRightFoot(5, 50); }, -1},
+    {"dance_4_feet", Upright, [](Otto& o) { o.DogDance4Feet(6, 300); }, -1},
+    {"swing", Upright, [](Otto& o) { o.DogSwing(8, 6); }, -1},
+    {"stretch", Upright, [](Otto& o) { o.DogStretch(2, 15); }, -1},
+    {"scratch", Upright, [](Otto& o) { o.DogScratch(5, 50); }, -1},
+    {"wag_tail", Upright, [](Otto& o) { o.WagTail(5, 100); }, -1},
+    {"roll_over", Upright, [](Otto& o) { o.DogRollOver(1, 200); }, -1},
+    {"play_dead", Upright, [](Otto& o) { o.DogPlayDead(5); }, -1},
+    {"shake_paw", Upright, [](Otto& o) { o.DogShakePaw(3, 150); }, -1},
+    {"sidestep_right", Upright, [](Otto& o) { o.DogSidestep(3, 150, 1); }, -1},
+    {"sidestep_left", Upright, [](Otto& o) { o.DogSidestep(3, 150, -1); }, -1},
+    {"pushup", Upright, [](Otto& o) { o.DogPushup(3, 150); }, -1},
+    {"balance", Upright, [](Otto& o) { o.DogBalance(2000, 150); }, -1},
+    {"toilet", Upright, [](Otto& o) { o.DogToilet(3000, 150); }, -1},
+    {"beat_step_swing", Upright, [](Otto& o) { o.DogBeatStep(BEAT_STYLE_SWING, 1, 250); }, -1},
+    {"home_from_bow", [](Otto& o) { o.ServoInit(0, 0, 90, 90, 0); }, [](Otto& o) { o.Home(); }, -1},
+    {"sit_then_walk", Upright,
+     [](Otto& o) {
+         o.DogSitDown(500);
+         o.DogWalk(1, 150);
+     },
+     -1},
+    // Stand up (12 + 300 ms) + 120 ms settle + 2 cycles of 8 x 150 ms; the stop
+    // lands just before a cycle boundary where the old loop polled the stop bit
+    {"continuous_walk", Upright, [](Otto& o) { o.ContinuousWalk(150); }, 432 + 2 * 1200 - 5},
+    // Stand up + 200 ms settle + 1 cycle of 16 x 100 ms
+    {"continuous_turn_left", Upright, [](Otto& o) { o.ContinuousTurnLeft(100); }, 512 + 1600 - 5},
+};
+
+#ifdef SIM_TRAJECTORY
+static const char* const kProfileNames[] = {"linear", "min_jerk", "trapezoid"};
+
+struct PlanCase {
+    const char* name;
+    int from[MOTION_SERVO_COUNT];
+    int to[MOTION_SERVO_COUNT];
+    int min_ms;  // Authored time, AddSmoothMove uses 12 ms per degree of the furthest leg
+};
+
+static const PlanCase kPlanCases[] = {
+    {"stand_up_from_lie", {5, 5, 5, 5, 90}, {90, 90, 90, 90, 90}, 85 * 12},
+    {"sit_down", {90, 90, 90, 90, 90}, {90, 90, 30, 30, 90}, 60 * 12},
+    {"lie_down", {90, 90, 90, 90, 90}, {5, 5, 5, 5, 90}, 85 * 12},
+    {"small_twitch", {90, 90, 90, 90, 90}, {95, 90, 88, 90, 90}, 5 * 12},
+    {"snap_to_pose", {90, 90, 90, 90, 90}, {30, 150, 60, 120, 90}, 0},
+    {"tail_and_legs", {90, 90, 90, 90, 0}, {60, 120, 90, 90, 180}, 200},
+};
+
+// Plans every case with every profile through MotionBuilder::Move and prints
+// the unrounded trajectory the player follows:
+//   P <case> <profile> <duration_ms> <accel_percent> <min_ms>
+//   J <servo> <from> <to> <max_speed> <max_accel>
+//   X <t_ms> <angle 0> .. <angle 4>   every ms from 0 to duration
+static void DumpPlans() {
+    JointLimits limits[MOTION_SERVO_COUNT];
+    for (int i = 0; i < SERVO_COUNT; i++) {
+        limits[i].max_speed = JOINT_SPEED_LIMIT_DEFAULT;
+        limits[i].max_accel = JOINT_ACCEL_LIMIT_DEFAULT;
+    }
+    // A lighter tail with its own limits, so plans mix per-joint limits
+    limits[SERVO_TAIL].max_speed = 400;
+    limits[SERVO_TAIL].max_accel = 6000;
+
+    for (const PlanCase& plan : kPlanCases) {
+        for (int profile = TRAJECTORY_LINEAR; profile <= TRAJECTORY_TRAPEZOID; profile++) {
+            MotionBuilder builder(plan.from);
+            builder.Move(MOTION_MASK_ALL, plan.to, (TrajectoryProfile)profile, limits, plan.min_ms);
+            MotionClip clip = builder.Build(plan.name);
+
+            const MotionKey& first = clip.keys.front();
+            printf("P %s %s %lu %d %d\n", plan.name, kProfileNames[profile], (unsigned long)clip.duration_ms,
+                   first.accel_percent, plan.min_ms);
+            for (int i = 0; i < MOTION_SERVO_COUNT; i++) {
+                printf("J %d %d %d %g %g\n", i, plan.from[i], plan.to[i], limits[i].max_speed, limits[i].max_accel);
+            }
+            for (uint32_t t = 0; t <= clip.duration_ms; t++) {
+                printf("X %lu", (unsigned long)t);
+                for (const MotionKey& key : clip.keys) {
+                    float progress = key.ramp_ms == 0 ? 1
+                                     : TrajectoryProgress((TrajectoryProfile)key.profile, (float)t / key.ramp_ms,
+                                                          key.accel_percent);
+                    printf(" %.6f", plan.from[key.servo] + (key.angle - plan.from[key.servo]) * progress);
+                }
+                printf("\n");
+            }
+        }
+    }
+}
+
+#define REPLAY_MAX_ACTIONS 200  // ACTION_SLOT_MAX_ACTIONS
+
+struct TimedCommand {
+    int64_t at_us;
+    uint8_t op;
+    int p1;
+    int p2;
+};
+
+// Memory slot compiler contract: what the web UI may save, and what a stored blob may contain
+struct ProgramCase {
+    const char* name;
+    const char* text;
+    bool strict;
+    const char* error;  // nullptr: must compile; else a substring of the error
+    int played;         // Steps ActionProgramRun() must hand out when it compiles
+};
+
+static const ProgramCase kProgramCases[] = {
+    {"plain", "dog_walk,2,150;dog_sit_down,1,500", true, nullptr, 2},
+    {"loop", "loop,3;dog_walk,1,150;endloop;home", true, nullptr, 4},
+    {"nested_loop", "loop,2;loop,3;dog_wag_tail,1,100;endloop;dog_bow,1,300;endloop", true, nullptr, 8},
+    {"empty_loop", "loop,5;endloop;dog_walk,1,150", true, "empty loop", 0},
+    {"empty_nested_loop", "loop,99;loop,99;endloop;endloop;home", true, "empty loop", 0},
+    {"empty_loop_lenient", "loop,5;endloop;dog_walk,1,150", false, nullptr, 1},
+    {"empty_unclosed_lenient", "dog_walk,1,150;loop,99", false, nullptr, 1},
+    {"only_empty_loop_lenient", "loop,99;endloop", false, "no actions", 0},
+    {"unclosed_loop", "loop,2;dog_walk,1,150", true, "loop without endloop", 0},
+    {"stray_endloop", "dog_walk,1,150;endloop", true, "endloop without loop", 0},
+    {"loop_count", "loop,0;dog_walk,1,150;endloop", true, "loop count", 0},
+};
+
+static int CheckPrograms() {
+    int failed = 0;
+    for (const ProgramCase& c : kProgramCases) {
+        std::vector<uint8_t> code;
+        std::string error;
+        bool compiled = ActionProgramCompile(c.text, nullptr, c.strict, code, &error);
+        std::string problem;
+        if (c.error != nullptr) {
+            if (compiled) {
+                problem = "compiled, expected error '" + std::string(c.error) + "'";
+            } else if (error.find(c.error) == std::string::npos) {
+                problem = "error '" + error + "'";
+            }
+        } else if (!compiled) {
+            problem = "rejected: " + error;
+        } else if (!ActionProgramInspect(code.data(), code.size(), nullptr)) {
+            problem = "blob fails ActionProgramInspect";
+        } else {
+            int played = ActionProgramRun(code.data(), code.size(), 1000, [](const ActionStep&) { return true; });
+            if (played != c.played) {
+                problem = "played " + std::to_string(played) + " steps, expected " + std::to_string(c.played);
+            }
+        }
+        printf("G %-24s %s\n", c.name, problem.empty() ? "ok" : ("FAIL " + problem).c_str());
+        failed += problem.empty() ? 0 : 1;
+    }
+
+    // A stored blob with an empty loop (hand-built, the compiler no longer emits one)
+    std::vector<uint8_t> blob = {ACTION_PROGRAM_VERSION, ACTION_EMOJI_NONE, 1, 0, ACTION_OP_LOOP, 99,
+                                 ACTION_OP_NEXT};
+    std::vector<uint8_t> step_code;
+    ActionProgramCompile("dog_walk,1,150", nullptr, true, step_code, nullptr);
+    blob.insert(blob.end(), step_code.begin() + ACTION_PROGRAM_HEADER_SIZE, step_code.end());
+    bool accepted = ActionProgramInspect(blob.data(), blob.size(), nullptr);
+    printf("G %-24s %s\n", "inspect_empty_loop", accepted ? "FAIL blob accepted" : "ok");
+    failed += accepted ? 1 : 0;
+    return failed ? 1 : 0;
+}
+
+// "<ms>:<action>[,p1,p2]", the action in memory slot syntax
+static bool ParseTimedCommand(const char* arg, TimedCommand* command) {
+    char name[32];
+    int at_ms = 0;
+    command->p1 = 0;
+    command->p2 = 0;
+    if (sscanf(arg, "%d:%31[^,],%d,%d", &at_ms, name, &command->p1, &command->p2) < 2) {
+        return false;
+    }
+    command->at_us = (int64_t)at_ms * 1000;
+    command->op = ActionOpFromName(name, command->p1);
+    return command->op != ACTION_OP_END;
+}
+
+// A memory slot played from the web UI: run_memory_slot() queues one action every gap_ms
+// while the action task plays them. The --at commands arrive from another client meanwhile
+// (stop and home preempt). Prints S/W/E like a scenario, with the queue's A lines in between.
+static int Replay(Otto& otto, const char* text, int gap_ms, const std::vector<TimedCommand>& commands) {
+    std::vector<uint8_t> code;
+    std::string error;
+    if (!ActionProgramCompile(text, nullptr, true, code, &error)) {
+        fprintf(stderr, "replay: %s\n", error.c_str());
+        return 2;
+    }
+
+    host_set_trace(nullptr);
+    otto.ServoInit(90, 90, 90, 90, 0);
+    host_reset_clock();
+    SimController controller(otto);
+    controller.ScheduleProgram(code, 0, gap_ms, REPLAY_MAX_ACTIONS);
+    for (const TimedCommand& command : commands) {
+        host_schedule_at(command.at_us, [&controller, command]() {
+            controller.QueueWebOp(command.op, command.p1, command.p2);
+        });
+    }
+
+    printf("S replay\n");
+    host_set_trace(stdout);
+    controller.RunUntilIdle();
+    host_set_trace(nullptr);
+    printf("E %lld\n", (long long)esp_timer_get_time());
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    Otto otto;
+    otto.Init(HOST_SERVO_GPIO_BASE + SERVO_LF, HOST_SERVO_GPIO_BASE + SERVO_RF, HOST_SERVO_GPIO_BASE + SERVO_LB,
+              HOST_SERVO_GPIO_BASE + SERVO_RB, HOST_SERVO_GPIO_BASE + SERVO_TAIL);
+
+#ifdef SIM_TRAJECTORY
+    const char* replay = nullptr;
+    int gap_ms = 100;
+    std::vector<TimedCommand> commands;
+#endif
+    for (int i = 1; i < argc; i++) {
+#ifdef SIM_TRAJECTORY
+        if (strcmp(argv[i], "plan") == 0) {
+            DumpPlans();
+            return 0;
+        }
+        if (strcmp(argv[i], "programs") == 0) {
+            return CheckPrograms();
+        }
+        if (strcmp(argv[i], "replay") == 0 && i + 1 < argc) {
+            replay = argv[++i];
+            continue;
+        }
+        if (strncmp(argv[i], "--gap=", 6) == 0) {
+            gap_ms = atoi(argv[i] + 6);
+            continue;
+        }
+        if (strncmp(argv[i], "--at=", 5) == 0) {
+            TimedCommand command;
+            if (!ParseTimedCommand(argv[i] + 5, &command)) {
+                fprintf(stderr, "bad --at command: %s\n", argv[i] + 5);
+                return 2;
+            }
+            commands.push_back(command);
+            continue;
+        }
+        if (strncmp(argv[i], "--tick-jitter=", 14) == 0) {
+            host_set_tick_jitter_us(atoi(argv[i] + 14));
+            continue;
+        }
+        if (strncmp(argv[i], "--profile=", 10) == 0) {
+            for (int profile = TRAJECTORY_LINEAR; profile <= TRAJECTORY_TRAPEZOID; profile++) {
+                if (strcmp(argv[i] + 10, kProfileNames[profile]) == 0) {
+                    otto.SetMotionProfile((TrajectoryProfile)profile);
+                }
+            }
+            continue;
+        }
+#endif
+        only = argv[i];
+    }
+#ifdef SIM_TRAJECTORY
+    if (replay != nullptr) {
+        return Replay(otto, replay, gap_ms, commands);
+    }
+#endif
+
+    for (const Scenario& scenario : kScenarios) {
+        if (only != nullptr && strcmp(only, scenario.name) != 0) {
+            continue;
+        }
+        host_set_trace(nullptr);
+        otto.ServoInit(90, 90, 90, 90, 0);
+        scenario.prepare(otto);
+
+        host_reset_clock();
+        if (scenario.stop_at_ms >= 0) {
+            host_request_stop_at((int64_t)scenario.stop_at_ms * 1000);
+        }
+        printf("S %s\n", scenario.name);
+        host_set_trace(stdout);
+        scenario.run(otto);
+        host_set_trace(nullptr);
+        printf("E %lld\n", (long long)esp_timer_get_time());
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Measure web UI page loads on a Kiki robot.
+
+Fetches each page several times on a fresh connection and prints bytes on
+the wire, time to first byte and total time. With the gzip/ETag firmware a
+second pass sends If-None-Match to show the 304 path. Run it against the old
+and new firmware to compare.
+
+    python scripts/web_ui_bench.py 192.168.1.100
+"""
+import argparse
+import gzip
+import http.client
+import statistics
+import time
+
+PAGES = ["/", "/music", "/servo_calibration"]
+
+
+def fetch(host, port, path, etag=None):
+    headers = {"Accept-Encoding": "gzip"}
+    if etag:
+        headers["If-None-Match"] = etag
+    start = time.perf_counter()
+    conn = http.client.HTTPConnection(host, port, timeout=15)
+    conn.request("GET", path, headers=headers)
+    resp = conn.getresponse()
+    ttfb = time.perf_counter() - start
+    body = resp.read()
+    total = time.perf_counter() - start
+    conn.close()
+    if resp.getheader("Content-Encoding") == "gzip":
+        html = gzip.decompress(body)
+    else:
+        html = body
+    return {
+        "status": resp.status,
+        "wire": len(body),
+        "html": len(html),
+        "chunked": resp.getheader("Transfer-Encoding") == "chunked",
+        "etag": resp.getheader("ETag"),
+        "ttfb": ttfb * 1000,
+        "total": total * 1000,
+    }
+
+
+def report(label, samples):
+    first = samples[0]
+    mode = "chunked" if first["chunked"] else "whole"
+    print(f"{label:<28} {first['status']:>4} {first['wire']:>8} {first['html']:>8} {mode:>8} "
+          f"{statistics.mean(s['ttfb'] for s in samples):>8.1f} "
+          f"{statistics.mean(s['total'] for s in samples):>8.1f} {max(s['total'] for s in samples):>8.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="robot IP address")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--runs", type=int, default=5)
+    args = parser.parse_args()
+
+    print(f"{'page':<28} {'http':>4} {'wire B':>8} {'html B':>8} {'xfer':>8} {'ttfb ms':>8} {'avg ms':>8} "
+          f"{'max ms':>8}")
+    for path in PAGES:
+        samples = [fetch(args.host, args.port, path) for _ in range(args.runs)]
+        report(path, samples)
+        etag = samples[0]["etag"]
+        if etag:
+            report(path + " (If-None-Match)", [fetch(args.host, args.port, path, etag) for _ in range(args.runs)])
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Measure command round-trip latency on a Kiki robot's /ws control channel.
+
+Opens the WebSocket, sends ping and command frames one at a time and waits
+for the matching pong/ack, then does the same number of plain HTTP requests
+for comparison. A burst of volume frames exercises the coalescing path (the
+robot acks every frame but applies only the latest). Standard library only.
+
+    python scripts/ws_latency_bench.py 192.168.1.100
+    python scripts/ws_latency_bench.py 192.168.1.100 --actions   # robot moves!
+"""
+import argparse
+import base64
+import http.client
+import json
+import os
+import socket
+import statistics
+import struct
+import time
+
+
+class WebSocket:
+    def __init__(self, host, port, path="/ws", timeout=5):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall((f"GET {path} HTTP/1.1\r\nHost: {host}\r\nUpgrade: websocket\r\n"
+                           f"Connection: Upgrade\r\nSec-WebSocket-Key: {key}\r\n"
+                           f"Sec-WebSocket-Version: 13\r\n\r\n").encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("handshake closed")
+            response += chunk
+        head, self.buffer = response.split(b"\r\n\r\n", 1)
+        if b" 101 " not in head.split(b"\r\n", 1)[0]:
+            raise ConnectionError(head.decode(errors="replace"))
+
+    def send(self, msg):
+        payload = json.dumps(msg, separators=(",", ":")).encode()
+        mask = os.urandom(4)
+        header = bytes([0x81])
+        if len(payload) < 126:
+            header += bytes([0x80 | len(payload)])
+        else:
+            header += bytes([0x80 | 126]) + struct.pack(">H", len(payload))
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(header + mask + masked)
+
+    def _read(self, n):
+        while len(self.buffer) < n:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("socket closed")
+            self.buffer += chunk
+        data, self.buffer = self.buffer[:n], self.buffer[n:]
+        return data
+
+    def recv(self):
+        """Next text frame as a dict (control frames are skipped)"""
+        while True:
+            b0, b1 = self._read(2)
+            length = b1 & 0x7F
+            if length == 126:
+                length = struct.unpack(">H", self._read(2))[0]
+            elif length == 127:
+                length = struct.unpack(">Q", self._read(8))[0]
+            payload = self._read(length)
+            if b0 & 0x0F == 0x1:
+                return json.loads(payload)
+
+    def wait_for(self, kind, msg_id, seen_states):
+        while True:
+            msg = self.recv()
+            if msg.get("t") == "state":
+                seen_states.append(msg)
+            elif msg.get("t") == kind and msg.get("id") == msg_id:
+                return msg
+
+    def close(self):
+        self.sock.close()
+
+
+def summary(label, samples):
+    samples = sorted(samples)
+    p95 = samples[min(len(samples) - 1, int(len(samples) * 0.95))]
+    print(f"{label:<22} n={len(samples):<4} median {statistics.median(samples):7.1f} ms  "
+          f"p95 {p95:7.1f} ms  max {samples[-1]:7.1f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", help="robot IP address")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--count", type=int, default=50)
+    parser.add_argument("--actions", action="store_true", help="also time queued actions (the robot will move)")
+    args = parser.parse_args()
+
+    ws = WebSocket(args.host, args.port)
+    states = []
+    next_id = 1
+
+    def round_trip(msg, kind="ack"):
+        nonlocal next_id
+        msg["id"] = next_id
+        next_id += 1
+        start = time.perf_counter()
+        ws.send(msg)
+        reply = ws.wait_for(kind, msg["id"], states)
+        if kind == "ack" and not reply.get("ok"):
+            raise RuntimeError(f"{msg}: {reply.get('err')}")
+        return (time.perf_counter() - start) * 1000
+
+    results = {
+        "ws ping": [round_trip({"t": "ping", "ts": 0}, "pong") for _ in range(args.count)],
+        "ws emotion": [round_trip({"t": "emotion", "v": "neutral"}) for _ in range(args.count)],
+    }
+    if args.actions:
+        results["ws action (queued)"] = [round_trip({"t": "action", "cmd": "dog_wag_tail", "p1": 1, "p2": 100})
+                                         for _ in range(min(args.count, 5))]
+        round_trip({"t": "stop"})
+
+    # Burst of slider input: every frame is acked, the robot applies only the latest
+    burst = []
+    for level in range(40, 40 + args.count):
+        burst.append(round_trip({"t": "volume", "v": level % 101}))
+    results["ws volume burst"] = burst
+    if states:
+        round_trip({"t": "volume", "v": states[0]["vol"]})
+
+    conn = http.client.HTTPConnection(args.host, args.port, timeout=5)
+    http_samples = []
+    for _ in range(args.count):
+        start = time.perf_counter()
+        conn.request("GET", "/emotion?emotion=neutral")
+        conn.getresponse().read()
+        http_samples.append((time.perf_counter() - start) * 1000)
+    results["http /emotion"] = http_samples
+    ws.close()
+
+    for label, samples in results.items():
+        summary(label, samples)
+    print(f"state pushes received: {len(states)}")
+
+
+if __name__ == "__main__":
+    main()